@@ -31,8 +31,11 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+// The number of compilations of a cluster after which it may be considered
+// megamorphic.
+constexpr int64_t kCompileThreshold = 10;
+
 bool ShouldBeMegamorphic(int64_t compile_count, int64_t execution_count) {
-  const int64_t kCompileThreshold = 10;
   const int64_t kMinExecutionsPerCompile = 50;
 
   // This heuristic is trying to capture the following property: have we sunk a
@@ -120,6 +123,18 @@ absl::Status DeviceCompilationProfiler::RegisterCompilation(
                  it->second.cumulative_compile_time_us / 1.0e6)
           << ")";
 
+  // Each distinct signature of the cluster inputs is compiled separately, so a
+  // cluster that keeps being compiled is usually fed tensors of varying shapes.
+  // Warn once, as this is cheap to fix in the input pipeline but otherwise
+  // costs a compilation per new shape.
+  if (it->second.compile_count == kCompileThreshold + 1) {
+    LOG(WARNING) << "Cluster " << function_name << " has been compiled "
+                 << it->second.compile_count
+                 << " times, most likely for inputs of different shapes. "
+                    "Padding variable-sized inputs to a small set of bucket "
+                    "shapes avoids recompiling for every new shape.";
+  }
+
   XlaJitCompilationActivity jit_compilation_activity;
   jit_compilation_activity.set_cluster_name(function_name);
   jit_compilation_activity.set_compile_count(it->second.compile_count);
@@ -388,6 +388,11 @@ absl::Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     profiler->DecrementOngoingAsyncCompilations();
     // Update compilation status in cache.
     if (!s.ok()) {
+      // The cluster keeps running through the TensorFlow fallback, so this
+      // would otherwise only be visible as a missing speedup.
+      LOG(WARNING) << "Asynchronous compilation of cluster " << function_name
+                   << " failed; it will keep running without XLA: "
+                   << s.status();
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
@@ -223,12 +223,21 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
     const XlaSerializedCacheKey& key) const {
   Env* env = Env::Default();
   const std::string file_path = GetFilePath(key);
-  if (!env->FileExists(file_path).ok()) {
-    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
-  }
 
+  // Entries are saved as binary protos, so read them as such first: with the
+  // cache directory on a remote filesystem, every read attempt is a separate
+  // fetch of the whole executable. A missing file is a cache miss, which saves
+  // a separate existence check.
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  absl::Status status = ReadBinaryProto(env, file_path, &entry);
+  if (absl::IsNotFound(status)) {
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  if (!status.ok()) {
+    // Also accept entries that were written as text protos.
+    entry.Clear();
+    TF_RETURN_IF_ERROR(ReadTextProto(env, file_path, &entry));
+  }
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
@@ -92,6 +92,27 @@ using jit::DeviceSet;
 // cluster.
 const char* kXlaAlreadyClustered = "_XlaAlreadyClustered";
 
+// Returns true if XLA:CPU lowers `node` to the same Eigen or oneDNN library
+// call as its TF kernel.  These ops gain nothing from being compiled unless
+// they are clustered with ops that XLA can fuse.
+bool IsCpuLibraryCallOp(const Node& node) {
+  static const auto* const kLibraryCallOps =
+      new absl::flat_hash_set<std::string>({
+          "BatchMatMul",
+          "BatchMatMulV2",
+          "BatchMatMulV3",
+          "Conv2D",
+          "Conv2DBackpropFilter",
+          "Conv2DBackpropInput",
+          "Conv3D",
+          "Conv3DBackpropFilterV2",
+          "Conv3DBackpropInputV2",
+          "DepthwiseConv2dNative",
+          "MatMul",
+      });
+  return kLibraryCallOps->contains(node.type_string());
+}
+
 class MarkForCompilationPassImpl {
  public:
   struct DebugOptions {
@@ -147,13 +168,15 @@ class MarkForCompilationPassImpl {
    public:
     // Constructs a trivial cluster representing a single TF node.
     Cluster(int tf_graph_node_id, int effective_cluster_size,
-            bool has_functional_control_flow, DeviceSet devices,
+            int library_call_size, bool has_functional_control_flow,
+            DeviceSet devices,
             std::optional<DeviceId> resource_op_device,
             std::optional<int> resource_var_operation_node_id,
             std::optional<DeadnessPredicate> deadness_predicate,
             bool is_xla_compile_attr_true, std::optional<string> xla_scope)
         : cycles_graph_node_id_(tf_graph_node_id),
           effective_cluster_size_(effective_cluster_size),
+          library_call_size_(library_call_size),
           has_functional_control_flow_(has_functional_control_flow),
           devices_(std::move(devices)),
           resource_op_device_(resource_op_device),
@@ -191,6 +214,14 @@ class MarkForCompilationPassImpl {
     // The size of the cluster excluding constant and identity nodes.
     int effective_cluster_size() const { return effective_cluster_size_; }
 
+    // True if every node counted in the effective cluster size is a CPU op
+    // that XLA lowers to the same library call the TF kernel makes, so that
+    // compiling the cluster cannot be expected to pay off.
+    bool has_only_library_calls() const {
+      return library_call_size_ > 0 &&
+             library_call_size_ == effective_cluster_size_;
+    }
+
     // True if the cluster has functional control flow like `If` and `While`.
     bool has_functional_control_flow() const {
       return has_functional_control_flow_;
@@ -249,6 +280,7 @@ class MarkForCompilationPassImpl {
     int cluster_size_ = 1;
     int cycles_graph_node_id_;
     int effective_cluster_size_;
+    int library_call_size_;
     bool has_functional_control_flow_;
     DeviceSet devices_;
     std::optional<DeviceId> resource_op_device_;
@@ -359,6 +391,7 @@ class MarkForCompilationPassImpl {
   void VLogClusteringSummary();
 
   Cluster* MakeNewCluster(int cycles_graph_node_id, int effective_cluster_size,
+                          int library_call_size,
                           bool has_functional_control_flow,
                           const DeviceSet& device_set,
                           std::optional<DeviceId> resource_op_device,
@@ -367,7 +400,7 @@ class MarkForCompilationPassImpl {
                           bool is_xla_compile_attr_true,
                           std::optional<string> xla_scope) {
     cluster_storage_.push_back(std::make_unique<Cluster>(
-        cycles_graph_node_id, effective_cluster_size,
+        cycles_graph_node_id, effective_cluster_size, library_call_size,
         has_functional_control_flow, device_set, resource_op_device,
         resource_var_operation_node_id, deadness_predicate,
         is_xla_compile_attr_true, xla_scope));
@@ -587,6 +620,7 @@ void MarkForCompilationPassImpl::Cluster::Merge(Cluster* other) {
 
   cluster_size_ += other->cluster_size_;
   effective_cluster_size_ += other->effective_cluster_size_;
+  library_call_size_ += other->library_call_size_;
   has_functional_control_flow_ |= other->has_functional_control_flow_;
 
   devices_.UnionWith(other->devices_);
@@ -989,7 +1023,8 @@ absl::Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
+    if ((cluster->effective_cluster_size() >= debug_options_.min_cluster_size &&
+         !cluster->has_only_library_calls()) ||
         cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
@@ -1154,6 +1189,14 @@ absl::Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
     TF_ASSIGN_OR_RETURN(DeviceId device,
                         device_info_cache_.GetIdFor(device_name_str));
 
+    // On CPU, GEMMs and convolutions compile to the same Eigen or oneDNN calls
+    // that the TF kernels make, so they only pay off with other ops to fuse.
+    int library_call_size = 0;
+    if (effective_cluster_size > 0 && IsCpuLibraryCallOp(*node) &&
+        device_info_cache_.GetDeviceTypeFor(device) == DEVICE_CPU) {
+      library_call_size = 1;
+    }
+
     bool is_resource_op = HasResourceInputOrOutput(*node);
     std::optional<DeviceId> resource_op_device;
     if (is_resource_op) {
@@ -1176,6 +1219,7 @@ absl::Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
     Cluster* new_cluster = MakeNewCluster(
         /*cycles_graph_node_id=*/node->id(),
         /*effective_cluster_size=*/effective_cluster_size,
+        /*library_call_size=*/library_call_size,
         /*has_functional_control_flow=*/has_functional_control_flow, devices,
         resource_op_device, resource_var_operation_node_id, deadness_predicate,
         /*is_xla_compile_attr_true=*/is_xla_compile_attr_true,
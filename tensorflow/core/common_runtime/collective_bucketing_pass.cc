@@ -0,0 +1,333 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/collective_bucketing_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/dump_graph.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kBucketHint[] = "bucket";
+
+// A CollectiveReduce that may be bucketed.
+struct Candidate {
+  Node* node;
+  int64_t instance_key;
+  TensorShape shape;
+};
+
+// Candidates with the same key may share a bucket: (device, group_key,
+// group_size, T, merge_op, final_op, subdiv_offsets, timeout_seconds, depth).
+using BucketKey =
+    std::tuple<std::string, int64_t, int64_t, DataType, std::string,
+               std::string, std::vector<int32>, float, int>;
+
+bool IsBucketableType(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE || dtype == DT_HALF ||
+         dtype == DT_BFLOAT16;
+}
+
+bool GetStaticShape(const ShapeRefiner& refiner, const Node* node,
+                    TensorShape* shape) {
+  shape_inference::InferenceContext* c = refiner.GetContext(node);
+  if (c == nullptr || c->num_outputs() != 1) return false;
+  shape_inference::ShapeHandle handle = c->output(0);
+  if (!c->FullyDefined(handle)) return false;
+  *shape = TensorShape();
+  for (int i = 0; i < c->Rank(handle); ++i) {
+    if (!shape->AddDimWithStatus(c->Value(c->Dim(handle, i))).ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<Node*> AddNodeOnDevice(NodeBuilder builder,
+                                      const std::string& device,
+                                      Graph* graph) {
+  Node* node;
+  TF_RETURN_IF_ERROR(builder.Finalize(graph, &node));
+  node->set_assigned_device_name(device);
+  return node;
+}
+
+absl::StatusOr<Node*> AddConst(const std::string& name, const Tensor& value,
+                               const std::string& device, Graph* graph) {
+  return AddNodeOnDevice(NodeBuilder(name, "Const")
+                             .Attr("dtype", value.dtype())
+                             .Attr("value", value),
+                         device, graph);
+}
+
+// Replaces the collectives in `bucket` by a single one over the concatenation
+// of their inputs.
+absl::Status FuseBucket(absl::Span<const Candidate> bucket, Graph* graph) {
+  Node* first = bucket.front().node;
+  const std::string& device = first->assigned_device_name();
+  const std::string prefix =
+      graph->NewName(absl::StrCat(first->name(), "/bucket"));
+  const int num_members = bucket.size();
+
+  Tensor flat_shape(DT_INT32, TensorShape({1}));
+  flat_shape.vec<int32>()(0) = -1;
+  TF_ASSIGN_OR_RETURN(
+      Node * flat_shape_node,
+      AddConst(absl::StrCat(prefix, "/flat_shape"), flat_shape, device, graph));
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  TF_ASSIGN_OR_RETURN(Node * axis_node,
+                      AddConst(absl::StrCat(prefix, "/axis"), axis, device,
+                               graph));
+  std::vector<NodeBuilder::NodeOut> flat_inputs;
+  Tensor size_splits(DT_INT64, TensorShape({num_members}));
+  for (int i = 0; i < num_members; ++i) {
+    const Edge* input;
+    TF_RETURN_IF_ERROR(bucket[i].node->input_edge(0, &input));
+    TF_ASSIGN_OR_RETURN(
+        Node * flatten,
+        AddNodeOnDevice(
+            NodeBuilder(absl::StrCat(prefix, "/flatten_", i), "Reshape")
+                .Input(input->src(), input->src_output())
+                .Input(flat_shape_node),
+            device, graph));
+    flat_inputs.emplace_back(flatten);
+    size_splits.vec<int64_t>()(i) = bucket[i].shape.num_elements();
+  }
+  TF_ASSIGN_OR_RETURN(
+      Node * pack,
+      AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/pack"), "ConcatV2")
+                          .Input(flat_inputs)
+                          .Input(axis_node),
+                      device, graph));
+
+  NodeDef reduce_def = first->def();
+  reduce_def.set_name(absl::StrCat(prefix, "/reduce"));
+  reduce_def.clear_input();
+  (*reduce_def.mutable_attr())["instance_key"].set_i(
+      bucket.front().instance_key);
+  (*reduce_def.mutable_attr())["communication_hint"].set_s("auto");
+  TF_ASSIGN_OR_RETURN(Node * reduce, graph->AddNode(std::move(reduce_def)));
+  reduce->set_assigned_device_name(device);
+  graph->AddEdge(pack, 0, reduce, 0);
+
+  TF_ASSIGN_OR_RETURN(Node * size_splits_node,
+                      AddConst(absl::StrCat(prefix, "/size_splits"),
+                               size_splits, device, graph));
+  TF_ASSIGN_OR_RETURN(
+      Node * unpack,
+      AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/unpack"), "SplitV")
+                          .Input(reduce)
+                          .Input(size_splits_node)
+                          .Input(axis_node)
+                          .Attr("num_split", num_members),
+                      device, graph));
+
+  for (int i = 0; i < num_members; ++i) {
+    Node* member = bucket[i].node;
+    const TensorShape& shape = bucket[i].shape;
+    Tensor shape_value(DT_INT64, TensorShape({shape.dims()}));
+    for (int d = 0; d < shape.dims(); ++d) {
+      shape_value.vec<int64_t>()(d) = shape.dim_size(d);
+    }
+    TF_ASSIGN_OR_RETURN(Node * shape_node,
+                        AddConst(absl::StrCat(prefix, "/shape_", i),
+                                 shape_value, device, graph));
+    TF_ASSIGN_OR_RETURN(
+        Node * unflatten,
+        AddNodeOnDevice(
+            NodeBuilder(absl::StrCat(prefix, "/unflatten_", i), "Reshape")
+                .Input(unpack, i)
+                .Input(shape_node),
+            device, graph));
+
+    std::vector<const Edge*> in_edges(member->in_edges().begin(),
+                                      member->in_edges().end());
+    for (const Edge* edge : in_edges) {
+      if (edge->IsControlEdge() && !edge->src()->IsSource()) {
+        graph->AddControlEdge(edge->src(), reduce);
+      }
+    }
+    std::vector<const Edge*> out_edges(member->out_edges().begin(),
+                                       member->out_edges().end());
+    for (const Edge* edge : out_edges) {
+      if (edge->IsControlEdge()) {
+        graph->AddControlEdge(reduce, edge->dst());
+      } else {
+        Node* dst = edge->dst();
+        const int dst_input = edge->dst_input();
+        graph->RemoveEdge(edge);
+        graph->AddEdge(unflatten, 0, dst, dst_input);
+      }
+    }
+    graph->RemoveNode(member);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status CollectiveBucketingPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr) return absl::OkStatus();
+  Graph* graph = options.graph->get();
+
+  bool has_bucket_hint = false;
+  absl::flat_hash_set<int64_t> waited_for_keys;
+  for (const Node* node : graph->op_nodes()) {
+    if (node->IsControlFlow()) {
+      // Members could be dead, or run a different number of times.
+      return absl::OkStatus();
+    }
+    if (node->type_string() != "CollectiveReduce") continue;
+    std::string hint;
+    if (TryGetNodeAttr(node->attrs(), "communication_hint", &hint) &&
+        hint == kBucketHint) {
+      has_bucket_hint = true;
+    }
+    std::vector<int32> wait_for;
+    if (TryGetNodeAttr(node->attrs(), "wait_for", &wait_for)) {
+      waited_for_keys.insert(wait_for.begin(), wait_for.end());
+    }
+  }
+  if (!has_bucket_hint) return absl::OkStatus();
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("before_collective_bucketing_pass", *graph,
+                               options.flib_def);
+  }
+
+  // The maximum number of collectives on any path to each node. Collectives
+  // with the same depth cannot depend on each other, so fusing them cannot
+  // create a cycle.
+  std::vector<int> depth(graph->num_node_ids(), 0);
+  ShapeRefiner refiner(graph->versions(), graph->op_registry());
+  absl::btree_map<BucketKey, std::vector<Candidate>> candidates;
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (Node* node : order) {
+    if (!node->IsOp()) continue;
+    int node_depth = 0;
+    for (const Edge* edge : node->in_edges()) {
+      const Node* src = edge->src();
+      const bool is_collective =
+          src->IsCollective() || src->IsDistributedCommunication();
+      node_depth = std::max(node_depth, depth[src->id()] + is_collective);
+    }
+    depth[node->id()] = node_depth;
+    // A shape inference failure only prevents bucketing the affected ops.
+    refiner.AddNode(node).IgnoreError();
+
+    if (node->type_string() != "CollectiveReduce") continue;
+    std::string hint;
+    int64_t instance_key, group_key, group_size;
+    DataType dtype;
+    std::string merge_op, final_op;
+    std::vector<int32> subdiv_offsets, wait_for;
+    float timeout_seconds;
+    if (!TryGetNodeAttr(node->attrs(), "communication_hint", &hint) ||
+        hint != kBucketHint ||
+        !TryGetNodeAttr(node->attrs(), "instance_key", &instance_key) ||
+        waited_for_keys.contains(instance_key) ||
+        !TryGetNodeAttr(node->attrs(), "wait_for", &wait_for) ||
+        !wait_for.empty() ||
+        !TryGetNodeAttr(node->attrs(), "group_key", &group_key) ||
+        !TryGetNodeAttr(node->attrs(), "group_size", &group_size) ||
+        !TryGetNodeAttr(node->attrs(), "T", &dtype) ||
+        !IsBucketableType(dtype) ||
+        !TryGetNodeAttr(node->attrs(), "merge_op", &merge_op) ||
+        !TryGetNodeAttr(node->attrs(), "final_op", &final_op) ||
+        !TryGetNodeAttr(node->attrs(), "subdiv_offsets", &subdiv_offsets) ||
+        !TryGetNodeAttr(node->attrs(), "timeout_seconds", &timeout_seconds)) {
+      continue;
+    }
+    TensorShape shape;
+    if (!GetStaticShape(refiner, node, &shape) ||
+        shape.num_elements() * DataTypeSize(dtype) > kMaxBucketBytes) {
+      continue;
+    }
+    candidates[{node->assigned_device_name(), group_key, group_size, dtype,
+                merge_op, final_op, subdiv_offsets, timeout_seconds,
+                node_depth}]
+        .push_back({node, instance_key, std::move(shape)});
+  }
+
+  int num_buckets = 0;
+  int num_bucketed = 0;
+  for (auto& [key, group] : candidates) {
+    std::sort(group.begin(), group.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return a.instance_key < b.instance_key;
+              });
+    const int64_t element_size = DataTypeSize(std::get<3>(key));
+    size_t begin = 0;
+    while (begin < group.size()) {
+      size_t end = begin;
+      int64_t bucket_bytes = 0;
+      while (end < group.size() &&
+             bucket_bytes + group[end].shape.num_elements() * element_size <=
+                 kMaxBucketBytes) {
+        bucket_bytes += group[end].shape.num_elements() * element_size;
+        ++end;
+      }
+      if (end - begin >= 2) {
+        TF_RETURN_IF_ERROR(FuseBucket(
+            absl::MakeConstSpan(group).subspan(begin, end - begin), graph));
+        ++num_buckets;
+        num_bucketed += end - begin;
+      }
+      begin = std::max(end, begin + 1);
+    }
+  }
+  VLOG(1) << "collective_bucketing_pass packed " << num_bucketed
+          << " all-reduces into " << num_buckets << " buckets.";
+
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("after_collective_bucketing_pass", *graph,
+                               options.flib_def);
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 45,
+                      CollectiveBucketingPass);
+
+}  // namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+// Small all-reduces that were created with `communication_hint="bucket"` are
+// packed into fusion buffers, so that each bucket runs as a single collective
+// instead of one collective per tensor.
+//
+// For example, the graph:
+//   g0 -> CollectiveReduce(instance_key=3) -> u0
+//   g1 -> CollectiveReduce(instance_key=7) -> u1
+// is rewritten to:
+//   {Reshape(g0), Reshape(g1)} -> ConcatV2 -> CollectiveReduce(instance_key=3)
+//   -> SplitV -> {Reshape -> u0, Reshape -> u1}
+//
+// Only CollectiveReduce ops on the same device with identical group and
+// reduction attributes, statically known shapes, and no data or control path
+// between them are bucketed, in instance key order, up to
+// kMaxBucketBytes per bucket. A bucket uses the smallest instance key of its
+// members. Every member of the group must therefore run the same graph, which
+// is what opting in with the communication hint asserts.
+
+namespace tensorflow {
+
+class CollectiveBucketingPass : public GraphOptimizationPass {
+ public:
+  // Maximum size of a fusion buffer.
+  static constexpr int64_t kMaxBucketBytes = 32 << 20;
+
+  absl::Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_BUCKETING_PASS_H_
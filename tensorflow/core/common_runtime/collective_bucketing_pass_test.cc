@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/collective_bucketing_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const char kDevice[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+Node* GetNode(const Graph& graph, const std::string& name) {
+  for (Node* node : graph.nodes()) {
+    if (node->name() == name) return node;
+  }
+  return nullptr;
+}
+
+Node* GetInput(const Node* node, int index) {
+  const Edge* edge;
+  TF_CHECK_OK(node->input_edge(index, &edge));
+  return edge->src();
+}
+
+std::vector<Node*> GetCollectives(const Graph& graph) {
+  std::vector<Node*> collectives;
+  for (Node* node : graph.op_nodes()) {
+    if (node->type_string() == "CollectiveReduce") collectives.push_back(node);
+  }
+  return collectives;
+}
+
+Node* AddAllReduce(const std::string& name, Output input, int instance_key,
+                   const std::string& hint, Graph* graph) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(name, "CollectiveReduce")
+                  .Input(input.node(), input.index())
+                  .Attr("group_size", 2)
+                  .Attr("group_key", 1)
+                  .Attr("instance_key", instance_key)
+                  .Attr("merge_op", "Add")
+                  .Attr("final_op", "Div")
+                  .Attr("subdiv_offsets", std::vector<int32>{0})
+                  .Attr("communication_hint", hint)
+                  .Finalize(graph, &node));
+  return node;
+}
+
+void AssignDevices(Graph* graph) {
+  for (Node* node : graph->op_nodes()) {
+    node->set_assigned_device_name(kDevice);
+  }
+}
+
+absl::Status RunPass(std::unique_ptr<Graph>* graph) {
+  GraphOptimizationPassOptions options;
+  options.graph = graph;
+  CollectiveBucketingPass pass;
+  return pass.Run(options);
+}
+
+TEST(CollectiveBucketingPassTest, BucketsIndependentAllReduces) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  Output g0 = ops::Const(scope.WithOpName("g0"), {1.0f, 2.0f});
+  Output g1 = ops::Const(scope.WithOpName("g1"), 3.0f, TensorShape({}));
+  Output g2 = ops::Const(scope.WithOpName("g2"), {{4.0f}, {5.0f}});
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  Node* r0 = AddAllReduce("r0", g0, 7, "bucket", graph.get());
+  Node* r1 = AddAllReduce("r1", g1, 3, "bucket", graph.get());
+  Node* r2 = AddAllReduce("r2", g2, 5, "bucket", graph.get());
+  Node* u0;
+  Node* u1;
+  Node* u2;
+  TF_ASSERT_OK(NodeBuilder("u0", "Neg").Input(r0).Finalize(graph.get(), &u0));
+  TF_ASSERT_OK(NodeBuilder("u1", "Neg").Input(r1).Finalize(graph.get(), &u1));
+  TF_ASSERT_OK(NodeBuilder("u2", "Neg").Input(r2).Finalize(graph.get(), &u2));
+  AssignDevices(graph.get());
+
+  TF_ASSERT_OK(RunPass(&graph));
+
+  std::vector<Node*> collectives = GetCollectives(*graph);
+  ASSERT_EQ(collectives.size(), 1);
+  Node* reduce = collectives[0];
+  int64_t instance_key;
+  TF_ASSERT_OK(GetNodeAttr(reduce->attrs(), "instance_key", &instance_key));
+  EXPECT_EQ(instance_key, 3);
+  EXPECT_EQ(GetInput(reduce, 0)->type_string(), "ConcatV2");
+  EXPECT_EQ(reduce->assigned_device_name(), kDevice);
+  for (const char* name : {"u0", "u1", "u2"}) {
+    Node* unflatten = GetInput(GetNode(*graph, name), 0);
+    EXPECT_EQ(unflatten->type_string(), "Reshape");
+    Node* unpack = GetInput(unflatten, 0);
+    EXPECT_EQ(unpack->type_string(), "SplitV");
+    EXPECT_EQ(GetInput(unpack, 0), reduce);
+  }
+  // Members are packed in instance key order.
+  int expected_output = 0;
+  for (const char* name : {"u1", "u2", "u0"}) {
+    const Edge* edge;
+    TF_ASSERT_OK(GetInput(GetNode(*graph, name), 0)->input_edge(0, &edge));
+    EXPECT_EQ(edge->src_output(), expected_output++);
+  }
+}
+
+TEST(CollectiveBucketingPassTest, DoesNotBucketDependentAllReduces) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  Output g0 = ops::Const(scope.WithOpName("g0"), {1.0f, 2.0f});
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  Node* r0 = AddAllReduce("r0", g0, 1, "bucket", graph.get());
+  Node* r1 = AddAllReduce("r1", Output(r0, 0), 2, "bucket", graph.get());
+  AssignDevices(graph.get());
+
+  TF_ASSERT_OK(RunPass(&graph));
+
+  EXPECT_EQ(GetCollectives(*graph).size(), 2);
+  EXPECT_EQ(GetInput(r1, 0), r0);
+}
+
+TEST(CollectiveBucketingPassTest, RequiresBucketHint) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  Output g0 = ops::Const(scope.WithOpName("g0"), {1.0f, 2.0f});
+  Output g1 = ops::Const(scope.WithOpName("g1"), {3.0f, 4.0f});
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  AddAllReduce("r0", g0, 1, "auto", graph.get());
+  AddAllReduce("r1", g1, 2, "bucket", graph.get());
+  AssignDevices(graph.get());
+
+  TF_ASSERT_OK(RunPass(&graph));
+
+  EXPECT_EQ(GetCollectives(*graph).size(), 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
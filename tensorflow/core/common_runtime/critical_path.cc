@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/critical_path.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
+
+namespace tensorflow {
+
+namespace {
+
+struct NodeTiming {
+  std::string device;
+  int64_t start_micros;
+  int64_t end_micros;
+};
+
+bool IsSend(const NodeDef& node) {
+  return node.op() == "_Send" || node.op() == "_HostSend";
+}
+
+bool IsRecv(const NodeDef& node) {
+  return node.op() == "_Recv" || node.op() == "_HostRecv";
+}
+
+// Returns whether `a` should be preferred over `b` as the node that finished
+// last. Ties are broken by name so that the result is deterministic.
+bool FinishedLater(const std::string& a_name, const NodeTiming& a,
+                   const std::string& b_name, const NodeTiming& b) {
+  if (a.end_micros != b.end_micros) return a.end_micros > b.end_micros;
+  return a_name < b_name;
+}
+
+// One execution of a node, identified by its name and its index in the
+// node's executions sorted by end time.
+struct Execution {
+  const std::string* name;
+  const NodeTiming* timing;
+  size_t index;
+};
+
+}  // namespace
+
+CriticalPath ComputeCriticalPath(const StepStats& step_stats,
+                                 const std::vector<const GraphDef*>& graphs) {
+  // All executions of every node (more than one for nodes in loops), sorted
+  // by end time.
+  absl::flat_hash_map<std::string, std::vector<NodeTiming>> timings;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      timings[node_stats.node_name()].push_back(
+          {dev_stats.device(), node_stats.all_start_micros(),
+           node_stats.all_start_micros() + node_stats.all_end_rel_micros()});
+    }
+  }
+  for (auto& [name, executions] : timings) {
+    std::stable_sort(executions.begin(), executions.end(),
+                     [](const NodeTiming& a, const NodeTiming& b) {
+                       return a.end_micros < b.end_micros;
+                     });
+  }
+
+  absl::flat_hash_map<std::string, std::vector<std::string>> inputs;
+  absl::flat_hash_map<std::string, std::string> send_by_tensor_name;
+  std::vector<std::pair<std::string, std::string>> recvs;
+  for (const GraphDef* graph : graphs) {
+    for (const NodeDef& node : graph->node()) {
+      std::vector<std::string>& node_inputs = inputs[node.name()];
+      for (const std::string& input : node.input()) {
+        node_inputs.emplace_back(ParseTensorName(input).node());
+      }
+      const auto tensor_name = node.attr().find("tensor_name");
+      if (tensor_name == node.attr().end()) continue;
+      if (IsSend(node)) {
+        send_by_tensor_name[tensor_name->second.s()] = node.name();
+      } else if (IsRecv(node)) {
+        recvs.emplace_back(node.name(), tensor_name->second.s());
+      }
+    }
+  }
+  // A _Recv completes only after the matching _Send, even though there is no
+  // edge between them in the partition graphs.
+  for (const auto& [recv, tensor_name] : recvs) {
+    const auto send = send_by_tensor_name.find(tensor_name);
+    if (send != send_by_tensor_name.end()) {
+      inputs[recv].push_back(send->second);
+    }
+  }
+
+  CriticalPath path;
+  std::optional<Execution> current;
+  for (const auto& [name, executions] : timings) {
+    if (!current.has_value() ||
+        FinishedLater(name, executions.back(), *current->name,
+                      *current->timing)) {
+      current = Execution{&name, &executions.back(), executions.size() - 1};
+    }
+  }
+
+  // Every execution appears on the path at most once, which guarantees
+  // termination even if executions of a cycle have identical timings.
+  absl::flat_hash_set<std::pair<std::string, size_t>> visited;
+  while (current.has_value()) {
+    visited.emplace(*current->name, current->index);
+    const NodeTiming& current_timing = *current->timing;
+    path.nodes.push_back({*current->name, current_timing.device,
+                          current_timing.start_micros,
+                          current_timing.end_micros, 0});
+
+    std::optional<Execution> next;
+    const auto node_inputs = inputs.find(*current->name);
+    if (node_inputs != inputs.end()) {
+      for (const std::string& input : node_inputs->second) {
+        const auto input_timings = timings.find(input);
+        if (input_timings == timings.end()) continue;
+        const std::vector<NodeTiming>& executions = input_timings->second;
+        // An execution that finished after this one can't be what it waited
+        // for, so pick the last one that finished before (e.g. the previous
+        // iteration of a loop). Note that comparing start times instead would
+        // be wrong: a _Recv is started before its _Send and waits for it
+        // asynchronously.
+        size_t index =
+            std::upper_bound(executions.begin(), executions.end(),
+                             current_timing.end_micros,
+                             [](int64_t end_micros, const NodeTiming& timing) {
+                               return end_micros < timing.end_micros;
+                             }) -
+            executions.begin();
+        while (index > 0 && visited.contains(std::make_pair(
+                                input_timings->first, index - 1))) {
+          --index;
+        }
+        if (index == 0) continue;
+        const NodeTiming& input_timing = executions[index - 1];
+        if (!next.has_value() ||
+            FinishedLater(input, input_timing, *next->name, *next->timing)) {
+          next = Execution{&input_timings->first, &input_timing, index - 1};
+        }
+      }
+    }
+    if (next.has_value()) {
+      path.nodes.back().wait_micros = std::max<int64_t>(
+          0, current_timing.start_micros - next->timing->end_micros);
+    }
+    current = next;
+  }
+
+  std::reverse(path.nodes.begin(), path.nodes.end());
+  if (!path.nodes.empty()) {
+    path.length_micros =
+        path.nodes.back().end_micros - path.nodes.front().start_micros;
+  }
+  for (const CriticalPathNode& node : path.nodes) {
+    path.total_wait_micros += node.wait_micros;
+  }
+  return path;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CRITICAL_PATH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+
+namespace tensorflow {
+
+// A node on the critical path of a step.
+struct CriticalPathNode {
+  std::string node_name;
+  std::string device;
+  int64_t start_micros = 0;
+  int64_t end_micros = 0;
+  // Time between the end of the previous node on the critical path and the
+  // start of this node, e.g. spent waiting in the executor's ready queue.
+  int64_t wait_micros = 0;
+};
+
+struct CriticalPath {
+  // Nodes on the critical path in execution order.
+  std::vector<CriticalPathNode> nodes;
+  // Time from the start of the first to the end of the last node.
+  int64_t length_micros = 0;
+  // Sum of the `wait_micros` of all nodes, i.e. the part of `length_micros`
+  // that no node on the critical path was executing.
+  int64_t total_wait_micros = 0;
+};
+
+// Extracts the chain of nodes that bounds the duration of a step from the
+// node timings in `step_stats` (as collected by StepStatsCollector) and the
+// dependencies in `graphs` (e.g. the partition graphs in RunMetadata).
+//
+// Starting from the node that finished last, the path is built backwards by
+// following, for every node, the input (data, control, or the matching _Send
+// of a _Recv) that finished last, i.e. the one the node was waiting for.
+// Nodes without timings are ignored. If a node was executed more than once
+// (e.g. in a loop), each execution is a separate instance on the path and an
+// input's instance is the last one that finished before the node's, so a path
+// through a loop covers all of its iterations.
+CriticalPath ComputeCriticalPath(const StepStats& step_stats,
+                                 const std::vector<const GraphDef*>& graphs);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CRITICAL_PATH_H_
@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/critical_path.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+NodeDef* AddNode(GraphDef* graph, const std::string& name,
+                 const std::string& op,
+                 const std::vector<std::string>& inputs) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  for (const std::string& input : inputs) {
+    node->add_input(input);
+  }
+  return node;
+}
+
+void AddTiming(DeviceStepStats* dev_stats, const std::string& name,
+               int64_t start_micros, int64_t end_micros) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_start_micros(start_micros);
+  node_stats->set_all_end_rel_micros(end_micros - start_micros);
+}
+
+std::vector<std::string> NodeNames(const CriticalPath& path) {
+  std::vector<std::string> names;
+  for (const CriticalPathNode& node : path.nodes) {
+    names.push_back(node.node_name);
+  }
+  return names;
+}
+
+TEST(CriticalPathTest, FollowsLastFinishedInput) {
+  GraphDef graph;
+  AddNode(&graph, "a", "Const", {});
+  AddNode(&graph, "b", "Identity", {"a"});
+  AddNode(&graph, "c", "Identity", {"a:0"});
+  AddNode(&graph, "d", "Add", {"b", "^c"});
+
+  StepStats step_stats;
+  DeviceStepStats* cpu0 = step_stats.add_dev_stats();
+  cpu0->set_device("/device:CPU:0");
+  AddTiming(cpu0, "a", 0, 10);
+  AddTiming(cpu0, "b", 12, 20);
+  AddTiming(cpu0, "d", 45, 50);
+  DeviceStepStats* cpu1 = step_stats.add_dev_stats();
+  cpu1->set_device("/device:CPU:1");
+  AddTiming(cpu1, "c", 11, 40);
+
+  const CriticalPath path = ComputeCriticalPath(step_stats, {&graph});
+  EXPECT_EQ(NodeNames(path), std::vector<std::string>({"a", "c", "d"}));
+  EXPECT_EQ(path.nodes[1].device, "/device:CPU:1");
+  EXPECT_EQ(path.nodes[0].wait_micros, 0);
+  EXPECT_EQ(path.nodes[1].wait_micros, 1);
+  EXPECT_EQ(path.nodes[2].wait_micros, 5);
+  EXPECT_EQ(path.length_micros, 50);
+  EXPECT_EQ(path.total_wait_micros, 6);
+}
+
+TEST(CriticalPathTest, FollowsSendRecvAcrossPartitions) {
+  GraphDef partition0;
+  AddNode(&partition0, "x", "Const", {});
+  AddNode(&partition0, "send", "_Send", {"x"});
+  (*partition0.mutable_node(1)->mutable_attr())["tensor_name"].set_s(
+      "edge_1_x");
+  GraphDef partition1;
+  AddNode(&partition1, "other", "Const", {});
+  NodeDef* recv = AddNode(&partition1, "recv", "_Recv", {});
+  (*recv->mutable_attr())["tensor_name"].set_s("edge_1_x");
+  AddNode(&partition1, "y", "Add", {"recv", "other"});
+
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  AddTiming(dev_stats, "x", 0, 5);
+  AddTiming(dev_stats, "send", 5, 6);
+  AddTiming(dev_stats, "other", 0, 1);
+  // The _Recv is started before the _Send and completes after it.
+  AddTiming(dev_stats, "recv", 2, 8);
+  AddTiming(dev_stats, "y", 9, 12);
+
+  const CriticalPath path =
+      ComputeCriticalPath(step_stats, {&partition0, &partition1});
+  EXPECT_EQ(NodeNames(path),
+            std::vector<std::string>({"x", "send", "recv", "y"}));
+  EXPECT_EQ(path.length_micros, 12);
+}
+
+TEST(CriticalPathTest, FollowsLoopIterations) {
+  GraphDef graph;
+  AddNode(&graph, "enter", "Enter", {});
+  AddNode(&graph, "merge", "Merge", {"enter", "next_iteration"});
+  AddNode(&graph, "next_iteration", "NextIteration", {"merge"});
+
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  AddTiming(dev_stats, "enter", 0, 1);
+  AddTiming(dev_stats, "merge", 2, 3);
+  AddTiming(dev_stats, "next_iteration", 3, 4);
+  AddTiming(dev_stats, "merge", 5, 6);
+  AddTiming(dev_stats, "next_iteration", 6, 7);
+  AddTiming(dev_stats, "merge", 8, 9);
+
+  const CriticalPath path = ComputeCriticalPath(step_stats, {&graph});
+  EXPECT_EQ(NodeNames(path),
+            std::vector<std::string>({"enter", "merge", "next_iteration",
+                                      "merge", "next_iteration", "merge"}));
+  EXPECT_EQ(path.nodes[1].start_micros, 2);
+  EXPECT_EQ(path.nodes[3].start_micros, 5);
+  EXPECT_EQ(path.length_micros, 9);
+  EXPECT_EQ(path.total_wait_micros, 3);
+}
+
+TEST(CriticalPathTest, TerminatesOnCycles) {
+  GraphDef graph;
+  AddNode(&graph, "a", "Merge", {"b"});
+  AddNode(&graph, "b", "NextIteration", {"a"});
+
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  AddTiming(dev_stats, "a", 0, 0);
+  AddTiming(dev_stats, "b", 0, 0);
+
+  const CriticalPath path = ComputeCriticalPath(step_stats, {&graph});
+  EXPECT_EQ(NodeNames(path), std::vector<std::string>({"b", "a"}));
+}
+
+TEST(CriticalPathTest, EmptyStepStats) {
+  GraphDef graph;
+  AddNode(&graph, "a", "Const", {});
+  const CriticalPath path = ComputeCriticalPath(StepStats(), {&graph});
+  EXPECT_TRUE(path.nodes.empty());
+  EXPECT_EQ(path.length_micros, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -102,11 +103,19 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
                                       : 10),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                 /*default_val=*/false, &use_host_callbacks_));
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(host_callbacks_mu_);
+    while (pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
 
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
@@ -168,6 +177,35 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+bool EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()>* func) {
+  auto callback = std::make_shared<std::function<void()>>(std::move(*func));
+  {
+    mutex_lock l(host_callbacks_mu_);
+    ++pending_host_callbacks_;
+  }
+  // The host callback runs on a driver thread that must not call back into
+  // the driver, so it only hands `func` over to threadpool_.
+  absl::Status s = stream->DoHostCallback([this, callback]() {
+    threadpool_.Schedule(std::move(*callback));
+    mutex_lock l(host_callbacks_mu_);
+    if (--pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+  if (s.ok()) return true;
+
+  VLOG(1) << "Falling back to polled events: " << s;
+  {
+    mutex_lock l(host_callbacks_mu_);
+    if (--pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  }
+  *func = std::move(*callback);
+  return false;
+}
+
 void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   VLOG(2) << "EnqueueCallback with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
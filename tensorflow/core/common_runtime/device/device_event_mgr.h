@@ -68,6 +68,7 @@ class EventMgr {
   // be brief and non-blocking since it executes in the one thread used for all
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_ && EnqueueHostCallback(stream, &func)) return;
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -103,6 +104,12 @@ class EventMgr {
     }
   }
 
+  // Sets up `*func` to be scheduled on threadpool_ by a host callback
+  // enqueued on `stream`, which the device runs as soon as the work before it
+  // completes, without waiting for the polling loop. Returns false and leaves
+  // `*func` untouched if the stream does not accept host callbacks.
+  bool EnqueueHostCallback(se::Stream* stream, std::function<void()>* func);
+
   // Set up `func` to be called once `stream` completes all its outstanding
   // work.
   void EnqueueCallback(se::Stream* stream, std::function<void()> func)
@@ -136,6 +143,17 @@ class EventMgr {
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
+  // Whether ThenExecute uses host callbacks instead of polled events, set by
+  // the TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS environment variable.
+  bool use_host_callbacks_ = false;
+
+  // Host callbacks that have been enqueued but have not run yet. Guarded by
+  // its own mutex, since host callbacks must not wait for threads that may be
+  // blocked in the driver while holding mu_.
+  mutex host_callbacks_mu_;
+  condition_variable host_callbacks_done_;
+  int64_t pending_host_callbacks_ TF_GUARDED_BY(host_callbacks_mu_) = 0;
+
   // The main PollLoop for the event manager runs in this threadpool.
   thread::ThreadPool threadpool_;
 };
@@ -138,6 +138,27 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that callbacks run when completion is signaled by host callbacks
+// instead of the polling loop.
+TEST(EventMgr, HostCallbacks) {
+  setenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS", "1", 1);
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  unsetenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS");
+  TEST_EventMgrHelper th(&em);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  std::atomic_int count(0);
+  Notification note;
+  for (int i = 0; i < 5; ++i) {
+    em.ThenExecute(stream.get(), [&count, &note]() {
+      if (++count == 5) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  EXPECT_EQ(5, count);
+  EXPECT_EQ(0, th.queue_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
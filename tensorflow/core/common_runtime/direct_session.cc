@@ -20,12 +20,14 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
+#include "tensorflow/core/common_runtime/critical_path.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -52,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
@@ -385,6 +389,13 @@ DirectSession::DirectSession(const SessionOptions& options,
     device_set_.AddDevice(d);
     d->op_segment()->AddHold(session_handle_);
   }
+  const int64_t step_arena_max_bytes =
+      options_.config.experimental().step_arena_allocator_max_bytes();
+  if (step_arena_max_bytes > 0 && device_mgr_->HostCPU() != nullptr) {
+    step_arena_pool_ = std::make_unique<StepArenaPool>(
+        device_mgr_->HostCPU()->GetAllocator(AllocatorAttributes()),
+        step_arena_max_bytes);
+  }
 }
 
 DirectSession::~DirectSession() {
@@ -696,6 +707,13 @@ absl::Status DirectSession::RunInternal(
     args.stats_collector = run_state.collector.get();
   }
 
+  // The step arena is skipped when collecting step stats, so that the
+  // allocations of the step are reported against the device allocators.
+  core::RefCountPtr<StepArenaAllocator> step_arena;
+  if (step_arena_pool_ != nullptr && run_state.collector == nullptr) {
+    step_arena = step_arena_pool_->Acquire();
+  }
+
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
     device_profiler_session = DeviceProfilerSession::Create();
@@ -712,8 +730,8 @@ absl::Status DirectSession::RunInternal(
   absl::Status run_status;
 
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [&default_runner, &handler, &step_arena](
+          const PerPartitionExecutorsAndLib& item, Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
@@ -733,6 +751,14 @@ absl::Status DirectSession::RunInternal(
           args->user_intra_op_threadpool =
               handler->AsIntraThreadPoolInterface();
         }
+        // Only executors whose device allocates from the arena's base
+        // allocator, i.e. host CPU executors, use the step arena.
+        args->step_allocator =
+            step_arena != nullptr &&
+                    item.device->GetAllocator(AllocatorAttributes()) ==
+                        step_arena->base()
+                ? step_arena.get()
+                : nullptr;
       };
 
   if (can_execute_synchronously) {
@@ -772,6 +798,11 @@ absl::Status DirectSession::RunInternal(
     }
   }
 
+  // All executors are done, so the arena can be recycled for another step.
+  if (step_arena != nullptr) {
+    step_arena_pool_->Release(std::move(step_arena));
+  }
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
@@ -835,6 +866,27 @@ absl::Status DirectSession::RunInternal(
       }
     }
   }
+
+  // Log the critical path of traced steps.
+  if (do_trace && run_metadata != nullptr && VLOG_IS_ON(1)) {
+    std::vector<GraphDef> graph_defs(executors_and_keys->items.size());
+    std::vector<const GraphDef*> graphs;
+    graphs.reserve(graph_defs.size());
+    for (size_t i = 0; i < graph_defs.size(); ++i) {
+      executors_and_keys->items[i].graph->ToGraphDef(&graph_defs[i]);
+      graphs.push_back(&graph_defs[i]);
+    }
+    const CriticalPath path =
+        ComputeCriticalPath(run_metadata->step_stats(), graphs);
+    VLOG(1) << "Critical path of step " << step_id << ": "
+            << path.nodes.size() << " nodes, " << path.length_micros
+            << "us, " << path.total_wait_micros << "us waiting";
+    for (const CriticalPathNode& node : path.nodes) {
+      VLOG(2) << "  " << node.node_name << " on " << node.device << ": "
+              << (node.end_micros - node.start_micros) << "us after waiting "
+              << node.wait_micros << "us";
+    }
+  }
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
   return absl::OkStatus();
@@ -1439,11 +1491,20 @@ absl::Status DirectSession::CreateExecutors(
                                          device->name(),
                                          partition_graph.get()));
 
+    // Nodes that were already measured as part of another signature start
+    // out with their measured cost rather than being assumed expensive.
+    std::unique_ptr<CostModel> seed_cost_model;
+    if (options_.config.graph_options().build_cost_model() > 0) {
+      seed_cost_model = CreateSeedCostModel(*partition_graph, device->name());
+      params.cost_model = seed_cost_model.get();
+    }
+
     item->executor = nullptr;
     item->device = device;
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    params.cost_model = nullptr;
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1488,6 +1549,43 @@ absl::Status DirectSession::CreateExecutors(
   return absl::OkStatus();
 }
 
+std::unique_ptr<CostModel> DirectSession::CreateSeedCostModel(
+    const Graph& graph, const string& device_name) {
+  absl::flat_hash_map<absl::string_view, const Node*> nodes_by_name;
+  for (const Node* n : graph.op_nodes()) {
+    nodes_by_name[n->name()] = n;
+  }
+  auto seed_cost_model = std::make_unique<CostModel>(/*is_global=*/false);
+  seed_cost_model->InitFromGraph(graph);
+
+  // Cost models are built under `executor_lock_`, and only the graphs of
+  // live executors are guaranteed to outlive this call.
+  mutex_lock l(executor_lock_);
+  CostModelManager::CostModelMap cost_models;
+  cost_model_manager_.ExportCostModels(&cost_models);
+  for (const auto& entry : executors_) {
+    for (const PerPartitionExecutorsAndLib& partition : entry.second->items) {
+      if (partition.graph == nullptr ||
+          partition.device->name() != device_name) {
+        continue;
+      }
+      auto it = cost_models.find(partition.graph.get());
+      if (it == cost_models.end()) continue;
+      const CostModel& measured = *it->second;
+      for (const Node* n : partition.graph->op_nodes()) {
+        auto node_it = nodes_by_name.find(n->name());
+        if (node_it == nodes_by_name.end() || measured.TotalCount(n) <= 0 ||
+            seed_cost_model->TotalCount(node_it->second) > 0) {
+          continue;
+        }
+        seed_cost_model->RecordCount(node_it->second, measured.TotalCount(n));
+        seed_cost_model->RecordTime(node_it->second, measured.TotalTime(n));
+      }
+    }
+  }
+  return seed_cost_model;
+}
+
 absl::Status DirectSession::GetOrCreateExecutors(
     absl::Span<const string> inputs, absl::Span<const string> outputs,
     absl::Span<const string> target_nodes,
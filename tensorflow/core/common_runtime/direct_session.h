@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -254,6 +255,14 @@ class DirectSession : public Session {
       std::unique_ptr<FunctionInfo>* out_func_info,
       RunStateArgs* run_state_args);
 
+  // Returns a cost model for `graph`, which will run on `device_name`, that
+  // holds the execution times measured for same-named nodes of the partition
+  // graphs of earlier signatures on that device. Used to seed the kernel cost
+  // estimates of new executors when `build_cost_model` is enabled.
+  std::unique_ptr<CostModel> CreateSeedCostModel(const Graph& graph,
+                                                 const string& device_name)
+      TF_LOCKS_EXCLUDED(executor_lock_);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -404,6 +413,10 @@ class DirectSession : public Session {
   // library; it copies and modifies the function library.
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
 
+  // Provides the per-step arenas for host intermediate tensors, if
+  // `ConfigProto.Experimental.step_arena_allocator_max_bytes` is set.
+  std::unique_ptr<StepArenaPool> step_arena_pool_;
+
   // true if the Session has been Closed.
   mutex closed_lock_;
   bool closed_ TF_GUARDED_BY(closed_lock_) = false;
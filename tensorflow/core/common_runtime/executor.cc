@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -31,11 +32,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/kernel_stats.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -145,13 +149,34 @@ struct KernelTimer {
 typedef absl::InlinedVector<TensorValue, 4UL> TensorValueVec;
 typedef absl::InlinedVector<AllocatorAttributes, 4UL> AllocatorAttributeVec;
 
+// The worker of a `WorkStealingQueue` that the current thread is running, if
+// any.
+struct WorkStealingWorker {
+  const void* queues = nullptr;
+  int id = -1;
+};
+
+WorkStealingWorker& CurrentWorkStealingWorker() {
+  static thread_local WorkStealingWorker worker;
+  return worker;
+}
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `work_stealing` is true, the ready nodes of each step are scheduled
+  // through per-worker deques with work stealing instead of one closure per
+  // expensive node.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   absl::Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (immutable_state_.params().cost_model != nullptr) {
+      kernel_stats_.SeedCostEstimates(graph,
+                                      *immutable_state_.params().cost_model);
+    }
     return absl::OkStatus();
   }
 
@@ -161,70 +186,9 @@ class ExecutorImpl : public Executor {
   template <class PropagatorStateType>
   friend class ExecutorState;
 
-  // Stores execution time information about the kernels in an executor's graph.
-  class KernelStats {
-   public:
-    KernelStats() = default;
-
-    void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
-      cost_estimates_ =
-          std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
-      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
-        }
-      }
-    }
-
-    // Returns true iff the given node is considered "expensive". The
-    // executor uses this flag to optimize graph execution, for example
-    // by "inlining" inexpensive kernels.
-    bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
-    }
-
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
-    }
-
-    // Updates the dynamic cost estimate, which is used to determine whether the
-    // given node is expensive. The new cost estimate is a weighted average of
-    // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
-    void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
-      // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
-      // updates may result in one or more updates being ignored.  This does not
-      // affect correctness but may slow down the update frequency.
-      std::atomic_uint_fast64_t& cost_estimate = cost_estimates_[node.node_id];
-      auto prev_estimate = cost_estimate.load(std::memory_order_relaxed);
-
-      uint64 new_estimate =
-          ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
-
-      cost_estimate.store(new_estimate, std::memory_order_relaxed);
-    }
-
-   private:
-    // Initial time (in CPU cycles) we expect an operation to take.  Used to
-    // determine whether an operation should be place in a threadpool.
-    // Operations start out "expensive".
-    static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
-    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
-    static constexpr uint64 kCostDecay = 10;
-
-    std::vector<bool> is_expensive_;
-    // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
-    std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
-  };
-
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const bool work_stealing_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +248,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                KernelStats* kernel_stats_,
+                bool work_stealing = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -298,6 +263,13 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // A ready node waiting in `work_queues_`.
+  struct ScheduledNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+  typedef WorkStealingQueue<ScheduledNode> WorkQueues;
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -341,6 +313,32 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Returns true if `tagged_node`, whose node is `item`, is expected to be
+  // expensive for the sizes of its current inputs.
+  bool IsExpensive(const TaggedNode& tagged_node, const NodeItem& item) {
+    return kernel_stats_->HasExpensiveMarker(item) &&
+           kernel_stats_->IsExpensive(
+               item,
+               KernelStats::ShapeBucket(
+                   propagator_.GetInputTensors(tagged_node), item.num_inputs));
+  }
+
+  // Pushes the nodes in [begin, end) onto `work_queues_` and wakes up an idle
+  // worker for each of them. If the current thread is a worker of this step,
+  // the nodes go to the back of its own deque, so that it continues with them
+  // once its inline nodes are done.
+  //
+  // REQUIRES: `work_queues_ != nullptr`.
+  template <typename Iter>
+  void PushWorkStealing(Iter begin, Iter end, int64_t scheduled_nsec);
+
+  // Runs nodes from `queues` as `worker` until every deque is empty. `state`
+  // is only dereferenced while one of its nodes is being processed, because
+  // the step may finish, and `state` be deleted, as soon as it runs out of
+  // nodes.
+  static void RunWorker(ExecutorState* state,
+                        std::shared_ptr<WorkQueues> queues, int worker);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -390,16 +388,23 @@ class ExecutorState {
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
-  ExecutorImpl::KernelStats* const kernel_stats_;
+  KernelStats* const kernel_stats_;
   CancellationManager* cancellation_manager_;
   tsl::CoordinationServiceAgent* coordination_service_agent_;
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
   Executor::Args::Runner runner_;
+  // Not owned. See `Executor::Args::step_allocator`.
+  Allocator* const step_allocator_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // Not null iff the ready nodes of this step are scheduled through
+  // per-worker deques with work stealing. Shared with the workers, which may
+  // outlive this state.
+  std::shared_ptr<WorkQueues> work_queues_;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -420,7 +425,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    KernelStats* kernel_stats, bool work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -447,6 +452,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       coordination_service_agent_(args.coordination_service_agent),
       stack_trace_(args.stack_trace),
       runner_(args.runner),
+      step_allocator_(args.step_allocator),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
@@ -456,6 +462,14 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (work_stealing && !run_all_kernels_inline_) {
+    const int num_workers =
+        session_config_ != nullptr &&
+                session_config_->inter_op_parallelism_threads() > 0
+            ? session_config_->inter_op_parallelism_threads()
+            : port::MaxParallelism();
+    work_queues_ = std::make_shared<WorkQueues>(num_workers);
+  }
 }
 
 template <class PropagatorStateType>
@@ -593,7 +607,11 @@ absl::Status ExecutorState<PropagatorStateType>::ProcessSync(
 
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
-  const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const bool has_expensive_marker = kernel_stats_->HasExpensiveMarker(item);
+  const int shape_bucket =
+      has_expensive_marker ? KernelStats::ShapeBucket(params->inputs) : 0;
+  const bool is_expensive =
+      has_expensive_marker && kernel_stats_->IsExpensive(item, shape_bucket);
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tsl::tracing::ScopedRegion region(tsl::tracing::EventCategory::kCompute,
@@ -605,7 +623,7 @@ absl::Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         tsl::profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (has_expensive_marker) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
@@ -614,7 +632,8 @@ absl::Status ExecutorState<PropagatorStateType>::ProcessSync(
     constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
     if (is_expensive ||
         timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
-      kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
+      kernel_stats_->UpdateCostEstimate(item, shape_bucket,
+                                        timer.ElapsedCycles());
     }
   } else {
     device->Compute(op_kernel, &ctx);
@@ -914,6 +933,8 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       // Set up compute params.
       params->op_kernel = item.kernel;
+      params->step_allocator =
+          item.outputs_are_step_local ? step_allocator_ : nullptr;
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
@@ -1113,6 +1134,16 @@ absl::Status ExecutorState<PropagatorStateType>::ProcessOutputs(
                 "to RunOptions for current allocation info. This isn't "
                 "available when running in Eager mode.\n"));
       }
+      if (immutable_state_.params().device->device_type() == DEVICE_GPU) {
+        s = errors::CreateWithUpdatedMessage(
+            s, strings::StrCat(
+                   s.message(),
+                   "\nHint: To run steps whose peak memory exceeds GPU "
+                   "memory, set GPUOptions.experimental.use_unified_memory "
+                   "to oversubscribe GPU memory, or set the grappler "
+                   "memory_optimization to SWAPPING_HEURISTICS to swap "
+                   "tensors to host memory.\n"));
+      }
     } else if (s.code() == error::UNAVAILABLE &&
                !item.is_distributed_communication) {
       s = errors::ReplaceErrorFromNonCommunicationOps(s, item.kernel->name());
@@ -1302,7 +1333,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && work_queues_ != nullptr) {
+      PushWorkStealing(ready->begin(), ready->end(), scheduled_nsec);
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
@@ -1311,7 +1344,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     } else {
       for (auto& tagged_node : *ready) {
         const NodeItem& item = *tagged_node.node_item;
-        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        if (tagged_node.get_is_dead() || !IsExpensive(tagged_node, item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
         } else {
@@ -1332,7 +1365,12 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (work_queues_ != nullptr) {
+        // Pushing onto the deques is cheap, so there is no need to fan out
+        // large batches through child threads: idle workers steal them.
+        PushWorkStealing(expensive_nodes.begin(), expensive_nodes.end(),
+                         scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
@@ -1376,6 +1414,52 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+template <typename Iter>
+void ExecutorState<PropagatorStateType>::PushWorkStealing(
+    Iter begin, Iter end, int64_t scheduled_nsec) {
+  const WorkStealingWorker& current = CurrentWorkStealingWorker();
+  const bool is_worker = current.queues == work_queues_.get();
+  size_t num_pushed = 0;
+  for (Iter it = begin; it != end; ++it) {
+    ScheduledNode node{*it, scheduled_nsec};
+    if (is_worker) {
+      work_queues_->Push(current.id, std::move(node));
+    } else {
+      work_queues_->PushAny(std::move(node));
+    }
+    ++num_pushed;
+  }
+  for (size_t i = 0; i < num_pushed; ++i) {
+    const int worker = work_queues_->TryAcquireWorker();
+    if (worker < 0) break;
+    RunTask([this, queues = work_queues_, worker]() {
+      RunWorker(this, queues, worker);
+    });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(
+    ExecutorState* state, std::shared_ptr<WorkQueues> queues, int worker) {
+  WorkStealingWorker& current = CurrentWorkStealingWorker();
+  const WorkStealingWorker saved = current;
+  current.queues = queues.get();
+  while (true) {
+    current.id = worker;
+    while (std::optional<ScheduledNode> node = queues->Pop(worker)) {
+      state->Process(node->tagged_node, node->scheduled_nsec);
+    }
+    queues->ReleaseWorker(worker);
+    // A node pushed after the last `Pop()` but before `ReleaseWorker()` may
+    // not have found an idle worker to wake up, so check again.
+    if (queues->empty()) break;
+    worker = queues->TryAcquireWorker();
+    if (worker < 0) break;
+  }
+  current = saved;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1516,14 +1600,15 @@ void ExecutorState<PropagatorStateType>::Finish() {
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+                                               &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1579,6 +1664,31 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor type, which runs graphs like the
+// default executor but schedules the ready nodes of a step through per-worker
+// deques. A worker continues with the successors of the nodes it ran, and
+// idle workers steal from the other workers' deques.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    absl::Status NewExecutor(const LocalExecutorParams& params,
+                             const Graph& graph,
+                             std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<ExecutorImpl>(params,
+                                                 /*work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
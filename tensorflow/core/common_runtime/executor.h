@@ -125,6 +125,11 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If not null, kernels whose outputs cannot outlive the step (see
+    // `NodeItem::outputs_are_step_local`) allocate from this allocator, e.g. a
+    // `StepArenaAllocator` that the caller resets after the step. Not owned.
+    Allocator* step_allocator = nullptr;
   };
   typedef std::function<void(const absl::Status&)> DoneCallback;
 
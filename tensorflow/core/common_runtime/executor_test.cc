@@ -25,8 +25,11 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/kernel_stats.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
@@ -38,11 +41,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -76,11 +81,14 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. An empty
+  // `executor_type` creates the default local executor.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.cost_model = cost_model_;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -92,7 +100,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> executor;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+      exec_ = executor.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -111,6 +125,7 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  const CostModel* cost_model_ = nullptr;
 };
 
 // A float val -> Tensor<float>
@@ -265,6 +280,103 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, SeedCostEstimatesFromCostModel) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(1024, g.get());
+  // Pretend that a previous run measured every node as cheap, and one node as
+  // expensive.
+  CostModel cost_model(/*is_global=*/false);
+  cost_model.InitFromGraph(*g);
+  bool first = true;
+  for (const Node* n : g->op_nodes()) {
+    cost_model.RecordCount(n, 1);
+    cost_model.RecordTime(n, Microseconds(first ? 1000 : 1));
+    first = false;
+  }
+  cost_model_ = &cost_model;
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1024.0, V(out));
+}
+
+TEST_F(ExecutorTest, KernelStatsSeededFromCostModel) {
+  const double micros_per_cycle =
+      profile_utils::CpuUtils::GetMicroSecPerClock();
+  if (!(micros_per_cycle > 0)) GTEST_SKIP() << "Unknown CPU frequency";
+
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, V(1.0));
+  Node* b = test::graph::Constant(&g, V(2.0));
+  Node* cheap = test::graph::Add(&g, a, b);
+  Node* expensive = test::graph::Add(&g, a, b);
+  Node* unmeasured = test::graph::Add(&g, a, b);
+  CostModel cost_model(/*is_global=*/false);
+  cost_model.InitFromGraph(g);
+  cost_model.RecordCount(cheap, 1);
+  cost_model.RecordTime(cheap, Microseconds(1));
+  cost_model.RecordCount(expensive, 2);
+  cost_model.RecordTime(expensive, Microseconds(2000));
+
+  GraphView gview;
+  TF_ASSERT_OK(gview.Initialize(&g));
+  std::vector<std::unique_ptr<OpKernel>> kernels;
+  for (const Node* n : g.op_nodes()) {
+    OpKernel* kernel = nullptr;
+    TF_ASSERT_OK(CreateNonCachedKernel(device_.get(), nullptr, n->properties(),
+                                       g.versions().producer(), &kernel));
+    kernels.emplace_back(kernel);
+    gview.node(n->id())->kernel = kernel;
+  }
+  KernelStats kernel_stats;
+  kernel_stats.Initialize(gview);
+  kernel_stats.SeedCostEstimates(g, cost_model);
+
+  const NodeItem& cheap_item = *gview.node(cheap->id());
+  const NodeItem& expensive_item = *gview.node(expensive->id());
+  const NodeItem& unmeasured_item = *gview.node(unmeasured->id());
+  const uint64 initial_estimate = kernel_stats.CostEstimate(unmeasured_item, 0);
+  EXPECT_FALSE(kernel_stats.HasExpensiveMarker(*gview.node(a->id())));
+  for (int bucket = 0; bucket < KernelStats::kNumShapeBuckets; ++bucket) {
+    // Measured nodes start at their average time, converted to cycles.
+    EXPECT_EQ(kernel_stats.CostEstimate(cheap_item, bucket),
+              static_cast<uint64>(1 / micros_per_cycle));
+    EXPECT_FALSE(kernel_stats.IsExpensive(cheap_item, bucket));
+    EXPECT_EQ(kernel_stats.CostEstimate(expensive_item, bucket),
+              static_cast<uint64>(1000 / micros_per_cycle));
+    EXPECT_TRUE(kernel_stats.IsExpensive(expensive_item, bucket));
+    // Unmeasured nodes keep the initial estimate and are assumed expensive.
+    EXPECT_EQ(kernel_stats.CostEstimate(unmeasured_item, bucket),
+              initial_estimate);
+    EXPECT_TRUE(kernel_stats.IsExpensive(unmeasured_item, bucket));
+  }
+  EXPECT_GT(initial_estimate,
+            kernel_stats.CostEstimate(expensive_item, /*shape_bucket=*/0));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 
+#include <atomic>
 #include <deque>
 #include <utility>
 #include <vector>
@@ -418,7 +419,9 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
   // The instantiated and transformed function is encoded as a Graph
   // object, and an executor is created for the graph.
   struct Item {
-    uint64 instantiation_counter = 0;
+    // Incremented under a shared lock of `mu_` when an instantiation hits the
+    // cache, decremented under an exclusive lock on release.
+    std::atomic<uint64> instantiation_counter{0};
     std::unique_ptr<const Graph> graph = nullptr;
     const FunctionLibraryDefinition* lib_def = nullptr;  // Not owned.
     FunctionBody* func_graph = nullptr;
@@ -779,7 +782,10 @@ absl::Status FunctionLibraryRuntimeImpl::Instantiate(
   const string key = Canonicalize(function_name, attrs, options_copy);
 
   {
-    mutex_lock l(mu_);
+    // Instantiating an already instantiated function only bumps the
+    // (atomic) instantiation counter, so a shared lock suffices and
+    // concurrent lookups do not serialize.
+    tf_shared_lock l(mu_);
     *handle = parent_->GetHandle(key);
     if (*handle != kInvalidHandle) {
       FunctionLibraryRuntime::LocalHandle handle_on_device =
@@ -885,8 +891,7 @@ absl::Status FunctionLibraryRuntimeImpl::ReleaseHandle(Handle handle) {
           h, " but found none");
     }
     std::unique_ptr<Item>& item = it->second;
-    --item->instantiation_counter;
-    if (item->instantiation_counter == 0) {
+    if (--item->instantiation_counter == 0) {
       // We don't simply erase h's item because that would trigger
       // item destruction while holding mu_. Item destruction can
       // trigger graph destruction. If the graph contains kernels like
@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/strings/numbers.h"
 #include "xla/tsl/framework/bfc_allocator.h"
 #include "xla/tsl/platform/logging.h"
 
@@ -80,6 +82,21 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+size_t GetChunkCacheBytesValue() {
+  const char* chunk_cache_bytes = std::getenv("TF_GPU_BFC_CHUNK_CACHE_BYTES");
+  if (chunk_cache_bytes == nullptr) {
+    return 0;
+  }
+  uint64_t value;
+  if (absl::SimpleAtoi(chunk_cache_bytes, &value)) {
+    return value;
+  }
+  LOG(ERROR) << "The TF_GPU_BFC_CHUNK_CACHE_BYTES environment variable is set"
+             << " but could not be parsed: \"" << chunk_cache_bytes << "\"."
+             << " Disabling the chunk caches.";
+  return 0;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(
@@ -95,6 +112,8 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.chunk_cache_bytes =
+            opts.chunk_cache_bytes.value_or(GetChunkCacheBytesValue());
         return o;
       }()) {}
 
@@ -46,6 +46,10 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+
+    // If nullopt, defaults to TF_GPU_BFC_CHUNK_CACHE_BYTES, or 0 (no chunk
+    // caches) if that envvar is not present.
+    std::optional<size_t> chunk_cache_bytes;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
@@ -232,6 +232,118 @@ TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST_P(GPUBFCAllocatorTest, ChunkCacheReusesFreedChunks) {
+  GPUBFCAllocator::Options opts;
+  opts.chunk_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  void* first_ptr = a.AllocateRaw(1, 1000);
+  a.DeallocateRaw(first_ptr);
+  // The freed chunk is cached, so it still counts as in use.
+  CheckStats(&a, 1, 1024, 1024, 1024);
+
+  // An allocation of the same bin reuses it without going to the bins.
+  void* second_ptr = a.AllocateRaw(1, 800);
+  EXPECT_EQ(first_ptr, second_ptr);
+  CheckStats(&a, 1, 1024, 1024, 1024);
+  a.DeallocateRaw(second_ptr);
+
+  // Chunks of larger bins are never cached.
+  const size_t large_size = 4 * BFCAllocator::kMaxCachedBinSize;
+  void* large_ptr = a.AllocateRaw(1, large_size);
+  a.DeallocateRaw(large_ptr);
+  CheckStats(&a, 2, 1024, 1024 + large_size, large_size);
+}
+
+TEST_P(GPUBFCAllocatorTest, ChunkCacheFlushesUnderMemoryPressure) {
+  GPUBFCAllocator::Options opts;
+  opts.chunk_cache_bytes = 4 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", opts);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 256 << 10));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  // The cached chunks are returned to the bins and coalesced, so that the
+  // allocation fits in the 2MiB limit.
+  void* large_ptr = a.AllocateRaw(1, 3 << 19);
+  EXPECT_NE(large_ptr, nullptr);
+  a.DeallocateRaw(large_ptr);
+}
+
+TEST_P(GPUBFCAllocatorTest, ChunkCacheConcurrentAllocations) {
+  GPUBFCAllocator::Options opts;
+  opts.chunk_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+  {
+    thread::ThreadPool pool(Env::Default(), "chunk_cache_test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        random::PhiloxRandom philox(123, t);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> live;
+        for (int i = 0; i < 1000; ++i) {
+          if (live.size() > 16 || (!live.empty() && rand.OneIn(2))) {
+            const int index = rand.Uniform(live.size());
+            a.DeallocateRaw(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+          } else {
+            live.push_back(a.AllocateRaw(1, 1 + rand.Uniform(64 << 10)));
+            CHECK_NE(live.back(), nullptr);
+          }
+        }
+        for (void* ptr : live) {
+          a.DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  // Only cached chunks remain in use, in at most one cache per thread.
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_LE(stats->bytes_in_use, 8 * opts.chunk_cache_bytes.value());
+}
+
+TEST_P(GPUBFCAllocatorTest, ReleaseFreeRegions) {
+  GPUBFCAllocator::Options opts;
+  opts.allow_growth = true;
+  opts.chunk_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  // Each allocation needs a new region: 2MiB, 4MiB, 8MiB.
+  void* small_ptr = a.AllocateRaw(1, 1 << 20);
+  void* medium_ptr = a.AllocateRaw(1, 3 << 20);
+  void* large_ptr = a.AllocateRaw(1, 7 << 20);
+  a.DeallocateRaw(medium_ptr);
+  a.DeallocateRaw(large_ptr);
+  // Cached, so its region stays in use until the caches are flushed.
+  a.DeallocateRaw(small_ptr);
+
+  MemoryDump before = a.RecordMemoryMap();
+  int64_t pool_bytes = 0;
+  for (const auto& region : before.region_summary()) {
+    pool_bytes += region.size();
+    EXPECT_EQ(region.fragmentation_metric(), 0);
+  }
+  EXPECT_EQ(before.stats().pool_bytes(), pool_bytes);
+
+  EXPECT_EQ(a.ReleaseFreeRegions(), static_cast<size_t>(pool_bytes));
+  MemoryDump after = a.RecordMemoryMap();
+  EXPECT_EQ(after.region_summary_size(), 0);
+  EXPECT_EQ(after.stats().pool_bytes(), 0);
+  EXPECT_EQ(a.ReleaseFreeRegions(), size_t{0});
+
+  // The allocator grows again on demand.
+  void* ptr = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(ptr, nullptr);
+  a.DeallocateRaw(ptr);
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
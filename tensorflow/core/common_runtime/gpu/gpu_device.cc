@@ -696,7 +696,10 @@ const absl::flat_hash_set<std::string>* GetOpsToLogFromEnv() {
 bool ShouldLogInputsAndOutputs(OpKernel* op_kernel) {
   static const absl::flat_hash_set<std::string>& ops_to_log =
       *GetOpsToLogFromEnv();
-  return ops_to_log.count(op_kernel->type_string());
+  // Called for every kernel launch; skip hashing the op type in the common
+  // case where no ops are logged.
+  if (ops_to_log.empty()) return false;
+  return ops_to_log.contains(op_kernel->type_string_view());
 }
 }  // namespace
 
@@ -98,6 +98,12 @@ class BaseGPUDevice : public LocalDevice {
 
   ~BaseGPUDevice() override;
 
+  // The streams used by one TF GPU device. Kernels of a device run in order on
+  // its single compute stream, and the device's allocator relies on that
+  // order to reuse memory. Each virtual device of a physical GPU (see
+  // GPUOptions::Experimental::virtual_devices) is a separate TF device with
+  // its own stream group and allocator, so independent parts of a graph can
+  // run concurrently on one GPU by placing them on different virtual devices.
   struct StreamGroup {
     se::Stream* compute = nullptr;
 #if TENSORFLOW_USE_ROCM
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/time/clock.h"
@@ -135,6 +136,44 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, LeastLoadedPolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::LeastLoadedPolicy>(
+                             ServingDeviceSelectorTestHelper::NowNs));
+  // Learn the execution times of two programs; only programs that run
+  // back-to-back are timed.
+  selector.Enqueue(0, "10ms");
+  selector.Enqueue(0, "10ms");
+  selector.Enqueue(1, "1ms");
+  selector.Enqueue(1, "1ms");
+  helper.ElapseNs(1e6);
+  selector.Completed(1, false);
+  helper.ElapseNs(1e6);
+  selector.Completed(1, false);
+  helper.ElapseNs(8e6);
+  selector.Completed(0, false);
+  helper.ElapseNs(10e6);
+  selector.Completed(0, false);
+
+  std::vector<tsl::DeviceReservation> reservations;
+  reservations.push_back(selector.ReserveDevice("10ms"));
+  EXPECT_EQ(reservations.back().device_index(), 0);
+  // Device 1 keeps being picked until its queue is as long as the 10ms
+  // program running on device 0.
+  for (int i = 0; i < 9; ++i) {
+    reservations.push_back(selector.ReserveDevice("1ms"));
+    EXPECT_EQ(reservations.back().device_index(), 1);
+  }
+  helper.ElapseNs(5e5);
+  reservations.push_back(selector.ReserveDevice("1ms"));
+  EXPECT_EQ(reservations.back().device_index(), 1);
+  // Both devices are now expected to be idle in 9.5ms; the one with fewer
+  // queued programs wins.
+  reservations.push_back(selector.ReserveDevice("1ms"));
+  EXPECT_EQ(reservations.back().device_index(), 0);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -56,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 #include "tsl/profiler/lib/traceme.h"
 
 // IMPLEMENTATION NOTE:
@@ -315,6 +316,30 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Copies `total_bytes` from pageable `src` into the pinned staging buffer
+// `dst`. Large buffers are split across the device's CPU worker threads, since
+// a single thread cannot saturate host memory bandwidth and the copy is on the
+// critical path of the transfer.
+void CopyToStagingBuffer(Device* gpu_device, const void* src, void* dst,
+                         int64_t total_bytes) {
+  // Chunks are large enough to amortize the cost of scheduling them.
+  constexpr int64_t kChunkBytes = 1 << 20;
+  const DeviceBase::CpuWorkerThreads* worker_threads =
+      gpu_device->tensorflow_cpu_worker_threads();
+  if (worker_threads == nullptr || total_bytes < 2 * kChunkBytes) {
+    std::memcpy(dst, src, total_bytes);
+    return;
+  }
+  const int64_t num_chunks = (total_bytes + kChunkBytes - 1) / kChunkBytes;
+  Shard(worker_threads->num_threads, worker_threads->workers, num_chunks,
+        kChunkBytes, [src, dst, total_bytes](int64_t start, int64_t limit) {
+          const int64_t begin = start * kChunkBytes;
+          const int64_t end = std::min(limit * kChunkBytes, total_bytes);
+          std::memcpy(static_cast<char*>(dst) + begin,
+                      static_cast<const char*>(src) + begin, end - begin);
+        });
+}
+
 }  // namespace
 
 void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
@@ -459,12 +484,22 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
+    if (do_staging) {
+      staging_buffer = host_memory_allocator->AllocateRaw(
+          tensorflow::Allocator::kAllocatorAlignment, total_bytes);
+      if (staging_buffer == nullptr) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Failed to allocate " << total_bytes
+            << " bytes of pinned memory to stage data for CPU->GPU transfer. "
+               "Staging will be skipped.";
+        do_staging = false;
+      }
+    }
+
     if (do_staging) {
       {
         tsl::profiler::TraceMe trace_me("Staging CPU buffer to pinned memory");
-        staging_buffer = host_memory_allocator->AllocateRaw(
-            tensorflow::Allocator::kAllocatorAlignment, total_bytes);
-        std::memcpy(staging_buffer, src_ptr, total_bytes);
+        CopyToStagingBuffer(gpu_device, src_ptr, staging_buffer, total_bytes);
         input_ref.Unref();
       }
       s = recv_host_to_device_stream->Memcpy(&gpu_dst_ptr, staging_buffer,
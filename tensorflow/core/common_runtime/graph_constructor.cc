@@ -681,6 +681,9 @@ absl::Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 
 absl::Status GraphConstructor::BuildNodeIndex() {
   // Validate the node names and add them to gdef_nodes_ and gdef_prefixes_.
+  // Sizing the index upfront avoids rehashing (and moving every key) several
+  // times while importing large graphs.
+  gdef_nodes_.reserve(node_def_count());
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
     if (!IsValidNodeName(node_def.name(), opts_.allow_internal_ops)) {
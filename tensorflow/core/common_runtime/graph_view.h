@@ -85,6 +85,9 @@ struct NodeItem {
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
+  bool outputs_are_step_local : 1;  // True iff no output of this node, nor
+                                    // any tensor forwarded from one, can be
+                                    // retained beyond the step.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
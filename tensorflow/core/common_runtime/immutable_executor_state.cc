@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -196,6 +198,7 @@ absl::Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    item->outputs_are_step_local = false;
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -256,12 +259,56 @@ absl::Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  if (!requires_control_flow_) {
+    MarkStepLocalOutputs(graph);
+  }
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
+namespace {
+// Returns true if the outputs of `n` may be retained beyond the step
+// regardless of what its consumers do with them.
+bool OutputsMayEscape(const Node* n) {
+  if (!n->IsOp() || n->IsRetval() || IsTransferNode(n) ||
+      n->op_def().is_stateful()) {
+    return true;
+  }
+  for (DataType dt : n->input_types()) {
+    if (IsRefType(dt)) return true;
+  }
+  for (DataType dt : n->output_types()) {
+    if (IsRefType(dt)) return true;
+  }
+  return false;
+}
+}  // namespace
+
+void ImmutableExecutorState::MarkStepLocalOutputs(const Graph& graph) {
+  // Consumers may forward their inputs to their outputs, so an output is only
+  // step-local if the outputs of every transitive data consumer are as well.
+  // The post order visits every consumer before its producers.
+  std::vector<Node*> order;
+  GetPostOrder(graph, &order);
+  std::vector<bool> escapes(graph.num_node_ids(), true);
+  for (const Node* n : order) {
+    bool node_escapes = OutputsMayEscape(n);
+    for (const Edge* e : n->out_edges()) {
+      if (node_escapes) break;
+      if (!e->IsControlEdge() && escapes[e->dst()->id()]) {
+        node_escapes = true;
+      }
+    }
+    escapes[n->id()] = node_escapes;
+    if (!IsSink(n)) {
+      gview_.node(n->id())->outputs_are_step_local = !node_escapes;
+    }
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
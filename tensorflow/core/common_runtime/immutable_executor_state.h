@@ -125,6 +125,9 @@ class ImmutableExecutorState {
   static absl::Status BuildControlFlowInfo(const Graph* graph,
                                            ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  // Sets `NodeItem::outputs_are_step_local` for every node. Requires a graph
+  // without control flow.
+  void MarkStepLocalOutputs(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
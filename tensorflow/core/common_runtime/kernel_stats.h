@@ -0,0 +1,180 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/costmodel.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Stores execution time information about the kernels in an executor's graph.
+//
+// The cost of a kernel is estimated separately for each bucket of input
+// sizes, so that an op that is cheap on small inputs and expensive on large
+// ones is inlined or dispatched according to the inputs it actually gets.
+class KernelStats {
+ public:
+  KernelStats() = default;
+
+  // Number of input-size buckets with a separate cost estimate per node.
+  // Bucket `b` holds the invocations whose non-reference inputs have in
+  // total [16^b, 16^(b+1)) elements; the last bucket also holds all larger
+  // inputs.
+  static constexpr int kNumShapeBuckets = 8;
+
+  void Initialize(const GraphView& gview) {
+    is_expensive_.resize(gview.num_nodes());
+    cost_estimates_ = std::make_unique<std::atomic_uint_fast64_t[]>(
+        gview.num_nodes() * kNumShapeBuckets);
+    for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+      if (gview.node(i)) {
+        is_expensive_[i] =
+            gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
+        for (int b = 0; b < kNumShapeBuckets; ++b) {
+          cost_estimates_[i * kNumShapeBuckets + b] =
+              kInitialCostEstimateCycles;
+        }
+      }
+    }
+  }
+
+  // Replaces the initial cost estimates of the nodes that have been measured
+  // in `cost_model` with the measured average execution time, for every
+  // bucket. The estimates are then refined online per bucket.
+  void SeedCostEstimates(const Graph& graph, const CostModel& cost_model) {
+    const double micros_per_cycle =
+        profile_utils::CpuUtils::GetMicroSecPerClock();
+    if (!(micros_per_cycle > 0)) return;
+    for (size_t i = 0; i < is_expensive_.size(); ++i) {
+      const Node* node = graph.FindNodeId(i);
+      if (!is_expensive_[i] || node == nullptr || !node->IsOp() ||
+          cost_model.TotalCount(node) <= 0) {
+        continue;
+      }
+      const uint64 estimate = static_cast<uint64>(
+          cost_model.TimeEstimate(node).value() / micros_per_cycle);
+      for (int b = 0; b < kNumShapeBuckets; ++b) {
+        cost_estimates_[i * kNumShapeBuckets + b] = estimate;
+      }
+    }
+  }
+
+  // Returns the bucket of an invocation whose inputs have `num_elements`
+  // elements in total.
+  static int ShapeBucket(int64_t num_elements) {
+    if (num_elements <= 0) return 0;
+    return std::min(kNumShapeBuckets - 1, Log2Floor64(num_elements) / 4);
+  }
+
+  // Returns the bucket of an invocation with the given `num_inputs` input
+  // entries. Reference inputs are not counted, because their shape may
+  // change concurrently.
+  static int ShapeBucket(const Entry* inputs, int num_inputs) {
+    int64_t num_elements = 0;
+    for (int i = 0; i < num_inputs; ++i) {
+      const Entry& entry = inputs[i];
+      if (entry.state == Entry::State::HAS_VALUE) {
+        num_elements += entry.val->NumElements();
+      } else if (entry.state == Entry::State::HAS_CONST_TENSOR) {
+        num_elements += entry.const_tensor->NumElements();
+      }
+    }
+    return ShapeBucket(num_elements);
+  }
+
+  // Returns the bucket of an invocation with the given prepared `inputs`.
+  static int ShapeBucket(absl::Span<const TensorValue> inputs) {
+    int64_t num_elements = 0;
+    for (const TensorValue& input : inputs) {
+      if (input.tensor != nullptr && !input.is_ref()) {
+        num_elements += input.tensor->NumElements();
+      }
+    }
+    return ShapeBucket(num_elements);
+  }
+
+  // Returns true iff the given node is considered "expensive" for inputs
+  // in `shape_bucket`. The executor uses this flag to optimize graph
+  // execution, for example by "inlining" inexpensive kernels.
+  bool IsExpensive(const NodeItem& node, int shape_bucket) const {
+    return is_expensive_[node.node_id] &&
+           (cost_estimates_[node.node_id * kNumShapeBuckets + shape_bucket]
+                .load(std::memory_order_relaxed) >
+            kOpIsExpensiveThresholdCycles);
+  }
+
+  // Returns the value of kernel->IsExpensive().
+  bool HasExpensiveMarker(const NodeItem& node) const {
+    return is_expensive_[node.node_id];
+  }
+
+  // Updates the dynamic cost estimate of `shape_bucket`, which is used to
+  // determine whether the given node is expensive. The new cost estimate is
+  // a weighted average of the old cost estimate and the latest cost. We only
+  // update cost estimates for kernels for which IsExpensive() return true.
+  void UpdateCostEstimate(const NodeItem& node, int shape_bucket,
+                          uint64 elapsed_cycles) {
+    // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
+    // updates may result in one or more updates being ignored.  This does not
+    // affect correctness but may slow down the update frequency.
+    std::atomic_uint_fast64_t& cost_estimate =
+        cost_estimates_[node.node_id * kNumShapeBuckets + shape_bucket];
+    auto prev_estimate = cost_estimate.load(std::memory_order_relaxed);
+
+    uint64 new_estimate =
+        ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
+
+    cost_estimate.store(new_estimate, std::memory_order_relaxed);
+  }
+
+  // Returns the current cost estimate, in CPU cycles, of `node` for inputs in
+  // `shape_bucket`.
+  uint64 CostEstimate(const NodeItem& node, int shape_bucket) const {
+    return cost_estimates_[node.node_id * kNumShapeBuckets + shape_bucket].load(
+        std::memory_order_relaxed);
+  }
+
+ private:
+  // Initial time (in CPU cycles) we expect an operation to take.  Used to
+  // determine whether an operation should be place in a threadpool.
+  // Operations start out "expensive".
+  static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
+  static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+  static constexpr uint64 kCostDecay = 10;
+
+  std::vector<bool> is_expensive_;
+  // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
+  // `kNumShapeBuckets` estimates per node, indexed by
+  // `node_id * kNumShapeBuckets + shape_bucket`.
+  std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,13 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If not null, the measured execution times in this cost model, e.g. one
+  // exported from a `CostModelManager` after a previous run of the same graph,
+  // seed the executor's per-node cost estimates. The node ids of the cost
+  // model must match those of the graph. Not owned, and only read while the
+  // executor is created.
+  const CostModel* cost_model = nullptr;
 };
 
 }  // end namespace tensorflow
@@ -136,12 +136,14 @@ absl::Status LowerFunctionalOpsPass::Run(
   bool keep_lowered_nodes_fetchable = !HasArgsOrRetvals(*g);
 
   // We disable lowering control flow to switch/merge variants when requested,
-  // and for the single-threaded executor and TFRT runtime, which does not
-  // support it.
+  // and for the single-threaded and static schedule executors and TFRT
+  // runtime, which do not support it.
   const bool functional_control_flow =
       options.session_options &&
       (options.session_options->config.experimental().executor_type() ==
            "SINGLE_THREADED_EXECUTOR" ||
+       options.session_options->config.experimental().executor_type() ==
+           "STATIC_SCHEDULE_EXECUTOR" ||
        options.session_options->config.experimental().use_tfrt() ||
        options.session_options->config.experimental()
            .disable_functional_ops_lowering());
@@ -502,11 +502,11 @@ absl::Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   const string& function_key = Canonicalize(function_name, attrs, options);
 
   {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     const auto& it = table_.find(function_key);
     if (it != table_.end()) {
       *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
+      ++mdevice_data_.at(*handle)->instantiation_counter_;
       return absl::OkStatus();
     }
   }
@@ -1224,8 +1224,7 @@ absl::Status ProcessFunctionLibraryRuntime::ReleaseMultiDeviceHandle(
   {
     mutex_lock l(mu_);
     auto it = mdevice_data_.find(handle);
-    --it->second->instantiation_counter_;
-    if (it->second->instantiation_counter_ != 0) {
+    if (--it->second->instantiation_counter_ != 0) {
       return absl::OkStatus();
     }
     mdata = std::move(it->second);
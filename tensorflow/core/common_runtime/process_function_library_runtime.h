@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -304,7 +305,9 @@ class ProcessFunctionLibraryRuntime {
 
     const string function_name_;
     const string function_key_;
-    uint64 instantiation_counter_;
+    // Incremented under a shared lock of `mu_` when an instantiation hits the
+    // cache, decremented under an exclusive lock on release.
+    std::atomic<uint64> instantiation_counter_;
     // Stored here to resize the output tensor vector when function is run.
     const int num_outputs_;
     DataTypeVector ret_types_;
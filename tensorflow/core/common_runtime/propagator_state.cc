@@ -753,8 +753,15 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter;
+  if (recycled_iteration != nullptr) {
+    next_iter = recycled_iteration;
+    recycled_iteration = nullptr;
+    next_iter->Reinitialize(iteration_count, pending_counts);
+  } else {
+    next_iter = new IterationState(iteration_count, pending_counts,
+                                   total_input_tensors);
+  }
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
@@ -775,7 +782,12 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    if (recycled_iteration == nullptr) {
+      iter_state->ClearInputTensors(total_input_tensors);
+      recycled_iteration = iter_state;
+    } else {
+      delete iter_state;
+    }
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
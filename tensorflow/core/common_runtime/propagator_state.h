@@ -135,8 +135,7 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    int64_t iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -206,6 +205,24 @@ class PropagatorState {
       return counts.adjust_for_activation_atomic(h, increment_dead);
     }
 
+    // Releases the tensors still held by this (done) iteration so that the
+    // state can be recycled with `Reinitialize()`.
+    void ClearInputTensors(int total_input_tensors) {
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i] = Entry();
+      }
+    }
+
+    // Reinitializes a recycled iteration state, whose input tensors have been
+    // cleared, as if it were newly constructed.
+    void Reinitialize(int64_t new_iter_num,
+                      const PendingCounts* pending_counts) {
+      iter_num = new_iter_num;
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyCountsFrom(*pending_counts);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -286,6 +303,10 @@ class PropagatorState {
     absl::InlinedVector<IterationState*, 12UL> iterations;
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
+    // The state of the last completed iteration, kept to be reused by the
+    // next iteration instead of allocating new input tensors and pending
+    // counts for every iteration of a loop.
+    IterationState* recycled_iteration TF_GUARDED_BY(mu) = nullptr;
 
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
@@ -419,6 +440,7 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      delete recycled_iteration;
     }
 
    private:
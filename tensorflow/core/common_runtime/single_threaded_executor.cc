@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
@@ -25,8 +29,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 
 namespace tensorflow {
 
@@ -67,11 +75,21 @@ typedef absl::InlinedVector<AllocatorAttributes, 4UL> AllocatorAttributeVec;
 
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
+static const string& kStaticScheduleExecutor =
+    *new string("STATIC_SCHEDULE_EXECUTOR");
 
 class SingleThreadedExecutorImpl : public Executor {
  public:
-  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
-      : params_(params) {}
+  // If `run_waves_in_parallel` is true, the kernels are grouped into waves of
+  // mutually independent kernels, and the kernels of a wave may run
+  // concurrently.
+  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params,
+                                      bool run_waves_in_parallel = false)
+      : params_(params),
+        run_waves_in_parallel_(run_waves_in_parallel),
+        max_wave_parallelism_(std::max(port::MaxParallelism(), 1)),
+        executor_type_(run_waves_in_parallel ? &kStaticScheduleExecutor
+                                             : &kSingleThreadedExecutor) {}
 
   ~SingleThreadedExecutorImpl() override {
     for (const KernelState& kernel_state : kernels_) {
@@ -94,6 +112,24 @@ class SingleThreadedExecutorImpl : public Executor {
                                      ordered_nodes.size());
     }
 
+    // The wave of a node is the length of the longest path (including control
+    // edges) from the source node to it, so the nodes of one wave never depend
+    // on each other. Sorting by wave keeps the order topological.
+    std::vector<int> node_waves;
+    if (run_waves_in_parallel_) {
+      node_waves.resize(graph.num_node_ids(), 0);
+      for (const Node* n : ordered_nodes) {
+        for (const Edge* e : n->in_edges()) {
+          node_waves[n->id()] =
+              std::max(node_waves[n->id()], node_waves[e->src()->id()] + 1);
+        }
+      }
+      std::stable_sort(ordered_nodes.begin(), ordered_nodes.end(),
+                       [&node_waves](const Node* a, const Node* b) {
+                         return node_waves[a->id()] < node_waves[b->id()];
+                       });
+    }
+
     // We reserve two less nodes because we do not need to create kernels for
     // the _SOURCE and _SINK nodes.
     kernels_.reserve(ordered_nodes.size() - 2);
@@ -141,8 +177,19 @@ class SingleThreadedExecutorImpl : public Executor {
         kernel_state.const_tensor = *const_tensor;
       } else {
         const size_t kernel_index = kernels_.size();
+        if (run_waves_in_parallel_ &&
+            (kernel_index == 0 ||
+             node_waves[n->id()] !=
+                 node_waves[nodes_with_kernels.back()->id()])) {
+          waves_.push_back({kernel_index, kernel_index, 0});
+        }
         kernels_.push_back({});
         nodes_with_kernels.push_back(n);
+        if (run_waves_in_parallel_) {
+          Wave& wave = waves_.back();
+          ++wave.end;
+          if (kernel->IsExpensive()) ++wave.num_expensive;
+        }
         KernelState& kernel_state = kernels_[kernel_index];
         kernel_state.kernel = kernel;
         kernel_state.num_inputs = n->num_inputs();
@@ -251,6 +298,14 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    if (run_waves_in_parallel_) {
+      cost_estimates_ =
+          std::make_unique<std::atomic_uint_fast64_t[]>(kernels_.size());
+      for (size_t i = 0; i < kernels_.size(); ++i) {
+        cost_estimates_[i] = kInitialCostEstimateCycles;
+      }
+    }
     return absl::OkStatus();
   }
 
@@ -288,7 +343,15 @@ class SingleThreadedExecutorImpl : public Executor {
     // * In an error case (see below), we use the connectivity information in
     //   `KernelState::output_locations` to determine which locations have been
     //   initialized, and manually destroy them.
-    std::vector<Entry> inputs(total_num_inputs_);
+    //
+    // The vector is reused across steps: it is taken from `free_inputs_` and
+    // returned there, with every element reset to `NO_VALUE`, when the step
+    // ends.
+    std::unique_ptr<std::vector<Entry>> inputs_holder = AcquireInputs();
+    auto inputs_cleanup = gtl::MakeCleanup([this, &inputs_holder] {
+      ReleaseInputs(std::move(inputs_holder));
+    });
+    std::vector<Entry>& inputs = *inputs_holder;
 
     // TODO(mrry): Can we avoid copying into these vectors? Consider modifying
     // OpKernelContext to take the TensorValueVec as a pointer into `inputs`.
@@ -328,7 +391,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.runner = &runner_copy;
     params.run_all_kernels_inline = args.run_all_kernels_inline;
     params.stats_collector = args.stats_collector;
-    params.executor_type = &kSingleThreadedExecutor;
+    params.executor_type = executor_type_;
 
     // NOTE(mrry): We are assuming that the graph is loopless and condless.
     params.frame_iter = FrameAndIter(0, 0);
@@ -405,87 +468,238 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
-    // Execute the kernels one-at-a-time in topological order.
-    for (size_t i = 0; i < kernels_.size(); ++i) {
-      const KernelState& kernel_state = kernels_[i];
-
-      // Prepare the per-kernel parameters.
-      const size_t input_start_index = kernel_state.input_start_index;
-      const size_t num_inputs = kernel_state.num_inputs;
-      const size_t num_outputs = kernel_state.num_outputs;
-
-      node_inputs.clear();
-      node_inputs.resize(num_inputs);
-      input_alloc_attrs.clear();
-      input_alloc_attrs.resize(num_inputs);
-      for (size_t j = 0; j < num_inputs; ++j) {
-        Entry& input = inputs[input_start_index + j];
-        switch (input.state) {
-          case Entry::State::HAS_CONST_TENSOR:
-            // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
-            // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
-            // accessors making dynamic checks that prevent using an immutable
-            // tensor as a mutable tensor.
-            node_inputs[j].tensor = const_cast<Tensor*>(input.const_tensor);
-            break;
-          case Entry::State::HAS_VALUE:
-            node_inputs[j].tensor = input.val.get();
-            break;
-          default:
-            DCHECK(false) << "Input did not have a valid value.";
-        }
-        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
+    if (run_waves_in_parallel_ && args.runner != nullptr &&
+        !args.run_all_kernels_inline) {
+      for (const Wave& wave : waves_) {
+        TF_RETURN_IF_ERROR(RunWave(wave, device, &params, inputs.data(),
+                                   &node_inputs, &input_alloc_attrs));
       }
-      params.inputs = node_inputs;
-      params.input_alloc_attrs = input_alloc_attrs;
-      params.op_kernel = kernel_state.kernel;
-      params.output_attr_array = kernel_state.output_alloc_attrs.data();
-      OpKernelContext ctx(&params, num_outputs);
-
-      // Actually execute the kernel.
-      device->Compute(kernel_state.kernel, &ctx);
-      TF_RETURN_IF_ERROR(ctx.status());
-
-      // Free the inputs to the current kernel.
-      for (size_t j = 0; j < num_inputs; ++j) {
-        inputs[input_start_index + j].ClearVal();
+      return absl::OkStatus();
+    }
+
+    // Execute the kernels one-at-a-time in topological order.
+    for (const KernelState& kernel_state : kernels_) {
+      TF_RETURN_IF_ERROR(RunKernel(kernel_state, device, &params,
+                                   inputs.data(), &node_inputs,
+                                   &input_alloc_attrs));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct KernelState;
+  struct Wave;
+
+  // Runs the kernel of `kernel_state` with inputs from the flat `inputs`
+  // vector and forwards its outputs to the inputs of the kernels that consume
+  // them. `node_inputs` and `input_alloc_attrs` are scratch space.
+  absl::Status RunKernel(const KernelState& kernel_state, Device* device,
+                         OpKernelContext::Params* params, Entry* inputs,
+                         TensorValueVec* node_inputs,
+                         AllocatorAttributeVec* input_alloc_attrs) const {
+    // Prepare the per-kernel parameters.
+    const size_t input_start_index = kernel_state.input_start_index;
+    const size_t num_inputs = kernel_state.num_inputs;
+    const size_t num_outputs = kernel_state.num_outputs;
+
+    node_inputs->clear();
+    node_inputs->resize(num_inputs);
+    input_alloc_attrs->clear();
+    input_alloc_attrs->resize(num_inputs);
+    for (size_t j = 0; j < num_inputs; ++j) {
+      Entry& input = inputs[input_start_index + j];
+      switch (input.state) {
+        case Entry::State::HAS_CONST_TENSOR:
+          // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+          // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+          // accessors making dynamic checks that prevent using an immutable
+          // tensor as a mutable tensor.
+          (*node_inputs)[j].tensor = const_cast<Tensor*>(input.const_tensor);
+          break;
+        case Entry::State::HAS_VALUE:
+          (*node_inputs)[j].tensor = input.val.get();
+          break;
+        default:
+          DCHECK(false) << "Input did not have a valid value.";
       }
+      (*input_alloc_attrs)[j] = input_alloc_attrs_[input_start_index + j];
+    }
+    params->inputs = *node_inputs;
+    params->input_alloc_attrs = *input_alloc_attrs;
+    params->op_kernel = kernel_state.kernel;
+    params->output_attr_array = kernel_state.output_alloc_attrs.data();
+    OpKernelContext ctx(params, num_outputs);
+
+    // Actually execute the kernel.
+    device->Compute(kernel_state.kernel, &ctx);
+    TF_RETURN_IF_ERROR(ctx.status());
+
+    // Free the inputs to the current kernel.
+    for (size_t j = 0; j < num_inputs; ++j) {
+      inputs[input_start_index + j].ClearVal();
+    }
 
-      // Forward the outputs of the kernel to the inputs of subsequent kernels.
-      for (size_t j = 0; j < num_outputs; ++j) {
-        TensorValue val = ctx.release_output(j);
-        const size_t num_destinations = kernel_state.output_locations[j].size();
-        if (num_destinations > 0) {
-          // TODO(mrry): Consider flattening the `output_locations` vector
-          // to improve the cache-friendliness of this loop.
-          for (size_t k = 0; k < num_destinations - 1; ++k) {
-            // TODO(mrry): Validate that the types match the expected values or
-            // ensure that the necessary validation has already happened.
-            Entry& input = inputs[kernel_state.output_locations[j][k]];
-            input.state = Entry::State::HAS_VALUE;
-            if (val.tensor != nullptr) {
-              input.val.Init(*val.tensor);
-            } else {
-              input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
-            }
-          }
-          // Move `arg` to the last consumer to avoid the cost of copying it.
-          Entry& input =
-              inputs[kernel_state.output_locations[j][num_destinations - 1]];
+    // Forward the outputs of the kernel to the inputs of subsequent kernels.
+    for (size_t j = 0; j < num_outputs; ++j) {
+      TensorValue val = ctx.release_output(j);
+      const size_t num_destinations = kernel_state.output_locations[j].size();
+      if (num_destinations > 0) {
+        // TODO(mrry): Consider flattening the `output_locations` vector
+        // to improve the cache-friendliness of this loop.
+        for (size_t k = 0; k < num_destinations - 1; ++k) {
+          // TODO(mrry): Validate that the types match the expected values or
+          // ensure that the necessary validation has already happened.
+          Entry& input = inputs[kernel_state.output_locations[j][k]];
           input.state = Entry::State::HAS_VALUE;
           if (val.tensor != nullptr) {
-            input.val.Init(std::move(*val.tensor));
+            input.val.Init(*val.tensor);
           } else {
             input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
           }
         }
-        delete val.tensor;
+        // Move `arg` to the last consumer to avoid the cost of copying it.
+        Entry& input =
+            inputs[kernel_state.output_locations[j][num_destinations - 1]];
+        input.state = Entry::State::HAS_VALUE;
+        if (val.tensor != nullptr) {
+          input.val.Init(std::move(*val.tensor));
+        } else {
+          input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+        }
       }
+      delete val.tensor;
     }
     return absl::OkStatus();
   }
 
- private:
+  // The kernels of a wave that have not been claimed yet, shared between
+  // `RunWave()` and the closures it schedules.
+  struct WaveState {
+    WaveState(size_t begin, size_t end)
+        : next(begin), end(end), pending(end - begin) {}
+
+    std::atomic<size_t> next;
+    const size_t end;
+    BlockingCounter pending;
+    mutex mu;
+    absl::Status status TF_GUARDED_BY(mu);
+  };
+
+  // Claims and runs kernels of `state` until none is left. Only dereferences
+  // the other arguments, which live on the stack of `Run()`, after claiming a
+  // kernel: `RunWave()` does not return before every claimed kernel is done,
+  // but a closure may start after that.
+  void RunWaveKernels(const std::shared_ptr<WaveState>& state, Device* device,
+                      const OpKernelContext::Params* params,
+                      Entry* inputs) const {
+    size_t i = state->next.fetch_add(1, std::memory_order_relaxed);
+    if (i >= state->end) return;
+    OpKernelContext::Params kernel_params = *params;
+    TensorValueVec node_inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    for (; i < state->end;
+         i = state->next.fetch_add(1, std::memory_order_relaxed)) {
+      absl::Status s = RunKernelAndUpdateCost(i, device, &kernel_params, inputs,
+                                              &node_inputs, &input_alloc_attrs);
+      if (!s.ok()) {
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+      }
+      state->pending.DecrementCount();
+    }
+  }
+
+  // Returns true if kernel `i` is marked as expensive and its measured cost
+  // exceeds `kOpIsExpensiveThresholdCycles`.
+  bool IsExpensive(size_t i) const {
+    return kernels_[i].kernel->IsExpensive() &&
+           cost_estimates_[i].load(std::memory_order_relaxed) >
+               kOpIsExpensiveThresholdCycles;
+  }
+
+  // Runs kernel `i` as `RunKernel()` does, and folds its execution time into
+  // its cost estimate.
+  absl::Status RunKernelAndUpdateCost(
+      size_t i, Device* device, OpKernelContext::Params* params,
+      Entry* inputs, TensorValueVec* node_inputs,
+      AllocatorAttributeVec* input_alloc_attrs) const {
+    const uint64 start_cycles = profile_utils::CpuUtils::GetCurrentClockCycle();
+    absl::Status s = RunKernel(kernels_[i], device, params, inputs,
+                               node_inputs, input_alloc_attrs);
+    const uint64 elapsed_cycles =
+        profile_utils::CpuUtils::GetCurrentClockCycle() - start_cycles;
+    // N.B. Updates are atomic but unlocked, so concurrent steps may drop an
+    // update, which only slows down the estimate.
+    std::atomic_uint_fast64_t& cost_estimate = cost_estimates_[i];
+    cost_estimate.store(
+        ((kCostDecay - 1) * cost_estimate.load(std::memory_order_relaxed) +
+         elapsed_cycles) /
+            kCostDecay,
+        std::memory_order_relaxed);
+    return s;
+  }
+
+  // Runs the kernels of `wave`. If the wave has more than one kernel that is
+  // expensive according to `IsExpensive()`, the kernels are shared between the
+  // calling thread and closures scheduled on `params->runner`: at most one per
+  // additional expensive kernel, and at most `max_wave_parallelism_` threads in
+  // total.
+  absl::Status RunWave(const Wave& wave, Device* device,
+                       OpKernelContext::Params* params, Entry* inputs,
+                       TensorValueVec* node_inputs,
+                       AllocatorAttributeVec* input_alloc_attrs) const {
+    size_t num_expensive = 0;
+    if (wave.num_expensive >= 2) {
+      for (size_t i = wave.begin; i < wave.end; ++i) {
+        if (IsExpensive(i)) ++num_expensive;
+      }
+    }
+    const size_t parallelism = std::min(num_expensive, max_wave_parallelism_);
+    if (parallelism < 2) {
+      for (size_t i = wave.begin; i < wave.end; ++i) {
+        TF_RETURN_IF_ERROR(RunKernelAndUpdateCost(
+            i, device, params, inputs, node_inputs, input_alloc_attrs));
+      }
+      return absl::OkStatus();
+    }
+    auto state = std::make_shared<WaveState>(wave.begin, wave.end);
+    for (size_t i = 1; i < parallelism; ++i) {
+      (*params->runner)([this, state, device, params, inputs]() {
+        RunWaveKernels(state, device, params, inputs);
+      });
+    }
+    // The calling thread claims kernels too, so the wave completes even if no
+    // scheduled closure gets to run.
+    RunWaveKernels(state, device, params, inputs);
+    state->pending.Wait();
+    mutex_lock l(state->mu);
+    return state->status;
+  }
+
+  // Returns a flat `inputs` vector whose elements are all `NO_VALUE`.
+  std::unique_ptr<std::vector<Entry>> AcquireInputs() {
+    {
+      mutex_lock l(free_inputs_mu_);
+      if (!free_inputs_.empty()) {
+        std::unique_ptr<std::vector<Entry>> inputs =
+            std::move(free_inputs_.back());
+        free_inputs_.pop_back();
+        return inputs;
+      }
+    }
+    return std::make_unique<std::vector<Entry>>(total_num_inputs_);
+  }
+
+  // Resets the elements of `inputs`, which may still hold values if the step
+  // failed, and keeps it for later steps.
+  void ReleaseInputs(std::unique_ptr<std::vector<Entry>> inputs) {
+    for (Entry& input : *inputs) {
+      input.ClearVal();
+    }
+    mutex_lock l(free_inputs_mu_);
+    free_inputs_.push_back(std::move(inputs));
+  }
+
   // Execute all operations in the calling thread when asynchronous execution
   // is requested. Callers may expect to perform expensive work in the calling
   // thread even when the execution itself is single-threaded.
@@ -496,6 +710,11 @@ class SingleThreadedExecutorImpl : public Executor {
   }
 
   const LocalExecutorParams params_;
+  const bool run_waves_in_parallel_;
+  // The maximum number of threads, including the calling thread, that run the
+  // kernels of one wave.
+  const size_t max_wave_parallelism_;
+  const string* const executor_type_;
 
   // All following members are read-only after Initialize().
 
@@ -531,6 +750,25 @@ class SingleThreadedExecutorImpl : public Executor {
   };
   std::vector<KernelState> kernels_;
 
+  // A range of `kernels_` that do not depend on each other.
+  struct Wave {
+    size_t begin;
+    size_t end;
+    // Number of kernels in the range whose `OpKernel::IsExpensive()` is true.
+    size_t num_expensive;
+  };
+  // The waves that partition `kernels_`, in order. Only set if
+  // `run_waves_in_parallel_` is true.
+  std::vector<Wave> waves_;
+
+  // Moving average of the execution time in CPU cycles of each kernel in
+  // `kernels_`, as in `ExecutorImpl::KernelStats`. Kernels start out
+  // expensive. Only set if `run_waves_in_parallel_` is true.
+  static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
+  static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+  static constexpr uint64 kCostDecay = 10;
+  std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+
   // For the `i`th argument, `arg_output_locations_[i]` contains the locations
   // in the flat `inputs` vector to which that argument must be copied.
   std::vector<std::vector<size_t>>
@@ -568,6 +806,12 @@ class SingleThreadedExecutorImpl : public Executor {
   // `RunAsync()` for details.
   std::vector<AllocatorAttributes>
       input_alloc_attrs_;  // Length = `total_num_inputs_`.
+
+  // Flat `inputs` vectors of finished steps, reused by later steps to avoid
+  // allocating one per step.
+  mutex free_inputs_mu_;
+  std::vector<std::unique_ptr<std::vector<Entry>>> free_inputs_
+      TF_GUARDED_BY(free_inputs_mu_);
 };
 
 class SingleThreadedExecutorRegistrar {
@@ -590,6 +834,26 @@ class SingleThreadedExecutorRegistrar {
 };
 static SingleThreadedExecutorRegistrar registrar;
 
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register(kStaticScheduleExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    absl::Status NewExecutor(const LocalExecutorParams& params,
+                             const Graph& graph,
+                             std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewStaticScheduleExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return absl::OkStatus();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar static_schedule_registrar;
+
 }  // namespace
 
 absl::Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
@@ -601,4 +865,14 @@ absl::Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
   return absl::OkStatus();
 }
 
+absl::Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                       const Graph& graph,
+                                       Executor** executor) {
+  auto impl = std::make_unique<SingleThreadedExecutorImpl>(
+      params, /*run_waves_in_parallel=*/true);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return absl::OkStatus();
+}
+
 }  // namespace tensorflow
@@ -54,6 +54,24 @@ namespace tensorflow {
 absl::Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
                                        const Graph& graph, Executor** executor);
 
+// Creates a new `Executor` that runs `graph` according to a schedule computed
+// once at creation time, with the same restrictions as the single-threaded
+// executor. Registered as the "STATIC_SCHEDULE_EXECUTOR" executor type.
+//
+// The kernels are grouped into waves: the wave of a node is the length of the
+// longest path from the source node to it, so the kernels of a wave are
+// mutually independent. Waves run in order on the caller thread. When a wave
+// contains several kernels whose `OpKernel::IsExpensive()` is true, closures
+// scheduled on `Executor::Args::runner` share its kernels with the caller
+// thread. As in the single-threaded executor, the input and output slot of
+// every edge is resolved at creation time, so a step does no pending-count
+// bookkeeping, and the flat input buffer is reused across steps.
+//
+// This executor is suitable for inference graphs without control flow whose
+// kernels are too cheap for the overhead of the default executor.
+absl::Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                       const Graph& graph, Executor** executor);
+
 // Returns OkStatus() for ops which are compatible with synchronous execution,
 // and otherwise returns an error message appropriate for propagation if needed.
 // If `allow_control_flow_sync_execution` is set to `true` control
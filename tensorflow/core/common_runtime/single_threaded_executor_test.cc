@@ -15,8 +15,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -37,10 +39,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -103,8 +108,7 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
-    TF_CHECK_OK(
-        NewExecutor("SINGLE_THREADED_EXECUTOR", params, *graph, &exec_));
+    TF_CHECK_OK(NewExecutor(executor_type_, params, *graph, &exec_));
     runner_ = [](const std::function<void()>& fn) { fn(); };
     rendez_ = NewLocalRendezvous();
   }
@@ -154,6 +158,7 @@ class ExecutorTest : public ::testing::Test {
   std::unique_ptr<Executor> exec_ = nullptr;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  string executor_type_ = "SINGLE_THREADED_EXECUTOR";
 };
 
 // A float val -> Tensor<float>
@@ -324,6 +329,81 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(retvals[0]));
 }
 
+TEST_F(ExecutorTest, StaticScheduleRandomTree) {
+  executor_type_ = "STATIC_SCHEDULE_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  thread::ThreadPool pool(Env::Default(), "static_schedule_test", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  // Later steps reuse the input buffer of earlier ones.
+  for (int i = 0; i < 4; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(static_cast<float>(i))}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(4096.0 * i, V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, StaticScheduleControlEdgeOrdersWaves) {
+  executor_type_ = "STATIC_SCHEDULE_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  Node* first;
+  TF_ASSERT_OK(
+      NodeBuilder(g->NewName("n"), "Mock").Input(in).Finalize(g.get(), &first));
+  Node* second;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Mock")
+                   .Input(in)
+                   .Finalize(g.get(), &second));
+  // Without data dependencies, only the control edge keeps `second` out of the
+  // wave of `first`.
+  g->AddControlEdge(first, second);
+  test::graph::Retval(g.get(), 0, first);
+  test::graph::Retval(g.get(), 1, second);
+  FixupSourceAndSinkEdges(g.get());
+  std::vector<string> order;
+  mutex mu;
+  Create(std::move(g), [&](OpKernelContext* ctx) {
+    {
+      mutex_lock l(mu);
+      order.push_back(ctx->op_kernel().name());
+    }
+    ctx->set_output(0, ctx->input(0));
+  });
+  thread::ThreadPool pool(Env::Default(), "static_schedule_test", 2);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT, DT_FLOAT});
+  TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+  TF_ASSERT_OK(Run(&call_frame));
+  EXPECT_EQ(order, std::vector<string>({first->name(), second->name()}));
+}
+
+TEST_F(ExecutorTest, StaticScheduleOpError) {
+  executor_type_ = "STATIC_SCHEDULE_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  auto check = test::graph::CheckNumerics(g.get(), in, "message");
+  test::graph::Retval(g.get(), 0, check);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(
+        call_frame.SetArgs({V(std::numeric_limits<float>::infinity())}));
+    EXPECT_TRUE(absl::IsInvalidArgument(Run(&call_frame)));
+  }
+  // The failed step released its input buffer for reuse.
+  FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+  TF_ASSERT_OK(call_frame.SetArgs({V(2.0)}));
+  TF_ASSERT_OK(Run(&call_frame));
+  std::vector<Tensor> retvals;
+  TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  EXPECT_EQ(2.0, V(retvals[0]));
+}
+
 TEST_F(ExecutorTest, OpError) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto zero = test::graph::Constant(g.get(), V(0.0));
@@ -0,0 +1,333 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/small_tensor_fusion_pass.h"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+
+namespace tensorflow {
+namespace {
+
+// A tensor that is consumed on another task, and the edges that consume it.
+struct FusedTensor {
+  Node* node;
+  int output;
+  TensorShape shape;
+  std::vector<const Edge*> edges;
+};
+
+// Tensors with the same source task, destination task and dtype, which are
+// transferred together.
+struct FusionGroup {
+  std::vector<FusedTensor> tensors;
+  // Maps a (node, output) pair to its index in `tensors`, or to -1 if the
+  // tensor cannot be fused.
+  absl::flat_hash_map<std::pair<const Node*, int>, int> index;
+};
+
+// (source task, destination task, dtype).
+using FusionGroupKey = std::tuple<std::string, std::string, DataType>;
+
+// Types with CPU kernels for Reshape, ConcatV2 and SplitV.
+bool IsFusibleType(DataType dtype) {
+  switch (dtype) {
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_INT8:
+    case DT_INT16:
+    case DT_INT32:
+    case DT_INT64:
+    case DT_UINT8:
+    case DT_UINT16:
+    case DT_BOOL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// `node` may depend on other tasks through something else than its inputs.
+bool MayDependOnOtherTasks(const Node* node) {
+  return node->IsRecv() || node->IsCollective() || node->IsFunctionCall() ||
+         node->IsIfNode() || node->IsWhileNode() || node->IsCaseNode() ||
+         node->IsDistributedCommunication();
+}
+
+// Returns the CPU:0 device of the task of `device`.
+std::string TaskCpuDevice(const DeviceNameUtils::ParsedName& device) {
+  DeviceNameUtils::ParsedName cpu = DeviceNameUtils::AddressSpace(device);
+  cpu.type = "CPU";
+  cpu.has_type = true;
+  cpu.id = 0;
+  cpu.has_id = true;
+  return DeviceNameUtils::ParsedNameToString(cpu);
+}
+
+// Returns true and sets `shape` if the shape of output `output` of `node` is
+// statically known.
+bool GetStaticShape(const ShapeRefiner& refiner, const Node* node, int output,
+                    TensorShape* shape) {
+  shape_inference::InferenceContext* c = refiner.GetContext(node);
+  if (c == nullptr || output >= c->num_outputs()) return false;
+  shape_inference::ShapeHandle handle = c->output(output);
+  if (!c->FullyDefined(handle)) return false;
+  *shape = TensorShape();
+  for (int i = 0; i < c->Rank(handle); ++i) {
+    if (!shape->AddDimWithStatus(c->Value(c->Dim(handle, i))).ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<Node*> AddNodeOnDevice(NodeBuilder builder,
+                                      const std::string& device,
+                                      Graph* graph) {
+  Node* node;
+  TF_RETURN_IF_ERROR(builder.Finalize(graph, &node));
+  node->set_assigned_device_name(device);
+  return node;
+}
+
+absl::StatusOr<Node*> AddConst(const std::string& name, const Tensor& value,
+                               const std::string& device, Graph* graph) {
+  return AddNodeOnDevice(NodeBuilder(name, "Const")
+                             .Attr("dtype", value.dtype())
+                             .Attr("value", value),
+                         device, graph);
+}
+
+// Replaces the edges of `group` by a pack on `src_device`, a single transfer
+// and an unpack on `dst_device`.
+absl::Status FuseGroup(const FusionGroup& group, const std::string& src_device,
+                       const std::string& dst_device, Graph* graph) {
+  const std::string prefix = graph->NewName("small_tensor_fusion");
+  const int num_tensors = group.tensors.size();
+
+  // Sender: flatten every tensor and concatenate them.
+  Tensor flat_shape(DT_INT32, TensorShape({1}));
+  flat_shape.vec<int32>()(0) = -1;
+  TF_ASSIGN_OR_RETURN(Node * flat_shape_node,
+                      AddConst(absl::StrCat(prefix, "/flat_shape"), flat_shape,
+                               src_device, graph));
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  TF_ASSIGN_OR_RETURN(
+      Node * pack_axis,
+      AddConst(absl::StrCat(prefix, "/pack_axis"), axis, src_device, graph));
+  std::vector<NodeBuilder::NodeOut> flat_tensors;
+  Tensor size_splits(DT_INT64, TensorShape({num_tensors}));
+  for (int i = 0; i < num_tensors; ++i) {
+    const FusedTensor& tensor = group.tensors[i];
+    TF_ASSIGN_OR_RETURN(
+        Node * flatten,
+        AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/flatten_", i),
+                                    "Reshape")
+                            .Input(tensor.node, tensor.output)
+                            .Input(flat_shape_node),
+                        src_device, graph));
+    flat_tensors.emplace_back(flatten);
+    size_splits.vec<int64_t>()(i) = tensor.shape.num_elements();
+  }
+  TF_ASSIGN_OR_RETURN(
+      Node * pack,
+      AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/pack"), "ConcatV2")
+                          .Input(flat_tensors)
+                          .Input(pack_axis),
+                      src_device, graph));
+
+  // Receiver: split the transferred tensor and restore the original shapes.
+  TF_ASSIGN_OR_RETURN(Node * size_splits_node,
+                      AddConst(absl::StrCat(prefix, "/size_splits"),
+                               size_splits, dst_device, graph));
+  TF_ASSIGN_OR_RETURN(
+      Node * unpack_axis,
+      AddConst(absl::StrCat(prefix, "/unpack_axis"), axis, dst_device, graph));
+  TF_ASSIGN_OR_RETURN(
+      Node * unpack,
+      AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/unpack"), "SplitV")
+                          .Input(pack)
+                          .Input(size_splits_node)
+                          .Input(unpack_axis)
+                          .Attr("num_split", num_tensors),
+                      dst_device, graph));
+  for (int i = 0; i < num_tensors; ++i) {
+    const FusedTensor& tensor = group.tensors[i];
+    Tensor shape(DT_INT64, TensorShape({tensor.shape.dims()}));
+    for (int d = 0; d < tensor.shape.dims(); ++d) {
+      shape.vec<int64_t>()(d) = tensor.shape.dim_size(d);
+    }
+    TF_ASSIGN_OR_RETURN(Node * shape_node,
+                        AddConst(absl::StrCat(prefix, "/shape_", i), shape,
+                                 dst_device, graph));
+    TF_ASSIGN_OR_RETURN(
+        Node * unflatten,
+        AddNodeOnDevice(NodeBuilder(absl::StrCat(prefix, "/unflatten_", i),
+                                    "Reshape")
+                            .Input(unpack, i)
+                            .Input(shape_node),
+                        dst_device, graph));
+    for (const Edge* edge : tensor.edges) {
+      Node* dst = edge->dst();
+      const int dst_input = edge->dst_input();
+      graph->RemoveEdge(edge);
+      graph->AddEdge(unflatten, 0, dst, dst_input);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status SmallTensorFusionPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr || options.session_options == nullptr) {
+    return absl::OkStatus();
+  }
+  const int64_t threshold = options.session_options->config.experimental()
+                                .small_tensor_fusion_threshold_bytes();
+  if (threshold <= 0) return absl::OkStatus();
+
+  Graph* graph = options.graph->get();
+  for (const Node* node : graph->op_nodes()) {
+    if (node->IsControlFlow()) {
+      // A dead input would make the whole fused transfer dead.
+      VLOG(1) << "Not fusing small tensors in a graph with control flow.";
+      return absl::OkStatus();
+    }
+  }
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("before_small_tensor_fusion_pass", *graph,
+                               options.flib_def);
+  }
+
+  // The device and task of every node, and whether the node depends on nodes
+  // of its own task only. Fusing tensors produced by such nodes cannot create
+  // a cycle through the destination task.
+  std::vector<DeviceNameUtils::ParsedName> devices(graph->num_node_ids());
+  std::vector<std::string> tasks(graph->num_node_ids());
+  std::vector<bool> depends_on_own_task_only(graph->num_node_ids(), false);
+  ShapeRefiner refiner(graph->versions(), graph->op_registry());
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (Node* node : order) {
+    if (!node->IsOp()) continue;
+    // A shape inference failure only prevents fusing the affected tensors.
+    refiner.AddNode(node).IgnoreError();
+    const int id = node->id();
+    if (!DeviceNameUtils::ParseFullName(node->assigned_device_name(),
+                                        &devices[id]) ||
+        !DeviceNameUtils::GetTaskName(devices[id], &tasks[id]) ||
+        MayDependOnOtherTasks(node)) {
+      continue;
+    }
+    bool own_task_only = true;
+    for (const Edge* edge : node->in_edges()) {
+      const Node* src = edge->src();
+      if (src->IsSource()) continue;
+      if (!depends_on_own_task_only[src->id()] ||
+          tasks[src->id()] != tasks[id]) {
+        own_task_only = false;
+        break;
+      }
+    }
+    depends_on_own_task_only[id] = own_task_only;
+  }
+
+  absl::btree_map<FusionGroupKey, FusionGroup> groups;
+  for (Node* src : graph->op_nodes()) {
+    if (!depends_on_own_task_only[src->id()]) continue;
+    const std::string& src_task = tasks[src->id()];
+    for (const Edge* edge : src->out_edges()) {
+      if (edge->IsControlEdge() || !edge->dst()->IsOp()) continue;
+      const std::string& dst_task = tasks[edge->dst()->id()];
+      if (dst_task.empty() || dst_task == src_task) continue;
+      const DataType dtype = src->output_type(edge->src_output());
+      if (!IsFusibleType(dtype)) continue;
+      FusionGroup& group = groups[{src_task, dst_task, dtype}];
+      auto [it, inserted] = group.index.try_emplace(
+          std::make_pair(src, edge->src_output()), group.tensors.size());
+      if (inserted) {
+        TensorShape shape;
+        if (!GetStaticShape(refiner, src, edge->src_output(), &shape) ||
+            shape.num_elements() * DataTypeSize(dtype) > threshold) {
+          it->second = -1;
+          continue;
+        }
+        group.tensors.push_back({src, edge->src_output(), std::move(shape)});
+      }
+      if (it->second >= 0) {
+        group.tensors[it->second].edges.push_back(edge);
+      }
+    }
+  }
+
+  int num_fused = 0;
+  for (const auto& [key, group] : groups) {
+    if (group.tensors.size() < 2) continue;
+    const std::string src_device =
+        TaskCpuDevice(devices[group.tensors[0].node->id()]);
+    const std::string dst_device =
+        TaskCpuDevice(devices[group.tensors[0].edges[0]->dst()->id()]);
+    if (options.device_set != nullptr &&
+        (options.device_set->FindDeviceByName(src_device) == nullptr ||
+         options.device_set->FindDeviceByName(dst_device) == nullptr)) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(FuseGroup(group, src_device, dst_device, graph));
+    num_fused += group.tensors.size();
+  }
+  VLOG(1) << "small_tensor_fusion_pass fused " << num_fused
+          << " tensors of at most " << threshold << " bytes.";
+
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << DumpGraphToFile("after_small_tensor_fusion_pass", *graph,
+                               options.flib_def);
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 50,
+                      SmallTensorFusionPass);
+
+}  // namespace tensorflow
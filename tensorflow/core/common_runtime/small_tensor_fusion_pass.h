@@ -0,0 +1,51 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SMALL_TENSOR_FUSION_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SMALL_TENSOR_FUSION_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+// Small tensors that cross from one task to another are packed into a single
+// tensor per (source task, destination task, dtype), so that partitioning
+// creates one Send/Recv pair for the group instead of one per tensor.
+//
+// For example, the graph:
+//   A -> X, B -> Y
+//   A and B are on /job:ps/replica:0/task:0/device:CPU:0
+//   X and Y are on /job:worker/replica:0/task:0/device:GPU:0
+// is rewritten to:
+//   {Reshape(A), Reshape(B)} -> ConcatV2 -> SplitV -> {Reshape, Reshape}
+//   -> {X, Y}
+//   ConcatV2 is on /job:ps/replica:0/task:0/device:CPU:0
+//   SplitV is on /job:worker/replica:0/task:0/device:CPU:0
+//
+// The pass is enabled by setting
+// ConfigProto.Experimental.small_tensor_fusion_threshold_bytes. Only tensors
+// with statically known shapes of at most that many bytes are fused. To keep
+// deadness propagation and the absence of cycles intact, graphs with control
+// flow are left unchanged, and only tensors whose producers (transitively)
+// depend on nodes of their own task alone are fused.
+
+namespace tensorflow {
+
+class SmallTensorFusionPass : public GraphOptimizationPass {
+ public:
+  absl::Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SMALL_TENSOR_FUSION_PASS_H_
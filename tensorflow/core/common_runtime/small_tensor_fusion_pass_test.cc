@@ -0,0 +1,176 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/small_tensor_fusion_pass.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+const char kPsCpu[] = "/job:ps/replica:0/task:0/device:CPU:0";
+const char kWorkerCpu[] = "/job:worker/replica:0/task:0/device:CPU:0";
+const char kWorkerGpu[] = "/job:worker/replica:0/task:0/device:GPU:0";
+
+Node* GetNode(const Graph& graph, const std::string& name) {
+  for (Node* node : graph.nodes()) {
+    if (node->name() == name) return node;
+  }
+  LOG(FATAL) << "Unknown node name: " << name;
+  return nullptr;
+}
+
+Node* GetInput(const Node* node, int index) {
+  const Edge* edge;
+  TF_CHECK_OK(node->input_edge(index, &edge));
+  return edge->src();
+}
+
+int CountOps(const Graph& graph, const std::string& op) {
+  int count = 0;
+  for (const Node* node : graph.op_nodes()) {
+    if (node->type_string() == op) ++count;
+  }
+  return count;
+}
+
+absl::Status RunPass(int64_t threshold, std::unique_ptr<Graph>* graph) {
+  SessionOptions session_options;
+  session_options.config.mutable_experimental()
+      ->set_small_tensor_fusion_threshold_bytes(threshold);
+  GraphOptimizationPassOptions options;
+  options.session_options = &session_options;
+  options.graph = graph;
+  SmallTensorFusionPass pass;
+  return pass.Run(options);
+}
+
+TEST(SmallTensorFusionPassTest, FusesSmallTensorsAcrossTasks) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  {
+    Scope scope = Scope::NewRootScope().ExitOnError();
+    Output a = ops::Const(scope.WithOpName("a"), 1.0f, TensorShape({}));
+    Output b = ops::Const(scope.WithOpName("b"), {2.0f, 3.0f});
+    Output c = ops::Const(scope.WithOpName("c"), {4, 5, 6});
+    ops::Negate(scope.WithOpName("neg_a"), a);
+    ops::Negate(scope.WithOpName("neg_b"), b);
+    ops::Add(scope.WithOpName("add_b"), b, b);
+    ops::Negate(scope.WithOpName("neg_c"), c);
+    TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  }
+  for (const char* name : {"a", "b", "c"}) {
+    GetNode(*graph, name)->set_assigned_device_name(kPsCpu);
+  }
+  for (const char* name : {"neg_a", "neg_b", "add_b", "neg_c"}) {
+    GetNode(*graph, name)->set_assigned_device_name(kWorkerGpu);
+  }
+
+  TF_ASSERT_OK(RunPass(/*threshold=*/64, &graph));
+
+  // `a` and `b` share one transfer; `c` is the only int32 tensor.
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 1);
+  EXPECT_EQ(CountOps(*graph, "SplitV"), 1);
+  Node* unflatten_a = GetInput(GetNode(*graph, "neg_a"), 0);
+  EXPECT_EQ(unflatten_a->type_string(), "Reshape");
+  EXPECT_EQ(unflatten_a->assigned_device_name(), kWorkerCpu);
+  Node* unpack = GetInput(unflatten_a, 0);
+  EXPECT_EQ(unpack->type_string(), "SplitV");
+  Node* pack = GetInput(unpack, 0);
+  EXPECT_EQ(pack->type_string(), "ConcatV2");
+  EXPECT_EQ(pack->assigned_device_name(), kPsCpu);
+
+  // Both consumers of `b` read the same unpacked tensor.
+  Node* unflatten_b = GetInput(GetNode(*graph, "neg_b"), 0);
+  EXPECT_EQ(GetInput(unflatten_b, 0), unpack);
+  EXPECT_EQ(GetInput(GetNode(*graph, "add_b"), 0), unflatten_b);
+  EXPECT_EQ(GetInput(GetNode(*graph, "add_b"), 1), unflatten_b);
+  EXPECT_EQ(GetInput(GetNode(*graph, "neg_c"), 0), GetNode(*graph, "c"));
+}
+
+TEST(SmallTensorFusionPassTest, SkipsLargeTensors) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  {
+    Scope scope = Scope::NewRootScope().ExitOnError();
+    Output a = ops::Const(scope.WithOpName("a"), {1.0f, 2.0f, 3.0f});
+    Output b = ops::Const(scope.WithOpName("b"), {4.0f, 5.0f, 6.0f});
+    ops::Negate(scope.WithOpName("neg_a"), a);
+    ops::Negate(scope.WithOpName("neg_b"), b);
+    TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  }
+  GetNode(*graph, "a")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "b")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "neg_a")->set_assigned_device_name(kWorkerCpu);
+  GetNode(*graph, "neg_b")->set_assigned_device_name(kWorkerCpu);
+
+  TF_ASSERT_OK(RunPass(/*threshold=*/8, &graph));
+
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 0);
+  EXPECT_EQ(GetInput(GetNode(*graph, "neg_a"), 0), GetNode(*graph, "a"));
+}
+
+TEST(SmallTensorFusionPassTest, SkipsTensorsDependingOnDestinationTask) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  {
+    Scope scope = Scope::NewRootScope().ExitOnError();
+    Output x = ops::Const(scope.WithOpName("x"), 1.0f, TensorShape({}));
+    Output a = ops::Negate(scope.WithOpName("a"), x);
+    Output b = ops::Const(scope.WithOpName("b"), 2.0f, TensorShape({}));
+    ops::Add(scope.WithOpName("sum"), a, b);
+    TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  }
+  // Fusing `a` with `b` would make `sum` wait for a transfer that depends on
+  // the worker itself.
+  GetNode(*graph, "x")->set_assigned_device_name(kWorkerCpu);
+  GetNode(*graph, "a")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "b")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "sum")->set_assigned_device_name(kWorkerCpu);
+
+  TF_ASSERT_OK(RunPass(/*threshold=*/64, &graph));
+
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 0);
+}
+
+TEST(SmallTensorFusionPassTest, DisabledByDefault) {
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  {
+    Scope scope = Scope::NewRootScope().ExitOnError();
+    Output a = ops::Const(scope.WithOpName("a"), 1.0f, TensorShape({}));
+    Output b = ops::Const(scope.WithOpName("b"), 2.0f, TensorShape({}));
+    ops::Add(scope.WithOpName("sum"), a, b);
+    TF_ASSERT_OK(scope.ToGraph(graph.get()));
+  }
+  GetNode(*graph, "a")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "b")->set_assigned_device_name(kPsCpu);
+  GetNode(*graph, "sum")->set_assigned_device_name(kWorkerCpu);
+
+  TF_ASSERT_OK(RunPass(/*threshold=*/0, &graph));
+
+  EXPECT_EQ(CountOps(*graph, "ConcatV2"), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
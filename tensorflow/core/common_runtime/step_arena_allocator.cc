@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) &
+         ~(Allocator::kAllocatorAlignment - 1);
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t max_bytes)
+    : base_(base), max_bytes_(RoundUpToAlignment(max_bytes)) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (buffer_ != nullptr) {
+    base_->DeallocateRaw(buffer_);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (alignment <= kAllocatorAlignment && num_bytes > 0) {
+    const size_t size = RoundUpToAlignment(num_bytes);
+    const size_t offset = offset_.fetch_add(size, std::memory_order_relaxed);
+    if (offset + size <= capacity_) {
+      // Released in `DeallocateRaw()`.
+      Ref();
+      return buffer_ + offset;
+    }
+  }
+  return base_->AllocateRaw(alignment, num_bytes);
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (buffer_ != nullptr && p >= buffer_ && p < buffer_ + capacity_) {
+    // May delete `this` if the arena has been released by its step.
+    Unref();
+  } else {
+    base_->DeallocateRaw(ptr);
+  }
+}
+
+void StepArenaAllocator::Reset() {
+  DCHECK(RefCountIsOne());
+  const size_t requested =
+      std::min(offset_.load(std::memory_order_relaxed), max_bytes_);
+  if (requested > capacity_) {
+    if (buffer_ != nullptr) {
+      base_->DeallocateRaw(buffer_);
+    }
+    buffer_ =
+        static_cast<char*>(base_->AllocateRaw(kAllocatorAlignment, requested));
+    capacity_ = buffer_ != nullptr ? requested : 0;
+    VLOG(2) << "Grew step arena to " << capacity_ << " bytes.";
+  }
+  offset_.store(0, std::memory_order_relaxed);
+}
+
+StepArenaPool::StepArenaPool(Allocator* base, size_t max_bytes_per_arena)
+    : base_(base), max_bytes_per_arena_(max_bytes_per_arena) {}
+
+StepArenaPool::~StepArenaPool() = default;
+
+core::RefCountPtr<StepArenaAllocator> StepArenaPool::Acquire() {
+  {
+    mutex_lock l(mu_);
+    if (!free_arenas_.empty()) {
+      core::RefCountPtr<StepArenaAllocator> arena =
+          std::move(free_arenas_.back());
+      free_arenas_.pop_back();
+      return arena;
+    }
+  }
+  return core::RefCountPtr<StepArenaAllocator>(
+      new StepArenaAllocator(base_, max_bytes_per_arena_));
+}
+
+void StepArenaPool::Release(core::RefCountPtr<StepArenaAllocator> arena) {
+  if (!arena->RefCountIsOne()) {
+    // A tensor allocated in the step is still alive. It keeps the arena alive
+    // until it is deallocated.
+    VLOG(1) << "A step arena allocation outlived its step; dropping the arena.";
+    return;
+  }
+  arena->Reset();
+  mutex_lock l(mu_);
+  free_arenas_.push_back(std::move(arena));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A bump allocator for the intermediate tensors of one step.
+//
+// Allocations are carved out of a single buffer obtained from `base` by
+// atomically bumping an offset, and deallocating them does not return memory
+// to `base`. `Reset()` reclaims the whole buffer once every allocation of the
+// step is gone. Requests that do not fit in the buffer, or that need a larger
+// alignment than `Allocator::kAllocatorAlignment`, fall back to `base`; the
+// buffer is grown at the next `Reset()` to the size the step asked for, up to
+// `max_bytes`.
+//
+// Every live allocation holds a reference on the arena, so an allocation that
+// outlives its step keeps the arena (and its buffer) alive instead of being
+// overwritten by a later step. This class is thread-safe, except for
+// `Reset()`.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  StepArenaAllocator(Allocator* base, size_t max_bytes);
+  ~StepArenaAllocator() override;
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Prepares the arena for the next step, growing its buffer if the last step
+  // overflowed it.
+  //
+  // REQUIRES: `RefCountIsOne()`, i.e. no allocation from the arena is alive,
+  // and no other thread is allocating from it.
+  void Reset();
+
+  Allocator* base() const { return base_; }
+
+  // The size of the buffer that allocations are carved out of.
+  size_t capacity() const { return capacity_; }
+
+ private:
+  Allocator* const base_;  // Not owned.
+  const size_t max_bytes_;
+  char* buffer_ = nullptr;
+  size_t capacity_ = 0;
+  // Number of bytes requested in the current step, including those that did
+  // not fit in the buffer.
+  std::atomic<size_t> offset_{0};
+};
+
+// A pool of `StepArenaAllocator`s, so that concurrent steps each get their own
+// arena and the arenas' buffers are reused across steps. Thread-safe.
+class StepArenaPool {
+ public:
+  StepArenaPool(Allocator* base, size_t max_bytes_per_arena);
+  ~StepArenaPool();
+
+  // Returns an arena for one step. The caller owns the returned reference and
+  // must pass it to `Release()` after the step, once no thread is allocating
+  // from the arena anymore.
+  core::RefCountPtr<StepArenaAllocator> Acquire();
+
+  // Resets `arena` and returns it to the pool if none of its allocations is
+  // alive. Otherwise drops the reference, and the arena is deleted once its
+  // remaining allocations are released.
+  void Release(core::RefCountPtr<StepArenaAllocator> arena);
+
+  Allocator* base() const { return base_; }
+
+ private:
+  Allocator* const base_;  // Not owned.
+  const size_t max_bytes_per_arena_;
+  mutex mu_;
+  std::vector<core::RefCountPtr<StepArenaAllocator>> free_arenas_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
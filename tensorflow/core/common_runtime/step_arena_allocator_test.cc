@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <utility>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(StepArenaAllocatorTest, FallsBackUntilFirstReset) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), /*max_bytes=*/1 << 20));
+  EXPECT_EQ(arena->capacity(), 0);
+  void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  ASSERT_NE(p, nullptr);
+  // The allocation came from the base allocator, so it holds no reference.
+  EXPECT_TRUE(arena->RefCountIsOne());
+  arena->DeallocateRaw(p);
+
+  arena->Reset();
+  EXPECT_EQ(arena->capacity(), 1024);
+  void* q = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  ASSERT_NE(q, nullptr);
+  EXPECT_FALSE(arena->RefCountIsOne());
+  arena->DeallocateRaw(q);
+  EXPECT_TRUE(arena->RefCountIsOne());
+}
+
+TEST(StepArenaAllocatorTest, GrowsUpToMaxBytes) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), /*max_bytes=*/4096));
+  for (int i = 0; i < 3; ++i) {
+    void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+    arena->DeallocateRaw(p);
+  }
+  arena->Reset();
+  EXPECT_EQ(arena->capacity(), 4096);
+
+  // Over-aligned requests always go to the base allocator.
+  void* p = arena->AllocateRaw(2 * Allocator::kAllocatorAlignment, 64);
+  ASSERT_NE(p, nullptr);
+  EXPECT_TRUE(arena->RefCountIsOne());
+  arena->DeallocateRaw(p);
+}
+
+TEST(StepArenaAllocatorTest, ResetReusesBuffer) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), /*max_bytes=*/1 << 20));
+  arena->DeallocateRaw(arena->AllocateRaw(Allocator::kAllocatorAlignment, 256));
+  arena->Reset();
+  void* first = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  arena->DeallocateRaw(first);
+  arena->Reset();
+  void* second = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(first, second);
+  EXPECT_FALSE(arena->RefCountIsOne());
+  arena->DeallocateRaw(second);
+}
+
+TEST(StepArenaPoolTest, ReusesReleasedArenas) {
+  StepArenaPool pool(cpu_allocator(), /*max_bytes_per_arena=*/1 << 20);
+  EXPECT_EQ(pool.base(), cpu_allocator());
+  core::RefCountPtr<StepArenaAllocator> arena = pool.Acquire();
+  StepArenaAllocator* raw = arena.get();
+  {
+    Tensor t(raw, DT_FLOAT, TensorShape({16}));
+  }
+  pool.Release(std::move(arena));
+
+  core::RefCountPtr<StepArenaAllocator> again = pool.Acquire();
+  EXPECT_EQ(again.get(), raw);
+  EXPECT_EQ(again->capacity(), 16 * sizeof(float));
+  // Concurrent steps get distinct arenas.
+  core::RefCountPtr<StepArenaAllocator> other = pool.Acquire();
+  EXPECT_NE(other.get(), raw);
+  pool.Release(std::move(other));
+  pool.Release(std::move(again));
+}
+
+TEST(StepArenaPoolTest, EscapedTensorKeepsArenaAlive) {
+  StepArenaPool pool(cpu_allocator(), /*max_bytes_per_arena=*/1 << 20);
+  Tensor escaped;
+  {
+    core::RefCountPtr<StepArenaAllocator> arena = pool.Acquire();
+    arena->DeallocateRaw(
+        arena->AllocateRaw(Allocator::kAllocatorAlignment, 64));
+    pool.Release(std::move(arena));
+  }
+  core::RefCountPtr<StepArenaAllocator> arena = pool.Acquire();
+  StepArenaAllocator* raw = arena.get();
+  escaped = Tensor(raw, DT_FLOAT, TensorShape({16}));
+  escaped.flat<float>().setConstant(1.0f);
+  // The escaped tensor still references the arena, so it is not pooled.
+  pool.Release(std::move(arena));
+
+  core::RefCountPtr<StepArenaAllocator> next = pool.Acquire();
+  EXPECT_NE(next.get(), raw);
+  Tensor t(next.get(), DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setZero();
+  EXPECT_EQ(escaped.flat<float>()(0), 1.0f);
+  pool.Release(std::move(next));
+}
+
+}  // namespace
+}  // namespace tensorflow
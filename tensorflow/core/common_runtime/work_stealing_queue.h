@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// WorkStealingQueue is an internal helper class that holds the ready nodes of
+// one executor step in per-worker deques, for use in the ExecutorState
+// module.
+//
+// A worker pushes the nodes it makes ready onto the back of its own deque and
+// pops from the back, so that the successors of a node tend to run on the
+// thread that produced their inputs while those are still in cache. A worker
+// whose deque is empty steals the oldest node from the front of another
+// worker's deque. Each deque has its own lock, so workers only contend when
+// stealing.
+//
+// The queue also tracks which worker slots are active, so that the executor
+// can wake up at most `num_workers` threads for a step.
+//
+// This class is thread-safe.
+template <typename T>
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(int num_workers)
+      : deques_(num_workers), next_victim_(0) {
+    CHECK_GT(num_workers, 0);
+    idle_workers_.reserve(num_workers);
+    for (int i = num_workers - 1; i >= 0; --i) {
+      idle_workers_.push_back(i);
+    }
+  }
+
+  int num_workers() const { return deques_.size(); }
+
+  // Returns true if no item is queued in any deque.
+  bool empty() const { return size_.load(std::memory_order_acquire) == 0; }
+
+  // Adds `item` to the back of the deque of `worker`.
+  void Push(int worker, T item) {
+    Deque& deque = deques_[worker];
+    {
+      mutex_lock l(deque.mu);
+      deque.items.push_back(std::move(item));
+    }
+    size_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Adds `item` to the back of the deque of a worker chosen in round-robin
+  // order. Used by threads that are not workers of this queue.
+  void PushAny(T item) {
+    const int worker =
+        next_victim_.fetch_add(1, std::memory_order_relaxed) % num_workers();
+    Push(worker, std::move(item));
+  }
+
+  // Removes and returns the most recently pushed item of the deque of
+  // `worker`. If that deque is empty, steals the oldest item of another
+  // worker's deque, visiting the other deques in order starting after
+  // `worker`. Returns `std::nullopt` if every deque is empty.
+  std::optional<T> Pop(int worker) {
+    if (empty()) return std::nullopt;
+    {
+      Deque& deque = deques_[worker];
+      mutex_lock l(deque.mu);
+      if (!deque.items.empty()) {
+        T item = std::move(deque.items.back());
+        deque.items.pop_back();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_workers(); ++i) {
+      Deque& victim = deques_[(worker + i) % num_workers()];
+      mutex_lock l(victim.mu);
+      if (!victim.items.empty()) {
+        T item = std::move(victim.items.front());
+        victim.items.pop_front();
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Marks an idle worker slot as active and returns it, or returns -1 if every
+  // slot is already active.
+  int TryAcquireWorker() {
+    mutex_lock l(workers_mu_);
+    if (idle_workers_.empty()) return -1;
+    const int worker = idle_workers_.back();
+    idle_workers_.pop_back();
+    return worker;
+  }
+
+  // Marks `worker`, which was returned by `TryAcquireWorker()`, as idle.
+  void ReleaseWorker(int worker) {
+    mutex_lock l(workers_mu_);
+    DCHECK_LT(idle_workers_.size(), num_workers());
+    idle_workers_.push_back(worker);
+  }
+
+ private:
+  // Aligned to avoid false sharing between the locks of neighboring deques,
+  // assuming the cacheline size is 64 bytes or smaller.
+  struct alignas(64) Deque {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  std::vector<Deque> deques_;
+  // Total number of queued items, used to skip scanning the deques when there
+  // is nothing to steal.
+  std::atomic<int64_t> size_{0};
+  std::atomic<uint32_t> next_victim_;
+
+  mutex workers_mu_;
+  std::vector<int> idle_workers_ TF_GUARDED_BY(workers_mu_);
+
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  void operator=(const WorkStealingQueue&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueTest, OwnerPopsMostRecent) {
+  WorkStealingQueue<int> queue(/*num_workers=*/2);
+  EXPECT_TRUE(queue.empty());
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(0, 3);
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.Pop(0), 3);
+  EXPECT_EQ(queue.Pop(0), 2);
+  EXPECT_EQ(queue.Pop(0), 1);
+  EXPECT_EQ(queue.Pop(0), std::nullopt);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(WorkStealingQueueTest, ThiefStealsOldest) {
+  WorkStealingQueue<int> queue(/*num_workers=*/3);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(2, 3);
+  // Worker 1 has no items, so it steals from worker 2 first, then worker 0.
+  EXPECT_EQ(queue.Pop(1), 3);
+  EXPECT_EQ(queue.Pop(1), 1);
+  EXPECT_EQ(queue.Pop(0), 2);
+  EXPECT_EQ(queue.Pop(1), std::nullopt);
+}
+
+TEST(WorkStealingQueueTest, PushAnySpreadsItems) {
+  WorkStealingQueue<int> queue(/*num_workers=*/2);
+  queue.PushAny(1);
+  queue.PushAny(2);
+  // Each worker finds one item in its own deque.
+  std::optional<int> a = queue.Pop(0);
+  std::optional<int> b = queue.Pop(1);
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  EXPECT_EQ(*a + *b, 3);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(WorkStealingQueueTest, AcquireAndReleaseWorkers) {
+  WorkStealingQueue<int> queue(/*num_workers=*/2);
+  const int first = queue.TryAcquireWorker();
+  const int second = queue.TryAcquireWorker();
+  EXPECT_GE(first, 0);
+  EXPECT_GE(second, 0);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(queue.TryAcquireWorker(), -1);
+  queue.ReleaseWorker(second);
+  EXPECT_EQ(queue.TryAcquireWorker(), second);
+}
+
+TEST(WorkStealingQueueTest, ConcurrentPopsSeeEveryItemOnce) {
+  constexpr int kNumWorkers = 4;
+  constexpr int kNumItems = 10000;
+  WorkStealingQueue<int> queue(kNumWorkers);
+  for (int i = 0; i < kNumItems / 2; ++i) {
+    queue.Push(0, i);
+  }
+  std::vector<std::atomic<int>> seen(kNumItems);
+  {
+    thread::ThreadPool pool(Env::Default(), "work_stealing_queue_test",
+                            kNumWorkers);
+    for (int worker = 0; worker < kNumWorkers; ++worker) {
+      pool.Schedule([&queue, &seen, worker]() {
+        while (std::optional<int> item = queue.Pop(worker)) {
+          seen[*item].fetch_add(1);
+          // Each item of the first half makes one more item ready on the
+          // worker's own deque, so owners and thieves race on every deque.
+          if (*item < kNumItems / 2) {
+            queue.Push(worker, *item + kNumItems / 2);
+          }
+        }
+      });
+    }
+  }
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(seen[i].load(), 1) << i;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Builds the record index (see `tsl::io::RecordIndex`) of uncompressed
+// TFRecord files, so that `TFRecordDataset` can seek to records and support
+// random access without scanning the files.
+//
+// Usage: build_record_index [--block_checksums] <file> [<file>...]
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/tsl/lib/io/record_index.h"
+#include "xla/tsl/lib/io/record_index_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+int main(int argc, char** argv) {
+  bool block_checksums = false;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("block_checksums", &block_checksums,
+                       "Whether to store a checksum for every block of index "
+                       "entries, verified on every lookup."),
+  };
+  const std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc < 2) {
+    std::cerr << usage << "\nArguments: <tfrecord file>...\n";
+    return -1;
+  }
+
+  tsl::io::RecordIndexOptions options;
+  options.block_checksums = block_checksums;
+  int num_failures = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string filename = argv[i];
+    const std::string index_filename = tsl::io::RecordIndexFileName(filename);
+    absl::Status s = tsl::io::BuildRecordIndex(tensorflow::Env::Default(),
+                                               filename, index_filename,
+                                               options);
+    if (s.ok()) {
+      std::cout << "Wrote " << index_filename << "\n";
+    } else {
+      std::cerr << "Failed to index " << filename << ": " << s << "\n";
+      ++num_failures;
+    }
+  }
+  return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/chunked_cache_file.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kShardSuffix[] = ".chunks";
+constexpr char kIndexSuffix[] = ".chunk_index";
+constexpr char kTempSuffix[] = ".tmp";
+
+// The first byte of every column record identifies how its payload is stored.
+constexpr char kColumnUncompressed = 0;
+constexpr char kColumnSnappy = 1;
+
+absl::Status NewRecordReader(Env* env, const std::string& filename,
+                             size_t buffer_size,
+                             std::unique_ptr<RandomAccessFile>* file,
+                             std::unique_ptr<io::RecordReader>* reader) {
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, file));
+  io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(
+          /*compression_type=*/"");
+  options.buffer_size = buffer_size;
+  *reader = std::make_unique<io::RecordReader>(file->get(), options);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string ChunkedCacheShardFilename(absl::string_view prefix,
+                                      int64_t shard_id) {
+  return absl::StrCat(prefix, "_", shard_id, kShardSuffix);
+}
+
+std::string ChunkedCacheIndexFilename(absl::string_view prefix) {
+  return absl::StrCat(prefix, kIndexSuffix);
+}
+
+absl::Status WriteChunkedCacheIndex(Env* env, absl::string_view prefix,
+                                    int64_t num_shards) {
+  // Write to a temporary file first so that readers never observe a partially
+  // written index.
+  const std::string filename = ChunkedCacheIndexFilename(prefix);
+  const std::string temp_filename = absl::StrCat(filename, kTempSuffix);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(temp_filename, &file));
+    io::RecordWriter writer(file.get());
+    std::string record;
+    core::PutVarint64(&record, num_shards);
+    TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  return env->RenameFile(temp_filename, filename);
+}
+
+ChunkedCacheWriter::ChunkedCacheWriter(Env* env, const std::string& filename,
+                                       size_t num_components, bool compress)
+    : env_(env),
+      filename_(filename),
+      num_components_(num_components),
+      compress_(compress),
+      columns_(num_components) {}
+
+absl::Status ChunkedCacheWriter::Initialize() {
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(filename_, &file_));
+  record_writer_ = std::make_unique<io::RecordWriter>(file_.get());
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheWriter::Write(const std::vector<Tensor>& element) {
+  if (record_writer_ == nullptr) {
+    return errors::FailedPrecondition("Chunked cache writer for ", filename_,
+                                      " is not initialized or closed.");
+  }
+  if (element.size() != num_components_) {
+    return errors::InvalidArgument("Expected an element with ",
+                                   num_components_, " components, got ",
+                                   element.size());
+  }
+  for (size_t i = 0; i < num_components_; ++i) {
+    TensorProto proto;
+    element[i].AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::DataLoss("Failed to serialize tensor of component ", i,
+                              " for the cache file ", filename_);
+    }
+    core::PutVarint64(&columns_[i], serialized.size());
+    columns_[i].append(serialized);
+    chunk_bytes_ += serialized.size();
+  }
+  ++chunk_elements_;
+  ++num_elements_;
+  if (chunk_bytes_ >= kTargetChunkBytes ||
+      chunk_elements_ >= kMaxChunkElements) {
+    return FlushChunk();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheWriter::FlushChunk() {
+  if (chunk_elements_ == 0) {
+    return absl::OkStatus();
+  }
+  std::string header;
+  core::PutVarint64(&header, chunk_elements_);
+  core::PutVarint64(&header, num_components_);
+  TF_RETURN_IF_ERROR(record_writer_->WriteRecord(header));
+  for (std::string& column : columns_) {
+    std::string record;
+    if (compress_ &&
+        port::Snappy_Compress(column.data(), column.size(), &record) &&
+        record.size() < column.size()) {
+      record.insert(record.begin(), kColumnSnappy);
+    } else {
+      record.clear();
+      record.reserve(column.size() + 1);
+      record.push_back(kColumnUncompressed);
+      record.append(column);
+    }
+    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
+    column.clear();
+  }
+  chunk_bytes_ = 0;
+  chunk_elements_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheWriter::Close() {
+  if (record_writer_ == nullptr) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(FlushChunk());
+  TF_RETURN_IF_ERROR(record_writer_->Close());
+  record_writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  return absl::OkStatus();
+}
+
+struct ChunkedCacheReader::Chunk {
+  int64_t num_elements = 0;
+  // Raw column records. Released once the chunk has been decoded.
+  std::vector<tstring> columns;
+  // Decoded elements, valid once `done` is set.
+  std::vector<std::vector<Tensor>> elements;
+
+  mutex mu;
+  condition_variable cv;
+  bool done TF_GUARDED_BY(mu) = false;
+  absl::Status status TF_GUARDED_BY(mu);
+};
+
+ChunkedCacheReader::ChunkedCacheReader(Env* env, const std::string& prefix,
+                                       size_t num_components,
+                                       int prefetch_chunks, Runner runner)
+    : env_(env),
+      prefix_(prefix),
+      num_components_(num_components),
+      prefetch_chunks_(std::max(prefetch_chunks, 1)),
+      runner_(std::move(runner)) {}
+
+absl::Status ChunkedCacheReader::Initialize() {
+  const std::string filename = ChunkedCacheIndexFilename(prefix_);
+  std::unique_ptr<RandomAccessFile> file;
+  std::unique_ptr<io::RecordReader> reader;
+  TF_RETURN_IF_ERROR(
+      NewRecordReader(env_, filename, /*buffer_size=*/0, &file, &reader));
+  uint64 offset = 0;
+  tstring record;
+  TF_RETURN_IF_ERROR(reader->ReadRecord(&offset, &record));
+  absl::string_view input(record);
+  uint64 num_shards;
+  if (!core::GetVarint64(&input, &num_shards)) {
+    return errors::DataLoss("Corrupted cache index file ", filename);
+  }
+  num_shards_ = num_shards;
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheReader::OpenNextShard(bool* end_of_cache) {
+  record_reader_.reset();
+  file_.reset();
+  if (next_shard_ >= num_shards_) {
+    *end_of_cache = true;
+    return absl::OkStatus();
+  }
+  *end_of_cache = false;
+  TF_RETURN_IF_ERROR(
+      NewRecordReader(env_, ChunkedCacheShardFilename(prefix_, next_shard_),
+                      kReadBufferSize, &file_, &record_reader_));
+  offset_ = 0;
+  ++next_shard_;
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheReader::ReadRawChunk(std::shared_ptr<Chunk>* chunk,
+                                              int64_t max_skippable_elements) {
+  tstring header;
+  while (true) {
+    if (record_reader_ == nullptr) {
+      bool end_of_cache;
+      TF_RETURN_IF_ERROR(OpenNextShard(&end_of_cache));
+      if (end_of_cache) {
+        chunk->reset();
+        return absl::OkStatus();
+      }
+    }
+    absl::Status s = record_reader_->ReadRecord(&offset_, &header);
+    if (absl::IsOutOfRange(s)) {
+      record_reader_.reset();
+      file_.reset();
+      continue;
+    }
+    TF_RETURN_IF_ERROR(s);
+    break;
+  }
+  absl::string_view input(header);
+  uint64 num_elements, num_columns;
+  if (!core::GetVarint64(&input, &num_elements) ||
+      !core::GetVarint64(&input, &num_columns)) {
+    return errors::DataLoss("Corrupted chunk header in cache file ",
+                            ChunkedCacheShardFilename(prefix_, next_shard_ - 1),
+                            " at offset ", offset_);
+  }
+  if (num_columns != num_components_) {
+    return errors::DataLoss("Cache file ",
+                            ChunkedCacheShardFilename(prefix_, next_shard_ - 1),
+                            " holds elements with ", num_columns,
+                            " components, expected ", num_components_);
+  }
+  auto result = std::make_shared<Chunk>();
+  result->num_elements = num_elements;
+  absl::Status s;
+  if (result->num_elements <= max_skippable_elements) {
+    int num_skipped = 0;
+    s = record_reader_->SkipRecords(&offset_, static_cast<int>(num_columns),
+                                     &num_skipped);
+  } else {
+    result->columns.resize(num_columns);
+    for (tstring& column : result->columns) {
+      s = record_reader_->ReadRecord(&offset_, &column);
+      if (!s.ok()) break;
+    }
+  }
+  if (absl::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated chunk in cache file ",
+                            ChunkedCacheShardFilename(prefix_, next_shard_ - 1),
+                            " at offset ", offset_);
+  }
+  TF_RETURN_IF_ERROR(s);
+  *chunk = std::move(result);
+  return absl::OkStatus();
+}
+
+void ChunkedCacheReader::DecodeChunk(Chunk* chunk, size_t num_components) {
+  absl::Status status = [&]() -> absl::Status {
+    chunk->elements.assign(chunk->num_elements,
+                           std::vector<Tensor>(num_components));
+    std::string uncompressed;
+    for (size_t c = 0; c < num_components; ++c) {
+      absl::string_view input(chunk->columns[c]);
+      if (input.empty()) {
+        return errors::DataLoss("Empty column record in cache chunk.");
+      }
+      const char codec = input[0];
+      input.remove_prefix(1);
+      if (codec == kColumnSnappy) {
+        size_t length;
+        if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                                &length)) {
+          return errors::DataLoss("Corrupted compressed cache chunk.");
+        }
+        uncompressed.resize(length);
+        if (!port::Snappy_Uncompress(input.data(), input.size(),
+                                     &uncompressed[0])) {
+          return errors::DataLoss("Corrupted compressed cache chunk.");
+        }
+        input = uncompressed;
+      } else if (codec != kColumnUncompressed) {
+        return errors::DataLoss("Unknown cache chunk encoding ",
+                                static_cast<int>(codec));
+      }
+      for (int64_t i = 0; i < chunk->num_elements; ++i) {
+        uint64 length;
+        if (!core::GetVarint64(&input, &length) || length > input.size()) {
+          return errors::DataLoss("Corrupted tensor in cache chunk.");
+        }
+        TensorProto proto;
+        if (!proto.ParseFromArray(input.data(), length) ||
+            !chunk->elements[i][c].FromProto(proto)) {
+          return errors::DataLoss("Unable to parse tensor in cache chunk.");
+        }
+        input.remove_prefix(length);
+      }
+      chunk->columns[c] = tstring();
+    }
+    return absl::OkStatus();
+  }();
+  mutex_lock l(chunk->mu);
+  chunk->status = std::move(status);
+  chunk->done = true;
+  chunk->cv.notify_all();
+}
+
+void ChunkedCacheReader::ScheduleDecode(std::shared_ptr<Chunk> chunk) {
+  pipeline_.push_back(chunk);
+  if (runner_) {
+    // The closure only references the chunk, which it keeps alive, so the
+    // reader may be destroyed while decodes are outstanding.
+    runner_([chunk = std::move(chunk), num_components = num_components_]() {
+      DecodeChunk(chunk.get(), num_components);
+    });
+  } else {
+    DecodeChunk(chunk.get(), num_components_);
+  }
+}
+
+absl::Status ChunkedCacheReader::FillPipeline() {
+  while (!end_of_cache_ &&
+         pipeline_.size() < static_cast<size_t>(prefetch_chunks_)) {
+    std::shared_ptr<Chunk> chunk;
+    TF_RETURN_IF_ERROR(ReadRawChunk(&chunk));
+    if (chunk == nullptr) {
+      end_of_cache_ = true;
+      break;
+    }
+    ScheduleDecode(std::move(chunk));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ChunkedCacheReader::WaitForFrontChunk() {
+  Chunk* chunk = pipeline_.front().get();
+  mutex_lock l(chunk->mu);
+  while (!chunk->done) {
+    chunk->cv.wait(l);
+  }
+  return chunk->status;
+}
+
+absl::Status ChunkedCacheReader::ReadElement(std::vector<Tensor>* element,
+                                             bool* end_of_sequence) {
+  *end_of_sequence = false;
+  while (true) {
+    TF_RETURN_IF_ERROR(FillPipeline());
+    if (pipeline_.empty()) {
+      *end_of_sequence = true;
+      return absl::OkStatus();
+    }
+    TF_RETURN_IF_ERROR(WaitForFrontChunk());
+    Chunk* chunk = pipeline_.front().get();
+    if (position_in_chunk_ < chunk->num_elements) {
+      *element = std::move(chunk->elements[position_in_chunk_++]);
+      return absl::OkStatus();
+    }
+    pipeline_.pop_front();
+    position_in_chunk_ = 0;
+  }
+}
+
+absl::Status ChunkedCacheReader::SkipElements(int64_t num_elements) {
+  while (num_elements > 0) {
+    if (!pipeline_.empty()) {
+      const int64_t available =
+          pipeline_.front()->num_elements - position_in_chunk_;
+      const int64_t num_skipped = std::min(num_elements, available);
+      position_in_chunk_ += num_skipped;
+      num_elements -= num_skipped;
+      if (position_in_chunk_ >= pipeline_.front()->num_elements) {
+        pipeline_.pop_front();
+        position_in_chunk_ = 0;
+      }
+      continue;
+    }
+    if (end_of_cache_) {
+      return absl::OkStatus();
+    }
+    std::shared_ptr<Chunk> chunk;
+    TF_RETURN_IF_ERROR(
+        ReadRawChunk(&chunk, /*max_skippable_elements=*/num_elements));
+    if (chunk == nullptr) {
+      end_of_cache_ = true;
+      return absl::OkStatus();
+    }
+    if (chunk->num_elements <= num_elements) {
+      num_elements -= chunk->num_elements;
+      continue;
+    }
+    ScheduleDecode(std::move(chunk));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_CHUNKED_CACHE_FILE_H_
+#define TENSORFLOW_CORE_DATA_CHUNKED_CACHE_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// A chunked, columnar file format for the file mode of `CacheDataset`.
+//
+// Elements are buffered into chunks of roughly `kTargetChunkBytes`. Each chunk
+// is written as a header record holding the number of elements and the number
+// of components, followed by one record per component ("column") holding the
+// serialized tensors of that component for every element in the chunk. Column
+// records are optionally Snappy compressed. Records are stored using the
+// TFRecord framing, so every record is checksummed.
+//
+// A cache consists of one chunk file per writer shard, named
+// `ChunkedCacheShardFilename(prefix, shard_id)`, and an index file named
+// `ChunkedCacheIndexFilename(prefix)` that is written once the cache is
+// complete and records the number of shards.
+
+// Returns the name of the chunk file for `shard_id` of the cache at `prefix`.
+std::string ChunkedCacheShardFilename(absl::string_view prefix,
+                                      int64_t shard_id);
+
+// Returns the name of the index file of the cache at `prefix`.
+std::string ChunkedCacheIndexFilename(absl::string_view prefix);
+
+// Writes the index file of a complete cache with `num_shards` chunk files.
+absl::Status WriteChunkedCacheIndex(Env* env, absl::string_view prefix,
+                                    int64_t num_shards);
+
+// Writes dataset elements into a single chunk file. Not thread-safe.
+class ChunkedCacheWriter {
+ public:
+  // Chunks are flushed once their serialized size reaches this many bytes.
+  static constexpr size_t kTargetChunkBytes = 4 << 20;  // 4MB
+  // Chunks are flushed once they hold this many elements.
+  static constexpr int64_t kMaxChunkElements = 1024;
+
+  // Creates a writer for `filename`. If `compress` is true and Snappy is
+  // available, column records are compressed.
+  ChunkedCacheWriter(Env* env, const std::string& filename,
+                     size_t num_components, bool compress);
+
+  // Creates (or truncates) the chunk file. Must be called before `Write`.
+  absl::Status Initialize();
+
+  // Buffers `element` and flushes the current chunk if it is large enough.
+  absl::Status Write(const std::vector<Tensor>& element);
+
+  // Flushes the buffered chunk and closes the file.
+  absl::Status Close();
+
+  // Returns the number of elements written so far.
+  int64_t num_elements() const { return num_elements_; }
+
+ private:
+  absl::Status FlushChunk();
+
+  Env* const env_;
+  const std::string filename_;
+  const size_t num_components_;
+  const bool compress_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> record_writer_;
+  // One serialized column per component for the chunk being built.
+  std::vector<std::string> columns_;
+  size_t chunk_bytes_ = 0;
+  int64_t chunk_elements_ = 0;
+  int64_t num_elements_ = 0;
+};
+
+// Reads the elements of a cache written with `ChunkedCacheWriter` in order.
+//
+// Chunk records are read sequentially through a large input buffer, while
+// decompression and tensor parsing of up to `prefetch_chunks` chunks run
+// concurrently on `runner`. Not thread-safe.
+class ChunkedCacheReader {
+ public:
+  using Runner = std::function<void(std::function<void()>)>;
+
+  // Size of the sequential read buffer of each chunk file.
+  static constexpr size_t kReadBufferSize = 4 << 20;  // 4MB
+
+  // If `runner` is empty, chunks are decoded inline on the calling thread.
+  ChunkedCacheReader(Env* env, const std::string& prefix,
+                     size_t num_components, int prefetch_chunks,
+                     Runner runner);
+
+  // Reads the index file. Must be called before any other method.
+  absl::Status Initialize();
+
+  // Reads the next element into `element`, or sets `end_of_sequence`.
+  absl::Status ReadElement(std::vector<Tensor>* element,
+                           bool* end_of_sequence);
+
+  // Skips `num_elements` elements. Whole chunks are skipped without decoding.
+  absl::Status SkipElements(int64_t num_elements);
+
+  // Returns the number of chunk files in the cache.
+  int64_t num_shards() const { return num_shards_; }
+
+ private:
+  struct Chunk;
+
+  // Reads the header and column records of the next chunk, opening the next
+  // shard as needed. Sets `*chunk` to nullptr at the end of the cache. If the
+  // chunk holds at most `max_skippable_elements` elements, its column records
+  // are skipped rather than read.
+  absl::Status ReadRawChunk(std::shared_ptr<Chunk>* chunk,
+                            int64_t max_skippable_elements = 0);
+  absl::Status OpenNextShard(bool* end_of_cache);
+  // Issues reads and decodes until `prefetch_chunks_` chunks are in flight.
+  absl::Status FillPipeline();
+  // Appends `chunk` to the pipeline and schedules its decoding.
+  void ScheduleDecode(std::shared_ptr<Chunk> chunk);
+  // Waits for the chunk at the front of the pipeline to be decoded.
+  absl::Status WaitForFrontChunk();
+  static void DecodeChunk(Chunk* chunk, size_t num_components);
+
+  Env* const env_;
+  const std::string prefix_;
+  const size_t num_components_;
+  const int prefetch_chunks_;
+  const Runner runner_;
+  int64_t num_shards_ = 0;
+
+  int64_t next_shard_ = 0;
+  std::unique_ptr<RandomAccessFile> file_;
+  std::unique_ptr<io::RecordReader> record_reader_;
+  uint64 offset_ = 0;
+  bool end_of_cache_ = false;
+
+  std::deque<std::shared_ptr<Chunk>> pipeline_;
+  // Index of the next element to return from the chunk at the front of
+  // `pipeline_`.
+  int64_t position_in_chunk_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_CHUNKED_CACHE_FILE_H_
@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/chunked_cache_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<tstring>({std::string(i % 7 + 1, 'a' + i % 26)})};
+}
+
+std::string TestPrefix() {
+  std::string prefix;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&prefix));
+  return prefix;
+}
+
+// Writes `num_elements` elements to `num_shards` chunk files.
+void WriteCache(const std::string& prefix, int64_t num_elements,
+                int64_t num_shards, bool compress) {
+  int64_t next = 0;
+  for (int64_t shard = 0; shard < num_shards; ++shard) {
+    ChunkedCacheWriter writer(Env::Default(),
+                              ChunkedCacheShardFilename(prefix, shard),
+                              /*num_components=*/2, compress);
+    TF_ASSERT_OK(writer.Initialize());
+    const int64_t end = num_elements * (shard + 1) / num_shards;
+    for (; next < end; ++next) {
+      TF_ASSERT_OK(writer.Write(MakeElement(next)));
+    }
+    TF_ASSERT_OK(writer.Close());
+  }
+  TF_ASSERT_OK(WriteChunkedCacheIndex(Env::Default(), prefix, num_shards));
+}
+
+void ExpectElements(ChunkedCacheReader* reader, int64_t begin, int64_t end) {
+  for (int64_t i = begin; i < end; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(reader->ReadElement(&element, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    std::vector<Tensor> expected = MakeElement(i);
+    ASSERT_EQ(element.size(), expected.size());
+    test::ExpectEqual(element[0], expected[0]);
+    test::ExpectEqual(element[1], expected[1]);
+  }
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(reader->ReadElement(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+class ChunkedCacheFileTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(ChunkedCacheFileTest, RoundTrip) {
+  const std::string prefix = TestPrefix();
+  // Spans multiple chunks per shard.
+  const int64_t num_elements = 3 * ChunkedCacheWriter::kMaxChunkElements + 5;
+  WriteCache(prefix, num_elements, /*num_shards=*/3, /*compress=*/GetParam());
+
+  thread::ThreadPool pool(Env::Default(), "chunked_cache_test", 4);
+  ChunkedCacheReader reader(
+      Env::Default(), prefix, /*num_components=*/2, /*prefetch_chunks=*/3,
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); });
+  TF_ASSERT_OK(reader.Initialize());
+  EXPECT_EQ(reader.num_shards(), 3);
+  ExpectElements(&reader, 0, num_elements);
+}
+
+TEST_P(ChunkedCacheFileTest, SkipElements) {
+  const std::string prefix = TestPrefix();
+  const int64_t num_elements = 2 * ChunkedCacheWriter::kMaxChunkElements + 10;
+  WriteCache(prefix, num_elements, /*num_shards=*/2, /*compress=*/GetParam());
+
+  for (int64_t skip : {int64_t{0}, int64_t{1},
+                       ChunkedCacheWriter::kMaxChunkElements,
+                       ChunkedCacheWriter::kMaxChunkElements + 3,
+                       num_elements - 1, num_elements, num_elements + 5}) {
+    ChunkedCacheReader reader(Env::Default(), prefix, /*num_components=*/2,
+                              /*prefetch_chunks=*/2, /*runner=*/nullptr);
+    TF_ASSERT_OK(reader.Initialize());
+    TF_ASSERT_OK(reader.SkipElements(skip));
+    ExpectElements(&reader, std::min(skip, num_elements), num_elements);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, ChunkedCacheFileTest,
+                         ::testing::Bool());
+
+TEST(ChunkedCacheFileErrorTest, MissingIndex) {
+  ChunkedCacheReader reader(Env::Default(), TestPrefix(), /*num_components=*/2,
+                            /*prefetch_chunks=*/1, /*runner=*/nullptr);
+  EXPECT_TRUE(absl::IsNotFound(reader.Initialize()));
+}
+
+TEST(ChunkedCacheFileErrorTest, ComponentMismatch) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/10, /*num_shards=*/1,
+             /*compress=*/false);
+  ChunkedCacheReader reader(Env::Default(), prefix, /*num_components=*/3,
+                            /*prefetch_chunks=*/1, /*runner=*/nullptr);
+  TF_ASSERT_OK(reader.Initialize());
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  EXPECT_TRUE(
+      absl::IsDataLoss(reader.ReadElement(&element, &end_of_sequence)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
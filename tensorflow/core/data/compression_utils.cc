@@ -14,12 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -28,7 +35,9 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
+#include "zstd.h"  // from @net_zstd
 
 namespace tensorflow {
 namespace data {
@@ -37,7 +46,278 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+constexpr int kCompressedElementVersion = 1;
+// Single-chunk Snappy elements are still written in the original format, so
+// that readers which predate chunking can read them.
+constexpr int kSingleSnappyChunkVersion = 0;
+
+bool UseSingleSnappyChunkFormat(const CompressionOptions& options) {
+  return options.codec == CompressedElement::SNAPPY &&
+         options.chunk_size_bytes <= 0;
+}
+
+// Splits the bytes described by `iov` into consecutive chunks of
+// `chunk_sizes[i]` bytes, returning the pieces covering each chunk.
+std::vector<std::vector<iovec>> SplitIov(
+    absl::Span<const iovec> iov, absl::Span<const uint64_t> chunk_sizes) {
+  std::vector<std::vector<iovec>> chunks(chunk_sizes.size());
+  size_t piece = 0;
+  size_t piece_offset = 0;
+  for (size_t i = 0; i < chunk_sizes.size(); ++i) {
+    uint64_t remaining = chunk_sizes[i];
+    while (remaining > 0 && piece < iov.size()) {
+      const size_t available = iov[piece].iov_len - piece_offset;
+      if (available == 0) {
+        ++piece;
+        piece_offset = 0;
+        continue;
+      }
+      const size_t n = std::min<uint64_t>(available, remaining);
+      chunks[i].push_back(
+          {static_cast<char*>(iov[piece].iov_base) + piece_offset, n});
+      piece_offset += n;
+      remaining -= n;
+    }
+  }
+  return chunks;
+}
+
+// Copies the bytes of `pieces` into a contiguous `out`.
+void Gather(absl::Span<const iovec> pieces, char* out) {
+  for (const iovec& piece : pieces) {
+    std::memcpy(out, piece.iov_base, piece.iov_len);
+    out += piece.iov_len;
+  }
+}
+
+// Copies the contiguous bytes in `in` into `pieces`.
+void Scatter(const char* in, absl::Span<const iovec> pieces) {
+  for (const iovec& piece : pieces) {
+    std::memcpy(piece.iov_base, in, piece.iov_len);
+    in += piece.iov_len;
+  }
+}
+
+absl::Status ZstdCompress(absl::Span<const iovec> pieces, size_t num_bytes,
+                          int level, std::string* out) {
+  std::string gathered;
+  const char* input = nullptr;
+  if (pieces.size() == 1) {
+    input = static_cast<const char*>(pieces[0].iov_base);
+  } else {
+    gathered.resize(num_bytes);
+    Gather(pieces, gathered.data());
+    input = gathered.data();
+  }
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(),
+                                                            &ZSTD_freeCCtx);
+  if (cctx == nullptr) {
+    return errors::Internal("Failed to create a ZSTD compression context.");
+  }
+  out->resize(ZSTD_compressBound(num_bytes));
+  const size_t size = ZSTD_compressCCtx(cctx.get(), out->data(), out->size(),
+                                        input, num_bytes, level);
+  if (ZSTD_isError(size)) {
+    return errors::Internal("Failed to compress using ZSTD: ",
+                            ZSTD_getErrorName(size));
+  }
+  out->resize(size);
+  return absl::OkStatus();
+}
+
+absl::Status ZstdUncompress(absl::string_view compressed,
+                            absl::Span<const iovec> pieces, size_t num_bytes) {
+  const uint64_t content_size =
+      ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+  if (content_size != num_bytes) {
+    return errors::Internal("Uncompressed size mismatch. ZSTD expects ",
+                            content_size,
+                            " whereas the tensor metadata suggests ",
+                            num_bytes);
+  }
+  std::string scattered;
+  char* output = nullptr;
+  if (pieces.size() == 1) {
+    output = static_cast<char*>(pieces[0].iov_base);
+  } else {
+    scattered.resize(num_bytes);
+    output = scattered.data();
+  }
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(),
+                                                            &ZSTD_freeDCtx);
+  if (dctx == nullptr) {
+    return errors::Internal("Failed to create a ZSTD decompression context.");
+  }
+  const size_t size = ZSTD_decompressDCtx(dctx.get(), output, num_bytes,
+                                          compressed.data(), compressed.size());
+  if (ZSTD_isError(size) || size != num_bytes) {
+    return errors::Internal("Failed to perform ZSTD decompression.");
+  }
+  if (pieces.size() != 1) {
+    Scatter(output, pieces);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CompressChunk(absl::Span<const iovec> pieces, size_t num_bytes,
+                           const CompressionOptions& options,
+                           std::string* out) {
+  switch (options.codec) {
+    case CompressedElement::NONE:
+      out->resize(num_bytes);
+      Gather(pieces, out->data());
+      return absl::OkStatus();
+    case CompressedElement::SNAPPY:
+      if (num_bytes > kuint32max) {
+        return errors::OutOfRange("Encountered a chunk of size ", num_bytes,
+                                  ", exceeding the 4GB Snappy limit.");
+      }
+      if (!port::Snappy_CompressFromIOVec(pieces.data(), num_bytes, out)) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+      return absl::OkStatus();
+    case CompressedElement::ZSTD:
+      return ZstdCompress(pieces, num_bytes, options.level, out);
+    default:
+      return errors::InvalidArgument("Unsupported compression codec: ",
+                                     options.codec);
+  }
+}
+
+absl::Status UncompressChunk(CompressedElement::Codec codec,
+                             absl::string_view compressed,
+                             absl::Span<const iovec> pieces,
+                             size_t num_bytes) {
+  switch (codec) {
+    case CompressedElement::NONE:
+      if (compressed.size() != num_bytes) {
+        return errors::Internal("Uncompressed chunk size mismatch. Got ",
+                                compressed.size(),
+                                " bytes whereas the tensor metadata suggests ",
+                                num_bytes);
+      }
+      Scatter(compressed.data(), pieces);
+      return absl::OkStatus();
+    case CompressedElement::SNAPPY: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(
+              compressed.data(), compressed.size(), &uncompressed_size) ||
+          uncompressed_size != num_bytes) {
+        return errors::Internal(
+            "Snappy uncompressed length does not match the tensor metadata.");
+      }
+      if (!port::Snappy_UncompressToIOVec(compressed.data(), compressed.size(),
+                                          pieces.data(), pieces.size())) {
+        return errors::Internal("Failed to perform snappy decompression.");
+      }
+      return absl::OkStatus();
+    }
+    case CompressedElement::ZSTD:
+      return ZstdUncompress(compressed, pieces, num_bytes);
+    default:
+      return errors::Internal("Unsupported compression codec: ", codec);
+  }
+}
+
+// Runs `fn(i)` for each `i` in [0, `num_chunks`), in parallel on `thread_pool`
+// if it is not null, and returns the first error.
+absl::Status ForEachChunk(int64_t num_chunks, int64_t cost_per_chunk,
+                          thread::ThreadPool* thread_pool,
+                          const std::function<absl::Status(int64_t)>& fn) {
+  std::vector<absl::Status> statuses(num_chunks);
+  if (thread_pool == nullptr || num_chunks <= 1) {
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      statuses[i] = fn(i);
+    }
+  } else {
+    thread_pool->ParallelFor(num_chunks, cost_per_chunk,
+                             [&](int64_t begin, int64_t end) {
+                               for (int64_t i = begin; i < end; ++i) {
+                                 statuses[i] = fn(i);
+                               }
+                             });
+  }
+  for (const absl::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+// Compresses the bytes described by `iov` into the chunked format.
+absl::Status CompressChunks(const iovec* iov, size_t num_pieces,
+                            size_t num_bytes, const CompressionOptions& options,
+                            thread::ThreadPool* thread_pool,
+                            CompressedElement* out) {
+  const uint64_t chunk_size = options.chunk_size_bytes > 0
+                                  ? options.chunk_size_bytes
+                                  : std::max<uint64_t>(num_bytes, 1);
+  // There is always at least one chunk, even for empty elements.
+  const int64_t num_chunks =
+      std::max<uint64_t>((num_bytes + chunk_size - 1) / chunk_size, 1);
+  std::vector<uint64_t> chunk_sizes(num_chunks, chunk_size);
+  chunk_sizes.back() = num_bytes - (num_chunks - 1) * chunk_size;
+  std::vector<std::vector<iovec>> chunks =
+      SplitIov(absl::MakeConstSpan(iov, num_pieces), chunk_sizes);
+  std::vector<std::string> compressed(num_chunks);
+  TF_RETURN_IF_ERROR(ForEachChunk(
+      num_chunks, chunk_size, thread_pool, [&](int64_t i) {
+        return CompressChunk(chunks[i], chunk_sizes[i], options,
+                             &compressed[i]);
+      }));
+  size_t compressed_size = 0;
+  for (const std::string& chunk : compressed) {
+    compressed_size += chunk.size();
+  }
+  std::string* data = out->mutable_data();
+  data->reserve(compressed_size);
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    data->append(compressed[i]);
+    out->add_chunk_uncompressed_bytes(chunk_sizes[i]);
+    out->add_chunk_compressed_bytes(compressed[i].size());
+  }
+  out->set_codec(options.codec);
+  return absl::OkStatus();
+}
+
+// Uncompresses the chunked format into the memory described by `iov`.
+absl::Status UncompressChunks(const CompressedElement& compressed,
+                              const iovec* iov, size_t num_pieces,
+                              size_t num_bytes,
+                              thread::ThreadPool* thread_pool) {
+  const int64_t num_chunks = compressed.chunk_uncompressed_bytes_size();
+  if (num_chunks == 0 ||
+      num_chunks != compressed.chunk_compressed_bytes_size()) {
+    return errors::Internal("Invalid chunk metadata in compressed element.");
+  }
+  std::vector<uint64_t> chunk_sizes(
+      compressed.chunk_uncompressed_bytes().begin(),
+      compressed.chunk_uncompressed_bytes().end());
+  std::vector<size_t> offsets(num_chunks);
+  uint64_t total_uncompressed = 0;
+  uint64_t total_compressed = 0;
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    offsets[i] = total_compressed;
+    total_uncompressed += chunk_sizes[i];
+    total_compressed += compressed.chunk_compressed_bytes(i);
+  }
+  if (total_uncompressed != num_bytes ||
+      total_compressed != compressed.data().size()) {
+    return errors::Internal(
+        "Uncompressed size mismatch. The chunks hold ", total_uncompressed,
+        " bytes whereas the tensor metadata suggests ", num_bytes);
+  }
+  std::vector<std::vector<iovec>> chunks =
+      SplitIov(absl::MakeConstSpan(iov, num_pieces), chunk_sizes);
+  const absl::string_view data = compressed.data();
+  return ForEachChunk(
+      num_chunks, /*cost_per_chunk=*/chunk_sizes[0], thread_pool,
+      [&](int64_t i) {
+        return UncompressChunk(
+            compressed.codec(),
+            data.substr(offsets[i], compressed.chunk_compressed_bytes(i)),
+            chunks[i], chunk_sizes[i]);
+      });
+}
 
 }  // namespace
 
@@ -66,6 +346,21 @@ class Iov {
 
 absl::Status CompressElement(const std::vector<Tensor>& element,
                              CompressedElement* out) {
+  return CompressElement(element, CompressionOptions(),
+                         /*thread_pool=*/nullptr, out);
+}
+
+absl::Status CompressElement(const std::vector<Tensor>& element,
+                             const CompressionOptions& options,
+                             thread::ThreadPool* thread_pool,
+                             CompressedElement* out) {
+  if (options.codec == CompressedElement::ZSTD &&
+      (options.level < ZSTD_minCLevel() || options.level > ZSTD_maxCLevel())) {
+    return errors::InvalidArgument("Invalid ZSTD compression level ",
+                                   options.level, ". Expected a level in [",
+                                   ZSTD_minCLevel(), ", ", ZSTD_maxCLevel(),
+                                   "].");
+  }
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -123,6 +418,16 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
+  if (!UseSingleSnappyChunkFormat(options)) {
+    TF_RETURN_IF_ERROR(CompressChunks(iov.Data(), iov.NumPieces(),
+                                      iov.NumBytes(), options, thread_pool,
+                                      out));
+    out->set_version(kCompressedElementVersion);
+    VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
+            << out->data().size() << " bytes in "
+            << out->chunk_compressed_bytes_size() << " chunks";
+    return absl::OkStatus();
+  }
   if (iov.NumBytes() > kuint32max) {
     return errors::OutOfRange("Encountered dataset element of size ",
                               iov.NumBytes(),
@@ -132,7 +437,7 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
                                       out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
-  out->set_version(kCompressedElementVersion);
+  out->set_version(kSingleSnappyChunkVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
   return absl::OkStatus();
@@ -140,7 +445,14 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
 
 absl::Status UncompressElement(const CompressedElement& compressed,
                                std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  return UncompressElement(compressed, /*thread_pool=*/nullptr, out);
+}
+
+absl::Status UncompressElement(const CompressedElement& compressed,
+                               thread::ThreadPool* thread_pool,
+                               std::vector<Tensor>* out) {
+  if (compressed.version() != kCompressedElementVersion &&
+      compressed.version() != kSingleSnappyChunkVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
@@ -193,23 +505,30 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.version() == kCompressedElementVersion) {
+    TF_RETURN_IF_ERROR(UncompressChunks(compressed, iov.Data(),
+                                        iov.NumPieces(), iov.NumBytes(),
+                                        thread_pool));
+  } else {
+    const std::string& compressed_data = compressed.data();
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                            compressed_data.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          compressed_data.size());
+    }
+    if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", iov.NumBytes());
+    }
+    if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                        compressed_data.size(), iov.Data(),
+                                        iov.NumPieces())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
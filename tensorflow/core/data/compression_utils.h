@@ -15,16 +15,29 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_COMPRESSION_UTILS_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
 
+// Options controlling how `CompressElement` compresses an element.
+struct CompressionOptions {
+  CompressedElement::Codec codec = CompressedElement::SNAPPY;
+  // Codec-specific compression level. 0 selects the codec's default.
+  int level = 0;
+  // If positive, the element's bytes are split into chunks of this size which
+  // are compressed and uncompressed independently, and in parallel when a
+  // thread pool is provided. If 0, the element is compressed as one chunk.
+  int64_t chunk_size_bytes = 0;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
@@ -34,10 +47,25 @@ namespace data {
 absl::Status CompressElement(const std::vector<Tensor>& element,
                              CompressedElement* out);
 
+// Like above, but compresses with `options`. Chunks are compressed in parallel
+// on `thread_pool` if it is not null. The default options produce the same
+// single-chunk Snappy format as the overload above. Snappy chunks are limited
+// to 4GB each.
+absl::Status CompressElement(const std::vector<Tensor>& element,
+                             const CompressionOptions& options,
+                             thread::ThreadPool* thread_pool,
+                             CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 absl::Status UncompressElement(const CompressedElement& compressed,
                                std::vector<Tensor>* out);
 
+// Like above, but uncompresses the chunks of `compressed` in parallel on
+// `thread_pool` if it is not null.
+absl::Status UncompressElement(const CompressedElement& compressed,
+                               thread::ThreadPool* thread_pool,
+                               std::vector<Tensor>* out);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/compression_utils.h"
 
 #include <cstdint>
+#include <tuple>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -22,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tsl/platform/status_matchers.h"
 
@@ -110,6 +113,85 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+std::vector<CompressionOptions> CodecTestCases() {
+  std::vector<CompressionOptions> options(5);
+  options[0].codec = CompressedElement::NONE;
+  options[1].codec = CompressedElement::SNAPPY;
+  options[1].chunk_size_bytes = 7;
+  options[2].codec = CompressedElement::ZSTD;
+  options[3].codec = CompressedElement::ZSTD;
+  options[3].level = 3;
+  options[3].chunk_size_bytes = 7;
+  options[4].codec = CompressedElement::NONE;
+  options[4].chunk_size_bytes = 1024;
+  return options;
+}
+
+class CodecCompressionUtilsTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<
+          std::tuple<std::vector<Tensor>, CompressionOptions>> {};
+
+TEST_P(CodecCompressionUtilsTest, RoundTrip) {
+  const auto& [element, options] = GetParam();
+  thread::ThreadPool thread_pool(Env::Default(), "compression_utils_test",
+                                 /*num_threads=*/4);
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &thread_pool, &compressed));
+  EXPECT_EQ(compressed.version(), 1);
+  EXPECT_EQ(compressed.codec(), options.codec);
+  EXPECT_GE(compressed.chunk_compressed_bytes_size(), 1);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(
+      UncompressElement(compressed, &thread_pool, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+
+  // Elements can also be uncompressed without a thread pool.
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+TEST_P(CodecCompressionUtilsTest, CorruptedChunkMetadata) {
+  const auto& [element, options] = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, /*thread_pool=*/nullptr,
+                               &compressed));
+  compressed.add_chunk_uncompressed_bytes(1);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Instantiation, CodecCompressionUtilsTest,
+    ::testing::Combine(::testing::ValuesIn(TestCases()),
+                       ::testing::ValuesIn(CodecTestCases())));
+
+TEST(CompressionUtilsTest, SplitsIntoChunks) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{1000})};
+  CompressionOptions options;
+  options.codec = CompressedElement::ZSTD;
+  options.chunk_size_bytes = 3000;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, /*thread_pool=*/nullptr,
+                               &compressed));
+  EXPECT_THAT(compressed.chunk_uncompressed_bytes(),
+              ::testing::ElementsAre(3000, 3000, 2000));
+}
+
+TEST(CompressionUtilsTest, InvalidZstdLevel) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{10})};
+  CompressionOptions options;
+  options.codec = CompressedElement::ZSTD;
+  options.level = 1000;
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, options, /*thread_pool=*/nullptr,
+                              &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
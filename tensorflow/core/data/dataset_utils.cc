@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -966,6 +967,20 @@ int64 GetAutotuneDefaultParallelism(IteratorContext* ctx) {
   return value;
 }
 
+bool NumaAwareThreadPoolsEnabled() {
+  static const bool enabled =
+      GetExperiments().contains("numa_aware_threadpool") &&
+      port::NUMAEnabled() && port::NUMANumNodes() > 1;
+  return enabled;
+}
+
+int GetNumaNodeForCurrentThread() {
+  if (!NumaAwareThreadPoolsEnabled()) {
+    return port::kNUMANoAffinity;
+  }
+  return port::NUMAGetThreadNodeAffinity();
+}
+
 IteratorContext MakeNestedIteratorContext(IteratorContext* ctx) {
   // Strips out any split providers so that they don't apply to sub-iterators.
   if (ctx->split_providers().empty()) {
@@ -1037,6 +1052,18 @@ REGISTER_DATASET_EXPERIMENT("inject_io_prefetch", RandomJobSamplePercentage<0>,
                             AllTasks);
 REGISTER_DATASET_EXPERIMENT("map_fusion", RandomJobSamplePercentage<0>,
                             IndependentHostTasks);
+REGISTER_DATASET_EXPERIMENT("file_read_ahead", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("tfrecord_memory_mapped_read",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("cache_chunked_file_format",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("shuffle_spill_to_disk",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("numa_aware_threadpool",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("map_filter_batch_fusion",
+                            RandomJobSamplePercentage<0>, AllTasks);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
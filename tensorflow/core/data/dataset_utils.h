@@ -356,6 +356,17 @@ inline int GetCpuBudget() {
 // optimization.
 int64 GetAutotuneDefaultParallelism(IteratorContext* ctx);
 
+// Returns true if the "numa_aware_threadpool" experiment is enabled and the
+// host has more than one NUMA node, in which case tf.data thread pools are
+// split into per-node pools whose threads are pinned to their node.
+bool NumaAwareThreadPoolsEnabled();
+
+// Returns the NUMA node that tf.data threads started on behalf of the calling
+// thread should be pinned to, or `port::kNUMANoAffinity` if
+// `NumaAwareThreadPoolsEnabled()` is false or the calling thread is not bound
+// to a node.
+int GetNumaNodeForCurrentThread();
+
 // Creates an iterator context appropriate for a nested dataset's iterator. A
 // nested dataset is a dataset created within another dataset, e.g. by the
 // function passed to `interleave` or `flat_map`.
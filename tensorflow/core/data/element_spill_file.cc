@@ -0,0 +1,243 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_spill_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/raw_coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Files smaller than this are never compacted, since copying the remaining
+// elements would cost more than the disk space it frees.
+constexpr uint64_t kMinCompactionSize = 1 << 20;  // 1 MiB
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ElementSpillFile>> ElementSpillFile::Create(
+    Env* env) {
+  std::string filename;
+  if (!env->LocalTempFilename(&filename)) {
+    return errors::Unavailable(
+        "Failed to find a local temporary directory for spilling dataset "
+        "elements.");
+  }
+  std::unique_ptr<ElementSpillFile> file(
+      new ElementSpillFile(env, std::move(filename)));
+  TF_RETURN_IF_ERROR(file->Reset());
+  return file;
+}
+
+absl::StatusOr<std::unique_ptr<ElementSpillFile>> ElementSpillFile::Create(
+    Env* env, const std::string& directory) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  std::string filename = io::JoinPath(directory, "element_spill");
+  if (!env->CreateUniqueFileName(&filename, ".spill")) {
+    return errors::Unavailable("Failed to create a spill file name in ",
+                               directory);
+  }
+  std::unique_ptr<ElementSpillFile> file(
+      new ElementSpillFile(env, std::move(filename)));
+  TF_RETURN_IF_ERROR(file->Reset());
+  return file;
+}
+
+ElementSpillFile::ElementSpillFile(Env* env, std::string filename)
+    : env_(env), filename_(std::move(filename)) {}
+
+ElementSpillFile::~ElementSpillFile() {
+  reader_.reset();
+  if (writer_ != nullptr) {
+    writer_->Close().IgnoreError();
+    writer_.reset();
+  }
+  absl::Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete spill file " << filename_ << ": " << s;
+  }
+}
+
+absl::Status ElementSpillFile::Reset() {
+  reader_.reset();
+  if (writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(writer_->Close());
+  }
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(filename_, &writer_));
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_));
+  size_ = 0;
+  flushed_size_ = 0;
+  taken_size_ = 0;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ElementSpillFile::Handle> ElementSpillFile::Write(
+    const std::vector<Tensor>& element) {
+  std::string block;
+  core::PutVarint64(&block, element.size());
+  for (const Tensor& tensor : element) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::DataLoss("Failed to serialize a spilled tensor.");
+    }
+    core::PutVarint64(&block, serialized.size());
+    block.append(serialized);
+  }
+  core::PutFixed32(&block,
+                   crc32c::Mask(crc32c::Value(block.data(), block.size())));
+  TF_RETURN_IF_ERROR(writer_->Append(block));
+  Handle handle;
+  handle.id = next_id_++;
+  Location& location = locations_[handle.id];
+  location.offset = size_;
+  location.length = block.size();
+  size_ += block.size();
+  return handle;
+}
+
+absl::Status ElementSpillFile::ReadBlock(const Location& location,
+                                         std::string* scratch,
+                                         absl::string_view* block) {
+  if (location.offset + location.length > flushed_size_) {
+    TF_RETURN_IF_ERROR(writer_->Flush());
+    flushed_size_ = size_;
+  }
+  scratch->resize(location.length);
+  TF_RETURN_IF_ERROR(
+      reader_->Read(location.offset, location.length, block, &(*scratch)[0]));
+  if (block->size() != location.length) {
+    return errors::DataLoss("Truncated read from spill file ", filename_);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillFile::Read(const Handle& handle,
+                                    std::vector<Tensor>* element) {
+  auto it = locations_.find(handle.id);
+  if (it == locations_.end() || it->second.length < sizeof(uint32)) {
+    return errors::InvalidArgument("Invalid spill file handle ", handle.id);
+  }
+  const Location& location = it->second;
+  std::string scratch;
+  absl::string_view block;
+  TF_RETURN_IF_ERROR(ReadBlock(location, &scratch, &block));
+  const size_t data_length = block.size() - sizeof(uint32);
+  const uint32 expected_crc =
+      crc32c::Unmask(core::DecodeFixed32(block.data() + data_length));
+  if (crc32c::Value(block.data(), data_length) != expected_crc) {
+    return errors::DataLoss("Corrupted element in spill file ", filename_,
+                            " at offset ", location.offset);
+  }
+  absl::string_view input = block.substr(0, data_length);
+  uint64 num_components;
+  if (!core::GetVarint64(&input, &num_components)) {
+    return errors::DataLoss("Corrupted element in spill file ", filename_);
+  }
+  element->clear();
+  element->resize(num_components);
+  for (Tensor& tensor : *element) {
+    uint64 length;
+    if (!core::GetVarint64(&input, &length) || length > input.size()) {
+      return errors::DataLoss("Corrupted element in spill file ", filename_);
+    }
+    TensorProto proto;
+    if (!proto.ParseFromArray(input.data(), length) ||
+        !tensor.FromProto(proto)) {
+      return errors::DataLoss("Unable to parse a spilled tensor from ",
+                              filename_);
+    }
+    input.remove_prefix(length);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillFile::Take(const Handle& handle,
+                                    std::vector<Tensor>* element) {
+  TF_RETURN_IF_ERROR(Read(handle, element));
+  auto it = locations_.find(handle.id);
+  taken_size_ += it->second.length;
+  locations_.erase(it);
+  if (locations_.empty()) {
+    // Every spilled element has been read back, so the space can be reused.
+    return Reset();
+  }
+  if (size_ >= kMinCompactionSize && taken_size_ > size_ / 2) {
+    return Compact();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElementSpillFile::Compact() {
+  // Copy the remaining blocks in file order, so that the new file is written
+  // sequentially.
+  std::vector<std::pair<uint64_t, Location*>> remaining;
+  remaining.reserve(locations_.size());
+  for (auto& [id, location] : locations_) {
+    remaining.emplace_back(location.offset, &location);
+  }
+  std::sort(remaining.begin(), remaining.end());
+
+  const std::string compacted_filename = absl::StrCat(filename_, ".compact");
+  std::unique_ptr<WritableFile> compacted;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(compacted_filename, &compacted));
+  std::vector<Location> new_locations;
+  new_locations.reserve(remaining.size());
+  uint64_t new_size = 0;
+  std::string scratch;
+  for (const auto& [offset, location] : remaining) {
+    absl::string_view block;
+    TF_RETURN_IF_ERROR(ReadBlock(*location, &scratch, &block));
+    TF_RETURN_IF_ERROR(compacted->Append(block));
+    new_locations.push_back({new_size, location->length});
+    new_size += location->length;
+  }
+  TF_RETURN_IF_ERROR(compacted->Close());
+
+  reader_.reset();
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(env_->RenameFile(compacted_filename, filename_));
+  TF_RETURN_IF_ERROR(env_->NewAppendableFile(filename_, &writer_));
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_));
+  for (size_t i = 0; i < remaining.size(); ++i) {
+    *remaining[i].second = new_locations[i];
+  }
+  VLOG(2) << "Compacted spill file " << filename_ << " from " << size_
+          << " to " << new_size << " bytes";
+  size_ = new_size;
+  flushed_size_ = new_size;
+  taken_size_ = 0;
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_ELEMENT_SPILL_FILE_H_
+#define TENSORFLOW_CORE_DATA_ELEMENT_SPILL_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// A local scratch file that holds dataset elements evicted from memory.
+//
+// Each element is appended as one block: the number of components, then the
+// length-prefixed serialized `TensorProto` of every component, followed by a
+// masked CRC32C of the block. Elements are read back individually at random.
+// Once every spilled element has been taken back, the file is truncated. When
+// more than half of a large file consists of taken elements, the remaining
+// elements are copied to a fresh file so that its size stays proportional to
+// the number of spilled bytes. The file is deleted when the `ElementSpillFile`
+// is destroyed. Not thread-safe.
+class ElementSpillFile {
+ public:
+  // Identifies a spilled element. Handles stay valid across compactions.
+  struct Handle {
+    uint64_t id = 0;
+  };
+
+  // Creates a spill file in a local temporary directory.
+  static absl::StatusOr<std::unique_ptr<ElementSpillFile>> Create(Env* env);
+
+  // Creates a spill file in `directory`, e.g. on a local SSD. The directory is
+  // created if it does not exist.
+  static absl::StatusOr<std::unique_ptr<ElementSpillFile>> Create(
+      Env* env, const std::string& directory);
+
+  ~ElementSpillFile();
+
+  // Appends `element` to the file and returns its location.
+  absl::StatusOr<Handle> Write(const std::vector<Tensor>& element);
+
+  // Reads the element at `handle` into `element`, keeping it in the file.
+  absl::Status Read(const Handle& handle, std::vector<Tensor>* element);
+
+  // Reads the element at `handle` into `element` and releases it. Each handle
+  // must be taken at most once.
+  absl::Status Take(const Handle& handle, std::vector<Tensor>* element);
+
+  // Number of elements written and not yet taken.
+  int64_t num_elements() const { return locations_.size(); }
+
+  // Number of bytes currently used by the file.
+  uint64_t size() const { return size_; }
+
+ private:
+  ElementSpillFile(Env* env, std::string filename);
+
+  // Location of a spilled element in the file.
+  struct Location {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+  };
+
+  // Creates (or truncates) the file and opens it for reading.
+  absl::Status Reset();
+
+  // Reads the raw block at `location`, using `scratch` as backing storage.
+  absl::Status ReadBlock(const Location& location, std::string* scratch,
+                         absl::string_view* block);
+
+  // Rewrites the file with only the elements that have not been taken.
+  absl::Status Compact();
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> writer_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  uint64_t size_ = 0;
+  // Number of bytes of the file that are guaranteed to be visible to
+  // `reader_`.
+  uint64_t flushed_size_ = 0;
+  // Number of bytes of the file that belong to taken elements.
+  uint64_t taken_size_ = 0;
+  uint64_t next_id_ = 0;
+  absl::flat_hash_map<uint64_t, Location> locations_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_ELEMENT_SPILL_FILE_H_
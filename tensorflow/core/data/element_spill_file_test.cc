@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/element_spill_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<tstring>({std::string(i + 1, 'x')})};
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i) {
+  std::vector<Tensor> expected = MakeElement(i);
+  ASSERT_EQ(element.size(), expected.size());
+  test::ExpectEqual(element[0], expected[0]);
+  test::ExpectEqual(element[1], expected[1]);
+}
+
+TEST(ElementSpillFileTest, RandomOrderReads) {
+  auto file = ElementSpillFile::Create(Env::Default());
+  TF_ASSERT_OK(file.status());
+  std::vector<ElementSpillFile::Handle> handles;
+  for (int64_t i = 0; i < 10; ++i) {
+    auto handle = (*file)->Write(MakeElement(i));
+    TF_ASSERT_OK(handle.status());
+    handles.push_back(*handle);
+  }
+  EXPECT_EQ((*file)->num_elements(), 10);
+
+  std::vector<Tensor> element;
+  TF_ASSERT_OK((*file)->Read(handles[7], &element));
+  ExpectElement(element, 7);
+  EXPECT_EQ((*file)->num_elements(), 10);
+
+  for (int64_t i : {3, 9, 0, 5, 1, 8, 2, 6, 4, 7}) {
+    TF_ASSERT_OK((*file)->Take(handles[i], &element));
+    ExpectElement(element, i);
+  }
+  EXPECT_EQ((*file)->num_elements(), 0);
+  // Taking the last element truncates the file.
+  EXPECT_EQ((*file)->size(), 0);
+}
+
+TEST(ElementSpillFileTest, InterleavedWritesAndTakes) {
+  auto file = ElementSpillFile::Create(Env::Default());
+  TF_ASSERT_OK(file.status());
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 5; ++i) {
+    auto first = (*file)->Write(MakeElement(2 * i));
+    TF_ASSERT_OK(first.status());
+    auto second = (*file)->Write(MakeElement(2 * i + 1));
+    TF_ASSERT_OK(second.status());
+    TF_ASSERT_OK((*file)->Take(*second, &element));
+    ExpectElement(element, 2 * i + 1);
+    TF_ASSERT_OK((*file)->Take(*first, &element));
+    ExpectElement(element, 2 * i);
+  }
+}
+
+TEST(ElementSpillFileTest, SizeStaysBoundedAcrossPutTakeCycles) {
+  auto file = ElementSpillFile::Create(Env::Default());
+  TF_ASSERT_OK(file.status());
+  // Keep a window of live elements so that the file never fully drains and
+  // only compaction can reclaim the space of taken elements.
+  constexpr int64_t kWindow = 8;
+  constexpr int64_t kElementSize = 16 * 1024;
+  std::deque<std::pair<int64_t, ElementSpillFile::Handle>> live;
+  uint64_t max_size = 0;
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 1000; ++i) {
+    auto handle = (*file)->Write(MakeElement(kElementSize + i));
+    TF_ASSERT_OK(handle.status());
+    live.emplace_back(kElementSize + i, *handle);
+    if (live.size() > kWindow) {
+      TF_ASSERT_OK((*file)->Take(live.front().second, &element));
+      ExpectElement(element, live.front().first);
+      live.pop_front();
+    }
+    max_size = std::max(max_size, (*file)->size());
+  }
+  // Without compaction the file would hold all ~16 MiB written so far.
+  EXPECT_LT(max_size, 4 << 20);
+  for (const auto& [i, handle] : live) {
+    TF_ASSERT_OK((*file)->Read(handle, &element));
+    ExpectElement(element, i);
+  }
+  EXPECT_EQ((*file)->num_elements(), kWindow);
+}
+
+TEST(ElementSpillFileTest, CreateInDirectory) {
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "element_spill_file_test", "spill");
+  auto file = ElementSpillFile::Create(Env::Default(), directory);
+  TF_ASSERT_OK(file.status());
+  auto handle = (*file)->Write(MakeElement(3));
+  TF_ASSERT_OK(handle.status());
+  std::vector<Tensor> element;
+  TF_ASSERT_OK((*file)->Read(*handle, &element));
+  ExpectElement(element, 3);
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+TEST(ElementSpillFileTest, InvalidHandle) {
+  auto file = ElementSpillFile::Create(Env::Default());
+  TF_ASSERT_OK(file.status());
+  ElementSpillFile::Handle handle;
+  handle.id = 100;
+  std::vector<Tensor> element;
+  EXPECT_TRUE(absl::IsInvalidArgument((*file)->Read(handle, &element)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
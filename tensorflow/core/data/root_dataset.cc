@@ -23,17 +23,22 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
@@ -94,6 +99,7 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
   }
   params->autotune_ram_budget_from_options =
       options.autotune_options().ram_budget();
+  params->autotune_state_path = options.autotune_options().state_path();
   double ram_budget_share;
   if (experiments.contains("autotune_buffer_optimization")) {
     // When running this experiment, increase the ram_budget since it already
@@ -227,6 +233,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
                                                        prefix(), &input_impl_));
     ctx->MergeCheckpoint(iter_ctx.checkpoint());
+    if (model_ && !dataset()->params_.autotune_state_path.empty()) {
+      InitializeAutotuneState(ctx);
+    }
     return absl::OkStatus();
   }
 
@@ -341,6 +350,47 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     return params;
   }
 
+  // Warm-starts the model from the tuned parameters saved for this input
+  // pipeline, which is identified by its fingerprint, and makes the model save
+  // the parameters it tunes to the same file. Failures only disable the
+  // persistence, as the model can always be tuned from scratch.
+  void InitializeAutotuneState(IteratorContext* ctx) {
+    const std::string& state_path = dataset()->params_.autotune_state_path;
+    std::vector<std::pair<string, Tensor>> input_list;
+    SerializationContext::Params params;
+    params.input_list = &input_list;
+    params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+    // Rewrite serialization leaves out data tensors and random seeds, which
+    // keeps the fingerprint cheap to compute and stable across restarts.
+    params.is_graph_rewrite = true;
+    params.resource_mgr = ctx->resource_mgr();
+    GraphDef graph_def;
+    uint64 fingerprint = 0;
+    absl::Status s =
+        AsGraphDef(dataset()->input_, SerializationContext(params), &graph_def);
+    if (s.ok()) {
+      s = HashGraph(graph_def, &fingerprint);
+    }
+    if (s.ok()) {
+      s = ctx->env()->RecursivelyCreateDir(state_path);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to initialize the autotune state in "
+                   << state_path << ": " << s;
+      return;
+    }
+    const std::string fname = io::JoinPath(
+        state_path, absl::StrCat("autotune_",
+                                 absl::Hex(fingerprint, absl::kZeroPad16),
+                                 ".pb"));
+    s = model_->LoadTunedParameters(fname);
+    if (!s.ok() && !absl::IsNotFound(s)) {
+      LOG(WARNING) << "Failed to warm-start autotuning from " << fname << ": "
+                   << s;
+    }
+    model_->SetTunedParametersFile(fname);
+  }
+
   absl::Status EnsureModelThreadStarted(IteratorContext* ctx) {
     mutex_lock l(mu_);
     if (!model_thread_) {
@@ -54,6 +54,15 @@ absl::Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, absl::string_view key_prefix,
     const std::vector<std::vector<Tensor>>& elements);
 
+// Writes the element at `index` of `elements` to the checkpoint writer using
+// the given key prefix. Callers writing elements one at a time must also write
+// the "num_elements" scalar under `key_prefix`, as WriteElementsToCheckpoint
+// does.
+absl::Status WriteElement(IteratorStateWriter* writer,
+                          absl::string_view key_prefix,
+                          const std::vector<std::vector<Tensor>>& elements,
+                          int64_t index);
+
 // Updates the dataset elements in the checkpoint for given `checkpoint_indices`
 // using the given key prefix, assuming that vector of elements have
 // checkpointed these before. The elements can be read back by passing the same
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -44,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
@@ -55,18 +57,44 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/retrying_utils.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
+// Upper bounds for a single batched element request.
+constexpr int64_t kMaxElementsPerRequest = 64;
+constexpr int64_t kMaxBytesPerRequest = 16 * 1024 * 1024;  // 16MB
+// Weight of the newest sample in the rate moving averages.
+constexpr double kRateSmoothingFactor = 0.1;
+
+void UpdateMovingAverage(double sample, double& average) {
+  average = average == 0.0 ? sample
+                           : kRateSmoothingFactor * sample +
+                                 (1 - kRateSmoothingFactor) * average;
+}
+
+TopologyLabels GetClientTopology() {
+  TopologyLabels topology;
+  std::string zone, rack;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_DATA_SERVICE_CLIENT_ZONE", "", &zone));
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_DATA_SERVICE_CLIENT_RACK", "", &rack));
+  topology.set_zone(zone);
+  topology.set_rack(rack);
+  topology.set_host(port::Hostname());
+  return topology;
+}
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -89,6 +117,9 @@ absl::StatusOr<DataTransferServerInfo> GetTransferServer(
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      topology_(GetClientTopology()),
+      prefer_nearby_workers_(!topology_.zone().empty() ||
+                             !topology_.rack().empty()),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -425,6 +456,21 @@ DataServiceClient::CreateWorkerClient(const TaskInfo& task_info) {
     metrics::RecordTFDataServiceDataTransferProtocolFallback(
         default_protocol, error::Code::NOT_FOUND,
         "Failed to find transfer server for default protocol");
+    return CreateGrpcWorkerClient(task_info);
+  }
+  // Workers on the same host that serve elements over shared memory are read
+  // from without going through gRPC. Compressed elements are variants, which
+  // can't be shared without copying, so this is only worth it for datasets
+  // without compression. Clients that request "shm" explicitly disable
+  // compression at runtime instead.
+  if (params_.metadata.compression() == DataServiceMetadata::COMPRESSION_OFF) {
+    if (absl::StatusOr<DataTransferServerInfo> shm_transfer_server =
+            GetTransferServer(kShmTransferProtocol, task_info);
+        shm_transfer_server.ok() &&
+        IsLocalShmTransferServer(*shm_transfer_server)) {
+      return CreateAlternativeWorkerClientMaybeWithGrpcFallback(
+          *shm_transfer_server, task_info);
+    }
   }
   return CreateGrpcWorkerClient(task_info);
 }
@@ -436,7 +482,9 @@ absl::Status DataServiceClient::AddTask(const TaskInfo& task_info)
   metrics::RecordTFDataServiceDataTransferProtocolUsed(
       worker->GetDataTransferProtocol(),
       /*user_specified=*/!params_.data_transfer_protocol.empty());
-  tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
+  tasks_.push_back(std::make_shared<Task>(
+      task_info, GetLocalityTier(topology_, task_info.worker_topology()),
+      std::move(worker)));
   worker_thread_cv_.notify_one();
   if (IsCoordinatedRead()) {
     VLOG(1) << "Consumer " << params_.consumer_index.value() << " adding task "
@@ -631,6 +679,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
   int64_t num_consecutive_skipped = 0;
   constexpr int64_t MAX_ROUND_FALLBACK_TO_BLOCKING = 5;
   bool allow_skip = true;
+  int64_t max_elements = 1;
 
   while (true) {
     std::shared_ptr<Result> result;
@@ -639,6 +688,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       if (task_to_process) {
         task_to_process->in_use = false;
         --outstanding_requests_;
+        reserved_elements_ -= max_elements;
         task_to_process = nullptr;
         worker_thread_cv_.notify_one();
       }
@@ -656,7 +706,9 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       }
       DCHECK(task_to_process != nullptr);
       task_to_process->in_use = true;
+      max_elements = ElementsPerRequest();
       ++outstanding_requests_;
+      reserved_elements_ += max_elements;
       if (IsCoordinatedRead()) {
         // Reserve a spot in the results_ queue.
         results_.push(std::make_shared<Result>());
@@ -671,13 +723,14 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
     int64_t deadline_micros = kint64max;
     absl::Status s = GetElementTraced(task_to_process.get(), deadline_micros,
                                       /*enqueue_result=*/!IsCoordinatedRead(),
-                                      allow_skip, result);
+                                      allow_skip, max_elements, result);
     if (!s.ok()) {
       mutex_lock l(mu_);
       VLOG(1) << "Failed to get element from worker "
               << task_to_process->info.worker_address() << ": " << s;
       task_to_process->in_use = false;
       --outstanding_requests_;
+      reserved_elements_ -= max_elements;
       status_ = errors::CreateWithUpdatedMessage(
           s, absl::StrCat("Failed to get element from worker ",
                           task_to_process->info.worker_address(), ": ",
@@ -715,9 +768,9 @@ bool DataServiceClient::ShouldProcessTask() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return results_.size() < max_outstanding_requests_;
   }
   // Otherwise, results aren't added to `results_` until the data has been
-  // successfully retrieved. We need to count requests already added to
-  // `results_` as well as in-progress requests.
-  return results_.size() + outstanding_requests_ < max_outstanding_requests_;
+  // successfully retrieved. We need to count results already added to
+  // `results_` as well as the slots reserved by in-progress requests.
+  return results_.size() + reserved_elements_ < max_outstanding_requests_;
 }
 
 // Searches for a task to process, visiting tasks in-order and giving every
@@ -728,6 +781,12 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
     return nullptr;
   }
 
+  // Unless the consumer is waiting for data, uncoordinated reads stay on the
+  // closest workers that still have data, to save cross-rack bandwidth.
+  std::optional<LocalityTier> farthest_tier;
+  if (prefer_nearby_workers_ && !IsCoordinatedRead() && !results_.empty()) {
+    farthest_tier = ClosestLocalityTier();
+  }
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
@@ -751,6 +810,13 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
       AdvanceTaskIndex();
       continue;
     }
+    if (farthest_tier.has_value() && task->locality_tier > *farthest_tier) {
+      VLOG(3) << "Skipping task " << next_task_index_ << " in locality tier "
+              << LocalityTierToString(task->locality_tier)
+              << " while the consumer is not waiting for data.";
+      AdvanceTaskIndex();
+      continue;
+    }
     task->round = current_round_;
     AdvanceTaskIndex();
     return task;
@@ -758,6 +824,17 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+LocalityTier DataServiceClient::ClosestLocalityTier() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  LocalityTier closest_tier = LOCALITY_TIER_REMOTE;
+  for (const std::shared_ptr<Task>& task : tasks_) {
+    if (!task->end_of_sequence && !task->removed) {
+      closest_tier = std::min(closest_tier, task->locality_tier);
+    }
+  }
+  return closest_tier;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -768,8 +845,33 @@ void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   }
 }
 
-absl::Status DataServiceClient::TryGetElement(const Task& task, bool allow_skip,
-                                              GetElementResult& result) {
+int64_t DataServiceClient::ElementsPerRequest() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Coordinated reads and cross-trainer cache reads hand out one element per
+  // request by design.
+  if (IsCoordinatedRead() || params_.cross_trainer_cache_options ||
+      consumer_interval_us_ <= 0.0 || request_latency_us_ <= 0.0) {
+    return 1;
+  }
+  // Each of the worker threads needs `latency / interval` elements per request
+  // for the requests in flight to cover the consumer's reads.
+  const double num_threads =
+      std::max<int64_t>(num_running_worker_threads_, int64_t{1});
+  const int64_t desired = static_cast<int64_t>(
+      std::ceil(request_latency_us_ / (consumer_interval_us_ * num_threads)));
+  // Never hold more than `max_outstanding_requests_` elements, counting the
+  // slots reserved by the requests in flight.
+  const int64_t free_slots =
+      max_outstanding_requests_ - static_cast<int64_t>(results_.size()) -
+      reserved_elements_;
+  return std::clamp<int64_t>(
+      desired, 1, std::min(kMaxElementsPerRequest, std::max<int64_t>(
+                                                       free_slots, 1)));
+}
+
+absl::Status DataServiceClient::TryGetElement(
+    const Task& task, bool allow_skip, int64_t max_elements,
+    std::vector<GetElementResult>& results) {
   GetElementRequest req;
   req.set_task_id(task.info.task_id());
   req.set_skipped_previous_round(task.skipped_previous_round);
@@ -783,7 +885,14 @@ absl::Status DataServiceClient::TryGetElement(const Task& task, bool allow_skip,
   if (params_.cross_trainer_cache_options) {
     req.set_trainer_id(params_.cross_trainer_cache_options->trainer_id());
   }
-  return task.worker->GetElement(req, result);
+  if (max_elements > 1) {
+    return task.worker->GetElements(req, max_elements, kMaxBytesPerRequest,
+                                    results);
+  }
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(task.worker->GetElement(req, result));
+  results.push_back(std::move(result));
+  return absl::OkStatus();
 }
 
 void DataServiceClient::ProcessGetElementResponse(
@@ -794,6 +903,12 @@ void DataServiceClient::ProcessGetElementResponse(
   result->end_of_sequence = get_element_result.end_of_sequence;
   result->skip = get_element_result.skip;
   if (!get_element_result.end_of_sequence && !get_element_result.skip) {
+    int64_t bytes = 0;
+    for (const Tensor& component : get_element_result.components) {
+      bytes += component.TotalBytes();
+    }
+    metrics::RecordTFDataServiceClientRead(
+        LocalityTierToString(task.locality_tier), bytes);
     task.skipped_previous_round = false;
     result->element = std::move(get_element_result.components);
     result->element_index = get_element_result.element_index;
@@ -813,7 +928,8 @@ void DataServiceClient::ProcessGetElementResponse(
 
 absl::Status DataServiceClient::GetElementTraced(
     Task* task, int64_t deadline_micros, bool enqueue_result, bool allow_skip,
-    std::shared_ptr<Result> result) TF_LOCKS_EXCLUDED(mu_) {
+    int64_t max_elements, std::shared_ptr<Result> result)
+    TF_LOCKS_EXCLUDED(mu_) {
   VLOG(3) << "Getting an element for task id " << task->info.task_id();
   tsl::profiler::TraceMe activity("GetDataServiceElement",
                                   tsl::profiler::TraceMeLevel::kInfo);
@@ -830,8 +946,8 @@ absl::Status DataServiceClient::GetElementTraced(
            {"round_index", task->round}});
     });
   }
-  absl::Status s =
-      GetElement(task, deadline_micros, enqueue_result, allow_skip, result);
+  absl::Status s = GetElement(task, deadline_micros, enqueue_result,
+                              allow_skip, max_elements, result);
   mutex_lock l(mu_);
   VLOG(3) << "Got an element for task id " << task->info.task_id();
   return s;
@@ -870,15 +986,22 @@ absl::Status DataServiceClient::MaybeRemoveTask(Task& task,
 
 absl::Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                                            bool enqueue_result, bool allow_skip,
+                                           int64_t max_elements,
                                            std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
-  GetElementResult get_element_result;
+  std::vector<GetElementResult> get_element_results;
   while (true) {
-    absl::Status s = TryGetElement(*task, allow_skip, get_element_result);
+    const int64_t start_us = Env::Default()->NowMicros();
+    absl::Status s =
+        TryGetElement(*task, allow_skip, max_elements, get_element_results);
     if (s.ok()) {
       task->num_retries = 0;
+      mutex_lock l(mu_);
+      UpdateMovingAverage(Env::Default()->NowMicros() - start_us,
+                          request_latency_us_);
       break;
     }
+    get_element_results.clear();
     if (!IsPreemptedError(s)) {
       if (task->worker->GetDataTransferProtocol() == kGrpcTransferProtocol ||
           task->worker->GetDataTransferProtocol() == kLocalTransferProtocol) {
@@ -944,7 +1067,14 @@ absl::Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
       return absl::OkStatus();
     }
   }
-  ProcessGetElementResponse(enqueue_result, get_element_result, result, *task);
+  ProcessGetElementResponse(enqueue_result, get_element_results[0], result,
+                            *task);
+  // Additional elements from a batched request are only ever received for
+  // uncoordinated reads, whose results are enqueued once ready.
+  for (size_t i = 1; i < get_element_results.size(); ++i) {
+    ProcessGetElementResponse(enqueue_result, get_element_results[i],
+                              std::make_shared<Result>(), *task);
+  }
   return absl::OkStatus();
 }
 
@@ -957,6 +1087,13 @@ std::shared_ptr<DataServiceClient::Result> DataServiceClient::PopNextResult()
   std::shared_ptr<Result> result = results_.front();
   results_.pop();
   ctx_->RecordBufferDequeue(result->element);
+  if (!result->skip) {
+    const int64_t now_us = Env::Default()->NowMicros();
+    if (last_consumed_us_ > 0) {
+      UpdateMovingAverage(now_us - last_consumed_us_, consumer_interval_us_);
+    }
+    last_consumed_us_ = now_us;
+  }
   return result;
 }
 
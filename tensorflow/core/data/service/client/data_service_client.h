@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/data_service.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -99,10 +100,13 @@ class DataServiceClient {
 
  private:
   struct Task {
-    Task(const TaskInfo& info, std::unique_ptr<DataServiceWorkerClient> worker)
-        : info(info), worker(std::move(worker)) {}
+    Task(const TaskInfo& info, LocalityTier locality_tier,
+         std::unique_ptr<DataServiceWorkerClient> worker)
+        : info(info), locality_tier(locality_tier), worker(std::move(worker)) {}
 
     const TaskInfo info;
+    // How close the task's worker is to this client.
+    const LocalityTier locality_tier;
     // Client for fetching task elements from the tf.data service worker.
     std::unique_ptr<DataServiceWorkerClient> worker;
     // The next round to read from the task.
@@ -178,26 +182,40 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // Returns the closest locality tier among tasks that still have data.
+  LocalityTier ClosestLocalityTier() const;
   void AdvanceTaskIndex();
+  // Returns how many elements the next request should ask for, so that
+  // requests in flight keep up with the rate at which the consumer reads.
+  int64_t ElementsPerRequest() const;
   absl::Status TryGetElement(const Task& task, bool allow_skip,
-                             GetElementResult& result);
+                             int64_t max_elements,
+                             std::vector<GetElementResult>& results);
   void ProcessGetElementResponse(bool enqueue_result,
                                  GetElementResult& get_element_result,
                                  std::shared_ptr<Result> result, Task& task);
   absl::Status GetElementTraced(Task* task, int64_t deadline_micros,
                                 bool enqueue_result, bool allow_skip,
+                                int64_t max_elements,
                                 std::shared_ptr<Result> result);
   absl::Status MaybeRemoveTask(Task& task, int64_t deadline_micros,
                                Result& result);
   absl::Status GetElement(Task* task, int64_t deadline_micros,
                           bool enqueue_result, bool allow_skip,
-                          std::shared_ptr<Result> result);
+                          int64_t max_elements, std::shared_ptr<Result> result);
   bool ResultReady() const;
   std::shared_ptr<Result> PopNextResult();
   bool IsCoordinatedRead() const;
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // Where this client runs in the network. The zone and rack are read from the
+  // TF_DATA_SERVICE_CLIENT_ZONE and TF_DATA_SERVICE_CLIENT_RACK environment
+  // variables.
+  const TopologyLabels topology_;
+  // If true, uncoordinated reads only fall back to farther workers when the
+  // consumer is waiting for data. Set when the client has a zone or a rack.
+  const bool prefer_nearby_workers_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
@@ -209,6 +227,11 @@ class DataServiceClient {
   // Number of outstanding requests.
   int64_t outstanding_requests_ TF_GUARDED_BY(mu_) = 0;
 
+  // Number of elements that outstanding requests may return. A request for up
+  // to `n` elements reserves `n` slots before it is issued, so that batched
+  // requests never exceed `max_outstanding_requests_`.
+  int64_t reserved_elements_ TF_GUARDED_BY(mu_) = 0;
+
   // max_outstanding_requests controls how many elements may be held in memory
   // at the same time. This count includes both in-progress requests for
   // elements as well as completed requests which haven't yet been produced.
@@ -258,6 +281,13 @@ class DataServiceClient {
 
   int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Exponential moving averages of the time between elements consumed by
+  // `GetNext` and of the latency of element requests to workers, in
+  // microseconds. Used to size batched element requests.
+  double consumer_interval_us_ TF_GUARDED_BY(mu_) = 0.0;
+  double request_latency_us_ TF_GUARDED_BY(mu_) = 0.0;
+  int64_t last_consumed_us_ TF_GUARDED_BY(mu_) = 0;
+
   bool iteration_finished_ TF_GUARDED_BY(mu_) = false;
   bool should_finish_iteration_ TF_GUARDED_BY(mu_) = true;
 
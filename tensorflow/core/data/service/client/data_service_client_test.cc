@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/client/data_service_client.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
@@ -104,6 +106,30 @@ std::unique_ptr<TestDataServiceContext> GetTestDataServiceContext() {
   return std::make_unique<TestDataServiceContext>();
 }
 
+// Tracks how many elements the client buffers at the same time.
+class BufferTrackingContext : public TestDataServiceContext {
+ public:
+  void RecordBufferEnqueue(const std::vector<Tensor>& element) override {
+    mutex_lock l(mu_);
+    ++buffered_;
+    max_buffered_ = std::max(max_buffered_, buffered_);
+  }
+  void RecordBufferDequeue(const std::vector<Tensor>& element) override {
+    mutex_lock l(mu_);
+    --buffered_;
+  }
+
+  int64_t max_buffered() const {
+    mutex_lock l(mu_);
+    return max_buffered_;
+  }
+
+ private:
+  mutable mutex mu_;
+  int64_t buffered_ TF_GUARDED_BY(mu_) = 0;
+  int64_t max_buffered_ TF_GUARDED_BY(mu_) = 0;
+};
+
 template <class T>
 StatusOr<std::vector<T>> GetResults(DataServiceClient& client) {
   std::vector<T> results;
@@ -181,6 +207,41 @@ TEST(DataServiceClientTest, StaticSharding) {
   client.Cancel();
 }
 
+TEST(DataServiceClientTest, BatchedRequestsRespectMaxOutstandingRequests) {
+  TestCluster test_cluster(/*num_workers=*/3);
+  TF_ASSERT_OK(test_cluster.Initialize());
+  DatasetClient<int64_t> test_dataset(test_cluster);
+  TF_ASSERT_OK_AND_ASSIGN(std::string dataset_id,
+                          test_dataset.RegisterDataset(RangeDataset(300)));
+
+  DataServiceParams params = GetDataServiceParams(
+      dataset_id, test_cluster.DispatcherAddress(), ProcessingModeDef::OFF);
+  params.max_outstanding_requests = 4;
+  DataServiceClient client(params);
+  TF_ASSERT_OK(client.Initialize(/*accelerator_device_info=*/nullptr,
+                                 /*allocator=*/nullptr));
+
+  auto context = std::make_unique<BufferTrackingContext>();
+  BufferTrackingContext* ctx = context.get();
+  auto context_factory = [&context]() -> std::unique_ptr<DataServiceContext> {
+    return std::move(context);
+  };
+  // A slow consumer makes the client batch several elements per request.
+  int64_t num_elements = 0;
+  while (true) {
+    TF_ASSERT_OK_AND_ASSIGN(GetNextResult next,
+                            client.GetNext(context_factory));
+    if (next.end_of_sequence) {
+      break;
+    }
+    ++num_elements;
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_EQ(num_elements, 900);
+  EXPECT_LE(ctx->max_buffered(), params.max_outstanding_requests);
+  client.Cancel();
+}
+
 TEST(DataServiceClientTest, RecordBufferEvents) {
   TestCluster test_cluster(/*num_workers=*/1);
   TF_ASSERT_OK(test_cluster.Initialize());
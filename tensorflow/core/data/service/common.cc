@@ -131,6 +131,38 @@ absl::StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s) {
                                  "COLOCATED, REMOTE, and HYBRID.");
 }
 
+LocalityTier GetLocalityTier(const TopologyLabels& client,
+                             const TopologyLabels& worker) {
+  if (!client.host().empty() && client.host() == worker.host()) {
+    return LOCALITY_TIER_HOST;
+  }
+  if (client.zone() != worker.zone()) {
+    return LOCALITY_TIER_REMOTE;
+  }
+  if (!client.rack().empty() && client.rack() == worker.rack()) {
+    return LOCALITY_TIER_RACK;
+  }
+  if (!client.zone().empty()) {
+    return LOCALITY_TIER_ZONE;
+  }
+  return LOCALITY_TIER_REMOTE;
+}
+
+std::string LocalityTierToString(LocalityTier locality_tier) {
+  switch (locality_tier) {
+    case LOCALITY_TIER_HOST:
+      return "host";
+    case LOCALITY_TIER_RACK:
+      return "rack";
+    case LOCALITY_TIER_ZONE:
+      return "zone";
+    case LOCALITY_TIER_REMOTE:
+      return "remote";
+    default:
+      return "unspecified";
+  }
+}
+
 bool IsPreemptedError(const absl::Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
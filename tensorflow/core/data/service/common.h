@@ -85,6 +85,15 @@ std::string TargetWorkersToString(TargetWorkers target_workers);
 // Returns InvalidArgument if the string is not recognized.
 absl::StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 
+// Returns how close a worker at `worker` is to a client at `client`. Labels
+// only match when they are non-empty, and a rack only matches within the same
+// zone.
+LocalityTier GetLocalityTier(const TopologyLabels& client,
+                             const TopologyLabels& worker);
+
+// Converts a `LocalityTier` enum to a lowercase string, e.g. "rack".
+std::string LocalityTierToString(LocalityTier locality_tier);
+
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const absl::Status& status);
 
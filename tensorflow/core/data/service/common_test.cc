@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
@@ -170,6 +172,47 @@ TEST(CommonTest, ParseInvalidDeploymentMode) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TopologyLabels Labels(absl::string_view zone, absl::string_view rack,
+                      absl::string_view host) {
+  TopologyLabels labels;
+  labels.set_zone(std::string(zone));
+  labels.set_rack(std::string(rack));
+  labels.set_host(std::string(host));
+  return labels;
+}
+
+TEST(CommonTest, GetLocalityTier) {
+  const TopologyLabels client = Labels("zone1", "rack1", "host1");
+  EXPECT_EQ(GetLocalityTier(client, Labels("zone1", "rack1", "host1")),
+            LOCALITY_TIER_HOST);
+  EXPECT_EQ(GetLocalityTier(client, Labels("zone1", "rack1", "host2")),
+            LOCALITY_TIER_RACK);
+  EXPECT_EQ(GetLocalityTier(client, Labels("zone1", "rack2", "host2")),
+            LOCALITY_TIER_ZONE);
+  EXPECT_EQ(GetLocalityTier(client, Labels("zone2", "rack1", "host2")),
+            LOCALITY_TIER_REMOTE);
+  EXPECT_EQ(GetLocalityTier(client, Labels("", "", "")), LOCALITY_TIER_REMOTE);
+}
+
+TEST(CommonTest, GetLocalityTierWithMissingLabels) {
+  EXPECT_EQ(GetLocalityTier(Labels("", "", "host1"), Labels("", "", "host1")),
+            LOCALITY_TIER_HOST);
+  EXPECT_EQ(GetLocalityTier(Labels("", "rack1", "host1"),
+                            Labels("", "rack1", "host2")),
+            LOCALITY_TIER_RACK);
+  EXPECT_EQ(GetLocalityTier(Labels("", "", "host1"), Labels("", "", "host2")),
+            LOCALITY_TIER_REMOTE);
+  EXPECT_EQ(GetLocalityTier(Labels("", "", ""), Labels("", "", "")),
+            LOCALITY_TIER_REMOTE);
+}
+
+TEST(CommonTest, LocalityTierToString) {
+  EXPECT_EQ(LocalityTierToString(LOCALITY_TIER_HOST), "host");
+  EXPECT_EQ(LocalityTierToString(LOCALITY_TIER_RACK), "rack");
+  EXPECT_EQ(LocalityTierToString(LOCALITY_TIER_ZONE), "zone");
+  EXPECT_EQ(LocalityTierToString(LOCALITY_TIER_REMOTE), "remote");
+}
+
 TEST(CommonTest, IsPreemptedError) {
   EXPECT_TRUE(IsPreemptedError(errors::Aborted("Aborted")));
   EXPECT_TRUE(IsPreemptedError(errors::Cancelled("Cancelled")));
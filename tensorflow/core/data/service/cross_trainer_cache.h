@@ -15,13 +15,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/byte_size.h"
@@ -46,6 +49,10 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory are appended to a
+// `CrossTrainerCacheSpill`, e.g. a log on local disk. Trainers that fall behind
+// the in-memory window then read from the spill instead of skipping ahead.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -91,6 +98,27 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// Second tier of a `CrossTrainerCache` that holds elements evicted from memory.
+// Evicted elements are appended in order, so the element at absolute index `i`
+// of the sequence is the `i`-th element appended. Implementations may drop
+// their oldest elements to bound their size. Implementations must be
+// thread-safe.
+template <class ElementType>
+class CrossTrainerCacheSpill {
+ public:
+  virtual ~CrossTrainerCacheSpill() = default;
+
+  // Appends `element`, the next element evicted from memory.
+  virtual absl::Status Append(const ElementType& element) = 0;
+
+  // Reads the element at absolute index `index`. Returns an OutOfRange error if
+  // the element has been dropped.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Returns the absolute index of the oldest element that can be read.
+  virtual size_t StartIndex() const = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -98,9 +126,11 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  // If `spill` is not null, elements evicted from memory are written to it.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CrossTrainerCacheSpill<ElementType>> spill = nullptr);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -134,6 +164,10 @@ class CrossTrainerCache {
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been evicted from
+  // memory and should be read from `spill_`.
+  bool IsElementSpilled(const std::string& trainer_id);
+
   // Returns the absolute element index relative to the dataset (not relative to
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
@@ -145,6 +179,10 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   absl::Status ExtendCache();
 
+  // Appends the elements `FreeSpace(new_element_size_bytes)` will evict to
+  // `spill_`. Must only be called by the thread extending the cache.
+  absl::Status SpillElements(size_t new_element_size_bytes);
+
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
@@ -158,6 +196,9 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Optional second tier for elements evicted from memory.
+  const std::unique_ptr<CrossTrainerCacheSpill<ElementType>> spill_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -169,6 +210,8 @@ class CrossTrainerCache {
   std::deque<std::shared_ptr<const ElementType>> cache_ TF_GUARDED_BY(mu_);
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
+  // Absolute index of the next element to append to `spill_`.
+  size_t spill_end_index_ TF_GUARDED_BY(mu_) = 0;
 
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
@@ -183,9 +226,11 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CrossTrainerCacheSpill<ElementType>> spill)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_(std::move(spill)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
@@ -212,20 +257,22 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      if (IsElementSpilled(trainer_id)) {
+        spilled_index = GetElementIndex(trainer_id);
+        trainer_to_element_index_map_[trainer_id] = *spilled_index + 1;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
                                 /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+      } else if (extending_cache_) {
+        // Waits for another thread to extend the cache. When concurrent
+        // trainers wait for the next element, only one of them should extend
+        // the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +281,20 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_index.has_value()) {
+      // Reads from the spill without holding `mu_`, so that trainers reading
+      // from memory are not blocked on disk reads.
+      StatusOr<ElementType> element = spill_->Read(*spilled_index);
+      if (errors::IsOutOfRange(element.status())) {
+        // The element was dropped from the spill in the meantime.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{
+          std::make_shared<const ElementType>(std::move(*element)),
+          /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
       absl::Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -250,6 +311,12 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
   return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementSpilled(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return spill_ != nullptr && GetElementIndex(trainer_id) < cache_start_index_;
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
@@ -271,8 +338,11 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  const size_t start_index =
+      spill_ != nullptr ? std::min(spill_->StartIndex(), cache_start_index_)
+                        : cache_start_index_;
+  if (element_index < start_index) {
+    element_index = start_index;
   }
   return element_index;
 }
@@ -289,6 +359,9 @@ absl::Status CrossTrainerCache<ElementType>::ExtendCache()
         "element size: ", new_element_size_bytes,
         " and cache size: ", max_cache_size_bytes_);
   }
+  if (spill_ != nullptr) {
+    TF_RETURN_IF_ERROR(SpillElements(new_element_size_bytes));
+  }
 
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
@@ -298,6 +371,38 @@ absl::Status CrossTrainerCache<ElementType>::ExtendCache()
   return absl::OkStatus();
 }
 
+template <class ElementType>
+absl::Status CrossTrainerCache<ElementType>::SpillElements(
+    size_t new_element_size_bytes) TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<std::shared_ptr<const ElementType>> elements_to_spill;
+  size_t spill_end_index = 0;
+  {
+    mutex_lock l(mu_);
+    size_t cache_size_bytes = cache_size_bytes_;
+    for (size_t i = 0; i < cache_.size() && cache_size_bytes +
+                                                    new_element_size_bytes >
+                                                max_cache_size_bytes_;
+         ++i) {
+      cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*cache_[i]);
+      // Elements appended by an earlier, failed extension are not re-appended.
+      if (cache_start_index_ + i >= spill_end_index_) {
+        elements_to_spill.push_back(cache_[i]);
+      }
+    }
+    spill_end_index = spill_end_index_;
+  }
+
+  // Only the thread extending the cache evicts elements, so the elements stay
+  // in memory until they have been spilled.
+  for (const std::shared_ptr<const ElementType>& element : elements_to_spill) {
+    TF_RETURN_IF_ERROR(spill_->Append(*element));
+    ++spill_end_index;
+    mutex_lock l(mu_);
+    spill_end_index_ = spill_end_index;
+  }
+  return absl::OkStatus();
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_spill_log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/element_spill_file.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+
+absl::StatusOr<std::unique_ptr<CrossTrainerCacheSpillLog>>
+CrossTrainerCacheSpillLog::Create(Env* env, const std::string& directory,
+                                  size_t max_size_bytes) {
+  if (max_size_bytes == 0) {
+    return errors::InvalidArgument(
+        "tf.data service cross-trainer cache spill size must be positive.");
+  }
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  return absl::WrapUnique(
+      new CrossTrainerCacheSpillLog(env, directory, max_size_bytes));
+}
+
+CrossTrainerCacheSpillLog::CrossTrainerCacheSpillLog(
+    Env* env, const std::string& directory, size_t max_size_bytes)
+    : env_(env), directory_(directory), max_size_bytes_(max_size_bytes) {}
+
+absl::Status CrossTrainerCacheSpillLog::Append(
+    const GetElementResult& element) {
+  mutex_lock l(mu_);
+  const size_t max_segment_size_bytes =
+      std::max<size_t>(max_size_bytes_ / kNumSegments, 1);
+  if (segments_.empty() ||
+      segments_.back().size_bytes >= max_segment_size_bytes) {
+    auto file = std::make_shared<SegmentFile>();
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<ElementSpillFile> spill_file,
+                        ElementSpillFile::Create(env_, directory_));
+    {
+      mutex_lock file_lock(file->mu);
+      file->file = std::move(spill_file);
+    }
+    Segment segment;
+    segment.file = std::move(file);
+    segment.start_index = end_index_;
+    segments_.push_back(std::move(segment));
+  }
+  Segment& segment = segments_.back();
+  ElementSpillFile::Handle handle;
+  size_t segment_size_bytes;
+  {
+    mutex_lock file_lock(segment.file->mu);
+    TF_ASSIGN_OR_RETURN(handle,
+                        segment.file->file->Write(element.components));
+    segment_size_bytes = segment.file->file->size();
+  }
+  segment.handles.push_back(handle);
+  segment.element_indices.push_back(element.element_index);
+  size_bytes_ += segment_size_bytes - segment.size_bytes;
+  segment.size_bytes = segment_size_bytes;
+  ++end_index_;
+
+  // Always keeps the segment being written.
+  while (size_bytes_ > max_size_bytes_ && segments_.size() > 1) {
+    size_bytes_ -= segments_.front().size_bytes;
+    segments_.pop_front();
+    start_index_ = segments_.front().start_index;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<GetElementResult> CrossTrainerCacheSpillLog::Read(
+    size_t index) {
+  std::shared_ptr<SegmentFile> file;
+  ElementSpillFile::Handle handle;
+  GetElementResult result;
+  {
+    mutex_lock l(mu_);
+    if (index < start_index_ || index >= end_index_) {
+      return errors::OutOfRange("Element ", index,
+                                " is not in the cross-trainer cache spill "
+                                "log, which holds elements [",
+                                start_index_, ", ", end_index_, ").");
+    }
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), index,
+                               [](size_t index, const Segment& segment) {
+                                 return index < segment.start_index;
+                               });
+    const Segment& segment = *std::prev(it);
+    const size_t offset = index - segment.start_index;
+    file = segment.file;
+    handle = segment.handles[offset];
+    result.element_index = segment.element_indices[offset];
+  }
+  // Reads of older segments don't wait for appends, which only lock the file
+  // of the newest segment.
+  mutex_lock file_lock(file->mu);
+  TF_RETURN_IF_ERROR(file->file->Read(handle, &result.components));
+  return result;
+}
+
+size_t CrossTrainerCacheSpillLog::StartIndex() const {
+  mutex_lock l(mu_);
+  return start_index_;
+}
+
+size_t CrossTrainerCacheSpillLog::SizeBytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_LOG_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/element_spill_file.h"
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Append-only log on local disk that holds the elements a cross-trainer cache
+// evicts from memory, so that lagging trainers can read them back instead of
+// skipping ahead.
+//
+// The log is split into segment files of about `max_size_bytes / kNumSegments`
+// bytes each. When the log grows past `max_size_bytes`, its oldest segment is
+// deleted. The files are deleted when the log is destroyed.
+//
+// Thread-safe. Reads hold the log lock only to locate an element, and read it
+// from disk under the lock of its segment file.
+class CrossTrainerCacheSpillLog
+    : public CrossTrainerCacheSpill<GetElementResult> {
+ public:
+  static constexpr int64_t kNumSegments = 8;
+
+  // Creates a spill log in `directory` holding up to about `max_size_bytes`.
+  static absl::StatusOr<std::unique_ptr<CrossTrainerCacheSpillLog>> Create(
+      Env* env, const std::string& directory, size_t max_size_bytes);
+
+  absl::Status Append(const GetElementResult& element) override;
+  absl::StatusOr<GetElementResult> Read(size_t index) override;
+  size_t StartIndex() const override;
+
+  // Number of bytes currently used on disk.
+  size_t SizeBytes() const;
+
+ private:
+  // A segment's spill file. It is shared with in-flight reads, which access
+  // it without holding `mu_`, so that the segment can be dropped meanwhile.
+  struct SegmentFile {
+    mutex mu;
+    std::unique_ptr<ElementSpillFile> file TF_GUARDED_BY(mu);
+  };
+
+  struct Segment {
+    std::shared_ptr<SegmentFile> file;
+    // Absolute index of the first element in the segment.
+    size_t start_index = 0;
+    // Number of bytes used by the segment file.
+    size_t size_bytes = 0;
+    std::vector<ElementSpillFile::Handle> handles;
+    // Index of each element within the task it came from.
+    std::vector<int64_t> element_indices;
+  };
+
+  CrossTrainerCacheSpillLog(Env* env, const std::string& directory,
+                            size_t max_size_bytes);
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_size_bytes_;
+
+  mutable mutex mu_;
+  std::deque<Segment> segments_ TF_GUARDED_BY(mu_);
+  // Absolute index of the oldest element that has not been dropped.
+  size_t start_index_ TF_GUARDED_BY(mu_) = 0;
+  // Absolute index of the next element to append.
+  size_t end_index_ TF_GUARDED_BY(mu_) = 0;
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_LOG_H_
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_spill_log.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+GetElementResult MakeElement(int64_t i) {
+  GetElementResult result;
+  result.components = {test::AsScalar<int64_t>(i),
+                       test::AsTensor<tstring>({std::string(100, 'x')})};
+  result.element_index = i;
+  return result;
+}
+
+void ExpectElement(const GetElementResult& result, int64_t i) {
+  GetElementResult expected = MakeElement(i);
+  EXPECT_EQ(result.element_index, i);
+  ASSERT_EQ(result.components.size(), expected.components.size());
+  test::ExpectEqual(result.components[0], expected.components[0]);
+  test::ExpectEqual(result.components[1], expected.components[1]);
+}
+
+std::string TestDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "cross_trainer_cache_spill_log_test",
+                      name);
+}
+
+TEST(CrossTrainerCacheSpillLogTest, AppendAndRead) {
+  auto spill = CrossTrainerCacheSpillLog::Create(
+      Env::Default(), TestDirectory("append_and_read"),
+      /*max_size_bytes=*/size_t{1} << 20);
+  TF_ASSERT_OK(spill.status());
+  for (int64_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK((*spill)->Append(MakeElement(i)));
+  }
+  EXPECT_EQ((*spill)->StartIndex(), 0);
+  for (int64_t i : {42, 0, 99, 7}) {
+    auto element = (*spill)->Read(i);
+    TF_ASSERT_OK(element.status());
+    ExpectElement(*element, i);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange((*spill)->Read(100).status()));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, DropsOldestSegments) {
+  const std::string directory = TestDirectory("drops_oldest_segments");
+  auto spill = CrossTrainerCacheSpillLog::Create(Env::Default(), directory,
+                                                 /*max_size_bytes=*/4096);
+  TF_ASSERT_OK(spill.status());
+  for (int64_t i = 0; i < 1000; ++i) {
+    TF_ASSERT_OK((*spill)->Append(MakeElement(i)));
+  }
+  const size_t start_index = (*spill)->StartIndex();
+  EXPECT_GT(start_index, 0);
+  EXPECT_LE((*spill)->SizeBytes(), 4096);
+  EXPECT_TRUE(errors::IsOutOfRange((*spill)->Read(start_index - 1).status()));
+  for (size_t i = start_index; i < 1000; ++i) {
+    auto element = (*spill)->Read(i);
+    TF_ASSERT_OK(element.status());
+    ExpectElement(*element, i);
+  }
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_LE(children.size(), CrossTrainerCacheSpillLog::kNumSegments + 1);
+}
+
+TEST(CrossTrainerCacheSpillLogTest, DeletesFilesOnDestruction) {
+  const std::string directory = TestDirectory("deletes_files");
+  {
+    auto spill = CrossTrainerCacheSpillLog::Create(Env::Default(), directory,
+                                                   /*max_size_bytes=*/4096);
+    TF_ASSERT_OK(spill.status());
+    TF_ASSERT_OK((*spill)->Append(MakeElement(0)));
+  }
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(CrossTrainerCacheSpillLogTest, InvalidSize) {
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      CrossTrainerCacheSpillLog::Create(Env::Default(),
+                                        TestDirectory("invalid_size"),
+                                        /*max_size_bytes=*/0)
+          .status()));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
@@ -121,6 +123,41 @@ size_t ElementOrErrorDataset<Tensor>::GetElementSizeBytes(
   return element.TotalBytes();
 }
 
+// Spill that keeps up to `max_elements` of the most recently evicted elements.
+class BoundedSpill : public CrossTrainerCacheSpill<int64_t> {
+ public:
+  explicit BoundedSpill(size_t max_elements) : max_elements_(max_elements) {}
+
+  absl::Status Append(const int64_t& element) override {
+    mutex_lock l(mu_);
+    elements_.push_back(element);
+    while (elements_.size() > max_elements_) {
+      elements_.pop_front();
+      ++start_index_;
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    if (index < start_index_ || index >= start_index_ + elements_.size()) {
+      return errors::OutOfRange("Element ", index, " is not spilled.");
+    }
+    return elements_[index - start_index_];
+  }
+
+  size_t StartIndex() const override {
+    mutex_lock l(mu_);
+    return start_index_;
+  }
+
+ private:
+  const size_t max_elements_;
+  mutable mutex mu_;
+  std::deque<int64_t> elements_ TF_GUARDED_BY(mu_);
+  size_t start_index_ TF_GUARDED_BY(mu_) = 0;
+};
+
 std::vector<int64_t> GetRange(const size_t range) {
   std::vector<int64_t> result;
   for (int64_t i = 0; i < range; ++i) {
@@ -190,6 +227,40 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromSpill) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<BoundedSpill>(/*max_elements=*/100));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer reads the evicted elements from the spill, then catches up
+  // with the elements in memory.
+  for (int i = 1; i < 60; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SlowTrainersSkipDroppedSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<BoundedSpill>(/*max_elements=*/10));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 95 elements have been evicted from memory, and the spill keeps the last 10
+  // of them.
+  for (int i = 85; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
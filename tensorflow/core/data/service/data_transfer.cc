@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/data_transfer.h"
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_join.h"
@@ -82,6 +84,15 @@ size_t GetElementResult::EstimatedMemoryUsageBytes() const {
   return size_bytes;
 }
 
+absl::Status DataTransferClient::GetElements(
+    const GetElementRequest& req, int64_t max_elements, int64_t max_bytes,
+    std::vector<GetElementResult>& results) {
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(GetElement(req, result));
+  results.push_back(std::move(result));
+  return absl::OkStatus();
+}
+
 void DataTransferServer::Register(std::string name, ServerFactoryT factory) {
   mutex_lock l(*get_lock());
   if (!transfer_server_factories().insert({name, factory}).second) {
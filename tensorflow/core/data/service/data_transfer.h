@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_DATA_TRANSFER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_DATA_TRANSFER_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -81,6 +82,14 @@ class DataTransferClient {
   virtual absl::Status GetElement(const GetElementRequest& req,
                                   GetElementResult& result) = 0;
 
+  // Fetches up to `max_elements` elements, appending them to `results`. Only
+  // the first element may block, and no more elements are added once they use
+  // `max_bytes` bytes (if positive). The default implementation fetches a
+  // single element.
+  virtual absl::Status GetElements(const GetElementRequest& req,
+                                   int64_t max_elements, int64_t max_bytes,
+                                   std::vector<GetElementResult>& results);
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   virtual void TryCancel() = 0;
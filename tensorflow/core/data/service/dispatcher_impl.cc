@@ -450,6 +450,8 @@ absl::Status DataServiceDispatcherImpl::WorkerHeartbeat(
       *update.mutable_register_worker()->mutable_worker_tags() =
           request->worker_tags();
       update.mutable_register_worker()->set_worker_uid(request->worker_uid());
+      *update.mutable_register_worker()->mutable_worker_topology() =
+          request->worker_topology();
       TF_RETURN_IF_ERROR(Apply(update));
       TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
       TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
@@ -971,6 +973,7 @@ absl::Status DataServiceDispatcherImpl::CreatePendingTask(
   *create_task->mutable_worker_tags() = {worker->tags.begin(),
                                          worker->tags.end()};
   create_task->set_worker_uid(worker->uid);
+  *create_task->mutable_worker_topology() = worker->topology;
   TF_RETURN_IF_ERROR(Apply(update));
   return absl::OkStatus();
 }
@@ -992,6 +995,7 @@ absl::Status DataServiceDispatcherImpl::CreateTask(
   *create_task->mutable_worker_tags() = {worker->tags.begin(),
                                          worker->tags.end()};
   create_task->set_worker_uid(worker->uid);
+  *create_task->mutable_worker_topology() = worker->topology;
   TF_RETURN_IF_ERROR(Apply(update));
   TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
   return absl::OkStatus();
@@ -1161,6 +1165,7 @@ absl::Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_task_id(task->task_id);
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
+    *task_info->mutable_worker_topology() = task->worker_topology;
     task_info->set_starting_round(task->starting_round);
   }
   response->set_iteration_finished(iteration->finished);
@@ -91,12 +91,14 @@ class DispatcherState {
                             register_worker.transfer_servers().end()}),
           tags(register_worker.worker_tags().begin(),
                register_worker.worker_tags().end()),
-          uid(register_worker.worker_uid()) {}
+          uid(register_worker.worker_uid()),
+          topology(register_worker.worker_topology()) {}
 
     const std::string address;
     const std::vector<DataTransferServerInfo> transfer_servers;
     const std::vector<std::string> tags;
     const int64_t uid;
+    const TopologyLabels topology;
   };
 
   // A key for identifying an iteration. The key contains a job name,
@@ -210,7 +212,8 @@ class DispatcherState {
                            create_task_update.transfer_servers().end()),
           worker_tags(create_task_update.worker_tags().begin(),
                       create_task_update.worker_tags().end()),
-          worker_uid(create_task_update.worker_uid()) {}
+          worker_uid(create_task_update.worker_uid()),
+          worker_topology(create_task_update.worker_topology()) {}
 
     const int64_t task_id;
     const std::shared_ptr<Iteration> iteration;
@@ -218,6 +221,7 @@ class DispatcherState {
     const std::vector<DataTransferServerInfo> transfer_servers;
     const std::vector<std::string> worker_tags;
     const int64_t worker_uid;
+    const TopologyLabels worker_topology;
     int64_t starting_round = 0;
     bool finished = false;
     bool removed = false;
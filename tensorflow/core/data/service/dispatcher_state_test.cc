@@ -406,6 +406,38 @@ TEST(DispatcherState, CreateTask) {
   }
 }
 
+TEST(DispatcherState, WorkerAndTaskTopology) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  Update update;
+  RegisterWorkerUpdate* register_worker = update.mutable_register_worker();
+  register_worker->set_worker_address(worker_address);
+  register_worker->mutable_worker_topology()->set_zone("zone");
+  register_worker->mutable_worker_topology()->set_rack("rack");
+  TF_EXPECT_OK(state.Apply(update));
+  std::shared_ptr<const Worker> worker;
+  TF_EXPECT_OK(state.WorkerFromAddress(worker_address, worker));
+  EXPECT_EQ(worker->topology.zone(), "zone");
+  EXPECT_EQ(worker->topology.rack(), "rack");
+
+  int64_t task_id = state.NextAvailableTaskId();
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(CreateIteration(iteration_id, dataset_id, state));
+  Update create_task_update;
+  CreateTaskUpdate* create_task = create_task_update.mutable_create_task();
+  create_task->set_task_id(task_id);
+  create_task->set_iteration_id(iteration_id);
+  create_task->set_worker_address(worker_address);
+  *create_task->mutable_worker_topology() = worker->topology;
+  TF_EXPECT_OK(state.Apply(create_task_update));
+  std::shared_ptr<const Task> task;
+  TF_EXPECT_OK(state.TaskFromId(task_id, task));
+  EXPECT_EQ(task->worker_topology.zone(), "zone");
+  EXPECT_EQ(task->worker_topology.rack(), "rack");
+}
+
 TEST(DispatcherState, CreateTasksForSameIteration) {
   std::string dataset_id = "dataset_id";
   int64_t iteration_id = 3;
@@ -0,0 +1,853 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+bool IsLocalShmTransferServer(const DataTransferServerInfo& server_info) {
+#if defined(__linux__)
+  return server_info.protocol() == kShmTransferProtocol &&
+         server_info.compatibility_info() == port::Hostname();
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+#if defined(__linux__)
+namespace {
+
+// The first page of the ring buffer mapping holds a `RingHeader`; tensor data
+// starts at `kRingDataOffset`.
+constexpr uint64_t kRingDataOffset = 4096;
+constexpr uint64_t kRingCapacity = kShmRingBufferBytes - kRingDataOffset;
+constexpr uint64_t kTensorAlignment = Allocator::kAllocatorAlignment;
+constexpr char kSocketNamePrefix[] = "tf_data_service_shm_";
+// Range of transfer ports picked when the worker config does not set one.
+constexpr int kMinPort = 20000;
+constexpr int kMaxPort = 65535;
+constexpr int kMaxBindAttempts = 100;
+
+// Encoding of a single component in the response metadata.
+enum ComponentKind : uint8_t {
+  // The component bytes live in the shared ring buffer.
+  kShared = 0,
+  // The component is serialized inline as a `TensorProto`.
+  kInline = 1,
+};
+
+// Shared state at the start of the ring buffer. Offsets are monotonically
+// increasing byte counts; the position in the data area is
+// `offset % kRingCapacity`.
+struct RingHeader {
+  // Bytes handed out by the server so far.
+  alignas(64) std::atomic<uint64_t> write_offset;
+  // Bytes returned by the client so far.
+  alignas(64) std::atomic<uint64_t> read_offset;
+};
+static_assert(sizeof(RingHeader) <= kRingDataOffset);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+uint64_t RoundUpToAlignment(uint64_t n) {
+  return (n + kTensorAlignment - 1) / kTensorAlignment * kTensorAlignment;
+}
+
+absl::Status ErrnoError(absl::string_view context) {
+  return errors::Unavailable(context, ": ", strerror(errno));
+}
+
+// Fills in the address of the abstract Unix domain socket for `port`.
+socklen_t MakeSocketAddress(int port, sockaddr_un* addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  const std::string name = absl::StrCat(kSocketNamePrefix, port);
+  // A leading NUL byte places the socket in the abstract namespace, so it
+  // needs no cleanup and disappears with the server.
+  memcpy(addr->sun_path + 1, name.data(), name.size());
+  return offsetof(sockaddr_un, sun_path) + 1 + name.size();
+}
+
+absl::Status WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("Failed to write to shared-memory transfer socket");
+    }
+    data += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = recv(fd, data, size, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("Failed to read from shared-memory transfer socket");
+    }
+    if (n == 0) {
+      return errors::Unavailable("Shared-memory transfer socket was closed.");
+    }
+    data += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+// Messages are framed as a fixed32 length followed by the payload.
+absl::Status WriteMessage(int fd, absl::string_view message) {
+  std::string frame;
+  frame.reserve(sizeof(uint32_t) + message.size());
+  core::PutFixed32(&frame, message.size());
+  frame.append(message.data(), message.size());
+  return WriteAll(fd, frame.data(), frame.size());
+}
+
+absl::Status ReadMessage(int fd, std::string* message) {
+  char length_bytes[sizeof(uint32_t)];
+  TF_RETURN_IF_ERROR(ReadAll(fd, length_bytes, sizeof(length_bytes)));
+  message->resize(core::DecodeFixed32(length_bytes));
+  return ReadAll(fd, message->data(), message->size());
+}
+
+absl::Status SendFileDescriptor(int socket_fd, int fd) {
+  char byte = 0;
+  iovec iov = {&byte, 1};
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  if (sendmsg(socket_fd, &msg, MSG_NOSIGNAL) != 1) {
+    return ErrnoError("Failed to send the ring buffer to the client");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int> ReceiveFileDescriptor(int socket_fd) {
+  char byte;
+  iovec iov = {&byte, 1};
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC) != 1) {
+    return ErrnoError("Failed to receive the ring buffer from the worker");
+  }
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS) {
+    return errors::Internal("Worker did not send a ring buffer descriptor.");
+  }
+  int fd;
+  memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  return fd;
+}
+
+// A memfd-backed mapping shared between a worker and one client.
+class SharedRing {
+ public:
+  // Creates a new ring buffer. Called by the server.
+  static absl::StatusOr<std::shared_ptr<SharedRing>> Create() {
+    int fd = memfd_create("tf_data_service_shm", MFD_CLOEXEC);
+    if (fd < 0) {
+      return ErrnoError("Failed to create ring buffer");
+    }
+    if (ftruncate(fd, kShmRingBufferBytes) != 0) {
+      absl::Status s = ErrnoError("Failed to size ring buffer");
+      close(fd);
+      return s;
+    }
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<SharedRing> ring, Map(fd));
+    new (ring->header()) RingHeader();
+    ring->header()->write_offset.store(0, std::memory_order_relaxed);
+    ring->header()->read_offset.store(0, std::memory_order_release);
+    return ring;
+  }
+
+  // Maps the ring buffer backed by `fd`, taking ownership of `fd`.
+  static absl::StatusOr<std::shared_ptr<SharedRing>> Map(int fd) {
+    void* base = mmap(nullptr, kShmRingBufferBytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      absl::Status s = ErrnoError("Failed to map ring buffer");
+      close(fd);
+      return s;
+    }
+    return std::shared_ptr<SharedRing>(
+        new SharedRing(fd, static_cast<char*>(base)));
+  }
+
+  ~SharedRing() {
+    munmap(base_, kShmRingBufferBytes);
+    close(fd_);
+  }
+
+  int fd() const { return fd_; }
+  RingHeader* header() { return reinterpret_cast<RingHeader*>(base_); }
+  char* At(uint64_t offset) {
+    return base_ + kRingDataOffset + offset % kRingCapacity;
+  }
+
+ private:
+  SharedRing(int fd, char* base) : fd_(fd), base_(base) {}
+
+  const int fd_;
+  char* const base_;
+};
+
+// Server-side allocator of ring buffer space. Not thread-safe; each
+// connection is served by a single thread.
+class RingWriter {
+ public:
+  explicit RingWriter(std::shared_ptr<SharedRing> ring)
+      : ring_(std::move(ring)) {}
+
+  // Reserves `size` contiguous bytes and returns their offset, or `nullopt` if
+  // the client has not released enough space yet.
+  std::optional<uint64_t> Reserve(uint64_t size) {
+    uint64_t offset = write_offset_;
+    const uint64_t position = offset % kRingCapacity;
+    if (position + size > kRingCapacity) {
+      // Skip the tail of the data area so the region does not wrap.
+      offset += kRingCapacity - position;
+    }
+    const uint64_t end = offset + RoundUpToAlignment(size);
+    const uint64_t read_offset =
+        ring_->header()->read_offset.load(std::memory_order_acquire);
+    if (end - read_offset > kRingCapacity) {
+      return std::nullopt;
+    }
+    write_offset_ = end;
+    return offset;
+  }
+
+  // Makes the reserved regions visible in the ring header.
+  void Publish() {
+    ring_->header()->write_offset.store(write_offset_,
+                                        std::memory_order_release);
+  }
+
+  SharedRing* ring() { return ring_.get(); }
+
+ private:
+  const std::shared_ptr<SharedRing> ring_;
+  uint64_t write_offset_ = 0;
+};
+
+// Client-side tracker of ring buffer regions still referenced by tensors.
+// Regions may be released in any order, but space is returned to the server
+// in ring order.
+class RingReleaser {
+ public:
+  explicit RingReleaser(std::shared_ptr<SharedRing> ring)
+      : ring_(std::move(ring)) {}
+
+  SharedRing* ring() { return ring_.get(); }
+
+  // Records a region ending at `end_offset`. Must be called in increasing
+  // offset order.
+  void Acquire(uint64_t end_offset) {
+    mutex_lock l(mu_);
+    regions_.emplace(end_offset, false);
+  }
+
+  void Release(uint64_t end_offset) {
+    mutex_lock l(mu_);
+    regions_[end_offset] = true;
+    std::optional<uint64_t> read_offset;
+    while (!regions_.empty() && regions_.begin()->second) {
+      read_offset = regions_.begin()->first;
+      regions_.erase(regions_.begin());
+    }
+    if (read_offset.has_value()) {
+      ring_->header()->read_offset.store(*read_offset,
+                                         std::memory_order_release);
+    }
+  }
+
+ private:
+  const std::shared_ptr<SharedRing> ring_;
+  mutex mu_;
+  // Maps the end offset of each outstanding region to whether it has been
+  // released.
+  std::map<uint64_t, bool> regions_ TF_GUARDED_BY(mu_);
+};
+
+// A tensor buffer that aliases a region of the ring buffer and returns it to
+// the server when the last reference goes away.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(std::shared_ptr<RingReleaser> releaser, uint64_t offset,
+                  uint64_t size, uint64_t end_offset)
+      : TensorBuffer(releaser->ring()->At(offset)),
+        releaser_(std::move(releaser)),
+        size_(size),
+        end_offset_(end_offset) {}
+
+  ~ShmTensorBuffer() override { releaser_->Release(end_offset_); }
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name("tf_data_service_shm");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<RingReleaser> releaser_;
+  const size_t size_;
+  const uint64_t end_offset_;
+};
+
+void EncodeStatus(const absl::Status& status, std::string* out) {
+  core::PutVarint32(out, static_cast<uint32_t>(status.code()));
+  core::PutVarint64(out, status.message().size());
+  out->append(status.message().data(), status.message().size());
+}
+
+absl::Status EncodeComponent(const Tensor& tensor, RingWriter& writer,
+                             std::string* out) {
+  const uint64_t size = tensor.TotalBytes();
+  std::optional<uint64_t> offset;
+  if (DataTypeCanUseMemcpy(tensor.dtype()) && size > 0 &&
+      RoundUpToAlignment(size) <= kRingCapacity) {
+    offset = writer.Reserve(size);
+  }
+  if (!offset.has_value()) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Failed to serialize tensor.");
+    }
+    out->push_back(kInline);
+    core::PutVarint64(out, serialized.size());
+    out->append(serialized);
+    return absl::OkStatus();
+  }
+  memcpy(writer.ring()->At(*offset), tensor.tensor_data().data(), size);
+  out->push_back(kShared);
+  core::PutVarint32(out, tensor.dtype());
+  core::PutVarint32(out, tensor.dims());
+  for (int64_t dim : tensor.shape().dim_sizes()) {
+    core::PutVarint64(out, dim);
+  }
+  core::PutVarint64(out, *offset);
+  core::PutVarint64(out, size);
+  return absl::OkStatus();
+}
+
+// Encodes the outcome of a GetElement call, writing shareable components into
+// the ring buffer.
+absl::Status EncodeResponse(const absl::Status& status,
+                            const GetElementResult& result, RingWriter& writer,
+                            std::string* out) {
+  EncodeStatus(status, out);
+  if (!status.ok()) {
+    return absl::OkStatus();
+  }
+  core::PutVarint64(out, result.element_index);
+  out->push_back(result.end_of_sequence ? 1 : 0);
+  out->push_back(result.skip ? 1 : 0);
+  core::PutVarint64(out, result.components.size());
+  for (const Tensor& component : result.components) {
+    TF_RETURN_IF_ERROR(EncodeComponent(component, writer, out));
+  }
+  writer.Publish();
+  return absl::OkStatus();
+}
+
+absl::Status DecodeError() {
+  return errors::DataLoss("Malformed shared-memory transfer response.");
+}
+
+absl::Status DecodeComponent(absl::string_view* input,
+                             const std::shared_ptr<RingReleaser>& releaser,
+                             Allocator* allocator, Tensor* tensor) {
+  if (input->empty()) return DecodeError();
+  const uint8_t kind = (*input)[0];
+  input->remove_prefix(1);
+  if (kind == kInline) {
+    uint64_t length;
+    if (!core::GetVarint64(input, &length) || length > input->size()) {
+      return DecodeError();
+    }
+    TensorProto proto;
+    if (!proto.ParseFromArray(input->data(), length)) return DecodeError();
+    input->remove_prefix(length);
+    bool success = allocator != nullptr ? tensor->FromProto(allocator, proto)
+                                        : tensor->FromProto(proto);
+    if (!success) {
+      return errors::Internal("Failed to parse tensor.");
+    }
+    return absl::OkStatus();
+  }
+  if (kind != kShared) return DecodeError();
+  uint32_t dtype, dims;
+  if (!core::GetVarint32(input, &dtype) || !core::GetVarint32(input, &dims)) {
+    return DecodeError();
+  }
+  TensorShape shape;
+  for (uint32_t i = 0; i < dims; ++i) {
+    uint64_t dim;
+    if (!core::GetVarint64(input, &dim)) return DecodeError();
+    TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim));
+  }
+  uint64_t offset, size;
+  if (!core::GetVarint64(input, &offset) || !core::GetVarint64(input, &size) ||
+      offset % kRingCapacity + size > kRingCapacity) {
+    return DecodeError();
+  }
+  // The tensor aliases the ring buffer, so it must cover exactly the bytes of
+  // a memcpy-able tensor of the given shape.
+  if (!DataType_IsValid(dtype) ||
+      !DataTypeCanUseMemcpy(static_cast<DataType>(dtype)) ||
+      size != static_cast<uint64_t>(shape.num_elements()) *
+                  DataTypeSize(static_cast<DataType>(dtype))) {
+    return DecodeError();
+  }
+  const uint64_t end_offset = offset + RoundUpToAlignment(size);
+  releaser->Acquire(end_offset);
+  auto buffer = core::RefCountPtr<TensorBuffer>(
+      new ShmTensorBuffer(releaser, offset, size, end_offset));
+  *tensor = Tensor(static_cast<DataType>(dtype), shape, std::move(buffer));
+  return absl::OkStatus();
+}
+
+absl::Status DecodeResponse(absl::string_view input,
+                            const std::shared_ptr<RingReleaser>& releaser,
+                            Allocator* allocator, GetElementResult& result) {
+  uint32_t code;
+  uint64_t message_length;
+  if (!core::GetVarint32(&input, &code) ||
+      !core::GetVarint64(&input, &message_length) ||
+      message_length > input.size()) {
+    return DecodeError();
+  }
+  if (code != static_cast<uint32_t>(absl::StatusCode::kOk)) {
+    return absl::Status(static_cast<absl::StatusCode>(code),
+                        input.substr(0, message_length));
+  }
+  input.remove_prefix(message_length);
+  uint64_t element_index, num_components;
+  if (!core::GetVarint64(&input, &element_index) || input.size() < 2) {
+    return DecodeError();
+  }
+  result.element_index = element_index;
+  result.end_of_sequence = input[0] != 0;
+  result.skip = input[1] != 0;
+  input.remove_prefix(2);
+  if (!core::GetVarint64(&input, &num_components)) return DecodeError();
+  result.components.resize(num_components);
+  for (Tensor& component : result.components) {
+    TF_RETURN_IF_ERROR(
+        DecodeComponent(&input, releaser, allocator, &component));
+  }
+  return absl::OkStatus();
+}
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~ShmDataTransferServer() override {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      connection_finished_cv_.notify_all();
+      if (listen_fd_ >= 0) {
+        shutdown(listen_fd_, SHUT_RDWR);
+      }
+      for (int fd : connection_fds_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+    accept_thread_.reset();
+    join_thread_.reset();
+    absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads;
+    {
+      mutex_lock l(mu_);
+      connection_threads = std::move(connection_threads_);
+    }
+    // Joins the remaining connection threads, which take `mu_` before exiting.
+    connection_threads.clear();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+  }
+
+  absl::Status Start(const experimental::WorkerConfig& config) override {
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      return ErrnoError("Failed to create shared-memory transfer socket");
+    }
+    if (config.data_transfer_port() > 0) {
+      port_ = config.data_transfer_port();
+      TF_RETURN_IF_ERROR(Bind(port_));
+    } else {
+      absl::Status s;
+      for (int i = 0; i < kMaxBindAttempts; ++i) {
+        port_ = kMinPort + random::New64() % (kMaxPort - kMinPort);
+        s = Bind(port_);
+        if (s.ok()) break;
+      }
+      TF_RETURN_IF_ERROR(s);
+    }
+    if (listen(listen_fd_, SOMAXCONN) != 0) {
+      return ErrnoError("Failed to listen on shared-memory transfer socket");
+    }
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_service_shm_accept", [this] { AcceptLoop(); }));
+    join_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_service_shm_join", [this] { JoinLoop(); }));
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return port::Hostname();
+  }
+
+ private:
+  absl::Status Bind(int port) {
+    sockaddr_un addr;
+    socklen_t addr_len = MakeSocketAddress(port, &addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+      return ErrnoError(
+          absl::StrCat("Failed to bind shared-memory transfer port ", port));
+    }
+    return absl::OkStatus();
+  }
+
+  void AcceptLoop() {
+    while (true) {
+      int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        if (fd >= 0) close(fd);
+        return;
+      }
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        LOG(ERROR) << "Shared-memory transfer server stopped accepting "
+                   << "connections: " << strerror(errno);
+        return;
+      }
+      connection_fds_.insert(fd);
+      const int64_t id = next_connection_id_++;
+      connection_threads_[id] = absl::WrapUnique(Env::Default()->StartThread(
+          {}, "tf_data_service_shm_connection",
+          [this, fd, id] { ServeConnection(fd, id); }));
+    }
+  }
+
+  void ServeConnection(int fd, int64_t id) {
+    absl::Status s = HandleConnection(fd);
+    VLOG(2) << "Shared-memory transfer connection closed: " << s;
+    mutex_lock l(mu_);
+    connection_fds_.erase(fd);
+    close(fd);
+    finished_connections_.push_back(id);
+    connection_finished_cv_.notify_one();
+  }
+
+  // Joins the threads of closed connections, so that they don't pile up on a
+  // long-running worker.
+  void JoinLoop() {
+    while (true) {
+      std::vector<std::unique_ptr<Thread>> finished_threads;
+      {
+        mutex_lock l(mu_);
+        while (!cancelled_ && finished_connections_.empty()) {
+          connection_finished_cv_.wait(l);
+        }
+        if (cancelled_) {
+          return;
+        }
+        for (int64_t id : finished_connections_) {
+          auto it = connection_threads_.find(id);
+          finished_threads.push_back(std::move(it->second));
+          connection_threads_.erase(it);
+        }
+        finished_connections_.clear();
+      }
+      // Joins the threads outside `mu_`, which they take before exiting.
+      finished_threads.clear();
+    }
+  }
+
+  absl::Status HandleConnection(int fd) {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<SharedRing> ring, SharedRing::Create());
+    TF_RETURN_IF_ERROR(SendFileDescriptor(fd, ring->fd()));
+    RingWriter writer(std::move(ring));
+    std::string message;
+    while (true) {
+      TF_RETURN_IF_ERROR(ReadMessage(fd, &message));
+      GetElementRequest req;
+      if (!req.ParseFromString(message)) {
+        return errors::DataLoss("Failed to parse GetElementRequest.");
+      }
+      GetElementResult result;
+      absl::Status s = get_element_(&req, &result);
+      std::string response;
+      TF_RETURN_IF_ERROR(EncodeResponse(s, result, writer, &response));
+      TF_RETURN_IF_ERROR(WriteMessage(fd, response));
+    }
+  }
+
+  const GetElementT get_element_;
+  int listen_fd_ = -1;
+  int port_ = -1;
+  std::unique_ptr<Thread> accept_thread_;
+  std::unique_ptr<Thread> join_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  absl::flat_hash_set<int> connection_fds_ TF_GUARDED_BY(mu_);
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads_
+      TF_GUARDED_BY(mu_);
+  // Connections whose threads have finished serving and can be joined.
+  std::vector<int64_t> finished_connections_ TF_GUARDED_BY(mu_);
+  condition_variable connection_finished_cv_;
+};
+
+// A connection to a shared-memory transfer server.
+struct ShmConnection {
+  ShmConnection(int fd, std::shared_ptr<RingReleaser> releaser)
+      : fd(fd), releaser(std::move(releaser)) {}
+  ~ShmConnection() { close(fd); }
+
+  const int fd;
+  // Tensors returned to the caller keep the ring buffer mapped after the
+  // connection goes away.
+  const std::shared_ptr<RingReleaser> releaser;
+};
+
+absl::StatusOr<std::unique_ptr<ShmConnection>> Connect(
+    const std::string& address) {
+  int port;
+  const size_t colon = address.rfind(':');
+  if (colon == std::string::npos ||
+      !absl::SimpleAtoi(absl::string_view(address).substr(colon + 1), &port)) {
+    return errors::InvalidArgument(
+        "Invalid shared-memory transfer address: ", address);
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return ErrnoError("Failed to create shared-memory transfer socket");
+  }
+  sockaddr_un addr;
+  socklen_t addr_len = MakeSocketAddress(port, &addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+    absl::Status s = ErrnoError(absl::StrCat(
+        "Failed to connect to shared-memory transfer server at ", address));
+    close(fd);
+    return s;
+  }
+  absl::StatusOr<int> ring_fd = ReceiveFileDescriptor(fd);
+  if (!ring_fd.ok()) {
+    close(fd);
+    return ring_fd.status();
+  }
+  absl::StatusOr<std::shared_ptr<SharedRing>> ring = SharedRing::Map(*ring_fd);
+  if (!ring.ok()) {
+    close(fd);
+    return ring.status();
+  }
+  return std::make_unique<ShmConnection>(
+      fd, std::make_shared<RingReleaser>(*std::move(ring)));
+}
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  ShmDataTransferClient(std::string address,
+                        std::unique_ptr<ShmConnection> connection,
+                        Allocator* allocator)
+      : address_(std::move(address)),
+        allocator_(allocator) {
+    mutex_lock l(mu_);
+    SetConnection(std::move(connection));
+    VLOG(2) << "Create ShmDataTransferClient for worker " << address_ << ".";
+  }
+
+  absl::Status GetElement(const GetElementRequest& req,
+                          GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id()
+            << " from shared-memory worker server.";
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    if (connection_ == nullptr) {
+      // The previous connection failed, e.g. because the worker restarted.
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmConnection> connection,
+                          Connect(address_));
+      SetConnection(std::move(connection));
+    }
+    int64_t start_time_us = env_->NowMicros();
+    std::string response;
+    absl::Status s = WriteMessage(connection_->fd, req.SerializeAsString());
+    if (s.ok()) {
+      s = ReadMessage(connection_->fd, &response);
+    }
+    if (!s.ok()) {
+      SetConnection(nullptr);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      return s;
+    }
+    TF_RETURN_IF_ERROR(
+        DecodeResponse(response, connection_->releaser, allocator_, result));
+    metrics::RecordTFDataServiceGetElementDuration(
+        kShmTransferProtocol, env_->NowMicros() - start_time_us);
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    cancelled_ = true;
+    // Unblocks an in-flight `GetElement`, which holds `mu_`.
+    mutex_lock l(fd_mu_);
+    if (active_fd_ >= 0) {
+      shutdown(active_fd_, SHUT_RDWR);
+    }
+  }
+
+  absl::Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    if (server_compatibility_info != port::Hostname()) {
+      return errors::FailedPrecondition(
+          "Shared-memory data transfer requires the worker to run on the same "
+          "host; worker host is ",
+          server_compatibility_info, ", client host is ", port::Hostname());
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  void SetConnection(std::unique_ptr<ShmConnection> connection)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    {
+      mutex_lock l(fd_mu_);
+      active_fd_ = connection != nullptr ? connection->fd : -1;
+    }
+    connection_ = std::move(connection);
+  }
+
+  const std::string address_;
+  Allocator* const allocator_;
+  std::atomic<bool> cancelled_ = false;
+  // Serializes requests on the connection.
+  mutex mu_;
+  std::unique_ptr<ShmConnection> connection_ TF_GUARDED_BY(mu_);
+  // Socket of `connection_`, for `TryCancel` to shut down without `mu_`.
+  mutex fd_mu_;
+  int active_fd_ TF_GUARDED_BY(fd_mu_) = -1;
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol, [](DataTransferServer::GetElementT get_element,
+                                 std::shared_ptr<DataTransferServer>* server) {
+          *server = std::make_shared<ShmDataTransferServer>(get_element);
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmConnection> connection,
+                              Connect(config.address));
+          *out = std::make_unique<ShmDataTransferClient>(
+              config.address, std::move(connection), config.allocator);
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+#endif  // defined(__linux__)
+
+}  // namespace data
+}  // namespace tensorflow
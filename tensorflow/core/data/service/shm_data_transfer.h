@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/data/service/common.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Shared-memory data transfer protocol for tf.data service workers that run
+// on the same host as their trainers.
+//
+// The worker listens on an abstract Unix domain socket named after its
+// transfer port. For every client connection it creates a memfd-backed ring
+// buffer and passes the file descriptor to the client. Requests and response
+// metadata go over the socket, while the bytes of memcpy-able tensors are
+// written into the ring buffer and aliased by the client without copying. The
+// client returns ring buffer space to the worker as the tensors are destroyed.
+// Components that cannot be shared (e.g. strings, variants, or tensors that do
+// not fit in the free space) are serialized inline over the socket.
+//
+// Enable it on the worker with `data_transfer_protocol: "shm"`. Compressed
+// elements are variants and always go inline, so clients that request "shm"
+// disable tf.data service compression at runtime. Clients that do not request a
+// protocol pick "shm" automatically for workers on the same host if the dataset
+// is not compressed, and use gRPC otherwise.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Size of the ring buffer created for each client connection. The memfd is
+// sparse, so untouched pages do not consume memory.
+constexpr uint64_t kShmRingBufferBytes = uint64_t{256} << 20;
+
+// Returns true if `server_info` describes a shared-memory transfer server that
+// runs on this host.
+bool IsLocalShmTransferServer(const DataTransferServerInfo& server_info);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
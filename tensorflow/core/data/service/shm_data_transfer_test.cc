@@ -0,0 +1,202 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::HasSubstr;
+
+struct ServerAndClient {
+  std::shared_ptr<DataTransferServer> server;
+  std::unique_ptr<DataTransferClient> client;
+};
+
+ServerAndClient StartServerAndClient(DataTransferServer::GetElementT fn) {
+  ServerAndClient result;
+  TF_CHECK_OK(DataTransferServer::Build(kShmTransferProtocol, std::move(fn),
+                                        &result.server));
+  TF_CHECK_OK(result.server->Start(experimental::WorkerConfig()));
+  DataTransferClient::Config config;
+  config.protocol = "grpc";
+  config.address = absl::StrCat("localhost:", result.server->Port());
+  config.accelerator_device_info = nullptr;
+  config.allocator = nullptr;
+  TF_CHECK_OK(
+      DataTransferClient::Build(kShmTransferProtocol, config, &result.client));
+  return result;
+}
+
+// Produces elements `[i, i + 1, ...]` with a string component.
+absl::Status MakeElement(int64_t size, const GetElementRequest* req,
+                         GetElementResult* result) {
+  const int64_t i = req->task_id();
+  Tensor numbers(DT_INT64, TensorShape({size}));
+  for (int64_t j = 0; j < size; ++j) {
+    numbers.flat<int64_t>()(j) = i + j;
+  }
+  result->components = {numbers,
+                        test::AsScalar<tstring>(absl::StrCat("element_", i))};
+  result->element_index = i;
+  return absl::OkStatus();
+}
+
+void ExpectElement(const GetElementResult& result, int64_t size, int64_t i) {
+  ASSERT_EQ(result.components.size(), 2);
+  ASSERT_EQ(result.components[0].NumElements(), size);
+  for (int64_t j = 0; j < size; ++j) {
+    ASSERT_EQ(result.components[0].flat<int64_t>()(j), i + j);
+  }
+  test::ExpectEqual(result.components[1],
+                    test::AsScalar<tstring>(absl::StrCat("element_", i)));
+  EXPECT_EQ(result.element_index, i);
+}
+
+TEST(ShmDataTransferTest, GetElements) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return MakeElement(/*size=*/16, req, result);
+      });
+  for (int64_t i = 0; i < 100; ++i) {
+    GetElementRequest req;
+    req.set_task_id(i);
+    GetElementResult result;
+    TF_ASSERT_OK(s.client->GetElement(req, result));
+    ExpectElement(result, /*size=*/16, i);
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+}
+
+TEST(ShmDataTransferTest, ComponentsAliasTheRingBuffer) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return MakeElement(/*size=*/16, req, result);
+      });
+  GetElementRequest req;
+  req.set_task_id(7);
+  GetElementResult result;
+  TF_ASSERT_OK(s.client->GetElement(req, result));
+  ExpectElement(result, /*size=*/16, 7);
+
+  // The numeric component is read from the shared mapping without copying,
+  // while the string component is sent inline.
+  TensorDescription numbers_description;
+  result.components[0].FillDescription(&numbers_description);
+  EXPECT_EQ(numbers_description.allocation_description().allocator_name(),
+            "tf_data_service_shm");
+  TensorDescription string_description;
+  result.components[1].FillDescription(&string_description);
+  EXPECT_NE(string_description.allocation_description().allocator_name(),
+            "tf_data_service_shm");
+}
+
+TEST(ShmDataTransferTest, HeldTensorsAreNotOverwritten) {
+  // 1 MiB per element, so the ring buffer wraps around several times.
+  constexpr int64_t kSize = (1 << 20) / sizeof(int64_t);
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return MakeElement(kSize, req, result);
+      });
+  GetElementRequest req;
+  req.set_task_id(0);
+  GetElementResult held;
+  TF_ASSERT_OK(s.client->GetElement(req, held));
+
+  const int64_t num_elements = 2 * kShmRingBufferBytes / (1 << 20);
+  for (int64_t i = 1; i < num_elements; ++i) {
+    req.set_task_id(i);
+    GetElementResult result;
+    TF_ASSERT_OK(s.client->GetElement(req, result));
+    ExpectElement(result, kSize, i);
+  }
+  ExpectElement(held, kSize, 0);
+}
+
+TEST(ShmDataTransferTest, EndOfSequence) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        result->end_of_sequence = true;
+        return absl::OkStatus();
+      });
+  GetElementResult result;
+  TF_ASSERT_OK(s.client->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, PropagatesErrors) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return absl::InvalidArgumentError("bad element");
+      });
+  GetElementResult result;
+  absl::Status status = s.client->GetElement(GetElementRequest(), result);
+  EXPECT_TRUE(absl::IsInvalidArgument(status));
+  EXPECT_THAT(status.message(), HasSubstr("bad element"));
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return MakeElement(/*size=*/1, req, result);
+      });
+  s.client->TryCancel();
+  GetElementResult result;
+  EXPECT_TRUE(absl::IsCancelled(
+      s.client->GetElement(GetElementRequest(), result)));
+}
+
+TEST(ShmDataTransferTest, CompatibilityInfo) {
+  ServerAndClient s = StartServerAndClient(
+      [](const GetElementRequest* req, GetElementResult* result) {
+        return absl::OkStatus();
+      });
+  TF_ASSERT_OK_AND_ASSIGN(std::string info, s.server->GetCompatibilityInfo());
+  TF_EXPECT_OK(s.client->CheckCompatibility(info));
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      s.client->CheckCompatibility("some-other-host")));
+
+  DataTransferServerInfo server_info;
+  server_info.set_protocol(kShmTransferProtocol);
+  server_info.set_compatibility_info(info);
+  EXPECT_TRUE(IsLocalShmTransferServer(server_info));
+  server_info.set_compatibility_info("some-other-host");
+  EXPECT_FALSE(IsLocalShmTransferServer(server_info));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,304 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_snapshot_chunk_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/threadpool.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/platform/tstring.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char kNumChunks[] = "num_chunks";
+constexpr const char kChunkFilename[] = "chunk_filename";
+constexpr const char kNumConsumed[] = "num_consumed";
+constexpr const char kParallelSnapshotChunkReader[] =
+    "ParallelSnapshotChunkReader";
+
+constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
+
+}  // namespace
+
+ParallelSnapshotChunkReader::ParallelSnapshotChunkReader(
+    tsl::Env* env, std::shared_ptr<SplitProvider> split_provider,
+    const std::string& compression, const DataTypeVector& dtypes,
+    int64_t num_parallel_chunks, ByteSize max_buffered_bytes)
+    : env_(env),
+      split_provider_(std::move(split_provider)),
+      compression_(compression),
+      dtypes_(dtypes),
+      num_parallel_chunks_(std::max<int64_t>(num_parallel_chunks, 1)),
+      max_buffered_bytes_(max_buffered_bytes.ToUnsignedBytes()) {}
+
+ParallelSnapshotChunkReader::~ParallelSnapshotChunkReader() {
+  Cancel();
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool;
+  {
+    absl::MutexLock l(&mu_);
+    thread_pool = std::move(thread_pool_);
+  }
+  // Joins the reader threads.
+  thread_pool.reset();
+}
+
+absl::Status ParallelSnapshotChunkReader::GetNext(std::vector<Tensor>& element,
+                                                  bool& end_of_sequence) {
+  absl::MutexLock l(&mu_);
+  if (thread_pool_ == nullptr) {
+    thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+        env_, tsl::ThreadOptions{}, "read_snapshot_chunk_thread",
+        num_parallel_chunks_);
+    for (int64_t i = 0; i < num_parallel_chunks_; ++i) {
+      thread_pool_->Schedule([this]() { ReadChunks(); });
+    }
+  }
+  while (true) {
+    if (cancelled_) {
+      return absl::CancelledError(
+          "tf.data snapshot chunk reader has been cancelled.");
+    }
+    if (chunks_.empty()) {
+      if (end_of_splits_) {
+        end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      cv_.Wait(&mu_);
+      continue;
+    }
+    Chunk& chunk = *chunks_.front();
+    if (!chunk.elements.empty()) {
+      element = std::move(chunk.elements.front());
+      chunk.elements.pop_front();
+      ++chunk.num_consumed;
+      buffered_bytes_ -= ElementSizeBytes(element);
+      end_of_sequence = false;
+      cv_.SignalAll();
+      return absl::OkStatus();
+    }
+    if (chunk.done) {
+      absl::Status status = chunk.status;
+      chunks_.pop_front();
+      cv_.SignalAll();
+      TF_RETURN_IF_ERROR(status);
+      continue;
+    }
+    cv_.Wait(&mu_);
+  }
+}
+
+void ParallelSnapshotChunkReader::Cancel() {
+  split_provider_->Cancel();
+  absl::MutexLock l(&mu_);
+  cancelled_ = true;
+  cv_.SignalAll();
+}
+
+void ParallelSnapshotChunkReader::ReadChunks() {
+  while (std::shared_ptr<Chunk> chunk = GetNextChunk()) {
+    const uint64_t start_us = env_->NowMicros();
+    absl::Status status = ReadChunk(*chunk);
+    if (status.ok()) {
+      metrics::RecordTFDataServiceSnapshotChunkReadDuration(env_->NowMicros() -
+                                                            start_us);
+    }
+    absl::MutexLock l(&mu_);
+    chunk->done = true;
+    chunk->status = std::move(status);
+    cv_.SignalAll();
+  }
+}
+
+std::shared_ptr<ParallelSnapshotChunkReader::Chunk>
+ParallelSnapshotChunkReader::GetNextChunk() {
+  {
+    absl::MutexLock l(&mu_);
+    if (cancelled_) {
+      return nullptr;
+    }
+    for (const std::shared_ptr<Chunk>& chunk : chunks_) {
+      if (!chunk->assigned) {
+        chunk->assigned = true;
+        return chunk;
+      }
+    }
+  }
+
+  absl::MutexLock split_lock(&split_mu_);
+  {
+    absl::MutexLock l(&mu_);
+    if (cancelled_ || end_of_splits_) {
+      return nullptr;
+    }
+  }
+  Tensor split;
+  bool end_of_splits = false;
+  absl::Status status = split_provider_->GetNext(&split, &end_of_splits);
+  absl::MutexLock l(&mu_);
+  if (!status.ok()) {
+    // Surfaces the error to the consumer after the chunks handed out before.
+    auto error = std::make_shared<Chunk>(/*filename=*/"", /*num_to_skip=*/0);
+    error->assigned = true;
+    error->done = true;
+    error->status = std::move(status);
+    chunks_.push_back(std::move(error));
+    end_of_splits_ = true;
+    cv_.SignalAll();
+    return nullptr;
+  }
+  if (end_of_splits) {
+    end_of_splits_ = true;
+    cv_.SignalAll();
+    return nullptr;
+  }
+  auto chunk = std::make_shared<Chunk>(split.scalar<tsl::tstring>()(),
+                                       /*num_to_skip=*/0);
+  chunk->assigned = true;
+  chunks_.push_back(chunk);
+  cv_.SignalAll();
+  return chunk;
+}
+
+absl::Status ParallelSnapshotChunkReader::ReadChunk(Chunk& chunk) {
+  tsl::profiler::TraceMe activity("ReadSnapshotChunk",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  snapshot_util::TFRecordReader reader(TranslateFileName(chunk.filename),
+                                       compression_, dtypes_,
+                                       kTFRecordReaderOutputBufferSize);
+  TF_RETURN_IF_ERROR(reader.Initialize(env_));
+  absl::Status status;
+  for (int64_t i = 0; status.ok(); ++i) {
+    std::vector<Tensor> element;
+    status = reader.ReadTensors(&element);
+    if (!status.ok() || i < chunk.num_to_skip) {
+      continue;
+    }
+    status = BufferElement(chunk, std::move(element));
+  }
+  metrics::GetTFDataBytesReadCounter(kParallelSnapshotChunkReader)
+      ->IncrementBy(reader.BytesRead());
+  if (absl::IsOutOfRange(status)) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      status, " Failed to read tf.data snapshot file: ", chunk.filename);
+  return status;
+}
+
+absl::Status ParallelSnapshotChunkReader::BufferElement(
+    Chunk& chunk, std::vector<Tensor> element) {
+  const int64_t element_size_bytes = ElementSizeBytes(element);
+  absl::MutexLock l(&mu_);
+  // The chunk being consumed may always buffer one element, so the consumer
+  // can make progress when later chunks fill up the buffers.
+  while (!cancelled_ && buffered_bytes_ + element_size_bytes >
+                            max_buffered_bytes_ &&
+         (chunks_.front().get() != &chunk || !chunk.elements.empty())) {
+    cv_.Wait(&mu_);
+  }
+  if (cancelled_) {
+    return absl::CancelledError(
+        "tf.data snapshot chunk reader has been cancelled.");
+  }
+  buffered_bytes_ += element_size_bytes;
+  chunk.elements.push_back(std::move(element));
+  cv_.SignalAll();
+  return absl::OkStatus();
+}
+
+int64_t ParallelSnapshotChunkReader::ElementSizeBytes(
+    const std::vector<Tensor>& element) {
+  int64_t size_bytes = 0;
+  for (const Tensor& tensor : element) {
+    size_bytes += tensor.TotalBytes();
+  }
+  return size_bytes;
+}
+
+absl::Status ParallelSnapshotChunkReader::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  absl::MutexLock split_lock(&split_mu_);
+  absl::MutexLock l(&mu_);
+  TF_RETURN_IF_ERROR(split_provider_->Save(full_name, writer));
+  // Chunks that are being read or whose read failed are saved like any other
+  // chunk, so that they are read again after restoring. Only the entry that
+  // surfaces a split provider error has no chunk to save.
+  std::vector<std::shared_ptr<Chunk>> chunks;
+  for (const std::shared_ptr<Chunk>& chunk : chunks_) {
+    if (!chunk->filename.empty()) {
+      chunks.push_back(chunk);
+    }
+  }
+  TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumChunks),
+                                         static_cast<int64_t>(chunks.size())));
+  for (int64_t i = 0; i < chunks.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(full_name(absl::StrCat(kChunkFilename, "_", i)),
+                            chunks[i]->filename));
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(full_name(absl::StrCat(kNumConsumed, "_", i)),
+                            chunks[i]->num_consumed));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParallelSnapshotChunkReader::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  absl::MutexLock split_lock(&split_mu_);
+  absl::MutexLock l(&mu_);
+  if (thread_pool_ != nullptr) {
+    return absl::FailedPreconditionError(
+        "tf.data snapshot chunk reader can only be restored before reading.");
+  }
+  TF_RETURN_IF_ERROR(split_provider_->Restore(full_name, reader));
+  int64_t num_chunks = 0;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumChunks), &num_chunks));
+  chunks_.clear();
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    tsl::tstring filename;
+    int64_t num_consumed = 0;
+    TF_RETURN_IF_ERROR(reader->ReadScalar(
+        full_name(absl::StrCat(kChunkFilename, "_", i)), &filename));
+    TF_RETURN_IF_ERROR(reader->ReadScalar(
+        full_name(absl::StrCat(kNumConsumed, "_", i)), &num_consumed));
+    chunks_.push_back(std::make_shared<Chunk>(filename, num_consumed));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,155 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_SNAPSHOT_CHUNK_READER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_SNAPSHOT_CHUNK_READER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/threadpool.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Reads the chunks of a tf.data distributed snapshot using multiple threads.
+// `split_provider` (usually a `SnapshotChunkProvider`) decides the chunk order.
+// Elements are returned chunk by chunk in that order, so the output order is
+// the same as reading the chunks one at a time. Up to `num_parallel_chunks`
+// chunks are read and decompressed ahead of the consumer. Buffered elements are
+// bounded by `max_buffered_bytes`, except that the chunk being consumed may
+// always buffer one element. This class is thread-safe.
+//
+// Usage example:
+//
+// ParallelSnapshotChunkReader reader(
+//     Env::Default(), std::make_shared<SnapshotChunkProvider>(path, env),
+//     tsl::io::compression::kSnappy, dtypes, /*num_parallel_chunks=*/4,
+//     ByteSize::GB(1));
+//
+// std::vector<Tensor> element;
+// bool end_of_sequence = false;
+// TF_RETURN_IF_ERROR(reader.GetNext(element, end_of_sequence));
+// while (!end_of_sequence) {
+//   ...
+//   TF_RETURN_IF_ERROR(reader.GetNext(element, end_of_sequence));
+// }
+class ParallelSnapshotChunkReader {
+ public:
+  ParallelSnapshotChunkReader(tsl::Env* env,
+                              std::shared_ptr<SplitProvider> split_provider,
+                              const std::string& compression,
+                              const DataTypeVector& dtypes,
+                              int64_t num_parallel_chunks,
+                              ByteSize max_buffered_bytes);
+  virtual ~ParallelSnapshotChunkReader();
+  ParallelSnapshotChunkReader(const ParallelSnapshotChunkReader&) = delete;
+  ParallelSnapshotChunkReader& operator=(const ParallelSnapshotChunkReader&) =
+      delete;
+
+  // Gets the next element. Blocks until the element has been read. Sets
+  // `end_of_sequence` to true after all chunks have been read.
+  absl::Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence);
+
+  // Cancels the reader. In-flight and future `GetNext` calls return Cancelled.
+  void Cancel();
+
+  // Supports checkpointing. The state consists of the split provider state and
+  // the number of elements consumed from each chunk handed out by it that has
+  // not been fully consumed, including chunks whose read failed. `Save` blocks
+  // while a reader thread waits for the split provider to produce a chunk.
+  absl::Status Save(std::function<std::string(std::string)> full_name,
+                    IteratorStateWriter* writer);
+  // REQUIRES: `GetNext` has not been called.
+  absl::Status Restore(std::function<std::string(std::string)> full_name,
+                       IteratorStateReader* reader);
+
+ private:
+  // A chunk handed out by the split provider.
+  struct Chunk {
+    Chunk(const std::string& filename, int64_t num_to_skip)
+        : filename(filename),
+          num_to_skip(num_to_skip),
+          num_consumed(num_to_skip) {}
+
+    const std::string filename;
+    // Number of elements to skip when reading the chunk, after a restore.
+    const int64_t num_to_skip;
+    // Elements read from the chunk that have not been consumed.
+    std::deque<std::vector<Tensor>> elements;
+    int64_t num_consumed = 0;
+    // Whether a thread is reading the chunk.
+    bool assigned = false;
+    // Whether the chunk has been read. If `status` is not OK, reading the
+    // chunk failed.
+    bool done = false;
+    absl::Status status;
+  };
+
+  // Run by each reader thread.
+  void ReadChunks();
+
+  // Gets the next chunk to read. Restored chunks are read first; afterwards,
+  // chunks come from `split_provider_`. Returns nullptr if there are no more
+  // chunks to read.
+  std::shared_ptr<Chunk> GetNextChunk();
+
+  // Reads `chunk` into its element buffer.
+  absl::Status ReadChunk(Chunk& chunk);
+
+  // Adds `element` to `chunk`, blocking while the buffers are full.
+  absl::Status BufferElement(Chunk& chunk, std::vector<Tensor> element);
+
+  // Estimated size of `element` in bytes.
+  static int64_t ElementSizeBytes(const std::vector<Tensor>& element);
+
+  tsl::Env* const env_;
+  const std::shared_ptr<SplitProvider> split_provider_;
+  const std::string compression_;
+  const DataTypeVector dtypes_;
+  const int64_t num_parallel_chunks_;
+  const int64_t max_buffered_bytes_;
+
+  // Held while getting a chunk from `split_provider_` and adding it to
+  // `chunks_`, so that chunks are consumed in the order they are handed out.
+  absl::Mutex split_mu_ ABSL_ACQUIRED_BEFORE(mu_);
+
+  mutable absl::Mutex mu_;
+  absl::CondVar cv_;
+  // Chunks in the order they should be consumed.
+  std::deque<std::shared_ptr<Chunk>> chunks_ ABSL_GUARDED_BY(mu_);
+  int64_t buffered_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  bool end_of_splits_ ABSL_GUARDED_BY(mu_) = false;
+  bool cancelled_ ABSL_GUARDED_BY(mu_) = false;
+
+  // Reader threads are started on the first `GetNext` call.
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_SNAPSHOT_CHUNK_READER_H_
@@ -0,0 +1,274 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_snapshot_chunk_reader.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/status_matchers.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/tsl/platform/test.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+// Hands out `chunks` in order.
+class ListSplitProvider : public SplitProvider {
+ public:
+  explicit ListSplitProvider(std::vector<std::string> chunks)
+      : chunks_(std::move(chunks)) {}
+
+  absl::Status GetNext(Tensor* split, bool* end_of_splits) override {
+    absl::MutexLock l(&mu_);
+    if (next_ >= chunks_.size()) {
+      *end_of_splits = true;
+      return absl::OkStatus();
+    }
+    *split = Tensor(chunks_[next_++]);
+    *end_of_splits = false;
+    return absl::OkStatus();
+  }
+
+  absl::Status Reset() override {
+    absl::MutexLock l(&mu_);
+    next_ = 0;
+    return absl::OkStatus();
+  }
+
+  absl::Status Save(std::function<std::string(std::string)> full_name,
+                    IteratorStateWriter* writer) override {
+    absl::MutexLock l(&mu_);
+    return writer->WriteScalar(full_name("next"), next_);
+  }
+
+  absl::Status Restore(std::function<std::string(std::string)> full_name,
+                       IteratorStateReader* reader) override {
+    absl::MutexLock l(&mu_);
+    return reader->ReadScalar(full_name("next"), &next_);
+  }
+
+  int64_t Cardinality() const override { return chunks_.size(); }
+
+ private:
+  const std::vector<std::string> chunks_;
+  absl::Mutex mu_;
+  int64_t next_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Writes `num_chunks` chunks of `num_elements_per_chunk` elements each. The
+// elements are consecutive integers starting at 0.
+absl::StatusOr<std::vector<std::string>> WriteChunks(
+    int64_t num_chunks, int64_t num_elements_per_chunk) {
+  std::string directory;
+  if (!tsl::Env::Default()->LocalTempFilename(&directory)) {
+    return absl::FailedPreconditionError(
+        "Failed to create local temp file for snapshot chunks.");
+  }
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(directory));
+  std::vector<std::string> chunks;
+  int64_t next = 0;
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    std::string chunk = tsl::io::JoinPath(directory, absl::StrCat("chunk_", i));
+    snapshot_util::TFRecordWriter writer(chunk,
+                                         tsl::io::compression::kSnappy);
+    TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+    for (int64_t j = 0; j < num_elements_per_chunk; ++j) {
+      TF_RETURN_IF_ERROR(writer.WriteTensors({Tensor(next++)}));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    chunks.push_back(std::move(chunk));
+  }
+  return chunks;
+}
+
+std::unique_ptr<ParallelSnapshotChunkReader> CreateReader(
+    const std::vector<std::string>& chunks, int64_t num_parallel_chunks,
+    ByteSize max_buffered_bytes) {
+  return std::make_unique<ParallelSnapshotChunkReader>(
+      tsl::Env::Default(), std::make_shared<ListSplitProvider>(chunks),
+      tsl::io::compression::kSnappy, DataTypeVector{DT_INT64},
+      num_parallel_chunks, max_buffered_bytes);
+}
+
+absl::StatusOr<std::vector<int64_t>> ReadElements(
+    ParallelSnapshotChunkReader& reader, int64_t max_num_elements = -1) {
+  std::vector<int64_t> elements;
+  while (max_num_elements < 0 || elements.size() < max_num_elements) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_RETURN_IF_ERROR(reader.GetNext(element, end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    elements.push_back(element[0].scalar<int64_t>()());
+  }
+  return elements;
+}
+
+std::vector<int64_t> Range(int64_t begin, int64_t end) {
+  std::vector<int64_t> range;
+  for (int64_t i = begin; i < end; ++i) {
+    range.push_back(i);
+  }
+  return range;
+}
+
+std::string full_name(const std::string& name) {
+  return FullName("test", name);
+}
+
+class ParallelSnapshotChunkReaderTest
+    : public ::testing::TestWithParam<int64_t> {
+ protected:
+  int64_t NumParallelChunks() const { return GetParam(); }
+};
+
+TEST_P(ParallelSnapshotChunkReaderTest, ReadsChunksInOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/10,
+                                      /*num_elements_per_chunk=*/20));
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::GB(1));
+  EXPECT_THAT(ReadElements(*reader),
+              IsOkAndHolds(ElementsAreArray(Range(0, 200))));
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, SmallBufferBudget) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/10,
+                                      /*num_elements_per_chunk=*/20));
+  // Smaller than one element, so each chunk buffers at most one element.
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::Bytes(1));
+  EXPECT_THAT(ReadElements(*reader),
+              IsOkAndHolds(ElementsAreArray(Range(0, 200))));
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, EmptyChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/5,
+                                      /*num_elements_per_chunk=*/0));
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::GB(1));
+  EXPECT_THAT(ReadElements(*reader), IsOkAndHolds(IsEmpty()));
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, SaveAndRestore) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/10,
+                                      /*num_elements_per_chunk=*/20));
+  for (int64_t num_to_read : {0, 1, 19, 20, 55, 199, 200}) {
+    auto reader =
+        CreateReader(chunks, NumParallelChunks(), ByteSize::Bytes(64));
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> elements,
+                            ReadElements(*reader, num_to_read));
+    EXPECT_THAT(elements, ElementsAreArray(Range(0, num_to_read)));
+
+    VariantTensorDataWriter writer;
+    TF_ASSERT_OK(reader->Save(full_name, &writer));
+    std::vector<const VariantTensorData*> variants;
+    writer.GetData(&variants);
+    VariantTensorDataReader state_reader(variants);
+    auto restored_reader =
+        CreateReader(chunks, NumParallelChunks(), ByteSize::Bytes(64));
+    TF_ASSERT_OK(restored_reader->Restore(full_name, &state_reader));
+    EXPECT_THAT(ReadElements(*restored_reader),
+                IsOkAndHolds(
+                    ElementsAreArray(Range(num_to_read, 200))));
+  }
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, RestoreRereadsFailedChunk) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/4,
+                                      /*num_elements_per_chunk=*/5));
+  // The third chunk is unavailable until after the checkpoint, so its read
+  // fails or is still pending when the reader is saved.
+  const std::string moved_chunk = absl::StrCat(chunks[2], ".moved");
+  TF_ASSERT_OK(tsl::Env::Default()->RenameFile(chunks[2], moved_chunk));
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::GB(1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> elements,
+                          ReadElements(*reader, /*max_num_elements=*/5));
+  EXPECT_THAT(elements, ElementsAreArray(Range(0, 5)));
+
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(reader->Save(full_name, &writer));
+  reader.reset();
+  std::vector<const VariantTensorData*> variants;
+  writer.GetData(&variants);
+  VariantTensorDataReader state_reader(variants);
+
+  TF_ASSERT_OK(tsl::Env::Default()->RenameFile(moved_chunk, chunks[2]));
+  auto restored_reader =
+      CreateReader(chunks, NumParallelChunks(), ByteSize::GB(1));
+  TF_ASSERT_OK(restored_reader->Restore(full_name, &state_reader));
+  EXPECT_THAT(ReadElements(*restored_reader),
+              IsOkAndHolds(ElementsAreArray(Range(5, 20))));
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, MissingChunk) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/3,
+                                      /*num_elements_per_chunk=*/5));
+  chunks.push_back(tsl::io::JoinPath(tsl::testing::TmpDir(), "missing_chunk"));
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::GB(1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> elements,
+                          ReadElements(*reader, /*max_num_elements=*/15));
+  EXPECT_THAT(elements, ElementsAreArray(Range(0, 15)));
+  EXPECT_THAT(ReadElements(*reader), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_P(ParallelSnapshotChunkReaderTest, Cancel) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> chunks,
+                          WriteChunks(/*num_chunks=*/10,
+                                      /*num_elements_per_chunk=*/20));
+  auto reader = CreateReader(chunks, NumParallelChunks(), ByteSize::Bytes(1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> elements,
+                          ReadElements(*reader, /*max_num_elements=*/10));
+  EXPECT_THAT(elements, ElementsAreArray(Range(0, 10)));
+  reader->Cancel();
+  EXPECT_THAT(ReadElements(*reader), StatusIs(absl::StatusCode::kCancelled));
+}
+
+INSTANTIATE_TEST_SUITE_P(NumParallelChunks, ParallelSnapshotChunkReaderTest,
+                         ::testing::Values(1, 2, 8));
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
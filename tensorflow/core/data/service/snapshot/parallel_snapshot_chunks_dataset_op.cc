@@ -0,0 +1,260 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/parallel_snapshot_chunk_reader.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char kParallelSnapshotChunksDataset[] =
+    "ParallelSnapshotChunksDataset";
+constexpr const char kSnapshotPath[] = "snapshot_path";
+constexpr const char kNumParallelChunks[] = "num_parallel_chunks";
+constexpr const char kMaxBufferedBytes[] = "max_buffered_bytes";
+constexpr const char kCompression[] = "compression";
+constexpr const char kOutputTypes[] = "output_types";
+constexpr const char kOutputShapes[] = "output_shapes";
+
+constexpr ByteSize kDefaultMaxBufferedBytes = ByteSize::GB(1);
+
+// Reads all chunks of a tf.data distributed snapshot, prefetching and
+// decompressing `num_parallel_chunks` chunks concurrently. Elements are
+// produced chunk by chunk in the order of `SnapshotChunkProvider`.
+class ParallelSnapshotChunksDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ParallelSnapshotChunksDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  std::string compression_;
+};
+
+class ParallelSnapshotChunksDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, tsl::tstring snapshot_path,
+          int64_t num_parallel_chunks, int64_t max_buffered_bytes,
+          const std::string& compression, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        snapshot_path_(std::move(snapshot_path)),
+        num_parallel_chunks_(num_parallel_chunks),
+        max_buffered_bytes_(max_buffered_bytes),
+        compression_(compression),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        env_(ctx->env()) {}
+
+  absl::string_view snapshot_path() const { return snapshot_path_; }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  absl::Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                      split_providers) const override {
+    split_providers->push_back(
+        std::make_unique<SnapshotChunkProvider>(snapshot_path_, env_));
+    return absl::OkStatus();
+  }
+
+  std::string DebugString() const override {
+    return name_utils::DatasetDebugString(kParallelSnapshotChunksDataset);
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    inputs->clear();
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckExternalState() const override { return absl::OkStatus(); }
+
+ protected:
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const std::string& prefix) const override;
+
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* snapshot_path = nullptr;
+    Node* num_parallel_chunks = nullptr;
+    Node* max_buffered_bytes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(snapshot_path_, &snapshot_path));
+    TF_RETURN_IF_ERROR(
+        b->AddScalar(num_parallel_chunks_, &num_parallel_chunks));
+    TF_RETURN_IF_ERROR(b->AddScalar(max_buffered_bytes_, &max_buffered_bytes));
+    AttrValue compression;
+    b->BuildAttrValue(compression_, &compression);
+    return b->AddDataset(
+        this,
+        /*inputs=*/{snapshot_path, num_parallel_chunks, max_buffered_bytes},
+        /*attrs=*/{{kCompression, compression}}, output);
+  }
+
+ private:
+  class Iterator;
+
+  const tsl::tstring snapshot_path_;
+  const int64_t num_parallel_chunks_;
+  const int64_t max_buffered_bytes_;
+  const std::string compression_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  tsl::Env* const env_;
+};
+
+class ParallelSnapshotChunksDatasetOp::Dataset::Iterator
+    : public DatasetIterator<ParallelSnapshotChunksDatasetOp::Dataset> {
+ public:
+  explicit Iterator(const Params& params)
+      : DatasetIterator<ParallelSnapshotChunksDatasetOp::Dataset>(params) {}
+
+  ~Iterator() override {
+    if (deregister_fn_) deregister_fn_();
+  }
+
+  absl::Status Initialize(IteratorContext* ctx) override {
+    std::shared_ptr<SplitProvider> split_provider;
+    if (ctx->split_providers().empty()) {
+      split_provider = std::make_shared<SnapshotChunkProvider>(
+          dataset()->snapshot_path(), ctx->env());
+    } else {
+      TF_ASSIGN_OR_RETURN(split_provider,
+                          GetSingleSplitProvider(ctx, dataset()));
+    }
+    int64_t num_parallel_chunks = dataset()->num_parallel_chunks_;
+    if (num_parallel_chunks == model::kAutotune) {
+      num_parallel_chunks = GetAutotuneDefaultParallelism(ctx);
+    }
+    const ByteSize max_buffered_bytes =
+        dataset()->max_buffered_bytes_ == model::kAutotune
+            ? kDefaultMaxBufferedBytes
+            : ByteSize::Bytes(dataset()->max_buffered_bytes_);
+    reader_ = std::make_unique<ParallelSnapshotChunkReader>(
+        ctx->env(), std::move(split_provider), dataset()->compression_,
+        dataset()->output_types_, num_parallel_chunks, max_buffered_bytes);
+    return RegisterCancellationCallback(
+        ctx->cancellation_manager(), [this]() { reader_->Cancel(); },
+        &deregister_fn_);
+  }
+
+ private:
+  absl::Status GetNextInternal(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) override {
+    return reader_->GetNext(*out_tensors, *end_of_sequence);
+  }
+
+  absl::Status SaveInternal(SerializationContext* ctx,
+                            IteratorStateWriter* writer) override {
+    return reader_->Save(
+        [&](const std::string& key) { return full_name(key); }, writer);
+  }
+
+  absl::Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+    return reader_->Restore(
+        [&](const std::string& key) { return full_name(key); }, reader);
+  }
+
+  std::unique_ptr<ParallelSnapshotChunkReader> reader_;
+  std::function<void()> deregister_fn_;
+};
+
+ParallelSnapshotChunksDatasetOp::ParallelSnapshotChunksDatasetOp(
+    OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+}
+
+void ParallelSnapshotChunksDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase** output) {
+  tsl::tstring snapshot_path;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kSnapshotPath, &snapshot_path));
+  OP_REQUIRES(ctx, !snapshot_path.empty(),
+              absl::InvalidArgumentError(
+                  "snapshot_path is required to read snapshot chunks."));
+  int64_t num_parallel_chunks = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kNumParallelChunks,
+                                          &num_parallel_chunks));
+  OP_REQUIRES(
+      ctx, num_parallel_chunks > 0 || num_parallel_chunks == model::kAutotune,
+      absl::InvalidArgumentError(
+          "num_parallel_chunks must be greater than zero or AUTOTUNE."));
+  int64_t max_buffered_bytes = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kMaxBufferedBytes,
+                                          &max_buffered_bytes));
+  OP_REQUIRES(
+      ctx, max_buffered_bytes > 0 || max_buffered_bytes == model::kAutotune,
+      absl::InvalidArgumentError(
+          "max_buffered_bytes must be greater than zero or AUTOTUNE."));
+  *output = new ParallelSnapshotChunksDatasetOp::Dataset(
+      ctx, std::move(snapshot_path), num_parallel_chunks, max_buffered_bytes,
+      compression_, output_types_, output_shapes_);
+}
+
+std::unique_ptr<IteratorBase>
+ParallelSnapshotChunksDatasetOp::Dataset::MakeIteratorInternal(
+    const std::string& prefix) const {
+  return std::make_unique<ParallelSnapshotChunksDatasetOp::Dataset::Iterator>(
+      ParallelSnapshotChunksDatasetOp::Dataset::Iterator::Params{
+          this,
+          name_utils::IteratorPrefix(kParallelSnapshotChunksDataset, prefix)});
+}
+
+REGISTER_KERNEL_BUILDER(
+    Name(kParallelSnapshotChunksDataset).Device(DEVICE_CPU),
+    ParallelSnapshotChunksDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -214,6 +214,21 @@ TEST(FirstComeFirstServedTaskRunnerTest, GetNext) {
   EXPECT_TRUE(result.end_of_sequence);
 }
 
+TEST(FirstComeFirstServedTaskRunnerTest, GetNextWithLargerBuffer) {
+  size_t range = 10;
+  FirstComeFirstServedTaskRunner runner(
+      std::make_unique<RangeIterator>(range, /*repeat=*/false),
+      /*buffer_size=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> output,
+      GetTaskRunnerOutput<int64_t>(runner, GetElementRequest()));
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 TEST(FirstComeFirstServedTaskRunnerTest, EmptyDataset) {
   FirstComeFirstServedTaskRunner runner(
       std::make_unique<RangeIterator>(/*range=*/0, /*repeat=*/false));
@@ -81,6 +81,13 @@ absl::Status DataServiceWorkerClient::GetElement(const GetElementRequest& req,
   return client_->GetElement(req, result);
 }
 
+absl::Status DataServiceWorkerClient::GetElements(
+    const GetElementRequest& req, int64_t max_elements, int64_t max_bytes,
+    std::vector<GetElementResult>& results) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return client_->GetElements(req, max_elements, max_bytes, results);
+}
+
 absl::Status DataServiceWorkerClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (client_) {
@@ -142,6 +149,85 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
                                                    end_time_us - start_time_us);
+    return ParseResponse(resp, result);
+  }
+
+  absl::Status GetElements(const GetElementRequest& req, int64_t max_elements,
+                           int64_t max_bytes,
+                           std::vector<GetElementResult>& results) override {
+    bool use_batched_rpc = false;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      use_batched_rpc = max_elements > 1 && get_elements_supported_;
+    }
+    if (!use_batched_rpc) {
+      return DataTransferClient::GetElements(req, max_elements, max_bytes,
+                                             results);
+    }
+    VLOG(3) << "GetElements for task " << req.task_id() << " from gRPC worker "
+            << "server.";
+    grpc::ClientContext ctx;
+    gtl::Cleanup<std::function<void()>> cleanup;
+    {
+      mutex_lock l(mu_);
+      active_contexts_.insert(&ctx);
+      cleanup = gtl::MakeCleanup([this, &ctx] {
+        mutex_lock l(mu_);
+        active_contexts_.erase(&ctx);
+      });
+    }
+    GetElementsRequest batch_req;
+    *batch_req.mutable_request() = req;
+    batch_req.set_max_elements(max_elements);
+    batch_req.set_max_bytes(max_bytes);
+    GetElementsResponse resp;
+    int64_t start_time_us = env_->NowMicros();
+    grpc::Status s = stub_->GetElements(&ctx, batch_req, &resp);
+    int64_t end_time_us = env_->NowMicros();
+    if (s.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+      // The worker predates the batched RPC.
+      VLOG(1) << "Worker does not support GetElements; falling back to "
+              << "GetElement.";
+      {
+        mutex_lock l(mu_);
+        get_elements_supported_ = false;
+      }
+      return DataTransferClient::GetElements(req, max_elements, max_bytes,
+                                             results);
+    }
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    if (resp.elements().empty()) {
+      return errors::Internal("GetElements returned no elements for task ",
+                              req.task_id());
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+                                                   end_time_us - start_time_us);
+    for (const GetElementResponse& element : resp.elements()) {
+      GetElementResult result;
+      TF_RETURN_IF_ERROR(ParseResponse(element, result));
+      results.push_back(std::move(result));
+    }
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  absl::Status ParseResponse(const GetElementResponse& resp,
+                             GetElementResult& result) {
+    result.element_index = resp.element_index();
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
@@ -169,16 +255,6 @@ class GrpcDataTransferClient : public DataTransferClient {
     return absl::OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
   Allocator* const allocator_;
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
@@ -189,6 +265,8 @@ class GrpcDataTransferClient : public DataTransferClient {
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Set to false once the worker rejects GetElements as unimplemented.
+  bool get_elements_supported_ TF_GUARDED_BY(mu_) = true;
 };
 
 class GrpcTransferClientRegistrar {
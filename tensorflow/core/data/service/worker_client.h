@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_CLIENT_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_WORKER_CLIENT_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -51,6 +53,12 @@ class DataServiceWorkerClient : public DataServiceClientBase {
   absl::Status GetElement(const GetElementRequest& req,
                           GetElementResult& result);
 
+  // Fetches up to `max_elements` elements from the worker. See
+  // `DataTransferClient::GetElements`.
+  absl::Status GetElements(const GetElementRequest& req, int64_t max_elements,
+                           int64_t max_bytes,
+                           std::vector<GetElementResult>& results);
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   void TryCancel();
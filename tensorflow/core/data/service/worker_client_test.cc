@@ -18,6 +18,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -283,6 +284,35 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param;
     });
 
+TEST_F(WorkerClientTest, BatchedNetworkRead) {
+  // Consider the worker to be remote so that local protocol isn't forced on.
+  LocalWorkers::Remove(GetWorkerAddress());
+
+  const int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcTransferProtocol));
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  std::vector<GetElementResult> results;
+  while (results.empty() || !results.back().end_of_sequence) {
+    const size_t num_results = results.size();
+    TF_ASSERT_OK(client->GetElements(request, /*max_elements=*/4,
+                                     /*max_bytes=*/0, results));
+    ASSERT_GT(results.size(), num_results);
+    ASSERT_LE(results.size(), num_results + 4);
+  }
+  ASSERT_EQ(results.size(), range + 1);
+  for (int64_t i = 0; i < range; ++i) {
+    EXPECT_FALSE(results[i].end_of_sequence);
+    test::ExpectEqual(results[i].components[0], Tensor(int64_t{i * i}));
+  }
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
                           RegisterDataset(/*range=*/5));
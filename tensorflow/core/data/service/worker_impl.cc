@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -118,6 +119,9 @@ WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
     new_config.set_snapshot_max_chunk_size_bytes(
         kDefaultMaxChunkSize.ToUnsignedBytes());
   }
+  if (new_config.topology().host().empty()) {
+    new_config.mutable_topology()->set_host(port::Hostname());
+  }
   return new_config;
 }
 
@@ -491,6 +495,53 @@ absl::Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   return absl::OkStatus();
 }
 
+absl::Status DataServiceWorkerImpl::GetElements(
+    const GetElementsRequest* request, GetElementsResponse* response) {
+  const GetElementRequest& first_request = request->request();
+  VLOG(3) << "Received GetElements request for task "
+          << first_request.task_id();
+  if (first_request.has_round_index() || first_request.has_consumer_index()) {
+    return errors::InvalidArgument(
+        "GetElements does not support coordinated reads. Use GetElement "
+        "instead.");
+  }
+  // Only the first element may block. Cross-trainer cache reads are always
+  // served one element at a time.
+  const int64_t max_elements =
+      first_request.trainer_id().empty()
+          ? std::max<int64_t>(request->max_elements(), 1)
+          : 1;
+  GetElementRequest next_request = first_request;
+  next_request.set_allow_skip(true);
+  int64_t num_bytes = 0;
+  for (int64_t i = 0; i < max_elements; ++i) {
+    struct GetElementResult result;
+    if (i == 0) {
+      TF_RETURN_IF_ERROR(GetElementResult(&first_request, &result));
+    } else if (!GetElementResult(&next_request, &result).ok() || result.skip) {
+      // No more elements are ready. Errors after the first element surface on
+      // the next request, so the elements already produced are not lost.
+      break;
+    }
+    num_bytes += result.EstimatedMemoryUsageBytes();
+    GetElementResponse* element = response->add_elements();
+    element->set_end_of_sequence(result.end_of_sequence);
+    element->set_skip_task(result.skip);
+    element->set_element_index(result.element_index);
+    if (result.end_of_sequence || result.skip) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(
+        MoveElementToResponse(std::move(result.components), *element));
+    if (request->max_bytes() > 0 && num_bytes >= request->max_bytes()) {
+      break;
+    }
+  }
+  VLOG(3) << "Producing " << response->elements_size()
+          << " elements for task " << first_request.task_id();
+  return absl::OkStatus();
+}
+
 absl::Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -658,6 +709,7 @@ WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
                                          transfer_servers_.end()};
   *request.mutable_worker_tags() = config_.worker_tags();
   request.set_worker_uid(worker_uid_);
+  *request.mutable_worker_topology() = config_.topology();
   *request.mutable_current_tasks() = {current_tasks.begin(),
                                       current_tasks.end()};
   for (const auto& snapshot_task_progress : GetSnapshotTaskProgress()) {
@@ -81,6 +81,8 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   absl::Status GetElement(const GetElementRequest* request,
                           GetElementResponse* response);
+  absl::Status GetElements(const GetElementsRequest* request,
+                           GetElementsResponse* response);
   absl::Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                               GetWorkerTasksResponse* response);
   absl::Status GetSnapshotTaskProgresses(
@@ -110,6 +110,19 @@ void PrintSummary(const MemoryDump& md) {
          static_cast<int64_t>(md.stats().peak_bytes_in_use()),
          static_cast<int64_t>(md.stats().largest_alloc_size()),
          md.stats().fragmentation_metric());
+  printf("pool_bytes: %" PRId64 ", largest_free_chunk: %" PRId64 "\n",
+         static_cast<int64_t>(md.stats().pool_bytes()),
+         static_cast<int64_t>(md.stats().largest_free_chunk()));
+  for (const auto& it : md.region_summary()) {
+    printf("   Region 0x%" PRIx64 " size=%10" PRId64 " \tin use=%10" PRId64
+           " \tchunks=%6" PRId64 " \tlargest_free=%10" PRId64
+           " \tfragmentation=%f\n",
+           static_cast<uint64_t>(it.address()), static_cast<int64_t>(it.size()),
+           static_cast<int64_t>(it.bytes_in_use()),
+           static_cast<int64_t>(it.num_chunks()),
+           static_cast<int64_t>(it.largest_free_chunk()),
+           it.fragmentation_metric());
+  }
 }
 
 void PrintSortedChunks(
@@ -64,6 +64,12 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
     WorkerCreationFunction;
 
+// Hooks for building a server on an alternative tensor transport (e.g. RDMA)
+// while keeping gRPC for control traffic. Such a transport registers its own
+// ServerFactory for a protocol like "grpc+verbs", registers its services (and
+// memory regions) through `service_func`, and supplies a RendezvousMgr whose
+// BaseRemoteRendezvous subclass moves tensors over the transport, so that
+// existing graphs use it without changes.
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
@@ -15,10 +15,53 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <cstddef>
+
+#include "grpcpp/support/slice.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
 
+namespace {
+
+// A TensorBuffer backed by (part of) a gRPC slice, which it keeps alive.
+class GrpcSliceBuffer : public TensorBuffer {
+ public:
+  GrpcSliceBuffer(const grpc_slice& slice, void* data, size_t size)
+      : TensorBuffer(data),
+        slice_(slice, ::grpc::Slice::ADD_REF),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+  // The slice may be shared with the sender in the same process, so it must
+  // not be modified in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::AliasBuffer(const void* data, size_t num_bytes) {
+  if (stream_ == nullptr) return nullptr;
+  const grpc_slice* slice = stream_->current_slice();
+  if (slice == nullptr) return nullptr;
+  const uint8_t* begin = GRPC_SLICE_START_PTR(*slice);
+  const uint8_t* end = begin + GRPC_SLICE_LENGTH(*slice);
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  if (p < begin || p + num_bytes > end) return nullptr;
+  return new GrpcSliceBuffer(*slice, const_cast<uint8_t*>(p), num_bytes);
+}
+
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
   ::tensorflow::GrpcByteSource byte_source(src);
@@ -37,12 +37,21 @@ using tsl::ToGrpcStatus;
 
 // Thin wrapper around ::grpc::ProtoBufferReader to give TensorResponse
 // an efficient byte reader from which to decode a RecvTensorResponse.
+//
+// Large tensor contents that are contiguous within one slice of the buffer
+// are adopted by the decoded tensor without copying, holding a reference on
+// the slice.
 class GrpcByteSource : public TensorResponse::Source {
  public:
   explicit GrpcByteSource(::grpc::ByteBuffer* buffer) : buffer_(buffer) {}
   ~GrpcByteSource() override { DeleteStream(); }
 
-  typedef ::grpc::ProtoBufferReader Reader;
+  // Exposes the slice that the data last returned by Next() points into.
+  class Reader : public ::grpc::ProtoBufferReader {
+   public:
+    using ::grpc::ProtoBufferReader::ProtoBufferReader;
+    const grpc_slice* current_slice() { return slice(); }
+  };
 
   protobuf::io::ZeroCopyInputStream* contents() override {
     DeleteStream();
@@ -50,6 +59,8 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  TensorBuffer* AliasBuffer(const void* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstdint>
+#include <utility>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -25,6 +28,11 @@ namespace tensorflow {
 
 TensorResponse::Source::~Source() {}
 
+TensorBuffer* TensorResponse::Source::AliasBuffer(const void* data,
+                                                  size_t num_bytes) {
+  return nullptr;
+}
+
 void TensorResponse::Clear() {
   on_host_ = false;
   device_ = nullptr;
@@ -143,8 +151,41 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::MaybeAliasTensorContent(
+    Source* source, protobuf::io::CodedInputStream* input,
+    const TensorProto& tensor_meta, int num_bytes) {
+  // Small tensors are cheap to copy, and aliasing them could keep much larger
+  // transport buffers alive. Host memory that is later copied to a GPU should
+  // come from the (pinned) allocator.
+  constexpr int kMinAliasBytes = 32 << 10;
+  if (num_bytes < kMinAliasBytes || alloc_attrs_.gpu_compatible()) {
+    return false;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  TensorShape shape(tensor_meta.tensor_shape());
+  if (shape.num_elements() * DataTypeSize(tensor_meta.dtype()) !=
+      static_cast<size_t>(num_bytes)) {
+    return false;
+  }
+  core::RefCountPtr<TensorBuffer> buf(source->AliasBuffer(data, num_bytes));
+  if (buf == nullptr) {
+    return false;
+  }
+  // Cannot fail, since the bytes are in the current buffer of `input`.
+  const bool skipped = input->Skip(num_bytes);
+  DCHECK(skipped);
+  tensor_ = Tensor(tensor_meta.dtype(), std::move(shape), std::move(buf));
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -194,13 +235,13 @@ bool TensorResponse::ParseTensorSubmessage(
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
+        if (MaybeAliasTensorContent(source, input, *tensor_meta, num_bytes)) {
+          break;
+        }
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         absl::string_view buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +274,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -63,6 +63,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer of `num_bytes` bytes at `data`, which points into the
+    // data last yielded by the stream returned by contents(), if the source
+    // can keep that memory alive for the lifetime of the buffer. Returns
+    // nullptr otherwise, which is what the default implementation does.
+    //
+    // The returned buffer does not own its memory, so tensors backed by it
+    // are never forwarded to outputs and modified in place.
+    virtual TensorBuffer* AliasBuffer(const void* data, size_t num_bytes);
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +100,16 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+
+  // Makes `tensor_` alias the next `num_bytes` of `input` instead of copying
+  // them, if `source` allows it. Returns false, leaving `input` untouched,
+  // otherwise.
+  bool MaybeAliasTensorContent(Source* source,
+                               protobuf::io::CodedInputStream* input,
+                               const TensorProto& tensor_meta, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -15,13 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -156,6 +160,75 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A source over caller-owned memory that lets large tensor contents alias it.
+class AliasingSource : public TensorResponse::Source {
+ public:
+  AliasingSource(const char* data, int size) : stream_(data, size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override { return &stream_; }
+
+  TensorBuffer* AliasBuffer(const void* data, size_t num_bytes) override {
+    ++num_aliased_;
+    return new UnownedBuffer(const_cast<void*>(data), num_bytes);
+  }
+
+  int num_aliased() const { return num_aliased_; }
+
+ private:
+  class UnownedBuffer : public TensorBuffer {
+   public:
+    UnownedBuffer(void* data, size_t size) : TensorBuffer(data), size_(size) {}
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    const size_t size_;
+  };
+
+  protobuf::io::ArrayInputStream stream_;
+  int num_aliased_ = 0;
+};
+
+TEST(TensorResponseAliasTest, AliasesLargeAlignedContent) {
+  for (int num_elems : {16, 64 << 10}) {
+    Tensor src(DT_FLOAT, TensorShape({num_elems}));
+    test::FillIota<float>(&src, 0.0f);
+    RecvTensorResponse proto;
+    src.AsProtoTensorContent(proto.mutable_tensor());
+    string encoded;
+    proto.AppendToString(&encoded);
+
+    // Place the encoding so that the tensor content is suitably aligned.
+    const size_t content_offset = encoded.find(src.tensor_data());
+    ASSERT_NE(content_offset, string::npos);
+    const size_t shift =
+        (EIGEN_MAX_ALIGN_BYTES - content_offset % EIGEN_MAX_ALIGN_BYTES) %
+        EIGEN_MAX_ALIGN_BYTES;
+    void* storage =
+        port::AlignedMalloc(encoded.size() + shift, EIGEN_MAX_ALIGN_BYTES);
+    char* data = static_cast<char*>(storage) + shift;
+    memcpy(data, encoded.data(), encoded.size());
+
+    {
+      AliasingSource source(data, encoded.size());
+      TensorResponse response;
+      DummyDevice cpu_device(Env::Default());
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      test::ExpectTensorEqual<float>(response.tensor(), src);
+
+      const bool expect_alias = src.TotalBytes() >= (32 << 10);
+      EXPECT_EQ(source.num_aliased(), expect_alias ? 1 : 0);
+      EXPECT_EQ(response.tensor().tensor_data().data() == data + content_offset,
+                expect_alias);
+    }
+    port::AlignedFree(storage);
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
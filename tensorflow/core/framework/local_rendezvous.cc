@@ -259,11 +259,14 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
         Item* item = nullptr;
         {
           mutex_lock l(bucket.mu);
-          auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-          ItemQueue* queue = &it->second;
+          // Use find() rather than insert(): if the Recv has already been
+          // satisfied, its queue may be gone and must not be recreated empty.
+          auto it = bucket.table.find(key_hash);
+          ItemQueue* queue = it == bucket.table.end() ? nullptr : &it->second;
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
-          if (queue->head != nullptr && queue->head->type == Item::kRecv) {
+          if (queue != nullptr && queue->head != nullptr &&
+              queue->head->type == Item::kRecv) {
             for (Item *prev = nullptr, *curr = queue->head; curr != nullptr;
                  prev = curr, curr = curr->next) {
               if (curr->recv_state.cancellation_token == token) {
@@ -161,6 +161,14 @@ auto* tf_data_get_next_duration_usecs_histogram =
         {tsl::monitoring::Buckets::Explicit(
             {2., 4., 8., 16., 32., 64., 128., 256., 512., 1024., 1e6})});
 
+auto* tf_data_service_snapshot_chunk_read_duration_usecs_histogram =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/data/service/snapshot_chunk_read_duration",
+         "Microseconds spent reading and decoding one tf.data distributed "
+         "snapshot chunk."},
+        // Power of 2 with bucket count 30 (> 8 minutes).
+        {tsl::monitoring::Buckets::Exponential(1, 2, 30)});
+
 auto* tf_data_used_vs_budget_ratio_histogram = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/data/used_vs_budget_ratio",
      "Ratio of tf.data used ram over ram budget when running optimization."},
@@ -213,6 +221,20 @@ auto* tf_data_service_client_iterators_counter =
         "Number of tf.data service client iterators created.", "worker_uid",
         "deployment_mode", "processing_mode", "is_coordinated_read");
 
+auto* tf_data_service_client_elements_read_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/client_elements_read",
+        "The number of elements tf.data service clients read from workers in "
+        "this locality tier.",
+        "locality_tier");
+
+auto* tf_data_service_client_bytes_read_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/client_bytes_read",
+        "The number of bytes tf.data service clients read from workers in this "
+        "locality tier.",
+        "locality_tier");
+
 auto* tf_data_service_cross_trainer_cache_queries_counter =
     tsl::monitoring::Counter<1>::New(
         "/tensorflow/data/service/cross_trainer_cache_queries",
@@ -305,6 +327,13 @@ auto* tf_data_pipeline_processing_time = tsl::monitoring::Gauge<double, 1>::New(
     "in microseconds",
     "id");
 
+auto* tf_data_pipeline_bottleneck_stage =
+    tsl::monitoring::Gauge<std::string, 1>::New(
+        "/tensorflow/data/pipeline_bottleneck_stage",
+        "The name of the root node of the slowest stage in the input pipeline, "
+        "i.e. the stage that bounds the pipeline processing time",
+        "id");
+
 auto* tf_data_auto_shard = tsl::monitoring::Gauge<int64, 2>::New(
     "/tensorflow/data/autoshard", "tf.data autoshard statistics.", "id",
     "name");
@@ -568,6 +597,11 @@ void RecordTFDataServiceGetElementDuration(const string& data_transfer_protocol,
       ->Add(duration_us);
 }
 
+void RecordTFDataServiceSnapshotChunkReadDuration(uint64 duration_us) {
+  tf_data_service_snapshot_chunk_read_duration_usecs_histogram->GetCell()->Add(
+      duration_us);
+}
+
 void RecordTFDataGetNextDuration(uint64 duration_us) {
   static auto* tf_data_get_next_duration_cell =
       tf_data_get_next_duration_usecs_histogram->GetCell();
@@ -664,6 +698,14 @@ void RecordTFDataServiceDataTransferProtocolError(
       ->IncrementBy(1);
 }
 
+void RecordTFDataServiceClientRead(const string& locality_tier,
+                                   int64_t bytes) {
+  tf_data_service_client_elements_read_counter->GetCell(locality_tier)
+      ->IncrementBy(1);
+  tf_data_service_client_bytes_read_counter->GetCell(locality_tier)
+      ->IncrementBy(bytes);
+}
+
 void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit) {
   std::string cache_hit_str = cache_hit ? "true" : "false";
   tf_data_service_cross_trainer_cache_queries_counter->GetCell(cache_hit_str)
@@ -930,6 +972,11 @@ void RecordPipelineProcessingTime(const string& id,
   GetTFDataPipelineProcessingTimeGauge(id)->Set(pipeline_processing_time_usec);
 }
 
+void RecordPipelineBottleneckStage(const string& id,
+                                   const string& bottleneck_stage) {
+  tf_data_pipeline_bottleneck_stage->GetCell(id)->Set(bottleneck_stage);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
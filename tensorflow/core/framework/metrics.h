@@ -98,6 +98,10 @@ void RecordTFDataExperimentOptOut(const string& experiment_name);
 void RecordTFDataServiceGetElementDuration(const string& data_transfer_protocol,
                                            uint64 duration_us);
 
+// Records the time (in microseconds) spent reading and decoding one chunk of a
+// tf.data distributed snapshot.
+void RecordTFDataServiceSnapshotChunkReadDuration(uint64 duration_us);
+
 // Records the time (in microseconds) spent in a single invocation of
 // `ItertatorResource::GetNext()`.
 void RecordTFDataGetNextDuration(uint64 duration_us);
@@ -176,6 +180,10 @@ void RecordTFDataServiceDataTransferProtocolError(
     const string& data_transfer_protocol, error::Code code,
     const string& error_message);
 
+// Records that a tf.data service client read an element of `bytes` bytes from
+// a worker in `locality_tier` ("host", "rack", "zone", or "remote").
+void RecordTFDataServiceClientRead(const string& locality_tier, int64_t bytes);
+
 // Records tf.data service cross-trainer cache queries.
 void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 
@@ -276,6 +284,12 @@ void RecordUnusedOutput(const string& op_name);
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec);
 
+// Records the name of the root node of the slowest stage of the input
+// pipeline, i.e. the stage whose time is reported by
+// `RecordPipelineProcessingTime`.
+void RecordPipelineBottleneckStage(const string& id,
+                                   const string& bottleneck_stage);
+
 // Increments the count of binaries loaded from the persistent cache.
 void UpdatePersistentCacheLoadCount();
 
@@ -22,7 +22,14 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <queue>
-
+#include <string>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -32,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tsl/platform/protobuf.h"
 
@@ -239,6 +247,82 @@ bool AreAllParametersMax(const Model::ModelParameters& parameters) {
   return true;
 }
 
+// Returns the total parallelism of the given parameters.
+int64_t TotalParallelism(const Model::ModelParameters& parameters) {
+  int64_t total = 0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      total += std::round(pair.second->value);
+    }
+  }
+  return total;
+}
+
+// Cumulative CPU times read from `/proc/stat`.
+struct CpuTimes {
+  uint64_t busy = 0;
+  uint64_t total = 0;
+};
+
+std::optional<CpuTimes> ReadCpuTimes() {
+  std::string contents;
+  if (!ReadFileToString(Env::Default(), "/proc/stat", &contents).ok()) {
+    return std::nullopt;
+  }
+  // The first line aggregates all CPUs: "cpu user nice system idle iowait
+  // irq softirq steal ...".
+  std::vector<absl::string_view> fields = absl::StrSplit(
+      absl::string_view(contents).substr(0, contents.find('\n')), ' ',
+      absl::SkipEmpty());
+  if (fields.size() < 5 || fields[0] != "cpu") {
+    return std::nullopt;
+  }
+  CpuTimes times;
+  for (int i = 1; i < fields.size(); ++i) {
+    uint64_t value;
+    if (!absl::SimpleAtoi(fields[i], &value)) {
+      return std::nullopt;
+    }
+    times.total += value;
+    // Fields 4 and 5 are the idle and iowait times.
+    if (i != 4 && i != 5) {
+      times.busy += value;
+    }
+  }
+  return times;
+}
+
+double ReadRunQueueLength() {
+  std::string contents;
+  double load;
+  if (!ReadFileToString(Env::Default(), "/proc/loadavg", &contents).ok() ||
+      !absl::SimpleAtod(contents.substr(0, contents.find(' ')), &load)) {
+    return -1.0;
+  }
+  return load;
+}
+
+int64_t ReadResidentBytes() {
+  std::string contents;
+  if (!ReadFileToString(Env::Default(), "/proc/self/status", &contents).ok()) {
+    return -1;
+  }
+  // The resident set size is reported as "VmRSS:    1234 kB".
+  constexpr absl::string_view kRssPrefix = "VmRSS:";
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    if (!absl::ConsumePrefix(&line, kRssPrefix)) {
+      continue;
+    }
+    int64_t kilobytes;
+    if (!absl::ConsumeSuffix(&line, "kB") ||
+        !absl::SimpleAtoi(absl::StripAsciiWhitespace(line), &kilobytes)) {
+      return -1;
+    }
+    return kilobytes * 1024;
+  }
+  return -1;
+}
+
 // Records the ram usage of hill climbing algorithm.
 void RecordAutotuneRamUsage(int64 ram_budget, double max_buffered_bytes) {
   if (ram_budget == 0) {
@@ -2173,6 +2257,22 @@ absl::Status Node::ToProto(ModelProto::Node* node_proto) const {
   return absl::OkStatus();
 }
 
+bool Node::SetTunableParameterValue(const string& name, double value) {
+  tf_shared_lock l(mu_);
+  auto it = parameters_.find(name);
+  if (it == parameters_.end() || it->second->state == nullptr ||
+      !it->second->state->tunable) {
+    return false;
+  }
+  Parameter* parameter = it->second.get();
+  value = std::clamp(std::round(value), parameter->min, parameter->max);
+  mutex_lock state_lock(*parameter->state->mu);
+  parameter->value = value;
+  parameter->state->value = value;
+  parameter->state->cond_var->notify_all();
+  return true;
+}
+
 absl::Status Node::FromProtoHelper(ModelProto::Node node_proto,
                                    std::shared_ptr<Node> node) {
   {
@@ -2257,6 +2357,55 @@ absl::Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+HostLoad SampleHostLoad() {
+  // CPU utilization is measured between consecutive samples.
+  static mutex* mu = new mutex();
+  static std::optional<CpuTimes>* last_cpu_times =
+      new std::optional<CpuTimes>();
+
+  HostLoad load;
+  load.num_cores = port::MaxParallelism();
+  load.run_queue_length = ReadRunQueueLength();
+  load.resident_bytes = ReadResidentBytes();
+  std::optional<CpuTimes> cpu_times = ReadCpuTimes();
+  if (cpu_times.has_value()) {
+    mutex_lock l(*mu);
+    if (last_cpu_times->has_value() &&
+        cpu_times->total > (*last_cpu_times)->total) {
+      load.cpu_utilization =
+          static_cast<double>(cpu_times->busy - (*last_cpu_times)->busy) /
+          (cpu_times->total - (*last_cpu_times)->total);
+    }
+    *last_cpu_times = cpu_times;
+  }
+  return load;
+}
+
+int64_t MaxThroughputOnFreeCores(const HostLoad& load, int64_t cpu_budget,
+                                 int64_t pipeline_parallelism) {
+  if (load.num_cores <= 0) {
+    return cpu_budget;
+  }
+  // Estimate how many cores are kept busy by work other than this pipeline.
+  // Both signals include the pipeline's own threads, which are subtracted.
+  double busy_cores = -1.0;
+  if (load.run_queue_length >= 0) {
+    busy_cores = load.run_queue_length;
+  }
+  if (load.cpu_utilization >= 0) {
+    busy_cores =
+        std::max(busy_cores, load.cpu_utilization * load.num_cores);
+  }
+  if (busy_cores < 0) {
+    return cpu_budget;
+  }
+  const double other_cores =
+      std::max(0.0, busy_cores - static_cast<double>(pipeline_parallelism));
+  const int64_t free_cores =
+      static_cast<int64_t>(std::floor(load.num_cores - other_cores));
+  return std::max<int64_t>(1, std::min(cpu_budget, free_cores));
+}
+
 Model::Model(std::optional<std::string> dataset_name)
     : dataset_name_(std::move(dataset_name)),
       optimization_period_ms_(kOptimizationPeriodMinMs),
@@ -2297,8 +2446,10 @@ Model::Model(std::optional<std::string> dataset_name)
 Model::~Model() {
   mutex_lock l(safe_to_collect_metrics_->mu);
   safe_to_collect_metrics_->val = false;
-  // Reset the pipeline processing time to 0
+  // Reset the pipeline processing time to 0 and clear the bottleneck stage, so
+  // that a destroyed pipeline no longer reports one.
   metrics::RecordPipelineProcessingTime(model_id_, 0);
+  metrics::RecordPipelineBottleneckStage(model_id_, "");
 }
 
 void Model::AddNode(Node::Factory factory, const string& name,
@@ -2405,6 +2556,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::HOST_AWARE:
+      OptimizeHostAware(snapshot, optimization_params, cancellation_manager,
+                        ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2422,6 +2577,7 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
 
     if (snapshot_) {
       double pipeline_processing_usec = 0;
+      std::string bottleneck_stage;
       ModelTiming model_timing(snapshot_);
       auto bfs_stage_roots = model_timing.GetStageRoots();
       for (const auto& root : bfs_stage_roots) {
@@ -2440,8 +2596,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
                                       root_timing->pipeline_ratio /
                                       EnvTime::kMicrosToNanos;
 
-        pipeline_processing_usec =
-            std::max(pipeline_processing_usec, root_total_time_usec);
+        if (root_total_time_usec > pipeline_processing_usec) {
+          pipeline_processing_usec = root_total_time_usec;
+          bottleneck_stage = root->long_name();
+        }
       }
       // Only updates the pipeline processing time when it is greater than 0.
       // If it is zero, we assume the pipeline processing time is the same
@@ -2449,6 +2607,7 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       if (pipeline_processing_usec > 0) {
         metrics::RecordPipelineProcessingTime(model_id_,
                                               pipeline_processing_usec);
+        metrics::RecordPipelineBottleneckStage(model_id_, bottleneck_stage);
       }
     }
   }
@@ -2597,6 +2756,49 @@ absl::Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
     FlushMetrics();
+    MaybeSaveTunedParameters();
+  }
+}
+
+void Model::MaybeSaveTunedParameters() {
+  if (tuned_parameters_file_.empty()) {
+    return;
+  }
+  {
+    // Only save once the optimization has settled, so that early estimates
+    // based on few elements do not overwrite a previously saved state.
+    tf_shared_lock l(mu_);
+    if (optimization_period_ms_ < kOptimizationPeriodMaxMs) {
+      return;
+    }
+  }
+  absl::Status s = SaveTunedParameters(tuned_parameters_file_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to save tuned parameters to "
+                 << tuned_parameters_file_ << ": " << s;
+  }
+}
+
+void Model::InitializeParameterValues(ModelParameters& parameters,
+                                      bool skip_buffer_sizes) {
+  // The restored values only seed the first optimization: later ones start
+  // from the minimum again so that they can go below the restored values,
+  // e.g. when those exceed the RAM budget.
+  absl::flat_hash_map<std::pair<string, string>, double> warm_start_values;
+  {
+    mutex_lock l(mu_);
+    warm_start_values.swap(warm_start_values_);
+  }
+  for (auto& pair : parameters) {
+    Parameter& parameter = *pair.second;
+    if (skip_buffer_sizes && parameter.name == kBufferSize) {
+      continue;
+    }
+    auto it = warm_start_values.find({pair.first, parameter.name});
+    parameter.value =
+        it == warm_start_values.end()
+            ? parameter.min
+            : std::min(std::max(it->second, parameter.min), parameter.max);
   }
 }
 
@@ -2620,10 +2822,9 @@ void Model::OptimizeGradientDescent(
   CollectParameters(snapshot, parameters, &parallelism_parameters,
                     &buffer_size_parameters);
 
-  // Initialize the parameter values to minimal before tuning.
-  for (auto& pair : parameters) {
-    pair.second->value = pair.second->min;
-  }
+  // Initialize the parameter values to minimal, or to the restored values,
+  // before tuning.
+  InitializeParameterValues(parameters, /*skip_buffer_sizes=*/false);
 
   // Optimization is stopped once the `OutputTime` improvement is smaller than
   // this value.
@@ -2696,13 +2897,9 @@ void Model::OptimizeHillClimbHelper(
            "every "
            "10 minutes).";
   }
-  // Initialize the parameter values to minimal before tuning.
-  for (auto& pair : parameters) {
-    if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
-      continue;
-    }
-    pair.second->value = pair.second->min;
-  }
+  // Initialize the parameter values to minimal, or to the restored values,
+  // before tuning.
+  InitializeParameterValues(parameters, skip_buffer_sizes);
   Parameter* best_parameter = nullptr;
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
@@ -3157,6 +3354,46 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeHostAware(std::shared_ptr<Node> snapshot,
+                              const OptimizationParams& optimization_params,
+                              CancellationManager* cancellation_manager,
+                              RamBudgetManager& ram_budget_manager) {
+  const int64_t max_parallelism = host_aware_objective_(
+      host_load_sampler_(), optimization_params.cpu_budget(),
+      TotalParallelism(CollectTunableParameters(snapshot)));
+  VLOG(2) << "Host-aware autotuning caps the total parallelism at "
+          << max_parallelism;
+  auto should_stop = [&optimization_params, max_parallelism](
+                         const ModelParameters& parameters,
+                         double processing_time, double output_time,
+                         double buffered_bytes) {
+    const bool all_max = AreAllParametersMax(parameters);
+    const bool output_time_budget_exceeded =
+        output_time < processing_time / optimization_params.cpu_budget();
+    const bool parallelism_budget_reached =
+        TotalParallelism(parameters) >= max_parallelism;
+    const bool ram_budget_exceeded =
+        buffered_bytes > optimization_params.ram_budget();
+    if (all_max) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
+    }
+    if (output_time_budget_exceeded) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("output_time");
+    }
+    if (parallelism_budget_reached) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("host_parallelism");
+    }
+    if (ram_budget_exceeded) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+    }
+    return all_max || output_time_budget_exceeded ||
+           parallelism_budget_reached || ram_budget_exceeded;
+  };
+  OptimizeHillClimbHelper(snapshot, optimization_params, cancellation_manager,
+                          optimization_params.ram_budget(), ram_budget_manager,
+                          should_stop);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
@@ -3226,6 +3463,81 @@ absl::Status Model::Save(const string& fname, std::shared_ptr<Node> snapshot,
   return WriteBinaryProto(Env::Default(), fname, model_proto);
 }
 
+absl::Status Model::SaveTunedParameters(const string& fname) {
+  std::shared_ptr<Node> output = this->output();
+  TunedParametersProto tuned_parameters;
+  if (output != nullptr) {
+    Node::NodeVector nodes =
+        output->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+    nodes.insert(nodes.begin(), output);
+    absl::flat_hash_map<string, int64_t> occurrences;
+    for (const auto& node : nodes) {
+      ModelProto::Node node_proto;
+      TF_RETURN_IF_ERROR(node->ToProto(&node_proto));
+      const int64_t occurrence = occurrences[node_proto.name()]++;
+      for (const auto& parameter_proto : node_proto.parameters()) {
+        if (!parameter_proto.tunable()) {
+          continue;
+        }
+        TunedParametersProto::Parameter* parameter =
+            tuned_parameters.add_parameters();
+        parameter->set_node_name(node_proto.name());
+        parameter->set_node_occurrence(occurrence);
+        parameter->set_name(parameter_proto.name());
+        parameter->set_value(parameter_proto.state_value());
+      }
+    }
+  }
+  // Write to a temporary file first so that a crash never leaves a truncated
+  // file behind. The temporary file name is unique so that pipelines sharing
+  // the same file do not write to each other's temporary files.
+  string tmp_fname = strings::StrCat(fname, "__");
+  if (!Env::Default()->CreateUniqueFileName(&tmp_fname, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            fname);
+  }
+  TF_RETURN_IF_ERROR(
+      WriteBinaryProto(Env::Default(), tmp_fname, tuned_parameters));
+  return Env::Default()->RenameFile(tmp_fname, fname);
+}
+
+absl::Status Model::LoadTunedParameters(const string& fname) {
+  TunedParametersProto tuned_parameters;
+  TF_RETURN_IF_ERROR(
+      ReadBinaryProto(Env::Default(), fname, &tuned_parameters));
+  std::shared_ptr<Node> output = this->output();
+  if (output == nullptr) {
+    return absl::OkStatus();
+  }
+  Node::NodeVector nodes = output->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.insert(nodes.begin(), output);
+  absl::flat_hash_map<std::pair<string, int64_t>, Node*> nodes_by_name;
+  absl::flat_hash_map<string, int64_t> occurrences;
+  for (const auto& node : nodes) {
+    const int64_t occurrence = occurrences[node->name()]++;
+    nodes_by_name[{node->name(), occurrence}] = node.get();
+  }
+  absl::flat_hash_map<std::pair<string, string>, double> warm_start_values;
+  for (const auto& parameter : tuned_parameters.parameters()) {
+    Node* node = gtl::FindPtrOrNull(
+        nodes_by_name, {parameter.node_name(), parameter.node_occurrence()});
+    if (node != nullptr &&
+        node->SetTunableParameterValue(parameter.name(), parameter.value())) {
+      warm_start_values[{node->long_name(), parameter.name()}] =
+          node->parameter_value(parameter.name());
+    }
+  }
+  const int64_t num_restored = warm_start_values.size();
+  {
+    mutex_lock l(mu_);
+    warm_start_values_ = std::move(warm_start_values);
+  }
+  VLOG(2) << "Restored " << num_restored << " of "
+          << tuned_parameters.parameters_size()
+          << " tuned parameters from " << fname;
+  return absl::OkStatus();
+}
+
 absl::Status Model::Load(const string& fname, std::unique_ptr<Model>* model,
                          OptimizationParams* optimization_params) {
   ModelProto model_proto;
@@ -431,6 +431,12 @@ class Node {
     return parameters_.at(name)->state->value;
   }
 
+  // Sets the value of the tunable parameter `name` to `value`, clamped to the
+  // range of the parameter, and notifies the iterator using the parameter.
+  // Returns false if the node has no tunable parameter with the given name.
+  bool SetTunableParameterValue(const string& name, double value)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the aggregate processing time.
   int64_t processing_time() const TF_LOCKS_EXCLUDED(mu_) {
     return processing_time_;
@@ -915,6 +921,33 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Host-level load signals consulted by the `HOST_AWARE` autotuning algorithm.
+// Signals that are not available on the platform are negative.
+struct HostLoad {
+  // Number of CPU cores available to the process.
+  int64_t num_cores = 0;
+  // Number of runnable threads on the host, averaged over the last minute.
+  double run_queue_length = -1.0;
+  // Fraction of time the host CPUs were busy since the previous sample.
+  double cpu_utilization = -1.0;
+  // Resident set size of the process in bytes.
+  int64_t resident_bytes = -1;
+};
+
+// Returns the current load of the host.
+HostLoad SampleHostLoad();
+
+// Objective of the `HOST_AWARE` autotuning algorithm. Given the host load, the
+// CPU budget of the pipeline and the total parallelism currently used by the
+// pipeline, returns the maximum total parallelism the optimization may use.
+using HostAwareObjective = std::function<int64_t(
+    const HostLoad& load, int64_t cpu_budget, int64_t pipeline_parallelism)>;
+
+// The default `HostAwareObjective`: maximizes throughput using at most the CPU
+// budget, without claiming cores that other work on the host keeps busy.
+int64_t MaxThroughputOnFreeCores(const HostLoad& load, int64_t cpu_budget,
+                                 int64_t pipeline_parallelism);
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -951,6 +984,15 @@ class Model {
     experiments_.insert(experiment);
   }
 
+  // Overrides how the `HOST_AWARE` algorithm samples the host load and which
+  // objective it optimizes for. Must be called before the optimization starts.
+  void SetHostLoadSampler(std::function<HostLoad()> sampler) {
+    host_load_sampler_ = std::move(sampler);
+  }
+  void SetHostAwareObjective(HostAwareObjective objective) {
+    host_aware_objective_ = std::move(objective);
+  }
+
   // Adds a node with the given name and given parent.
   void AddNode(Node::Factory factory, const string& name,
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
@@ -1012,6 +1054,24 @@ class Model {
   static absl::Status FromProto(ModelProto model_proto,
                                 std::unique_ptr<Model>* model);
 
+  // Saves the current values of the tunable parameters of this model to a
+  // file. Note that the file directory must already exist.
+  absl::Status SaveTunedParameters(const string& fname);
+
+  // Sets the tunable parameters of this model to the values saved in a file by
+  // `SaveTunedParameters`. Saved values are matched by node name and parameter
+  // name; values whose node does not exist in the model are ignored so that the
+  // model stays valid if the input pipeline changed. The restored values are
+  // also used as the starting point of the next optimization.
+  absl::Status LoadTunedParameters(const string& fname)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the file that `OptimizeLoop` periodically saves the tuned parameters
+  // to, once the optimization period has reached its maximum.
+  void SetTunedParametersFile(const string& fname) {
+    tuned_parameters_file_ = fname;
+  }
+
   // Saves this model with a given snapshot and its optimization parameters to a
   // file. Note that the file directory must already exist.
   absl::Status Save(const string& fname, std::shared_ptr<Node> snapshot,
@@ -1055,6 +1115,17 @@ class Model {
   // a vector which contains pairs of node names and tunable parameters.
   ModelParameters CollectTunableParameters(std::shared_ptr<Node> node);
 
+  // Saves the tuned parameters to `tuned_parameters_file_` if it is set and
+  // the optimization period has reached its maximum.
+  void MaybeSaveTunedParameters();
+
+  // Sets the parameters to the values the optimization algorithms start tuning
+  // from: in the first optimization after `LoadTunedParameters`, the restored
+  // value if there is one, and the parameter minimum otherwise. Buffer size
+  // parameters are left unchanged if `skip_buffer_sizes` is true.
+  void InitializeParameterValues(ModelParameters& parameters,
+                                 bool skip_buffer_sizes) TF_LOCKS_EXCLUDED(mu_);
+
   // Copy parameter state values to parameter values if necessary.For some
   // nodes, the parameter state values are not tuned by Autotune and hence the
   // parameter values can be stale. We do not sync all parameters because it may
@@ -1120,6 +1191,15 @@ class Model {
                               CancellationManager* cancellation_manager,
                               RamBudgetManager& ram_budget_manager);
 
+  // This optimization behaves similarly to the hill climb optimization, but
+  // caps the total parallelism of the pipeline at the value returned by the
+  // host-aware objective for the current host load. This keeps the pipeline
+  // from adding threads once the host is saturated, e.g. by other jobs.
+  void OptimizeHostAware(std::shared_ptr<Node> snapshot,
+                         const OptimizationParams& optimization_params,
+                         CancellationManager* cancellation_manager,
+                         RamBudgetManager& ram_budget_manager);
+
   // This optimization starts by setting all tunable parallelism parameters to
   // their minimum values. It then repeatedly increases the parallelism
   // parameter of the longest stage by 1 until either the longest stage is
@@ -1212,6 +1292,15 @@ class Model {
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   absl::flat_hash_set<std::string> experiments_;
+  // If not empty, the file the tuned parameters are saved to.
+  std::string tuned_parameters_file_;
+  // Parameter values restored by `LoadTunedParameters`, keyed by node long name
+  // and parameter name. Cleared once they have seeded an optimization.
+  absl::flat_hash_map<std::pair<std::string, std::string>, double>
+      warm_start_values_ TF_GUARDED_BY(mu_);
+  // Host load sampler and objective used by the `HOST_AWARE` algorithm.
+  std::function<HostLoad()> host_load_sampler_ = SampleHostLoad;
+  HostAwareObjective host_aware_objective_ = MaxThroughputOnFreeCores;
   // Stores the optimization snapshot of the Model.
   std::shared_ptr<Node> snapshot_ TF_GUARDED_BY(mu_);
   // Stores the optimization parameters used by autotune.
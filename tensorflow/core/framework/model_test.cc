@@ -28,6 +28,7 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -1457,6 +1458,18 @@ TEST(ModelTest, ModelCollectOptimizationMetrics) {
             HasSubstr("gap_times: 11"), HasSubstr("gap_times: 12")));
 }
 
+TEST(ModelTest, BottleneckStageIsClearedOnDestruction) {
+  CellReader<std::string> cell_reader(
+      "/tensorflow/data/pipeline_bottleneck_stage");
+  auto model = std::make_unique<model::Model>();
+  std::string model_id =
+      strings::StrCat(reinterpret_cast<uintptr_t>(model.get()));
+  metrics::RecordPipelineBottleneckStage(model_id, "ParallelMapV2(id:1)");
+  EXPECT_EQ(cell_reader.Read(model_id), "ParallelMapV2(id:1)");
+  model.reset();
+  EXPECT_EQ(cell_reader.Read(model_id), "");
+}
+
 TEST(ModelTest, ModelCollectAndDestroyRaceCondition) {
   CellReader<std::string> cell_reader("/tensorflow/data/model");
   auto* model = new model::Model();
@@ -2644,6 +2657,245 @@ TEST_F(ModelTimingTest, OptimizeStageBased_OneStage) {
   EXPECT_EQ(5, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
 }
 
+TEST_F(ModelTimingTest, SaveAndLoadTunedParameters) {
+  constexpr char kModel[] = R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: %d
+          state_value: %d
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Prefetch"
+        autotune: true
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        parameters: {
+          name: "buffer_size"
+          value: %d
+          state_value: %d
+          min: 1
+          max: 32
+          tunable: true
+        }
+      }
+    }
+    output: 1
+  )pb";
+  BuildModelFromProto(strings::Printf(kModel, 7, 7, 12, 12));
+  std::string fname;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&fname));
+  TF_ASSERT_OK(model_->SaveTunedParameters(fname));
+
+  BuildModelFromProto(strings::Printf(kModel, 1, 1, 1, 1));
+  TF_ASSERT_OK(model_->LoadTunedParameters(fname));
+  EXPECT_EQ(7, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+  EXPECT_EQ(12, GetNode(/*node_id=*/2)->parameter_value("buffer_size"));
+
+  // Saved values for a different input pipeline are ignored.
+  std::string mismatched = strings::Printf(kModel, 1, 1, 1, 1);
+  mismatched.replace(mismatched.find("Prefetch"), 8, "Shuffle");
+  BuildModelFromProto(mismatched);
+  TF_ASSERT_OK(model_->LoadTunedParameters(fname));
+  EXPECT_EQ(7, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+  EXPECT_EQ(1, GetNode(/*node_id=*/2)->parameter_value("buffer_size"));
+
+  EXPECT_TRUE(absl::IsNotFound(
+      model_->LoadTunedParameters(strings::StrCat(fname, ".missing"))));
+}
+
+TEST_F(ModelTimingTest, LoadedTunedParametersSeedOnlyTheFirstOptimize) {
+  constexpr char kModel[] = R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 97
+        buffered_elements: 3
+        processing_time: 5000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: %d
+          state_value: %d
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 3000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb";
+  BuildModelFromProto(strings::Printf(kModel, 12, 12));
+  std::string fname;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&fname));
+  TF_ASSERT_OK(model_->SaveTunedParameters(fname));
+
+  BuildModelFromProto(strings::Printf(kModel, 1, 1));
+  TF_ASSERT_OK(model_->LoadTunedParameters(fname));
+  ASSERT_EQ(12, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+
+  // Hill climbing starts from the restored value instead of the minimum, so
+  // it can only keep or raise it.
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(/*budget=*/1LL << 30);
+  model_->Optimize(AutotuneAlgorithm::HILL_CLIMB, CpuBudgetFunc(4),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1LL << 30,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+  EXPECT_GE(GetNode(/*node_id=*/1)->parameter_value("parallelism"), 12);
+
+  // Later optimizations start from the minimum again, so they can go below the
+  // restored value, e.g. to fit into a RAM budget that the restored value
+  // exceeds.
+  model_->Optimize(AutotuneAlgorithm::HILL_CLIMB, CpuBudgetFunc(4),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/300,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+  EXPECT_LT(GetNode(/*node_id=*/1)->parameter_value("parallelism"), 12);
+}
+
+TEST_F(ModelTimingTest, OptimizeHostAware_CappedByHostLoad) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 97
+        buffered_elements: 3
+        processing_time: 5000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 3000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+  // 10 runnable threads on 8 cores, 4 of which belong to the pipeline, leave
+  // 2 cores for the pipeline.
+  model_->SetHostLoadSampler([]() {
+    HostLoad load;
+    load.num_cores = 8;
+    load.run_queue_length = 10;
+    return load;
+  });
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model_->Optimize(AutotuneAlgorithm::HOST_AWARE, CpuBudgetFunc(20),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+
+  EXPECT_EQ(2, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+}
+
+TEST(HostAwareObjectiveTest, MaxThroughputOnFreeCores) {
+  HostLoad load;
+  load.num_cores = 16;
+  // Without any host signals the CPU budget applies.
+  EXPECT_EQ(MaxThroughputOnFreeCores(load, /*cpu_budget=*/8,
+                                     /*pipeline_parallelism=*/4),
+            8);
+  // The pipeline's own threads do not count towards the host load.
+  load.run_queue_length = 12;
+  EXPECT_EQ(MaxThroughputOnFreeCores(load, /*cpu_budget=*/16,
+                                     /*pipeline_parallelism=*/4),
+            8);
+  // The busier of the two signals is used.
+  load.cpu_utilization = 1.0;
+  EXPECT_EQ(MaxThroughputOnFreeCores(load, /*cpu_budget=*/16,
+                                     /*pipeline_parallelism=*/4),
+            4);
+  // At least one core is always allowed.
+  load.run_queue_length = 100;
+  EXPECT_EQ(MaxThroughputOnFreeCores(load, /*cpu_budget=*/16,
+                                     /*pipeline_parallelism=*/4),
+            1);
+}
+
 TEST_F(ModelTimingTest, OptimizeStageBased_CappedByParameterMax) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -624,6 +624,11 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, allocations with default attributes are served by this
+    // allocator instead of the device's. The executor sets it for kernels whose
+    // outputs cannot outlive the step; see `Executor::Args::step_allocator`.
+    Allocator* step_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
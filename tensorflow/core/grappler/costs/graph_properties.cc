@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include <functional>
+#include <queue>
+#include <vector>
+
 #include "absl/hash/hash.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -524,34 +528,36 @@ bool IsShapeFullyDefinedIntegerVectorOrScalar(
 // topological ordering isn't required for correctness but helps speed things up
 // since it avoids processing the same node multiple times as its inputs
 // information is refined.
+//
+// Nodes are tracked by their dense position in the topological order, so that
+// pushing and popping don't allocate, which matters on very large graphs where
+// most nodes go through the queue at least once.
 class TopoQueue {
  public:
   explicit TopoQueue(const std::vector<const NodeDef*>& topo_order)
-      : topo_order_(TopoOrder(topo_order)) {}
+      : topo_order_(topo_order),
+        topo_ids_(TopoOrder(topo_order)),
+        queued_(topo_order.size(), false) {}
 
-  void push(const NodeDef* n) { queue_.emplace(n, topo_order_.at(n)); }
+  void push(const NodeDef* n) {
+    const int id = topo_ids_.at(n);
+    if (queued_[id]) return;
+    queued_[id] = true;
+    queue_.push(id);
+  }
 
   const NodeDef* pop() {
     CHECK(!empty());
-    auto it = queue_.begin();
-    const NodeDef* n = it->first;
-    queue_.erase(it);
-    return n;
+    const int id = queue_.top();
+    queue_.pop();
+    queued_[id] = false;
+    return topo_order_[id];
   }
 
   bool empty() const { return queue_.empty(); }
   std::size_t size() const { return queue_.size(); }
 
  private:
-  using NodeAndId = std::pair<const NodeDef*, int>;
-  // Graph nodes are created in (roughly) topological order. Therefore we can
-  // use their id to ensure they're sorted topologically.
-  struct OrderByIdAscending {
-    bool operator()(const NodeAndId& lhs, const NodeAndId& rhs) const {
-      return lhs.second < rhs.second;
-    }
-  };
-
   const absl::flat_hash_map<const NodeDef*, int> TopoOrder(
       const std::vector<const NodeDef*>& topo_order) const {
     absl::flat_hash_map<const NodeDef*, int> map;
@@ -563,8 +569,12 @@ class TopoQueue {
     return map;
   }
 
-  const absl::flat_hash_map<const NodeDef*, int> topo_order_;
-  std::set<NodeAndId, OrderByIdAscending> queue_;
+  const std::vector<const NodeDef*> topo_order_;
+  const absl::flat_hash_map<const NodeDef*, int> topo_ids_;
+  // Whether the node at a given topological position is in `queue_`, so each
+  // node is queued at most once.
+  std::vector<bool> queued_;
+  std::priority_queue<int, std::vector<int>, std::greater<int>> queue_;
 };
 
 
@@ -816,6 +826,11 @@ class SymbolicShapeRefiner {
     GrapplerFunctionItem grappler_function_item = *maybe_grappler_function_item;
     MutableGraphView gv(&grappler_function_item.graph);
 
+    // Dimensions of the call inputs, used below to map the symbolic dimensions
+    // of the function outputs back to the caller's dimensions.
+    std::vector<std::vector<DimensionHandle>> input_dims(
+        grappler_function_item.inputs().size());
+
     // Forward shapes from function input nodes to argument nodes.
     for (int i = 0, end = grappler_function_item.inputs().size(); i < end;
          ++i) {
@@ -844,6 +859,11 @@ class SymbolicShapeRefiner {
       TensorShapeProto proto;
       const auto handle = input_ic->output(output_port_num);
       input_ic->ShapeHandleToProto(handle, &proto);
+      if (InferenceContext::RankKnown(handle)) {
+        for (int d = 0; d < InferenceContext::Rank(handle); ++d) {
+          input_dims[i].push_back(InferenceContext::DimKnownRank(handle, d));
+        }
+      }
       // There may be dim.size < -1 in SymbolicShapeRefiner. Change those to -1.
       NormalizeShapeForOutput(&proto);
       // _Arg op's output shape uses _output_shapes attr.
@@ -943,6 +963,31 @@ class SymbolicShapeRefiner {
         /*aggressive_shape_inference=*/aggressive_shape_inference_,
         /*include_tensor_values=*/true));
 
+    // The function body is inferred in isolation, so an unknown dimension that
+    // flows from an argument to an output comes back as a fresh symbolic
+    // dimension. Map the body's symbolic ids of the argument dimensions to the
+    // caller's dimension handles, so that e.g. f(x) = Relu(x) keeps the
+    // identity of x's unknown dimensions across the call. Symbolic ids that
+    // only appear in the outputs share one new dimension per id.
+    absl::flat_hash_map<int64_t, DimensionHandle> symbolic_dims;
+    for (int i = 0, end = grappler_function_item.inputs().size(); i < end;
+         ++i) {
+      const string& arg_name = grappler_function_item.input(i).node_name;
+      if (!gp.HasOutputProperties(arg_name)) continue;
+      const auto& arg_props = gp.GetOutputProperties(arg_name);
+      if (arg_props.empty()) continue;
+      const TensorShapeProto& arg_shape = arg_props[0].shape();
+      if (arg_shape.unknown_rank() ||
+          arg_shape.dim_size() != static_cast<int>(input_dims[i].size())) {
+        continue;
+      }
+      for (int d = 0; d < arg_shape.dim_size(); ++d) {
+        if (arg_shape.dim(d).size() < -1) {
+          symbolic_dims.emplace(arg_shape.dim(d).size(), input_dims[i][d]);
+        }
+      }
+    }
+
     // Add return nodes for output shapes.
     int output = 0;
     ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
@@ -968,10 +1013,26 @@ class SymbolicShapeRefiner {
             " (output_properties.size() = ", output_properties.size(), ").");
       }
       auto& outprop = output_properties[out_tensor.index()];
-      TensorShapeProto shape = outprop.shape();
-      NormalizeShapeForOutput(&shape);
+      const TensorShapeProto& shape = outprop.shape();
       ShapeHandle out;
-      TF_RETURN_IF_ERROR(ic->MakeShapeFromShapeProto(shape, &out));
+      if (shape.unknown_rank()) {
+        out = ic->UnknownShape();
+      } else {
+        std::vector<DimensionHandle> dims;
+        dims.reserve(shape.dim_size());
+        for (const auto& dim : shape.dim()) {
+          if (dim.size() >= 0) {
+            dims.push_back(ic->MakeDim(dim.size()));
+          } else if (dim.size() == -1) {
+            dims.push_back(ic->UnknownDim());
+          } else {
+            auto [it, inserted] = symbolic_dims.try_emplace(dim.size());
+            if (inserted) it->second = ic->UnknownDim();
+            dims.push_back(it->second);
+          }
+        }
+        out = ic->MakeShape(dims);
+      }
       ic->set_output(output, out);
       if (outprop.has_value()) {
         // Forward tensor value to output_tensors_as_shape.
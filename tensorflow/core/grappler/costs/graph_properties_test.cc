@@ -1701,6 +1701,41 @@ TEST_F(GraphPropertiesTest, FunctionWithScalarInput) {
   EXPECT_FALSE(out_prop0.shape().unknown_rank());
 }
 
+TEST_F(GraphPropertiesTest, FunctionPreservesSymbolicDims) {
+  FunctionDefLibrary library;
+  *library.add_function() = FunctionDefHelper::Create(
+      "MyRelu",                                               // Name
+      {"x: float"},                                           // Inputs
+      {"out: float"},                                         // Outputs
+      {},                                                     // Attrs
+      {{{"a"}, "Relu", {"x"}, {{"T", DataType::DT_FLOAT}}}},  // Nodes
+      {{"out", "a:activations:0"}});                          // Returns
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  TF_ASSERT_OK(s.graph()->AddFunctionLibrary(library));
+  Output x = ops::Placeholder(s.WithOpName("x"), DataType::DT_FLOAT,
+                              ops::Placeholder::Shape({-1, -1}));
+  auto _x = tensorflow::ops::AsNodeOut(s, x);
+  tensorflow::Node* func_op;
+  TF_ASSERT_OK(
+      tensorflow::NodeBuilder("MyRelu", "MyRelu", s.graph()->op_registry())
+          .Input(_x)
+          .Finalize(s.graph(), &func_op));
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  const auto& in_shape = properties.GetOutputProperties("x")[0].shape();
+  const auto& out_shape = properties.GetOutputProperties("MyRelu")[0].shape();
+  ASSERT_EQ(in_shape.dim_size(), 2);
+  ASSERT_EQ(out_shape.dim_size(), 2);
+  // The unknown dimensions of the call output are the ones of its input.
+  EXPECT_LT(out_shape.dim(0).size(), -1);
+  EXPECT_EQ(out_shape.dim(0).size(), in_shape.dim(0).size());
+  EXPECT_EQ(out_shape.dim(1).size(), in_shape.dim(1).size());
+  EXPECT_NE(out_shape.dim(0).size(), out_shape.dim(1).size());
+}
+
 TEST_F(GraphPropertiesTest, SimpleFunctionStaticShapeInference) {
   // Test graph produced in python using:
   /*
@@ -3750,6 +3750,176 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
   std::unordered_set<string> fused_nodes_;
 };
 
+// Replace a tree of element-wise unary and binary ops with a single
+// '_FusedElementwise' node, which evaluates all of them in one pass over the
+// output instead of materializing every intermediate tensor.
+//
+// Every fused node must have the shape of the root and a single consumer, so
+// the cluster is a tree. Leaves may be broadcast if their shape (without
+// leading 1s) is a suffix of the root shape. Chains of unary ops only are left
+// to the UnaryOpsComposition stage, which supports more ops and types.
+class FuseElementwiseClusters : public ArithmeticOptimizerStage {
+ public:
+  explicit FuseElementwiseClusters(const GraphOptimizerContext& ctx,
+                                   const ArithmeticOptimizerContext& ctx_ext)
+      : ArithmeticOptimizerStage("FuseElementwiseClusters", ctx, ctx_ext) {}
+  ~FuseElementwiseClusters() override = default;
+
+  bool IsSupported(const NodeDef* node) const override {
+    return CanFuse(*node, GetDataTypeFromAttr(*node, "T")) &&
+           !ctx().node_map->NodeExists(OptimizedNodeName(*node));
+  }
+
+  absl::Status TrySimplify(NodeDef* root,
+                           string* simplified_node_name) override {
+    const OpInfo::TensorProperties* root_props;
+    TF_RETURN_IF_ERROR(GetTensorProperties(root->name(), &root_props));
+    if (root_props->shape().unknown_rank()) return absl::OkStatus();
+
+    ElementwiseCluster cluster;
+    cluster.dtype = root->attr().at("T").type();
+    cluster.shape = &root_props->shape();
+    if (!AddToCluster(*root, &cluster)) return absl::OkStatus();
+    if (cluster.ops.size() < 2 || cluster.num_binary_ops == 0) {
+      return absl::OkStatus();
+    }
+
+    // Operands refer to leaves by their index and to the result of ops[i] by
+    // num_leaves + i, as expected by the kernel.
+    const int num_leaves = cluster.leaves.size();
+    std::vector<int> operands;
+    operands.reserve(cluster.operands.size());
+    for (int operand : cluster.operands) {
+      operands.push_back(operand < 0 ? -operand - 1 : num_leaves + operand);
+    }
+
+    VLOG(2) << "Fuse element-wise ops: root=" << root->name() << " ops=["
+            << absl::StrJoin(cluster.ops, ", ") << "]";
+
+    NodeDef* fused_node = ctx().optimized_graph->add_node();
+    fused_node->set_name(OptimizedNodeName(*root));
+    fused_node->set_op("_FusedElementwise");
+    fused_node->set_device(root->device());
+    for (const string& leaf : cluster.leaves) fused_node->add_input(leaf);
+
+    auto attr = fused_node->mutable_attr();
+    SetAttrValue(cluster.dtype, &(*attr)["T"]);
+    SetAttrValue(num_leaves, &(*attr)["N"]);
+    SetAttrValue(cluster.ops, &(*attr)["ops"]);
+    SetAttrValue(operands, &(*attr)["operands"]);
+
+    ctx().node_map->AddNode(fused_node->name(), fused_node);
+    for (const string& leaf : cluster.leaves) {
+      ctx().node_map->AddOutput(NodeName(leaf), fused_node->name());
+    }
+    for (const string& name : cluster.nodes) fused_nodes_.insert(name);
+
+    *simplified_node_name = fused_node->name();
+    return absl::OkStatus();
+  }
+
+ private:
+  struct ElementwiseCluster {
+    DataType dtype;
+    const TensorShapeProto* shape;
+    // Ops in evaluation order, and their operands: a non-negative operand is
+    // the index of an op, and a negative operand -i-1 is leaf i.
+    std::vector<string> ops;
+    std::vector<int> operands;
+    int num_binary_ops = 0;
+    std::vector<string> nodes;
+    std::vector<string> leaves;
+    absl::flat_hash_map<string, int> leaf_index;
+  };
+
+  // Adds `node` and the fusible part of the tree below it to `cluster`.
+  // Returns false if one of the remaining inputs can't be a leaf.
+  bool AddToCluster(const NodeDef& node, ElementwiseCluster* cluster) const {
+    const int num_inputs = NumNonControlInputs(node);
+    std::vector<int> operands;
+    for (int i = 0; i < num_inputs; ++i) {
+      const string& input = node.input(i);
+      const NodeDef* input_node = ctx().node_map->GetNode(input);
+      if (input_node != nullptr && IsFusibleInput(*input_node, *cluster)) {
+        if (!AddToCluster(*input_node, cluster)) return false;
+        operands.push_back(cluster->ops.size() - 1);
+        continue;
+      }
+      auto it = cluster->leaf_index.find(input);
+      if (it == cluster->leaf_index.end()) {
+        if (!CanBroadcastToRoot(input, *cluster)) return false;
+        it = cluster->leaf_index.emplace(input, cluster->leaves.size()).first;
+        cluster->leaves.push_back(input);
+      }
+      operands.push_back(-it->second - 1);
+    }
+    cluster->ops.push_back(node.op());
+    cluster->operands.insert(cluster->operands.end(), operands.begin(),
+                             operands.end());
+    if (num_inputs == 2) ++cluster->num_binary_ops;
+    cluster->nodes.push_back(node.name());
+    return true;
+  }
+
+  bool IsFusibleInput(const NodeDef& node,
+                      const ElementwiseCluster& cluster) const {
+    if (!CanFuse(node, cluster.dtype) ||
+        NumNonControlDataOutputs(node, *ctx().node_map) != 1) {
+      return false;
+    }
+    const OpInfo::TensorProperties* props;
+    return GetTensorProperties(node.name(), &props).ok() &&
+           ShapesSymbolicallyEqual(props->shape(), *cluster.shape);
+  }
+
+  // Returns true if `tensor`, without its leading 1s, has the trailing
+  // dimensions of the root.
+  bool CanBroadcastToRoot(const string& tensor,
+                          const ElementwiseCluster& cluster) const {
+    const OpInfo::TensorProperties* props;
+    if (!GetTensorProperties(tensor, &props).ok() ||
+        props->dtype() != cluster.dtype || props->shape().unknown_rank()) {
+      return false;
+    }
+    const TensorShapeProto& shape = props->shape();
+    const TensorShapeProto& root_shape = *cluster.shape;
+    int first = 0;
+    while (first < shape.dim_size() && shape.dim(first).size() == 1) ++first;
+    const int rank = shape.dim_size() - first;
+    if (rank > root_shape.dim_size()) return false;
+    for (int d = 0; d < rank; ++d) {
+      const int64_t dim = shape.dim(first + d).size();
+      const int64_t root_dim =
+          root_shape.dim(root_shape.dim_size() - rank + d).size();
+      // Unknown dimensions (-1) are not comparable, symbolic ones (< -1) are.
+      if (dim != root_dim || dim == -1) return false;
+    }
+    return true;
+  }
+
+  bool CanFuse(const NodeDef& node, DataType dtype) const {
+    // WARN: This should be consistent with fused_elementwise_op.cc.
+    static const auto* const kFusibleOps = new absl::flat_hash_set<string>{
+        "Abs",     "Add",  "AddV2",  "Div",
+        "Exp",     "Inv",  "Log",    "Maximum",
+        "Minimum", "Mul",  "Neg",    "RealDiv",
+        "Reciprocal",      "Relu",   "Rsqrt",
+        "Sigmoid", "Sqrt", "Square", "SquaredDifference",
+        "Sub",     "Tanh"};
+    return kFusibleOps->contains(node.op()) &&
+           (dtype == DT_FLOAT || dtype == DT_DOUBLE) &&
+           GetDataTypeFromAttr(node, "T") == dtype && !IsInPreserveSet(node) &&
+           NodeIsOnCpu(node) && fused_nodes_.count(node.name()) == 0 &&
+           !IsDrivenByControlDependency(node) && !DrivesControlDependency(node);
+  }
+
+  string OptimizedNodeName(const NodeDef& node) const {
+    return strings::StrCat(node.name(), "/fused_elementwise");
+  }
+
+  std::unordered_set<string> fused_nodes_;
+};
+
 // Replace operations of the form:
 //    x = stack((a_0, a_1, ..., a_{n-1}), axis=k)[:,...,i,...]
 // with
@@ -4403,6 +4573,8 @@ absl::Status ArithmeticOptimizer::SimplifyArithmeticOps(bool can_use_shapes) {
     pipeline.AddStage<OptimizeMaxOrMinOfMonotonicStage>(ctx, ctx_ext);
   if (options_.convert_expm1)
     pipeline.AddStage<ConvertExpm1Stage>(ctx, ctx_ext);
+  if (is_aggressive && options_.fuse_elementwise_clusters && can_use_shapes)
+    pipeline.AddStage<FuseElementwiseClusters>(ctx, ctx_ext);
   if (options_.unary_ops_composition)
     pipeline.AddStage<UnaryOpsComposition>(ctx, ctx_ext);
   if (options_.remove_stack_slice_same_axis)
@@ -4479,6 +4651,8 @@ absl::Status ArithmeticOptimizer::Optimize(Cluster* /*cluster*/,
   // // Disable restricted graph rewrites.
   options_.unary_ops_composition &=
       item.optimization_options().allow_non_differentiable_rewrites;
+  options_.fuse_elementwise_clusters &=
+      item.optimization_options().allow_non_differentiable_rewrites;
 
   // Perform topological sort on the graph in order to help DedupComputations
   // and AddOpsRewrite to optimize larger subgraphs starting from the roots
@@ -4335,6 +4335,73 @@ TEST_F(ArithmeticOptimizerTest, UnaryOpsComposition) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(ArithmeticOptimizerTest, FuseElementwiseClusters) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f},
+                      {2, 3});
+  auto mean = ops::Const(s.WithOpName("mean"), {1.0f, 2.0f, 3.0f}, {3});
+  auto gamma = ops::Const(s.WithOpName("gamma"), {0.5f, -1.0f, 2.0f}, {3});
+  auto beta = ops::Const(s.WithOpName("beta"), {0.0f, 1.0f, -2.0f}, {3});
+  Output sub = ops::Sub(s.WithOpName("sub"), x, mean);
+  Output mul = ops::Mul(s.WithOpName("mul"), sub, gamma);
+  Output add = ops::Add(s.WithOpName("add"), mul, beta);
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  Output final_out = ops::Identity(s.WithOpName("final_out"), relu);
+
+  GrapplerItem item;
+  item.fetch = {"final_out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  GraphDef output;
+  ArithmeticOptimizer optimizer(RewriterConfig::AGGRESSIVE);
+  EnableOnlyFuseElementwiseClusters(&optimizer);
+  OptimizeAndPrune(&optimizer, &item, &output);
+
+  // Check that Sub/Mul/Add/Relu were replaced with a single op.
+  int required_node_count = 0;
+  for (int i = 0; i < output.node_size(); ++i) {
+    const NodeDef& node = output.node(i);
+    EXPECT_NE(node.name(), "sub");
+    if (node.name() == "final_out") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "relu/fused_elementwise");
+      ++required_node_count;
+    } else if (node.name() == "relu/fused_elementwise") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "mean");
+      EXPECT_EQ(node.input(2), "gamma");
+      EXPECT_EQ(node.input(3), "beta");
+
+      auto ops = node.attr().at("ops").list().s();
+      ASSERT_EQ(ops.size(), 4);
+      EXPECT_EQ(ops[0], "Sub");
+      EXPECT_EQ(ops[1], "Mul");
+      EXPECT_EQ(ops[2], "Add");
+      EXPECT_EQ(ops[3], "Relu");
+      auto operands = node.attr().at("operands").list().i();
+      EXPECT_EQ(std::vector<int64_t>(operands.begin(), operands.end()),
+                std::vector<int64_t>({0, 1, 4, 2, 5, 3, 6}));
+      ++required_node_count;
+    }
+  }
+  EXPECT_EQ(required_node_count, 2);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
 TEST_F(ArithmeticOptimizerTest, RemoveStackStridedSliceSameAxis) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto a_in =
@@ -233,6 +233,11 @@ class ArithmeticOptimizerTest : public GrapplerTest {
     optimizer->options_.unary_ops_composition = true;
   }
 
+  void EnableOnlyFuseElementwiseClusters(ArithmeticOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.fuse_elementwise_clusters = true;
+  }
+
   void EnableOnlyRemoveStackSliceSameAxis(ArithmeticOptimizer* optimizer) {
     DisableAllStages(optimizer);
     optimizer->options_.remove_stack_slice_same_axis = true;
@@ -261,6 +266,7 @@ class ArithmeticOptimizerTest : public GrapplerTest {
     options.fold_conjugate_into_transpose = false;
     options.fold_multiply_into_conv = false;
     options.fold_transpose_into_matmul = false;
+    options.fuse_elementwise_clusters = false;
     options.hoist_common_factor_out_of_aggregation = false;
     options.hoist_cwise_unary_chains = false;
     options.minimize_broadcasts = false;
@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_filter_batch_fusion.h"
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFusedOpName[] = "MapFilterBatchDataset";
+
+NodeDef MakeMapFilterBatchNode(const NodeDef& map_node,
+                               const NodeDef& filter_node,
+                               const NodeDef& batch_node,
+                               MutableGraphView* graph) {
+  NodeDef new_node;
+  new_node.set_op(kFusedOpName);
+  graph_utils::SetUniqueGraphNodeName(kFusedOpName, graph->graph(), &new_node);
+
+  // Set the `input_dataset` input argument.
+  new_node.add_input(map_node.input(0));
+
+  // Set the `map_other_arguments` input arguments.
+  for (int i = 1; i < map_node.input_size(); ++i) {
+    new_node.add_input(map_node.input(i));
+  }
+
+  // Set the `predicate_other_arguments` input arguments.
+  for (int i = 1; i < filter_node.input_size(); ++i) {
+    new_node.add_input(filter_node.input(i));
+  }
+
+  // Set the `batch_size` input argument.
+  new_node.add_input(batch_node.input(1));
+
+  // Set the `drop_remainder` input argument.
+  if (batch_node.op() == "BatchDatasetV2") {
+    new_node.add_input(batch_node.input(2));
+  } else {
+    NodeDef* tmp = graph_utils::AddScalarConstNode<bool>(false, graph);
+    new_node.add_input(tmp->name());
+  }
+
+  // Required attributes.
+  graph_utils::CopyAttribute("f", map_node, &new_node);
+  (*new_node.mutable_attr())["Tmap_arguments"] =
+      map_node.attr().at("Targuments");
+  graph_utils::CopyAttribute("predicate", filter_node, &new_node);
+  (*new_node.mutable_attr())["Tpredicate_arguments"] =
+      filter_node.attr().at("Targuments");
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+
+  // Optional attributes.
+  if (gtl::FindOrNull(map_node.attr(), "preserve_cardinality")) {
+    graph_utils::CopyAttribute("preserve_cardinality", map_node, &new_node);
+  }
+  graph_utils::MaybeSetFusedMetadata(map_node, batch_node, &new_node);
+  return new_node;
+}
+
+// Returns true if the batch size of `batch_node` is a constant small enough
+// for the fused kernel to preallocate the whole batch.
+bool HasSmallConstantBatchSize(const NodeDef& batch_node,
+                               const MutableGraphView& graph) {
+  const NodeDef* batch_size_node = graph.GetNode(batch_node.input(1));
+  int64_t batch_size;
+  if (batch_size_node == nullptr ||
+      !graph_utils::GetScalarConstNodeValue(*batch_size_node, &batch_size)
+           .ok()) {
+    return false;
+  }
+  return batch_size > 0 && batch_size <= MapFilterBatchFusion::kMaxBatchSize;
+}
+
+// Returns true if `map_node` runs its function with inter-op parallelism. The
+// fused kernel always does, so maps that opt out of it are not fused.
+bool UsesInterOpParallelism(const NodeDef& map_node) {
+  const auto* use_inter_op_parallelism =
+      gtl::FindOrNull(map_node.attr(), "use_inter_op_parallelism");
+  return use_inter_op_parallelism == nullptr || use_inter_op_parallelism->b();
+}
+
+}  // namespace
+
+absl::Status MapFilterBatchFusion::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "BatchDataset" && node.op() != "BatchDatasetV2") {
+      continue;
+    }
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& batch_node = node;
+    if (!HasSmallConstantBatchSize(batch_node, graph)) {
+      continue;
+    }
+
+    NodeDef* filter_node = graph_utils::GetInputNode(batch_node, graph);
+    if (filter_node == nullptr || filter_node->op() != "FilterDataset" ||
+        nodes_to_delete.contains(filter_node->name())) {
+      continue;
+    }
+    NodeDef* map_node = graph_utils::GetInputNode(*filter_node, graph);
+    if (map_node == nullptr || map_node->op() != "MapDataset" ||
+        nodes_to_delete.contains(map_node->name()) ||
+        !UsesInterOpParallelism(*map_node)) {
+      continue;
+    }
+    // The intermediate datasets must not be consumed by any other node.
+    if (graph.GetFanout(graph.GetOutputPort(filter_node->name(), 0)).size() !=
+            1 ||
+        graph.GetFanout(graph.GetOutputPort(map_node->name(), 0)).size() !=
+            1) {
+      continue;
+    }
+
+    auto* new_node = graph.AddNode(
+        MakeMapFilterBatchNode(*map_node, *filter_node, batch_node, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_node->name()));
+
+    // Mark the `Map`, `Filter` and `Batch` nodes for removal.
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(filter_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapFilterBatchFusion, "map_filter_batch_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_FILTER_BATCH_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_FILTER_BATCH_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses a `MapDataset` -> `FilterDataset` -> `BatchDataset[V2]` chain into a
+// single `MapFilterBatchDataset`, which runs the map function and predicate
+// per element and copies the surviving elements straight into a preallocated
+// batch. Only chains with a constant batch size of at most `kMaxBatchSize` are
+// fused, since the fused kernel allocates the full batch up front. Maps with
+// `use_inter_op_parallelism=false` are left alone, since the fused kernel
+// always runs the map function with inter-op parallelism.
+class MapFilterBatchFusion : public TFDataOptimizerBase {
+ public:
+  static constexpr int64_t kMaxBatchSize = 4096;
+
+  MapFilterBatchFusion() = default;
+  ~MapFilterBatchFusion() override = default;
+
+  string name() const override { return "map_filter_batch_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  absl::Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OptimizeAndCollectStats(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphDef* output,
+                                       OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_FILTER_BATCH_FUSION_H_
@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_filter_batch_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeFilterNode;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+GrapplerItem MakeItem(int64_t batch_size) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       MakeMapNode("map", "range"), MakeFilterNode("filter", "map"),
+       NDef("batch_size", "Const", {},
+            {{"value", batch_size}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", true}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "filter", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false)},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::IsZero(),
+      });
+  return item;
+}
+
+TEST(MapFilterBatchFusionTest, FuseMapFilterAndBatch) {
+  GrapplerItem item = MakeItem(/*batch_size=*/8);
+  MapFilterBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("filter", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("MapFilterBatchDataset", output));
+  const NodeDef& fused_node = output.node(
+      graph_utils::FindGraphNodeWithOp("MapFilterBatchDataset", output));
+  ASSERT_EQ(fused_node.input_size(), 3);
+  EXPECT_EQ(fused_node.input(0), "range");
+  EXPECT_EQ(fused_node.input(1), "batch_size");
+  EXPECT_EQ(fused_node.input(2), "drop_remainder");
+  const NodeDef& map_node =
+      item.graph.node(graph_utils::FindGraphNodeWithName("map", item.graph));
+  const NodeDef& filter_node =
+      item.graph.node(graph_utils::FindGraphNodeWithName("filter", item.graph));
+  EXPECT_TRUE(
+      AreAttrValuesEqual(fused_node.attr().at("f"), map_node.attr().at("f")));
+  EXPECT_TRUE(AreAttrValuesEqual(fused_node.attr().at("predicate"),
+                                 filter_node.attr().at("predicate")));
+}
+
+TEST(MapFilterBatchFusionTest, SkipLargeBatchSize) {
+  GrapplerItem item =
+      MakeItem(/*batch_size=*/MapFilterBatchFusion::kMaxBatchSize + 1);
+  MapFilterBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("filter", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_FALSE(
+      graph_utils::ContainsNodeWithOp("MapFilterBatchDataset", output));
+}
+
+TEST(MapFilterBatchFusionTest, SkipMapWithoutInterOpParallelism) {
+  GrapplerItem item = MakeItem(/*batch_size=*/8);
+  NodeDef* map_node = item.graph.mutable_node(
+      graph_utils::FindGraphNodeWithName("map", item.graph));
+  (*map_node->mutable_attr())["use_inter_op_parallelism"].set_b(false);
+  MapFilterBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("filter", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  EXPECT_FALSE(
+      graph_utils::ContainsNodeWithOp("MapFilterBatchDataset", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
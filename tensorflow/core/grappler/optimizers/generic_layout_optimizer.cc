@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -24,12 +28,18 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -40,6 +50,26 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kGPURatioThreshold = 0.5;
 constexpr float kConvGPUExpectedDtypeThreshold = 0.5;
+// Autotuning candidate that leaves the graph in its original layout.
+constexpr char kKeepLayout[] = "keep";
+
+// Layouts chosen by autotuning, keyed by graph and cluster fingerprint, so that
+// retracing or re-optimizing the same graph does not measure it again.
+mutex autotune_cache_mu(LINKER_INITIALIZED);
+auto* autotune_cache TF_GUARDED_BY(autotune_cache_mu) =
+    new absl::flat_hash_map<uint64, string>();
+
+uint64 AutotuneCacheKey(const GrapplerItem& item, const Cluster& cluster) {
+  uint64 key = DeterministicProtoHash64(item.graph);
+  for (const string& fetch : item.fetch) {
+    key = FingerprintCat64(key, Fingerprint64(fetch));
+  }
+  for (const auto& device : cluster.GetDevices()) {
+    key = FingerprintCat64(key, Fingerprint64(device.first));
+    key = FingerprintCat64(key, DeterministicProtoHash64(device.second));
+  }
+  return key;
+}
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -474,11 +504,26 @@ absl::Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                      ". Supported layouts: 'NHWC', 'NCHW'."));
   }
   const auto gpu_stats = GetNumGPUs(*cluster);
+  if (gpu_stats.num_gpus > 0 && enforced_layout_.empty()) {
+    int64_t measurement_steps = 0;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_GRAPPLER_LAYOUT_AUTOTUNE_STEPS",
+                                           0, &measurement_steps));
+    if (measurement_steps > 0) {
+      return AutotuneLayout(cluster, item, measurement_steps, output);
+    }
+  }
+  return ConvertLayout(cluster, item, enforced_layout_, output);
+}
+
+absl::Status GenericLayoutOptimizer::ConvertLayout(
+    Cluster* cluster, const GrapplerItem& item,
+    const string& enforced_layout, GraphDef* output) {
+  const auto gpu_stats = GetNumGPUs(*cluster);
 
   const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
 
   TransposeContext context;
-  context.enforced_layout = enforced_layout_;
+  context.enforced_layout = enforced_layout;
 
   if (gpu_stats.num_gpus > 0) {
     TF_RETURN_IF_ERROR(TransposeContext::InitializeTransposeContext(
@@ -524,5 +569,80 @@ absl::Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   return absl::OkStatus();
 }
 
+std::unique_ptr<CostEstimator>
+GenericLayoutOptimizer::CreateAutotuneCostEstimator(Cluster* cluster,
+                                                    int64_t measurement_steps) {
+  return std::make_unique<MeasuringCostEstimator>(cluster, measurement_steps,
+                                                  /*measurement_threads=*/0);
+}
+
+absl::Status GenericLayoutOptimizer::AutotuneLayout(Cluster* cluster,
+                                                    const GrapplerItem& item,
+                                                    int64_t measurement_steps,
+                                                    GraphDef* output) {
+  const uint64 key = AutotuneCacheKey(item, *cluster);
+  std::optional<string> cached_layout;
+  {
+    mutex_lock lock(autotune_cache_mu);
+    auto it = autotune_cache->find(key);
+    if (it != autotune_cache->end()) cached_layout = it->second;
+  }
+  if (cached_layout.has_value()) {
+    VLOG(2) << "Using autotuned layout '" << *cached_layout << "' for "
+            << item.id;
+    if (*cached_layout == kKeepLayout) {
+      *output = item.graph;
+      return absl::OkStatus();
+    }
+    return ConvertLayout(cluster, item, *cached_layout, output);
+  }
+
+  std::unique_ptr<CostEstimator> estimator =
+      CreateAutotuneCostEstimator(cluster, measurement_steps);
+  absl::Status status = estimator->Initialize(item);
+  if (!status.ok()) {
+    VLOG(1) << "Layout autotuning is unavailable: " << status;
+    return ConvertLayout(cluster, item, enforced_layout_, output);
+  }
+
+  string best_layout;
+  GraphDef best_graph;
+  Costs::Duration best_time = Costs::Duration::max();
+  for (const string& layout : {string(kKeepLayout), string(kNCHW),
+                               string(kNHWC)}) {
+    GraphDef candidate;
+    if (layout == kKeepLayout) {
+      candidate = item.graph;
+    } else if (!ConvertLayout(cluster, item, layout, &candidate).ok()) {
+      continue;
+    }
+    Costs costs;
+    status =
+        estimator->PredictCosts(candidate, /*run_metadata=*/nullptr, &costs);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to measure layout '" << layout << "': " << status;
+      continue;
+    }
+    VLOG(2) << "Layout '" << layout << "' of " << item.id << " took "
+            << costs.execution_time.count() << "ns";
+    if (costs.execution_time < best_time) {
+      best_time = costs.execution_time;
+      best_layout = layout;
+      best_graph = std::move(candidate);
+    }
+  }
+  if (best_layout.empty()) {
+    // Nothing could be measured, e.g. because the feeds are incomplete.
+    return ConvertLayout(cluster, item, enforced_layout_, output);
+  }
+
+  {
+    mutex_lock lock(autotune_cache_mu);
+    autotune_cache->emplace(key, best_layout);
+  }
+  *output = std::move(best_graph);
+  return absl::OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
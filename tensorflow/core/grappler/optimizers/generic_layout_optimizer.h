@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -25,6 +28,12 @@ namespace tensorflow {
 namespace grappler {
 
 // Optimize the data layout for convolutional models.
+//
+// On GPU clusters without an enforced layout, setting the environment variable
+// TF_GRAPPLER_LAYOUT_AUTOTUNE_STEPS to a positive number replaces the layout
+// heuristic with measurement: the original graph and its NCHW and NHWC
+// rewrites are each run that many times on the cluster, and the fastest one is
+// kept. The choice is cached per graph for the lifetime of the process.
 class GenericLayoutOptimizer : public GraphOptimizer {
  public:
   explicit GenericLayoutOptimizer(string enforced_layout = "")
@@ -50,7 +59,23 @@ class GenericLayoutOptimizer : public GraphOptimizer {
   absl::Status Optimize(Cluster* cluster, const GrapplerItem& item,
                         GraphDef* output) override;
 
+ protected:
+  // Returns the estimator that measures each candidate layout during
+  // autotuning. By default, candidates are run `measurement_steps` times on
+  // `cluster`.
+  virtual std::unique_ptr<CostEstimator> CreateAutotuneCostEstimator(
+      Cluster* cluster, int64_t measurement_steps);
+
  private:
+  // Rewrites `item` into `enforced_layout`, or into the layout chosen by the
+  // heuristic if it is empty.
+  absl::Status ConvertLayout(Cluster* cluster, const GrapplerItem& item,
+                             const string& enforced_layout, GraphDef* output);
+  // Picks the fastest layout for `item` by running each candidate on
+  // `cluster`. Falls back to the heuristic if the candidates cannot be run.
+  absl::Status AutotuneLayout(Cluster* cluster, const GrapplerItem& item,
+                              int64_t measurement_steps, GraphDef* output);
+
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
   const string enforced_layout_;
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <cstdint>
+#include <memory>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/clusters/single_machine.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
@@ -362,6 +366,79 @@ TEST_F(GenericLayoutOptimizerTest, GPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NCHW");
 }
 
+// Measures a graph as fast if its "Conv2D" node is in NHWC, and counts the
+// estimators created, i.e. the graphs that were autotuned.
+class FakeLayoutCostEstimator : public CostEstimator {
+ public:
+  absl::Status Initialize(const GrapplerItem& item) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status PredictCosts(const GraphDef& optimized_graph,
+                            RunMetadata* run_metadata,
+                            Costs* cost) const override {
+    *cost = Costs::ZeroCosts();
+    cost->execution_time = Costs::Duration(1000);
+    for (const NodeDef& node : optimized_graph.node()) {
+      if (node.name() == "Conv2D" &&
+          node.attr().at("data_format").s() == "NHWC") {
+        cost->execution_time = Costs::Duration(10);
+      }
+    }
+    return absl::OkStatus();
+  }
+};
+
+class FakeAutotuneLayoutOptimizer : public GenericLayoutOptimizer {
+ public:
+  int num_autotuned() const { return num_autotuned_; }
+
+ protected:
+  std::unique_ptr<CostEstimator> CreateAutotuneCostEstimator(
+      Cluster* cluster, int64_t measurement_steps) override {
+    ++num_autotuned_;
+    return std::make_unique<FakeLayoutCostEstimator>();
+  }
+
+ private:
+  int num_autotuned_ = 0;
+};
+
+TEST_F(GenericLayoutOptimizerTest, AutotuneLayout) {
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv =
+      SimpleConv2D(&s, 4, 2, "VALID", "/job:w/replica:0/task:0/device:GPU:0");
+  Output fetch = ops::Identity(s.WithOpName("AutotunedFetch"), {conv});
+  GrapplerItem item;
+  item.fetch = {"AutotunedFetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  setenv("TF_GRAPPLER_LAYOUT_AUTOTUNE_STEPS", "2", /*overwrite=*/1);
+  FakeAutotuneLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  EXPECT_EQ(optimizer.num_autotuned(), 1);
+  // The second run reuses the cached choice instead of measuring again.
+  GraphDef cached_output;
+  TF_ASSERT_OK(
+      optimizer.Optimize(virtual_cluster_.get(), item, &cached_output));
+  unsetenv("TF_GRAPPLER_LAYOUT_AUTOTUNE_STEPS");
+  EXPECT_EQ(optimizer.num_autotuned(), 1);
+  CompareGraphs(output, cached_output);
+
+  // The heuristic would pick NCHW on this cluster (see the GPUDevice test),
+  // but NHWC was measured to be faster.
+  absl::Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+}
+
 TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D(&s, 4, 2, "VALID", "/CPU:0");
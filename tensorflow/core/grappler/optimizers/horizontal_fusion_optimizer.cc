@@ -0,0 +1,300 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion_optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Fusing fewer nodes than this does not pay for the added concat and split.
+constexpr int kMinGroupSize = 4;
+// Larger inputs are dominated by the copies into and out of the packed buffer.
+constexpr int64_t kMaxElementsPerNode = 64 * 1024;
+
+// Returns the number of inputs of `node` if it is an element-wise op that can
+// be applied to a packed buffer, or 0 otherwise.
+int FusibleArity(const NodeDef& node) {
+  static const auto* const kUnaryOps = new absl::flat_hash_set<string>{
+      "Abs",   "Cast",  "Ceil",       "Cos",   "Exp",   "Expm1",
+      "Floor", "Log",   "Log1p",      "Neg",   "Relu",  "Relu6",
+      "Round", "Rsqrt", "Reciprocal", "Sign",  "Sin",   "Sigmoid",
+      "Sqrt",  "Square", "Tanh"};
+  static const auto* const kBinaryOps = new absl::flat_hash_set<string>{
+      "Add", "AddV2", "Maximum", "Minimum", "Mul", "RealDiv",
+      "SquaredDifference", "Sub"};
+  if (kUnaryOps->contains(node.op())) return 1;
+  if (kBinaryOps->contains(node.op())) return 2;
+  return 0;
+}
+
+// Returns the key under which `node` may be grouped with other nodes, which
+// covers its op, device, non-internal attributes and control inputs. Fused
+// nodes share the control inputs of the group, so all members need the same.
+string FusionKey(const NodeDef& node) {
+  std::vector<string> attr_names;
+  for (const auto& attr : node.attr()) {
+    if (!absl::StartsWith(attr.first, "_")) attr_names.push_back(attr.first);
+  }
+  std::sort(attr_names.begin(), attr_names.end());
+  string key = absl::StrCat(node.op(), "|", node.device());
+  for (const string& attr_name : attr_names) {
+    absl::StrAppend(&key, "|", attr_name, "=",
+                    SummarizeAttrValue(node.attr().at(attr_name)));
+  }
+  std::vector<string> control_inputs;
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) control_inputs.push_back(input);
+  }
+  std::sort(control_inputs.begin(), control_inputs.end());
+  for (const string& control_input : control_inputs) {
+    absl::StrAppend(&key, "|", control_input);
+  }
+  return key;
+}
+
+bool IsPackableType(DataType dtype) {
+  return DataTypeIsFloating(dtype) || DataTypeIsInteger(dtype);
+}
+
+// Returns true if `node` can join a horizontal fusion group: all of its inputs
+// are small tensors of the same fully defined shape.
+bool IsFusionCandidate(const NodeDef& node, const GraphProperties& properties,
+                       const FrameView& frame_view,
+                       const std::unordered_set<string>& nodes_to_preserve) {
+  const int arity = FusibleArity(node);
+  if (arity == 0 || NumNonControlInputs(node) != arity ||
+      nodes_to_preserve.count(node.name()) > 0 ||
+      frame_view.IsInFrame(node)) {
+    return false;
+  }
+  if (!properties.HasInputProperties(node.name()) ||
+      !properties.HasOutputProperties(node.name())) {
+    return false;
+  }
+  const auto& inputs = properties.GetInputProperties(node.name());
+  const auto& outputs = properties.GetOutputProperties(node.name());
+  if (inputs.size() != arity || outputs.size() != 1 ||
+      !IsPackableType(outputs[0].dtype())) {
+    return false;
+  }
+  for (const auto& input : inputs) {
+    const PartialTensorShape shape(input.shape());
+    if (!shape.IsFullyDefined() || !IsPackableType(input.dtype()) ||
+        shape.num_elements() == 0 ||
+        shape.num_elements() > kMaxElementsPerNode ||
+        !shape.IsIdenticalTo(PartialTensorShape(inputs[0].shape()))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+NodeDef* AddNode(const string& name, const string& op, const string& device,
+                 GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  node->set_device(device);
+  return node;
+}
+
+void AddConstNode(const string& name, const Tensor& value, const string& device,
+                  GraphDef* graph) {
+  NodeDef* node = AddNode(name, "Const", device, graph);
+  (*node->mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+}
+
+// Rewrites the nodes at `members` into one op over a packed buffer whose
+// helper nodes are named under `prefix`.
+void FuseGroup(const std::vector<int>& members, const string& prefix,
+               const GraphProperties& properties, GraphDef* graph) {
+  const NodeDef first = graph->node(members[0]);
+  const string& device = first.device();
+  const int arity = FusibleArity(first);
+  const int num_members = members.size();
+  const auto& first_inputs = properties.GetInputProperties(first.name());
+  const DataType input_dtype = first_inputs[0].dtype();
+  const DataType output_dtype =
+      properties.GetOutputProperties(first.name())[0].dtype();
+
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  AddConstNode(absl::StrCat(prefix, "/axis"), axis, device, graph);
+  Tensor flat_shape(DT_INT32, TensorShape({1}));
+  flat_shape.vec<int32>()(0) = -1;
+  AddConstNode(absl::StrCat(prefix, "/flat_shape"), flat_shape, device, graph);
+
+  // Pack each operand of every member into one vector.
+  NodeDef* fused =
+      AddNode(absl::StrCat(prefix, "/fused"), first.op(), device, graph);
+  for (const auto& attr : first.attr()) {
+    if (!absl::StartsWith(attr.first, "_")) {
+      (*fused->mutable_attr())[attr.first] = attr.second;
+    }
+  }
+  for (const string& input : first.input()) {
+    if (IsControlInput(input)) fused->add_input(input);
+  }
+  for (int operand = 0; operand < arity; ++operand) {
+    NodeDef* packed = AddNode(absl::StrCat(prefix, "/packed_", operand),
+                              "ConcatV2", device, graph);
+    for (int i = 0; i < num_members; ++i) {
+      NodeDef* flat = AddNode(absl::StrCat(prefix, "/flat_", operand, "_", i),
+                              "Reshape", device, graph);
+      flat->add_input(graph->node(members[i]).input(operand));
+      flat->add_input(absl::StrCat(prefix, "/flat_shape"));
+      (*flat->mutable_attr())["T"].set_type(input_dtype);
+      (*flat->mutable_attr())["Tshape"].set_type(DT_INT32);
+      packed->add_input(flat->name());
+    }
+    packed->add_input(absl::StrCat(prefix, "/axis"));
+    (*packed->mutable_attr())["N"].set_i(num_members);
+    (*packed->mutable_attr())["T"].set_type(input_dtype);
+    (*packed->mutable_attr())["Tidx"].set_type(DT_INT32);
+    fused->add_input(packed->name());
+  }
+
+  // Split the result and give every member back its slice in its own shape.
+  Tensor sizes(DT_INT64, TensorShape({num_members}));
+  for (int i = 0; i < num_members; ++i) {
+    const auto& input = properties.GetInputProperties(
+        graph->node(members[i]).name())[0];
+    sizes.vec<int64_t>()(i) = PartialTensorShape(input.shape()).num_elements();
+  }
+  AddConstNode(absl::StrCat(prefix, "/sizes"), sizes, device, graph);
+  NodeDef* split =
+      AddNode(absl::StrCat(prefix, "/split"), "SplitV", device, graph);
+  split->add_input(fused->name());
+  split->add_input(absl::StrCat(prefix, "/sizes"));
+  split->add_input(absl::StrCat(prefix, "/axis"));
+  (*split->mutable_attr())["num_split"].set_i(num_members);
+  (*split->mutable_attr())["T"].set_type(output_dtype);
+  (*split->mutable_attr())["Tlen"].set_type(DT_INT64);
+
+  for (int i = 0; i < num_members; ++i) {
+    NodeDef* member = graph->mutable_node(members[i]);
+    const PartialTensorShape shape(
+        properties.GetInputProperties(member->name())[0].shape());
+    Tensor dims(DT_INT64, TensorShape({shape.dims()}));
+    for (int d = 0; d < shape.dims(); ++d) {
+      dims.vec<int64_t>()(d) = shape.dim_size(d);
+    }
+    const string shape_name = absl::StrCat(prefix, "/shape_", i);
+    AddConstNode(shape_name, dims, device, graph);
+
+    member = graph->mutable_node(members[i]);
+    member->set_op("Reshape");
+    member->clear_input();
+    member->add_input(absl::StrCat(split->name(), ":", i));
+    member->add_input(shape_name);
+    member->clear_attr();
+    (*member->mutable_attr())["T"].set_type(output_dtype);
+    (*member->mutable_attr())["Tshape"].set_type(DT_INT64);
+  }
+}
+
+}  // namespace
+
+absl::Status HorizontalFusionOptimizer::Optimize(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_input_tensor_values=*/false));
+
+  // Nodes at the same depth (longest path from a source) can not depend on
+  // each other, so fusing them can not create a cycle.
+  // Nodes that transitively consume a Switch output may receive dead tensors,
+  // and packing them with live nodes would kill the whole group, so they are
+  // never fused.
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*optimized_graph, &topo_order));
+  absl::flat_hash_map<string, int> depth;
+  absl::flat_hash_set<string> conditional_nodes;
+  for (const NodeDef* node : topo_order) {
+    int node_depth = 0;
+    bool is_conditional = IsSwitch(*node);
+    for (const string& input : node->input()) {
+      node_depth = std::max(node_depth, depth[NodeName(input)] + 1);
+      is_conditional |= conditional_nodes.contains(NodeName(input));
+    }
+    depth[node->name()] = node_depth;
+    if (is_conditional) conditional_nodes.insert(node->name());
+  }
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  std::map<std::pair<int, string>, std::vector<int>> groups;
+  absl::flat_hash_set<string> node_names;
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    const NodeDef& node = optimized_graph->node(i);
+    node_names.insert(node.name());
+    if (!conditional_nodes.contains(node.name()) &&
+        IsFusionCandidate(node, properties, frame_view, nodes_to_preserve)) {
+      groups[{depth[node.name()], FusionKey(node)}].push_back(i);
+    }
+  }
+
+  int group_id = 0;
+  for (const auto& group : groups) {
+    const std::vector<int>& members = group.second;
+    if (members.size() < static_cast<size_t>(kMinGroupSize)) continue;
+    const string& op = optimized_graph->node(members[0]).op();
+    string prefix;
+    do {
+      prefix = AddPrefixToNodeName(absl::StrCat(op, "_", group_id++),
+                                   "horizontal_fusion");
+    } while (node_names.contains(absl::StrCat(prefix, "/fused")));
+    VLOG(2) << "Fusing " << members.size() << " " << op << " nodes into "
+            << prefix;
+    FuseGroup(members, prefix, properties, optimized_graph);
+  }
+  return absl::OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses many small, mutually independent element-wise ops of the same kind
+// into one op over a packed buffer.
+//
+// Nodes with the same op, attributes, device and control inputs, whose inputs
+// are small and have fully defined shapes, and which sit at the same depth of
+// the graph (so none of them can depend on another) are grouped. Nodes inside
+// loops or downstream of a Switch are left alone. Each group is rewritten as
+//
+//   ConcatV2(Reshape(x_i, [-1])...) -> Op -> SplitV -> Reshape(original shape)
+//
+// and each original node is replaced by the final Reshape of its slice, so its
+// name and consumers are unchanged. This trades one concat and one split for
+// the per-node kernel launch and executor overhead of every member.
+class HorizontalFusionOptimizer : public GraphOptimizer {
+ public:
+  HorizontalFusionOptimizer() = default;
+  ~HorizontalFusionOptimizer() override = default;
+
+  string name() const override { return "horizontal_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  absl::Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                        GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_OPTIMIZER_H_
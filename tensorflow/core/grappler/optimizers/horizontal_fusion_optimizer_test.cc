@@ -0,0 +1,220 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion_optimizer.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class HorizontalFusionOptimizerTest : public GrapplerTest {};
+
+int CountOps(const GraphDef& graph, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph.node()) {
+    if (node.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST_F(HorizontalFusionOptimizerTest, FusesIndependentUnaryOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 4; ++i) {
+    const string suffix = std::to_string(i);
+    auto x = ops::Placeholder(s.WithOpName("x" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({2, i + 1}));
+    auto log = ops::Log1p(s.WithOpName("log" + suffix), x);
+    ops::Identity(s.WithOpName("out" + suffix), log);
+    item.fetch.push_back("out" + suffix);
+    item.feed.emplace_back("x" + suffix,
+                           GenerateRandomTensor<DT_FLOAT>({2, i + 1}));
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "Log1p"), 1);
+  EXPECT_EQ(CountOps(output, "ConcatV2"), 1);
+  EXPECT_EQ(CountOps(output, "SplitV"), 1);
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "log2") {
+      EXPECT_EQ(node.op(), "Reshape");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "horizontal_fusion/Log1p_0/split:2");
+    }
+  }
+
+  auto expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto actual = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    test::ExpectTensorNear<float>(actual[i], expected[i], 1e-6);
+  }
+}
+
+TEST_F(HorizontalFusionOptimizerTest, FusesIndependentBinaryOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 5; ++i) {
+    const string suffix = std::to_string(i);
+    auto x = ops::Placeholder(s.WithOpName("x" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({3}));
+    auto y = ops::Placeholder(s.WithOpName("y" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({3}));
+    auto mul = ops::Mul(s.WithOpName("mul" + suffix), x, y);
+    ops::Identity(s.WithOpName("out" + suffix), mul);
+    item.fetch.push_back("out" + suffix);
+    item.feed.emplace_back("x" + suffix, GenerateRandomTensor<DT_FLOAT>({3}));
+    item.feed.emplace_back("y" + suffix, GenerateRandomTensor<DT_FLOAT>({3}));
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "Mul"), 1);
+  EXPECT_EQ(CountOps(output, "ConcatV2"), 2);
+
+  auto expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto actual = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    test::ExpectTensorNear<float>(actual[i], expected[i], 1e-6);
+  }
+}
+
+TEST_F(HorizontalFusionOptimizerTest, DoesNotFuseDependentOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                            ops::Placeholder::Shape({4}));
+  Output chain = x;
+  for (int i = 0; i < 4; ++i) {
+    chain = ops::Exp(s.WithOpName("exp" + std::to_string(i)), chain);
+  }
+  ops::Identity(s.WithOpName("out"), chain);
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "Exp"), 4);
+  EXPECT_EQ(CountOps(output, "SplitV"), 0);
+}
+
+TEST_F(HorizontalFusionOptimizerTest, DoesNotFuseSmallGroups) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 3; ++i) {
+    const string suffix = std::to_string(i);
+    auto x = ops::Placeholder(s.WithOpName("x" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+    ops::Identity(s.WithOpName("out" + suffix),
+                  ops::Exp(s.WithOpName("exp" + suffix), x));
+    item.fetch.push_back("out" + suffix);
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "Exp"), 3);
+}
+
+TEST_F(HorizontalFusionOptimizerTest, GroupsByControlInputs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto ctrl_a = ops::NoOp(s.WithOpName("ctrl_a"));
+  auto ctrl_b = ops::NoOp(s.WithOpName("ctrl_b"));
+  GrapplerItem item;
+  for (int i = 0; i < 7; ++i) {
+    const string suffix = std::to_string(i);
+    auto x = ops::Placeholder(s.WithOpName("x" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+    auto exp = ops::Exp(s.WithOpName("exp" + suffix)
+                            .WithControlDependencies(i < 4 ? ctrl_a : ctrl_b),
+                        x);
+    ops::Identity(s.WithOpName("out" + suffix), exp);
+    item.fetch.push_back("out" + suffix);
+    item.feed.emplace_back("x" + suffix, GenerateRandomTensor<DT_FLOAT>({4}));
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Only the four nodes that depend on `ctrl_a` form a large enough group.
+  EXPECT_EQ(CountOps(output, "Exp"), 4);
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "horizontal_fusion/Exp_0/fused") {
+      EXPECT_EQ(node.input(0), "^ctrl_a");
+    }
+  }
+
+  auto expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto actual = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    test::ExpectTensorNear<float>(actual[i], expected[i], 1e-6);
+  }
+}
+
+TEST_F(HorizontalFusionOptimizerTest, DoesNotFuseOpsDownstreamOfSwitch) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto pred = ops::Placeholder(s.WithOpName("pred"), DT_BOOL,
+                               ops::Placeholder::Shape({}));
+  GrapplerItem item;
+  for (int i = 0; i < 4; ++i) {
+    const string suffix = std::to_string(i);
+    auto x = ops::Placeholder(s.WithOpName("x" + suffix), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+    auto sw = ops::Switch(s.WithOpName("switch" + suffix), x, pred);
+    auto neg = ops::Neg(s.WithOpName("neg" + suffix), sw.output_true);
+    ops::Identity(s.WithOpName("out" + suffix),
+                  ops::Exp(s.WithOpName("exp" + suffix), neg));
+    item.fetch.push_back("out" + suffix);
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusionOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "Neg"), 4);
+  EXPECT_EQ(CountOps(output, "Exp"), 4);
+  EXPECT_EQ(CountOps(output, "SplitV"), 0);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -18,17 +18,22 @@ limitations under the License.
 #include <algorithm>
 #include <deque>
 #include <limits>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -39,6 +44,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -716,6 +723,282 @@ absl::Status CheckForDeadFanout(const MutableGraphView& view,
   return absl::OkStatus();
 }
 
+// Follows a chain of Identity nodes in a function body from `tensor`, and
+// returns the name of the tensor at its start.
+string SkipIdentities(
+    const string& tensor,
+    const absl::flat_hash_map<string, const NodeDef*>& nodes) {
+  string current = tensor;
+  for (;;) {
+    auto it = nodes.find(NodeName(current));
+    if (it == nodes.end() || !IsIdentity(*it->second) ||
+        it->second->input_size() == 0 || IsControlInput(it->second->input(0))) {
+      return current;
+    }
+    current = it->second->input(0);
+  }
+}
+
+bool HasFunctionAttr(const NodeDef& node) {
+  for (const auto& attr : node.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Moves the computation of a functional While body that only depends on loop
+// invariant loop variables and constants in front of the loop. Each value it
+// produced that is still read by the body becomes a new loop variable that the
+// body passes through unchanged.
+absl::Status HoistWhileLoopInvariants(NodeDef* while_node,
+                                      FunctionLibraryDefinition* flib,
+                                      GraphDef* graph, bool* modified) {
+  *modified = false;
+  for (const string& input : while_node->input()) {
+    if (IsControlInput(input)) return absl::OkStatus();
+  }
+  if (!while_node->attr().contains("body") ||
+      !while_node->attr().contains("cond")) {
+    return absl::OkStatus();
+  }
+  const NameAttrList& body_attr = while_node->attr().at("body").func();
+  const NameAttrList& cond_attr = while_node->attr().at("cond").func();
+  const FunctionDef* body_fdef = flib->Find(body_attr.name());
+  const FunctionDef* cond_fdef = flib->Find(cond_attr.name());
+  if (body_fdef == nullptr || cond_fdef == nullptr) return absl::OkStatus();
+
+  GrapplerFunctionItem body;
+  TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
+      *body_fdef, AttrSlice(&body_attr.attr()), *flib,
+      graph->versions().producer(), &body));
+  const int num_loop_vars = body.input_size();
+  if (num_loop_vars != while_node->input_size() ||
+      num_loop_vars != body.output_size()) {
+    return absl::OkStatus();
+  }
+
+  GraphDef& body_graph = body.mutable_function_body();
+  absl::flat_hash_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& node : body_graph.node()) {
+    body_nodes[node.name()] = &node;
+  }
+
+  // A loop variable is invariant if the body returns it unchanged.
+  absl::flat_hash_map<string, int> invariant_args;
+  for (int i = 0; i < num_loop_vars; ++i) {
+    auto it = body_nodes.find(body.output(i).node_name);
+    if (it == body_nodes.end() || it->second->input_size() != 1) continue;
+    const string source = SkipIdentities(it->second->input(0), body_nodes);
+    if (source == body.input(i).node_name) {
+      invariant_args[body.input(i).node_name] = i;
+    }
+  }
+  if (invariant_args.empty()) return absl::OkStatus();
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(body_graph, &topo_order));
+  absl::flat_hash_set<string> invariant_nodes;
+  absl::flat_hash_set<string> constant_nodes;
+  bool has_computation = false;
+  for (const NodeDef* node : topo_order) {
+    if (IsConstant(*node) && node->input_size() == 0) {
+      constant_nodes.insert(node->name());
+      continue;
+    }
+    if (IsArg(*node) || IsRetval(*node) || IsControlFlow(*node) ||
+        !IsFreeOfSideEffect(*node) || HasFunctionAttr(*node) ||
+        node->input_size() == 0) {
+      continue;
+    }
+    bool depends_on_loop_var = false;
+    bool hoistable = true;
+    for (const string& input : node->input()) {
+      const string input_node = NodeName(input);
+      if (IsControlInput(input)) {
+        hoistable = false;
+      } else if (invariant_args.contains(input_node) ||
+                 invariant_nodes.contains(input_node)) {
+        depends_on_loop_var = true;
+      } else if (!constant_nodes.contains(input_node)) {
+        hoistable = false;
+      }
+      if (!hoistable) break;
+    }
+    // Nodes computed from constants alone are left to constant folding.
+    if (hoistable && depends_on_loop_var) {
+      invariant_nodes.insert(node->name());
+      if (!IsIdentity(*node)) has_computation = true;
+    }
+  }
+  if (!has_computation) return absl::OkStatus();
+
+  // Collect the outputs of hoisted nodes that the rest of the body still reads.
+  std::set<string> frontier;
+  for (const NodeDef& node : body_graph.node()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) {
+      if (!invariant_nodes.contains(NodeName(input))) continue;
+      // Control dependencies on hoisted nodes would have to be rewired across
+      // the function boundary.
+      if (IsControlInput(input)) return absl::OkStatus();
+      frontier.insert(input);
+    }
+  }
+
+  // Each frontier tensor is read from a new pass-through loop variable, unless
+  // it is just an alias of an existing one.
+  absl::flat_hash_set<string> used_arg_names;
+  for (const NodeDef& node : body_graph.node()) {
+    used_arg_names.insert(node.name());
+  }
+  for (const auto& arg : cond_fdef->signature().input_arg()) {
+    used_arg_names.insert(arg.name());
+  }
+  absl::flat_hash_map<string, string> replacements;
+  std::vector<std::pair<string, DataType>> new_loop_vars;
+  std::vector<string> new_loop_var_sources;
+  int arg_id = 0;
+  for (const string& tensor : frontier) {
+    const string source = SkipIdentities(tensor, body_nodes);
+    if (invariant_args.contains(NodeName(source))) {
+      replacements[tensor] = NodeName(source);
+      continue;
+    }
+    const NodeDef* producer = body_nodes.at(NodeName(tensor));
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(producer->op(),
+                                                         &op_def));
+    DataType dtype;
+    TF_RETURN_IF_ERROR(OutputTypeForNode(
+        *producer, *op_def, ParseTensorName(tensor).index(), &dtype));
+    string arg_name;
+    do {
+      arg_name = absl::StrCat("hoisted_arg_", arg_id++);
+    } while (used_arg_names.contains(arg_name) ||
+             used_arg_names.contains(absl::StrCat(arg_name, "_out_RetVal")));
+    used_arg_names.insert(arg_name);
+    replacements[tensor] = arg_name;
+    new_loop_vars.emplace_back(arg_name, dtype);
+    new_loop_var_sources.push_back(tensor);
+  }
+
+  // Copy the hoisted nodes, and the constants they read, in front of the loop.
+  // They are only added to the graph once the new functions are in place.
+  const string prefix = AddPrefixToNodeName("hoisted", while_node->name());
+  std::vector<NodeDef> hoisted_nodes;
+  absl::flat_hash_set<string> copied_constants;
+  auto outer_name = [&](const string& tensor) -> string {
+    const TensorId id = ParseTensorName(tensor);
+    auto arg = invariant_args.find(string(id.node()));
+    if (arg != invariant_args.end()) {
+      return while_node->input(arg->second);
+    }
+    const string name = AddPrefixToNodeName(string(id.node()), prefix);
+    return id.index() == 0 ? name : absl::StrCat(name, ":", id.index());
+  };
+  auto copy_node = [&](const NodeDef& node) {
+    NodeDef& copy = hoisted_nodes.emplace_back(node);
+    copy.set_name(AddPrefixToNodeName(node.name(), prefix));
+    if (copy.device().empty()) copy.set_device(while_node->device());
+    copy.clear_input();
+    for (const string& input : node.input()) {
+      copy.add_input(outer_name(input));
+    }
+  };
+  for (const NodeDef* node : topo_order) {
+    if (!invariant_nodes.contains(node->name())) continue;
+    for (const string& input : node->input()) {
+      const string input_node = NodeName(input);
+      if (constant_nodes.contains(input_node) &&
+          copied_constants.insert(input_node).second) {
+        copy_node(*body_nodes.at(input_node));
+      }
+    }
+    copy_node(*node);
+  }
+
+  // Rewire the body and drop the hoisted nodes from it.
+  for (NodeDef& node : *body_graph.mutable_node()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (int i = 0; i < node.input_size(); ++i) {
+      auto it = replacements.find(node.input(i));
+      if (it != replacements.end()) node.set_input(i, it->second);
+    }
+  }
+  body_nodes.clear();
+  EraseNodesFromGraph(std::set<string>(invariant_nodes.begin(),
+                                       invariant_nodes.end()),
+                      &body_graph);
+  for (const auto& loop_var : new_loop_vars) {
+    TF_RETURN_IF_ERROR(
+        AppendPassThroughArgument(loop_var.first, loop_var.second, &body));
+  }
+
+  FunctionDef new_body;
+  TF_RETURN_IF_ERROR(MakeFunctionDef(body, *flib, &new_body));
+  new_body.mutable_signature()->set_name(
+      flib->UniqueFunctionName(absl::StrCat(body_attr.name(), "_hoisted")));
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_body));
+
+  FunctionDef new_cond = *cond_fdef;
+  new_cond.mutable_signature()->set_name(
+      flib->UniqueFunctionName(absl::StrCat(cond_attr.name(), "_hoisted")));
+  for (const auto& loop_var : new_loop_vars) {
+    OpDef::ArgDef* arg = new_cond.mutable_signature()->add_input_arg();
+    arg->set_name(loop_var.first);
+    arg->set_type(loop_var.second);
+  }
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_cond));
+
+  for (NodeDef& node : hoisted_nodes) {
+    graph->add_node()->Swap(&node);
+  }
+  auto* attr = while_node->mutable_attr();
+  for (int i = 0; i < new_loop_vars.size(); ++i) {
+    while_node->add_input(outer_name(new_loop_var_sources[i]));
+    (*attr)["T"].mutable_list()->add_type(new_loop_vars[i].second);
+    for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+      auto it = attr->find(shapes_attr);
+      if (it != attr->end() && it->second.list().shape_size() > 0) {
+        it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+      }
+    }
+  }
+  NameAttrList* loop_body = (*attr)["body"].mutable_func();
+  loop_body->set_name(new_body.signature().name());
+  loop_body->clear_attr();
+  (*attr)["cond"].mutable_func()->set_name(new_cond.signature().name());
+
+  VLOG(2) << "Hoisted " << invariant_nodes.size()
+          << " loop invariant nodes out of " << while_node->name();
+  *modified = true;
+  return absl::OkStatus();
+}
+
+absl::Status HoistFunctionalWhileLoopInvariants(GraphDef* graph) {
+  FunctionLibraryDefinition flib(OpRegistry::Global(), graph->library());
+  // Hoisting appends nodes to the graph, which must not be visited again.
+  const int num_nodes = graph->node_size();
+  bool library_changed = false;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = graph->mutable_node(i);
+    if (!IsWhile(*node)) continue;
+    bool modified = false;
+    absl::Status status =
+        HoistWhileLoopInvariants(node, &flib, graph, &modified);
+    if (!status.ok()) {
+      VLOG(2) << "Failed to hoist loop invariants out of " << node->name()
+              << ": " << status;
+      continue;
+    }
+    library_changed |= modified;
+  }
+  if (library_changed) *graph->mutable_library() = flib.ToProto();
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -727,7 +1010,7 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -735,7 +1018,8 @@ absl::Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                      GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      !options_.enable_functional_while_hoisting) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
@@ -756,6 +1040,9 @@ absl::Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
+  if (options_.enable_functional_while_hoisting) {
+    TF_RETURN_IF_ERROR(HoistFunctionalWhileLoopInvariants(optimized_graph));
+  }
 
   return absl::OkStatus();
 }
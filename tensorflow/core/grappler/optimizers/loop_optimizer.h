@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_functional_while_hoisting;
+  }
 
   absl::Status Optimize(Cluster* cluster, const GrapplerItem& item,
                         GraphDef* optimized_graph) override;
@@ -53,9 +55,15 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    // Hoists loop invariant computation out of functional While bodies. The
+    // hoisted nodes run even if the loop does not, so an error they raise
+    // would surface where it did not before.
+    bool enable_functional_while_hoisting = false;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_functional_while_hoisting =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
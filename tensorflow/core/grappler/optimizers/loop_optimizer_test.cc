@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -71,6 +73,12 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyFunctionalWhileHoisting(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_dead_branch_removal = false;
+    optimizer->options_.enable_functional_while_hoisting = true;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
@@ -1802,5 +1810,103 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, HoistFunctionalWhileLoopInvariants) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // Body(i, x, acc) = (i + 1, x, acc * Exp(x)), where Exp(x) is invariant.
+  FunctionDef body = FDH::Create(
+      "Body", {"i:int32", "x:float", "acc:float"},
+      {"i_out:int32", "x_out:float", "acc_out:float"}, {},
+      {{{"one"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(1)}, {"dtype", DT_INT32}}},
+       {{"next"}, "Add", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"scale"}, "Exp", {"x"}, {{"T", DT_FLOAT}}},
+       {{"x_copy"}, "Identity", {"x"}, {{"T", DT_FLOAT}}},
+       {{"product"}, "Mul", {"acc", "scale:y:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next:z:0"},
+       {"x_out", "x_copy:output:0"},
+       {"acc_out", "product:z:0"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"i:int32", "x:float", "acc:float"}, {"pred:bool"}, {},
+      {{{"limit"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(3)}, {"dtype", DT_INT32}}},
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"pred", "less:z:0"}});
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("i", "Const", {},
+            {{"value", test::AsScalar<int32>(0)}, {"dtype", DT_INT32}}),
+       NDef("x", "Const", {},
+            {{"value", test::AsScalar<float>(0.5f)}, {"dtype", DT_FLOAT}}),
+       NDef("acc", "Const", {},
+            {{"value", test::AsScalar<float>(1.0f)}, {"dtype", DT_FLOAT}}),
+       NDef("while", "While", {"i", "x", "acc"},
+            {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+             {"body", FDH::FunctionRef("Body")},
+             {"cond", FDH::FunctionRef("Cond")},
+             {"output_shapes", std::vector<PartialTensorShape>(3)},
+             {"parallel_iterations", 10}}),
+       NDef("out", "Identity", {"while:2"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer(RewriterConfig::AGGRESSIVE, nullptr);
+  EnableOnlyFunctionalWhileHoisting(&optimizer);
+  EXPECT_TRUE(optimizer.UsesFunctionLibrary());
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* while_node = nullptr;
+  const NodeDef* hoisted_exp = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "while") while_node = &node;
+    if (node.name() == "while/hoisted/scale") hoisted_exp = &node;
+  }
+  ASSERT_NE(while_node, nullptr);
+  ASSERT_NE(hoisted_exp, nullptr);
+  EXPECT_EQ(hoisted_exp->op(), "Exp");
+  ASSERT_EQ(hoisted_exp->input_size(), 1);
+  EXPECT_EQ(hoisted_exp->input(0), "x");
+
+  ASSERT_EQ(while_node->input_size(), 4);
+  EXPECT_EQ(while_node->input(3), "while/hoisted/scale");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 4);
+  EXPECT_EQ(while_node->attr().at("output_shapes").list().shape_size(), 4);
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  const FunctionDef* new_body =
+      flib.Find(while_node->attr().at("body").func().name());
+  const FunctionDef* new_cond =
+      flib.Find(while_node->attr().at("cond").func().name());
+  ASSERT_NE(new_body, nullptr);
+  ASSERT_NE(new_cond, nullptr);
+  EXPECT_NE(new_body->signature().name(), "Body");
+  EXPECT_EQ(new_body->signature().input_arg_size(), 4);
+  EXPECT_EQ(new_body->signature().output_arg_size(), 4);
+  EXPECT_EQ(new_cond->signature().input_arg_size(), 4);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.op(), "Exp");
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(LoopOptimizerTest, FunctionalWhileHoistingIsAggressiveOnly) {
+  EXPECT_FALSE(
+      LoopOptimizer(RewriterConfig::ON, nullptr).UsesFunctionLibrary());
+  EXPECT_TRUE(
+      LoopOptimizer(RewriterConfig::AGGRESSIVE, nullptr).UsesFunctionLibrary());
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
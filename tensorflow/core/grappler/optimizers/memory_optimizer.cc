@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -979,13 +981,53 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
-static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
-    std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
-    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+// Simulates `item` on a virtual copy of `cluster` and records the estimated
+// completion time of every op, on the same timeline as `GraphMemory`.
+static bool EstimateOpCompletionTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  absl::Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+    }
+  }
+  return true;
+}
+
+// Returns the time at which the peak memory usage `mem_usage` is reached.
+static Costs::Duration PeakTime(const GraphMemory::MemoryUsage& mem_usage) {
+  Costs::Duration peak_time = -1;
+  for (const auto& live_tensor : mem_usage.live_tensors) {
+    if (live_tensor.allocation_time > peak_time) {
+      peak_time = live_tensor.allocation_time;
+    }
+  }
+  return peak_time;
+}
+
+// Infers the memory usage of `item` into `memory_ptr` unless it is already
+// known. Returns false if the memory usage can't be inferred.
+static bool MaybeInferMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                                  std::unique_ptr<GraphMemory>* memory_ptr) {
   if ((*memory_ptr) == nullptr) {
-    memory_ptr->reset(new GraphMemory(*item));
+    memory_ptr->reset(new GraphMemory(item));
     absl::Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
     if (!s.ok()) {
       memory_ptr->reset();
@@ -993,6 +1035,17 @@ static bool IdentifySwappingCandidates(
       return false;
     }
   }
+  return true;
+}
+
+static bool IdentifySwappingCandidates(
+    Cluster* cluster, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  if (!MaybeInferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
   const GraphMemory& memory = **memory_ptr;
 
   bool updated_graph = false;
@@ -1014,38 +1067,11 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      absl::Status s =
-          vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpCompletionTimes(cluster, *item, &op_completion_times)) {
+      return false;
     }
 
-    Costs::Duration peak_time = -1;
-    for (const auto& live_tensor : mem_usage.live_tensors) {
-      if (live_tensor.allocation_time > peak_time) {
-        peak_time = live_tensor.allocation_time;
-      }
-    }
+    const Costs::Duration peak_time = PeakTime(mem_usage);
 
     std::vector<MemInfo> mem_state;
 
@@ -1273,6 +1299,144 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// Recomputes activations that are live across the memory peak of devices whose
+// estimated peak usage exceeds `memory_budget_bytes` (or the device memory size
+// if the budget is not set). Unlike RecomputationRewritingPass, candidates are
+// not matched by name scope: the largest cheap-to-recompute tensors held
+// across the peak are picked until the estimated savings cover the excess, and
+// only their uses scheduled after the peak read the recomputed value.
+bool BudgetRecomputationPass(Cluster* cluster, int64_t memory_budget_bytes,
+                             std::unique_ptr<GraphMemory>* memory_ptr,
+                             GrapplerItem* item,
+                             std::unordered_set<string>* skip_list) {
+  if (!MaybeInferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+
+  // Maps the names of nodes to recompute to the names of the nodes which will
+  // read the recomputed value.
+  std::map<string, std::set<string>> nodes_to_recompute;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const int64_t budget = memory_budget_bytes > 0
+                               ? memory_budget_bytes
+                               : device.second.memory_size();
+    if (budget <= 0) {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - budget;
+    VLOG(1) << "Peak memory usage of " << mem_usage.used_memory
+            << " bytes exceeds the budget of " << budget << " bytes on "
+            << name;
+
+    if (op_completion_times.empty() &&
+        !EstimateOpCompletionTimes(cluster, *item, &op_completion_times)) {
+      return false;
+    }
+    const Costs::Duration peak_time = PeakTime(mem_usage);
+
+    struct Candidate {
+      int64_t memory_used;
+      string node;
+      std::set<string> late_uses;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      // RecomputeSubgraph only redirects uses of the first output.
+      if (live_tensor.memory_used <= 1024 || live_tensor.output_id != 0 ||
+          live_tensor.deallocation_time <= peak_time ||
+          skip_list->count(live_tensor.node) != 0 ||
+          nodes_to_recompute.count(live_tensor.node) != 0 ||
+          feeds.count(live_tensor.node) != 0) {
+        continue;
+      }
+      const NodeDef* node = node_map.GetNode(live_tensor.node);
+      if (node == nullptr ||
+          absl::StartsWith(node->name(), kRecomputedNodePrefix) ||
+          (cheap_to_recompute_ops.count(node->op()) == 0 &&
+           node->attr().count(kRecomputeHint) == 0)) {
+        continue;
+      }
+      Candidate candidate{live_tensor.memory_used, node->name(), {}};
+      for (const NodeDef* output : node_map.GetOutputs(node->name())) {
+        auto it = op_completion_times.find(output->name());
+        if (it == op_completion_times.end() || it->second <= peak_time) {
+          continue;
+        }
+        for (const string& input : output->input()) {
+          if (input == node->name()) {
+            candidate.late_uses.insert(output->name());
+            break;
+          }
+        }
+      }
+      if (!candidate.late_uses.empty()) {
+        candidates.push_back(std::move(candidate));
+      }
+    }
+
+    // Recompute as few tensors as possible: the largest ones first.
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return a.memory_used > b.memory_used ||
+                       (a.memory_used == b.memory_used && a.node < b.node);
+              });
+    for (Candidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      VLOG(1) << "Will recompute " << candidate.node << " of size "
+              << candidate.memory_used << " for "
+              << candidate.late_uses.size() << " uses after the peak";
+      required_savings -= candidate.memory_used;
+      nodes_to_recompute[candidate.node] = std::move(candidate.late_uses);
+    }
+  }
+  if (nodes_to_recompute.empty()) {
+    return false;
+  }
+
+  // Topological sorting invalidates NodeDef pointers, so resolve the nodes by
+  // name only afterwards.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  NodeMap sorted_node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  for (const auto& [node_name, target_names] : nodes_to_recompute) {
+    std::unordered_set<const NodeDef*> recomputed_source_nodes = {
+        sorted_node_map.GetNode(node_name)};
+    std::unordered_set<NodeDef*> target_nodes;
+    for (const string& target_name : target_names) {
+      target_nodes.insert(sorted_node_map.GetNode(target_name));
+    }
+    RecomputeSubgraph(recomputed_source_nodes, target_nodes, sorted_node_map,
+                      topological_numbering, &item->graph);
+    // Don't attempt to recompute the same node in a subsequent pass.
+    skip_list->insert(node_name);
+  }
+  return true;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1426,6 +1590,18 @@ absl::Status MemoryOptimizer::Optimize(Cluster* cluster,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      // Prefer recomputing cheap activations over swapping them out.
+      if (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+          optimization_level_ == RewriterConfig::HEURISTICS) {
+        if (BudgetRecomputationPass(cluster, memory_budget_bytes_, &memory,
+                                    &optimized_item, &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
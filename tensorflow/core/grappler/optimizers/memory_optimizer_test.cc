@@ -346,6 +346,52 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationForMemoryBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  // `b` is cheap to recompute and stays alive across the peak, which is
+  // reached while `d` and `e` are both live.
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/gpu:0"), v);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output d = ops::Concat(s.WithOpName("d").WithDevice("/gpu:0"), {c, c}, axis);
+  Output e = ops::Exp(s.WithOpName("e").WithDevice("/gpu:0"), d);
+  Output r = ops::Sum(s.WithOpName("r").WithDevice("/gpu:0"), e, axis);
+  Output f = ops::Mul(s.WithOpName("f").WithDevice("/gpu:0"), b, r);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"f"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // No name scope matches, so only the memory budget drives recomputation.
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                            "gradients/",
+                            /*memory_budget_bytes=*/1024 * 1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_b = node_map.GetNode("Recomputed/b");
+  ASSERT_NE(recomputed_b, nullptr);
+  EXPECT_EQ("Square", recomputed_b->op());
+  EXPECT_EQ("v", recomputed_b->input(0));
+  EXPECT_EQ("Recomputed/b", node_map.GetNode("f")->input(0));
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
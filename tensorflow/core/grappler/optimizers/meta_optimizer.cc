@@ -17,15 +17,19 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -35,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
@@ -46,10 +51,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -62,7 +69,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -110,6 +122,59 @@ bool IsRunOnceOptimizer(const string& name) {
          absl::StartsWith(name, "auto_mixed_precision");
 }
 
+// Groups `funcs` into waves such that every function comes after the
+// functions it calls, so callers are optimized with their callees' optimized
+// bodies. Functions within a wave don't call each other and keep their
+// relative order. Calls forming a cycle are ignored.
+std::vector<std::vector<const FunctionDef*>> GroupFunctionsByCallDepth(
+    absl::Span<const FunctionDef* const> funcs) {
+  absl::flat_hash_map<string, int> index_by_name;
+  for (int i = 0; i < funcs.size(); ++i) {
+    index_by_name[funcs[i]->signature().name()] = i;
+  }
+
+  std::vector<std::vector<int>> callees(funcs.size());
+  for (int i = 0; i < funcs.size(); ++i) {
+    auto add_callee = [&](const string& name) {
+      auto it = index_by_name.find(name);
+      if (it != index_by_name.end() && it->second != i) {
+        callees[i].push_back(it->second);
+      }
+    };
+    for (const NodeDef& node : funcs[i]->node_def()) {
+      add_callee(node.op());
+      for (const auto& attr : node.attr()) {
+        if (attr.second.has_func()) add_callee(attr.second.func().name());
+        for (const NameAttrList& func : attr.second.list().func()) {
+          add_callee(func.name());
+        }
+      }
+    }
+  }
+
+  // depth[i] is 1 + the maximum depth of the callees of funcs[i], with -1
+  // marking functions whose depth is being computed.
+  std::vector<int> depth(funcs.size(), 0);
+  std::function<int(int)> compute_depth = [&](int i) -> int {
+    if (depth[i] != 0) return std::max(depth[i], 0);
+    depth[i] = -1;
+    int result = 1;
+    for (int callee : callees[i]) {
+      result = std::max(result, compute_depth(callee) + 1);
+    }
+    depth[i] = result;
+    return result;
+  };
+
+  std::vector<std::vector<const FunctionDef*>> waves;
+  for (int i = 0; i < funcs.size(); ++i) {
+    const int wave = compute_depth(i) - 1;
+    if (waves.size() <= wave) waves.resize(wave + 1);
+    waves[wave].push_back(funcs[i]);
+  }
+  return waves;
+}
+
 // Creates a function library stub from a real function library: copy only
 // signatures and attributes of all the function defined in fdef_lib. This stub
 // can be swapped with real function library in a graph, before passing it to
@@ -198,7 +263,9 @@ absl::Status GetGraphDevice(const GraphDef& g_def,
 
 bool MetaOptimizer::LowerControlFlow() const {
   if (config_proto_.experimental().executor_type() ==
-      "SINGLE_THREADED_EXECUTOR")
+          "SINGLE_THREADED_EXECUTOR" ||
+      config_proto_.experimental().executor_type() ==
+          "STATIC_SCHEDULE_EXECUTOR")
     return false;
 
   if (config_proto_.experimental().use_tfrt()) return false;
@@ -261,6 +328,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("horizontal_fusion", "horizontal_fusion",
+         new HorizontalFusionOptimizer());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -276,6 +345,9 @@ MetaOptimizer::MetaOptimizer(DeviceBase* cpu_device, const ConfigProto& cfg)
   auto global_jit_level =
       cfg.graph_options().optimizer_options().global_jit_level();
   xla_auto_clustering_on_ = IsXlaGlobalJitOn(global_jit_level);
+  absl::Status status = ReadInt64FromEnvVar(
+      "TF_GRAPPLER_FUNCTION_LIBRARY_THREADS", 1, &function_library_threads_);
+  if (!status.ok()) LOG(WARNING) << status;
 }
 
 absl::Status MetaOptimizer::InitializeOptimizers(
@@ -474,13 +546,15 @@ absl::Status MetaOptimizer::InitializeOptimizers(
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
+      optimizers->push_back(std::make_unique<MemoryOptimizer>(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          cfg_.memory_optimization(), "gradients/",
+          cfg_.memory_optimizer_budget_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -488,6 +562,13 @@ absl::Status MetaOptimizer::InitializeOptimizers(
         std::make_unique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
 
+  if (BOTH_ARE_ON(horizontal_fusion)) {
+    optimizers->push_back(std::make_unique<HorizontalFusionOptimizer>());
+  } else if (BOTH_ARE_EXPERIMENTAL_MLIR(horizontal_fusion) ||
+             BOTH_ARE_EXPERIMENTAL_BOTH(horizontal_fusion)) {
+    VLOG(2) << "horizontal_fusion is not implemented in TFG yet";
+  }
+
 #ifndef ENABLE_MKL
   if (BOTH_ARE_ON(scoped_allocator_optimization)) {
     optimizers->push_back(std::make_unique<ScopedAllocatorOptimizer>(
@@ -642,6 +723,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(horizontal_fusion)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -697,6 +779,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("horizontal_fusion", "horizontal_fusion")
 #undef PRINT_CFG
     }
   }
@@ -731,7 +814,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
         pair.first == "pin_to_host_optimization" ||
-        pair.first == "scoped_allocator_optimization") {
+        pair.first == "scoped_allocator_optimization" ||
+        pair.first == "horizontal_fusion") {
       // These optimizers are turned off by default.
       // TODO(penporn): Remove the hard-coded length and change it to max length
       // of all option strings.
@@ -889,7 +973,10 @@ absl::Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1057,7 +1144,10 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1166,12 +1256,80 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of `func` into `optimized_func_graph`. Only reads
+  // `flib`, so it can run concurrently for independent functions.
+  auto optimize_function = [&](const FunctionDef& func,
+                               GrapplerFunctionItem* func_item,
+                               GraphDef* optimized_func_graph) -> absl::Status {
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  std::unique_ptr<thread::ThreadPool> function_thread_pool;
+  if (function_library_threads_ > 1) {
+    function_thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_library",
+        function_library_threads_);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -1194,87 +1352,75 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
-      }
+    // Sequentially, each function is optimized in library order and sees the
+    // optimized bodies of the functions before it. Concurrently, functions
+    // are optimized in waves so that callees are still optimized before
+    // their callers.
+    std::vector<std::vector<const FunctionDef*>> waves;
+    if (function_thread_pool == nullptr) {
+      for (const FunctionDef* func : funcs) waves.push_back({func});
+    } else {
+      waves = GroupFunctionsByCallDepth(funcs);
+    }
+
+    int function_idx = 0;
+    for (const auto& wave : waves) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
+      std::vector<GrapplerFunctionItem> func_items(wave.size());
+      std::vector<GraphDef> optimized_func_graphs(wave.size());
+      std::vector<absl::Status> statuses(wave.size());
+      for (const FunctionDef* func : wave) {
+        VLOG(3) << "Optimize function: function=" << func->signature().name()
+                << " [" << function_idx++ << " of "
+                << optimized_graph->library().function_size() << "]";
+      }
+      if (wave.size() == 1) {
+        statuses[0] = optimize_function(*wave[0], &func_items[0],
+                                        &optimized_func_graphs[0]);
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        BlockingCounter counter(wave.size());
+        for (int i = 0; i < wave.size(); ++i) {
+          function_thread_pool->Schedule([&, i]() {
+            statuses[i] = optimize_function(*wave[i], &func_items[i],
+                                            &optimized_func_graphs[i]);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      // Update the library in a deterministic order once the whole wave is
+      // optimized.
+      for (int i = 0; i < wave.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        const string& func_name = wave[i]->signature().name();
+
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graphs[i].library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
         }
-      }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        func_items[i].SwapFunctionBody(std::move(optimized_func_graphs[i]));
+        TF_RETURN_IF_ERROR(
+            MakeFunctionDef(func_items[i], flib, &optimized_func));
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -1323,6 +1469,7 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
 
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock lock(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -1359,6 +1506,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.horizontal_fusion() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
@@ -1371,11 +1519,24 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 absl::Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                               DeviceBase* cpu_device, Cluster* cluster,
                               GraphDef* optimized_graph) {
+  OptimizedGraphCache* cache = OptimizedGraphCache::Global();
+  string cache_key;
+  if (cache != nullptr) {
+    cache_key = OptimizedGraphCache::Key(item, cfg, cpu_device, cluster);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing cached optimized graph for grappler item: "
+              << item.id;
+      return absl::OkStatus();
+    }
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (cache != nullptr) cache->Insert(cache_key, *optimized_graph);
+  return absl::OkStatus();
 }
 
 absl::Status OptimizeGraph(
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -101,6 +103,10 @@ class MetaOptimizer : public GraphOptimizer {
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
   bool xla_auto_clustering_on_;
+  // Number of threads used to optimize independent functions of the function
+  // library concurrently. Read from TF_GRAPPLER_FUNCTION_LIBRARY_THREADS; 1
+  // optimizes them sequentially.
+  int64_t function_library_threads_ = 1;
 
   struct OptimizerResult {
     string optimizer_name;
@@ -119,7 +125,9 @@ class MetaOptimizer : public GraphOptimizer {
                             GraphDef* optimized_graph,
                             GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  mutable mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      TF_GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
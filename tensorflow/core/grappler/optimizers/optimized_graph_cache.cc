@@ -0,0 +1,197 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+auto* optimized_graph_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler/optimized_graph_cache_lookups",
+    "The number of lookups in the process-wide cache of graphs optimized by "
+    "the meta optimizer, by result (memory_hit, disk_hit or miss).",
+    "result");
+
+// Appends `field` prefixed by its length, so that the concatenation of fields
+// is unambiguous.
+void AppendField(absl::string_view field, std::string* out) {
+  absl::StrAppend(out, field.size(), ":", field);
+}
+
+void AppendProto(const protobuf::MessageLite& proto, std::string* out) {
+  std::string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, out);
+}
+
+void AppendList(const std::vector<std::string>& list, std::string* out) {
+  absl::StrAppend(out, list.size(), ":");
+  for (const std::string& element : list) AppendField(element, out);
+}
+
+}  // namespace
+
+OptimizedGraphCache::OptimizedGraphCache(int64_t capacity, std::string dir)
+    : capacity_(capacity), dir_(std::move(dir)) {}
+
+OptimizedGraphCache* OptimizedGraphCache::Global() {
+  static OptimizedGraphCache* const cache = []() -> OptimizedGraphCache* {
+    int64_t capacity = 0;
+    std::string dir;
+    absl::Status status = ReadInt64FromEnvVar(
+        "TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_SIZE", 0, &capacity);
+    if (!status.ok()) LOG(WARNING) << status;
+    status =
+        ReadStringFromEnvVar("TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_DIR", "", &dir);
+    if (!status.ok()) LOG(WARNING) << status;
+    if (capacity <= 0 && dir.empty()) return nullptr;
+    if (!dir.empty()) {
+      status = Env::Default()->RecursivelyCreateDir(dir);
+      if (!status.ok()) {
+        LOG(WARNING) << "Not persisting optimized graphs to " << dir << ": "
+                     << status;
+        dir.clear();
+      }
+    }
+    return new OptimizedGraphCache(capacity, std::move(dir));
+  }();
+  return cache;
+}
+
+std::string OptimizedGraphCache::Key(const GrapplerItem& item,
+                                     const ConfigProto& cfg,
+                                     const DeviceBase* cpu_device,
+                                     const Cluster* cluster) {
+  std::string serialized;
+  SerializeToStringDeterministic(item.graph, &serialized);
+  const Fprint128 graph_fingerprint = Fingerprint128(serialized);
+
+  // Everything other than the graph is small, so fingerprint it at once.
+  serialized.clear();
+  AppendProto(cfg, &serialized);
+  const auto& options = item.optimization_options();
+  absl::StrAppend(&serialized, options.allow_non_differentiable_rewrites,
+                  options.allow_pruning_stateful_and_dataset_ops,
+                  options.optimize_function_library, options.is_eager_mode,
+                  ":", options.intra_op_parallelism_threads, ":");
+  AppendList(item.fetch, &serialized);
+  AppendList(item.keep_ops, &serialized);
+  AppendList(item.init_ops, &serialized);
+  absl::StrAppend(&serialized, item.feed.size(), ":");
+  for (const auto& [name, tensor] : item.feed) {
+    AppendField(name, &serialized);
+    TensorProto tensor_proto;
+    tensor.AsProtoTensorContent(&tensor_proto);
+    AppendProto(tensor_proto, &serialized);
+  }
+  std::vector<std::string> devices(item.devices().begin(),
+                                   item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  AppendList(devices, &serialized);
+  AppendField(cpu_device != nullptr ? cpu_device->name() : "", &serialized);
+  if (cluster != nullptr) {
+    std::map<std::string, DeviceProperties> cluster_devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    absl::StrAppend(&serialized, cluster_devices.size(), ":");
+    for (const auto& [name, properties] : cluster_devices) {
+      AppendField(name, &serialized);
+      AppendProto(properties, &serialized);
+    }
+  }
+
+  const Fprint128 fingerprint =
+      tsl::FingerprintCat128(graph_fingerprint, Fingerprint128(serialized));
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool OptimizedGraphCache::Lookup(const std::string& key, GraphDef* graph) {
+  {
+    mutex_lock lock(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      *graph = *it->second;
+      optimized_graph_cache_lookups->GetCell("memory_hit")->IncrementBy(1);
+      return true;
+    }
+  }
+  if (!dir_.empty()) {
+    auto cached = std::make_shared<GraphDef>();
+    const std::string path = FilePath(key);
+    if (Env::Default()->FileExists(path).ok() &&
+        ReadBinaryProto(Env::Default(), path, cached.get()).ok()) {
+      *graph = *cached;
+      InsertInMemory(key, std::move(cached));
+      optimized_graph_cache_lookups->GetCell("disk_hit")->IncrementBy(1);
+      return true;
+    }
+  }
+  optimized_graph_cache_lookups->GetCell("miss")->IncrementBy(1);
+  return false;
+}
+
+void OptimizedGraphCache::Insert(const std::string& key,
+                                 const GraphDef& graph) {
+  if (!dir_.empty()) {
+    // Write to a temporary file first so that concurrent readers never see a
+    // partially written graph.
+    const std::string path = FilePath(key);
+    const std::string tmp_path =
+        absl::StrCat(path, ".", Env::Default()->NowMicros(), ".tmp");
+    absl::Status status = WriteBinaryProto(Env::Default(), tmp_path, graph);
+    if (status.ok()) status = Env::Default()->RenameFile(tmp_path, path);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to persist optimized graph " << key << ": " << status;
+    }
+  }
+  InsertInMemory(key, std::make_shared<GraphDef>(graph));
+}
+
+std::string OptimizedGraphCache::FilePath(const std::string& key) const {
+  return io::JoinPath(dir_, absl::StrCat(key, ".pb"));
+}
+
+void OptimizedGraphCache::InsertInMemory(
+    const std::string& key, std::shared_ptr<const GraphDef> graph) {
+  if (capacity_ <= 0) return;
+  mutex_lock lock(mu_);
+  if (!entries_.emplace(key, std::move(graph)).second) return;
+  insertion_order_.push_back(key);
+  while (static_cast<int64_t>(insertion_order_.size()) > capacity_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A cache of meta optimizer results, keyed by a fingerprint of everything the
+// optimization depends on. Entries are kept in memory, evicted oldest first,
+// and optionally persisted to a directory so that they can be reused across
+// processes.
+class OptimizedGraphCache {
+ public:
+  // Keeps at most `capacity` graphs in memory (none if `capacity` <= 0) and
+  // persists all inserted graphs to `dir` unless it is empty.
+  OptimizedGraphCache(int64_t capacity, std::string dir);
+
+  // Returns the process-wide cache configured by
+  // TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_SIZE and
+  // TF_GRAPPLER_OPTIMIZED_GRAPH_CACHE_DIR, or nullptr if neither is set.
+  static OptimizedGraphCache* Global();
+
+  // Returns the cache key for optimizing `item` with the given arguments. The
+  // key only depends on the deterministic serialization of its inputs, so it
+  // is stable across processes.
+  static std::string Key(const GrapplerItem& item, const ConfigProto& cfg,
+                         const DeviceBase* cpu_device, const Cluster* cluster);
+
+  // Copies the cached result for `key` into `graph` and returns true, or
+  // returns false on a miss.
+  bool Lookup(const std::string& key, GraphDef* graph);
+
+  void Insert(const std::string& key, const GraphDef& graph);
+
+ private:
+  std::string FilePath(const std::string& key) const;
+
+  void InsertInMemory(const std::string& key,
+                      std::shared_ptr<const GraphDef> graph);
+
+  const int64_t capacity_;
+  const std::string dir_;
+
+  mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const GraphDef>> entries_
+      TF_GUARDED_BY(mu_);
+  // Keys in insertion order, oldest first, for FIFO eviction.
+  std::deque<std::string> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
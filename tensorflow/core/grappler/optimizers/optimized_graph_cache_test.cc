@@ -0,0 +1,126 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <string>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem MakeItem() {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {2});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {2});
+  Output c = ops::Add(s.WithOpName("c"), a, b);
+  GrapplerItem item;
+  item.fetch = {"c"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  return item;
+}
+
+GraphDef MakeOptimizedGraph(const string& name) {
+  GraphDef graph;
+  graph.add_node()->set_name(name);
+  return graph;
+}
+
+string TestDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(dir));
+  return dir;
+}
+
+TEST(OptimizedGraphCacheTest, KeyDependsOnItemAndConfig) {
+  ConfigProto config;
+  GrapplerItem item = MakeItem();
+  item.feed.emplace_back("a", test::AsTensor<float>({3.0f, 4.0f}));
+  const string key = OptimizedGraphCache::Key(item, config, nullptr, nullptr);
+
+  // Rebuilding the same item yields the same key.
+  GrapplerItem same_item = MakeItem();
+  same_item.feed.emplace_back("a", test::AsTensor<float>({3.0f, 4.0f}));
+  EXPECT_EQ(key,
+            OptimizedGraphCache::Key(same_item, config, nullptr, nullptr));
+
+  GrapplerItem other_fetch = same_item;
+  other_fetch.fetch = {"a"};
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(other_fetch, config, nullptr, nullptr));
+
+  GrapplerItem other_feed = MakeItem();
+  other_feed.feed.emplace_back("a", test::AsTensor<float>({3.0f, 5.0f}));
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(other_feed, config, nullptr, nullptr));
+
+  ConfigProto other_config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_remapping(RewriterConfig::OFF);
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(item, other_config, nullptr, nullptr));
+}
+
+TEST(OptimizedGraphCacheTest, LookupHitsInsertedGraph) {
+  OptimizedGraphCache cache(/*capacity=*/2, /*dir=*/"");
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+
+  cache.Insert("key", MakeOptimizedGraph("optimized"));
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  ASSERT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(graph.node(0).name(), "optimized");
+  EXPECT_FALSE(cache.Lookup("other_key", &graph));
+}
+
+TEST(OptimizedGraphCacheTest, EvictsOldestEntry) {
+  OptimizedGraphCache cache(/*capacity=*/1, /*dir=*/"");
+  cache.Insert("first", MakeOptimizedGraph("first"));
+  cache.Insert("second", MakeOptimizedGraph("second"));
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("first", &graph));
+  ASSERT_TRUE(cache.Lookup("second", &graph));
+  EXPECT_EQ(graph.node(0).name(), "second");
+}
+
+TEST(OptimizedGraphCacheTest, PersistsGraphsToDisk) {
+  const string dir = TestDir("persists_graphs_to_disk");
+  {
+    // Nothing is kept in memory, so only the persisted copy can be found.
+    OptimizedGraphCache cache(/*capacity=*/0, dir);
+    cache.Insert("key", MakeOptimizedGraph("optimized"));
+  }
+  OptimizedGraphCache cache(/*capacity=*/0, dir);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  ASSERT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(graph.node(0).name(), "optimized");
+  EXPECT_FALSE(cache.Lookup("other_key", &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
@@ -294,6 +295,37 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
   // We couldn't find an appropriate Host device, return no device.
   return "";
 }
+
+// Returns how many host<->device copies are saved by moving `node`, which was
+// swapped to Host, back to its original `device`.
+int CopiesSavedByRevertingToDevice(const GraphView& graph, NodeDef& node,
+                                   const string& device) {
+  // On Host, every consumer that reads the output from device memory needs a
+  // copy.
+  int copies_on_host = 0;
+  for (const GraphView::InputPort& fanout : graph.GetFanouts(node, false)) {
+    if (!IsNodeInputPortHostFriendly(*fanout.node, fanout.port_id)) {
+      ++copies_on_host;
+    }
+  }
+  if (copies_on_host == 0) return 0;
+
+  // On the device, every input produced on Host needs a copy, unless the
+  // kernel reads it from Host memory.
+  string host_device = node.device();
+  node.set_device(device);
+  int copies_on_device = 0;
+  for (int i = 0; i < node.input_size(); ++i) {
+    if (IsControlInput(node.input(i))) break;
+    const NodeDef* fanin = graph.GetNode(NodeName(node.input(i)));
+    if (fanin != nullptr && absl::StrContains(fanin->device(), DEVICE_CPU) &&
+        !IsNodeInputPortHostFriendly(node, i)) {
+      ++copies_on_device;
+    }
+  }
+  node.set_device(std::move(host_device));
+  return copies_on_host - copies_on_device;
+}
 }  // end namespace internal
 
 absl::Status PinToHostOptimizer::Optimize(Cluster* cluster,
@@ -323,8 +355,8 @@ absl::Status PinToHostOptimizer::Optimize(Cluster* cluster,
   // will help us discover producer->consumer chains of Host ops.
   TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
 
-  // All the Const nodes, and their original devices in topological order.
-  std::vector<std::pair<NodeDef*, string>> const_nodes;
+  // All the nodes we swapped, and their original devices in topological order.
+  std::vector<std::pair<NodeDef*, string>> swapped_nodes;
 
   for (auto& node : *optimized_graph->mutable_node()) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -338,32 +370,23 @@ absl::Status PinToHostOptimizer::Optimize(Cluster* cluster,
     string device =
         internal::TryFindHostDevice(devices, has_device_cpu, node.device());
     if (!device.empty()) {
-      // Keep track of all Const nodes that we swapped.
-      if (IsConstant(node)) {
-        const_nodes.emplace_back(&node, node.device());
-      }
+      swapped_nodes.emplace_back(&node, node.device());
       VLOG(2) << "Moving node " << node.name() << " to device " << device;
       *node.mutable_device() = std::move(device);
     }
   }
 
-  // Traverse all `const_nodes`, and map them back to GPU greedily.
-  for (auto& it : const_nodes) {
+  // Traverse the swapped nodes in reverse topological order, so that consumers
+  // are settled before their producers, and map a node back to its original
+  // device when that takes fewer host<->device copies than keeping it on Host.
+  for (auto it = swapped_nodes.rbegin(); it != swapped_nodes.rend(); ++it) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-    NodeDef* node = it.first;
-    const string& device = it.second;
-
-    // Check all the consumers of this node, if any of them are not on CPU, swap
-    // this node back onto the original device.
-    for (const GraphView::InputPort& fanout : graph.GetFanouts(*node, false)) {
-      // The consumer is not Host friendly, swap it back to the original device.
-      if (!internal::IsNodeInputPortHostFriendly(*fanout.node,
-                                                 fanout.port_id)) {
-        VLOG(2) << "Swapping node " << node->name() << " back to device "
-                << device;
-        node->set_device(device);
-        break;
-      }
+    NodeDef* node = it->first;
+    const string& device = it->second;
+    if (internal::CopiesSavedByRevertingToDevice(graph, *node, device) > 0) {
+      VLOG(2) << "Swapping node " << node->name() << " back to device "
+              << device;
+      node->set_device(device);
     }
   }
   return absl::OkStatus();
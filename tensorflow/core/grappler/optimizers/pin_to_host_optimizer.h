@@ -33,9 +33,10 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
 // Optimize TensorFlow ops that should be swapped into the CPU to avoid
 // excessive cpu<->gpu memcpy/sync.
 //
-// TODO(williamchan): The current heuristic will swap any small integer Const to
-// CPU. This may cause a problem cpu->cpu->gpu wherein the original behaviour of
-// gpu->gpu->gpu may have been better/faster. We should probably fix this.
+// Small ops are first swapped to the CPU greedily. A swapped node is then moved
+// back to its original device if that needs fewer host<->device copies, e.g.
+// cpu->cpu->gpu is turned back into gpu->gpu->gpu when the consumers read the
+// tensor from device memory.
 class PinToHostOptimizer : public GraphOptimizer {
  public:
   PinToHostOptimizer() {}
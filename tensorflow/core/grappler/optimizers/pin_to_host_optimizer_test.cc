@@ -235,6 +235,42 @@ TEST_F(PinToHostOptimizerTest, Identity) {
   EXPECT_EQ(found, 5);
 }
 
+TEST_F(PinToHostOptimizerTest, RevertWhenHostAddsCopies) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  // `b` has one input from Host but two consumers that read it from device
+  // memory, so keeping it on Host would take more copies than reverting it.
+  Output a = ops::Const(s.WithOpName("a"), 3);
+  Output b = ops::Negate(s.WithOpName("b"), a);
+  Output dims = ops::Const(s.WithOpName("dims"), {64, 64});
+  Output c = ops::Fill(s.WithOpName("c"), dims, b);
+  Output d = ops::Fill(s.WithOpName("d"), dims, b);
+
+  GrapplerItem item;
+  item.fetch = {"c", "d"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  GraphDef output;
+  PinToHostOptimizer optimizer(RewriterConfig::ON);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<int32>(tensors[i], tensors_expected[i]);
+  }
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "b" || node.name() == "c" || node.name() == "d") {
+      EXPECT_TRUE(node.device().empty());
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
 TEST_F(PinToHostOptimizerTest, PortIdToArgId) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::Const(s.WithOpName("a"), 1, {1, 2, 3});
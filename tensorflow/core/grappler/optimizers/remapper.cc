@@ -170,6 +170,17 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Gather of embedding rows followed by a SparseSegment{Sum,Mean,SqrtN}
+// reduction, which can read the rows directly from the gathered table instead.
+struct GatherWithSparseSegmentReduction {
+  GatherWithSparseSegmentReduction() = default;
+  GatherWithSparseSegmentReduction(int gather, int reduction)
+      : gather(gather), reduction(reduction) {}
+
+  int gather = kMissingIndex;
+  int reduction = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -762,6 +773,19 @@ void AddInputShapesAttr(const RemapperContext& ctx, int node_index) {
   }
 }
 
+// Marks Conv2D and MatMul nodes whose filter or weights are produced by a
+// Const node, so that the CPU kernels may cache transformed copies of them
+// across steps.
+void AddConstWeightsAttr(const RemapperContext& ctx, int node_index) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  if (node_view->NumRegularFanins() < 2) return;
+  const auto* weights = node_view->GetRegularFanin(1).node_view();
+  if (!IsConstant(*weights->node())) return;
+
+  auto mutable_node = ctx.graph_view.graph()->mutable_node(node_index);
+  (*mutable_node->mutable_attr())["_grappler_const_weights"].set_b(true);
+}
+
 bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
                              ContractionWithBiasAdd* matched,
                              bool check_device_compatible = true) {
@@ -2746,6 +2770,75 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns true if `node_view` is a Gather or a GatherV2 along axis 0 without
+// batch dimensions, whose indices are a vector.
+bool IsRowGather(const RemapperContext& ctx,
+                 const utils::MutableNodeView& node_view) {
+  const auto* node_def = node_view.node();
+  if (node_def->op() != "Gather" && node_def->op() != "GatherV2") return false;
+  if (node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (node_view.NumRegularFanins() < 3) return false;
+    const auto* axis_def = node_view.GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (axis_def->op() != "Const" ||
+        !axis.FromProto(axis_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1 ||
+        (axis.dtype() != DT_INT32 && axis.dtype() != DT_INT64)) {
+      return false;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  const DataType indices_dtype = GetDataTypeFromAttr(*node_def, "Tindices");
+  if (indices_dtype != DT_INT32 && indices_dtype != DT_INT64) return false;
+
+  const auto& props = ctx.graph_properties.GetInputProperties(node_def->name());
+  return props.size() >= 2 && !props[1].shape().unknown_rank() &&
+         props[1].shape().dim_size() == 1;
+}
+
+// clang-format off
+// Embedding lookup pattern
+//       params    ids
+//           \     /
+//       Gather{V2}    indices   segment_ids
+//                \       |       /
+//          SparseSegment{Sum,Mean,SqrtN}[WithNumSegments]
+// clang-format on
+bool FindGatherWithSparseSegmentReduction(
+    const RemapperContext& ctx, int node_index,
+    GatherWithSparseSegmentReduction* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSparseSegmentReduction(*node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  const auto& data_fanin = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = data_fanin.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if (data_fanin.index() != 0 || HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def) ||
+      !IsRowGather(ctx, *gather_node_view)) {
+    return false;
+  }
+
+  *matched = GatherWithSparseSegmentReduction(gather_node_view->node_index(),
+                                              node_index);
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -4377,6 +4470,48 @@ absl::Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+absl::Status AddSparseSegmentReductionOnParams(
+    RemapperContext* ctx, const GatherWithSparseSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& reduction = graph->node(matched.reduction);
+  VLOG(2) << "Fuse " << gather.op() << " with " << reduction.op()
+          << ": gather=" << gather.name() << " reduction=" << reduction.name();
+
+  // reduction(gather(params, ids), indices) only reads the rows
+  // params[ids[indices]], so it is computed from the table directly once the
+  // indices are composed, without materializing the [nnz, dim] gather output.
+  NodeDef composed_indices;
+  composed_indices.set_name(
+      absl::StrCat(reduction.name(), "/composed_indices"));
+  composed_indices.set_op("Gather");
+  composed_indices.set_device(reduction.device());
+  composed_indices.add_input(gather.input(1));     // params: ids
+  composed_indices.add_input(reduction.input(1));  // indices
+  auto* indices_attr = composed_indices.mutable_attr();
+  (*indices_attr)["Tparams"] = gather.attr().at("Tindices");
+  (*indices_attr)["Tindices"] = reduction.attr().at("Tidx");
+
+  NodeDef fused_op = reduction;
+  fused_op.set_input(0, gather.input(0));  // data: params
+  fused_op.set_input(1, composed_indices.name());
+  (*fused_op.mutable_attr())["Tidx"] = gather.attr().at("Tindices");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(composed_indices), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return absl::OkStatus();
+}
+
 absl::Status AddFusedBatchMatMul(RemapperContext* ctx,
                                  const std::map<string, int>& matched_nodes_map,
                                  const std::set<int>& remove_node_indices,
@@ -4850,17 +4985,28 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a Gather + SparseSegment reduction fusion, which needs the
+  // rank of the gather indices.
+  const auto is_gather_sparse_segment_candidate = [&]() -> bool {
+    if (!IsSparseSegmentReduction(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto* data_node_def =
+        node_view->GetRegularFanin(0).node_view()->node();
+    return data_node_def->op() == "Gather" || data_node_def->op() == "GatherV2";
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) || is_gather_sparse_segment_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_gather_sparse_segment_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -4934,6 +5080,10 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
         IsMatMul(ctx.graph_view.graph()->node(i))) {
       AddInputShapesAttr(ctx, i);
     }
+    if (IsConv2D(ctx.graph_view.graph()->node(i)) ||
+        IsMatMul(ctx.graph_view.graph()->node(i))) {
+      AddConstWeightsAttr(ctx, i);
+    }
 
     if (IsMKLEnabled() && !ctx.xla_cpu_jit_disable_fusion) {
       const auto* node_view = ctx.graph_view.GetNode(i);
@@ -5223,6 +5373,15 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Gather+SparseSegment{Sum,Mean,SqrtN} into a reduction that reads
+    // the rows from the embedding table directly.
+    GatherWithSparseSegmentReduction gather_with_reduction;
+    if (FindGatherWithSparseSegmentReduction(ctx, i, &gather_with_reduction)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentReductionOnParams(
+          &ctx, gather_with_reduction, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
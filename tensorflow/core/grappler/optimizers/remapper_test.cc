@@ -1767,6 +1767,78 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+class RemapperGatherWithSparseSegmentReductionTest : public RemapperTest {
+ public:
+  template <typename Reduction>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                              ops::Placeholder::Shape({10, 4}));
+    auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                           ops::Placeholder::Shape({6}));
+    auto axis = ops::Const(s.WithOpName("axis"), 0);
+    auto gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+    auto indices =
+        ops::Const(s.WithOpName("indices"), {0LL, 2LL, 3LL, 5LL}, {4});
+    auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1});
+    auto reduction =
+        Reduction(s.WithOpName("reduction"), gather, indices, segment_ids);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+
+    auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 4});
+    auto ids_t = test::AsTensor<int32>({9, 1, 4, 4, 0, 7});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"params", params_t}, {"ids", ids_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "gather");
+      if (node.name() == "reduction") {
+        ASSERT_GE(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "params");
+        EXPECT_EQ(node.input(1), "reduction/composed_indices");
+        EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT32);
+        found++;
+      } else if (node.name() == "reduction/composed_indices") {
+        EXPECT_EQ(node.op(), "Gather");
+        ASSERT_EQ(node.input_size(), 2);
+        EXPECT_EQ(node.input(0), "ids");
+        EXPECT_EQ(node.input(1), "indices");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 2);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperGatherWithSparseSegmentReductionTest, Sum) {
+  RunTest<ops::SparseSegmentSum>();
+}
+
+TEST_F(RemapperGatherWithSparseSegmentReductionTest, Mean) {
+  RunTest<ops::SparseSegmentMean>();
+}
+
+TEST_F(RemapperGatherWithSparseSegmentReductionTest, SqrtN) {
+  RunTest<ops::SparseSegmentSqrtN>();
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -3108,5 +3180,40 @@ class XlaCpuJitDisableFusionTest : public RemapperTest {
 TEST_F(XlaCpuJitDisableFusionTest, MatMulWithBias) { RunTest<DT_FLOAT>(); }
 #endif  // !(DNNL_AARCH64_USE_ACL || GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 
+TEST_F(RemapperTest, MarksConstWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto input = ops::Placeholder(s.WithOpName("input"), DT_FLOAT,
+                                ops::Placeholder::Shape({1, 4, 4, 2}));
+  auto filter = ops::Const(s.WithOpName("filter"), 1.0f, {1, 1, 2, 2});
+  auto conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                          "SAME");
+  auto lhs = ops::Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 2}));
+  auto rhs = ops::Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 2}));
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+
+  GrapplerItem item;
+  item.fetch = {"conv", "matmul"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "conv") {
+      ASSERT_EQ(node.attr().count("_grappler_const_weights"), 1);
+      EXPECT_TRUE(node.attr().at("_grappler_const_weights").b());
+      found++;
+    } else if (node.name() == "matmul") {
+      EXPECT_EQ(node.attr().count("_grappler_const_weights"), 0);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
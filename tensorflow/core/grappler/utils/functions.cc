@@ -415,6 +415,36 @@ absl::Status RemoveFunctionOutputs(
   return absl::OkStatus();
 }
 
+absl::Status AppendPassThroughArgument(const string& arg_name, DataType dtype,
+                                       GrapplerFunctionItem* item) {
+  const string retval_name = absl::StrCat(arg_name, "_out_RetVal");
+  for (const NodeDef& node : item->graph.node()) {
+    if (node.name() == arg_name || node.name() == retval_name) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Function body already has a node named ", node.name()));
+    }
+  }
+
+  NodeDef* arg = item->graph.add_node();
+  arg->set_name(arg_name);
+  arg->set_op("_Arg");
+  (*arg->mutable_attr())["T"].set_type(dtype);
+  (*arg->mutable_attr())["index"].set_i(item->input_size());
+
+  NodeDef* retval = item->graph.add_node();
+  retval->set_name(retval_name);
+  retval->set_op("_Retval");
+  retval->add_input(arg_name);
+  (*retval->mutable_attr())["T"].set_type(dtype);
+  (*retval->mutable_attr())["index"].set_i(item->output_size());
+
+  item->input_args_.emplace_back(arg_name, dtype);
+  item->output_args_.emplace_back(retval_name, dtype);
+  item->feed.push_back({arg_name, Tensor()});
+  item->fetch.push_back(retval_name);
+  return absl::OkStatus();
+}
+
 namespace {
 
 // FunctionDef uses different connectivity encoding for the function body nodes,
@@ -97,6 +97,8 @@ class GrapplerFunctionItem : public GrapplerItem {
   friend absl::Status RemoveFunctionOutputs(const absl::flat_hash_set<int>&,
                                             GrapplerFunctionItem*,
                                             std::vector<std::pair<int, int>>*);
+  friend absl::Status AppendPassThroughArgument(const string&, DataType,
+                                                GrapplerFunctionItem*);
 
   GrapplerFunctionItem(string func_name, string description,
                        AttrSlice func_attr,
@@ -159,6 +161,12 @@ absl::Status RemoveFunctionOutputs(
 
 // TODO(ezhulenev, b/120103818): Add RemoveFunctionInputs.
 
+// Appends an input of type `dtype` to the instantiated grappler function item,
+// named `arg_name`, and an output that returns it unchanged. This is the shape
+// of a new loop variable of a functional While body.
+absl::Status AppendPassThroughArgument(const string& arg_name, DataType dtype,
+                                       GrapplerFunctionItem* item);
+
 // Make a GrapplerFunctionItem from the function definition and function
 // instantiation attributes (caller node attributes). Returns error if the given
 // function def cannot be converted (e.g. not all attributes are defined).
@@ -650,6 +650,41 @@ TEST_F(FunctionsTest, ReplaceInputWithConst) {
   EXPECT_EQ(3, count);
 }
 
+TEST_F(FunctionsTest, AppendPassThroughArgument) {
+  FunctionDef func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"output"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /* Mapping between function returns and function node outputs. */
+      {{"z", "output:z:0"}});
+
+  protobuf::Map<string, AttrValue> func_instantiation_attr;
+  func_instantiation_attr["T"].set_type(DT_FLOAT);
+  FunctionLibraryDefinition flib(OpRegistry::Global(), FunctionDefLibrary());
+
+  GrapplerFunctionItem item;
+  TF_EXPECT_OK(MakeGrapplerFunctionItem(func,
+                                        AttrSlice(&func_instantiation_attr),
+                                        flib, TF_GRAPH_DEF_VERSION, &item));
+
+  TF_EXPECT_OK(AppendPassThroughArgument("extra", DT_INT32, &item));
+  EXPECT_FALSE(AppendPassThroughArgument("x", DT_INT32, &item).ok());
+
+  ASSERT_EQ(3, item.input_size());
+  ASSERT_EQ(2, item.output_size());
+  EXPECT_EQ("extra", item.input(2).node_name);
+  EXPECT_EQ(DT_INT32, item.input(2).data_type);
+  EXPECT_EQ("extra_out_RetVal", item.output(1).node_name);
+
+  FunctionDef specialized;
+  TF_EXPECT_OK(MakeFunctionDef(item, flib, &specialized));
+  ASSERT_EQ(3, specialized.signature().input_arg_size());
+  ASSERT_EQ(2, specialized.signature().output_arg_size());
+  EXPECT_EQ("extra", specialized.signature().input_arg(2).name());
+  EXPECT_EQ(DT_INT32, specialized.signature().input_arg(2).type());
+  EXPECT_EQ("extra_out", specialized.signature().output_arg(1).name());
+  EXPECT_EQ("extra", specialized.ret().at("extra_out"));
+}
+
 TEST_F(FunctionsTest, SwapFunctionBodyAndMakeFunctionDef) {
   using ::tensorflow::test::function::NDef;
 
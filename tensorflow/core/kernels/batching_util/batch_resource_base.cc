@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
@@ -50,7 +52,7 @@ limitations under the License.
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
-#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
 #include "tensorflow/core/kernels/batching_util/batch_stats.h"
@@ -225,6 +227,50 @@ void RecordBatchTaskSizeSum(int32_t batch_task_size,
   cell->GetCell(model_name, op_name, "false")->IncrementBy(unbatched_task_size);
 }
 
+void RecordSequencePaddingFraction(double padding_fraction,
+                                   const string& model_name,
+                                   const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/sequence_padding_fraction",
+       "Tracks the fraction of each task's sequence dimension that is padding "
+       "added to reach its sequence length bucket.",
+       "model_name", "op_name"},
+      monitoring::Buckets::Explicit(
+          {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9}));
+  cell->GetCell(model_name, op_name)->Add(padding_fraction);
+}
+
+// Pads (with zeros) or truncates dimension 1 of `tensor` to `length`. The
+// tensor's dtype must be memcpy-able.
+absl::Status ResizeSequenceDimension(OpKernelContext* context, int64_t length,
+                                     Tensor* tensor) {
+  if (tensor->dim_size(1) == length) return absl::OkStatus();
+  TensorShape resized_shape = tensor->shape();
+  resized_shape.set_dim(1, length);
+  Tensor resized;
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(tensor->dtype(), resized_shape, &resized));
+  const int64_t num_rows = tensor->dim_size(0);
+  if (num_rows > 0) {
+    // Both tensors are row-major, so each slice along dimension 0 of the
+    // shorter tensor is a prefix of the corresponding slice of the longer one.
+    const size_t row_bytes = tensor->TotalBytes() / num_rows;
+    const size_t resized_row_bytes = resized.TotalBytes() / num_rows;
+    const size_t copied_bytes = std::min(row_bytes, resized_row_bytes);
+    const char* src = tensor->tensor_data().data();
+    char* dst = const_cast<char*>(resized.tensor_data().data());
+    if (resized_row_bytes > row_bytes) {
+      memset(dst, 0, resized.TotalBytes());
+    }
+    for (int64_t row = 0; row < num_rows; ++row) {
+      memcpy(dst + row * resized_row_bytes, src + row * row_bytes,
+             copied_bytes);
+    }
+  }
+  *tensor = std::move(resized);
+  return absl::OkStatus();
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -274,6 +320,16 @@ void RecordBatchParamAllowedBatchSizes(const string& allowed_batch_sizes,
   cell->GetCell(model_name, op_name)->Set(allowed_batch_sizes);
 }
 
+void RecordWarmedUpBatchSize(int32_t batch_size, const string& model_name,
+                             const string& op_name) {
+  static auto* cell = monitoring::Gauge<bool, 3>::New(
+      "/tensorflow/serving/batching/warmed_up_batch_size",
+      "Tracks which allowed batch sizes have successfully run a warmup batch, "
+      "and hence have their executables compiled and autotuned.",
+      "model_name", "op_name", "batch_size");
+  cell->GetCell(model_name, op_name, absl::StrCat(batch_size))->Set(true);
+}
+
 void RecordBatchCosts(const std::string& model_name,
                       const int64_t processed_size,
                       const absl::string_view cost_type,
@@ -329,6 +385,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
   task->forced_warmup_batch_size = this->forced_warmup_batch_size;
+  task->unpadded_sequence_length = this->unpadded_sequence_length;
 
   return task;
 }
@@ -495,9 +552,16 @@ absl::Status BatchResourceBase::RegisterInput(
     batch_components->request_cost = request_cost_accessor->GetRequestCost();
   }
 
+  string queue_name = batcher_queue_name;
+  if (!sequence_length_buckets_.empty()) {
+    TF_ASSIGN_OR_RETURN(queue_name,
+                        AssignSequenceLengthBucket(context, batcher_queue_name,
+                                                   batch_components.get()));
+  }
+
   BatcherQueueT* batcher_queue;
   TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
-      /* queue_name= */ batcher_queue_name,
+      /* queue_name= */ queue_name,
       /* model_name= */ GetModelName(context),
       /* op_name= */ context->op_kernel().name(), /* queue= */ &batcher_queue));
 
@@ -767,9 +831,15 @@ absl::Status BatchResourceBase::ConcatInputTensors(
     }
 
     Tensor concatenated_tensor;
-    absl::Status concat_status =
-        Concat(context, to_concatenate, &concatenated_tensor);
-    TF_RETURN_IF_ERROR(concat_status);
+    if (to_concatenate.size() == 1) {
+      // A lone unpadded task already is the batch; hand its input to the
+      // batch function as is instead of copying it.
+      concatenated_tensor = to_concatenate[0];
+    } else {
+      absl::Status concat_status =
+          Concat(context, to_concatenate, &concatenated_tensor);
+      TF_RETURN_IF_ERROR(concat_status);
+    }
     concatenated_tensors->push_back(concatenated_tensor);
   }
   return absl::OkStatus();
@@ -928,9 +998,14 @@ absl::Status BatchResourceBase::SplitOutputTensors(
           "; padding size: ", padding_size);
     }
 
+    // Returns each task an aliased sub-slice of the batched output when the
+    // slices are suitably aligned, which avoids copying the output back out;
+    // the slices keep the whole batched output alive until the last task's
+    // output is released. Falls back to a copy otherwise.
     std::vector<Tensor> split_tensor;
-    const absl::Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    const absl::Status split_status =
+        Split(batch->task(0).context, output_tensor,
+              task_sizes_plus_optional_padding, &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -944,6 +1019,19 @@ absl::Status BatchResourceBase::SplitOutputTensors(
           task_sizes_plus_optional_padding.size());
     }
 
+    // Slice sequence outputs back from the bucket bound to the length of each
+    // task's own sequence inputs.
+    if (absl::c_linear_search(sequence_output_indices_, i)) {
+      for (int j = 0; j < batch->num_tasks(); ++j) {
+        TF_RETURN_IF_ERROR(SliceSequenceOutput(batch->task(j),
+                                               &split_tensor[j]));
+      }
+      for (int j = 0; j < unbatched_tasks.size(); ++j) {
+        TF_RETURN_IF_ERROR(SliceSequenceOutput(
+            *unbatched_tasks[j], &split_tensor[batch->num_tasks() + j]));
+      }
+    }
+
     // Ignore a possible final split_tensors entry containing the padding.
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
@@ -965,6 +1053,21 @@ absl::Status BatchResourceBase::SplitOutputTensors(
   return absl::OkStatus();
 }
 
+absl::Status BatchResourceBase::SliceSequenceOutput(const BatchTask& task,
+                                                    Tensor* output) const {
+  if (task.unpadded_sequence_length < 0) return absl::OkStatus();
+  if (output->dims() < 2 ||
+      output->dim_size(1) < task.unpadded_sequence_length) {
+    return errors::FailedPrecondition(
+        "Sequence output must have at least 2 dimensions and keep the padded "
+        "sequence length in dimension 1; got shape ",
+        output->shape().DebugString(), " for sequence length ",
+        task.unpadded_sequence_length);
+  }
+  return ResizeSequenceDimension(task.context, task.unpadded_sequence_length,
+                                 output);
+}
+
 void BatchResourceBase::CleanUpFunctionHelper(
     BatchTask& task, const absl::Status& status) const {
   WithContext wc(task.propagated_context);
@@ -1085,6 +1188,9 @@ void BatchResourceBase::ProcessFuncBatch(
         if (last_task.forced_warmup_batch_size == 0) {
           final_status = SplitOutputTensors(combined_outputs, batch.get(),
                                             unbatched_tasks);
+        } else {
+          RecordWarmedUpBatchSize(last_task.forced_warmup_batch_size,
+                                  model_name, op_name);
         }
       });
 }
@@ -1248,6 +1354,66 @@ absl::Status BatchResourceBase::LookupOrCreateBatcherQueue(
   return absl::OkStatus();
 }
 
+absl::StatusOr<string> BatchResourceBase::AssignSequenceLengthBucket(
+    OpKernelContext* context, const string& batcher_queue_name,
+    BatchTask* task) const {
+  if (sequence_input_indices_.empty()) {
+    return errors::InvalidArgument(
+        "Sequence length buckets require at least one sequence input.");
+  }
+  int64_t length = -1;
+  bool can_pad = true;
+  for (int index : sequence_input_indices_) {
+    if (index < 0 || index >= static_cast<int>(task->inputs.size())) {
+      return errors::InvalidArgument("Sequence input index ", index,
+                                     " is out of range; there are ",
+                                     task->inputs.size(), " inputs.");
+    }
+    const Tensor& input = task->inputs[index];
+    if (input.dims() < 2) {
+      return errors::InvalidArgument(
+          "Sequence input ", index,
+          " must have at least 2 dimensions; got shape ",
+          input.shape().DebugString());
+    }
+    if (length >= 0 && input.dim_size(1) != length) {
+      return errors::InvalidArgument(
+          "Sequence inputs must have the same dimension 1; got ", length,
+          " and ", input.dim_size(1), " for input ", index);
+    }
+    length = input.dim_size(1);
+    can_pad &= DataTypeCanUseMemcpy(input.dtype());
+  }
+  for (int index : sequence_output_indices_) {
+    if (index < 0 || index >= context->num_outputs()) {
+      return errors::InvalidArgument("Sequence output index ", index,
+                                     " is out of range; there are ",
+                                     context->num_outputs(), " outputs.");
+    }
+    can_pad &= DataTypeCanUseMemcpy(context->op_kernel().output_type(index));
+  }
+
+  auto bucket = std::lower_bound(sequence_length_buckets_.begin(),
+                                 sequence_length_buckets_.end(), length);
+  if (bucket == sequence_length_buckets_.end() || !can_pad) {
+    return absl::StrCat(batcher_queue_name, "/seq_len_", length);
+  }
+  const int64_t bound = *bucket;
+  RecordSequencePaddingFraction(
+      1.0 - static_cast<double>(length) / static_cast<double>(bound),
+      GetModelName(context), context->op_kernel().name());
+  task->unpadded_sequence_length = length;
+  if (bound == length) {
+    return absl::StrCat(batcher_queue_name, "/seq_bucket_", bound);
+  }
+
+  for (int index : sequence_input_indices_) {
+    Tensor& input = task->inputs[index];
+    TF_RETURN_IF_ERROR(ResizeSequenceDimension(context, bound, &input));
+  }
+  return absl::StrCat(batcher_queue_name, "/seq_bucket_", bound);
+}
+
 void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     const std::string& model_name, const std::string& op_name,
     const std::vector<std::unique_ptr<CostMeasurement>>&
@@ -141,6 +141,11 @@ class BatchResourceBase : public ResourceBase {
     // batch is processed, but is not propagated to the kernel outputs.
     int forced_warmup_batch_size = 0;
 
+    // The length of dimension 1 of the sequence inputs before they were padded
+    // to a sequence length bucket (see set_sequence_length_buckets()), or -1
+    // if the task is not in a bucket.
+    int64_t unpadded_sequence_length = -1;
+
    protected:
     virtual std::unique_ptr<BatchTask> CreateDerivedTask() {
       return std::make_unique<BatchTask>();
@@ -186,6 +191,26 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Groups tasks into length buckets before batching, so that short and long
+  // sequences are not batched together. `buckets` are ascending upper bounds
+  // on the sequence length, which is dimension 1 of the inputs at
+  // `sequence_input_indices`. These inputs must all have the same dimension 1.
+  // Each bucket gets its own batcher queue, and thus its own batches and batch
+  // timeout. The sequence inputs are padded with zeros along dimension 1 up to
+  // the bucket bound, so the batched function sees the padded length. The
+  // outputs at `sequence_output_indices` are sliced back along dimension 1 to
+  // the length of each task's sequence inputs. Tasks longer than the largest
+  // bound, or with sequence inputs or outputs that cannot be memcpy'd, are
+  // only batched with tasks of exactly the same length. Must be called before
+  // the first RegisterInput call.
+  void set_sequence_length_buckets(std::vector<int32> buckets,
+                                   std::vector<int> sequence_input_indices,
+                                   std::vector<int> sequence_output_indices) {
+    sequence_length_buckets_ = std::move(buckets);
+    sequence_input_indices_ = std::move(sequence_input_indices);
+    sequence_output_indices_ = std::move(sequence_output_indices);
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -312,6 +337,10 @@ class BatchResourceBase : public ResourceBase {
       const std::vector<Tensor>& combined_outputs, BatchT* batch,
       std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks) const;
 
+  // Slices dimension 1 of `output`, a sequence output of `task`, back to the
+  // task's unpadded sequence length.
+  Status SliceSequenceOutput(const BatchTask& task, Tensor* output) const;
+
   void ProcessFuncBatch(
       std::unique_ptr<BatchT> batch,
       std::vector<std::unique_ptr<BatchTask>> unbatched_tasks = {}) const;
@@ -346,6 +375,13 @@ class BatchResourceBase : public ResourceBase {
                                     const string& op_name,
                                     BatcherQueueT** queue);
 
+  // Pads the sequence inputs of `task` to its sequence length bucket (see
+  // set_sequence_length_buckets()) and returns the name of the bucket's queue
+  // within 'batcher_queue_name'.
+  StatusOr<string> AssignSequenceLengthBucket(OpKernelContext* context,
+                                              const string& batcher_queue_name,
+                                              BatchTask* task) const;
+
   SessionMetadata session_metadata_;
 
   absl::Mutex outstanding_batch_mu_;
@@ -372,6 +408,14 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // Ascending upper bounds of the sequence length buckets. Empty if tasks are
+  // not bucketed.
+  std::vector<int32> sequence_length_buckets_;
+  // Indices of the inputs that are padded to the sequence length bucket, and
+  // of the outputs that are sliced back to each task's sequence length.
+  std::vector<int> sequence_input_indices_;
+  std::vector<int> sequence_output_indices_;
 };
 
 }  // namespace serving
@@ -430,9 +430,11 @@ class BatchResourceBaseTest : public ::testing::Test {
 
     void ProcessFuncBatchImpl(
         const BatchResourceBase::BatchTask& /* last_task */,
-        absl::Span<const Tensor> /* inputs */,
+        absl::Span<const Tensor> inputs,
         std::vector<Tensor>* /* combined_outputs */,
         std::function<void(const absl::Status&)> /* done */) const override {
+      processed_input_shape_ = inputs[0].shape();
+      processed_input_data_ = inputs[0].tensor_data().data();
       process_func_batch_called_.Notify();
     }
 
@@ -440,8 +442,34 @@ class BatchResourceBaseTest : public ::testing::Test {
       return process_func_batch_called_;
     }
 
+    // The shape of the first input of the last processed batch.
+    const TensorShape& processed_input_shape() const {
+      return processed_input_shape_;
+    }
+
+    // The buffer of the first input of the last processed batch.
+    const char* processed_input_data() const { return processed_input_data_; }
+
    private:
     mutable Notification process_func_batch_called_;
+    mutable TensorShape processed_input_shape_;
+    mutable const char* processed_input_data_ = nullptr;
+  };
+
+  // Like MyBatchResource, but returns its first input as its output.
+  class EchoBatchResource : public BatchResourceBase {
+   public:
+    using BatchResourceBase::BatchResourceBase;
+
+    std::string DebugString() const override { return ""; }
+
+    void ProcessFuncBatchImpl(
+        const BatchResourceBase::BatchTask& /* last_task */,
+        absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
+        std::function<void(const absl::Status&)> done) const override {
+      combined_outputs->push_back(inputs[0]);
+      done(absl::OkStatus());
+    }
   };
 
   BatchResourceBaseTest() {
@@ -622,6 +650,126 @@ TEST_F(BatchResourceBaseTest, ConfiguredBatchPaddingPolicyMetric) {
   my_batch_resource->Unref();
 }
 
+TEST_F(BatchResourceBaseTest, SingleUnpaddedTaskInputIsNotCopied) {
+  std::shared_ptr<SharedBatchScheduler<BatchResourceBase::BatchTask>> batcher;
+  TF_CHECK_OK(
+      SharedBatchScheduler<BatchResourceBase::BatchTask>::Create({}, &batcher));
+
+  MyBatchResource* my_batch_resource = new MyBatchResource(
+      /* has_process_batch_function */ true,
+      /* batcher= */ batcher,
+      /* batcher_queue_options */ {},
+      /* allowed_batch_sizes */ {});
+
+  TF_CHECK_OK(my_batch_resource->RegisterInput(
+      /* guid= */
+      0, /* context= */ context_.get(),
+      /* batcher_queue_name= */ "batcher_queue_name",
+      /* create_batch_task_fn= */
+      []() -> absl::StatusOr<std::unique_ptr<BatchResourceBase::BatchTask>> {
+        return std::make_unique<BatchResourceBase::BatchTask>();
+      },
+      /* done_callback= */ [] {}, /* forced_warmup_batch_size= */ 0));
+
+  ASSERT_TRUE(
+      my_batch_resource->process_func_batch_called()
+          .WaitForNotificationWithTimeout(absl::Seconds(1)));
+  EXPECT_EQ(my_batch_resource->processed_input_data(),
+            input_tensor_.tensor_data().data());
+
+  // This is how we have to destroy the BatchResource.
+  my_batch_resource->Unref();
+}
+
+TEST_F(BatchResourceBaseTest, SequenceLengthBucketing) {
+  tensorflow::monitoring::testing::CellReader<
+      tensorflow::monitoring::testing::Histogram>
+      padding_fraction(
+          "/tensorflow/serving/batching/sequence_padding_fraction");
+
+  std::shared_ptr<SharedBatchScheduler<BatchResourceBase::BatchTask>> batcher;
+  TF_CHECK_OK(
+      SharedBatchScheduler<BatchResourceBase::BatchTask>::Create({}, &batcher));
+
+  MyBatchResource* my_batch_resource = new MyBatchResource(
+      /* has_process_batch_function */ true,
+      /* batcher= */ batcher,
+      /* batcher_queue_options */ {},
+      /* allowed_batch_sizes */ {});
+  // The inputs have shape [5, 2, 1], so they go to the bucket of length 4.
+  my_batch_resource->set_sequence_length_buckets(
+      /* buckets= */ {4, 16}, /* sequence_input_indices= */ {0, 1},
+      /* sequence_output_indices= */ {});
+
+  TF_CHECK_OK(my_batch_resource->RegisterInput(
+      /* guid= */
+      0, /* context= */ context_.get(),
+      /* batcher_queue_name= */ "batcher_queue_name",
+      /* create_batch_task_fn= */
+      []() -> absl::StatusOr<std::unique_ptr<BatchResourceBase::BatchTask>> {
+        return std::make_unique<BatchResourceBase::BatchTask>();
+      },
+      /* done_callback= */ [] {}, /* forced_warmup_batch_size= */ 0));
+
+  ASSERT_TRUE(
+      my_batch_resource->process_func_batch_called()
+          .WaitForNotificationWithTimeout(absl::Seconds(1)));
+  EXPECT_EQ(my_batch_resource->processed_input_shape(),
+            TensorShape({5, 4, 1}));
+  tensorflow::monitoring::testing::Histogram histogram =
+      padding_fraction.Delta(/* model_name= */ "my_model_name",
+                             /* op_name= */ "my_batch_node");
+  EXPECT_FLOAT_EQ(histogram.num(), 1.0);
+  EXPECT_FLOAT_EQ(histogram.sum(), 0.5);
+
+  // This is how we have to destroy the BatchResource.
+  my_batch_resource->Unref();
+}
+
+TEST_F(BatchResourceBaseTest, SequenceLengthBucketingSlicesOutputs) {
+  std::shared_ptr<SharedBatchScheduler<BatchResourceBase::BatchTask>> batcher;
+  TF_CHECK_OK(
+      SharedBatchScheduler<BatchResourceBase::BatchTask>::Create({}, &batcher));
+
+  EchoBatchResource* echo_batch_resource = new EchoBatchResource(
+      /* has_process_batch_function */ true,
+      /* batcher= */ batcher,
+      /* batcher_queue_options */ {},
+      /* allowed_batch_sizes */ {});
+  echo_batch_resource->set_sequence_length_buckets(
+      /* buckets= */ {4, 16}, /* sequence_input_indices= */ {0, 1},
+      /* sequence_output_indices= */ {0});
+  auto input = input_tensor_.flat<int64_t>();
+  for (int i = 0; i < input.size(); ++i) {
+    input(i) = i;
+  }
+
+  // The inputs have shape [5, 2, 1] and are batched padded to [5, 4, 1]. The
+  // output is sliced back to the task's own sequence length.
+  Notification done;
+  TF_CHECK_OK(echo_batch_resource->RegisterInput(
+      /* guid= */
+      0, /* context= */ context_.get(),
+      /* batcher_queue_name= */ "batcher_queue_name",
+      /* create_batch_task_fn= */
+      []() -> absl::StatusOr<std::unique_ptr<BatchResourceBase::BatchTask>> {
+        return std::make_unique<BatchResourceBase::BatchTask>();
+      },
+      /* done_callback= */ [&done] { done.Notify(); },
+      /* forced_warmup_batch_size= */ 0));
+
+  ASSERT_TRUE(done.WaitForNotificationWithTimeout(absl::Seconds(1)));
+  ASSERT_TRUE(context_->status().ok()) << context_->status();
+  const Tensor& output = *context_->mutable_output(0);
+  ASSERT_EQ(output.shape(), TensorShape({5, 2, 1}));
+  for (int i = 0; i < input.size(); ++i) {
+    EXPECT_EQ(output.flat<int64_t>()(i), i);
+  }
+
+  // This is how we have to destroy the BatchResource.
+  echo_batch_resource->Unref();
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -50,6 +50,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <optional>
@@ -115,6 +116,69 @@ class CostTracker {
   absl::Duration sample_sum_ TF_GUARDED_BY(mu_);
 };
 
+// Tracks a sliding window of the most recent latency samples and reports
+// percentiles over it.
+//
+// Thread-safe.
+class LatencyTracker {
+ public:
+  explicit LatencyTracker(int64_t window_size = 1000)
+      : window_size_(window_size) {
+    DCHECK_GT(window_size, 0);
+  }
+
+  // Registers a latency sample, evicting the oldest one if the window is full.
+  void Register(absl::Duration latency) {
+    mutex_lock l(mu_);
+    if (static_cast<int64_t>(samples_.size()) < window_size_) {
+      samples_.push_back(latency);
+    } else {
+      samples_[next_sample_] = latency;
+    }
+    next_sample_ = (next_sample_ + 1) % window_size_;
+  }
+
+  // Returns the `percentile`-th percentile (in [0, 100]) of the samples in the
+  // window.
+  //
+  // Returns std::nullopt if no samples have been registered.
+  std::optional<absl::Duration> Percentile(double percentile) const {
+    std::vector<absl::Duration> samples;
+    {
+      mutex_lock l(mu_);
+      samples = samples_;
+    }
+    if (samples.empty()) return std::nullopt;
+
+    const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                        static_cast<double>(samples.size() - 1);
+    auto nth = samples.begin() + static_cast<int64_t>(rank + 0.5);
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+  }
+
+  // Returns the number of samples currently in the window.
+  int64_t sample_count() const {
+    mutex_lock l(mu_);
+    return samples_.size();
+  }
+
+  // Drops all samples, e.g. after a configuration change that makes them
+  // stale.
+  void Clear() {
+    mutex_lock l(mu_);
+    samples_.clear();
+    next_sample_ = 0;
+  }
+
+ private:
+  mutable mutex mu_;
+
+  const int64_t window_size_;
+  std::vector<absl::Duration> samples_ TF_GUARDED_BY(mu_);
+  int64_t next_sample_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // Tracks statistics for a particular model and batch size.
 //
 // Thread-safe.
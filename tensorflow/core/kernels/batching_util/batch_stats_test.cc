@@ -69,6 +69,35 @@ TEST(BatchStatsTest, CostTrackerMeanIsCorrect) {
   ASSERT_EQ(*tracker.mean(), absl::Hours(6));
 }
 
+TEST(BatchStatsTest, LatencyTrackerStartsWithNoPercentile) {
+  LatencyTracker tracker;
+  ASSERT_EQ(tracker.Percentile(99), std::nullopt);
+}
+
+TEST(BatchStatsTest, LatencyTrackerPercentileIsCorrect) {
+  LatencyTracker tracker;
+  for (int i = 1; i <= 100; ++i) {
+    tracker.Register(absl::Milliseconds(i));
+  }
+  ASSERT_EQ(tracker.Percentile(0), absl::Milliseconds(1));
+  ASSERT_EQ(tracker.Percentile(50), absl::Milliseconds(51));
+  ASSERT_EQ(tracker.Percentile(99), absl::Milliseconds(99));
+  ASSERT_EQ(tracker.Percentile(100), absl::Milliseconds(100));
+}
+
+TEST(BatchStatsTest, LatencyTrackerEvictsOldestSamples) {
+  LatencyTracker tracker(/* window_size= */ 2);
+  tracker.Register(absl::Seconds(10));
+  tracker.Register(absl::Seconds(1));
+  tracker.Register(absl::Seconds(2));
+  ASSERT_EQ(tracker.sample_count(), 2);
+  ASSERT_EQ(tracker.Percentile(100), absl::Seconds(2));
+
+  tracker.Clear();
+  ASSERT_EQ(tracker.sample_count(), 0);
+  ASSERT_EQ(tracker.Percentile(100), std::nullopt);
+}
+
 TEST(BatchStatsTest, ProcessedSizeIsCorrect) {
   ModelBatchStats stats;
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
@@ -112,9 +113,13 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
+// Queues may also be given a scheduling priority, in which case queues of
+// higher priority are served strictly first, and a "share" (an int >= 1) that
+// weights the round-robin among queues of equal priority: e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
+// Large batches from lower priority queues can be dispatched in smaller units,
+// so that a burst of higher priority traffic does not wait behind a whole
+// low priority batch. See QueueOptions for details.
 //
 //
 // PERFORMANCE TUNING: See README.md.
@@ -187,6 +192,41 @@ class SharedBatchScheduler
     // avoid latency spikes.
     int64_t batch_timeout_micros = 0;
 
+    // If positive, a p99 latency target in microseconds for tasks submitted to
+    // this queue, counting both the time spent enqueued and the time spent in
+    // the process-batch callback.
+    //
+    // The queue then treats `batch_timeout_micros` and the maximum batch size
+    // as upper bounds and tunes the values in effect online: while the
+    // observed p99 latency exceeds the target it first shortens the batch
+    // timeout and then, once the timeout is zero, shrinks the batch size at
+    // which batches are closed; while there is headroom it grows them back.
+    // This keeps batches as large (and throughput as high) as the latency
+    // target allows.
+    int64_t target_p99_latency_micros = 0;
+
+    // Queues with a higher `scheduling_priority` are served strictly before
+    // queues with a lower one: a batch thread only takes work from a queue
+    // when no queue of higher priority has a schedulable batch. Queues of equal
+    // priority are served round-robin (or ranked, with `rank_queues`).
+    int scheduling_priority = 0;
+
+    // The weight of this queue among queues of equal priority served
+    // round-robin: the batch threads take up to this many batches in a row
+    // from this queue before moving on to the next one. Must be positive.
+    // Ignored with `rank_queues`.
+    int scheduling_share = 1;
+
+    // If positive and another active queue has a higher `scheduling_priority`,
+    // batches of this queue are dispatched in units of at most this size
+    // (rounded down to whole tasks; a single larger task is dispatched on its
+    // own). The rest of the batch stays at the head of the queue and is only
+    // dispatched when no higher priority queue has work, so higher priority
+    // batches wait behind at most one unit. Batches formed from low priority
+    // tasks within a queue (see `enable_priority_queue`) are not split, and
+    // neither are batches whose remainder would exceed `max_enqueued_batches`.
+    size_t preemptible_batch_unit_size = 0;
+
     // The maximum allowable number of enqueued (accepted by Schedule() but
     // not yet being processed on a batch thread) tasks in terms of batches.
     // If this limit is reached, Schedule() will return an UNAVAILABLE error.
@@ -305,6 +345,13 @@ class SharedBatchScheduler
 
   static bool BatchExists(const BatchTaskUniquePtr& batch_to_process);
 
+  // Returns the highest `scheduling_priority` among the active queues that
+  // have a schedulable batch, or nullopt if all active queues have the same
+  // priority (in which case no queue needs to be skipped). Also sets
+  // `max_priority_out` to the highest priority of any active queue.
+  std::optional<int> GetPriorityToSchedule_Locked(int* max_priority_out)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const Options options_;
 
   mutex mu_;
@@ -323,6 +370,10 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
 
+  // The number of batches taken in a row from 'next_queue_to_schedule_',
+  // compared against its `scheduling_share`.
+  int num_batches_scheduled_in_turn_ TF_GUARDED_BY(mu_) = 0;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -413,7 +464,17 @@ class Queue {
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr ScheduleBatch();
+  //
+  // If `split_into_preemptible_units` is true, a batch larger than
+  // `preemptible_batch_unit_size` is split and only its first unit returned.
+  typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr ScheduleBatch(
+      bool split_into_preemptible_units = false);
+
+  // See QueueOptions.scheduling_priority.
+  int scheduling_priority() const { return options_.scheduling_priority; }
+
+  // See QueueOptions.scheduling_share.
+  int scheduling_share() const { return options_.scheduling_share; }
 
   // Without mutating the queue, checks if ScheduleBatch() will return a valid
   // batch and if so will return the priority of that batch.
@@ -517,6 +578,28 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // If `batch`, which has just been taken off the front of the batch queue, is
+  // larger than `preemptible_batch_unit_size`, trims it to its first unit and
+  // puts the remaining tasks back at the front of the queue as a closed batch.
+  // Does nothing if the queue already holds `max_enqueued_batches` batches.
+  void SplitOffPreemptibleUnit(Batch<TaskType>& batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the batch size at which the open batch is closed and becomes
+  // schedulable, which is also the size large inputs are split into. Equal to
+  // max_execution_batch_size() unless the queue is tuning for
+  // `target_p99_latency_micros`.
+  size_t target_batch_size() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return tuned_batch_size_;
+  }
+
+  // Records the latency of the oldest task in a just-processed batch, which
+  // started waiting at `earliest_task_start_time_micros`, and retunes the
+  // batch timeout and target batch size once enough samples have been
+  // collected. No-op unless `target_p99_latency_micros` is set.
+  void RecordBatchLatency(uint64 earliest_task_start_time_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Gets the appropriate batches.
   std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches()
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -597,6 +680,20 @@ class Queue {
   // 'empty_notification_->Notify()'.
   Notification* empty_notification_ TF_GUARDED_BY(mu_) = nullptr;
 
+  // Number of processed batches whose latency is sampled before each tuning
+  // decision for `target_p99_latency_micros`.
+  static constexpr int64_t kLatencyTuningWindow = 100;
+
+  // The batch timeout and the batch size at which open batches are closed.
+  // These are the configured values, unless `target_p99_latency_micros` is
+  // set, in which case RecordBatchLatency() adjusts them.
+  int64_t tuned_batch_timeout_micros_ TF_GUARDED_BY(mu_);
+  size_t tuned_batch_size_ TF_GUARDED_BY(mu_);
+
+  // Latencies of the oldest task of each batch processed since the last
+  // tuning decision.
+  LatencyTracker batch_latency_{kLatencyTuningWindow};
+
   Queue(const Queue&) = delete;
   void operator=(const Queue&) = delete;
 };
@@ -705,11 +802,20 @@ absl::Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "batch_timeout_micros must be non-negative; was ",
         options.batch_timeout_micros);
   }
+  if (options.target_p99_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_p99_latency_micros must be non-negative; was ",
+        options.target_p99_latency_micros);
+  }
   if (options.max_enqueued_batches == 0) {
     return errors::InvalidArgument(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.scheduling_share < 1) {
+    return errors::InvalidArgument("scheduling_share must be positive; was ",
+                                   options.scheduling_share);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -772,6 +878,32 @@ bool SharedBatchScheduler<TaskType>::BatchExists(
   return batch_to_process != nullptr;
 }
 
+template <typename TaskType>
+std::optional<int> SharedBatchScheduler<TaskType>::GetPriorityToSchedule_Locked(
+    int* max_priority_out) {
+  *max_priority_out = 0;
+  if (queues_.empty()) return std::nullopt;
+
+  int min_priority = queues_.front()->scheduling_priority();
+  int max_priority = min_priority;
+  for (const auto& queue : queues_) {
+    min_priority = std::min(min_priority, queue->scheduling_priority());
+    max_priority = std::max(max_priority, queue->scheduling_priority());
+  }
+  *max_priority_out = max_priority;
+  if (min_priority == max_priority) return std::nullopt;
+
+  std::optional<int> priority_to_schedule;
+  for (const auto& queue : queues_) {
+    if ((!priority_to_schedule.has_value() ||
+         queue->scheduling_priority() > *priority_to_schedule) &&
+        queue->PeekBatchPriority().has_value()) {
+      priority_to_schedule = queue->scheduling_priority();
+    }
+  }
+  return priority_to_schedule;
+}
+
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
@@ -780,6 +912,9 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   std::optional<typename internal::Queue<TaskType>::BatchPriorityKey>
       batch_priority_key;
+  int max_priority;
+  const std::optional<int> priority_to_schedule =
+      GetPriorityToSchedule_Locked(&max_priority);
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -794,7 +929,11 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
 
     bool queue_has_work = false;
 
-    if (options_.rank_queues) {
+    if (priority_to_schedule.has_value() &&
+        (*next_queue_to_schedule_)->scheduling_priority() <
+            *priority_to_schedule) {
+      // A queue of higher priority has work, so this one has to wait.
+    } else if (options_.rank_queues) {
       auto key = (*next_queue_to_schedule_)->PeekBatchPriority();
       queue_has_work = key.has_value();
       if (key.has_value() && (!batch_priority_key.has_value() ||
@@ -804,7 +943,9 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
       }
     } else {
       // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch(
+          /*split_into_preemptible_units=*/(*next_queue_to_schedule_)
+              ->scheduling_priority() < max_priority);
       queue_has_work = BatchExists(batch_to_process);
 
       if (queue_has_work) {
@@ -818,8 +959,14 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
       // We've encountered a closed queue with no work to do. Drop it.
       DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
       next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+      num_batches_scheduled_in_turn_ = 0;
+    } else if (queue_has_work && !options_.rank_queues &&
+               ++num_batches_scheduled_in_turn_ <
+                   (*next_queue_to_schedule_)->scheduling_share()) {
+      // Stay on this queue until it has used up its share of the turn.
     } else {
       ++next_queue_to_schedule_;
+      num_batches_scheduled_in_turn_ = 0;
     }
     if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
       // We've hit the end. Wrap to the first queue.
@@ -828,7 +975,9 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   }
 
   if (options_.rank_queues && batch_priority_key.has_value()) {
-    batch_to_process = queue_for_batch->ScheduleBatch();
+    batch_to_process = queue_for_batch->ScheduleBatch(
+        /*split_into_preemptible_units=*/queue_for_batch
+            ->scheduling_priority() < max_priority);
   }
 
   *queue_for_batch_out = queue_for_batch;
@@ -872,7 +1021,9 @@ Queue<TaskType>::Queue(
       env_(env),
       max_execution_batch_size_(GetMaxExecutionBatchSize(options_)),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      tuned_batch_timeout_micros_(options_.batch_timeout_micros),
+      tuned_batch_size_(max_execution_batch_size_) {
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
@@ -918,8 +1069,11 @@ absl::Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
 
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
 
+  // The target batch size may have been tuned below the size of the open
+  // batch, which then has no remaining slots.
   const int64_t open_batch_remaining_slot =
-      max_execution_batch_size() - batches.back()->size();
+      std::max<int64_t>(0, static_cast<int64_t>(target_batch_size()) -
+                               static_cast<int64_t>(batches.back()->size()));
 
   const int64_t input_task_size = (*task)->size();
 
@@ -934,8 +1088,9 @@ absl::Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
   }
 
   for (int i = 0; i < output_tasks.size(); ++i) {
-    if (batches.back()->size() + output_tasks[i]->size() >
-        max_execution_batch_size()) {
+    if (!batches.back()->empty() &&
+        batches.back()->size() + output_tasks[i]->size() >
+            target_batch_size()) {
       StartNewBatch();
     }
     if (batches.back()->empty()) {
@@ -972,7 +1127,8 @@ void Queue<TaskType>::PadOpenBatchWithLowPriorityTasks() {
 
   while (!low_priority_tasks_.empty() && !out_of_space) {
     const int64_t open_batch_remaining_slot =
-        max_execution_batch_size() - batches.back()->size();
+        static_cast<int64_t>(target_batch_size()) -
+        static_cast<int64_t>(batches.back()->size());
     if (open_batch_remaining_slot <= 0) {
       // Terminate early if the open batch is full. Remaining low priority tasks
       // will be re-checked during the next batch formation opportunity.
@@ -1000,7 +1156,7 @@ void Queue<TaskType>::PadOpenBatchWithLowPriorityTasks() {
 
     for (int i = 0; i < output_tasks.size(); ++i) {
       if (batches.back()->size() + output_tasks[i]->size() >
-          max_execution_batch_size()) {
+          target_batch_size()) {
         low_priority_tasks_.PrependTask(std::move(output_tasks[i]), task_time);
         out_of_space = true;
         // NOTE: Future iterations of this loop will also hit this case but are
@@ -1179,7 +1335,7 @@ absl::Status Queue<TaskType>::ValidateLowPriorityTaskQueueCapacity(
 
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr
-Queue<TaskType>::ScheduleBatch() {
+Queue<TaskType>::ScheduleBatch(bool split_into_preemptible_units) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -1242,6 +1398,9 @@ Queue<TaskType>::ScheduleBatch() {
       // There is at least one closed batch that is ready to be scheduled.
       batch_to_schedule = std::move(batches.front());
       batches.pop_front();
+      if (split_into_preemptible_units) {
+        SplitOffPreemptibleUnit(*batch_to_schedule);
+      }
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1263,6 +1422,40 @@ Queue<TaskType>::ScheduleBatch() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+void Queue<TaskType>::SplitOffPreemptibleUnit(Batch<TaskType>& batch) {
+  const size_t unit_size = options_.preemptible_batch_unit_size;
+  if (unit_size == 0 || batch.size() <= unit_size) return;
+  // The remainder would take up a slot in the batch queue, so don't split if
+  // that would exceed `max_enqueued_batches`.
+  if (num_enqueued_batches() >=
+      static_cast<int64_t>(options_.max_enqueued_batches)) {
+    return;
+  }
+
+  // Keep whole tasks only, and at least one task.
+  size_t new_size = batch.task(0).size();
+  for (int i = 1; i < batch.num_tasks(); ++i) {
+    if (new_size + batch.task(i).size() > unit_size) break;
+    new_size += batch.task(i).size();
+  }
+  if (new_size == batch.size()) return;
+
+  const uint64 start_time_micros = batch.EarliestTaskStartTime().value();
+  std::vector<std::unique_ptr<TaskType>> remaining_tasks;
+  batch.TryTrimToNewSize(new_size, remaining_tasks);
+  // Trimming at a task boundary always succeeds.
+  DCHECK(!remaining_tasks.empty());
+
+  auto remainder =
+      std::make_unique<Batch<TaskType>>(++traceme_context_id_counter_);
+  for (std::unique_ptr<TaskType>& task : remaining_tasks) {
+    remainder->AddTask(std::move(task), start_time_micros);
+  }
+  remainder->Close();
+  GetBatches().push_front(std::move(remainder));
+}
+
 template <typename TaskType>
 std::vector<std::unique_ptr<TaskType>> Queue<TaskType>::GetLowPriorityTasks(
     size_t size) {
@@ -1315,6 +1508,9 @@ void Queue<TaskType>::ProcessBatch(
       tsl::profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
+  const std::optional<uint64> earliest_task_start_time_micros =
+      batch->EarliestTaskStartTime();
+
   if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
           process_batch_callback_)) {
     std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
@@ -1326,6 +1522,9 @@ void Queue<TaskType>::ProcessBatch(
 
   {
     mutex_lock l(mu_);
+    if (earliest_task_start_time_micros.has_value()) {
+      RecordBatchLatency(*earliest_task_start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1333,6 +1532,56 @@ void Queue<TaskType>::ProcessBatch(
   }
 }
 
+template <typename TaskType>
+void Queue<TaskType>::RecordBatchLatency(
+    uint64 earliest_task_start_time_micros) {
+  // Tasks added without a start time (e.g. low priority padding) carry no
+  // latency information.
+  if (options_.target_p99_latency_micros <= 0 ||
+      earliest_task_start_time_micros == 0) {
+    return;
+  }
+  const uint64 now_micros = env_->NowMicros();
+  if (now_micros < earliest_task_start_time_micros) return;
+  batch_latency_.Register(
+      absl::Microseconds(now_micros - earliest_task_start_time_micros));
+  if (batch_latency_.sample_count() < kLatencyTuningWindow) return;
+
+  const absl::Duration p99_latency = *batch_latency_.Percentile(99);
+  const absl::Duration target_latency =
+      absl::Microseconds(options_.target_p99_latency_micros);
+  // Samples taken under the old settings would skew the next decision.
+  batch_latency_.Clear();
+
+  // Decrease multiplicatively and increase additively, so that the queue backs
+  // off quickly when the target is violated and probes for more throughput
+  // slowly. The timeout is adjusted before the batch size because delaying a
+  // batch only adds latency, while a smaller batch also costs throughput.
+  if (p99_latency > target_latency) {
+    if (tuned_batch_timeout_micros_ > 0) {
+      tuned_batch_timeout_micros_ /= 2;
+    } else {
+      tuned_batch_size_ = std::max<size_t>(1, tuned_batch_size_ / 2);
+    }
+  } else if (p99_latency < target_latency * 0.8) {
+    if (tuned_batch_size_ < max_execution_batch_size_) {
+      tuned_batch_size_ =
+          std::min(max_execution_batch_size_,
+                   tuned_batch_size_ +
+                       std::max<size_t>(1, max_execution_batch_size_ / 8));
+    } else if (tuned_batch_timeout_micros_ < options_.batch_timeout_micros) {
+      tuned_batch_timeout_micros_ = std::min(
+          options_.batch_timeout_micros,
+          tuned_batch_timeout_micros_ +
+              std::max<int64_t>(1, options_.batch_timeout_micros / 8));
+    }
+  }
+  VLOG(2) << "Tuned batching for p99 latency " << p99_latency << " (target "
+          << target_latency << "): batch_timeout_micros="
+          << tuned_batch_timeout_micros_
+          << ", batch_size=" << tuned_batch_size_;
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -1373,11 +1622,12 @@ template <typename TaskType>
 absl::Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
     std::unique_ptr<TaskType>* input_task,
     std::vector<std::unique_ptr<TaskType>>* output_tasks) {
-  const int open_batch_remaining_slot =
-      max_execution_batch_size() - this->tail_batch_task_size();
+  const int open_batch_remaining_slot = std::max<int64_t>(
+      0, static_cast<int64_t>(target_batch_size()) -
+             static_cast<int64_t>(this->tail_batch_task_size()));
   return options_.split_input_task_func(
-      std::move(input_task), open_batch_remaining_slot,
-      max_execution_batch_size(), std::move(output_tasks));
+      std::move(input_task), open_batch_remaining_slot, target_batch_size(),
+      std::move(output_tasks));
 }
 
 template <typename TaskType>
@@ -1412,7 +1662,7 @@ Queue<TaskType>::PeekBatchPriorityImpl() const {
 
   size_t effective_batch_size = open_batch->size();
   uint64 effective_start_time_micros = open_batch_start_time_micros_;
-  int64_t effective_batch_timeout_micros = options_.batch_timeout_micros;
+  int64_t effective_batch_timeout_micros = tuned_batch_timeout_micros_;
   if (effective_batch_size == 0) {
     // open_batch_start_time_micros_ is not valid for an empty batch.
     effective_start_time_micros = env_->NowMicros();
@@ -1440,8 +1690,7 @@ Queue<TaskType>::PeekBatchPriorityImpl() const {
     return std::nullopt;
   }
 
-  bool schedulable = closed_ ||
-                     effective_batch_size >= max_execution_batch_size() ||
+  bool schedulable = closed_ || effective_batch_size >= target_batch_size() ||
                      env_->NowMicros() >= effective_start_time_micros +
                                               effective_batch_timeout_micros;
 
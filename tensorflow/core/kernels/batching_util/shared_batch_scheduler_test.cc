@@ -737,6 +737,334 @@ TEST_P(SharedBatchSchedulerTest,
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, ShortensTimeoutWhenLatencyTargetIsMissed) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    int num_batches_processed = 0;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      // Every batch spends 1000us in the callback after waiting out the 500us
+      // timeout, missing the 1000us target.
+      env.AdvanceByMicroseconds(1000);
+      mutex_lock l(mu);
+      ++num_batches_processed;
+    };
+    auto wait_for_batches = [&](int num_batches) {
+      while (true) {
+        {
+          mutex_lock l(mu);
+          if (num_batches_processed >= num_batches) return;
+        }
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    };
+    auto num_batches = [&] {
+      mutex_lock l(mu);
+      return num_batches_processed;
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+        /*batch_timeout_micros=*/500, /*max_enqueued_batches=*/2);
+    options.target_p99_latency_micros = 1000;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Collect one tuning window worth of latency samples, all of which miss
+    // the target.
+    for (int i = 1; i <= 100; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      env.AdvanceByMicroseconds(500);
+      wait_for_batches(i);
+    }
+
+    // The timeout is now halved.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(249);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_EQ(num_batches(), 100);
+    env.AdvanceByMicroseconds(1);
+    wait_for_batches(101);
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, SplitsInputsToTunedBatchSize) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      // Every batch spends 1000us in the callback, missing the 500us target.
+      env.AdvanceByMicroseconds(1000);
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+    };
+    auto wait_for_batches = [&](int num_batches) {
+      while (true) {
+        {
+          mutex_lock l(mu);
+          if (static_cast<int>(batch_sizes.size()) >= num_batches) return;
+        }
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+        /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2);
+    options.target_p99_latency_micros = 500;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Without a timeout to shorten, one tuning window of misses halves the
+    // batch size to 2. The batch after the window is only processed once the
+    // tuning decision has been made.
+    for (int i = 1; i <= 101; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      wait_for_batches(i);
+    }
+
+    TF_ASSERT_OK(ScheduleTask(4, queue.get()));
+    if (enable_input_batch_split()) {
+      wait_for_batches(103);
+      mutex_lock l(mu);
+      EXPECT_THAT(std::vector<size_t>(batch_sizes.begin() + 101,
+                                      batch_sizes.end()),
+                  ::testing::ElementsAre(2, 2));
+    } else {
+      // A task that cannot be split still forms a batch on its own.
+      wait_for_batches(102);
+      mutex_lock l(mu);
+      EXPECT_THAT(std::vector<size_t>(batch_sizes.begin() + 101,
+                                      batch_sizes.end()),
+                  ::testing::ElementsAre(4));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, NegativeLatencyTargetIsRejected) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2);
+  options.target_p99_latency_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("target_p99_latency_micros")));
+}
+
+TEST_P(SharedBatchSchedulerTest, HigherPriorityQueueIsServedFirst) {
+  mutex mu;
+  std::vector<std::string> processed;
+  Notification blocker_started, release_blocker;
+  auto make_callback = [&](std::string name) {
+    return [&, name](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      bool block = false;
+      {
+        mutex_lock l(mu);
+        processed.push_back(name);
+        block = processed.size() == 1;
+      }
+      if (block) {
+        blocker_started.Notify();
+        release_blocker.WaitForNotification();
+      }
+    };
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  // Batches only become schedulable when full.
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/2, /*input_batch_size_limit=*/2,
+      /*batch_timeout_micros=*/1000 * 1000 * 1000, /*max_enqueued_batches=*/2);
+  options.scheduling_priority = 0;
+  auto low_priority_queue = CreateQueue(scheduler, options, make_callback("L"));
+  options.scheduling_priority = 1;
+  auto high_priority_queue =
+      CreateQueue(scheduler, options, make_callback("H"));
+
+  // Occupy the only batch thread, then make both queues schedulable.
+  TF_ASSERT_OK(ScheduleTask(2, low_priority_queue.get()));
+  blocker_started.WaitForNotification();
+  TF_ASSERT_OK(ScheduleTask(2, low_priority_queue.get()));
+  TF_ASSERT_OK(ScheduleTask(2, high_priority_queue.get()));
+  release_blocker.Notify();
+
+  low_priority_queue.reset();
+  high_priority_queue.reset();
+  EXPECT_THAT(processed, ::testing::ElementsAre("L", "H", "L"));
+}
+
+TEST_P(SharedBatchSchedulerTest, QueuesAreServedAccordingToTheirShares) {
+  mutex mu;
+  std::string processed;
+  Notification blocker_started, release_blocker;
+  auto make_callback = [&](char name) {
+    return [&, name](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      {
+        mutex_lock l(mu);
+        processed.push_back(name);
+      }
+      if (name == 'C') {
+        blocker_started.Notify();
+        release_blocker.WaitForNotification();
+      }
+    };
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/2, /*input_batch_size_limit=*/2,
+      /*batch_timeout_micros=*/1000 * 1000 * 1000, /*max_enqueued_batches=*/5);
+  auto queue_c = CreateQueue(scheduler, options, make_callback('C'));
+  auto queue_a = CreateQueue(scheduler, options, make_callback('A'));
+  options.scheduling_share = 2;
+  auto queue_b = CreateQueue(scheduler, options, make_callback('B'));
+
+  TF_ASSERT_OK(ScheduleTask(2, queue_c.get()));
+  blocker_started.WaitForNotification();
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(ScheduleTask(2, queue_a.get()));
+  }
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(ScheduleTask(2, queue_b.get()));
+  }
+  release_blocker.Notify();
+
+  queue_a.reset();
+  queue_b.reset();
+  queue_c.reset();
+  EXPECT_EQ(processed, "CABBABBA");
+}
+
+TEST_P(SharedBatchSchedulerTest, LowPriorityBatchesAreDispatchedInUnits) {
+  mutex mu;
+  std::vector<std::pair<std::string, size_t>> processed;
+  Notification first_unit_started, release_first_unit;
+  auto make_callback = [&](std::string name) {
+    return [&, name](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      bool block = false;
+      {
+        mutex_lock l(mu);
+        processed.emplace_back(name, batch->size());
+        block = processed.size() == 1;
+      }
+      if (block) {
+        first_unit_started.Notify();
+        release_first_unit.WaitForNotification();
+      }
+    };
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/3, /*input_batch_size_limit=*/3,
+      /*batch_timeout_micros=*/1000 * 1000 * 1000, /*max_enqueued_batches=*/2);
+  options.scheduling_priority = 1;
+  auto high_priority_queue =
+      CreateQueue(scheduler, options, make_callback("H"));
+  options.scheduling_priority = 0;
+  options.preemptible_batch_unit_size = 2;
+  auto low_priority_queue = CreateQueue(scheduler, options, make_callback("L"));
+
+  // A full low priority batch of three tasks is dispatched as a unit of two
+  // tasks, and the high priority batch that arrives meanwhile goes before the
+  // remaining task.
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(ScheduleTask(1, low_priority_queue.get()));
+  }
+  first_unit_started.WaitForNotification();
+  TF_ASSERT_OK(ScheduleTask(3, high_priority_queue.get()));
+  release_first_unit.Notify();
+
+  low_priority_queue.reset();
+  high_priority_queue.reset();
+  EXPECT_THAT(processed,
+              ::testing::ElementsAre(::testing::Pair("L", 2),
+                                     ::testing::Pair("H", 3),
+                                     ::testing::Pair("L", 1)));
+}
+
+TEST_P(SharedBatchSchedulerTest, FullLowPriorityQueueIsNotSplitIntoUnits) {
+  mutex mu;
+  std::vector<std::pair<std::string, size_t>> processed;
+  Notification first_batch_started, release_first_batch;
+  auto make_callback = [&](std::string name) {
+    return [&, name](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      bool block = false;
+      {
+        mutex_lock l(mu);
+        processed.emplace_back(name, batch->size());
+        block = processed.size() == 1;
+      }
+      if (block) {
+        first_batch_started.Notify();
+        release_first_batch.WaitForNotification();
+      }
+    };
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/3, /*input_batch_size_limit=*/3,
+      /*batch_timeout_micros=*/1000 * 1000 * 1000, /*max_enqueued_batches=*/1);
+  options.scheduling_priority = 1;
+  auto high_priority_queue =
+      CreateQueue(scheduler, options, make_callback("H"));
+  options.scheduling_priority = 0;
+  options.preemptible_batch_unit_size = 2;
+  auto low_priority_queue = CreateQueue(scheduler, options, make_callback("L"));
+
+  // The open batch already takes up the only slot of the low priority queue,
+  // so there is no room for the remainder and the batch is dispatched whole.
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(ScheduleTask(1, low_priority_queue.get()));
+  }
+  first_batch_started.WaitForNotification();
+  TF_ASSERT_OK(ScheduleTask(3, high_priority_queue.get()));
+  release_first_batch.Notify();
+
+  low_priority_queue.reset();
+  high_priority_queue.reset();
+  EXPECT_THAT(processed, ::testing::ElementsAre(::testing::Pair("L", 3),
+                                                ::testing::Pair("H", 3)));
+}
+
+TEST_P(SharedBatchSchedulerTest, NonPositiveSchedulingShareIsRejected) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2);
+  options.scheduling_share = 0;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("scheduling_share")));
+}
+
 TEST_P(SharedBatchSchedulerTest, Fairness) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
@@ -59,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/deep_conv2d.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/weights_cache.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -161,11 +162,14 @@ struct LaunchGeneric {
 // parity gap between convolution operations on different devices.
 template <typename T>
 struct LaunchGrouped {
+  // If `filter_cache` is not null the filter is constant, and its shuffled
+  // copy is cached there.
   void operator()(OpKernelContext* ctx, const Tensor& input,
                   const Tensor& filter, int row_stride, int col_stride,
                   int row_dilation, int col_dilation, const Padding& padding,
                   const std::vector<int64_t>& explicit_paddings, Tensor* output,
-                  TensorFormat data_format) {
+                  TensorFormat data_format,
+                  WeightsCache* filter_cache = nullptr) {
     DCHECK(data_format == FORMAT_NHWC)
         << "Grouped conv implementation only "
            "supports NHWC tensor format for now.";
@@ -191,7 +195,23 @@ struct LaunchGrouped {
 
     auto& device = ctx->eigen_device<CPUDevice>();
 
-    absl::BlockingCounter shuffles_completed(2);
+    // A constant filter is shuffled only once, before the input shuffle starts
+    // so that an error can not leave it running.
+    Tensor filter_shuffled;
+    if (filter_cache != nullptr) {
+      auto shuffle_filter = [&](const Tensor& filter,
+                                Tensor* shuffled) -> absl::Status {
+        TF_RETURN_IF_ERROR(ctx->allocate_temp(
+            filter.dtype(), TensorShape(post_shuffle(filter)), shuffled));
+        shuffled->tensor<T, 5>().device(device) =
+            filter.shaped<T, 5>(pre_shuffle(filter)).shuffle(shuffle);
+        return absl::OkStatus();
+      };
+      OP_REQUIRES_OK(ctx, filter_cache->GetOrCompute(filter, shuffle_filter,
+                                                     &filter_shuffled));
+    }
+
+    absl::BlockingCounter shuffles_completed(filter_cache == nullptr ? 2 : 1);
     auto on_shuffled = [&]() { shuffles_completed.DecrementCount(); };
 
     // Shuffle input into temporary tensor.
@@ -203,12 +223,13 @@ struct LaunchGrouped {
         input.shaped<T, 5>(pre_shuffle(input)).shuffle(shuffle);
 
     // Shuffle filter into temporary tensor.
-    Tensor filter_shuffled;
-    OP_REQUIRES_OK(ctx, ctx->allocate_temp(filter.dtype(),
-                                           TensorShape(post_shuffle(filter)),
-                                           &filter_shuffled));
-    filter_shuffled.tensor<T, 5>().device(device, on_shuffled) =
-        filter.shaped<T, 5>(pre_shuffle(filter)).shuffle(shuffle);
+    if (filter_cache == nullptr) {
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(filter.dtype(),
+                                             TensorShape(post_shuffle(filter)),
+                                             &filter_shuffled));
+      filter_shuffled.tensor<T, 5>().device(device, on_shuffled) =
+          filter.shaped<T, 5>(pre_shuffle(filter)).shuffle(shuffle);
+    }
 
     // Wait for the completion of input/filter shuffles.
     shuffles_completed.Wait();
@@ -615,13 +636,22 @@ struct LaunchConv2DOp<CPUDevice, T> {
     if (in_depth != patch_depth) {
       LaunchGrouped<T>()(ctx, input, filter, row_stride, col_stride,
                          row_dilation, col_dilation, padding, explicit_paddings,
-                         output, data_format);
+                         output, data_format, filter_cache_);
     } else {
       LaunchGeneric<CPUDevice, T>()(ctx, input, filter, row_stride, col_stride,
                                     row_dilation, col_dilation, padding,
                                     explicit_paddings, output, data_format);
     }
   }
+
+  // Caches transformations of a constant filter in `filter_cache`, which must
+  // outlive the launcher.
+  void set_filter_cache(WeightsCache* filter_cache) {
+    filter_cache_ = filter_cache;
+  }
+
+ private:
+  WeightsCache* filter_cache_ = nullptr;
 };
 extern template struct LaunchConv2DOp<CPUDevice, Eigen::bfloat16>;
 extern template struct LaunchConv2DOp<CPUDevice, Eigen::half>;
@@ -652,6 +682,11 @@ class Conv2DOp : public BinaryOp<T> {
 
     OP_REQUIRES_OK(context, context->GetAttr("use_cudnn_on_gpu", &use_cudnn_));
     cudnn_use_autotune_ = CudnnUseAutotune();
+    if constexpr (std::is_same_v<Device, CPUDevice>) {
+      if (WeightsCache::WeightsAreConstant(context)) {
+        launcher_.set_filter_cache(&filter_cache_);
+      }
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -727,6 +762,7 @@ class Conv2DOp : public BinaryOp<T> {
   bool use_cudnn_;
   bool cudnn_use_autotune_;
 
+  WeightsCache filter_cache_;
   LaunchConv2DOp<Device, T> launcher_;
 
   Conv2DOp(const Conv2DOp&) = delete;
@@ -479,6 +479,31 @@ TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+TEST_F(ConvOpTest, GroupedConvWithConstFilter) {
+  TF_EXPECT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "VALID")
+                   .Attr("_grappler_const_weights", true)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  // Two groups of one input and two output channels each.
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 4}), {1, 2, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_FLOAT, TensorShape({1, 1, 2, 4}));
+  test::FillValues<float>(&expected, {1, 2, 6, 8, 3, 6, 12, 16});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+
+  // The second step reuses the shuffled filter.
+  test::FillValues<float>(mutable_input(0).tensor, {-1, 0, 1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  test::FillValues<float>(&expected, {-1, -2, 0, 0, 1, 2, 6, 8});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
 template <typename T>
 class FusedConv2DOpTest : public OpsTestBase {
  protected:
@@ -23,6 +23,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "tensorflow/core/data/chunked_cache_file.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -63,6 +65,10 @@ constexpr char kLockFileSuffix[] = ".lockfile";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
+constexpr char kChunkedFormat[] = "chunked_format";
+constexpr char kChunkedFormatExperiment[] = "cache_chunked_file_format";
+// Number of chunks the chunked cache reader decodes ahead of the consumer.
+constexpr int kChunkedReadPrefetch = 4;
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
@@ -235,13 +241,22 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                            tensor_index);
   }
 
+  // Returns true if the cache at `filename_` has been completely written, in
+  // either the tensor bundle or the chunked format.
+  bool CacheCompleted() const {
+    return env_->FileExists(MetaFilename(filename_)).ok() ||
+           env_->FileExists(ChunkedCacheIndexFilename(filename_)).ok();
+  }
+
+  bool ChunkedCacheCompleted() const {
+    return env_->FileExists(ChunkedCacheIndexFilename(filename_)).ok();
+  }
+
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->CacheCompleted()) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -281,10 +296,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kMode, &temp));
         mode_ = static_cast<Mode>(temp);
       }
-      if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+      if (mode_ == Mode::write && dataset()->CacheCompleted()) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
@@ -316,6 +328,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
     // When all elements have been produced, these shards get coalesced.
+    //
+    // When the "cache_chunked_file_format" experiment is enabled, elements are
+    // instead written with `ChunkedCacheWriter` to one chunk file per shard.
+    // Completing the cache writes an index file listing the shards, so no
+    // merge step is needed.
     class FileWriterIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileWriterIterator(const Params& params)
@@ -326,10 +343,21 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                 strings::StrCat(params.dataset->filename_, "_", shard_id_)),
             lockfile_(strings::StrCat(filename_, kLockFileSuffix)),
             lockfile_created_(false),
-            iteration_completed_(false) {}
+            iteration_completed_(false),
+            use_chunked_format_(
+                GetExperiments().contains(kChunkedFormatExperiment)) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        bool use_chunked_format;
+        {
+          mutex_lock l(mu_);
+          use_chunked_format = use_chunked_format_;
+        }
+        const bool completed =
+            use_chunked_format
+                ? dataset()->ChunkedCacheCompleted()
+                : dataset()->env_->FileExists(MetaFilename(filename_)).ok();
+        if (!completed) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           std::vector<string> cache_files;
           absl::Status s = dataset()->env_->GetMatchingPaths(
@@ -362,7 +390,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           return absl::OkStatus();
         }
-        TF_RETURN_IF_ERROR(writer_->status());
+        if (!use_chunked_format_) {
+          TF_RETURN_IF_ERROR(writer_->status());
+        }
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
           absl::Status s = Finish();
@@ -387,12 +417,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
               "Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_->Add(key, t));
-        }
+        TF_RETURN_IF_ERROR(WriteElementLocked(*out_tensors));
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
         }
@@ -412,6 +437,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kCurIndex, cur_index_));
+        if (use_chunked_format_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kChunkedFormat, ""));
+        }
 
         if (iteration_completed_) {
           TF_RETURN_IF_ERROR(
@@ -425,8 +453,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // about flushing the current shard. This ensures that we never write
         // empty shards.
         if (lockfile_created_) {
-          // Flush the current bundle.
-          TF_RETURN_IF_ERROR(writer_->Finish());
+          // Flush the current shard.
+          TF_RETURN_IF_ERROR(FlushShardLocked());
 
           // Note: We do not delete the lockfile here. We keep lockfiles of
           // all shards around until the entire cache has been written to
@@ -456,6 +484,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             return errors::Internal("Invalid value for cur_index ", temp);
           }
         }
+        use_chunked_format_ = reader->Contains(prefix(), kChunkedFormat);
 
         if (reader->Contains(prefix(), kIterationCompleted)) {
           iteration_completed_ = true;
@@ -475,11 +504,47 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        if (!use_chunked_format_) {
+          writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        }
         return absl::OkStatus();
       }
 
      private:
+      // Creates the writer for the current shard.
+      absl::Status NewShardWriterLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (use_chunked_format_) {
+          chunked_writer_ = std::make_unique<ChunkedCacheWriter>(
+              dataset()->env_,
+              ChunkedCacheShardFilename(dataset()->filename_, shard_id_),
+              dataset()->num_tensors_, /*compress=*/true);
+          return chunked_writer_->Initialize();
+        }
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        return absl::OkStatus();
+      }
+
+      absl::Status WriteElementLocked(const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (use_chunked_format_) {
+          return chunked_writer_->Write(element);
+        }
+        size_t tensor_index = 0;
+        for (const Tensor& t : element) {
+          DCHECK_LT(tensor_index, dataset()->num_tensors_);
+          string key = dataset()->FormatName(cur_index_, tensor_index++);
+          TF_RETURN_IF_ERROR(writer_->Add(key, t));
+        }
+        return absl::OkStatus();
+      }
+
+      absl::Status FlushShardLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (use_chunked_format_) {
+          return chunked_writer_->Close();
+        }
+        return writer_->Finish();
+      }
+
       absl::Status EnsureLockFileExists(bool* end_of_sequence)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -537,23 +602,28 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        TF_RETURN_IF_ERROR(NewShardWriterLocked());
         lockfile_created_ = true;
         return absl::OkStatus();
       }
 
       absl::Status Finish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
-        // Flush the current bundle.
-        TF_RETURN_IF_ERROR(writer_->Finish());
-        // Merge all the bundles.
-        // Currently there are `shard_id_ + 1` bundles, one for each
-        // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
-        // integer starting at 0 and incremented by 1 for each new checkpoint.
-        // We merge all these bundles into a bundle with prefix <filename> so
-        // that the next call to `MakeIterator` can build a
-        // `FileReaderIterator`.
-        {
+        // Flush the current shard.
+        TF_RETURN_IF_ERROR(FlushShardLocked());
+        if (use_chunked_format_) {
+          // Chunk files are read in place. Writing the index marks the cache
+          // as complete.
+          TF_RETURN_IF_ERROR(WriteChunkedCacheIndex(
+              dataset()->env_, dataset()->filename_, shard_id_ + 1));
+        } else {
+          // Merge all the bundles.
+          // Currently there are `shard_id_ + 1` bundles, one for each
+          // checkpoint. Each bundle has prefix <filename>_<id> where `id` is
+          // an integer starting at 0 and incremented by 1 for each new
+          // checkpoint. We merge all these bundles into a bundle with prefix
+          // <filename> so that the next call to `MakeIterator` can build a
+          // `FileReaderIterator`.
           std::vector<tstring> prefixes;
           prefixes.reserve(shard_id_ + 1);
           for (size_t i = 0; i <= shard_id_; ++i) {
@@ -581,9 +651,14 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `StrCat(dataset()->filename_, "_", shard_id_)`.
       string filename_;
       std::unique_ptr<BundleWriter> writer_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<ChunkedCacheWriter> chunked_writer_ TF_GUARDED_BY(mu_);
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
+      // Whether shards are written with `ChunkedCacheWriter` rather than
+      // `BundleWriter`. Restored from the checkpoint so that all shards of a
+      // cache use the same format.
+      bool use_chunked_format_ TF_GUARDED_BY(mu_);
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
@@ -675,6 +750,75 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // ChunkedFileReaderIterator reads a cache written in the chunked format.
+    // Chunks are read sequentially and decoded ahead of the consumer on the
+    // iterator's runner.
+    class ChunkedFileReaderIterator : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit ChunkedFileReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params), cur_index_(0) {}
+
+      absl::Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        return ResetReaderLocked(ctx);
+      }
+
+      absl::Status GetNextInternal(IteratorContext* ctx,
+                                   std::vector<Tensor>* out_tensors,
+                                   bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        out_tensors->clear();
+        TF_RETURN_IF_ERROR(reader_->ReadElement(out_tensors, end_of_sequence));
+        if (!*end_of_sequence) {
+          cur_index_++;
+        }
+        return absl::OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      absl::Status SaveInternal(SerializationContext* ctx,
+                                IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kCurIndex, cur_index_));
+        return absl::OkStatus();
+      }
+
+      absl::Status RestoreInternal(
+          IteratorContext* ctx,
+          IteratorStateReader* iterator_state_reader) override {
+        mutex_lock l(mu_);
+        int64_t temp;
+        TF_RETURN_IF_ERROR(
+            iterator_state_reader->ReadScalar(prefix(), kCurIndex, &temp));
+        if (temp < 0) {
+          return errors::Internal("Invalid value for cur_index ", temp);
+        }
+        cur_index_ = temp;
+        TF_RETURN_IF_ERROR(ResetReaderLocked(ctx));
+        return reader_->SkipElements(cur_index_);
+      }
+
+     private:
+      absl::Status ResetReaderLocked(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        reader_ = std::make_unique<ChunkedCacheReader>(
+            dataset()->env_, dataset()->filename_, dataset()->num_tensors_,
+            kChunkedReadPrefetch, *ctx->runner());
+        return reader_->Initialize();
+      }
+
+      mutex mu_;
+      int64_t cur_index_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<ChunkedCacheReader> reader_ TF_GUARDED_BY(mu_);
+    };  // ChunkedFileReaderIterator
+
     absl::Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -687,9 +831,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              std::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->ChunkedCacheCompleted()) {
+            iterator_ = std::make_unique<ChunkedFileReaderIterator>(
+                ChunkedFileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = std::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -15,17 +15,54 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
 namespace experimental {
+namespace {
+
+// Returns the pool on which the chunks of an element are (un)compressed.
+thread::ThreadPool* GetThreadPool(OpKernelContext* ctx) {
+  const DeviceBase::CpuWorkerThreads* worker_threads =
+      ctx->device()->tensorflow_cpu_worker_threads();
+  return worker_threads != nullptr ? worker_threads->workers : nullptr;
+}
+
+}  // namespace
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  // The attrs are absent from graphs serialized before they were added, in
+  // which case the default options apply.
+  if (ctx->HasAttr(kCodec)) {
+    std::string codec;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+    if (codec == "none") {
+      options_.codec = CompressedElement::NONE;
+    } else if (codec == "zstd") {
+      options_.codec = CompressedElement::ZSTD;
+    } else {
+      options_.codec = CompressedElement::SNAPPY;
+    }
+  }
+  if (ctx->HasAttr(kLevel)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kLevel, &options_.level));
+  }
+  if (ctx->HasAttr(kChunkSizeBytes)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kChunkSizeBytes, &options_.chunk_size_bytes));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -34,7 +71,8 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, options_,
+                                      GetThreadPool(ctx), &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -68,7 +106,8 @@ void UncompressElementOp::Compute(OpKernelContext* ctx) {
           tensor.DebugString()));
 
   std::vector<Tensor> components;
-  OP_REQUIRES_OK(ctx, UncompressElement(*compressed, &components));
+  OP_REQUIRES_OK(ctx, UncompressElement(*compressed, GetThreadPool(ctx),
+                                        &components));
   OP_REQUIRES(ctx, components.size() == output_types_.size(),
               errors::FailedPrecondition("Expected ", output_types_.size(),
                                          " outputs from uncompress, but got ",
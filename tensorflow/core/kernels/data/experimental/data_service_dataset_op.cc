@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -704,13 +705,19 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
     should_uncompress =
         should_uncompress &&
         (*compression == DataServiceMetadata::COMPRESSION_SNAPPY ||
-         *compression == DataServiceMetadata::COMPRESSION_FORCED_SNAPPY);
+         *compression == DataServiceMetadata::COMPRESSION_FORCED_SNAPPY ||
+         *compression == DataServiceMetadata::COMPRESSION_ZSTD);
   }
   if (should_uncompress) {
     absl::StatusOr<bool> disable_compression_at_runtime =
         DisableCompressionAtRuntime(data_transfer_protocol_,
                                     config->deployment_mode(), *compression);
     OP_REQUIRES_OK(ctx, disable_compression_at_runtime.status());
+    // Compressed elements are variants, which the shared-memory transfer
+    // protocol can't hand to the client without copying.
+    if (data_transfer_protocol_ == kShmTransferProtocol) {
+      *disable_compression_at_runtime = true;
+    }
     absl::StatusOr<bool> compression_disabled_at_runtime =
         CompressionDisabledAtRuntime(dataset_id, address, protocol,
                                      *disable_compression_at_runtime);
@@ -0,0 +1,447 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/map_filter_batch_dataset_op.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kMapOtherArguments;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kPredicateOtherArguments;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kBatchSize;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kFunc;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kPredicate;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kTmapArguments;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kTpredicateArguments;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const MapFilterBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    MapFilterBatchDatasetOp::kPreserveCardinality;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+
+}  // namespace
+
+class MapFilterBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t batch_size,
+          bool drop_remainder, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes,
+          std::unique_ptr<CapturedFunction> captured_func,
+          std::unique_ptr<CapturedFunction> captured_predicate,
+          bool preserve_cardinality)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        batch_size_(batch_size),
+        drop_remainder_(drop_remainder),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        captured_func_(std::move(captured_func)),
+        captured_predicate_(std::move(captured_predicate)),
+        preserve_cardinality_(preserve_cardinality),
+        traceme_metadata_(
+            {{"batch_size",
+              strings::Printf("%lld", static_cast<long long>(batch_size))},
+             {"drop_remainder", drop_remainder ? "true" : "false"}}) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckExternalState() const override {
+    TF_RETURN_IF_ERROR(captured_func_->CheckExternalState());
+    TF_RETURN_IF_ERROR(captured_predicate_->CheckExternalState());
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* batch_size_node;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size_node));
+    Node* drop_remainder_node;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder_node));
+    std::vector<Node*> map_other_arguments;
+    DataTypeVector map_other_arguments_types;
+    TF_RETURN_IF_ERROR(captured_func_->AddToGraph(
+        ctx, b, &map_other_arguments, &map_other_arguments_types));
+    std::vector<Node*> predicate_other_arguments;
+    DataTypeVector predicate_other_arguments_types;
+    TF_RETURN_IF_ERROR(captured_predicate_->AddToGraph(
+        ctx, b, &predicate_other_arguments, &predicate_other_arguments_types));
+    AttrValue f;
+    b->BuildAttrValue(captured_func_->func(), &f);
+    AttrValue predicate;
+    b->BuildAttrValue(captured_predicate_->func(), &predicate);
+    AttrValue map_other_arguments_types_attr;
+    b->BuildAttrValue(map_other_arguments_types,
+                      &map_other_arguments_types_attr);
+    AttrValue predicate_other_arguments_types_attr;
+    b->BuildAttrValue(predicate_other_arguments_types,
+                      &predicate_other_arguments_types_attr);
+    AttrValue preserve_cardinality_attr;
+    b->BuildAttrValue(preserve_cardinality_, &preserve_cardinality_attr);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {std::make_pair(0, input_graph_node),
+         std::make_pair(3, batch_size_node),
+         std::make_pair(4, drop_remainder_node)},  // Single tensor inputs.
+        {std::make_pair(1, map_other_arguments),
+         std::make_pair(2, predicate_other_arguments)},  // Tensor list inputs.
+        {std::make_pair(kFunc, f), std::make_pair(kPredicate, predicate),
+         std::make_pair(kTmapArguments, map_other_arguments_types_attr),
+         std::make_pair(kTpredicateArguments,
+                        predicate_other_arguments_types_attr),
+         std::make_pair(kPreserveCardinality,
+                        preserve_cardinality_attr)},  // Attrs
+        output));
+    return absl::OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    absl::Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      TF_RETURN_IF_ERROR(
+          dataset()->captured_func_->Instantiate(ctx, &instantiated_func_));
+      return dataset()->captured_predicate_->Instantiate(
+          ctx, &instantiated_predicate_);
+    }
+
+    absl::Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      std::vector<Tensor> batch;
+      int64_t num_elements = 0;
+      std::vector<Tensor> input_element;
+      std::vector<Tensor> mapped_element;
+      std::vector<Tensor> predicate_result;
+      while (input_impl_ && num_elements < dataset()->batch_size_) {
+        input_element.clear();
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &input_element, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        mapped_element.clear();
+        absl::Status s = instantiated_func_->Run(
+            ctx, std::move(input_element), &mapped_element, model_node());
+        if (errors::IsOutOfRange(s)) {
+          if (dataset()->preserve_cardinality_) {
+            // To guarantee that the map preserves the cardinality of its
+            // input, we convert `OutOfRange` to `InvalidArgument` as the former
+            // may be interpreted by a caller as the end of sequence.
+            return errors::InvalidArgument(
+                "Function invocation produced OutOfRangeError: ", s.message());
+          }
+          // `f` may deliberately raise `errors::OutOfRange` to indicate that
+          // we should terminate the iteration early.
+          input_impl_.reset();
+          break;
+        }
+        TF_RETURN_IF_ERROR(s);
+
+        predicate_result.clear();
+        s = instantiated_predicate_->RunWithBorrowedArgs(
+            ctx, mapped_element, &predicate_result, model_node());
+        if (!s.ok()) {
+          return AddErrorContext(s);
+        }
+        if (predicate_result.size() != 1 ||
+            predicate_result[0].dtype() != DT_BOOL ||
+            predicate_result[0].NumElements() != 1) {
+          return errors::InvalidArgument(
+              "Filter predicate `predicate` must return a scalar bool.");
+        }
+        if (!predicate_result[0].scalar<bool>()()) {
+          continue;
+        }
+        if (batch.empty()) {
+          TF_RETURN_IF_ERROR(AllocateBatch(ctx, mapped_element, &batch));
+        }
+        TF_RETURN_IF_ERROR(CopyElementToBatch(std::move(mapped_element),
+                                              num_elements, &batch));
+        ++num_elements;
+      }
+
+      if (num_elements == 0 ||
+          (num_elements < dataset()->batch_size_ &&
+           dataset()->drop_remainder_)) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      if (num_elements < dataset()->batch_size_) {
+        TF_RETURN_IF_ERROR(TrimBatch(ctx, num_elements, &batch));
+      }
+      *out_tensors = std::move(batch);
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    absl::Status SaveInternal(SerializationContext* ctx,
+                              IteratorStateWriter* writer) override {
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+          dataset()->captured_func_->CheckExternalState()));
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+          dataset()->captured_predicate_->CheckExternalState()));
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kInputImplEmpty, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status RestoreInternal(IteratorContext* ctx,
+                                 IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_empty;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kInputImplEmpty, &input_empty));
+      if (static_cast<bool>(input_empty)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // Allocates the output batch, using `element` as the template for the
+    // shape and type of each component. Elements are copied into the batch as
+    // soon as they pass the predicate, so the batch is allocated at its full
+    // size up front.
+    absl::Status AllocateBatch(IteratorContext* ctx,
+                               const std::vector<Tensor>& element,
+                               std::vector<Tensor>* batch) {
+      if (element.size() != dataset()->output_types_.size()) {
+        return errors::InvalidArgument(
+            "Function `f` returned ", element.size(),
+            " components, but the dataset expects ",
+            dataset()->output_types_.size(), ".");
+      }
+      batch->reserve(element.size());
+      for (size_t i = 0; i < element.size(); ++i) {
+        if (element[i].dtype() != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Function `f` returned a ", DataTypeString(element[i].dtype()),
+              " tensor for component ", i, ", but the dataset expects ",
+              DataTypeString(dataset()->output_types_[i]), ".");
+        }
+        TensorShape batch_component_shape({dataset()->batch_size_});
+        batch_component_shape.AppendShape(element[i].shape());
+        batch->emplace_back(ctx->allocator({}), element[i].dtype(),
+                            batch_component_shape);
+        if (!batch->back().IsInitialized()) {
+          return errors::ResourceExhausted(
+              "Failed to allocate memory for the batch of component ", i);
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    // Copies `element` into the `index`-th slice of `batch`.
+    absl::Status CopyElementToBatch(std::vector<Tensor>&& element,
+                                    int64_t index, std::vector<Tensor>* batch) {
+      if (element.size() != batch->size()) {
+        return errors::InvalidArgument(
+            "Function `f` returned ", element.size(),
+            " components, but the dataset expects ", batch->size(), ".");
+      }
+      for (size_t i = 0; i < element.size(); ++i) {
+        Tensor& batch_component = (*batch)[i];
+        const int64_t num_dims = batch_component.dims() - 1;
+        bool same_shape = element[i].dims() == num_dims;
+        for (int64_t d = 0; same_shape && d < num_dims; ++d) {
+          same_shape =
+              element[i].dim_size(d) == batch_component.dim_size(d + 1);
+        }
+        if (!same_shape) {
+          TensorShape first_element_shape = batch_component.shape();
+          first_element_shape.RemoveDim(0);
+          return errors::InvalidArgument(
+              "Cannot batch tensors with different shapes in component ", i,
+              ". First element had shape ", first_element_shape.DebugString(),
+              " and element ", index, " had shape ",
+              element[i].shape().DebugString(), ".");
+        }
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+            std::move(element[i]), &batch_component, index));
+      }
+      return absl::OkStatus();
+    }
+
+    // Shrinks the components of `batch` to their first `num_elements` slices.
+    absl::Status TrimBatch(IteratorContext* ctx, int64_t num_elements,
+                           std::vector<Tensor>* batch) {
+      for (Tensor& batch_component : *batch) {
+        TensorShape trimmed_shape = batch_component.shape();
+        trimmed_shape.set_dim(0, num_elements);
+        Tensor trimmed(ctx->allocator({}), batch_component.dtype(),
+                       trimmed_shape);
+        TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+            batch_component, /*src_offset=*/0, /*dst_offset=*/0, num_elements,
+            &trimmed));
+        batch_component = std::move(trimmed);
+      }
+      return absl::OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_func_;
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_predicate_;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t batch_size_;
+  const bool drop_remainder_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  const std::unique_ptr<CapturedFunction> captured_func_;
+  const std::unique_ptr<CapturedFunction> captured_predicate_;
+  const bool preserve_cardinality_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+MapFilterBatchDatasetOp::MapFilterBatchDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kFunc, /*params=*/{},
+                                               &func_metadata_));
+  OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kPredicate, /*params=*/{},
+                                               &predicate_metadata_));
+  OP_REQUIRES(
+      ctx, predicate_metadata_->short_circuit_info().indices.size() <= 1,
+      errors::InvalidArgument(
+          "predicate function has more than one return value."));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kPreserveCardinality, &preserve_cardinality_));
+}
+
+void MapFilterBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                          DatasetBase* input,
+                                          DatasetBase** output) {
+  int64_t batch_size = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("batch_size must be greater than zero."));
+
+  bool drop_remainder;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument(ctx, kDropRemainder, &drop_remainder));
+
+  std::unique_ptr<CapturedFunction> captured_func;
+  OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_metadata_,
+                                               kMapOtherArguments,
+                                               &captured_func));
+  std::unique_ptr<CapturedFunction> captured_predicate;
+  OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, predicate_metadata_,
+                                               kPredicateOtherArguments,
+                                               &captured_predicate));
+
+  *output = new Dataset(ctx, input, batch_size, drop_remainder, output_types_,
+                        output_shapes_, std::move(captured_func),
+                        std::move(captured_predicate), preserve_cardinality_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("MapFilterBatchDataset").Device(DEVICE_CPU),
+                        MapFilterBatchDatasetOp);
+REGISTER_INPUT_COLOCATION_EXEMPTION("MapFilterBatchDataset");
+}  // namespace
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
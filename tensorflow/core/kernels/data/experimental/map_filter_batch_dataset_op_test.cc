@@ -0,0 +1,150 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/map_filter_batch_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "map_filter_batch_dataset";
+
+class MapFilterBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  MapFilterBatchDatasetParams(T input_dataset_params, int64_t batch_size,
+                              bool drop_remainder,
+                              FunctionDefHelper::AttrValueWrapper func,
+                              FunctionDefHelper::AttrValueWrapper predicate,
+                              std::vector<FunctionDef> func_lib,
+                              DataTypeVector output_dtypes,
+                              std::vector<PartialTensorShape> output_shapes,
+                              string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        batch_size_(batch_size),
+        drop_remainder_(drop_remainder),
+        func_(std::move(func)),
+        predicate_(std::move(predicate)),
+        func_lib_(std::move(func_lib)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {batch_size_}),
+            CreateTensor<bool>(TensorShape({}), {drop_remainder_})};
+  }
+
+  absl::Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {MapFilterBatchDatasetOp::kInputDataset,
+                    MapFilterBatchDatasetOp::kBatchSize,
+                    MapFilterBatchDatasetOp::kDropRemainder};
+    return absl::OkStatus();
+  }
+
+  absl::Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"f", func_},
+                    {"predicate", predicate_},
+                    {"Tmap_arguments", DataTypeVector{}},
+                    {"Tpredicate_arguments", DataTypeVector{}},
+                    {"output_shapes", output_shapes_},
+                    {"output_types", output_dtypes_},
+                    {"preserve_cardinality", false},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  std::vector<FunctionDef> func_lib() const override { return func_lib_; }
+
+  string dataset_type() const override {
+    return MapFilterBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t batch_size_;
+  bool drop_remainder_;
+  FunctionDefHelper::AttrValueWrapper func_;
+  FunctionDefHelper::AttrValueWrapper predicate_;
+  std::vector<FunctionDef> func_lib_;
+};
+
+class MapFilterBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+// Maps `x -> 2 * x` over [0, 10), keeps the elements `<= 10` and batches them.
+MapFilterBatchDatasetParams MakeDatasetParams(int64_t batch_size,
+                                              bool drop_remainder) {
+  return MapFilterBatchDatasetParams(
+      RangeDatasetParams(0, 10, 1), batch_size, drop_remainder,
+      /*func=*/FunctionDefHelper::FunctionRef("XTimesTwo", {{"T", DT_INT64}}),
+      /*predicate=*/
+      FunctionDefHelper::FunctionRef("LessThanOrEqualToN", {{"T", DT_INT64}}),
+      /*func_lib=*/
+      {test::function::XTimesTwo(), test::function::LessThanOrEqualToN(10)},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({batch_size})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<MapFilterBatchDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/MakeDatasetParams(4, /*drop_remainder=*/false),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({4}), {0, 2, 4, 6}),
+            CreateTensor<int64_t>(TensorShape({2}), {8, 10})}},
+          {/*dataset_params=*/MakeDatasetParams(4, /*drop_remainder=*/true),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({4}), {0, 2, 4, 6})}},
+          {/*dataset_params=*/MakeDatasetParams(3, /*drop_remainder=*/true),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({3}), {{0, 2, 4}, {6, 8, 10}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(MapFilterBatchDatasetOpTest,
+                         MapFilterBatchDatasetParams, GetNextTestCases())
+
+TEST_F(MapFilterBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = MakeDatasetParams(4, /*drop_remainder=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(MapFilterBatchDatasetOp::kDatasetType)));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<MapFilterBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/MakeDatasetParams(4, /*drop_remainder=*/false),
+           /*breakpoints=*/{0, 1, 4},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape({4}), {0, 2, 4, 6}),
+            CreateTensor<int64_t>(TensorShape({2}), {8, 10})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(MapFilterBatchDatasetOpTest,
+                                 MapFilterBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(MapFilterBatchDatasetOpTest, InvalidBatchSize) {
+  auto dataset_params = MakeDatasetParams(0, /*drop_remainder=*/false);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -197,6 +197,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
          it++) {
       it->second = i++;
     }
+    // The config is shared by all iterators, so build its feature lookup table
+    // once instead of for every parsed batch.
+    OP_REQUIRES_OK(ctx,
+                   example::PrecomputeFastParseExampleConfigIndex(&config));
 
     *output = new Dataset(
         ctx, input, dense_defaults, sparse_keys_, dense_keys_,
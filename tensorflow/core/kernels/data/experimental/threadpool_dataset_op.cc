@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/threadpool_dataset_op.h"
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -67,15 +70,34 @@ class ThreadPoolResource : public ResourceBase {
   ThreadPoolResource(Env* env, const ThreadOptions& thread_options,
                      const string& name, int num_threads, bool low_latency_hint,
                      int max_intra_op_parallelism)
-      : thread_pool_(env, thread_options, name, num_threads, low_latency_hint),
-        max_intra_op_parallelism_(max_intra_op_parallelism) {}
+      : max_intra_op_parallelism_(max_intra_op_parallelism) {
+    const int num_nodes =
+        NumaAwareThreadPoolsEnabled() ? port::NUMANumNodes() : 1;
+    if (num_nodes < 2 || num_threads < num_nodes) {
+      thread_pools_.push_back(std::make_unique<thread::ThreadPool>(
+          env, thread_options, name, num_threads, low_latency_hint));
+      return;
+    }
+    // Split the threads evenly across NUMA nodes so that work scheduled from
+    // a node runs, and touches the memory it allocates, on that node.
+    for (int node = 0; node < num_nodes; ++node) {
+      ThreadOptions node_options = thread_options;
+      node_options.numa_node = node;
+      const int node_threads = num_threads * (node + 1) / num_nodes -
+                               num_threads * node / num_nodes;
+      thread_pools_.push_back(std::make_unique<thread::ThreadPool>(
+          env, node_options, strings::StrCat(name, "_numa", node),
+          node_threads, low_latency_hint));
+    }
+  }
 
   // Schedules fn() for execution in the pool of threads.
   void Schedule(std::function<void()> fn) {
+    thread::ThreadPool* pool = PoolForCurrentThread();
     if (max_intra_op_parallelism_ < 0) {
-      thread_pool_.Schedule(std::move(fn));
+      pool->Schedule(std::move(fn));
     } else {
-      thread_pool_.Schedule(std::bind(
+      pool->Schedule(std::bind(
           [this](std::function<void()> bound_fn) {
             // TODO(mrry): Consider moving this thread-local configuration to
             // the threads themselves.
@@ -86,12 +108,36 @@ class ThreadPoolResource : public ResourceBase {
     }
   }
 
-  int32 NumThreads() { return thread_pool_.NumThreads(); }
+  int32 NumThreads() {
+    int32 num_threads = 0;
+    for (const auto& pool : thread_pools_) {
+      num_threads += pool->NumThreads();
+    }
+    return num_threads;
+  }
 
   string DebugString() const override { return "ThreadPoolResource"; }
 
  private:
-  thread::ThreadPool thread_pool_;
+  // Returns the pool pinned to the calling thread's NUMA node. Callers that
+  // are not bound to a node are spread across the pools round-robin.
+  thread::ThreadPool* PoolForCurrentThread() {
+    if (thread_pools_.size() == 1) {
+      return thread_pools_[0].get();
+    }
+    const int node = port::NUMAGetThreadNodeAffinity();
+    if (node >= 0 && static_cast<size_t>(node) < thread_pools_.size()) {
+      return thread_pools_[node].get();
+    }
+    return thread_pools_[next_pool_.fetch_add(1, std::memory_order_relaxed) %
+                         thread_pools_.size()]
+        .get();
+  }
+
+  // Holds a single pool unless NUMA-aware thread pools are enabled, in which
+  // case the pool at index `i` runs on NUMA node `i`.
+  std::vector<std::unique_ptr<thread::ThreadPool>> thread_pools_;
+  std::atomic<uint64_t> next_pool_{0};
   const int max_intra_op_parallelism_;
 };
 
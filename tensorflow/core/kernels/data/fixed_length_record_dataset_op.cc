@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/read_ahead_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 
@@ -47,6 +49,9 @@ constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
 constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
+constexpr char kReadAheadExperiment[] = "file_read_ahead";
+// Number of `buffer_size` reads kept in flight when reading ahead.
+constexpr int kReadAheadDepth = 4;
 
 class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
  public:
@@ -61,7 +66,8 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         footer_bytes_(footer_bytes),
         buffer_size_(buffer_size),
         compression_type_(compression_type),
-        op_version_(op_version) {}
+        op_version_(op_version),
+        use_read_ahead_(GetExperiments().contains(kReadAheadExperiment)) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
@@ -137,20 +143,19 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (input_buffer_) {
-          const int64_t current_pos = input_buffer_->Tell();
+        if (input_buffer_ || read_ahead_stream_) {
+          const int64_t current_pos = TellLocked();
           DCHECK_GE(file_pos_limit_, 0);
           if (current_pos < file_pos_limit_) {
-            string record;
-            TF_RETURN_IF_ERROR(
-                input_buffer_->ReadNBytes(dataset()->record_bytes_, &record));
+            tstring record;
+            TF_RETURN_IF_ERROR(ReadRecordLocked(&record));
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
             bytes_counter->IncrementBy(dataset()->record_bytes_);
 
             // Produce the record as output.
             Tensor record_tensor(ctx->allocator({}), DT_STRING, {});
-            record_tensor.scalar<tstring>()() = record;
+            record_tensor.scalar<tstring>()() = std::move(record);
             out_tensors->emplace_back(std::move(record_tensor));
             *end_of_sequence = false;
             return absl::OkStatus();
@@ -158,8 +163,7 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
 
           // We have reached the end of the current file, so maybe move on to
           // next file.
-          input_buffer_.reset();
-          file_.reset();
+          ResetStreamsLocked();
           ++current_file_index_;
         }
 
@@ -190,9 +194,8 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         }
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             TranslateFileName(next_filename), &file_));
-        input_buffer_ = std::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
-        TF_RETURN_IF_ERROR(input_buffer_->SkipNBytes(dataset()->header_bytes_));
+        SetupStreamsLocked(ctx);
+        TF_RETURN_IF_ERROR(SkipLocked(dataset()->header_bytes_));
       } while (true);
     }
 
@@ -203,10 +206,11 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
 
-      // `input_buffer_` is empty if
+      // `input_buffer_` and `read_ahead_stream_` are empty if
       // 1. GetNext has not been called even once.
       // 2. All files have been read and iterator has been exhausted.
-      int64_t current_pos = input_buffer_ ? input_buffer_->Tell() : -1;
+      int64_t current_pos =
+          input_buffer_ || read_ahead_stream_ ? TellLocked() : -1;
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kCurrentPos, current_pos));
       return absl::OkStatus();
@@ -224,9 +228,8 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
           reader->ReadScalar(prefix(), kCurrentPos, &current_pos));
 
       // Seek to current_pos.
-      input_buffer_.reset();
-      file_.reset();
-      if (current_pos >= 0) {  // There was an active input_buffer_.
+      ResetStreamsLocked();
+      if (current_pos >= 0) {  // There was an active input stream.
         uint64 file_size;
         const std::string& current_filename =
             dataset()->filenames_[current_file_index_];
@@ -235,20 +238,69 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         file_pos_limit_ = file_size - dataset()->footer_bytes_;
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             TranslateFileName(current_filename), &file_));
-        input_buffer_ = std::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
-        TF_RETURN_IF_ERROR(input_buffer_->Seek(current_pos));
+        SetupStreamsLocked(ctx);
+        if (input_buffer_) {
+          TF_RETURN_IF_ERROR(input_buffer_->Seek(current_pos));
+        } else {
+          TF_RETURN_IF_ERROR(read_ahead_stream_->SkipNBytes(current_pos));
+        }
       }
 
       return absl::OkStatus();
     }
 
    private:
+    // Sets up the stream reading from `file_`. Reads are issued ahead of the
+    // consumer if the dataset uses read-ahead, and buffered otherwise.
+    void SetupStreamsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->use_read_ahead_) {
+        read_ahead_stream_ = std::make_unique<io::ReadAheadInputStream>(
+            file_.get(), dataset()->buffer_size_, kReadAheadDepth,
+            *ctx->runner());
+      } else {
+        input_buffer_ = std::make_unique<io::InputBuffer>(
+            file_.get(), dataset()->buffer_size_);
+      }
+    }
+
+    void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      read_ahead_stream_.reset();
+      input_buffer_.reset();
+      file_.reset();
+    }
+
+    int64_t TellLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return input_buffer_ ? input_buffer_->Tell() : read_ahead_stream_->Tell();
+    }
+
+    absl::Status SkipLocked(int64_t bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return input_buffer_ ? input_buffer_->SkipNBytes(bytes)
+                           : read_ahead_stream_->SkipNBytes(bytes);
+    }
+
+    absl::Status ReadRecordLocked(tstring* record)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (input_buffer_) {
+        record->resize_uninitialized(dataset()->record_bytes_);
+        size_t bytes_read;
+        TF_RETURN_IF_ERROR(input_buffer_->ReadNBytes(
+            dataset()->record_bytes_, &(*record)[0], &bytes_read));
+        record->resize(bytes_read);
+        return absl::OkStatus();
+      }
+      return read_ahead_stream_->ReadNBytes(dataset()->record_bytes_, record);
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
         TF_GUARDED_BY(mu_);  // must outlive input_buffer_
     std::unique_ptr<io::InputBuffer> input_buffer_ TF_GUARDED_BY(mu_);
+    // Used instead of `input_buffer_` when the dataset reads ahead. Must be
+    // destroyed before `file_`, which it reads from in the background.
+    std::unique_ptr<io::ReadAheadInputStream> read_ahead_stream_
+        TF_GUARDED_BY(mu_);
     int64_t file_pos_limit_ TF_GUARDED_BY(mu_) = -1;
   };
 
@@ -458,6 +510,9 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   const int64_t buffer_size_;
   const tstring compression_type_;
   const int op_version_;
+  // Whether uncompressed reads are issued asynchronously ahead of the
+  // consumer.
+  const bool use_read_ahead_;
 };
 
 FixedLengthRecordDatasetOp::FixedLengthRecordDatasetOp(
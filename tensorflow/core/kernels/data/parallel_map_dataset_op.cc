@@ -292,8 +292,11 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(*mu_);
       interleave_depth_ = ctx->interleave_depth();
       if (use_unbounded_threadpool_) {
+        // Keep the map threads on the consumer's NUMA node, if it has one.
+        ThreadOptions thread_options;
+        thread_options.numa_node = GetNumaNodeForCurrentThread();
         unbounded_thread_pool_ = std::make_unique<UnboundedThreadPool>(
-            ctx->env(), "tf_data_map_unbounded_thread_pool");
+            ctx->env(), "tf_data_map_unbounded_thread_pool", thread_options);
       }
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
@@ -536,10 +539,23 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     void CallCompleted(const std::shared_ptr<IteratorContext>& ctx,
                        const std::shared_ptr<InvocationResult>& result)
         TF_LOCKS_EXCLUDED(*mu_) {
-      mutex_lock l(*mu_);
-      num_calls_--;
+      // In deterministic mode the consumer waits on the result's own
+      // notification, so it can be notified without holding `mu_`. The result
+      // is complete before `num_calls_` is decremented, which `SaveInternal`
+      // relies on.
       result->notification.Notify();
-      cond_var_->notify_all();
+      mutex_lock l(*mu_);
+      const int64_t num_calls = num_calls_--;
+      // Waking every waiter on each completion makes `mu_` the main contention
+      // point at high parallelism. Only notify when a waiter can make
+      // progress: the runner thread is blocked only if the number of calls was
+      // at the parallelism limit, `SaveInternal` and `CancelThreads` wait for
+      // all calls to finish, and in non-deterministic mode the consumer waits
+      // on `cond_var_` for any completed call.
+      if (!deterministic_ || num_calls_ == 0 ||
+          num_calls >= num_parallel_calls_->value) {
+        cond_var_->notify_all();
+      }
     }
 
     void CallFunction(const std::shared_ptr<IteratorContext>& ctx,
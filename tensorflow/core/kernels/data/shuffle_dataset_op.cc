@@ -23,12 +23,15 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/element_spill_file.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -64,6 +67,10 @@ namespace data {
 const int64_t kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64_t kMaxEpochsInBuffer = 3;
 
+// When this experiment is enabled, shuffle buffer elements that do not fit in
+// the iterator's RAM budget are spilled to a local scratch file.
+constexpr char kSpillToDiskExperiment[] = "shuffle_spill_to_disk";
+
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
 constexpr char kEndOfInputSequence[] = "end_of_input_sequence";
@@ -200,10 +207,19 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
     }
 
+    ~Iterator() override {
+      if (ram_budget_manager_ != nullptr && allocated_bytes_ > 0) {
+        ram_budget_manager_->RequestLegacyPrefetchBytes(-allocated_bytes_);
+      }
+    }
+
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     absl::Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(mu_);
+      if (GetExperiments().contains(kSpillToDiskExperiment)) {
+        ram_budget_manager_ = ctx->ram_budget_manager();
+      }
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
       // Initialize checkpoint_indices_ to the entire buffer.
@@ -234,12 +250,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t offset =
           Random() % (slices_.front()->end - slices_.front()->start);
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
-      this->RecordBufferDequeue(ctx, *out_tensors);
-      std::swap(buffer_->at(index),
-                buffer_->at(slices_.front()->start % buffer_->size()));
+      int64_t start_index = slices_.front()->start % buffer_->size();
+      TF_RETURN_IF_ERROR(TakeElementLocked(ctx, index, out_tensors));
+      std::swap(buffer_->at(index), buffer_->at(start_index));
+      SwapSpilledLocked(index, start_index);
       checkpoint_indices_.insert(index);
-      checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
+      checkpoint_indices_.insert(start_index);
       slices_.front()->start++;
       num_elements_--;
       return absl::OkStatus();
@@ -290,12 +306,24 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         // already contains checkpoint of the shuffle buffer created by the
         // previous invocation of this instance and the indices that need to be
         // updated are stored in `checkpoint_indices`.
-        TF_RETURN_IF_ERROR(UpdateCheckpointElements(
-            writer, key_prefix, *buffer_, checkpoint_indices_));
+        if (spilled_.empty()) {
+          TF_RETURN_IF_ERROR(UpdateCheckpointElements(
+              writer, key_prefix, *buffer_, checkpoint_indices_));
+        } else {
+          TF_RETURN_IF_ERROR(WriteSpilledBufferLocked(
+              writer, key_prefix, checkpoint_indices_));
+        }
         checkpoint_indices_.clear();
-      } else {
+      } else if (spilled_.empty()) {
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, key_prefix, *buffer_));
+      } else {
+        absl::flat_hash_set<int64_t> all_indices;
+        for (int64_t i = 0; i < buffer_->size(); ++i) {
+          all_indices.insert(i);
+        }
+        TF_RETURN_IF_ERROR(
+            WriteSpilledBufferLocked(writer, key_prefix, all_indices));
       }
 
       TF_RETURN_IF_ERROR(
@@ -368,9 +396,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           checkpoint_indices_.insert(i);
         }
       }
-      for (const auto& element : *buffer_) {
-        RecordBufferEnqueue(ctx, element);
-      }
+      TF_RETURN_IF_ERROR(ApplyRamBudgetLocked(ctx));
       if (!IsShuffleAll()) {
         buffer_->resize(dataset()->buffer_size_);
       }
@@ -465,7 +491,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
+          TF_RETURN_IF_ERROR(AddToShuffleBuffer(ctx, std::move(input_element)));
           continue;
         }
         input_impl_.reset();
@@ -522,25 +548,140 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return absl::OkStatus();
     }
 
-    void AddToShuffleBuffer(IteratorContext* ctx, std::vector<Tensor>&& element)
+    absl::Status AddToShuffleBuffer(IteratorContext* ctx,
+                                    std::vector<Tensor>&& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       data_produced_ = true;
       if (num_elements_ == 0) {
         VLOG(1) << "Starting to fill up shuffle buffer of size: "
                 << BufferSizeString();
       }
-      this->RecordBufferEnqueue(ctx, element);
+      size_t index;
       if (num_elements_ == buffer_->size()) {
         DCHECK(IsShuffleAll());
-        checkpoint_indices_.insert(buffer_->size());
-        buffer_->push_back(element);
+        index = buffer_->size();
+        buffer_->emplace_back();
       } else {
-        size_t index = slices_.back()->end % buffer_->size();
-        checkpoint_indices_.insert(index);
-        buffer_->at(index) = std::move(element);
+        index = slices_.back()->end % buffer_->size();
       }
+      checkpoint_indices_.insert(index);
+      TF_RETURN_IF_ERROR(StoreElementLocked(ctx, index, std::move(element)));
       num_elements_++;
       slices_.back()->end++;
+      return absl::OkStatus();
+    }
+
+    // Stores `element` at `index` of `buffer_`. If the element does not fit in
+    // the RAM budget, it is written to `spill_file_` instead.
+    absl::Status StoreElementLocked(IteratorContext* ctx, int64_t index,
+                                    std::vector<Tensor>&& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ram_budget_manager_ != nullptr) {
+        const int64_t bytes = GetAllocatedBytes(element);
+        if (!ram_budget_manager_->RequestLegacyPrefetchBytes(bytes)) {
+          if (spill_file_ == nullptr) {
+            TF_ASSIGN_OR_RETURN(spill_file_,
+                                ElementSpillFile::Create(ctx->env()));
+            LOG(INFO) << dataset()->metadata().name() << ": "
+                      << "Shuffle buffer exceeds the RAM budget; spilling "
+                      << "elements to local disk.";
+          }
+          TF_ASSIGN_OR_RETURN(spilled_[index], spill_file_->Write(element));
+          buffer_->at(index).clear();
+          return absl::OkStatus();
+        }
+        allocated_bytes_ += bytes;
+      }
+      this->RecordBufferEnqueue(ctx, element);
+      buffer_->at(index) = std::move(element);
+      return absl::OkStatus();
+    }
+
+    // Moves the element at `index` of `buffer_` into `element`, reading it
+    // back from `spill_file_` if it was spilled.
+    absl::Status TakeElementLocked(IteratorContext* ctx, int64_t index,
+                                   std::vector<Tensor>* element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto it = spilled_.find(index);
+      if (it != spilled_.end()) {
+        ElementSpillFile::Handle handle = it->second;
+        spilled_.erase(it);
+        return spill_file_->Take(handle, element);
+      }
+      *element = std::move(buffer_->at(index));
+      this->RecordBufferDequeue(ctx, *element);
+      if (ram_budget_manager_ != nullptr) {
+        const int64_t bytes = GetAllocatedBytes(*element);
+        ram_budget_manager_->RequestLegacyPrefetchBytes(-bytes);
+        allocated_bytes_ -= bytes;
+      }
+      return absl::OkStatus();
+    }
+
+    // Swaps the spill state of two buffer indices, mirroring a swap of the
+    // corresponding `buffer_` entries.
+    void SwapSpilledLocked(int64_t a, int64_t b)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (spilled_.empty() || a == b) {
+        return;
+      }
+      auto it_a = spilled_.find(a);
+      auto it_b = spilled_.find(b);
+      if (it_a == spilled_.end() && it_b == spilled_.end()) {
+        return;
+      }
+      if (it_a != spilled_.end() && it_b != spilled_.end()) {
+        std::swap(it_a->second, it_b->second);
+        return;
+      }
+      const int64_t from = it_a != spilled_.end() ? a : b;
+      const int64_t to = it_a != spilled_.end() ? b : a;
+      ElementSpillFile::Handle handle = spilled_[from];
+      spilled_.erase(from);
+      spilled_[to] = handle;
+    }
+
+    // Accounts the elements of a freshly restored `buffer_` against the RAM
+    // budget, spilling the ones that do not fit.
+    absl::Status ApplyRamBudgetLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ram_budget_manager_ != nullptr && allocated_bytes_ > 0) {
+        ram_budget_manager_->RequestLegacyPrefetchBytes(-allocated_bytes_);
+      }
+      allocated_bytes_ = 0;
+      spilled_.clear();
+      spill_file_.reset();
+      for (int64_t i = 0; i < buffer_->size(); ++i) {
+        if (buffer_->at(i).empty()) {
+          continue;
+        }
+        std::vector<Tensor> element = std::move(buffer_->at(i));
+        TF_RETURN_IF_ERROR(StoreElementLocked(ctx, i, std::move(element)));
+      }
+      return absl::OkStatus();
+    }
+
+    // Writes the buffer elements at `indices` to the checkpoint, reading
+    // spilled elements back one at a time so that the buffer never needs to
+    // be fully resident in memory.
+    absl::Status WriteSpilledBufferLocked(
+        IteratorStateWriter* writer, const std::string& key_prefix,
+        const absl::flat_hash_set<int64_t>& indices)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(key_prefix, kNumElements, buffer_->size()));
+      for (int64_t i : indices) {
+        auto it = spilled_.find(i);
+        if (it == spilled_.end()) {
+          TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, *buffer_, i));
+          continue;
+        }
+        TF_RETURN_IF_ERROR(spill_file_->Read(it->second, &buffer_->at(i)));
+        absl::Status s = WriteElement(writer, key_prefix, *buffer_, i);
+        buffer_->at(i).clear();
+        TF_RETURN_IF_ERROR(s);
+      }
+      return absl::OkStatus();
     }
 
     void ClearEmptySlices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -581,6 +722,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Set when elements may be spilled to disk, in which case in-memory
+    // elements of `buffer_` are accounted against its budget.
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+        TF_GUARDED_BY(mu_);
+    // Bytes of in-memory elements allocated from `ram_budget_manager_`.
+    int64_t allocated_bytes_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<ElementSpillFile> spill_file_ TF_GUARDED_BY(mu_);
+    // Locations in `spill_file_` of the elements of `buffer_` that are not
+    // held in memory, keyed by buffer index.
+    absl::flat_hash_map<int64_t, ElementSpillFile::Handle> spilled_
+        TF_GUARDED_BY(mu_);
   };
 
   const DatasetBase* const input_;
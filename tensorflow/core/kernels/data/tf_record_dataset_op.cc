@@ -14,8 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
-
+#include <list>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/io/record_index.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -41,16 +55,23 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const TFRecordDatasetOp::kRandomAccess;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
+constexpr char kMemoryMappedReadExperiment[] = "tfrecord_memory_mapped_read";
+constexpr char kReadAheadExperiment[] = "file_read_ahead";
+// Number of `buffer_size` reads kept in flight when reading ahead.
+constexpr int kReadAheadDepth = 4;
 constexpr int64_t kUnspecifiedBufferSize = -1;
 constexpr int64_t kDefaultBufferSize = 256LL << 10;  // 256KB
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Maximum number of files kept open for random access.
+constexpr size_t kMaxRandomAccessOpenFiles = 16;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -60,21 +81,168 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// Reads records of uncompressed TFRecord files by global index, using the
+// sidecar record index of each file (see `tsl::io::RecordIndex`). Only the
+// number of records of each file is kept in memory; record locations are read
+// from the index files on demand. This class is thread-safe.
+class TFRecordRandomAccess {
+ public:
+  TFRecordRandomAccess(Env* env, const std::vector<string>& filenames)
+      : env_(env), filenames_(filenames) {}
+
+  // Loads the number of records of each file. The result is cached.
+  absl::Status Initialize() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    return InitializeLocked();
+  }
+
+  // Returns the total number of records, or an error if some file has no
+  // record index.
+  absl::StatusOr<int64_t> Cardinality() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(InitializeLocked());
+    return cumulative_num_records_.empty() ? 0
+                                           : cumulative_num_records_.back();
+  }
+
+  // Reads the record at `index` across all files into `record`.
+  absl::Status ReadRecord(int64_t index, tstring* record)
+      TF_LOCKS_EXCLUDED(mu_) {
+    std::shared_ptr<OpenFile> file;
+    int64_t index_in_file = 0;
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(InitializeLocked());
+      auto it = std::upper_bound(cumulative_num_records_.begin(),
+                                 cumulative_num_records_.end(), index);
+      if (index < 0 || it == cumulative_num_records_.end()) {
+        return absl::OutOfRangeError(absl::StrCat(
+            "Index out of range [0, ",
+            cumulative_num_records_.empty() ? 0
+                                            : cumulative_num_records_.back(),
+            "): ", index));
+      }
+      const size_t file_index = it - cumulative_num_records_.begin();
+      index_in_file =
+          file_index == 0 ? index
+                          : index - cumulative_num_records_[file_index - 1];
+      TF_ASSIGN_OR_RETURN(file, GetOpenFileLocked(file_index));
+    }
+
+    TF_ASSIGN_OR_RETURN(tsl::io::RecordLocation location,
+                        file->index->GetLocation(index_in_file));
+    io::RecordReader reader(file->file.get());
+    uint64 offset = location.offset;
+    TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, record));
+    if (record->size() != location.length) {
+      return absl::DataLossError(absl::StrCat(
+          "Record ", index_in_file, " of ", file->filename, " has ",
+          record->size(), " bytes, but its record index expects ",
+          location.length, " bytes. The record index may be stale."));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct OpenFile {
+    string filename;
+    std::unique_ptr<RandomAccessFile> file;
+    std::unique_ptr<tsl::io::RecordIndex> index;
+  };
+
+  absl::Status InitializeLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (status_.has_value()) {
+      return *status_;
+    }
+    status_ = absl::OkStatus();
+    int64_t num_records = 0;
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      absl::StatusOr<std::unique_ptr<tsl::io::RecordIndex>> index =
+          tsl::io::RecordIndex::Open(
+              env_, tsl::io::RecordIndexFileName(
+                        TranslateFileName(filenames_[i])));
+      if (!index.ok()) {
+        status_ = absl::Status(
+            index.status().code(),
+            absl::StrCat("Random access to TFRecord file ", filenames_[i],
+                         " requires a record index, which can be built with "
+                         "the `build_record_index` tool: ",
+                         index.status().message()));
+        cumulative_num_records_.clear();
+        return *status_;
+      }
+      num_records += (*index)->num_records();
+      cumulative_num_records_.push_back(num_records);
+    }
+    return *status_;
+  }
+
+  // Returns the data file and record index of `filenames_[file_index]`,
+  // opening them if needed. Keeps at most `kMaxRandomAccessOpenFiles` open.
+  absl::StatusOr<std::shared_ptr<OpenFile>> GetOpenFileLocked(
+      size_t file_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = open_files_.find(file_index);
+    if (it != open_files_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.second);
+      return it->second.first;
+    }
+    auto file = std::make_shared<OpenFile>();
+    file->filename = filenames_[file_index];
+    const string filename = TranslateFileName(file->filename);
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &file->file));
+    TF_ASSIGN_OR_RETURN(
+        file->index,
+        tsl::io::RecordIndex::Open(env_,
+                                   tsl::io::RecordIndexFileName(filename)));
+    if (open_files_.size() >= kMaxRandomAccessOpenFiles) {
+      open_files_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(file_index);
+    open_files_[file_index] = {file, lru_.begin()};
+    return file;
+  }
+
+  Env* const env_;
+  const std::vector<string> filenames_;
+
+  mutex mu_;
+  std::optional<absl::Status> status_ TF_GUARDED_BY(mu_);
+  // Number of records in `filenames_[0..i]`.
+  std::vector<int64_t> cumulative_num_records_ TF_GUARDED_BY(mu_);
+  // Open files, with the most recently used file first in `lru_`.
+  std::list<size_t> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, std::pair<std::shared_ptr<OpenFile>,
+                                        std::list<size_t>::iterator>>
+      open_files_ TF_GUARDED_BY(mu_);
+};
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   bool random_access)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        use_memory_mapped_read_(
+            options_.compression_type == io::RecordReaderOptions::NONE &&
+            GetExperiments().contains(kMemoryMappedReadExperiment)),
+        use_read_ahead_(GetExperiments().contains(kReadAheadExperiment)),
+        random_access_requested_(random_access) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    if (options_.compression_type == io::RecordReaderOptions::NONE &&
+        byte_offsets_.empty()) {
+      random_access_ =
+          std::make_unique<TFRecordRandomAccess>(ctx->env(), filenames_);
+    }
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -109,6 +277,62 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   absl::Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  // The cardinality is known if random access was requested and every file
+  // has a record index. Reading the indices requires I/O, so it is only done
+  // for moderate compute levels.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!random_access_requested_ || random_access_ == nullptr ||
+        options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<int64_t> cardinality = random_access_->Cardinality();
+    if (!cardinality.ok()) {
+      VLOG(2) << "Unable to compute the cardinality of " << DebugString()
+              << ": " << cardinality.status();
+      return kUnknownCardinality;
+    }
+    return *cardinality;
+  }
+
+  absl::Status Get(OpKernelContext* ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  absl::Status Get(AnyContext ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(RandomIndexingCompatible());
+    TF_RETURN_IF_ERROR(random_access_->Initialize());
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(random_access_->ReadRecord(
+        index, &out_tensors->back().scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(out_tensors->back().scalar<tstring>()().size());
+    return absl::OkStatus();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (!random_access_requested_) {
+      return errors::FailedPrecondition(
+          type_string(), " only supports random access if its `",
+          kRandomAccess, "` attribute is set.");
+    }
+    if (random_access_ == nullptr) {
+      return errors::FailedPrecondition(
+          type_string(),
+          " only supports random access to uncompressed files read from the "
+          "beginning. Got compression type \"",
+          compression_type_, "\" and ", byte_offsets_.size(), " byte offsets.");
+    }
+    // Whether every file has a record index is only checked when computing
+    // the cardinality, to avoid I/O when building the dataset graph.
+    return absl::OkStatus();
+  }
+
  protected:
   absl::Status AsGraphDefInternal(SerializationContext* ctx,
                                   DatasetGraphDefBuilder* b,
@@ -119,8 +343,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    if (random_access_requested_) {
+      AttrValue random_access;
+      b->BuildAttrValue(random_access_requested_, &random_access);
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {filenames, compression_type, buffer_size},
+                        {std::make_pair(kRandomAccess, random_access)},
+                        output));
+    } else {
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, compression_type, buffer_size}, output));
+    }
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
     return absl::OkStatus();
@@ -130,22 +363,28 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     absl::Status GetNextInternal(IteratorContext* ctx,
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        global_shuffle_active_ = true;
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
+        if (reader_ || mapped_reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
           absl::Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+              ReadRecordLocked(&out_tensors->back().scalar<tstring>()());
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -176,7 +415,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return absl::OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -188,10 +427,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (reader_ || mapped_reader_) {
           int last_num_skipped;
-          absl::Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                                &last_num_skipped);
+          absl::Status s = SkipRecordsLocked(
+              ctx->env(), num_to_skip - *num_skipped, &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -218,7 +457,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return absl::OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -234,15 +473,23 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
 
-      if (reader_) {
+      if (reader_ || mapped_reader_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kOffset, TellOffsetLocked()));
+      }
+      if (global_shuffle_active_) {
         TF_RETURN_IF_ERROR(
-            writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
+            global_shuffle_iterator_.Save(prefix(), ctx, writer));
       }
       return absl::OkStatus();
     }
 
     absl::Status RestoreInternal(IteratorContext* ctx,
                                  IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        global_shuffle_active_ = true;
+        return global_shuffle_iterator_.Restore(prefix(), ctx, reader);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -252,15 +499,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader->Contains(prefix(), kOffset)) {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
+        if (dataset()->random_access_ != nullptr) {
+          TF_RETURN_IF_ERROR(RestoreRecordPositionLocked(ctx->env(), offset));
+        }
       }
       return absl::OkStatus();
     }
 
    private:
     // Sets up reader streams to read from the file at `current_file_index_`.
-    absl::Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    absl::Status SetupStreamsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Env* env = ctx->env();
       if (current_file_index_ >= dataset()->filenames_.size()) {
         return errors::InvalidArgument(
             "current_file_index_:", current_file_index_,
@@ -276,22 +528,206 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           },
           tsl::profiler::kInfo);
 
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->use_memory_mapped_read_) {
+        // Not all file systems support memory mapping, in which case we fall
+        // back to reading through `RandomAccessFile`.
+        absl::Status s =
+            env->NewReadOnlyMemoryRegionFromFile(filename, &region_);
+        if (s.ok()) {
+          mapped_reader_ =
+              std::make_unique<io::MemoryMappedRecordReader>(region_.get());
+        } else {
+          VLOG(2) << "Failed to memory map " << filename << ": " << s
+                  << ". Falling back to buffered reads.";
+        }
+      }
+      if (!mapped_reader_) {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+        io::RecordReaderOptions options = dataset()->options_;
+        if (dataset()->use_read_ahead_) {
+          options.read_ahead_depth = kReadAheadDepth;
+          options.read_ahead_runner = *ctx->runner();
+        }
+        reader_ = std::make_unique<io::SequentialRecordReader>(file_.get(),
+                                                               options);
+      }
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
-            reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
+            SeekOffsetLocked(dataset()->byte_offsets_[current_file_index_]));
       }
       return absl::OkStatus();
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      mapped_reader_.reset();
+      region_.reset();
       reader_.reset();
       file_.reset();
+      record_index_.reset();
+      record_index_checked_ = false;
+      records_read_ = 0;
+    }
+
+    // Opens the record index of the current file, if it has one that matches
+    // the file. This is done lazily because most iterators never skip.
+    absl::Status MaybeOpenRecordIndexLocked(Env* env)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (record_index_checked_ || dataset()->random_access_ == nullptr) {
+        return absl::OkStatus();
+      }
+      record_index_checked_ = true;
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      const string index_filename = tsl::io::RecordIndexFileName(filename);
+      if (!env->FileExists(index_filename).ok()) {
+        return absl::OkStatus();
+      }
+      absl::StatusOr<std::unique_ptr<tsl::io::RecordIndex>> index =
+          tsl::io::RecordIndex::Open(env, index_filename);
+      if (!index.ok()) {
+        LOG_FIRST_N(WARNING, 1) << "Ignoring record index " << index_filename
+                                << ": " << index.status();
+        return absl::OkStatus();
+      }
+      uint64 file_size = 0;
+      if (region_) {
+        file_size = region_->length();
+      } else {
+        TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+      }
+      absl::StatusOr<uint64> indexed_size =
+          RecordOffset(**index, (*index)->num_records());
+      if (!indexed_size.ok() || *indexed_size != file_size) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Ignoring stale record index " << index_filename << " of "
+            << filename << " (" << file_size << " bytes): "
+            << (indexed_size.ok()
+                    ? absl::StrCat("it covers ", *indexed_size, " bytes")
+                    : indexed_size.status().ToString());
+        return absl::OkStatus();
+      }
+      record_index_ = std::move(*index);
+      return absl::OkStatus();
+    }
+
+    // Returns the offset of record `record_index` in the indexed file, or the
+    // size of the file if `record_index` is the number of records.
+    static absl::StatusOr<uint64> RecordOffset(
+        const tsl::io::RecordIndex& index, uint64 record_index) {
+      if (record_index < index.num_records()) {
+        TF_ASSIGN_OR_RETURN(tsl::io::RecordLocation location,
+                            index.GetLocation(record_index));
+        return location.offset;
+      }
+      if (record_index == 0) {
+        return 0;
+      }
+      TF_ASSIGN_OR_RETURN(tsl::io::RecordLocation location,
+                          index.GetLocation(record_index - 1));
+      return location.offset + io::RecordReader::kHeaderSize +
+             location.length + io::RecordReader::kFooterSize;
+    }
+
+    // Finds the position of the record at `offset` of the current file in
+    // its record index, so that skipping after a restore can seek too.
+    absl::Status RestoreRecordPositionLocked(Env* env, uint64 offset)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(MaybeOpenRecordIndexLocked(env));
+      if (!record_index_) {
+        return absl::OkStatus();
+      }
+      absl::StatusOr<uint64> position = FindRecord(*record_index_, offset);
+      if (!position.ok()) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Unable to find the restored position in the record index of "
+            << dataset()->filenames_[current_file_index_] << ": "
+            << position.status() << ". Skipping records will not use the "
+            << "index.";
+        record_index_.reset();
+        return absl::OkStatus();
+      }
+      records_read_ = *position;
+      return absl::OkStatus();
+    }
+
+    // Returns the position of the record at `offset` in `index`. Record
+    // offsets are increasing, so this is a binary search.
+    static absl::StatusOr<uint64> FindRecord(const tsl::io::RecordIndex& index,
+                                             uint64 offset) {
+      uint64 begin = 0;
+      uint64 end = index.num_records();
+      while (begin < end) {
+        const uint64 mid = begin + (end - begin) / 2;
+        TF_ASSIGN_OR_RETURN(uint64 mid_offset, RecordOffset(index, mid));
+        if (mid_offset < offset) {
+          begin = mid + 1;
+        } else {
+          end = mid;
+        }
+      }
+      TF_ASSIGN_OR_RETURN(uint64 found_offset, RecordOffset(index, begin));
+      if (found_offset != offset) {
+        return errors::DataLoss("Offset ", offset,
+                                " is not at a record boundary.");
+      }
+      return begin;
+    }
+
+    // Reads the next record from whichever reader is active. Records read from
+    // a memory mapped file are copied straight from the mapping into `record`.
+    absl::Status ReadRecordLocked(tstring* record)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        absl::string_view view;
+        TF_RETURN_IF_ERROR(mapped_reader_->ReadRecord(&view));
+        record->assign(view.data(), view.size());
+      } else {
+        TF_RETURN_IF_ERROR(reader_->ReadRecord(record));
+      }
+      ++records_read_;
+      return absl::OkStatus();
+    }
+
+    // Skips records of the current file. With a record index, this seeks to
+    // the target record instead of reading the headers of skipped records.
+    absl::Status SkipRecordsLocked(Env* env, int num_to_skip,
+                                   int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      TF_RETURN_IF_ERROR(MaybeOpenRecordIndexLocked(env));
+      if (record_index_) {
+        const uint64 remaining = record_index_->num_records() - records_read_;
+        if (static_cast<uint64>(num_to_skip) >= remaining) {
+          *num_skipped = static_cast<int>(remaining);
+          records_read_ += remaining;
+          return errors::OutOfRange("eof");
+        }
+        TF_ASSIGN_OR_RETURN(
+            tsl::io::RecordLocation location,
+            record_index_->GetLocation(records_read_ + num_to_skip));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(location.offset));
+        *num_skipped = num_to_skip;
+        records_read_ += num_to_skip;
+        return absl::OkStatus();
+      }
+      absl::Status s =
+          mapped_reader_ ? mapped_reader_->SkipRecords(num_to_skip, num_skipped)
+                         : reader_->SkipRecords(num_to_skip, num_skipped);
+      records_read_ += *num_skipped;
+      return s;
+    }
+
+    uint64 TellOffsetLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return mapped_reader_ ? mapped_reader_->TellOffset()
+                            : reader_->TellOffset();
+    }
+
+    absl::Status SeekOffsetLocked(uint64 offset)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return mapped_reader_ ? mapped_reader_->SeekOffset(offset)
+                            : reader_->SeekOffset(offset);
     }
 
     mutex mu_;
@@ -301,6 +737,23 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // Used instead of `file_` and `reader_` when the dataset reads through a
+    // memory mapping. `mapped_reader_` borrows `region_`, so it must be
+    // destroyed first.
+    std::unique_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::MemoryMappedRecordReader> mapped_reader_
+        TF_GUARDED_BY(mu_);
+
+    // Record index of the current file, if it has one and it is needed.
+    std::unique_ptr<tsl::io::RecordIndex> record_index_ TF_GUARDED_BY(mu_);
+    bool record_index_checked_ TF_GUARDED_BY(mu_) = false;
+    // Number of records read or skipped in the current file.
+    uint64 records_read_ TF_GUARDED_BY(mu_) = 0;
+
+    GlobalShuffleIterator global_shuffle_iterator_;
+    // Whether elements are produced through `global_shuffle_iterator_`.
+    std::atomic<bool> global_shuffle_active_ = false;
   };
 
   const std::vector<string> filenames_;
@@ -308,11 +761,26 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  // Whether uncompressed files are read through a read-only memory mapping,
+  // bypassing the `InputBuffer` copy made by `RecordReader`.
+  const bool use_memory_mapped_read_;
+  // Whether buffered reads are issued asynchronously ahead of the consumer.
+  const bool use_read_ahead_;
+  // Whether random access was requested through the `random_access` attribute.
+  // Only then are the record indices read to compute the cardinality.
+  const bool random_access_requested_;
+  // Set if the files can be read by record index, i.e. they are uncompressed
+  // and read from the beginning.
+  std::unique_ptr<TFRecordRandomAccess> random_access_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  if (op_version_ > 1) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kRandomAccess, &random_access_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -391,7 +859,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        random_access_);
 }
 
 namespace {
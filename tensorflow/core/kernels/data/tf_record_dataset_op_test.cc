@@ -11,19 +11,27 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/record_index.h"
+#include "xla/tsl/lib/io/record_index_builder.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -65,13 +73,15 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        std::vector<int64_t> byte_offsets, string node_name)
+                        std::vector<int64_t> byte_offsets, string node_name,
+                        bool random_access = false)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         buffer_size_(buffer_size),
-        byte_offsets_(std::move(byte_offsets)) {
+        byte_offsets_(std::move(byte_offsets)),
+        random_access_(random_access) {
     op_version_ = 2;
   }
 
@@ -99,6 +109,7 @@ class TFRecordDatasetParams : public DatasetParams {
   absl::Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kRandomAccess, random_access_);
     return absl::OkStatus();
   }
 
@@ -111,6 +122,7 @@ class TFRecordDatasetParams : public DatasetParams {
   CompressionType compression_type_;
   int64_t buffer_size_;
   std::vector<int64_t> byte_offsets_;
+  bool random_access_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -352,6 +364,150 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+// Writes uncompressed test files for random access, optionally with their
+// record indices.
+TFRecordDatasetParams RandomAccessDatasetParams(const std::string& name,
+                                                bool build_index,
+                                                bool random_access = true) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_", name, "_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_", name, "_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  TF_CHECK_OK(
+      CreateTestFiles(filenames, contents, CompressionType::UNCOMPRESSED));
+  for (const tstring& filename : filenames) {
+    const std::string index_filename = tsl::io::RecordIndexFileName(filename);
+    if (build_index) {
+      TF_CHECK_OK(tsl::io::BuildRecordIndex(Env::Default(), filename,
+                                            index_filename));
+    } else {
+      Env::Default()->DeleteFile(index_filename).IgnoreError();
+    }
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName, random_access);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccess) {
+  auto dataset_params =
+      RandomAccessDatasetParams("RANDOM_ACCESS", /*build_index=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  CardinalityOptions options;
+  options.set_compute_level(
+      CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 6);
+
+  std::vector<tstring> expected = {"1", "22", "333", "a", "bb", "ccc"};
+  for (int64_t index : {4, 0, 5, 2, 1, 3}) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), index, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[index]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessRequiresRecordIndex) {
+  auto dataset_params =
+      RandomAccessDatasetParams("NO_INDEX", /*build_index=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(
+      CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 0, &out_tensors).code(),
+      absl::StatusCode::kNotFound);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessMustBeRequested) {
+  auto dataset_params = RandomAccessDatasetParams(
+      "NOT_REQUESTED", /*build_index=*/true, /*random_access=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+  CardinalityOptions options;
+  options.set_compute_level(
+      CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+}
+
+TEST_F(TFRecordDatasetOpTest, SavesGlobalShuffleStateOnlyWhenShuffling) {
+  auto dataset_params =
+      RandomAccessDatasetParams("SAVE", /*build_index=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  auto contains_global_shuffle_state = [this]() -> bool {
+    std::unique_ptr<SerializationContext> serialization_ctx;
+    TF_CHECK_OK(CreateSerializationContext(&serialization_ctx));
+    VariantTensorDataWriter writer;
+    TF_CHECK_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    return reader.Contains(iterator_->prefix(),
+                           "global_shuffle_iterator_next_index");
+  };
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_FALSE(contains_global_shuffle_state());
+
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.index_mapper = [](size_t element_position) -> absl::StatusOr<size_t> {
+    return element_position;
+  };
+  IteratorContext shuffle_ctx(std::move(params));
+  TF_ASSERT_OK(
+      iterator_->GetNext(&shuffle_ctx, &out_tensors, &end_of_sequence));
+  EXPECT_TRUE(contains_global_shuffle_state());
+}
+
+TEST_F(TFRecordDatasetOpTest, SkipWithRecordIndex) {
+  auto dataset_params = RandomAccessDatasetParams("SKIP", /*build_index=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  int num_skipped = 0;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/2,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_EQ(num_skipped, 2);
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_EQ(out_tensors[0].scalar<tstring>()(), "333");
+  // Skips across the end of the first file.
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/1,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_EQ(num_skipped, 1);
+  out_tensors.clear();
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_EQ(out_tensors[0].scalar<tstring>()(), "bb");
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), /*num_to_skip=*/5,
+                               &end_of_sequence, &num_skipped));
+  EXPECT_EQ(num_skipped, 1);
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessRequiresUncompressedFiles) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <algorithm>
+#include <utility>
 #include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -81,9 +84,10 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    std::vector<string> fields;
     for (int64_t i = 0; i < records_size; ++i) {
       const absl::string_view record(records_t(i));
-      std::vector<string> fields;
+      fields.clear();
       ExtractFields(ctx, record, &fields);
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
@@ -232,20 +236,23 @@ class DecodeCSVOp : public OpKernel {
         // This is the body of the field;
         string field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
-          }
+          // Find the end of the field with a single (memchr-based) scan for
+          // the delimiter and copy the body at once, instead of appending it
+          // byte by byte.
+          const size_t field_end =
+              std::min(input.find(delim_, current_idx), input.size());
+          const absl::string_view body =
+              input.substr(current_idx, field_end - current_idx);
+          OP_REQUIRES(
+              ctx,
+              body.find_first_of(use_quote_delim_ ? "\"\n\r" : "\n\r") ==
+                  absl::string_view::npos,
+              errors::InvalidArgument(
+                  "Unquoted fields cannot have quotes/CRLFs inside"));
+          if (include) field.assign(body.data(), body.size());
 
           // Go to next field or the end
-          current_idx++;
+          current_idx = field_end + 1;
         } else if (use_quote_delim_) {
           // Quoted field needs to be ended with '"' and delim or end
           while (
@@ -278,7 +285,7 @@ class DecodeCSVOp : public OpKernel {
 
         num_fields_parsed++;
         if (include) {
-          result->push_back(field);
+          result->push_back(std::move(field));
           selector_idx++;
           if (selector_idx == select_cols_.size()) return;
         }
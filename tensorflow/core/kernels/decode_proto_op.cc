@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/util/proto/decode.h"
 #include "tensorflow/core/util/proto/descriptors.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -733,31 +734,47 @@ class DecodeProtoOp : public OpKernel {
     Tensor* sizes_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, sizes_shape, &sizes_tensor));
 
+    // Messages are decoded independently of each other and write to disjoint
+    // slices of the outputs, so every pass below is sharded across messages.
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const auto input = buf_tensor.flat<tstring>();
+
     // This is used to allocate binary bufs if used. It serves only to define
     // memory ownership.
-    std::vector<tstring> tmp_binary_bufs(message_count);
+    std::vector<tstring> tmp_binary_bufs;
 
     // These are the actual buffers to use, which may be in tmp_binary_bufs
     // or may be pointers into the buf_tensor. Either way they are not owned
     // here.
-    std::vector<const tstring*> bufs;
+    std::vector<const tstring*> bufs(message_count);
+
+    // Rough cost of touching one message, used to decide how finely to shard.
+    int64_t total_bytes = 0;
+    for (int mi = 0; mi < message_count; ++mi) {
+      total_bytes += input(mi).size();
+    }
+    const int64_t cost_per_message =
+        total_bytes / message_count + 10 * field_count + 1;
 
     if (is_binary_ && !sanitize_) {
       // Fast path.
       for (int mi = 0; mi < message_count; ++mi) {
-        const tstring* buf = &buf_tensor.flat<tstring>()(mi);
-        bufs.push_back(buf);
+        bufs[mi] = &input(mi);
       }
     } else {
       // We will have to allocate a copy, either to convert from text to binary
       // or to sanitize a binary proto.
-      for (int mi = 0; mi < message_count; ++mi) {
-        ReserializeMessage(ctx, buf_tensor.flat<tstring>()(mi),
-                           &tmp_binary_bufs[mi]);
-        if (!ctx->status().ok()) {
-          return;
-        }
-        bufs.push_back(&tmp_binary_bufs[mi]);
+      tmp_binary_bufs.resize(message_count);
+      Shard(worker_threads->num_threads, worker_threads->workers,
+            message_count, 50 * cost_per_message,
+            [&](int64_t start, int64_t limit) {
+              for (int64_t mi = start; mi < limit; ++mi) {
+                ReserializeMessage(ctx, input(mi), &tmp_binary_bufs[mi]);
+                bufs[mi] = &tmp_binary_bufs[mi];
+              }
+            });
+      if (!ctx->status().ok()) {
+        return;
       }
     }
 
@@ -769,11 +786,23 @@ class DecodeProtoOp : public OpKernel {
     // conditional when handling the output data. The caller can distinguish
     // between real data and defaults using the repeat count matrix that is
     // returned by decode_proto.
+    Shard(worker_threads->num_threads, worker_threads->workers, message_count,
+          cost_per_message, [&](int64_t start, int64_t limit) {
+            for (int64_t mi = start; mi < limit; ++mi) {
+              CountFields(ctx, mi, *bufs[mi], sizes_tensor);
+            }
+          });
+    if (!ctx->status().ok()) {
+      return;
+    }
     std::vector<int32> max_sizes(field_count, 1);
+    const auto sizes = sizes_tensor->flat_inner_dims<int32>();
     for (int mi = 0; mi < message_count; ++mi) {
-      CountFields(ctx, mi, *bufs[mi], sizes_tensor, &max_sizes);
-      if (!ctx->status().ok()) {
-        return;
+      for (int fi = 0; fi < field_count; ++fi) {
+        const int32_t size = sizes(mi, fields_[fi]->output_index);
+        if (max_sizes[fi] < size) {
+          max_sizes[fi] = size;
+        }
       }
     }
 
@@ -799,7 +828,7 @@ class DecodeProtoOp : public OpKernel {
 
     // Make the second pass through the serialized proto, decoding into
     // preallocated tensors.
-    AccumulateFields(ctx, bufs, outputs);
+    AccumulateFields(ctx, bufs, outputs, cost_per_message);
   }
 
  private:
@@ -825,8 +854,9 @@ class DecodeProtoOp : public OpKernel {
   }
 
   // Count the number of occurrences of each requested field in a message batch.
+  // Safe to call concurrently for different messages.
   void CountFields(OpKernelContext* ctx, int message_index, const tstring& buf,
-                   Tensor* sizes_tensor, std::vector<int32>* max_sizes) {
+                   Tensor* sizes_tensor) {
     int field_count = fields_.size();
 
     CodedInputStream input(reinterpret_cast<const uint8*>(buf.c_str()),
@@ -855,25 +885,20 @@ class DecodeProtoOp : public OpKernel {
       for (int fi = 0; fi < field_count; fi++) {
         field_sizes[fi] = 0;
       }
-      // Finished decoding this message.
-      return;
     }
 
-    // Update the size tensor and max repeat size for each field.
+    // Update the size tensor for each field.
     auto sizes = sizes_tensor->flat_inner_dims<int32>();
     for (int fi = 0; fi < field_count; fi++) {
-      int32_t size = field_sizes[fi];
-      sizes(message_index, fields_[fi]->output_index) = size;
-      if ((*max_sizes)[fi] < size) {
-        (*max_sizes)[fi] = size;
-      }
+      sizes(message_index, fields_[fi]->output_index) = field_sizes[fi];
     }
   }
 
   // Parse fields from a serialized message into preallocated tensors.
   void AccumulateFields(OpKernelContext* ctx,
                         const std::vector<const tstring*>& bufs,
-                        std::vector<Tensor*> outputs) {
+                        std::vector<Tensor*> outputs,
+                        int64_t cost_per_message) {
     struct TensorInfo {
       explicit TensorInfo(Tensor* tensor) {
         // Note that we can decode only max_repeat_count values before overflow.
@@ -911,43 +936,49 @@ class DecodeProtoOp : public OpKernel {
       tensors.emplace_back(outputs[fi]);
     }
 
-    for (int message_index = 0; message_index < bufs.size(); ++message_index) {
-      const tstring& buf = *bufs[message_index];
-
-      std::vector<DenseCollector> collectors;
-      collectors.reserve(field_count);
-      for (int output_index = 0; output_index < field_count; ++output_index) {
-        const TensorInfo& info = tensors[output_index];
-        const FieldInfo* field_info = fields_[output_index].get();
-        DCHECK(field_info != nullptr);
-        const DefaultValue default_value = field_info->default_value;
-        collectors.emplace_back(info.data + message_index * info.stride,
-                                default_value, info.last_dim_size);
-      }
+    auto decode_range = [&](int64_t start, int64_t limit) {
+      for (int64_t message_index = start; message_index < limit;
+           ++message_index) {
+        const tstring& buf = *bufs[message_index];
+
+        std::vector<DenseCollector> collectors;
+        collectors.reserve(field_count);
+        for (int output_index = 0; output_index < field_count; ++output_index) {
+          const TensorInfo& info = tensors[output_index];
+          const FieldInfo* field_info = fields_[output_index].get();
+          DCHECK(field_info != nullptr);
+          const DefaultValue default_value = field_info->default_value;
+          collectors.emplace_back(info.data + message_index * info.stride,
+                                  default_value, info.last_dim_size);
+        }
 
-      // Fill in output tensors from the wire.
-      CodedInputStream input(reinterpret_cast<const uint8*>(buf.c_str()),
-                             buf.size());
-      absl::Status st = Collect(&input, absl::MakeSpan(collectors));
-      if (st.ok() && !input.ConsumedEntireMessage()) {
-        st = errors::DataLoss(
-            "AccumulateFields: Failed to consume entire buffer");
-      }
-      if (kFailOnDecodeError) {
-        OP_REQUIRES_OK(ctx, st);  // NOLINT
-      }
-      if (!st.ok()) {
-        // This code suppresses the corrupt proto, treating it as empty
-        // to avoid crashing training.
-        LOG(WARNING) << "Proto counting error for message type "
-                     << message_type_ << ": " << st;
-      }
+        // Fill in output tensors from the wire.
+        CodedInputStream input(reinterpret_cast<const uint8*>(buf.c_str()),
+                               buf.size());
+        absl::Status st = Collect(&input, absl::MakeSpan(collectors));
+        if (st.ok() && !input.ConsumedEntireMessage()) {
+          st = errors::DataLoss(
+              "AccumulateFields: Failed to consume entire buffer");
+        }
+        if (kFailOnDecodeError) {
+          OP_REQUIRES_OK(ctx, st);  // NOLINT
+        }
+        if (!st.ok()) {
+          // This code suppresses the corrupt proto, treating it as empty
+          // to avoid crashing training.
+          LOG(WARNING) << "Proto counting error for message type "
+                       << message_type_ << ": " << st;
+        }
 
-      // Fill the remainder of the dense outputs with default values.
-      for (auto& collector : collectors) {
-        OP_REQUIRES_OK(ctx, collector.FillWithDefaults());
+        // Fill the remainder of the dense outputs with default values.
+        for (auto& collector : collectors) {
+          OP_REQUIRES_OK(ctx, collector.FillWithDefaults());
+        }
       }
-    }
+    };
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, bufs.size(),
+          cost_per_message, decode_range);
   }
 
   // Traverses a serialized protobuf, dispatching values to the collectors.
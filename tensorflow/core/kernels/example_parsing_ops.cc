@@ -306,6 +306,21 @@ class ParseSingleExampleOp : public OpKernel {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
     metrics::RecordParseDenseFeature(attrs_.dense_keys.size());
     metrics::RecordParseSparseFeature(attrs_.sparse_keys.size());
+
+    // The feature names are attributes, so the feature lookup table only
+    // needs to be built once for all calls.
+    example::FastParseExampleConfig config;
+    config.dense.resize(attrs_.dense_keys.size());
+    for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
+      config.dense[d].feature_name = attrs_.dense_keys[d];
+    }
+    config.sparse.resize(attrs_.sparse_keys.size());
+    for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
+      config.sparse[d].feature_name = attrs_.sparse_keys[d];
+    }
+    OP_REQUIRES_OK(ctx,
+                   example::PrecomputeFastParseExampleConfigIndex(&config));
+    config_index_ = std::move(config.index);
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -356,7 +371,6 @@ class ParseSingleExampleOp : public OpKernel {
 
     example::Result result;
 
-    // TODO(mrry): Build the configuration once and cache it.
     example::FastParseExampleConfig config;
     for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
       config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
@@ -367,6 +381,7 @@ class ParseSingleExampleOp : public OpKernel {
     for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
       config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
     }
+    config.index = config_index_;
 
     const tstring& serialized_proto = serialized->scalar<tstring>()();
 
@@ -393,6 +408,7 @@ class ParseSingleExampleOp : public OpKernel {
 
  protected:
   ParseSingleExampleAttrs attrs_;
+  std::shared_ptr<const example::FastParseExampleConfigIndex> config_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseSingleExample").Device(DEVICE_CPU),
@@ -0,0 +1,298 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+template <typename T>
+using UnaryFn = void (*)(typename TTypes<T>::ConstFlat,
+                         typename TTypes<T>::Flat);
+template <typename T>
+using BinaryFn = void (*)(typename TTypes<T>::ConstFlat,
+                          typename TTypes<T>::ConstFlat,
+                          typename TTypes<T>::Flat);
+
+template <typename T, typename Functor>
+void ApplyUnary(typename TTypes<T>::ConstFlat x, typename TTypes<T>::Flat out) {
+  out = x.unaryExpr(typename Functor::func());
+}
+
+template <typename T>
+void ApplyRelu(typename TTypes<T>::ConstFlat x, typename TTypes<T>::Flat out) {
+  out = x.cwiseMax(static_cast<T>(0));
+}
+
+template <typename T, typename Functor>
+void ApplyBinary(typename TTypes<T>::ConstFlat x,
+                 typename TTypes<T>::ConstFlat y,
+                 typename TTypes<T>::Flat out) {
+  out = x.binaryExpr(y, typename Functor::func());
+}
+
+// WARN: This should be consistent with the FuseElementwiseClusters stage of
+// the arithmetic optimizer.
+template <typename T>
+const absl::flat_hash_map<string, UnaryFn<T>>& UnaryFns() {
+  static const auto* const fns = new absl::flat_hash_map<string, UnaryFn<T>>{
+      {"Abs", ApplyUnary<T, functor::abs<T>>},
+      {"Exp", ApplyUnary<T, functor::exp<T>>},
+      {"Inv", ApplyUnary<T, functor::inverse<T>>},
+      {"Log", ApplyUnary<T, functor::log<T>>},
+      {"Neg", ApplyUnary<T, functor::neg<T>>},
+      {"Reciprocal", ApplyUnary<T, functor::inverse<T>>},
+      {"Relu", ApplyRelu<T>},
+      {"Rsqrt", ApplyUnary<T, functor::rsqrt<T>>},
+      {"Sigmoid", ApplyUnary<T, functor::sigmoid<T>>},
+      {"Sqrt", ApplyUnary<T, functor::sqrt<T>>},
+      {"Square", ApplyUnary<T, functor::square<T>>},
+      {"Tanh", ApplyUnary<T, functor::tanh<T>>}};
+  return *fns;
+}
+
+template <typename T>
+const absl::flat_hash_map<string, BinaryFn<T>>& BinaryFns() {
+  static const auto* const fns = new absl::flat_hash_map<string, BinaryFn<T>>{
+      {"Add", ApplyBinary<T, functor::add<T>>},
+      {"AddV2", ApplyBinary<T, functor::add<T>>},
+      {"Div", ApplyBinary<T, functor::div<T>>},
+      {"Maximum", ApplyBinary<T, functor::maximum<T>>},
+      {"Minimum", ApplyBinary<T, functor::minimum<T>>},
+      {"Mul", ApplyBinary<T, functor::mul<T>>},
+      {"RealDiv", ApplyBinary<T, functor::div<T>>},
+      {"SquaredDifference", ApplyBinary<T, functor::squared_difference<T>>},
+      {"Sub", ApplyBinary<T, functor::sub<T>>}};
+  return *fns;
+}
+
+// `_FusedElementwise` evaluates a small program of element-wise ops in one
+// pass over its output. The output is split into blocks that fit in cache, and
+// every block runs the whole program before the next one starts, so the
+// intermediate results never leave the cache.
+//
+// Registers [0, N) hold the inputs and register N + i holds the result of
+// ops[i], whose operands are the next one or two registers listed in
+// `operands`. The result of the last op is the output.
+//
+// An input may be broadcast if its shape, without leading 1s, is a suffix of
+// the output shape. Element `i` of the output then reads element `i % size` of
+// that input.
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> ops;
+    std::vector<int32> operands;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+    num_inputs_ = context->num_inputs();
+
+    int next_operand = 0;
+    auto read_operand = [&](int num_registers, int* reg) -> absl::Status {
+      if (next_operand >= operands.size()) {
+        return errors::InvalidArgument("Too few operands for ops");
+      }
+      *reg = operands[next_operand++];
+      if (*reg < 0 || *reg >= num_registers) {
+        return errors::InvalidArgument("Operand ", *reg, " is not one of the ",
+                                       num_registers, " registers defined ",
+                                       "before it");
+      }
+      return absl::OkStatus();
+    };
+    const auto& unary_fns = UnaryFns<T>();
+    const auto& binary_fns = BinaryFns<T>();
+    for (const string& op : ops) {
+      const int num_registers = num_inputs_ + instructions_.size();
+      Instruction instruction;
+      if (auto it = unary_fns.find(op); it != unary_fns.end()) {
+        instruction.unary = it->second;
+        OP_REQUIRES_OK(context, read_operand(num_registers, &instruction.x));
+      } else if (auto it = binary_fns.find(op); it != binary_fns.end()) {
+        instruction.binary = it->second;
+        OP_REQUIRES_OK(context, read_operand(num_registers, &instruction.x));
+        OP_REQUIRES_OK(context, read_operand(num_registers, &instruction.y));
+      } else {
+        OP_REQUIRES(context, false,
+                    errors::InvalidArgument(
+                        "Unsupported op ", op, " for ",
+                        DataTypeString(DataTypeToEnum<T>::v())));
+      }
+      instructions_.push_back(instruction);
+    }
+    OP_REQUIRES(context, next_operand == operands.size(),
+                errors::InvalidArgument("Too many operands for ops"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // The output shape is the broadcast of all input shapes, aligned on their
+    // trailing dimensions.
+    int output_rank = 0;
+    for (int i = 0; i < num_inputs_; ++i) {
+      output_rank = std::max(output_rank, context->input(i).dims());
+    }
+    absl::InlinedVector<int64_t, 4> output_dims(output_rank, 1);
+    for (int i = 0; i < num_inputs_; ++i) {
+      const TensorShape& shape = context->input(i).shape();
+      for (int d = 0; d < shape.dims(); ++d) {
+        const int64_t dim = shape.dim_size(d);
+        if (dim != 1) output_dims[output_rank - shape.dims() + d] = dim;
+      }
+    }
+    TensorShape output_shape;
+    OP_REQUIRES_OK(context,
+                   TensorShape::BuildTensorShape(output_dims, &output_shape));
+    std::vector<int64_t> input_sizes(num_inputs_);
+    std::vector<int> forwardable_inputs;
+    for (int i = 0; i < num_inputs_; ++i) {
+      const TensorShape& shape = context->input(i).shape();
+      OP_REQUIRES(context, IsBroadcastableTo(shape, output_shape),
+                  errors::InvalidArgument(
+                      "Input ", i, " with shape ", shape.DebugString(),
+                      " can not be broadcast to ", output_shape.DebugString()));
+      input_sizes[i] = shape.num_elements();
+      if (shape == output_shape) forwardable_inputs.push_back(i);
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                forwardable_inputs, 0, output_shape, &output));
+    const int64_t size = output_shape.num_elements();
+    if (size == 0) return;
+
+    std::vector<const T*> inputs(num_inputs_);
+    for (int i = 0; i < num_inputs_; ++i) {
+      inputs[i] = context->input(i).flat<T>().data();
+    }
+    T* out = output->flat<T>().data();
+    const int num_blocks = (size + kBlockSize - 1) / kBlockSize;
+    const int64_t cost_per_block = kBlockSize * 5 * instructions_.size();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, [&](int64_t first_block, int64_t last_block) {
+            std::vector<T> scratch((num_inputs_ + instructions_.size()) *
+                                   kBlockSize);
+            for (int64_t b = first_block; b < last_block; ++b) {
+              const int64_t begin = b * kBlockSize;
+              EvaluateBlock(inputs, input_sizes, begin,
+                            std::min(kBlockSize, size - begin), out,
+                            scratch.data());
+            }
+          });
+  }
+
+ private:
+  // Small enough for all registers of typical programs to stay in L1.
+  static constexpr int64_t kBlockSize = 1024;
+
+  struct Instruction {
+    UnaryFn<T> unary = nullptr;
+    BinaryFn<T> binary = nullptr;
+    int x = 0;
+    int y = 0;
+  };
+
+  static bool IsBroadcastableTo(const TensorShape& shape,
+                                const TensorShape& output_shape) {
+    int first = 0;
+    while (first < shape.dims() && shape.dim_size(first) == 1) ++first;
+    const int rank = shape.dims() - first;
+    if (rank > output_shape.dims()) return false;
+    for (int d = 0; d < rank; ++d) {
+      if (shape.dim_size(first + d) !=
+          output_shape.dim_size(output_shape.dims() - rank + d)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Runs the program on output elements [begin, begin + size).
+  void EvaluateBlock(const std::vector<const T*>& inputs,
+                     const std::vector<int64_t>& input_sizes, int64_t begin,
+                     int64_t size, T* out, T* scratch) const {
+    std::vector<const T*> registers(num_inputs_ + instructions_.size());
+    for (int i = 0; i < num_inputs_; ++i) {
+      const int64_t input_size = input_sizes[i];
+      if (input_size >= begin + size) {
+        registers[i] = inputs[i] + begin;
+        continue;
+      }
+      // Copy the broadcast input into the block one period at a time.
+      T* block = scratch + i * kBlockSize;
+      int64_t offset = begin % input_size;
+      for (int64_t filled = 0; filled < size;) {
+        const int64_t n = std::min(input_size - offset, size - filled);
+        std::memcpy(block + filled, inputs[i] + offset, n * sizeof(T));
+        filled += n;
+        offset = 0;
+      }
+      registers[i] = block;
+    }
+
+    for (int k = 0; k < instructions_.size(); ++k) {
+      const Instruction& instruction = instructions_[k];
+      T* result = k + 1 == instructions_.size()
+                      ? out + begin
+                      : scratch + (num_inputs_ + k) * kBlockSize;
+      typename TTypes<T>::Flat result_block(result, size);
+      typename TTypes<T>::ConstFlat x(registers[instruction.x], size);
+      if (instruction.unary != nullptr) {
+        instruction.unary(x, result_block);
+      } else {
+        typename TTypes<T>::ConstFlat y(registers[instruction.y], size);
+        instruction.binary(x, y, result_block);
+      }
+      registers[num_inputs_ + k] = result;
+    }
+  }
+
+  int num_inputs_;
+  std::vector<Instruction> instructions_;
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+
+#undef REGISTER_CPU
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  absl::Status MakeOp(int num_inputs, const std::vector<string>& ops,
+                      const std::vector<int32>& operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_inputs, DT_FLOAT))
+                           .Attr("ops", ops)
+                           .Attr("operands", operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, Normalize) {
+  // (x - mean) * rsqrt(var + epsilon)
+  TF_ASSERT_OK(MakeOp(4, {"Sub", "Add", "Rsqrt", "Mul"},
+                      {0, 1, 2, 3, 5, 4, 6}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({1, 3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({3}), {3, 8, 15});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {0, 1 / 3.f, 2 / 4.f, 3 / 2.f, 4 / 3.f,
+                                      5 / 4.f});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, BroadcastAcrossBlocks) {
+  // square(maximum(x, y)) where y repeats every 7 elements.
+  TF_ASSERT_OK(MakeOp(2, {"Maximum", "Square"}, {0, 1, 2}));
+  const int rows = 500;
+  std::vector<float> x(rows * 7);
+  for (int i = 0; i < x.size(); ++i) x[i] = (i % 11) - 5;
+  const std::vector<float> y = {-3, -2, -1, 0, 1, 2, 3};
+  AddInputFromArray<float>(TensorShape({rows, 7}), x);
+  AddInputFromArray<float>(TensorShape({7}), y);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({rows, 7}));
+  for (int i = 0; i < x.size(); ++i) {
+    const float m = std::max(x[i], y[i % 7]);
+    expected.flat<float>()(i) = m * m;
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsUndefinedOperand) {
+  EXPECT_FALSE(MakeOp(1, {"Exp", "Log"}, {0, 2}).ok());
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsIncompatibleShapes) {
+  TF_ASSERT_OK(MakeOp(2, {"Add", "Exp"}, {0, 1, 2}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+
 #include "absl/base/prefetch.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -56,50 +58,76 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   // Store the value of invalidate index for printing error information, it's a
   // shared variable.
   SliceIndex result = -1;
+  // Rows are prefetched this many indices ahead of the copy, which is enough
+  // to cover a cache miss to DRAM for the short rows of embedding tables.
+  constexpr SliceIndex kPrefetchDistance = 8;
+  constexpr size_t kCacheLineSize = 64;
+  const size_t prefetch_bytes = std::min(slice_bytes, 4 * kCacheLineSize);
+  auto prefetch_row = [&](SliceIndex batch_idx, SliceIndex indices_idx) {
+    const Index index = indices(indices_idx);
+    if (!FastBoundsCheck(index, limit)) return;
+    const char* row = reinterpret_cast<const char*>(
+        params_base + (batch_idx * static_cast<SliceIndex>(limit) +
+                       static_cast<SliceIndex>(index)) *
+                          slice_elems);
+    for (size_t offset = 0; offset < prefetch_bytes;
+         offset += kCacheLineSize) {
+      absl::PrefetchToLocalCache(row + offset);
+    }
+  };
   auto work = [&](int64_t start, int64_t end) {
-    SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
-    SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
-    SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
-    SliceIndex indices_idx_end = static_cast<SliceIndex>(end % indices_size);
-
-    while ((batch_idx < batch_idx_end) ||
-           (batch_idx == batch_idx_end && indices_idx < indices_idx_end)) {
-      SliceIndex i_next = indices_idx + 1;
-      SliceIndex b_next = batch_idx + 1;
-      const Index index = internal::SubtleMustCopy(indices(indices_idx));
-      if (!FastBoundsCheck(index, limit)) {
-        mutex_lock l(mu);
-        result = indices_idx;
-        return;
-      }
-      if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
-          (i_next < indices_size)) {
-        absl::PrefetchToLocalCache(&params(batch_idx, indices(i_next), 0));
-        absl::PrefetchToLocalCache(&out(batch_idx, i_next, 0));
-        b_next = batch_idx;
-      } else if (b_next <= batch_idx_end) {
-        absl::PrefetchToLocalCache(&params(b_next, indices(0), 0));
-        absl::PrefetchToLocalCache(&out(b_next, 0, 0));
-        i_next = 0;
+    while (start < end) {
+      const SliceIndex batch_idx =
+          static_cast<SliceIndex>(start / indices_size);
+      const SliceIndex indices_begin =
+          static_cast<SliceIndex>(start % indices_size);
+      const SliceIndex indices_end = static_cast<SliceIndex>(
+          std::min<int64_t>(indices_size, indices_begin + (end - start)));
+      start += indices_end - indices_begin;
+
+      for (SliceIndex i = indices_begin;
+           i < std::min(indices_end, indices_begin + kPrefetchDistance); ++i) {
+        prefetch_row(batch_idx, i);
       }
-      // Copy using memcpy if possible, otherwise an Eigen loop
-      // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
-      // ahead-of-time compilation binary size).
-      if (is_simple_type<T>::value) {
-        // Avoid auto-promotion to Index from SliceIndex by casting.
-        memcpy(
-            out_base + (batch_idx * indices_size + indices_idx) * slice_elems,
-            params_base + (batch_idx * static_cast<SliceIndex>(limit) +
-                           static_cast<SliceIndex>(index)) *
-                              slice_elems,
-            slice_bytes);
-      } else {
-        // For non-"simple" types (e.g. strings).
-        out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
-            params.template chip<0>(batch_idx).template chip<0>(index);
+      SliceIndex indices_idx = indices_begin;
+      while (indices_idx < indices_end) {
+        const Index index = internal::SubtleMustCopy(indices(indices_idx));
+        if (!FastBoundsCheck(index, limit)) {
+          mutex_lock l(mu);
+          result = indices_idx;
+          return;
+        }
+        if (indices_idx + kPrefetchDistance < indices_end) {
+          prefetch_row(batch_idx, indices_idx + kPrefetchDistance);
+        }
+        // Copy using memcpy if possible, otherwise an Eigen loop
+        // TODO(cwhipkey): avoid linking to framework to get Allocator (to
+        // improve ahead-of-time compilation binary size).
+        if (is_simple_type<T>::value) {
+          // Runs of consecutive indices, e.g. from a range or a sorted
+          // batch of ids, are copied with a single memcpy.
+          SliceIndex run = 1;
+          while (indices_idx + run < indices_end &&
+                 static_cast<int64_t>(index) + run < limit &&
+                 internal::SubtleMustCopy(indices(indices_idx + run)) ==
+                     index + run) {
+            ++run;
+          }
+          // Avoid auto-promotion to Index from SliceIndex by casting.
+          memcpy(
+              out_base + (batch_idx * indices_size + indices_idx) * slice_elems,
+              params_base + (batch_idx * static_cast<SliceIndex>(limit) +
+                             static_cast<SliceIndex>(index)) *
+                                slice_elems,
+              run * slice_bytes);
+          indices_idx += run;
+        } else {
+          // For non-"simple" types (e.g. strings).
+          out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
+              params.template chip<0>(batch_idx).template chip<0>(index);
+          ++indices_idx;
+        }
       }
-      indices_idx = i_next;
-      batch_idx = b_next;
     }
   };
 
@@ -0,0 +1,320 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Largest scaling denominator supported by libjpeg DCT scaling.
+constexpr int kMaxScaleDenominator = 8;
+
+// Returns the largest DCT scaling denominator for which the scaled crop
+// window is still at least as large as the output, so that decoding at reduced
+// resolution never discards detail the resize would keep.
+int ChooseScaleDenominator(int crop_height, int crop_width, int out_height,
+                           int out_width) {
+  int ratio = kMaxScaleDenominator;
+  while (ratio > 1 &&
+         (crop_height / ratio < out_height || crop_width / ratio < out_width)) {
+    ratio /= 2;
+  }
+  return ratio;
+}
+
+// A crop window decoded at reduced resolution. Because libjpeg crops on whole
+// scaled pixels, the requested window is tracked in the coordinates of
+// `pixels` to keep the resize aligned with the original image.
+struct DecodedCrop {
+  std::vector<uint8> pixels;
+  int height = 0;
+  int width = 0;
+  int channels = 0;
+  float window_y = 0;
+  float window_x = 0;
+  float window_height = 0;
+  float window_width = 0;
+};
+
+// Decodes the window `crop_window` = [y, x, height, width] of the JPEG image
+// `contents`, at the lowest resolution that covers the output size.
+absl::Status DecodeCrop(absl::string_view contents, const int32* crop_window,
+                        jpeg::UncompressFlags flags, int out_height,
+                        int out_width, DecodedCrop* crop) {
+  int image_height = 0;
+  int image_width = 0;
+  if (!jpeg::GetImageInfo(contents.data(), contents.size(), &image_width,
+                          &image_height, /*components=*/nullptr)) {
+    return errors::InvalidArgument("Invalid JPEG data, size ",
+                                   contents.size());
+  }
+  const int y = crop_window[0];
+  const int x = crop_window[1];
+  const int height = crop_window[2];
+  const int width = crop_window[3];
+  if (height <= 0 || width <= 0 || y < 0 || x < 0 ||
+      y > image_height - height || x > image_width - width) {
+    return errors::InvalidArgument(
+        "Invalid crop window [", y, ", ", x, ", ", height, ", ", width,
+        "] for an image of size ", image_height, "x", image_width);
+  }
+
+  const int ratio =
+      ChooseScaleDenominator(height, width, out_height, out_width);
+  // libjpeg rounds scaled dimensions up.
+  const int scaled_height = (image_height + ratio - 1) / ratio;
+  const int scaled_width = (image_width + ratio - 1) / ratio;
+  const int scaled_y = y / ratio;
+  const int scaled_x = x / ratio;
+  flags.ratio = ratio;
+  flags.crop = true;
+  flags.crop_y = scaled_y;
+  flags.crop_x = scaled_x;
+  flags.crop_height =
+      std::min(scaled_height, (y + height + ratio - 1) / ratio) - scaled_y;
+  flags.crop_width =
+      std::min(scaled_width, (x + width + ratio - 1) / ratio) - scaled_x;
+
+  uint8* buffer = jpeg::Uncompress(
+      contents.data(), contents.size(), flags, /*nwarn=*/nullptr,
+      [crop](int decoded_width, int decoded_height,
+             int decoded_channels) -> uint8* {
+        crop->height = decoded_height;
+        crop->width = decoded_width;
+        crop->channels = decoded_channels;
+        crop->pixels.resize(static_cast<size_t>(decoded_height) *
+                            decoded_width * decoded_channels);
+        return crop->pixels.data();
+      });
+  if (buffer == nullptr) {
+    return errors::InvalidArgument(
+        "jpeg::Uncompress failed. Invalid JPEG data or crop window.");
+  }
+  crop->window_y = static_cast<float>(y) / ratio - scaled_y;
+  crop->window_x = static_cast<float>(x) / ratio - scaled_x;
+  crop->window_height = static_cast<float>(height) / ratio;
+  crop->window_width = static_cast<float>(width) / ratio;
+  return absl::OkStatus();
+}
+
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes bilinear interpolation weights with half pixel centers, sampling
+// `out_size` pixels from the window [begin, begin + length) of an input with
+// `in_size` pixels. Indices are multiplied by `stride`.
+std::vector<Interpolation> ComputeInterpolation(int64_t out_size,
+                                                int64_t in_size, float begin,
+                                                float length, int64_t stride) {
+  std::vector<Interpolation> interpolation(out_size);
+  const float scale = length / out_size;
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = begin + (i + 0.5f) * scale - 0.5f;
+    const float in_floor = std::floor(in);
+    interpolation[i].lower =
+        std::min(std::max<int64_t>(in_floor, 0), in_size - 1) * stride;
+    interpolation[i].upper =
+        std::min(std::max<int64_t>(std::ceil(in), 0), in_size - 1) * stride;
+    interpolation[i].lerp = in - in_floor;
+  }
+  return interpolation;
+}
+
+// Resizes the requested window of `crop` into the `out_height` x `out_width`
+// float image `output`.
+void ResizeCrop(const DecodedCrop& crop, int out_height, int out_width,
+                float* output) {
+  const int channels = crop.channels;
+  const int64_t row_size = static_cast<int64_t>(crop.width) * channels;
+  const std::vector<Interpolation> ys =
+      ComputeInterpolation(out_height, crop.height, crop.window_y,
+                           crop.window_height, /*stride=*/row_size);
+  const std::vector<Interpolation> xs =
+      ComputeInterpolation(out_width, crop.width, crop.window_x,
+                           crop.window_width, /*stride=*/channels);
+  const uint8* pixels = crop.pixels.data();
+  for (const Interpolation& y : ys) {
+    const uint8* top = pixels + y.lower;
+    const uint8* bottom = pixels + y.upper;
+    for (const Interpolation& x : xs) {
+      for (int c = 0; c < channels; ++c) {
+        const float top_left = top[x.lower + c];
+        const float top_right = top[x.upper + c];
+        const float bottom_left = bottom[x.lower + c];
+        const float bottom_right = bottom[x.upper + c];
+        const float top_value = top_left + (top_right - top_left) * x.lerp;
+        const float bottom_value =
+            bottom_left + (bottom_right - bottom_left) * x.lerp;
+        *output++ = top_value + (bottom_value - top_value) * y.lerp;
+      }
+    }
+  }
+}
+
+// Decodes, crops and resizes JPEG images in one pass. Only the crop window is
+// decoded, using libjpeg DCT scaling to skip resolution the output does not
+// need, and the result is resized straight into the output tensor. A vector
+// of images is decoded in parallel into the slots of a batch tensor.
+class DecodeCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Same default as `DecodeJpeg`.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& crop_window = context->input(1);
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument(
+                    "size must be a 1-D tensor with two elements, got shape ",
+                    size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    if (TensorShapeUtils::IsScalar(contents.shape())) {
+      OP_REQUIRES(context,
+                  TensorShapeUtils::IsVector(crop_window.shape()) &&
+                      crop_window.NumElements() == 4,
+                  errors::InvalidArgument(
+                      "crop_window must be a 1-D tensor with four elements "
+                      "for a single image, got shape ",
+                      crop_window.shape().DebugString()));
+      DecodedCrop crop;
+      OP_REQUIRES_OK(context,
+                     DecodeCrop(contents.scalar<tstring>()(),
+                                crop_window.vec<int32>().data(), flags_,
+                                out_height, out_width, &crop));
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(
+                         0, TensorShape({out_height, out_width, crop.channels}),
+                         &output));
+      ResizeCrop(crop, out_height, out_width, output->flat<float>().data());
+      return;
+    }
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument(
+                    "contents must be a scalar or a 1-D tensor, got shape ",
+                    contents.shape().DebugString()));
+    OP_REQUIRES(context, channels_ != 0,
+                errors::InvalidArgument(
+                    "channels must be set to decode a batch of images."));
+    const int64_t batch_size = contents.dim_size(0);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(crop_window.shape()) &&
+            crop_window.dim_size(0) == batch_size &&
+            crop_window.dim_size(1) == 4,
+        errors::InvalidArgument("crop_window must have shape [", batch_size,
+                                ", 4] for a batch of ", batch_size,
+                                " images, got shape ",
+                                crop_window.shape().DebugString()));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    static_cast<int64_t>(channels_)}),
+                       &output));
+    const int64_t image_size =
+        static_cast<int64_t>(out_height) * out_width * channels_;
+    const auto contents_vec = contents.vec<tstring>();
+    const auto windows = crop_window.matrix<int32>();
+    float* output_data = output->flat<float>().data();
+
+    mutex mu;
+    absl::Status status;
+    auto decode_images = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        DecodedCrop crop;
+        absl::Status s = DecodeCrop(contents_vec(i), &windows(i, 0), flags_,
+                                    out_height, out_width, &crop);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          status.Update(errors::CreateWithUpdatedMessage(
+              s, absl::StrCat("Failed to decode image ", i, ": ",
+                              s.message())));
+          return;
+        }
+        ResizeCrop(crop, out_height, out_width,
+                   output_data + i * image_size);
+      }
+    };
+    // Decoding dominates; a scaled decode touches a few times more pixels
+    // than the output has.
+    const int64_t cost_per_image = image_size * 200;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_image, decode_images);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kImageHeight = 256;
+constexpr int kImageWidth = 256;
+// JPEG compression error on a smooth image.
+constexpr float kTolerance = 6.0f;
+
+// Encodes an RGB image whose red channel is the column and green channel the
+// row, so that the expected value of any resampling is known exactly.
+tstring GradientJpeg() {
+  std::vector<uint8> pixels(kImageHeight * kImageWidth * 3);
+  for (int y = 0; y < kImageHeight; ++y) {
+    for (int x = 0; x < kImageWidth; ++x) {
+      uint8* pixel = &pixels[(y * kImageWidth + x) * 3];
+      pixel[0] = x;
+      pixel[1] = y;
+      pixel[2] = 128;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 100;
+  flags.chroma_downsampling = false;
+  return jpeg::Compress(pixels.data(), kImageWidth, kImageHeight, flags);
+}
+
+// Checks that `image` is the crop window [y, x, height, width] of the gradient
+// image, resized with half pixel centers.
+void ExpectResizedGradient(const float* image, int y, int x, int height,
+                           int width, int out_height, int out_width) {
+  for (int i = 0; i < out_height; ++i) {
+    for (int j = 0; j < out_width; ++j) {
+      const float expected_y = y + (i + 0.5f) * height / out_height - 0.5f;
+      const float expected_x = x + (j + 0.5f) * width / out_width - 0.5f;
+      const float* pixel = image + (i * out_width + j) * 3;
+      EXPECT_NEAR(pixel[0], expected_x, kTolerance) << "at " << i << ", " << j;
+      EXPECT_NEAR(pixel[1], expected_y, kTolerance) << "at " << i << ", " << j;
+      EXPECT_NEAR(pixel[2], 128, kTolerance) << "at " << i << ", " << j;
+    }
+  }
+}
+
+class DecodeCropAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int channels) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_op", "DecodeCropAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", channels)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(DecodeCropAndResizeJpegOpTest, Downscale) {
+  MakeOp(/*channels=*/3);
+  // Decodes at 1/8 scale.
+  AddInputFromArray<tstring>(TensorShape({}), {GradientJpeg()});
+  AddInputFromArray<int32>(TensorShape({4}), {37, 64, 160, 128});
+  AddInputFromArray<int32>(TensorShape({2}), {20, 16});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({20, 16, 3}));
+  ExpectResizedGradient(output.flat<float>().data(), 37, 64, 160, 128, 20, 16);
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, Upscale) {
+  MakeOp(/*channels=*/0);
+  AddInputFromArray<tstring>(TensorShape({}), {GradientJpeg()});
+  AddInputFromArray<int32>(TensorShape({4}), {10, 20, 30, 40});
+  AddInputFromArray<int32>(TensorShape({2}), {45, 50});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({45, 50, 3}));
+  ExpectResizedGradient(output.flat<float>().data(), 10, 20, 30, 40, 45, 50);
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, Batch) {
+  MakeOp(/*channels=*/3);
+  const tstring jpeg = GradientJpeg();
+  AddInputFromArray<tstring>(TensorShape({3}), {jpeg, jpeg, jpeg});
+  AddInputFromArray<int32>(TensorShape({3, 4}), {0, 0, 256, 256,  //
+                                                 100, 3, 64, 200,  //
+                                                 5, 17, 24, 24});
+  AddInputFromArray<int32>(TensorShape({2}), {24, 24});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({3, 24, 24, 3}));
+  const float* data = output.flat<float>().data();
+  const int image_size = 24 * 24 * 3;
+  ExpectResizedGradient(data, 0, 0, 256, 256, 24, 24);
+  ExpectResizedGradient(data + image_size, 100, 3, 64, 200, 24, 24);
+  ExpectResizedGradient(data + 2 * image_size, 5, 17, 24, 24, 24, 24);
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, InvalidCropWindow) {
+  MakeOp(/*channels=*/3);
+  AddInputFromArray<tstring>(TensorShape({}), {GradientJpeg()});
+  AddInputFromArray<int32>(TensorShape({4}), {200, 0, 100, 100});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 10});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, BatchRequiresChannels) {
+  MakeOp(/*channels=*/0);
+  AddInputFromArray<tstring>(TensorShape({1}), {GradientJpeg()});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {0, 0, 10, 10});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 10});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -203,14 +203,15 @@ void ResizeLine3ChannelsVector(const T* const ys_input_lower_ptr,
 
 template <typename T>
 void resize_image(
-    typename TTypes<T, 4>::ConstTensor images, const int batch_size,
-    const int64_t in_height, const int64_t in_width, const int64_t out_height,
-    const int64_t out_width, const int channels,
+    const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
+    const int batch_size, const int64_t in_height, const int64_t in_width,
+    const int64_t out_height, const int64_t out_width, const int channels,
     const std::vector<CachedInterpolation>& xs,
     const std::vector<CachedInterpolation>& ys,
     typename TTypes<float, 4>::Tensor output) TF_ATTRIBUTE_NOINLINE;
 template <typename T>
-void resize_image(typename TTypes<T, 4>::ConstTensor images,
+void resize_image(const CPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
                   const int batch_size, const int64_t in_height,
                   const int64_t in_width, const int64_t out_height,
                   const int64_t out_width, const int channels,
@@ -221,15 +222,21 @@ void resize_image(typename TTypes<T, 4>::ConstTensor images,
   const int64_t in_batch_num_values = in_height * in_row_size;
   const int64_t out_row_size = out_width * channels;
 
-  const T* input_b_ptr = images.data();
+  const T* input_data = images.data();
+  float* output_data = output.data();
   const CachedInterpolation* xs = xs_vec.data();
 
-  if (channels == 3) {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
+  // Output rows are independent of each other, so shard over all rows of all
+  // images in the batch.
+  auto resize_rows = [&](int64_t start, int64_t limit) {
+    for (int64_t row = start; row < limit; ++row) {
+      const int64_t b = row / out_height;
+      const int64_t y = row % out_height;
+      const T* input_b_ptr = input_data + b * in_batch_num_values;
+      const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
+      const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
+      float* output_y_ptr = output_data + row * out_row_size;
+      if (channels == 3) {
 #ifdef __SSE4_1__
         ResizeLine3ChannelsVector(ys_input_lower_ptr, ys_input_upper_ptr, xs,
                                   ys[y].lerp, out_width, output_y_ptr);
@@ -237,25 +244,19 @@ void resize_image(typename TTypes<T, 4>::ConstTensor images,
         ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
                            ys[y].lerp, out_width, output_y_ptr, 3);
 #endif
-        output_y_ptr += out_row_size;
-      }
-      input_b_ptr += in_batch_num_values;
-    }
-  } else {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-
+      } else {
         ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
                            ys[y].lerp, out_width, output_y_ptr, channels);
-
-        output_y_ptr += out_row_size;
       }
-      input_b_ptr += in_batch_num_values;
     }
-  }
+  };
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/4 * sizeof(T) * out_row_size,
+      /*bytes_stored=*/sizeof(float) * out_row_size,
+      /*compute_cycles=*/out_row_size *
+          (Eigen::TensorOpCost::AddCost<float>() * 6 +
+           Eigen::TensorOpCost::MulCost<float>() * 3));
+  d.parallelFor(batch_size * out_height, cost, resize_rows);
 }
 
 // Casts from float16 to T.
@@ -324,7 +325,7 @@ struct ResizeBilinear<CPUDevice, T> {
       xs[i].upper *= channels;
     }
 
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
+    resize_image<T>(d, images, batch_size, in_height, in_width, out_height,
                     out_width, channels, xs, ys, output);
   }
 };
@@ -30,7 +30,7 @@ absl::Status InitializableLookupTable::Find(OpKernelContext* ctx,
   // Do not let the use migrate before the check;  table is used without
   // a lock by the readers.
   std::atomic_thread_fence(std::memory_order_acquire);
-  return DoFind(keys, values, default_value);
+  return DoFind(ctx, keys, values, default_value);
 }
 
 absl::Status InitializableLookupTable::ImportValues(OpKernelContext* ctx,
@@ -195,9 +195,11 @@ class InitializableLookupTable : public LookupInterface {
   // underlying data structure.
   virtual absl::Status DoInsert(const Tensor& keys, const Tensor& values) = 0;
 
-  // Performs the batch find operation on the underlying data structure.
-  virtual absl::Status DoFind(const Tensor& keys, Tensor* values,
-                              const Tensor& default_value) = 0;
+  // Performs the batch find operation on the underlying data structure. `ctx`
+  // may be null; when set, its CPU worker threads may be used for large
+  // batches.
+  virtual absl::Status DoFind(OpKernelContext* ctx, const Tensor& keys,
+                              Tensor* values, const Tensor& default_value) = 0;
 
   virtual absl::Status AreEntriesSame(const InitTableIterator& iter,
                                       bool* result);
@@ -15,15 +15,23 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <atomic>
+#include <numeric>
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -100,5 +108,147 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class BoundedMutableHashTableTest : public OpsTestBase {
+ protected:
+  // Creates a table with int64 keys and float values, and returns it in
+  // `table`, which the caller must unref.
+  void MakeTable(int64_t max_size, int64_t admission_threshold,
+                 lookup::LookupInterface** table) {
+    TF_ASSERT_OK(NodeDefBuilder("table", "BoundedMutableHashTable")
+                     .Attr("key_dtype", DT_INT64)
+                     .Attr("value_dtype", DT_FLOAT)
+                     .Attr("max_size", max_size)
+                     .Attr("admission_threshold", admission_threshold)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    TF_ASSERT_OK(LookupResource(context_.get(),
+                                GetOutput(0)->scalar<ResourceHandle>()(),
+                                table));
+  }
+
+  void Insert(lookup::LookupInterface* table,
+              const std::vector<int64_t>& keys) {
+    std::vector<float> values(keys.begin(), keys.end());
+    TF_ASSERT_OK(table->Insert(context_.get(), test::AsTensor<int64_t>(keys),
+                               test::AsTensor<float>(values)));
+  }
+
+  Tensor Find(lookup::LookupInterface* table,
+              const std::vector<int64_t>& keys) {
+    Tensor values(DT_FLOAT, TensorShape({static_cast<int64_t>(keys.size())}));
+    TF_CHECK_OK(table->Find(context_.get(), test::AsTensor<int64_t>(keys),
+                            &values, test::AsScalar<float>(-1)));
+    return values;
+  }
+};
+
+TEST_F(BoundedMutableHashTableTest, EvictsWhenFull) {
+  lookup::LookupInterface* table = nullptr;
+  MakeTable(/*max_size=*/2, /*admission_threshold=*/1, &table);
+  core::ScopedUnref unref(table);
+
+  Insert(table, {1, 2});
+  EXPECT_EQ(table->size(), 2);
+  Insert(table, {3});
+  EXPECT_EQ(table->size(), 2);
+  test::ExpectTensorEqual<float>(Find(table, {1, 2, 3}),
+                                 test::AsTensor<float>({-1, 2, 3}));
+
+  // Updating an existing key never evicts.
+  Insert(table, {2});
+  EXPECT_EQ(table->size(), 2);
+  test::ExpectTensorEqual<float>(Find(table, {2, 3}),
+                                 test::AsTensor<float>({2, 3}));
+}
+
+TEST_F(BoundedMutableHashTableTest, AdmitsFrequentKeys) {
+  lookup::LookupInterface* table = nullptr;
+  MakeTable(/*max_size=*/16, /*admission_threshold=*/2, &table);
+  core::ScopedUnref unref(table);
+
+  Insert(table, {1, 2});
+  EXPECT_EQ(table->size(), 0);
+  Insert(table, {1});
+  EXPECT_EQ(table->size(), 1);
+  // Repeated keys within one batch count separately.
+  Insert(table, {3, 3});
+  EXPECT_EQ(table->size(), 2);
+  test::ExpectTensorEqual<float>(Find(table, {1, 2, 3}),
+                                 test::AsTensor<float>({1, -1, 3}));
+
+  TF_ASSERT_OK(table->Remove(context_.get(), test::AsTensor<int64_t>({1})));
+  EXPECT_EQ(table->size(), 1);
+}
+
+class MutableHashTableTest : public OpsTestBase {
+ protected:
+  // Creates a table with int64 keys and values, and returns it in `table`,
+  // which the caller must unref.
+  void MakeTable(lookup::LookupInterface** table) {
+    TF_ASSERT_OK(NodeDefBuilder("table", "MutableHashTableV2")
+                     .Attr("key_dtype", DT_INT64)
+                     .Attr("value_dtype", DT_INT64)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    TF_ASSERT_OK(LookupResource(context_.get(),
+                                GetOutput(0)->scalar<ResourceHandle>()(),
+                                table));
+  }
+};
+
+TEST_F(MutableHashTableTest, BatchesAreAtomic) {
+  lookup::LookupInterface* table = nullptr;
+  MakeTable(&table);
+  core::ScopedUnref unref(table);
+
+  // Enough keys to touch every shard of the table.
+  constexpr int kNumKeys = 256;
+  constexpr int kNumWrites = 200;
+  std::vector<int64_t> keys(kNumKeys);
+  std::iota(keys.begin(), keys.end(), 0);
+  const Tensor keys_tensor = test::AsTensor<int64_t>(keys);
+
+  // One thread overwrites all keys with the same value in every batch, while
+  // another checks that each lookup of all keys sees a single batch.
+  std::atomic<bool> done(false);
+  std::atomic<int> torn_lookups(0);
+  {
+    thread::ThreadPool pool(Env::Default(), "lookup_ops_test", 2);
+    pool.Schedule([&]() {
+      Tensor values(DT_INT64, TensorShape({kNumKeys}));
+      for (int64_t write = 1; write <= kNumWrites; ++write) {
+        values.flat<int64_t>().setConstant(write);
+        TF_CHECK_OK(table->Insert(context_.get(), keys_tensor, values));
+      }
+      done = true;
+    });
+    pool.Schedule([&]() {
+      Tensor values(DT_INT64, TensorShape({kNumKeys}));
+      const Tensor default_value = test::AsScalar<int64_t>(0);
+      while (!done) {
+        TF_CHECK_OK(
+            table->Find(context_.get(), keys_tensor, &values, default_value));
+        const auto flat = values.flat<int64_t>();
+        for (int i = 1; i < kNumKeys; ++i) {
+          if (flat(i) != flat(0)) {
+            ++torn_lookups;
+            break;
+          }
+        }
+      }
+    });
+  }
+  EXPECT_EQ(torn_lookups, 0);
+
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  TF_ASSERT_OK(table->Find(context_.get(), keys_tensor, &values,
+                           test::AsScalar<int64_t>(0)));
+  Tensor expected(DT_INT64, TensorShape({kNumKeys}));
+  expected.flat<int64_t>().setConstant(kNumWrites);
+  test::ExpectTensorEqual<int64_t>(values, expected);
+}
+
 }  // namespace
 }  // namespace tensorflow
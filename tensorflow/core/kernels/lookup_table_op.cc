@@ -16,14 +16,21 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,11 +43,148 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+// An unordered_map split into shards that are locked independently, so that
+// concurrent lookups and inserts of keys that land in different shards don't
+// serialize on a single table lock. Batched operations first partition their
+// keys by shard and then lock every shard they touch, in shard order, for the
+// whole batch. A batch is thus applied or observed atomically, as with a single
+// table lock, and batches that touch disjoint shards still run concurrently.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = std::unordered_map<K, V>;
+  static constexpr int kLogNumShards = 4;
+  static constexpr int kNumShards = 1 << kLogNumShards;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(map, i, key)` for each `key` at position `i` of `keys`, where
+  // `map` is the shard holding that key. A shared lock is held on every shard
+  // touched by `keys` until all calls have returned.
+  template <typename Keys, typename Fn>
+  void FindBatch(const Keys& keys, Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    const auto partition = Partition(keys);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (!partition[s].empty()) shards_[s].mu.lock_shared();
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      for (const auto& entry : partition[s]) {
+        fn(shards_[s].map, entry.first, static_cast<const K&>(entry.second));
+      }
+    }
+    for (int s = kNumShards - 1; s >= 0; --s) {
+      if (!partition[s].empty()) shards_[s].mu.unlock_shared();
+    }
+  }
+
+  // Same as FindBatch, but with exclusive locks so that `fn` may modify the
+  // shard map.
+  template <typename Keys, typename Fn>
+  void UpdateBatch(const Keys& keys, Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    const auto partition = Partition(keys);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (!partition[s].empty()) shards_[s].mu.lock();
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      for (const auto& entry : partition[s]) {
+        fn(shards_[s].map, entry.first, static_cast<const K&>(entry.second));
+      }
+    }
+    for (int s = kNumShards - 1; s >= 0; --s) {
+      if (!partition[s].empty()) shards_[s].mu.unlock();
+    }
+  }
+
+  // Same as UpdateBatch, but atomically clears the whole map first.
+  template <typename Keys, typename Fn>
+  void ReplaceBatch(const Keys& keys, Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    const auto partition = Partition(keys);
+    for (Shard& shard : shards_) shard.mu.lock();
+    for (int s = 0; s < kNumShards; ++s) {
+      shards_[s].map.clear();
+      for (const auto& entry : partition[s]) {
+        fn(shards_[s].map, entry.first, static_cast<const K&>(entry.second));
+      }
+    }
+    for (int s = kNumShards - 1; s >= 0; --s) shards_[s].mu.unlock();
+  }
+
+  // Returns `fn(maps)`, where `maps` holds all shard maps, while holding a
+  // shared lock on every shard so that they are observed consistently.
+  template <typename Fn>
+  auto ReadAll(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+    auto unlock = gtl::MakeCleanup([this]() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int s = kNumShards - 1; s >= 0; --s) shards_[s].mu.unlock_shared();
+    });
+    std::array<const Map*, kNumShards> maps;
+    for (int s = 0; s < kNumShards; ++s) maps[s] = &shards_[s].map;
+    return fn(maps);
+  }
+
+ private:
+  // Integral keys are copied out of the input tensor once, so that a
+  // concurrent write to it can't send a key to the wrong shard.
+  using StoredKey = std::conditional_t<std::is_same<K, tstring>::value,
+                                       std::reference_wrapper<const K>, K>;
+  using ShardKeys = std::vector<std::pair<int64_t, StoredKey>>;
+
+  // Shards live on their own cache lines so that their locks don't share one.
+  struct alignas(64) Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  static int ShardOf(const K& key) {
+    // Mix the hash, since std::hash is the identity on integers.
+    const uint64 hash = static_cast<uint64>(std::hash<K>()(key));
+    return (hash * 0x9E3779B97F4A7C15ULL) >> (64 - kLogNumShards);
+  }
+
+  template <typename Keys>
+  static std::array<ShardKeys, kNumShards> Partition(const Keys& keys) {
+    std::array<ShardKeys, kNumShards> partition;
+    for (int64_t i = 0; i < keys.size(); ++i) {
+      StoredKey key(SubtleMustCopyIfIntegral(keys(i)));
+      partition[ShardOf(key)].emplace_back(i, std::move(key));
+    }
+    return partition;
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+// Returns the number of buckets used by `maps`, counting empty buckets as one.
+template <class Map, size_t N>
+int64_t BucketMemory(const std::array<const Map*, N>& maps) {
+  int64_t ret = 0;
+  for (const Map* map : maps) {
+    for (unsigned i = 0; i < map->bucket_count(); ++i) {
+      size_t bucket_size = map->bucket_size(i);
+      if (bucket_size == 0) {
+        ret++;
+      } else {
+        ret += bucket_size;
+      }
+    }
+  }
+  return ret;
+}
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The map is sharded by key, so concurrent operations only contend when they
+// touch the same shard.
 //
 // Sample use case:
 //
@@ -55,10 +199,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
                     const Tensor& default_value) override {
@@ -70,8 +211,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.FindBatch(key_values, [&](const Map& map, int64_t i, const K& k) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +219,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+          map, k, is_full_size_default ? default_flat(i) : default_flat(0));
+    });
 
     return absl::OkStatus();
   }
@@ -90,13 +229,13 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    auto insert = [&](Map& map, int64_t i, const K& k) {
+      gtl::InsertOrUpdate(&map, k, SubtleMustCopyIfIntegral(value_values(i)));
+    };
     if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      table_.ReplaceBatch(key_values, insert);
+    } else {
+      table_.UpdateBatch(key_values, insert);
     }
     return absl::OkStatus();
   }
@@ -109,10 +248,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   absl::Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.UpdateBatch(key_values,
+                       [](Map& map, int64_t i, const K& k) { map.erase(k); });
     return absl::OkStatus();
   }
 
@@ -122,17 +259,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   absl::Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.ReadAll([&](const ShardMaps& maps) -> absl::Status {
+      int64_t size = TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +282,20 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
+    int64_t ret = table_.ReadAll(
+        [](const ShardMaps& maps) { return BucketMemory(maps); });
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   absl::Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.ReadAll([&](const ShardMaps& maps) {
+      int64_t size = TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,21 +328,32 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  using Table = ShardedHashMap<K, V>;
+  using Map = typename Table::Map;
+  using ShardMaps = std::array<const Map*, Table::kNumShards>;
+
+  static int64_t TotalSize(const ShardMaps& maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
+  // Writes all keys and values of `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `TotalSize(maps)`.
+  void ExportKeysAndValues(const ShardMaps& maps, Tensor* keys,
+                           Tensor* values) const {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -226,10 +370,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
                     const Tensor& default_value) override {
@@ -242,10 +383,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.FindBatch(key_values, [&](const Map& map, int64_t i, const K& k) {
+      const ValueArray* value_vec = gtl::FindOrNull(map, k);
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,7 +401,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return absl::OkStatus();
   }
@@ -272,18 +411,18 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    auto insert = [&](Map& map, int64_t i, const K& k) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      gtl::InsertOrUpdate(&map, k, value_vec);
+    };
+    if (clear) {
+      table_.ReplaceBatch(key_values, insert);
+    } else {
+      table_.UpdateBatch(key_values, insert);
     }
     return absl::OkStatus();
   }
@@ -296,10 +435,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   absl::Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.UpdateBatch(key_values,
+                       [](Map& map, int64_t i, const K& k) { map.erase(k); });
     return absl::OkStatus();
   }
 
@@ -309,18 +446,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   absl::Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.ReadAll([&](const ShardMaps& maps) -> absl::Status {
+      int64_t size = TotalSize(maps);
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +470,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
+    int64_t ret = table_.ReadAll(
+        [](const ShardMaps& maps) { return BucketMemory(maps); });
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   absl::Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.ReadAll([&](const ShardMaps& maps) {
+      int64_t size = TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +518,39 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Table = ShardedHashMap<K, ValueArray>;
+  using Map = typename Table::Map;
+  using ShardMaps = std::array<const Map*, Table::kNumShards>;
+
+  static int64_t TotalSize(const ShardMaps& maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
+  // Writes all keys and values of `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `TotalSize(maps)`.
+  void ExportKeysAndValues(const ShardMaps& maps, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
@@ -881,6 +1026,251 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+// Lookup table that holds at most `max_size` entries, for key spaces that grow
+// without bound. A new key is only admitted once a count-min sketch estimates
+// that it has been inserted `admission_threshold` times. When the table is
+// full, admitting a key evicts an entry that was not accessed recently, picked
+// with the CLOCK approximation of LRU so that lookups only need a shared lock.
+//
+// Values are exported and imported in the same layout as
+// MutableHashTableOfTensors. Imported entries bypass admission.
+template <class K, class V>
+class BoundedMutableHashTable final : public LookupInterface {
+ public:
+  BoundedMutableHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(
+        ctx,
+        TensorShapeUtils::IsScalar(value_shape_) ||
+            TensorShapeUtils::IsVector(value_shape_),
+        errors::InvalidArgument(
+            "Value shape must be a scalar or a vector, got shape ",
+            value_shape_.DebugString()));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "max_size", &max_size_));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "admission_threshold",
+                                    &admission_threshold_));
+    OP_REQUIRES(ctx, admission_threshold_ <= kMaxCount,
+                errors::InvalidArgument("admission_threshold must be at most ",
+                                        kMaxCount, ", got ",
+                                        admission_threshold_));
+    value_dim_ = value_shape_.num_elements();
+    if (admission_threshold_ > 1) {
+      int64_t width = 1;
+      while (width < std::min<int64_t>(max_size_, kMaxSketchWidth)) {
+        width <<= 1;
+      }
+      sketch_.resize(kSketchDepth * width);
+    }
+  }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return table_.size();
+  }
+
+  absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+                    const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    const int64_t num_keys = key_values.size();
+    auto value_values = value->shaped<V, 2>({num_keys, value_dim_});
+    const auto default_flat = default_value.flat<V>();
+    const bool is_full_size_default =
+        default_flat.size() == value_values.size();
+
+    tf_shared_lock l(mu_);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      const Slot* slot =
+          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+      if (slot != nullptr) {
+        slot->referenced.store(true, std::memory_order_relaxed);
+        for (int64_t j = 0; j < value_dim_; ++j) {
+          value_values(i, j) = slot->value[j];
+        }
+      } else {
+        for (int64_t j = 0; j < value_dim_; ++j) {
+          value_values(i, j) = is_full_size_default
+                                   ? default_flat(i * value_dim_ + j)
+                                   : default_flat(j);
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    mutex_lock l(mu_);
+    InsertLocked(keys, values, /*admit_all=*/false);
+    return absl::OkStatus();
+  }
+
+  absl::Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it != table_.end()) Erase(it);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                            const Tensor& values) override {
+    mutex_lock l(mu_);
+    table_.clear();
+    clock_.clear();
+    clock_hand_ = 0;
+    InsertLocked(keys, values, /*admit_all=*/true);
+    return absl::OkStatus();
+  }
+
+  absl::Status ExportValues(OpKernelContext* ctx) override {
+    tf_shared_lock l(mu_);
+    const int64_t size = table_.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TensorShape values_shape({size});
+    values_shape.AppendShape(value_shape_);
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", values_shape, &values));
+
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->shaped<V, 2>({size, value_dim_});
+    int64_t i = 0;
+    for (const auto& entry : table_) {
+      keys_data(i) = entry.first;
+      for (int64_t j = 0; j < value_dim_; ++j) {
+        values_data(i, j) = entry.second.value[j];
+      }
+      ++i;
+    }
+    return absl::OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(BoundedMutableHashTable) + sketch_.size() +
+           table_.size() * (sizeof(K) + sizeof(Slot) + sizeof(Entry*));
+  }
+
+ private:
+  // Sketch counters saturate at this value.
+  static constexpr int64_t kMaxCount = 255;
+  static constexpr int kSketchDepth = 4;
+  static constexpr int64_t kMaxSketchWidth = int64_t{1} << 24;
+
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
+  struct Slot {
+    ValueArray value;
+    // Position of the entry in `clock_`.
+    int64_t position = 0;
+    // Set whenever the entry is accessed, and cleared when the clock hand
+    // passes over it.
+    mutable std::atomic<bool> referenced{true};
+  };
+  using Map = std::unordered_map<K, Slot>;
+  using Entry = typename Map::value_type;
+
+  void InsertLocked(const Tensor& keys, const Tensor& values, bool admit_all)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto key_values = keys.flat<K>();
+    const int64_t num_keys = key_values.size();
+    const auto value_values = values.shaped<V, 2>({num_keys, value_dim_});
+    for (int64_t i = 0; i < num_keys; ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = table_.find(key);
+      if (it == table_.end()) {
+        if (!admit_all && !Admit(key)) continue;
+        if (static_cast<int64_t>(table_.size()) >= max_size_) EvictOne();
+        it = table_.try_emplace(key).first;
+        it->second.position = clock_.size();
+        clock_.push_back(&*it);
+      }
+      Slot& slot = it->second;
+      slot.value.resize(value_dim_);
+      for (int64_t j = 0; j < value_dim_; ++j) {
+        slot.value[j] = SubtleMustCopyIfIntegral(value_values(i, j));
+      }
+      slot.referenced.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // Counts an insertion of `key` in the sketch, and returns whether the key
+  // has now been inserted often enough to be admitted.
+  bool Admit(const K& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (sketch_.empty()) return true;
+    const int64_t width = sketch_.size() / kSketchDepth;
+    uint64 hash = HashScalar(key) * 0x9E3779B97F4A7C15ULL;
+    hash ^= hash >> 32;
+    const uint64 step = (hash >> 17) | 1;
+    int64_t estimate = kMaxCount;
+    for (int d = 0; d < kSketchDepth; ++d) {
+      uint8& count = sketch_[d * width + ((hash + d * step) & (width - 1))];
+      if (count < kMaxCount) ++count;
+      estimate = std::min<int64_t>(estimate, count);
+    }
+    // Periodically halve all counts, so that keys that were frequent a long
+    // time ago don't stay admitted forever.
+    if (++sketch_updates_ >= kAgingFactor * max_size_) {
+      for (uint8& count : sketch_) count >>= 1;
+      sketch_updates_ = 0;
+    }
+    return estimate >= admission_threshold_;
+  }
+
+  // Evicts the first entry under the clock hand that was not accessed since
+  // the hand last passed over it.
+  void EvictOne() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (!clock_.empty()) {
+      if (clock_hand_ >= clock_.size()) clock_hand_ = 0;
+      Entry* entry = clock_[clock_hand_];
+      if (entry->second.referenced.exchange(false,
+                                            std::memory_order_relaxed)) {
+        ++clock_hand_;
+        continue;
+      }
+      Erase(table_.find(entry->first));
+      return;
+    }
+  }
+
+  void Erase(typename Map::iterator it) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t position = it->second.position;
+    clock_[position] = clock_.back();
+    clock_[position]->second.position = position;
+    clock_.pop_back();
+    table_.erase(it);
+  }
+
+  // Number of sketch updates, relative to `max_size_`, between two agings.
+  static constexpr int64_t kAgingFactor = 10;
+
+  TensorShape value_shape_;
+  int64_t value_dim_;
+  int64_t max_size_;
+  int64_t admission_threshold_;
+  mutable mutex mu_;
+  Map table_ TF_GUARDED_BY(mu_);
+  // The entries of `table_`, in the order the clock hand visits them.
+  std::vector<Entry*> clock_ TF_GUARDED_BY(mu_);
+  int64_t clock_hand_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<uint8> sketch_ TF_GUARDED_BY(mu_);
+  int64_t sketch_updates_ TF_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1247,4 +1637,28 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Register the BoundedMutableHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                              \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("BoundedMutableHashTable")                                        \
+          .Device(DEVICE_CPU)                                                \
+          .TypeConstraint<key_dtype>("key_dtype")                            \
+          .TypeConstraint<value_dtype>("value_dtype"),                       \
+      LookupTableOp<lookup::BoundedMutableHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32);
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64_t);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
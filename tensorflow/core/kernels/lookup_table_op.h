@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <type_traits>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -320,16 +323,29 @@ class HashTable : public InitializableLookupTable {
     return absl::OkStatus();
   }
 
-  absl::Status DoFind(const Tensor& key, Tensor* value,
+  absl::Status DoFind(OpKernelContext* ctx, const Tensor& key, Tensor* value,
                       const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    auto find = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        value_values(i) = gtl::FindWithDefault(
+            table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+      }
+    };
+    if (ctx == nullptr) {
+      find(0, key_values.size());
+      return absl::OkStatus();
     }
+    // Hashing the key and probing a table that typically does not fit in
+    // cache; string keys cost more, in proportion to their length.
+    const int64_t kCostPerUnit = std::is_same<K, tstring>::value ? 200 : 50;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          key_values.size(), kCostPerUnit, find);
     return absl::OkStatus();
   }
 
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/weights_cache.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/bfloat16.h"
@@ -885,6 +886,31 @@ inline void FastConvertFromFloat<bfloat16>(const float* src, bfloat16* dst,
   FloatToBFloat16(src, dst, size);
 }
 
+// The conversions below are memory bound, but for matmuls with few rows in
+// the output converting the other operand costs as much as the matmul itself,
+// so they run on the CPU worker threads like the matmul does.
+template <typename T>
+inline void ParallelConvertToFloat(OpKernelContext* context, const T* src,
+                                   float* dst, int64_t size) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, size,
+        /*cost_per_unit=*/2, [src, dst](int64_t begin, int64_t end) {
+          FastConvertToFloat(src + begin, dst + begin, end - begin);
+        });
+}
+
+template <typename T>
+inline void ParallelConvertFromFloat(OpKernelContext* context,
+                                     const float* src, T* dst, int64_t size) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, size,
+        /*cost_per_unit=*/2, [src, dst](int64_t begin, int64_t end) {
+          FastConvertFromFloat(src + begin, dst + begin, end - begin);
+        });
+}
+
 template <typename Device, typename Ta, typename Tb, typename Tout>
 class BaseBatchMatMulOp : public OpKernel {
  public:
@@ -907,6 +933,7 @@ class BaseBatchMatMulOp : public OpKernel {
       OP_REQUIRES_OK(context, context->GetAttr("grad_x", &grad_input_1_));
       OP_REQUIRES_OK(context, context->GetAttr("grad_y", &grad_input_2_));
     }
+    const_weights_ = WeightsCache::WeightsAreConstant(context);
   }
 
   ~BaseBatchMatMulOp() override {}
@@ -982,35 +1009,56 @@ class BaseBatchMatMulOp : public OpKernel {
                   (std::is_same_v<Ta, bfloat16> ||
                    std::is_same_v<Ta, Eigen::half>)) {
       Tensor in0_reshaped_float, in1_reshaped_float, out_reshaped_float;
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in0_reshaped.shape(),
-                                             &in0_reshaped_float));
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in1_reshaped.shape(),
-                                             &in1_reshaped_float));
+      auto convert_to_float = [ctx](const Tensor& t,
+                                    Tensor* t_float) -> absl::Status {
+        TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_FLOAT, t.shape(), t_float));
+        ParallelConvertToFloat(ctx, t.flat<Ta>().data(),
+                               t_float->flat<float>().data(), t.NumElements());
+        return absl::OkStatus();
+      };
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, out_reshaped.shape(),
                                              &out_reshaped_float));
 
       // TODO: Avoid extra copy to make (b)float16 matmul efficient on CPU.
-      FastConvertToFloat(in0_reshaped.flat<Ta>().data(),
-                         in0_reshaped_float.flat<float>().data(),
-                         in0_reshaped.NumElements());
-      FastConvertToFloat(in1_reshaped.flat<Tb>().data(),
-                         in1_reshaped_float.flat<float>().data(),
-                         in1_reshaped.NumElements());
+      OP_REQUIRES_OK(ctx, convert_to_float(in0_reshaped, &in0_reshaped_float));
+      if (const_weights_) {
+        // Constant weights only have to be converted once.
+        OP_REQUIRES_OK(ctx, weights_cache_.GetOrCompute(in1_reshaped,
+                                                        convert_to_float,
+                                                        &in1_reshaped_float));
+      } else {
+        OP_REQUIRES_OK(ctx,
+                       convert_to_float(in1_reshaped, &in1_reshaped_float));
+      }
 
       LaunchBatchMatMul<Device, float>::Launch(
           ctx, in0_reshaped_float, in1_reshaped_float, adj_x_, adj_y_, trans_x_,
           trans_y_, grad_input_1_, grad_input_2_, bcast, &out_reshaped_float);
-      FastConvertFromFloat<Tout>(out_reshaped_float.flat<float>().data(),
-                                 out_reshaped.flat<Tout>().data(),
-                                 out->NumElements());
+      ParallelConvertFromFloat<Tout>(ctx,
+                                     out_reshaped_float.flat<float>().data(),
+                                     out_reshaped.flat<Tout>().data(),
+                                     out->NumElements());
     } else {
       // Cast tensor to desired type to reuse Eigen.
       // TODO(b/178749687): remove this cast if Eigen supports this natively.
       if constexpr (!std::is_same<Ta, Tout>::value) {
-        in0_reshaped = CastTensor<Ta, Tout>(in0_reshaped);
+        OP_REQUIRES_OK(ctx, CastTensor<Ta, Tout>(ctx, &in0_reshaped));
       }
       if constexpr (!std::is_same<Tb, Tout>::value) {
-        in1_reshaped = CastTensor<Tb, Tout>(in1_reshaped);
+        if (const_weights_) {
+          Tensor in1_cast;
+          OP_REQUIRES_OK(
+              ctx, weights_cache_.GetOrCompute(
+                       in1_reshaped,
+                       [&](const Tensor& t, Tensor* cast) {
+                         *cast = t;
+                         return CastTensor<Tb, Tout>(ctx, cast);
+                       },
+                       &in1_cast));
+          in1_reshaped = std::move(in1_cast);
+        } else {
+          OP_REQUIRES_OK(ctx, CastTensor<Tb, Tout>(ctx, &in1_reshaped));
+        }
       }
       LaunchBatchMatMul<Device, Tout>::Launch(
           ctx, in0_reshaped, in1_reshaped, adj_x_, adj_y_, trans_x_, trans_y_,
@@ -1031,13 +1079,21 @@ class BaseBatchMatMulOp : public OpKernel {
   bool trans_y_ = false;
   bool grad_input_1_ = false;
   bool grad_input_2_ = false;
+  // True if In[1] is constant, in which case transformations of it are cached
+  // in `weights_cache_`.
+  bool const_weights_ = false;
+  WeightsCache weights_cache_;
 
-  // Cast `t` from `SrcT` to `DstT`.
+  // Cast `t` from `SrcT` to `DstT` in place, on the device of the kernel.
   template <typename SrcT, typename DstT>
-  Tensor CastTensor(const Tensor& t) {
-    Tensor res = Tensor(DataTypeToEnum<DstT>::v(), t.shape());
-    res.flat<DstT>() = t.flat<SrcT>().template cast<DstT>();
-    return res;
+  absl::Status CastTensor(OpKernelContext* ctx, Tensor* t) {
+    Tensor res;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DataTypeToEnum<DstT>::v(), t->shape(), &res));
+    res.flat<DstT>().device(ctx->eigen_device<Device>()) =
+        t->flat<SrcT>().template cast<DstT>();
+    *t = std::move(res);
+    return absl::OkStatus();
   }
 };
 
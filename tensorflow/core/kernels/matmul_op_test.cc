@@ -545,6 +545,11 @@ BM_Matmul(2000, 1, 2000, true, true);
 
 // LINT.ThenChange(//tensorflow/core/kernels/mkl/mkl_matmul_op_benchmark.cc)
 
+// bfloat16 matmuls, which convert their operands to float and back on CPU.
+BM_MatmulDev(1, 1024, 1024, false, false, bfloat16, DT_BFLOAT16, cpu);
+BM_MatmulDev(16, 1024, 1024, false, false, bfloat16, DT_BFLOAT16, cpu);
+BM_MatmulDev(128, 1024, 1024, false, false, bfloat16, DT_BFLOAT16, cpu);
+
 // Benchmarks for batched matmul with broadcasting.
 Node* BroadcastTo(Graph* g, Node* input, Node* shape) {
   Node* ret;
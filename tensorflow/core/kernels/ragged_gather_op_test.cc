@@ -175,6 +175,37 @@ TEST_F(RaggedGatherOpTest, RaggedGather_ScalarIndices) {
                                 test::AsTensor<float>({.4, .5, .6, .7}), 0.1);
 }
 
+TEST_F(RaggedGatherOpTest, RaggedGather_ManyRows) {
+  // Enough rows for the values to be copied by several threads.
+  const int kRows = 10000;
+  std::vector<int64_t> splits = {0};
+  std::vector<float> values;
+  for (int r = 0; r < kRows; ++r) {
+    for (int c = 0; c < r % 4; ++c) values.push_back(values.size());
+    splits.push_back(values.size());
+  }
+  std::vector<int32> indices;
+  std::vector<int64_t> expected_splits = {0};
+  std::vector<float> expected_values;
+  for (int r = kRows - 1; r >= 0; r -= 2) {
+    indices.push_back(r);
+    for (int64_t i = splits[r]; i < splits[r + 1]; ++i) {
+      expected_values.push_back(values[i]);
+    }
+    expected_splits.push_back(expected_values.size());
+  }
+  BuildRaggedGatherGraph<float, int32>(
+      TensorShape({static_cast<int64_t>(indices.size())}), indices, {splits},
+      TensorShape({static_cast<int64_t>(values.size())}), values);
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>(expected_splits));
+  test::ExpectTensorEqual<float>(*GetOutput(1),
+                                 test::AsTensor<float>(expected_values));
+}
+
 TEST_F(RaggedGatherOpTest, RaggedGather_OutOfBounds) {
   // indices = [2, 10]
   // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -515,68 +516,99 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       default_value = bcast_default.flat<VALUE_TYPE>().data();
     }
 
-    // Loop through the output_index vector, finding contiguous regions that
-    // should be copied.  Once we find the end of a contiguous region, copy it
-    // and add any necessary padding (with default_value).
-    INDEX_TYPE src_start = 0;  // Start of contiguous region (in values)
-    INDEX_TYPE dst_start = 0;  // Destination for contiguous region (in output)
-    INDEX_TYPE dst_end = 0;    // Destination for contiguous region (in output)
-    for (int src_i = 0; src_i <= output_index_size; ++src_i) {
-      // dst_i is the destination where the value at src_i should be copied.
-      INDEX_TYPE dst_i = src_i < output_index_size ? output_index[src_i] : -1;
-
-      // If we're still in a contiguous region, then update dst_end go to the
-      // next src_i.
-      if (dst_i == dst_end) {
-        ++dst_end;
-        continue;
-      }
+    // Loop through output_index[src_begin:src_end], finding contiguous regions
+    // that should be copied.  Once we find the end of a contiguous region, copy
+    // it and add any necessary padding (with default_value), starting at
+    // output row dst_begin and padding up to output row dst_limit.
+    auto copy_range = [&](INDEX_TYPE src_begin, INDEX_TYPE src_end,
+                          INDEX_TYPE dst_begin, INDEX_TYPE dst_limit) {
+      // Start of contiguous region (in values)
+      INDEX_TYPE src_start = src_begin;
+      // Destination for contiguous region (in output)
+      INDEX_TYPE dst_start = dst_begin;
+      INDEX_TYPE dst_end = dst_begin;
+      for (INDEX_TYPE src_i = src_begin; src_i <= src_end; ++src_i) {
+        // dst_i is the destination where the value at src_i should be copied.
+        INDEX_TYPE dst_i = src_i < src_end ? output_index[src_i] : -1;
+
+        // If we're still in a contiguous region, then update dst_end go to the
+        // next src_i.
+        if (dst_i == dst_end) {
+          ++dst_end;
+          continue;
+        }
 
-      // We found the end of contiguous region.  This can be because we found
-      // a gap (dst_i > dst_end), or a source value that shouldn't be copied
-      // because it's out-of-bounds (dst_i == -1), or the end of the tensor
-      // (dst_i = -1).
-      if (dst_start < dst_end) {
-        // Copy the contiguous region.
-        const VALUE_TYPE* src = values_base + src_start * value_element_size;
-        VALUE_TYPE* dst = output_base + dst_start * value_element_size;
-        INDEX_TYPE nvals = (dst_end - dst_start) * value_element_size;
-        copy_array<VALUE_TYPE, INDEX_TYPE>(dst, src, nvals);
-      }
+        // We found the end of contiguous region.  This can be because we found
+        // a gap (dst_i > dst_end), or a source value that shouldn't be copied
+        // because it's out-of-bounds (dst_i == -1), or the end of the range
+        // (dst_i = -1).
+        if (dst_start < dst_end) {
+          // Copy the contiguous region.
+          const VALUE_TYPE* src = values_base + src_start * value_element_size;
+          VALUE_TYPE* dst = output_base + dst_start * value_element_size;
+          INDEX_TYPE nvals = (dst_end - dst_start) * value_element_size;
+          copy_array<VALUE_TYPE, INDEX_TYPE>(dst, src, nvals);
+        }
 
-      // Add any necessary padding (w/ default_value).
-      if (src_i >= output_index_size) {
-        // We reached the end of values: pad to the end of output.
-        size_t output_size = output_tensor->NumElements();
-        dst_i = output_size / value_element_size;
-      }
-      if (dst_i > dst_end) {
-        if (default_value_tensor.NumElements() == 1) {
-          std::fill(output_base + dst_end * value_element_size,
-                    output_base + dst_i * value_element_size, *default_value);
-          dst_end = dst_i;
-        } else {
-          while (dst_i > dst_end) {
-            VALUE_TYPE* dst = output_base + dst_end * value_element_size;
-            copy_array<VALUE_TYPE, INDEX_TYPE>(dst, default_value,
-                                               value_element_size);
-            ++dst_end;
+        // Add any necessary padding (w/ default_value).
+        if (src_i >= src_end) {
+          // We reached the end of the range: pad to its end in the output.
+          dst_i = dst_limit;
+        }
+        if (dst_i > dst_end) {
+          if (default_value_tensor.NumElements() == 1) {
+            std::fill(output_base + dst_end * value_element_size,
+                      output_base + dst_i * value_element_size,
+                      *default_value);
+            dst_end = dst_i;
+          } else {
+            while (dst_i > dst_end) {
+              VALUE_TYPE* dst = output_base + dst_end * value_element_size;
+              copy_array<VALUE_TYPE, INDEX_TYPE>(dst, default_value,
+                                                 value_element_size);
+              ++dst_end;
+            }
           }
         }
-      }
 
-      // Update indices.
-      if (dst_i < 0) {
-        // src_i should be skipped -- leave it out of the contiguous region.
-        src_start = src_i + 1;
-        dst_start = dst_end;
-      } else {
-        // src_i should be copied -- include it in the contiguous region.
-        src_start = src_i;
-        dst_start = dst_end;
-        dst_end = dst_start + 1;
+        // Update indices.
+        if (dst_i < 0) {
+          // src_i should be skipped -- leave it out of the contiguous region.
+          src_start = src_i + 1;
+          dst_start = dst_end;
+        } else {
+          // src_i should be copied -- include it in the contiguous region.
+          src_start = src_i;
+          dst_start = dst_end;
+          dst_end = dst_start + 1;
+        }
+      }
+    };
+
+    const INDEX_TYPE num_output_rows =
+        output_tensor->NumElements() / value_element_size;
+    // Values that are copied land in increasing output rows, so the output
+    // rows up to the destination of the first value copied at or after
+    // src_i are written by the values before src_i.
+    auto first_dst_row = [&](INDEX_TYPE src_i) {
+      for (; src_i < output_index_size; ++src_i) {
+        if (output_index[src_i] >= 0) return output_index[src_i];
       }
+      return num_output_rows;
+    };
+    if (output_index_size == 0) {
+      copy_range(0, 0, 0, num_output_rows);
+      return;
     }
+    const int64_t cost_per_value =
+        output_tensor->NumElements() * sizeof(VALUE_TYPE) / output_index_size;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          output_index_size, cost_per_value,
+          [&](int64_t begin, int64_t end) {
+            copy_range(begin, end, begin == 0 ? 0 : first_dst_row(begin),
+                       first_dst_row(end));
+          });
   }
 };
 
@@ -409,6 +409,36 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorConstrained) {
                                 0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorManyRows) {
+  // Enough rows for the output to be written by several threads, with row
+  // lengths 0..4 constrained to 3 columns.
+  const int kRows = 20000;
+  const int kCols = 3;
+  std::vector<float> values;
+  std::vector<int32> row_splits = {0};
+  std::vector<float> expected(kRows * kCols, 1.5);
+  for (int r = 0; r < kRows; ++r) {
+    for (int c = 0; c < r % 5; ++c) {
+      if (c < kCols) expected[r * kCols + c] = values.size();
+      values.push_back(values.size());
+    }
+    row_splits.push_back(values.size());
+  }
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({kRows, kCols}),       // shape
+      {"ROW_SPLITS"},                    // row_partition_types
+      createVector<float>(values),       // values
+      createScalar<float>(1.5),          // default_value
+      {createVector<int32>(row_splits)}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>(expected, TensorShape({kRows, kCols})));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParamsConstrained) {
   // params = [
   //           [[]],
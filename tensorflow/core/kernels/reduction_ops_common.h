@@ -23,6 +23,11 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/numeric_op.h"
@@ -35,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -269,9 +275,99 @@ struct ReduceFunctorBase {
   }
 };
 
+// Describes the reducers for which a column reduction can use ColumnSum.
+template <typename Reducer>
+struct ColumnSumTraits {
+  static constexpr bool kSupported = false;
+  static constexpr bool kIsMean = false;
+};
+
+template <typename T>
+struct ColumnSumTraits<Eigen::internal::SumReducer<T>> {
+  static constexpr bool kSupported = std::is_floating_point<T>::value;
+  static constexpr bool kIsMean = false;
+};
+
+template <typename T>
+struct ColumnSumTraits<MeanReducer<T>> {
+  static constexpr bool kSupported = std::is_floating_point<T>::value;
+  static constexpr bool kIsMean = true;
+};
+
+// Returns true if reducing the first axis of a [rows, cols] matrix should use
+// ColumnSum rather than Eigen.
+inline bool UseColumnSum(OpKernelContext* ctx, int64_t rows, int64_t cols) {
+  // Eigen parallelizes a column reduction over its outputs only. That leaves
+  // threads idle and walks memory with a large stride when there are few
+  // columns and many rows.
+  static constexpr int64_t kMaxColumns = 1024;
+  static constexpr int64_t kMinElements = 1 << 16;
+  return cols <= kMaxColumns && rows * cols >= kMinElements &&
+         ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
+}
+
+// Sums the rows of the row-major [rows, cols] matrix `in` into `out`. The rows
+// are split into blocks that are summed in parallel with contiguous vector
+// adds, and the partial sums of the blocks are then added up in block order.
+// The blocks only depend on the shape, so the result does not depend on the
+// number of threads.
+template <typename T>
+void ColumnSum(OpKernelContext* ctx, T* out, const T* in, int64_t rows,
+               int64_t cols) {
+  static constexpr int64_t kMaxBlocks = 64;
+  static constexpr int64_t kMinBlockElements = 16 * 1024;
+  const int64_t block_rows =
+      std::max((rows + kMaxBlocks - 1) / kMaxBlocks,
+               (kMinBlockElements + cols - 1) / cols);
+  const int64_t num_blocks = (rows + block_rows - 1) / block_rows;
+
+  using Row = Eigen::Map<Eigen::Array<T, 1, Eigen::Dynamic>>;
+  using ConstRow = Eigen::Map<const Eigen::Array<T, 1, Eigen::Dynamic>>;
+  std::vector<T> partial_sums(num_blocks * cols, T(0));
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        /*cost_per_unit=*/block_rows * cols, [&](int64_t begin, int64_t end) {
+          for (int64_t b = begin; b < end; ++b) {
+            Row sum(&partial_sums[b * cols], cols);
+            const int64_t row_end = std::min(rows, (b + 1) * block_rows);
+            for (int64_t r = b * block_rows; r < row_end; ++r) {
+              sum += ConstRow(in + r * cols, cols);
+            }
+          }
+        });
+  Row result(out, cols);
+  result.setZero();
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    result += ConstRow(&partial_sums[b * cols], cols);
+  }
+}
+
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
-    : ReduceFunctorBase<CPUDevice, Reducer> {};
+    : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    if constexpr (ColumnSumTraits<Reducer>::kSupported &&
+                  OUT_T::NumDimensions == 1 && IN_T::NumDimensions == 2 &&
+                  std::is_same<ReductionAxes,
+                               Eigen::IndexList<Eigen::type2index<0>>>::value) {
+      const int64_t rows = in.dimension(0);
+      const int64_t cols = in.dimension(1);
+      if (UseColumnSum(ctx, rows, cols)) {
+        ColumnSum(ctx, out.data(), in.data(), rows, cols);
+        if (ColumnSumTraits<Reducer>::kIsMean) {
+          out = out / static_cast<typename OUT_T::Scalar>(rows);
+        }
+        return;
+      }
+    }
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in, reduction_axes,
+                                                  reducer);
+  }
+};
 
 }  // namespace functor
 }  // namespace tensorflow
@@ -256,4 +256,43 @@ static void BM_Mean2DToScalarCPUBF16(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Mean2DToScalarCPUBF16)->RangePair(2048, 8192, 2048, 8192);
 
+// Feature-normalization graphs reduce tall, narrow matrices over either axis.
+static void BM_Sum2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)
+    ->UseRealTime()
+    ->ArgPair(1 << 20, 1)
+    ->ArgPair(1 << 20, 8)
+    ->ArgPair(1 << 20, 64)
+    ->ArgPair(1 << 16, 1024)
+    ->ArgPair(1024, 1 << 16);
+
+static void BM_Mean2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Mean", num_x, num_y);
+}
+BENCHMARK(BM_Mean2DColumnReduceCPU)
+    ->UseRealTime()
+    ->ArgPair(1 << 20, 8)
+    ->ArgPair(1 << 20, 64);
+
+static void BM_Sum2DRowReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoRowReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DRowReduceCPU)
+    ->UseRealTime()
+    ->ArgPair(1 << 20, 8)
+    ->ArgPair(1 << 20, 64)
+    ->ArgPair(1 << 16, 1024)
+    ->ArgPair(1024, 1 << 16);
+
 }  // end namespace tensorflow
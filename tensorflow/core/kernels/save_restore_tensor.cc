@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -360,6 +363,37 @@ struct RestoreOp {
   absl::Status status;
 };
 
+// Runs `ops`, which are adjacent in the checkpoint, with a single new
+// BundleReader so that they are read as one sequential scan. Stops at the
+// first failing op; the failure is recorded in that op's status.
+void RunRestoreOpsWithNewReader(absl::Span<RestoreOp* const> ops,
+                                BundleCache* cache) {
+  if (ops.empty()) return;
+  BundleReader reader(tsl::Env::Default(), ops.front()->reader_prefix,
+                      {cache, false});
+  for (RestoreOp* op : ops) {
+    op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+    if (!op->status.ok()) return;
+  }
+}
+
+// Number of threads used to restore the small tensors of a RestoreV2 op when
+// no explicit restore parallelism is configured. Zero (the default) restores
+// them serially from the op thread.
+int64_t SmallTensorRestoreThreads() {
+  static const int64_t num_threads = [] {
+    int64_t value;
+    absl::Status status =
+        ReadInt64FromEnvVar("TF_RESTORE_SMALL_TENSORS_THREADS", 0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.message();
+      return int64_t{0};
+    }
+    return std::max(value, int64_t{0});
+  }();
+  return num_threads;
+}
+
 }  // namespace
 
 absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -456,17 +490,43 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
-    // Read small tensors from the op thread.
-    for (auto* op : small_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    const int64_t small_restore_threads = std::min<int64_t>(
+        SmallTensorRestoreThreads(), small_restore_ops.size());
+    std::unique_ptr<thread::ThreadPool> small_reader_pool;
+    if (small_restore_threads > 1) {
+      // `small_restore_ops` is in file order, so splitting it into contiguous
+      // runs gives each thread a sequential scan of its own region of the
+      // bundle.
+      small_reader_pool = std::make_unique<thread::ThreadPool>(
+          Env::Default(), "restore_small_tensors", small_restore_threads);
+      const absl::Span<RestoreOp* const> ops(small_restore_ops);
+      const size_t run_size =
+          (ops.size() + small_restore_threads - 1) / small_restore_threads;
+      for (size_t start = 0; start < ops.size(); start += run_size) {
+        small_reader_pool->Schedule([run = ops.subspan(start, run_size),
+                                     &cache]() {
+          RunRestoreOpsWithNewReader(run, &cache);
+        });
+      }
+    } else {
+      // Read small tensors from the op thread.
+      for (auto* op : small_restore_ops) {
+        TF_RETURN_IF_ERROR(op->run(&default_reader));
+      }
     }
 
     // Wait for all scheduled work to finish and check the status of all
-    // ops that ran in the pool.
+    // ops that ran in the pools.
+    small_reader_pool.reset();
     reader_pool.reset();
     for (auto* op : large_restore_ops) {
       TF_RETURN_IF_ERROR(op->status);
     }
+    if (small_restore_threads > 1) {
+      for (auto* op : small_restore_ops) {
+        TF_RETURN_IF_ERROR(op->status);
+      }
+    }
   }
 
   for (const RestoreOp& restore_op : restore_ops) {
@@ -20,7 +20,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <utility>
+#include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
@@ -29,9 +32,11 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
 
@@ -102,6 +107,71 @@ class UpdateExecutor<T, Input, Update, Output, scatter_nd_op::UpdateOp::MAX> {
 
 namespace functor {
 
+namespace scatter_nd_cpu {
+
+// Scatters with at least this many updated elements are applied in parallel.
+constexpr int64_t kParallelMinElements = 32768;
+
+// Updates are prefetched this many rows ahead of the one being applied.
+constexpr int64_t kPrefetchDistance = 8;
+
+template <typename T, scatter_nd_op::UpdateOp OP>
+EIGEN_ALWAYS_INLINE void UpdateSlice(const T* update, int64_t slice_size,
+                                     T* output) {
+  for (int64_t j = 0; j < slice_size; ++j) {
+    if constexpr (OP == scatter_nd_op::UpdateOp::ASSIGN) {
+      output[j] = update[j];
+    } else if constexpr (OP == scatter_nd_op::UpdateOp::ADD) {
+      output[j] += update[j];
+    } else if constexpr (OP == scatter_nd_op::UpdateOp::SUB) {
+      output[j] -= update[j];
+    } else if constexpr (OP == scatter_nd_op::UpdateOp::MIN) {
+      output[j] = Eigen::numext::mini(output[j], update[j]);
+    } else {
+      output[j] = Eigen::numext::maxi(output[j], update[j]);
+    }
+  }
+}
+
+// Applies the updates in `slices`, pairs of (output slice, update slice), on
+// the worker threads. `slices` is ordered by output slice, keeping the order of
+// the updates within each output slice, so that each output slice is updated
+// by a single thread in the original order and the output is walked in address
+// order.
+template <typename T, typename Index, scatter_nd_op::UpdateOp OP>
+void ApplyInParallel(const CPUDevice& d, Index slice_size,
+                     const std::vector<std::pair<Index, Index>>& slices,
+                     const T* updates, T* output) {
+  const int64_t num_slices = slices.size();
+  auto apply = [&](int64_t begin, int64_t end) {
+    // An output slice belongs to the block holding its first update.
+    while (begin > 0 && begin < num_slices &&
+           slices[begin].first == slices[begin - 1].first) {
+      ++begin;
+    }
+    while (end < num_slices && slices[end].first == slices[end - 1].first) {
+      ++end;
+    }
+    for (int64_t k = begin; k < end; ++k) {
+      if (k + kPrefetchDistance < end) {
+        const auto& next = slices[k + kPrefetchDistance];
+        port::prefetch<port::PREFETCH_HINT_T0>(output +
+                                               next.first * slice_size);
+        port::prefetch<port::PREFETCH_HINT_T0>(updates +
+                                               next.second * slice_size);
+      }
+      UpdateSlice<T, OP>(updates + slices[k].second * slice_size, slice_size,
+                         output + slices[k].first * slice_size);
+    }
+  };
+  const Eigen::TensorOpCost cost(/*bytes_loaded=*/2 * slice_size * sizeof(T),
+                                 /*bytes_stored=*/slice_size * sizeof(T),
+                                 /*compute_cycles=*/slice_size);
+  d.parallelFor(num_slices, cost, apply);
+}
+
+}  // namespace scatter_nd_cpu
+
 // Implementation of update functor for CPU.
 template <typename T, typename Index, scatter_nd_op::UpdateOp OP, int IXDIM>
 struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
@@ -127,6 +197,35 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
+    if constexpr (is_simple_type<T>::value) {
+      if (batch_size > 1 && static_cast<int64_t>(batch_size) * slice_size >=
+                                scatter_nd_cpu::kParallelMinElements) {
+        std::vector<std::pair<Index, Index>> slices;
+        slices.reserve(batch_size);
+        for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+          Index i = 0;
+          bool out_of_bounds = false;
+          for (int dim = 0; dim < IXDIM; ++dim) {
+            const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+            out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+            i += ix_d * batch_strides[dim];
+          }
+          if (TF_PREDICT_FALSE(out_of_bounds)) {
+            error_loc = loc;
+          } else {
+            slices.emplace_back(i, static_cast<Index>(loc));
+          }
+        }
+        // Sorting the pairs keeps updates to the same slice in order.
+        if (!std::is_sorted(slices.begin(), slices.end())) {
+          std::sort(slices.begin(), slices.end());
+        }
+        scatter_nd_cpu::ApplyInParallel<T, Index, OP>(
+            d, slice_size, slices, Tupdates.data(), Toutput.data());
+        return error_loc;
+      }
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
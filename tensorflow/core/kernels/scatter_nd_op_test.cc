@@ -522,6 +522,32 @@ TEST_F(ScatterNdOpTest, Simple_OneD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(ScatterNdOpTest, LargeWithRepeatedIndices) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Large enough to be applied in parallel; every row is updated 400 times
+  // from updates that are not ordered by row.
+  const int kRows = 100;
+  const int kUpdates = 40000;
+  std::vector<int32> indices(kUpdates);
+  std::vector<float> updates(kUpdates);
+  for (int i = 0; i < kUpdates; ++i) {
+    indices[i] = (kUpdates - i) % kRows;
+    updates[i] = indices[i];
+  }
+  AddInputFromArray<int32>(TensorShape({kUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kUpdates}), updates);
+  AddInputFromArray<int32>(TensorShape({1}), {kRows});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Check the output.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows}));
+  for (int i = 0; i < kRows; ++i) {
+    expected.flat<float>()(i) = 400.0f * i;
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 TEST_F(ScatterNdOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
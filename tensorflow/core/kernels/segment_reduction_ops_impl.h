@@ -51,8 +51,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -616,33 +619,17 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
-    // accumulation. We create a temp tensor to perform this accumulation for
-    // every segment.
-    Tensor temp;
-    if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
-      TensorShape temp_shape = output_shape;
-      OP_REQUIRES_OK(context, temp_shape.SetDimWithStatus(/*d=*/0, /*size=*/1));
-      temp = tensorflow::Tensor(DT_FLOAT, temp_shape);
-    }
-    auto temp_flat = temp.flat_outer_dims<float>();
-
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
+    // Validate the segment ids and find where each segment ends in one
+    // serial pass, so that the segments can then be reduced in parallel.
+    // segment_ends[s] is one past the last position of segment s in indices.
+    std::vector<int64_t> segment_ends;
+    std::vector<SegmentId> segment_rows;
+    SegmentId out_index = internal::SubtleMustCopy(segment_vec(0));
+    for (int64_t end = 1; end <= num_indices; ++end) {
       SegmentId next_index = 0;
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
+        if (out_index == next_index) continue;
         // We have a new segment here.  Verify that the segment ids are growing.
         OP_REQUIRES(context, out_index < next_index,
                     errors::InvalidArgument("segment ids are not increasing"));
@@ -653,42 +640,66 @@ class SparseSegmentReductionOpBase : public OpKernel {
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(0);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
+      segment_rows.push_back(out_index);
+      segment_ends.push_back(end);
       out_index = next_index;
-      if (end > num_indices) break;
     }
-
-    // Fill the gap at the end with the default value.
-    if (uninitialized_index < output_rows) {
-      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-          output_rows - uninitialized_index, num_col);
+    const int64_t num_segments = segment_rows.size();
+
+    // Sets the rows in [begin, end) of the output to the default value.
+    auto fill_gap = [&output_flat, num_col, this](SegmentId begin,
+                                                  SegmentId end) {
+      if (end <= begin) return;
+      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(end - begin,
+                                                          num_col);
       Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice(&output_flat(begin, 0), gap_slice_shape);
       gap_slice.setConstant(default_value_);
-    }
+    };
+
+    // Each segment is reduced by exactly one thread, in the same order as a
+    // serial reduction, so the result does not depend on the sharding.
+    mutex mu;
+    int64_t bad_index = num_indices;
+    auto reduce_segments = [&](int64_t first_segment, int64_t last_segment) {
+      // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
+      // accumulation. We create a temp tensor to perform this accumulation for
+      // every segment.
+      Tensor temp;
+      if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
+        temp = Tensor(DT_FLOAT, TensorShape({1, num_col}));
+      }
+      auto temp_flat = temp.flat_outer_dims<float>();
+      for (int64_t s = first_segment; s < last_segment; ++s) {
+        const int64_t start = s == 0 ? 0 : segment_ends[s - 1];
+        const int64_t num = segment_ends[s] - start;
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        fill_gap(s == 0 ? 0 : segment_rows[s - 1] + 1, segment_rows[s]);
+        auto out = output_flat.template chip<0>(segment_rows[s]);
+        auto temp_row = temp_flat.template chip<0>(0);
+        const int64_t bad_offset = Reduce<T, Index>(input_flat, indices_vec,
+                                                    start, num, out, temp_row);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_index = std::min(bad_index, start + bad_offset);
+          return;
+        }
+      }
+    };
+    const int64_t cost_per_segment =
+        (num_indices / num_segments + 1) * num_col * sizeof(T);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_index == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ", indices_vec(bad_index),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
+
+    // Fill the gap at the end with the default value.
+    fill_gap(segment_rows.back() + 1, output_rows);
   }
 
  private:
@@ -752,6 +763,29 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return res;
   }
 
+  // Prefetches the rows gathered by indices_vec[begin, end) while the previous
+  // group of rows is being reduced. Out of range indices are skipped here and
+  // reported when their group is reduced.
+  template <typename Tin, typename Tindex>
+  EIGEN_ALWAYS_INLINE void PrefetchRows(
+      const typename TTypes<Tin>::ConstMatrix& input_flat,
+      const typename TTypes<Tindex>::ConstVec& indices_vec, int64_t begin,
+      int64_t end) {
+    constexpr int64_t kCacheLineSize = 64;
+    // Embedding rows are typically a few cache lines long, and prefetching
+    // much more than that only evicts rows that are still needed.
+    const int64_t row_bytes = std::min<int64_t>(
+        input_flat.dimension(1) * sizeof(Tin), 4 * kCacheLineSize);
+    for (int64_t i = begin; i < end; ++i) {
+      const Tindex index = indices_vec(i);
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const char* row = reinterpret_cast<const char*>(&input_flat(index, 0));
+      for (int64_t offset = 0; offset < row_bytes; offset += kCacheLineSize) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+      }
+    }
+  }
+
   template <typename Tin, typename Tindex, typename Tout>
   int64_t ReduceImpl(
       const typename TTypes<Tin>::ConstMatrix& input_flat,
@@ -854,6 +888,8 @@ class SparseSegmentReductionOpBase : public OpKernel {
         }
       }
       for (; r < num; r += 8) {
+        PrefetchRows<Tin, Tindex>(input_flat, indices_vec, start + r + 8,
+                                  start + std::min(num, r + 16));
         INDEX(0, r);
         INDEX(1, r + 1);
         INDEX(2, r + 2);
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -290,4 +291,44 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+// Gathers kNumIndices random rows of a [kVocabSize, dim] embedding table and
+// sums them into segments of `ids_per_segment` rows each.
+static void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int ids_per_segment = state.range(1);
+  const int kVocabSize = 100000;
+  const int kNumIndices = 1 << 18;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({kVocabSize, dim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({kNumIndices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({kNumIndices}));
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices_flat(i) = random::New64() % kVocabSize;
+    segments_flat(i) = i / ids_per_segment;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          kNumIndices * dim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSum)
+    ->UseRealTime()
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 32)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 32);
+
 }  // namespace tensorflow
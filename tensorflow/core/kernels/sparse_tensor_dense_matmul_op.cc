@@ -19,12 +19,17 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
 #include "Eigen/Core"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -251,9 +256,96 @@ absl::Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
                                  "] out of bounds (>=", out_dim0, ")");
 }
 
+// Returns true if a product with `nnz` nonzeros and `rhs_right` output columns
+// is large enough to be split over the CPU worker threads by output row.
+bool UseRowBlockedImpl(OpKernelContext* ctx, int64_t nnz, int64_t rhs_right) {
+  // Below this many multiply-adds, bucketing the nonzeros by row costs more
+  // than the threads save.
+  static constexpr int64_t kMinRowBlockedWork = 1 << 16;
+  return nnz * rhs_right >= kMinRowBlockedWork &&
+         ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
+}
+
+// Computes the product like SparseTensorDenseMatMulImpl, but first buckets the
+// nonzeros of `a` by output row (converting them from COO to CSR order) and
+// then computes blocks of output rows in parallel. The nonzeros of each row
+// keep their relative order, so every output element accumulates its terms in
+// the same order as in the serial implementation.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+absl::Status SparseTensorDenseMatMulRowBlockedImpl(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const std::size_t nnz = a_values.size();
+  const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  const int64_t num_rows = out.dimension(0);
+
+  std::vector<Tindices> ms(nnz);
+  std::vector<Tindices> ks(nnz);
+  std::vector<int64_t> row_starts(num_rows + 1, 0);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    ms[i] = m;
+    ks[i] = k;
+    ++row_starts[m + 1];
+  }
+  std::partial_sum(row_starts.begin(), row_starts.end(), row_starts.begin());
+  // row_nnz[row_starts[m], row_starts[m + 1]) are the positions in `a` of the
+  // nonzeros of row `m`, in increasing order.
+  std::vector<int64_t> row_nnz(nnz);
+  {
+    std::vector<int64_t> next(row_starts.begin(), row_starts.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) row_nnz[next[ms[i]]++] = i;
+  }
+
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  const int64_t cost_per_row =
+      (static_cast<int64_t>(nnz) / num_rows + 1) * rhs_right * 2;
+  auto compute = [&](const auto& b_passed) {
+    constexpr int b_chip_index = ADJ_B ? 1 : 0;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, [&](int64_t begin, int64_t end) {
+            for (int64_t m = begin; m < end; ++m) {
+              if (row_starts[m] == row_starts[m + 1]) continue;
+              auto out_row = out.template chip<0>(m);
+              for (int64_t p = row_starts[m]; p < row_starts[m + 1]; ++p) {
+                const int64_t i = row_nnz[p];
+                const T a_value =
+                    ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+                out_row += b_passed.template chip<b_chip_index>(ks[i])
+                               .template cast<Tsum>() *
+                           static_cast<Tsum>(a_value);
+              }
+            }
+          });
+  };
+  if (ADJ_B) {
+    // Perform transpose and conjugation on B once, since we chip out B's
+    // columns in the nnz loop.
+    Eigen::array<int, 2> shuffle{1, 0};  // preserve dimension order
+    Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
+        b.swap_layout().shuffle(shuffle).conjugate();
+    compute(col_major_conj_b);
+  } else {
+    compute(b);
+  }
+  return absl::OkStatus();
+}
+
 template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
 absl::Status SparseTensorDenseMatMulImpl(
-    typename TTypes<Tsum>::Matrix out,
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
     typename TTypes<Tindices>::ConstMatrix a_indices,
     typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
   // Vectorize certain operations above this size.
@@ -265,9 +357,14 @@ absl::Status SparseTensorDenseMatMulImpl(
   const int lhs_index_a = ADJ_A ? 1 : 0;
   const int rhs_index_a = ADJ_A ? 0 : 1;
 
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
+  // Splitting the nonzeros among threads as they come would make threads
+  // contend on the same output rows, so large products are first bucketed by
+  // output row and then computed one block of rows per thread.
+  if (UseRowBlockedImpl(ctx, nnz, rhs_right)) {
+    return SparseTensorDenseMatMulRowBlockedImpl<T, Tsum, Tindices, ADJ_A,
+                                                 ADJ_B>(ctx, out, a_indices,
+                                                        a_values, b);
+  }
 
   if (rhs_right < kNumVectorize) {
     // Disable vectorization if the RHS of output is too small
@@ -341,7 +438,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+              ctx, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -351,7 +448,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
           SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+              ctx, out_workaround, a_indices, a_values, b));
     }
     return absl::OkStatus();
   }
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/spectrogram.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -70,47 +71,62 @@ class AudioSpectrogramOp : public OpKernel {
             &output_tensor));
     auto output_flat = output_tensor->flat<float>().data();
 
-    std::vector<float> input_for_channel(sample_count);
-    for (int64_t channel = 0; channel < channel_count; ++channel) {
-      OP_REQUIRES(context, spectrogram.Reset(),
-                  errors::InvalidArgument("Failed to Reset()"));
-
-      float* output_slice =
-          output_flat + (channel * output_height * output_width);
-      for (int i = 0; i < sample_count; ++i) {
-        input_for_channel[i] = input_as_matrix(i, channel);
-      }
-      std::vector<std::vector<float>> spectrogram_output;
-      OP_REQUIRES(context,
-                  spectrogram.ComputeSquaredMagnitudeSpectrogram(
-                      input_for_channel, &spectrogram_output),
-                  errors::InvalidArgument("Spectrogram compute failed"));
-      OP_REQUIRES(context, (spectrogram_output.size() == output_height),
-                  errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected height ",
-                      output_height, " but got ", spectrogram_output.size()));
-      OP_REQUIRES(context,
-                  spectrogram_output.empty() ||
-                      (spectrogram_output[0].size() == output_width),
+    // Channels are independent, so they are computed in parallel. Spectrogram
+    // is not thread-safe, hence each shard uses its own instance.
+    auto compute_channels = [&](int64_t start, int64_t limit) {
+      Spectrogram spectrogram;
+      OP_REQUIRES(context, spectrogram.Initialize(window_size_, stride_),
                   errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected width ",
-                      output_width, " but got ", spectrogram_output[0].size()));
-      for (int row_index = 0; row_index < output_height; ++row_index) {
-        const std::vector<float>& spectrogram_row =
-            spectrogram_output[row_index];
-        DCHECK_EQ(spectrogram_row.size(), output_width);
-        float* output_row = output_slice + (row_index * output_width);
-        if (magnitude_squared_) {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = spectrogram_row[i];
-          }
-        } else {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = sqrtf(spectrogram_row[i]);
+                      "Spectrogram initialization failed for window size ",
+                      window_size_, " and stride ", stride_));
+      std::vector<float> input_for_channel(sample_count);
+      for (int64_t channel = start; channel < limit; ++channel) {
+        OP_REQUIRES(context, spectrogram.Reset(),
+                    errors::InvalidArgument("Failed to Reset()"));
+
+        float* output_slice =
+            output_flat + (channel * output_height * output_width);
+        for (int i = 0; i < sample_count; ++i) {
+          input_for_channel[i] = input_as_matrix(i, channel);
+        }
+        std::vector<std::vector<float>> spectrogram_output;
+        OP_REQUIRES(context,
+                    spectrogram.ComputeSquaredMagnitudeSpectrogram(
+                        input_for_channel, &spectrogram_output),
+                    errors::InvalidArgument("Spectrogram compute failed"));
+        OP_REQUIRES(context, (spectrogram_output.size() == output_height),
+                    errors::InvalidArgument(
+                        "Spectrogram size calculation failed: Expected height ",
+                        output_height, " but got ", spectrogram_output.size()));
+        OP_REQUIRES(context,
+                    spectrogram_output.empty() ||
+                        (spectrogram_output[0].size() == output_width),
+                    errors::InvalidArgument(
+                        "Spectrogram size calculation failed: Expected width ",
+                        output_width, " but got ",
+                        spectrogram_output[0].size()));
+        for (int row_index = 0; row_index < output_height; ++row_index) {
+          const std::vector<float>& spectrogram_row =
+              spectrogram_output[row_index];
+          DCHECK_EQ(spectrogram_row.size(), output_width);
+          float* output_row = output_slice + (row_index * output_width);
+          if (magnitude_squared_) {
+            for (int i = 0; i < output_width; ++i) {
+              output_row[i] = spectrogram_row[i];
+            }
+          } else {
+            for (int i = 0; i < output_width; ++i) {
+              output_row[i] = sqrtf(spectrogram_row[i]);
+            }
           }
         }
       }
-    }
+    };
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    // Roughly one windowed FFT per output row.
+    const int64_t cost_per_channel = output_height * window_size_ * 20;
+    Shard(worker_threads->num_threads, worker_threads->workers, channel_count,
+          cost_per_channel, compute_channels);
   }
 
  private:
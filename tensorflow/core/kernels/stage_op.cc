@@ -99,7 +99,7 @@ class Buffer : public ResourceBase {
     // Update bytes in the Staging Area
     current_bytes_ -= GetTupleBytes(*tuple);
 
-    notify_inserters_if_bounded(&lock);
+    notify_inserters_if_bounded(&lock, /*removed_single_element=*/true);
   }
 
   // Return tuple at index
@@ -129,7 +129,7 @@ class Buffer : public ResourceBase {
     buf_.clear();
     current_bytes_ = 0;
 
-    notify_inserters_if_bounded(&lock);
+    notify_inserters_if_bounded(&lock, /*removed_single_element=*/false);
   }
 
   string DebugString() const override {
@@ -140,13 +140,22 @@ class Buffer : public ResourceBase {
  private:
   // If the buffer is configured for bounded capacity, notify
   // waiting inserters that space is now available
-  void notify_inserters_if_bounded(std::unique_lock<std::mutex>* lock) {
+  void notify_inserters_if_bounded(std::unique_lock<std::mutex>* lock,
+                                   bool removed_single_element) {
     if (IsBounded()) {
       lock->unlock();
-      // Notify all inserters. The removal of an element
-      // may make memory available for many inserters
-      // to insert new elements
-      full_cond_var_.notify_all();
+      if (removed_single_element && memory_limit_ == 0) {
+        // Only the number of elements is bounded, so the removal of a
+        // single element makes room for exactly one inserter. Waking
+        // all of them would only make the others contend for the lock
+        // and go back to sleep.
+        full_cond_var_.notify_one();
+      } else {
+        // Notify all inserters. The removal of an element
+        // may make memory available for many inserters
+        // to insert new elements
+        full_cond_var_.notify_all();
+      }
     }
   }
 
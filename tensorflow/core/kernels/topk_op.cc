@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <vector>
 
@@ -161,6 +162,21 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return absl::OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // Rows much longer than k are split across the threads when there are too
+    // few rows to keep them busy.
+    if (k < num_cols && num_rows < worker_threads.num_threads) {
+      const int64_t chunk_cols =
+          std::max<int64_t>(kMinColsPerChunk, 4 * static_cast<int64_t>(k));
+      const int64_t num_chunks = (num_cols + chunk_cols - 1) / chunk_cols;
+      if (num_chunks > 1) {
+        ComputeSplitRows(worker_threads, sorted, k, input, num_rows, num_cols,
+                         chunk_cols, num_chunks, values, indices);
+        return absl::OkStatus();
+      }
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -247,12 +263,92 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return absl::OkStatus();
   }
+
+ private:
+  // Minimum number of columns of a row given to one thread.
+  static constexpr int64_t kMinColsPerChunk = 1 << 15;
+
+  // Orders by decreasing value, then by increasing index, which makes the
+  // top k of a row unique.
+  struct StableComp {
+    const T* input_data;
+    bool operator()(const Tidx a, const Tidx b) const {
+      if (input_data[b] < input_data[a]) {
+        return true;
+      } else if (input_data[b] > input_data[a]) {
+        return false;
+      } else {
+        return a < b;
+      }
+    }
+  };
+
+  // Computes the top k of each row by splitting the row into `num_chunks`
+  // chunks of `chunk_cols` columns. Each chunk selects its own top k on a
+  // worker thread, and since StableComp is a total order, the top k of the row
+  // is the top k of the union of these candidates.
+  static void ComputeSplitRows(
+      const DeviceBase::CpuWorkerThreads& worker_threads, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t chunk_cols,
+      const int64_t num_chunks, typename TTypes<T, 2>::Tensor values,
+      typename TTypes<Tidx, 2>::Tensor indices) {
+    std::vector<Tidx> candidates(num_rows * num_chunks * k);
+    std::vector<int64_t> num_candidates(num_rows * num_chunks);
+    auto select_chunk = [&](int64_t start, int64_t limit) {
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / num_chunks;
+        const int64_t begin = (unit % num_chunks) * chunk_cols;
+        const int64_t end = std::min(begin + chunk_cols, num_cols);
+        gtl::TopN<Tidx, StableComp> filter(k, StableComp{&input(b, 0)});
+        for (int64_t c = begin; c < end; ++c) {
+          filter.push(static_cast<Tidx>(c));
+        }
+        int64_t i = 0;
+        for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+             ++it, ++i) {
+          candidates[unit * k + i] = *it;
+        }
+        num_candidates[unit] = i;
+      }
+    };
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_chunks, static_cast<int64_t>(cmp_cost * chunk_cols),
+          select_chunk);
+
+    auto merge_row = [&](int64_t start, int64_t limit) {
+      for (int64_t b = start; b < limit; ++b) {
+        gtl::TopN<Tidx, StableComp> filter(k, StableComp{&input(b, 0)});
+        for (int64_t unit = b * num_chunks; unit < (b + 1) * num_chunks;
+             ++unit) {
+          for (int64_t i = 0; i < num_candidates[unit]; ++i) {
+            filter.push(candidates[unit * k + i]);
+          }
+        }
+        int64_t i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
+          for (const Tidx c : *top_k) indices(b, i++) = c;
+        } else {
+          for (auto it = filter.unsorted_begin(); it != filter.unsorted_end();
+               ++it) {
+            indices(b, i++) = *it;
+          }
+        }
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          static_cast<int64_t>(cmp_cost * num_chunks * k), merge_row);
+  }
 };
 
 }  // namespace functor
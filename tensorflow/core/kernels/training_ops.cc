@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -40,6 +42,48 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// Calls `update(i, index)` for every offset `i` of `indices`, where `index` is
+// `indices(i)`, on the worker threads of `d`. All the offsets holding the same
+// index are handled by one thread in increasing order, so duplicate indices
+// apply their updates one after the other instead of racing on the row, and
+// rows are visited in address order. Returns an error without updating
+// anything if an index is not in [0, first_dim_size).
+template <typename Tindex, typename Update>
+absl::Status ParallelForEachIndex(const CPUDevice& d,
+                                  typename TTypes<Tindex>::ConstVec indices,
+                                  Tindex first_dim_size,
+                                  const Eigen::TensorOpCost& cost,
+                                  Update update) {
+  const Tindex N = static_cast<Tindex>(indices.dimension(0));
+  std::vector<std::pair<Tindex, Tindex>> rows(N);
+  for (Tindex i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    rows[i] = {index, i};
+  }
+  if (!std::is_sorted(rows.begin(), rows.end())) {
+    std::sort(rows.begin(), rows.end());
+  }
+  auto shard = [&](Tindex begin, Tindex end) {
+    // A row belongs to the shard holding its first update.
+    while (begin > 0 && begin < N &&
+           rows[begin].first == rows[begin - 1].first) {
+      ++begin;
+    }
+    while (end < N && rows[end].first == rows[end - 1].first) {
+      ++end;
+    }
+    for (Tindex k = begin; k < end; ++k) {
+      update(rows[k].second, rows[k].first);
+    }
+  };
+  d.parallelFor(N, cost, shard);
+  return absl::OkStatus();
+}
 }  // namespace
 
 namespace functor {
@@ -182,63 +226,37 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
     const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
 
     if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
-
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
-          auto a = accum.template chip<0>(index);
-          auto g = grad.template chip<0>(i);
-          auto v = var.template chip<0>(index);
-          if (update_slots) {
-            a += g.square();
-          }
-          if (has_epsilon) {
-            v -= g.constant(lr_scalar) * g / (a.sqrt() + a.constant(epsilon()));
-          } else {
-            v -= g.constant(lr_scalar) * g * a.rsqrt();
-          }
-        }
-      };
-
-      d.parallelFor(N, cost, shard);
+      return ParallelForEachIndex<Tindex>(
+          d, indices, first_dim_size, cost, [&](Tindex i, Tindex index) {
+            auto a = accum.template chip<0>(index);
+            auto g = grad.template chip<0>(i);
+            auto v = var.template chip<0>(index);
+            if (update_slots) {
+              a += g.square();
+            }
+            if (has_epsilon) {
+              v -= g.constant(lr_scalar) * g /
+                   (a.sqrt() + a.constant(epsilon()));
+            } else {
+              v -= g.constant(lr_scalar) * g * a.rsqrt();
+            }
+          });
     } else {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
-
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
-          T& a = accum(index);
-          const T& g = grad(i);
-          if (update_slots) {
-            a += g * g;
-          }
-          if (has_epsilon) {
-            var(index) -= lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon());
-          } else {
-            var(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
-          }
-        }
-      };
-
-      d.parallelFor(N, cost, shard);
+      return ParallelForEachIndex<Tindex>(
+          d, indices, first_dim_size, cost, [&](Tindex i, Tindex index) {
+            T& a = accum(index);
+            const T& g = grad(i);
+            if (update_slots) {
+              a += g * g;
+            }
+            if (has_epsilon) {
+              var(index) -=
+                  lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon());
+            } else {
+              var(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
+            }
+          });
     }
-
-    return absl::OkStatus();
   }
 };
 
@@ -286,59 +304,54 @@ struct SparseApplyProximalAdagrad<CPUDevice, T, Tindex> {
     const T lr_scalar = lr();
     const T l1_scalar = l1();
     const T l2_scalar = l2();
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/inner_dim * sizeof(T) * 3,
+        /*bytes_stored=*/inner_dim * sizeof(T) * 2,
+        /*compute_cycles=*/inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 4 +
+                                        Eigen::TensorOpCost::MulCost<T>() * 6));
     if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; i++) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-        auto a = accum.template chip<0>(index);
-        auto g = grad.template chip<0>(i);
-        auto v = var.template chip<0>(index);
-        a += g.square();
-        // compute learning_rate for current step.
-        auto learning_rate = a.constant(lr_scalar) * a.rsqrt();
-        auto prox_v = v;
-        // v = w - g * learning_rate.
-        prox_v -= g * learning_rate;
-        if (l1_scalar > 0) {
-          // compute sign(v) * max(|v|, 0)
-          v = prox_v.sign() *
-              (prox_v.abs() - learning_rate * prox_v.constant(l1_scalar))
-                  .cwiseMax(static_cast<T>(0.0)) /
-              (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
-        } else {
-          v = prox_v /
-              (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
-        }
-      }
+      return ParallelForEachIndex<Tindex>(
+          d, indices, first_dim_size, cost, [&](Tindex i, Tindex index) {
+            auto a = accum.template chip<0>(index);
+            auto g = grad.template chip<0>(i);
+            auto v = var.template chip<0>(index);
+            a += g.square();
+            // compute learning_rate for current step.
+            auto learning_rate = a.constant(lr_scalar) * a.rsqrt();
+            auto prox_v = v;
+            // v = w - g * learning_rate.
+            prox_v -= g * learning_rate;
+            if (l1_scalar > 0) {
+              // compute sign(v) * max(|v|, 0)
+              v = prox_v.sign() *
+                  (prox_v.abs() - learning_rate * prox_v.constant(l1_scalar))
+                      .cwiseMax(static_cast<T>(0.0)) /
+                  (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
+            } else {
+              v = prox_v /
+                  (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
+            }
+          });
     } else {
-      for (Tindex i = 0; i < N; i++) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-        T& a = accum(index);
-        const T& g = grad(i);
-        a += g * g;
-        auto learning_rate = lr_scalar / std::sqrt(a);
-        auto prox_v = var(index);
-        prox_v -= learning_rate * g;
-        if (l1_scalar > 0) {
-          var(index) = sgn(prox_v) *
-                       std::max(std::abs(prox_v) - learning_rate * l1_scalar,
-                                static_cast<T>(0.0)) /
-                       (1.0 + l2_scalar * learning_rate);
-        } else {
-          var(index) = prox_v / (1.0 + l2_scalar * learning_rate);
-        }
-      }
+      return ParallelForEachIndex<Tindex>(
+          d, indices, first_dim_size, cost, [&](Tindex i, Tindex index) {
+            T& a = accum(index);
+            const T& g = grad(i);
+            a += g * g;
+            auto learning_rate = lr_scalar / std::sqrt(a);
+            auto prox_v = var(index);
+            prox_v -= learning_rate * g;
+            if (l1_scalar > 0) {
+              var(index) =
+                  sgn(prox_v) *
+                  std::max(std::abs(prox_v) - learning_rate * l1_scalar,
+                           static_cast<T>(0.0)) /
+                  (1.0 + l2_scalar * learning_rate);
+            } else {
+              var(index) = prox_v / (1.0 + l2_scalar * learning_rate);
+            }
+          });
     }
-    return absl::OkStatus();
   }
 };
 
@@ -609,75 +622,75 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
         l2_shrinkage_scalar = l2_shrinkage();
       }
       T lr_power_scalar = lr_power();
+      const Eigen::TensorOpCost cost(
+          /*bytes_loaded=*/inner_dim * sizeof(T) * 4,
+          /*bytes_stored=*/inner_dim * sizeof(T) * 3,
+          /*compute_cycles=*/inner_dim *
+              (Eigen::TensorOpCost::AddCost<T>() * 8 +
+               Eigen::TensorOpCost::MulCost<T>() * 8 +
+               Eigen::TensorOpCost::DivCost<T>() * 2));
       if (inner_dim > 1) {
         const Tindex first_dim_size =
             static_cast<Tindex>(var_flat.dimension(0));
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
-          auto accum = accum_flat.template chip<0>(index);
-          auto linear = linear_flat.template chip<0>(index);
-          auto grad = grad_flat.template chip<0>(i);
-          auto var = var_flat.template chip<0>(index);
-
-          if (has_l2_shrinkage) {
-            auto grad_with_shrinkage =
-                grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
-            ComputeFtrl(/*grad=*/grad,
-                        /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
-          } else {
-            ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
-          }
-        }
+        return ParallelForEachIndex<Tindex>(
+            d, indices_vec, first_dim_size, cost, [&](Tindex i, Tindex index) {
+              auto accum = accum_flat.template chip<0>(index);
+              auto linear = linear_flat.template chip<0>(index);
+              auto grad = grad_flat.template chip<0>(i);
+              auto var = var_flat.template chip<0>(index);
+
+              if (has_l2_shrinkage) {
+                auto grad_with_shrinkage =
+                    grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
+                ComputeFtrl(/*grad=*/grad,
+                            /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              } else {
+                ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              }
+            });
       } else {
         const Tindex first_dim_size = accum_flat.size();
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
-          T& a = accum_flat(index);
-          T& l = linear_flat(index);
-          T& v = var_flat(index);
-          T g;
-          if (has_l2_shrinkage) {
-            g = grad_flat(i) +
-                (static_cast<T>(2) * l2_shrinkage_scalar * var_flat(index));
-          } else {
-            g = grad_flat(i);
-          }
-
-          T updated_a = a + grad_flat(i) * grad_flat(i);
-          using Eigen::numext::pow;
-          T sigma = pow(updated_a, -lr_power_scalar) - pow(a, -lr_power_scalar);
-          if (!multiply_linear_by_lr) {
-            sigma /= lr_scalar;
-          }
-          T updated_l = (multiply_linear_by_lr ? l + g * lr_scalar - sigma * v
-                                               : l + g - sigma * v);
-          v = FtrlCompute(updated_a, updated_l, lr_scalar, l1_scalar, l2_scalar,
-                          lr_power_scalar, multiply_linear_by_lr);
-          a = updated_a;
-          l = updated_l;
-        }
+        return ParallelForEachIndex<Tindex>(
+            d, indices_vec, first_dim_size, cost, [&](Tindex i, Tindex index) {
+              T& a = accum_flat(index);
+              T& l = linear_flat(index);
+              T& v = var_flat(index);
+              T g;
+              if (has_l2_shrinkage) {
+                g = grad_flat(i) +
+                    (static_cast<T>(2) * l2_shrinkage_scalar * var_flat(index));
+              } else {
+                g = grad_flat(i);
+              }
+
+              T updated_a = a + grad_flat(i) * grad_flat(i);
+              using Eigen::numext::pow;
+              T sigma =
+                  pow(updated_a, -lr_power_scalar) - pow(a, -lr_power_scalar);
+              if (!multiply_linear_by_lr) {
+                sigma /= lr_scalar;
+              }
+              T updated_l =
+                  (multiply_linear_by_lr ? l + g * lr_scalar - sigma * v
+                                         : l + g - sigma * v);
+              v = FtrlCompute(updated_a, updated_l, lr_scalar, l1_scalar,
+                              l2_scalar, lr_power_scalar,
+                              multiply_linear_by_lr);
+              a = updated_a;
+              l = updated_l;
+            });
       }
     }
     return absl::OkStatus();
@@ -199,6 +199,56 @@ BENCHMARK(BM_SparseAdagrad)
     ->ArgPair(128, 32 << 10)
     ->ArgPair(128, 128 << 10);
 
+static void SparseFtrl(int32_t m, int32_t n, Graph** init_g,
+                       Graph** train_g) {
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, m, n);
+    auto accum = Var(g, m, n);
+    auto linear = Var(g, m, n);
+    auto zero = Zeros(g, m, n);
+    test::graph::Assign(g, var, zero);
+    test::graph::Assign(g, accum, zero);
+    test::graph::Assign(g, linear, zero);
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, m, n);
+    auto accum = Var(g, m, n);
+    auto linear = Var(g, m, n);
+    auto grad = Random(g, m, n);
+    auto indices = Iota(g, m);
+    auto lr = Scalar(g, 0.01);
+    auto l1 = Scalar(g, 0.001);
+    auto l2 = Scalar(g, 0.001);
+    auto lr_power = Scalar(g, -0.5);
+    test::graph::Multi(g, "SparseApplyFtrl",
+                       {var, accum, linear, grad, indices, lr, l1, l2,
+                        lr_power});
+    *train_g = g;
+  }
+}
+static void BM_SparseFtrl(::testing::benchmark::State& state) {
+  const int m = state.range(0);
+  const int n = state.range(1);
+
+  Graph* init;
+  Graph* train;
+  SparseFtrl(m, n, &init, &train);
+  test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * m * n;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_SparseFtrl)
+    ->UseRealTime()
+    ->ArgPair(128, 1 << 10)
+    ->ArgPair(128, 8 << 10)
+    ->ArgPair(128, 128 << 10);
+
 static void Momentum(int32_t n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -68,12 +70,114 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes `in` tile by tile if the permutation moves the innermost
+// dimension, after merging dimensions that stay adjacent. Returns false,
+// without touching `out`, if the permutation keeps the innermost dimension in
+// place and the inner loop of the shuffle is already a contiguous copy.
+//
+// Each tile spans `kTile` elements of the innermost input dimension `a` and
+// `kTile` elements of the dimension `b` that becomes innermost in the output,
+// so that all the cache lines it reads and writes stay resident while it is
+// copied. The rest of the dimensions and the tiles of `b` are distributed over
+// the worker threads.
+template <typename T>
+bool TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const absl::Span<const int32> perm, Tensor* out) {
+  if (in.dims() < 2) return false;
+  internal::TransposePermsVec out_positions;
+  internal::TransposeDimsVec new_dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &out_positions,
+                                      &new_dims);
+  // ReduceTransposeDimensions returns the output position of each merged
+  // input dimension; invert it to get the merged permutation.
+  const int ndims = out_positions.size();
+  internal::TransposePermsVec new_perm(ndims);
+  for (int i = 0; i < ndims; ++i) new_perm[out_positions[i]] = i;
+  if (ndims < 2 || new_perm[ndims - 1] == ndims - 1) return false;
+
+  // Strides of the merged input dimensions in the input and in the output.
+  absl::InlinedVector<int64_t, 8UL> in_strides(ndims);
+  absl::InlinedVector<int64_t, 8UL> out_strides(ndims);
+  int64_t stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = stride;
+    stride *= new_dims[i];
+  }
+  stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_strides[new_perm[i]] = stride;
+    stride *= new_dims[new_perm[i]];
+  }
+
+  const int a = ndims - 1;
+  const int b = new_perm[ndims - 1];
+  const int64_t size_a = new_dims[a];
+  const int64_t size_b = new_dims[b];
+  const int64_t in_stride_b = in_strides[b];
+  const int64_t out_stride_a = out_strides[a];
+
+  // A tile row of 64 bytes fills one cache line.
+  constexpr int64_t kTile = std::max<int64_t>(64 / sizeof(T), 4);
+  const int64_t num_b_tiles = (size_b + kTile - 1) / kTile;
+
+  absl::InlinedVector<int64_t, 8UL> outer_dims;
+  absl::InlinedVector<int64_t, 8UL> outer_in_strides;
+  absl::InlinedVector<int64_t, 8UL> outer_out_strides;
+  int64_t num_outer = 1;
+  for (int i = 0; i < ndims; ++i) {
+    if (i == a || i == b) continue;
+    outer_dims.push_back(new_dims[i]);
+    outer_in_strides.push_back(in_strides[i]);
+    outer_out_strides.push_back(out_strides[i]);
+    num_outer *= new_dims[i];
+  }
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  auto transpose_fn = [&, p, q](int64_t begin, int64_t end) {
+    for (int64_t unit = begin; unit < end; ++unit) {
+      int64_t outer = unit / num_b_tiles;
+      const int64_t b_begin = (unit - outer * num_b_tiles) * kTile;
+      const int64_t b_end = std::min(b_begin + kTile, size_b);
+      int64_t in_base = 0;
+      int64_t out_base = 0;
+      for (int i = static_cast<int>(outer_dims.size()) - 1; i >= 0; --i) {
+        const int64_t index = outer % outer_dims[i];
+        outer /= outer_dims[i];
+        in_base += index * outer_in_strides[i];
+        out_base += index * outer_out_strides[i];
+      }
+      for (int64_t a_begin = 0; a_begin < size_a; a_begin += kTile) {
+        const int64_t a_end = std::min(a_begin + kTile, size_a);
+        for (int64_t i = a_begin; i < a_end; ++i) {
+          const T* src = p + in_base + i + b_begin * in_stride_b;
+          T* dst = q + out_base + i * out_stride_a + b_begin;
+          for (int64_t j = 0; j < b_end - b_begin; ++j) {
+            dst[j] = src[j * in_stride_b];
+          }
+        }
+      }
+    }
+  };
+  const double bytes_per_unit = kTile * size_a * sizeof(T);
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/bytes_per_unit,
+                           /*bytes_stored=*/bytes_per_unit,
+                           /*compute_cycles=*/kTile * size_a);
+  device.parallelFor(num_outer * num_b_tiles, cost, std::move(transpose_fn));
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const absl::Span<const int32> perm, Tensor* out) {
+    // DoTransposeImpl maps every plain numeric type onto an unsigned integer
+    // type of the same size.
+    if constexpr (!conjugate && std::is_unsigned_v<T>) {
+      if (TransposeTiled<T>(d, in, perm, out)) return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
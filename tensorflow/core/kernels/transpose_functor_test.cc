@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class TransposeFunctorTest : public ::testing::Test {
+ protected:
+  TransposeFunctorTest() : pool_(4), device_(&pool_, 4) {}
+
+  // Compares DoTranspose against an element by element transpose.
+  template <typename T>
+  void TestTranspose(const TensorShape& shape, const std::vector<int32>& perm) {
+    Tensor in(DataTypeToEnum<T>::value, shape);
+    auto in_flat = in.flat<T>();
+    for (int64_t i = 0; i < in.NumElements(); ++i) {
+      in_flat(i) = static_cast<T>(i % 101);
+    }
+    TensorShape out_shape;
+    for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+    Tensor out(DataTypeToEnum<T>::value, out_shape);
+    TF_ASSERT_OK(DoTranspose(device_, in, perm, &out));
+
+    Tensor expected(DataTypeToEnum<T>::value, out_shape);
+    auto expected_flat = expected.flat<T>();
+    const int ndims = shape.dims();
+    std::vector<int64_t> index(ndims, 0);
+    for (int64_t o = 0; o < out.NumElements(); ++o) {
+      int64_t t = o;
+      for (int i = ndims - 1; i >= 0; --i) {
+        index[perm[i]] = t % out_shape.dim_size(i);
+        t /= out_shape.dim_size(i);
+      }
+      int64_t in_index = 0;
+      for (int i = 0; i < ndims; ++i) {
+        in_index = in_index * shape.dim_size(i) + index[i];
+      }
+      expected_flat(o) = in_flat(in_index);
+    }
+    test::ExpectTensorEqual<T>(expected, out);
+  }
+
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+TEST_F(TransposeFunctorTest, MatrixTranspose) {
+  TestTranspose<float>({67, 131}, {1, 0});
+  TestTranspose<int8>({67, 131}, {1, 0});
+  TestTranspose<Eigen::half>({3, 200}, {1, 0});
+  TestTranspose<double>({200, 3}, {1, 0});
+}
+
+TEST_F(TransposeFunctorTest, LayoutConversion) {
+  // NHWC -> NCHW and NCHW -> NHWC.
+  TestTranspose<float>({2, 9, 11, 3}, {0, 3, 1, 2});
+  TestTranspose<float>({2, 3, 9, 11}, {0, 2, 3, 1});
+  TestTranspose<uint8>({2, 17, 5, 40}, {0, 3, 1, 2});
+  TestTranspose<int16>({2, 40, 17, 5}, {0, 2, 3, 1});
+}
+
+TEST_F(TransposeFunctorTest, GeneralPermutation) {
+  TestTranspose<float>({4, 5, 6, 7, 8}, {3, 1, 4, 0, 2});
+  TestTranspose<int32>({4, 5, 6, 7, 8}, {1, 3, 0, 4, 2});
+  TestTranspose<int8>({3, 4, 5, 6, 7, 2, 2, 3, 2},
+                      {8, 6, 7, 0, 5, 1, 3, 2, 4});
+}
+
+TEST_F(TransposeFunctorTest, InnerDimensionKept) {
+  TestTranspose<float>({5, 6, 7}, {1, 0, 2});
+  TestTranspose<float>({5, 6, 7, 8}, {2, 0, 1, 3});
+}
+
+TEST_F(TransposeFunctorTest, EmptyTensor) {
+  TestTranspose<float>({0, 5, 6}, {2, 0, 1});
+  TestTranspose<float>({5, 0}, {1, 0});
+}
+
+}  // namespace
+}  // namespace tensorflow
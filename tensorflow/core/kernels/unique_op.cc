@@ -13,9 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <numeric>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +74,127 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with fewer elements than this are deduplicated on the calling thread,
+// because the extra passes made by `ParallelUnique` do not pay off for them.
+constexpr int64_t kParallelUniqueMinSize = 1 << 17;
+
+// Returns true if the unique elements of a vector of `n` elements of type `T`
+// should be computed by `ParallelUnique`. Floating-point types are excluded
+// because every `NaN` is a distinct element, so it can not be looked up again
+// once it has been inserted.
+template <typename T>
+bool UseParallelUnique(OpKernelContext* context, int64_t n) {
+  return std::is_integral<T>::value && n >= kParallelUniqueMinSize &&
+         context->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
+}
+
+// Computes the unique elements of the vector `input` with the CPU worker
+// threads. The outputs are the same as those of the serial implementation,
+// with unique elements ordered by their first occurrence in `input`.
+//
+// The input is split into one contiguous block per thread, and the elements
+// are split into as many partitions by hash:
+//
+// 1. Each block records the first position in it of each of its elements in
+//    one map per partition.
+// 2. Each partition merges the maps of all blocks in block order, which finds
+//    the first position of each of its elements in `input`.
+// 3. A prefix sum over the first positions of each block assigns each unique
+//    element its index in the output.
+// 4. Each block looks up the output index of each of its elements.
+template <typename T, typename TIndex>
+absl::Status ParallelUnique(OpKernelContext* context, const Tensor& input,
+                            int64_t axis, typename TTypes<TIndex>::Vec idx_vec,
+                            int64_t* uniq_size) {
+  using Map = typename UniqueOpHashMap<T, int64_t>::map_type;
+  using Key = typename Map::key_type;
+  auto Tin = input.flat<T>();
+  const int64_t N = static_cast<int64_t>(Tin.size());
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int num_blocks = worker_threads.num_threads;
+  const int num_partitions = worker_threads.num_threads;
+  const int64_t block_size = (N + num_blocks - 1) / num_blocks;
+
+  // Runs `fn(i)` for every `i` in [0, n), where each call touches about one
+  // block worth of elements.
+  auto parallel_for = [&](int64_t n, const std::function<void(int64_t)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, n,
+          /*cost_per_unit=*/block_size * 50, [&fn](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) fn(i);
+          });
+  };
+  // The partition hash is mixed, so that the elements of a partition are still
+  // spread over all the buckets of its map.
+  auto partition_of = [num_partitions](const Key& key) {
+    const uint64_t h = static_cast<uint64_t>(std::hash<Key>{}(key));
+    return static_cast<int>(((h * 0x9E3779B97F4A7C15ull) >> 32) %
+                            num_partitions);
+  };
+
+  // block_maps[b * num_partitions + p] maps each element of partition `p` in
+  // block `b` to its first position.
+  std::vector<Map> block_maps(num_blocks * num_partitions);
+  parallel_for(num_blocks, [&](int64_t b) {
+    Map* maps = &block_maps[b * num_partitions];
+    const int64_t end = std::min(N, (b + 1) * block_size);
+    for (int64_t i = b * block_size; i < end; ++i) {
+      const Key key(Tin(i));
+      maps[partition_of(key)].emplace(key, i);
+    }
+  });
+
+  std::vector<Map> partition_maps(num_partitions);
+  std::vector<uint8_t> is_first(N, 0);
+  parallel_for(num_partitions, [&](int64_t p) {
+    Map& map = partition_maps[p];
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      Map& block_map = block_maps[b * num_partitions + p];
+      for (const auto& it : block_map) {
+        if (map.emplace(it.first, it.second).second) is_first[it.second] = 1;
+      }
+      Map().swap(block_map);
+    }
+  });
+
+  // Temporarily store the index of each first occurrence among those of its
+  // block in `idx_vec`.
+  std::vector<int64_t> block_offsets(num_blocks + 1, 0);
+  parallel_for(num_blocks, [&](int64_t b) {
+    const int64_t end = std::min(N, (b + 1) * block_size);
+    int64_t count = 0;
+    for (int64_t i = b * block_size; i < end; ++i) {
+      if (is_first[i]) idx_vec(i) = count++;
+    }
+    block_offsets[b + 1] = count;
+  });
+  std::partial_sum(block_offsets.begin(), block_offsets.end(),
+                   block_offsets.begin());
+  *uniq_size = block_offsets[num_blocks];
+  parallel_for(num_partitions, [&](int64_t p) {
+    for (auto& it : partition_maps[p]) {
+      const int64_t first = it.second;
+      it.second = block_offsets[first / block_size] + idx_vec(first);
+    }
+  });
+
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, *uniq_size);
+  Tensor* output = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  parallel_for(num_blocks, [&](int64_t b) {
+    const int64_t end = std::min(N, (b + 1) * block_size);
+    for (int64_t i = b * block_size; i < end; ++i) {
+      const Key key(Tin(i));
+      const int64_t index = partition_maps[partition_of(key)].find(key)->second;
+      idx_vec(i) = index;
+      if (is_first[i]) Tout(index) = Tin(i);
+    }
+  });
+  return absl::OkStatus();
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -143,7 +270,11 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        UseParallelUnique<T>(context, new_sizes[1])) {
+      OP_REQUIRES_OK(context, ParallelUnique<T, TIndex>(context, input, axis,
+                                                        idx_vec, &uniq_size));
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
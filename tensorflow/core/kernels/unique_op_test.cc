@@ -15,10 +15,15 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -37,6 +42,41 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large enough to take the parallel path when there are several CPU threads.
+TEST_F(UniqueOpTest, LargeInputKeepsFirstOccurrenceOrder) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const int kSize = 1 << 18;
+  std::vector<int64_t> x(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = (static_cast<int64_t>(i) * 7919) % 10007 - 5000;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kSize}), x);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int64_t, int32> index_of;
+  std::vector<int64_t> y;
+  std::vector<int32> idx;
+  std::vector<int32> count;
+  for (int64_t value : x) {
+    auto it = index_of.emplace(value, y.size());
+    if (it.second) {
+      y.push_back(value);
+      count.push_back(0);
+    }
+    idx.push_back(it.first->second);
+    ++count[it.first->second];
+  }
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0), test::AsTensor<int64_t>(y));
+  test::ExpectTensorEqual<int32>(*GetOutput(1), test::AsTensor<int32>(idx));
+  test::ExpectTensorEqual<int32>(*GetOutput(2), test::AsTensor<int32>(count));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_WEIGHTS_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_WEIGHTS_CACHE_H_
+
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Caches a tensor derived from the constant weights operand of a kernel, e.g.
+// a reordered filter or a float copy of bfloat16 weights, so the derivation
+// does not have to be repeated every step.
+//
+// Grappler's remapper sets the `_grappler_const_weights` attribute on nodes
+// whose weights are produced by a Const node. The cached value is tied to the
+// buffer of the weights: the cache keeps a reference to that buffer, so it can
+// not be freed and reused for other data while the entry is alive, and any
+// other buffer (e.g. a fed value) replaces the entry. The cached value is
+// allocated by the kernel's allocator and is released with the kernel.
+class WeightsCache {
+ public:
+  // Returns true if the weights of the kernel being constructed are known to
+  // be constant.
+  static bool WeightsAreConstant(OpKernelConstruction* context) {
+    bool const_weights = false;
+    if (!context->GetAttr("_grappler_const_weights", &const_weights).ok()) {
+      return false;
+    }
+    return const_weights;
+  }
+
+  // Sets `*value` to the cached value for `weights`, calling `compute` to
+  // derive it from `weights` if it is not cached yet.
+  absl::Status GetOrCompute(
+      const Tensor& weights,
+      absl::FunctionRef<absl::Status(const Tensor&, Tensor*)> compute,
+      Tensor* value) {
+    {
+      tf_shared_lock l(mu_);
+      if (Matches(weights)) {
+        *value = value_;
+        return absl::OkStatus();
+      }
+    }
+    // Compute outside of the lock; concurrent misses only do redundant work.
+    TF_RETURN_IF_ERROR(compute(weights, value));
+    mutex_lock l(mu_);
+    weights_ = weights;
+    value_ = *value;
+    return absl::OkStatus();
+  }
+
+ private:
+  bool Matches(const Tensor& weights) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return weights_.IsInitialized() && weights_.dtype() == weights.dtype() &&
+           weights_.shape() == weights.shape() &&
+           weights_.data() == weights.data();
+  }
+
+  mutable mutex mu_;
+  Tensor weights_ TF_GUARDED_BY(mu_);
+  Tensor value_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_WEIGHTS_CACHE_H_
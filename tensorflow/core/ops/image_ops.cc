@@ -528,6 +528,55 @@ REGISTER_OP("DecodeAndCropJpeg")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &contents));
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels < 0) {
+        return errors::InvalidArgument("channels must be non-negative, got ",
+                                       channels);
+      }
+      DimensionHandle channels_dim =
+          channels == 0 ? c->UnknownDim() : c->MakeDim(channels);
+
+      ShapeHandle crop_window;
+      DimensionHandle unused_dim;
+      if (!c->RankKnown(contents)) {
+        TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(1), 2, &crop_window));
+        c->set_output(0, c->UnknownShape());
+        return absl::OkStatus();
+      }
+      const bool batched = c->Rank(contents) == 1;
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(1), batched ? 2 : 1, &crop_window));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(crop_window, batched ? 1 : 0),
+                                      4, &unused_dim));
+      DimensionHandle batch_dim = c->UnknownDim();
+      if (batched) {
+        TF_RETURN_IF_ERROR(c->Merge(c->Dim(contents, 0),
+                                    c->Dim(crop_window, 0), &batch_dim));
+      }
+      TF_RETURN_IF_ERROR(SetOutputToSizedImage(c, batch_dim,
+                                               2 /* size_input_idx */,
+                                               channels_dim));
+      if (!batched) {
+        ShapeHandle image;
+        TF_RETURN_IF_ERROR(c->Subshape(c->output(0), 1, &image));
+        c->set_output(0, image);
+      }
+      return absl::OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -483,6 +483,19 @@ REGISTER_OP("AnonymousMutableDenseHashTable")
     .SetIsStateful()
     .SetShapeFn(MutableDenseHashTableShapeFn);
 
+REGISTER_OP("BoundedMutableHashTable")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .Attr("value_shape: shape = {}")
+    .Attr("max_size: int >= 1")
+    .Attr("admission_threshold: int >= 1 = 1")
+    .SetIsStateful()
+    .SetShapeFn(MutableHashTableOfTensorsShapeFn);
+
 REGISTER_OP("InitializeTable")
     .Input("table_handle: Ref(string)")
     .Input("keys: Tkey")
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTION_OPTIONS_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTION_OPTIONS_H_
 
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <ostream>
@@ -100,6 +101,21 @@ struct GraphExecutionOptions {
 
   CostAnalysisOptions cost_analysis_options;
 
+  // Caches the outputs of client graphs that are free of side effects, keyed
+  // by a fingerprint of their inputs, and coalesces concurrent runs with
+  // identical inputs into a single execution. Graphs with stateful ops,
+  // including variable and table reads, are never cached.
+  struct RunResultCacheOptions {
+    // The maximum total bytes of cached outputs per client graph. Zero
+    // disables the cache.
+    int64_t max_bytes = 0;
+
+    // How long a cached result stays valid.
+    absl::Duration ttl = absl::InfiniteDuration();
+  };
+
+  RunResultCacheOptions run_result_cache_options;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -45,7 +46,9 @@ limitations under the License.
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "mlir/IR/Visitors.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tensorflow/dialect_registration.h"
 #include "tensorflow/compiler/mlir/tensorflow/ir/tf_saved_model.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/import_model.h"
@@ -61,6 +64,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -82,6 +87,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/export_mlir.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
+#include "tensorflow/core/tfrt/graph_executor/run_result_cache.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
@@ -99,6 +105,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/utils/tfrt_graph_execution_state.h"
 #include "tensorflow/core/tfrt/utils/utils.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/refcount.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/profiler/lib/traceme.h"
@@ -563,6 +570,36 @@ void CreateSortedNamesAndOriginalIndices(absl::Span<const std::string> names,
   }
 }
 
+// Returns true if running the TF ops in `module` has no observable side
+// effects, so that identical inputs always produce identical outputs. Reads of
+// variables and lookup tables are treated as stateful, since another graph can
+// mutate them between runs; ops that are unknown to the op registry are
+// conservatively treated as having side effects.
+bool IsFreeOfSideEffects(mlir::ModuleOp module) {
+  // Call and control-flow ops are stateful in the op registry, but their
+  // bodies are walked as well.
+  static const auto* const kAllowedStatefulOps =
+      new absl::flat_hash_set<std::string>({
+          "Case",
+          "If",
+          "StatefulPartitionedCall",
+          "While",
+      });
+  auto result = module.walk([&](mlir::Operation* op) {
+    if (op->getName().getDialectNamespace() != "tf") {
+      return mlir::WalkResult::advance();
+    }
+    std::string op_name = op->getName().stripDialect().str();
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()->LookUpOpDef(op_name, &op_def).ok() ||
+        (op_def->is_stateful() && !kAllowedStatefulOps->contains(op_name))) {
+      return mlir::WalkResult::interrupt();
+    }
+    return mlir::WalkResult::advance();
+  });
+  return !result.wasInterrupted();
+}
+
 }  // namespace
 
 absl::Status GraphExecutor::Run(
@@ -644,17 +681,36 @@ absl::Status GraphExecutor::Run(
   CostRecorder* cost_recorder =
       loaded_client_graph.MaybeGetCostRecorder(now, &do_recompilation);
 
+  auto run_graph = [&](std::vector<tensorflow::Tensor>* flat_outputs) {
+    return GraphExecutionRunOnFunction(
+        options_, run_options, loaded_client_graph.name(),
+        loaded_client_graph.symbol_uids(), func, loaded_executable,
+        flat_inputs, flat_outputs, resource_context_.get(),
+        &executable_context->resource_context,
+        &loaded_client_graph.runner_table(),
+        &loaded_client_graph.resource_array(), runtime(), fallback_state(),
+        loaded_client_graph.process_function_library_runtime(),
+        &req_deadline_tracker_, loaded_client_graph.stream_callback_id(),
+        cost_recorder);
+  };
+
+  // Serve the request from the result cache when possible. Runs that record
+  // costs or stream outputs must actually execute the graph.
+  std::optional<tsl::Fprint128> cache_key;
+  RunResultCache* result_cache = loaded_client_graph.result_cache();
+  if (result_cache != nullptr && cost_recorder == nullptr &&
+      !loaded_client_graph.stream_callback_id().has_value() &&
+      !run_options.streamed_output_callback) {
+    cache_key = RunResultCache::FingerprintInputs(flat_inputs);
+  }
+
   std::vector<tensorflow::Tensor> flat_outputs;
-  TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
-      options_, run_options, loaded_client_graph.name(),
-      loaded_client_graph.symbol_uids(), func, loaded_executable, flat_inputs,
-      &flat_outputs, resource_context_.get(),
-      &executable_context->resource_context,
-      &loaded_client_graph.runner_table(),
-      &loaded_client_graph.resource_array(), runtime(), fallback_state(),
-      loaded_client_graph.process_function_library_runtime(),
-      &req_deadline_tracker_, loaded_client_graph.stream_callback_id(),
-      cost_recorder));
+  if (cache_key.has_value()) {
+    TF_RETURN_IF_ERROR(
+        result_cache->GetOrCompute(*cache_key, run_graph, &flat_outputs));
+  } else {
+    TF_RETURN_IF_ERROR(run_graph(&flat_outputs));
+  }
 
   if (do_recompilation) {
     TF_RETURN_IF_ERROR(
@@ -704,6 +760,9 @@ GraphExecutor::ImportAndCompileClientGraph(
       auto flib_def_and_module,
       ImportClientGraphToMlirModule(client_graph, context.get()));
   auto& [flib_def, module] = flib_def_and_module;
+  // Check for side effects before lowering, while the module still holds the
+  // original TF ops.
+  const bool is_pure = IsFreeOfSideEffects(module.get());
 
   // If the module contains a Restore op, then there should be one input,
   // and it should specify the checkpoint for variable restore.
@@ -801,7 +860,7 @@ GraphExecutor::ImportAndCompileClientGraph(
       client_graph.name, std::move(symbol_uids), this, std::move(context),
       std::move(module_with_op_keys), std::move(module),
       std::move(executable_context), stream_callback_id,
-      !checkpoint_path.empty(), std::move(flib_def), latency_sampler);
+      !checkpoint_path.empty(), is_pure, std::move(flib_def), latency_sampler);
 }
 
 absl::StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
@@ -1119,7 +1178,7 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     mlir::OwningOpRef<mlir::ModuleOp> tfrt_mlir,
     std::shared_ptr<ExecutableContext> executable_context,
     std::optional<StreamCallbackId> stream_callback_id, bool is_restore,
-    FunctionLibraryDefinition flib_def,
+    bool is_pure, FunctionLibraryDefinition flib_def,
     tsl::monitoring::SamplerCell* latency_sampler)
     : name_(std::move(name)),
       symbol_uids_(std::move(symbol_uids)),
@@ -1160,6 +1219,12 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
       cost_analysis_data_.tfrt_mlir = std::move(tfrt_mlir);
     }
   }
+  const auto& cache_options =
+      graph_executor_->options().run_result_cache_options;
+  if (is_pure && !is_restore_ && cache_options.max_bytes > 0) {
+    result_cache_ = std::make_unique<RunResultCache>(cache_options.max_bytes,
+                                                     cache_options.ttl);
+  }
 }
 
 void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
+#include "tensorflow/core/tfrt/graph_executor/run_result_cache.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/function.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
@@ -158,7 +159,8 @@ class GraphExecutor {
                       mlir::OwningOpRef<mlir::ModuleOp> tfrt_mlir,
                       std::shared_ptr<ExecutableContext> executable_context,
                       std::optional<StreamCallbackId> stream_callback_id,
-                      bool is_restore, FunctionLibraryDefinition flib_def,
+                      bool is_restore, bool is_pure,
+                      FunctionLibraryDefinition flib_def,
                       tsl::monitoring::SamplerCell* latency_sampler);
 
     // Returns this instance's CostRecorder if it is time to update costs,
@@ -191,6 +193,10 @@ class GraphExecutor {
 
     bool is_restore() const { return is_restore_; }
 
+    // Returns the cache for this graph's results, or nullptr if result
+    // caching is disabled or the graph has side effects.
+    RunResultCache* result_cache() { return result_cache_.get(); }
+
     const ProcessFunctionLibraryRuntime& process_function_library_runtime()
         const {
       return pflr_;
@@ -235,6 +241,7 @@ class GraphExecutor {
     FunctionLibraryDefinition flib_def_;
     ProcessFunctionLibraryRuntime pflr_;
     tsl::monitoring::SamplerCell* latency_sampler_;
+    std::unique_ptr<RunResultCache> result_cache_;
   };
 
   // A subgraph constructed by specifying input/output tensors.
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/cc/framework/scope.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -590,6 +591,52 @@ TEST_F(GraphExecutorTest, SyncExecute) {
   EXPECT_EQ(expected, results[0].Get<tfrt::DenseHostTensor>());
 }
 
+TEST_F(GraphExecutorTest, RunResultCacheSeesVariableUpdates) {
+  GraphDef graph_def;
+  {
+    auto scope = tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+
+    auto var = ops::VarHandleOp(scope.WithOpName("var"), DT_INT32, {});
+    auto value = ops::Placeholder(scope.WithOpName("value"), DT_INT32);
+    ops::AssignVariableOp(scope.WithOpName("assign"), var, value);
+    ops::ReadVariableOp(scope.WithOpName("read"), var, DT_INT32);
+
+    TF_ASSERT_OK(scope.ToGraphDef(&graph_def));
+  }
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.run_result_cache_options.max_bytes = 1 << 20;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+
+  std::vector<tensorflow::Tensor> outputs;
+  for (int32_t value : {1, 2}) {
+    TF_ASSERT_OK(graph_executor->Run(
+        /*run_options=*/{},
+        /*inputs=*/{{"value", CreateTfTensor<int32_t>(/*shape=*/{}, {value})}},
+        /*output_tensor_names=*/{},
+        /*target_tensor_names=*/{"assign"}, &outputs));
+
+    // The read graph has identical (empty) inputs on every run, so it must
+    // not be served from the result cache after the variable changed.
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, /*inputs=*/{},
+                                     /*output_tensor_names=*/{"read"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({value}));
+  }
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
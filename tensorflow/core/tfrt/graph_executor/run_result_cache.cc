@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/graph_executor/run_result_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+std::optional<tsl::Fprint128> RunResultCache::FingerprintInputs(
+    absl::Span<const Tensor> inputs) {
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128("");
+  for (const Tensor& input : inputs) {
+    fingerprint = tsl::FingerprintCat128(fingerprint, input.dtype());
+    fingerprint = tsl::FingerprintCat128(fingerprint, input.dims());
+    for (int64_t dim : input.shape().dim_sizes()) {
+      fingerprint = tsl::FingerprintCat128(fingerprint, dim);
+    }
+    if (input.dtype() == DT_STRING) {
+      for (const tstring& element : input.unaligned_flat<tstring>()) {
+        fingerprint =
+            tsl::FingerprintCat128(fingerprint, tsl::Fingerprint128(element));
+      }
+    } else if (DataTypeCanUseMemcpy(input.dtype())) {
+      fingerprint = tsl::FingerprintCat128(
+          fingerprint, tsl::Fingerprint128(input.tensor_data()));
+    } else {
+      return std::nullopt;
+    }
+  }
+  return fingerprint;
+}
+
+absl::Status RunResultCache::GetOrCompute(
+    const tsl::Fprint128& key,
+    absl::FunctionRef<absl::Status(std::vector<Tensor>*)> compute,
+    std::vector<Tensor>* outputs) {
+  std::shared_ptr<InFlight> in_flight;
+  {
+    tensorflow::mutex_lock lock(mu_);
+    if (auto it = entries_.find(key); it != entries_.end()) {
+      if (it->second.expiration > absl::Now()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        *outputs = it->second.outputs;
+        return absl::OkStatus();
+      }
+      Erase(it);
+    }
+    if (auto it = in_flight_.find(key); it != in_flight_.end()) {
+      in_flight = it->second;
+    } else {
+      in_flight_[key] = std::make_shared<InFlight>();
+    }
+  }
+
+  if (in_flight != nullptr) {
+    in_flight->done.WaitForNotification();
+    if (!in_flight->status.ok()) return in_flight->status;
+    *outputs = in_flight->outputs;
+    return absl::OkStatus();
+  }
+
+  absl::Status status = compute(outputs);
+
+  tensorflow::mutex_lock lock(mu_);
+  auto node = in_flight_.extract(key);
+  if (status.ok()) {
+    node.mapped()->outputs = *outputs;
+    Insert(key, *outputs);
+  }
+  node.mapped()->status = status;
+  node.mapped()->done.Notify();
+  return status;
+}
+
+void RunResultCache::Insert(const tsl::Fprint128& key,
+                            const std::vector<Tensor>& outputs) {
+  int64_t bytes = 0;
+  for (const Tensor& output : outputs) bytes += output.TotalBytes();
+  if (bytes > max_bytes_) return;
+
+  if (auto it = entries_.find(key); it != entries_.end()) Erase(it);
+  while (!lru_.empty() && size_bytes_ + bytes > max_bytes_) {
+    Erase(entries_.find(lru_.back()));
+  }
+
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.outputs = outputs;
+  entry.bytes = bytes;
+  entry.expiration = absl::Now() + ttl_;
+  entry.lru_position = lru_.begin();
+  size_bytes_ += bytes;
+}
+
+void RunResultCache::Erase(EntryMap::iterator it) {
+  size_bytes_ -= it->second.bytes;
+  lru_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
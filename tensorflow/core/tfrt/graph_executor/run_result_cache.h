@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_RUN_RESULT_CACHE_H_
+#define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_RUN_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+// A cache of graph execution results keyed by a fingerprint of the inputs.
+//
+// Concurrent lookups of the same key are coalesced: the first caller runs the
+// computation and the others wait for its result. Successful results are kept
+// until they expire or are evicted in LRU order to stay within `max_bytes`.
+// Errors are returned to every waiter but are never cached.
+//
+// This class is thread-safe.
+class RunResultCache {
+ public:
+  RunResultCache(int64_t max_bytes, absl::Duration ttl)
+      : max_bytes_(max_bytes), ttl_(ttl) {}
+
+  RunResultCache(const RunResultCache&) = delete;
+  RunResultCache& operator=(const RunResultCache&) = delete;
+
+  // Returns the fingerprint of `inputs`, or std::nullopt if some input has a
+  // dtype whose content cannot be fingerprinted (e.g. resources or variants).
+  static std::optional<tsl::Fprint128> FingerprintInputs(
+      absl::Span<const Tensor> inputs);
+
+  // Sets `outputs` to the cached result for `key`. On a miss, calls `compute`
+  // to produce it unless another caller is already computing the same key, in
+  // which case waits for and shares that result.
+  absl::Status GetOrCompute(
+      const tsl::Fprint128& key,
+      absl::FunctionRef<absl::Status(std::vector<Tensor>*)> compute,
+      std::vector<Tensor>* outputs);
+
+  // Returns the total bytes of the cached outputs.
+  int64_t size_bytes() const {
+    tensorflow::mutex_lock lock(mu_);
+    return size_bytes_;
+  }
+
+ private:
+  struct InFlight {
+    absl::Notification done;
+    absl::Status status;
+    std::vector<Tensor> outputs;
+  };
+
+  struct Entry {
+    std::vector<Tensor> outputs;
+    int64_t bytes = 0;
+    absl::Time expiration;
+    std::list<tsl::Fprint128>::iterator lru_position;
+  };
+
+  using EntryMap =
+      absl::flat_hash_map<tsl::Fprint128, Entry, tsl::Fprint128Hasher>;
+
+  void Insert(const tsl::Fprint128& key, const std::vector<Tensor>& outputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Erase(EntryMap::iterator it) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t max_bytes_;
+  const absl::Duration ttl_;
+
+  mutable tensorflow::mutex mu_;
+  EntryMap entries_ TF_GUARDED_BY(mu_);
+  // Keys ordered from the most to the least recently used.
+  std::list<tsl::Fprint128> lru_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<tsl::Fprint128, std::shared_ptr<InFlight>,
+                      tsl::Fprint128Hasher>
+      in_flight_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_RUN_RESULT_CACHE_H_
@@ -0,0 +1,187 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/graph_executor/run_result_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+using ::testing::status::StatusIs;
+
+tsl::Fprint128 KeyOf(const Tensor& tensor) {
+  return *RunResultCache::FingerprintInputs({tensor});
+}
+
+TEST(RunResultCacheTest, FingerprintInputs) {
+  auto a = RunResultCache::FingerprintInputs(
+      {test::AsTensor<int32_t>({1, 2, 3, 4}, {2, 2})});
+  auto b = RunResultCache::FingerprintInputs(
+      {test::AsTensor<int32_t>({1, 2, 3, 4}, {4})});
+  auto c = RunResultCache::FingerprintInputs(
+      {test::AsTensor<int32_t>({1, 2, 3, 4}, {2, 2})});
+  auto d = RunResultCache::FingerprintInputs(
+      {test::AsTensor<tstring>({"a", "bc"})});
+  auto e = RunResultCache::FingerprintInputs(
+      {test::AsTensor<tstring>({"ab", "c"})});
+  ASSERT_TRUE(a && b && c && d && e);
+  EXPECT_EQ(*a, *c);
+  EXPECT_FALSE(*a == *b);
+  EXPECT_FALSE(*d == *e);
+
+  EXPECT_FALSE(RunResultCache::FingerprintInputs(
+                   {Tensor(DT_RESOURCE, TensorShape({}))})
+                   .has_value());
+}
+
+TEST(RunResultCacheTest, CachesSuccessfulResults) {
+  RunResultCache cache(/*max_bytes=*/1024, absl::InfiniteDuration());
+  Tensor input = test::AsScalar<int32_t>(1);
+  int num_computes = 0;
+  auto compute = [&](std::vector<Tensor>* outputs) {
+    ++num_computes;
+    outputs->push_back(test::AsScalar<float>(2.0));
+    return absl::OkStatus();
+  };
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(cache.GetOrCompute(KeyOf(input), compute, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    test::ExpectEqual(outputs[0], test::AsScalar<float>(2.0));
+  }
+  EXPECT_EQ(num_computes, 1);
+  EXPECT_EQ(cache.size_bytes(), sizeof(float));
+}
+
+TEST(RunResultCacheTest, DoesNotCacheErrors) {
+  RunResultCache cache(/*max_bytes=*/1024, absl::InfiniteDuration());
+  Tensor input = test::AsScalar<int32_t>(1);
+  int num_computes = 0;
+  auto compute = [&](std::vector<Tensor>* outputs) {
+    ++num_computes;
+    return absl::InternalError("failed");
+  };
+
+  std::vector<Tensor> outputs;
+  EXPECT_THAT(cache.GetOrCompute(KeyOf(input), compute, &outputs),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(cache.GetOrCompute(KeyOf(input), compute, &outputs),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(num_computes, 2);
+  EXPECT_EQ(cache.size_bytes(), 0);
+}
+
+TEST(RunResultCacheTest, EvictsLeastRecentlyUsed) {
+  // Room for exactly two scalar float outputs.
+  RunResultCache cache(/*max_bytes=*/2 * sizeof(float),
+                       absl::InfiniteDuration());
+  int num_computes = 0;
+  auto compute = [&](std::vector<Tensor>* outputs) {
+    ++num_computes;
+    outputs->push_back(test::AsScalar<float>(0.0));
+    return absl::OkStatus();
+  };
+  auto run = [&](int32_t value) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(cache.GetOrCompute(KeyOf(test::AsScalar<int32_t>(value)),
+                                    compute, &outputs));
+  };
+
+  run(1);
+  run(2);
+  run(1);  // Makes 2 the least recently used entry.
+  run(3);  // Evicts 2.
+  EXPECT_EQ(num_computes, 3);
+  run(1);
+  EXPECT_EQ(num_computes, 3);
+  run(2);
+  EXPECT_EQ(num_computes, 4);
+}
+
+TEST(RunResultCacheTest, ExpiresEntries) {
+  RunResultCache cache(/*max_bytes=*/1024, absl::ZeroDuration());
+  Tensor input = test::AsScalar<int32_t>(1);
+  int num_computes = 0;
+  auto compute = [&](std::vector<Tensor>* outputs) {
+    ++num_computes;
+    outputs->push_back(test::AsScalar<float>(0.0));
+    return absl::OkStatus();
+  };
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(cache.GetOrCompute(KeyOf(input), compute, &outputs));
+  TF_ASSERT_OK(cache.GetOrCompute(KeyOf(input), compute, &outputs));
+  EXPECT_EQ(num_computes, 2);
+}
+
+TEST(RunResultCacheTest, CoalescesConcurrentRequests) {
+  RunResultCache cache(/*max_bytes=*/1024, absl::InfiniteDuration());
+  Tensor input = test::AsScalar<int32_t>(1);
+  std::atomic<int> num_computes = 0;
+  absl::Notification compute_started;
+  absl::Notification finish_compute;
+  auto compute = [&](std::vector<Tensor>* outputs) {
+    ++num_computes;
+    compute_started.Notify();
+    finish_compute.WaitForNotification();
+    outputs->push_back(test::AsScalar<float>(2.0));
+    return absl::OkStatus();
+  };
+
+  constexpr int kNumRequests = 4;
+  std::vector<std::vector<Tensor>> outputs(kNumRequests);
+  {
+    tsl::thread::ThreadPool thread_pool(Env::Default(), "test", kNumRequests);
+    for (int i = 0; i < kNumRequests; ++i) {
+      thread_pool.Schedule([&, i]() {
+        TF_ASSERT_OK(cache.GetOrCompute(KeyOf(input), compute, &outputs[i]));
+      });
+    }
+    compute_started.WaitForNotification();
+    // Give the remaining requests a chance to start waiting.
+    absl::SleepFor(absl::Milliseconds(100));
+    finish_compute.Notify();
+  }
+
+  EXPECT_EQ(num_computes, 1);
+  for (const auto& output : outputs) {
+    ASSERT_EQ(output.size(), 1);
+    test::ExpectEqual(output[0], test::AsScalar<float>(2.0));
+  }
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
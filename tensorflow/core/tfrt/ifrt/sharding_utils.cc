@@ -36,6 +36,7 @@ limitations under the License.
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "xla/hlo/ir/hlo_sharding.h"
+#include "xla/pjrt/pjrt_compiler.h"
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/device.h"
@@ -66,6 +67,19 @@ namespace tensorflow {
 namespace ifrt_serving {
 namespace {
 
+// Returns the semantics to create IFRT arrays from host tensors with. The
+// PjRt CPU client may adopt the tensor buffer instead of copying it, and calls
+// the on-done callback, which holds a reference to the tensor, only once the
+// array no longer uses the buffer. Other backends are not known to keep the
+// host buffer alive that way, so they copy it.
+xla::ifrt::Client::HostBufferSemantics HostTensorSemantics(
+    const xla::ifrt::Client& ifrt_client) {
+  return ifrt_client.platform_name() == xla::CpuName()
+             ? xla::ifrt::Client::HostBufferSemantics::kImmutableZeroCopy
+             : xla::ifrt::Client::HostBufferSemantics::
+                   kImmutableUntilTransferCompletes;
+}
+
 struct IndexDomainLexicographicalComparator {
   bool operator()(const xla::ifrt::IndexDomain& a,
                   const xla::ifrt::IndexDomain& b) const {
@@ -185,8 +199,7 @@ SplitAndCreateArraysFromHostBuffer(
                               xla::ifrt::Shape(tensor.shape().dim_sizes()),
                               GetByteStrides(tensor_data_type, tensor.shape()),
                               std::move(single_device_sharding),
-                              xla::ifrt::Client::HostBufferSemantics::
-                                  kImmutableUntilTransferCompletes,
+                              HostTensorSemantics(ifrt_client),
                               [tensor, slice_idx]() {
                                 // Keep tensor alive
                                 VLOG(2) << "Done with host buffer for slice "
@@ -348,8 +361,7 @@ CreateArrayFromHostTensorForSingleDevice(xla::ifrt::Client& ifrt_client,
   return ifrt_client.MakeArrayFromHostBuffer(
       tensor.data(), dtype, ToIfrtShape(tensor.shape()),
       GetByteStrides(tensor.dtype(), tensor.shape()),
-      std::move(single_device_sharding),
-      xla::ifrt::Client::HostBufferSemantics::kImmutableUntilTransferCompletes,
+      std::move(single_device_sharding), HostTensorSemantics(ifrt_client),
       [tensor]() {
         // Keep tensor alive
         VLOG(2) << "Done with single device host buffer for slice " << " at "
@@ -706,9 +718,7 @@ absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> MakeArrayFromTensor(
     return ifrt_client.MakeArrayFromHostBuffer(
         input_tensor.data(), ifrt_dtype, ToIfrtShape(input_tensor.shape()),
         GetByteStrides(input_tensor.dtype(), input_tensor.shape()),
-        std::move(ifrt_sharding),
-        xla::ifrt::Client::HostBufferSemantics::
-            kImmutableUntilTransferCompletes,
+        std::move(ifrt_sharding), HostTensorSemantics(ifrt_client),
         [input_tensor]() {  // keep tensor alive
         });
   }
@@ -647,6 +647,39 @@ INSTANTIATE_TEST_SUITE_P(
             },
         }));
 
+TEST(ShardingUtilsTest, CpuArrayKeepsHostTensorAlive) {
+  constexpr int kMaxParallelism = 16;
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), tsl::ThreadOptions(),
+                                      "Resharding", kMaxParallelism);
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  auto input_tensor =
+      test::AsTensor<int32_t>({1, 2, 3, 4}, TensorShape({2, 2}));
+  ASSERT_TRUE(input_tensor.RefCountIsOne());
+  std::vector<int> device_ids = {0};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto array,
+      MakeArrayFromTensor(*client, input_tensor, absl::MakeSpan(device_ids),
+                          xla::HloSharding::Replicate(), thread_pool));
+
+  // The CPU client may alias the tensor buffer, so the array must hold a
+  // reference to the tensor for as long as it uses the buffer.
+  EXPECT_FALSE(input_tensor.RefCountIsOne());
+
+  tensorflow::Tensor host_tensor(DT_INT32, TensorShape({2, 2}));
+  TF_ASSERT_OK(
+      array
+          ->CopyToHostBuffer(
+              host_tensor.data(),
+              GetByteStrides(host_tensor.dtype(), host_tensor.shape()),
+              xla::ifrt::ArrayCopySemantics::kAlwaysCopy)
+          .Await());
+  EXPECT_THAT(host_tensor, TensorEq(input_tensor));
+}
+
 TEST(ShardingUtilsTest, MismatchRank) {
   constexpr int kMaxParallelism = 16;
   tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), tsl::ThreadOptions(),
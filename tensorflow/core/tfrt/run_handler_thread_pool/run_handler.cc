@@ -20,7 +20,9 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -34,6 +36,7 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -691,6 +694,8 @@ class RunHandler::Impl {
   internal::ThreadWorkSource* tws() { return &tws_; }
 
   int64_t priority() const { return options_.priority; }
+  int qos_class() const { return options_.qos_class; }
+  int64_t deadline_us() const { return options_.deadline_us; }
 
  private:
   class RunHandlerEigenThreadPool
@@ -746,7 +751,9 @@ class RunHandlerPool::Impl {
         version_(0),
         wait_if_no_active_request_(options.wait_if_no_active_request),
         sub_thread_pool_end_request_percentage_(
-            options.sub_thread_request_percentage) {
+            options.sub_thread_request_percentage),
+        max_handlers_per_qos_class_(
+            std::move(options.max_concurrent_handlers_per_qos_class)) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
     free_handlers_.reserve(max_handlers_);
     handlers_.reserve(max_handlers_);
@@ -783,6 +790,14 @@ class RunHandlerPool::Impl {
     return !free_handlers_.empty();
   }
 
+  // Returns true if a request of `qos_class` can take a handler now.
+  bool can_admit(int qos_class) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!has_free_handler()) return false;
+    auto cap = max_handlers_per_qos_class_.find(qos_class);
+    return cap == max_handlers_per_qos_class_.end() ||
+           active_handlers_per_qos_class_[qos_class] < cap->second;
+  }
+
   std::unique_ptr<RunHandler> Get(int64_t step_id, int64_t timeout_in_ms,
                                   const RunHandlerOptions& options)
       TF_LOCKS_EXCLUDED(mu_) {
@@ -793,21 +808,26 @@ class RunHandlerPool::Impl {
     uint64_t version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const uint64_t request_time_us = tensorflow::EnvTime::NowMicros();
     {
       tensorflow::mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      const int qos_class = options.qos_class;
+      if (!can_admit(qos_class)) {
         tsl::profiler::TraceMe activity(
             [step_id] {
               return tsl::profiler::TraceMeEncode("WaitingForHandler",
                                                   {{"step_id", step_id}});
             },
             tsl::profiler::TraceMeLevel::kInfo);
+        auto admissible = [this, qos_class]()
+                              TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                                return can_admit(qos_class);
+                              };
         if (timeout_in_ms == 0) {
-          mu_.Await(tensorflow::Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       tensorflow::Condition(this, &Impl::has_free_handler),
-                       tensorflow::EnvTime::NowNanos() +
-                           timeout_in_ms * 1000 * 1000)) {
+          mu_.Await(tensorflow::Condition(&admissible));
+        } else if (!mu_.AwaitWithDeadline(tensorflow::Condition(&admissible),
+                                          tensorflow::EnvTime::NowNanos() +
+                                              timeout_in_ms * 1000 * 1000)) {
           return nullptr;
         }
       }
@@ -816,15 +836,22 @@ class RunHandlerPool::Impl {
       handler_impl = free_handlers_.back();
       handler_impl->Reset(step_id, options);
       free_handlers_.pop_back();
+      ++active_handlers_per_qos_class_[qos_class];
 
+      // Handlers are ordered by decreasing priority, then by increasing
+      // deadline, then by arrival.
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
       int priority = options.priority;
+      const int64_t deadline_us = EffectiveDeadline(options.deadline_us);
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() ||
+             priority > (*it)->priority() ||
+             (priority == (*it)->priority() &&
+              deadline_us < EffectiveDeadline((*it)->deadline_us())))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -835,6 +862,8 @@ class RunHandlerPool::Impl {
       }
       version = ++version_;
     }
+    RecordQueueingDelay(options.qos_class,
+                        tensorflow::EnvTime::NowMicros() - request_time_us);
     RecomputePoolStats(num_active_requests, version, *thread_work_sources);
     return std::unique_ptr<RunHandler>(new RunHandler(handler_impl));
   }
@@ -862,6 +891,7 @@ class RunHandlerPool::Impl {
     // handlers.
     sorted_active_handlers_.erase(iter);
     free_handlers_.push_back(handler);
+    --active_handlers_per_qos_class_[handler->qos_class()];
     DCHECK_LE(free_handlers_.size(), max_handlers_);
     LogInfo();
 
@@ -888,6 +918,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerDeadlinesForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    tensorflow::mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->deadline_us());
+    }
+    return ret;
+  }
+
   void Quiesce() TF_LOCKS_EXCLUDED(mu_) {
     while (true) {
       {
@@ -917,6 +957,22 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Maps "no deadline" to the latest possible deadline.
+  static int64_t EffectiveDeadline(int64_t deadline_us) {
+    return deadline_us == 0 ? std::numeric_limits<int64_t>::max()
+                            : deadline_us;
+  }
+
+  static void RecordQueueingDelay(int qos_class, uint64_t delay_us) {
+    static auto* cell = tensorflow::monitoring::Sampler<1>::New(
+        {"/tfrt/run_handler/queueing_delay",
+         "Tracks how long (in microseconds) requests wait for a run handler, "
+         "by QoS class.",
+         "qos_class"},
+        tensorflow::monitoring::Buckets::Exponential(10, 1.5, 33));
+    cell->GetCell(tensorflow::strings::StrCat(qos_class))->Add(delay_us);
+  }
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -945,6 +1001,8 @@ class RunHandlerPool::Impl {
   int64_t version_ TF_GUARDED_BY(mu_);
   bool wait_if_no_active_request_;
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+  const std::map<int, int> max_handlers_per_qos_class_;
+  std::map<int, int> active_handlers_per_qos_class_ TF_GUARDED_BY(mu_);
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
@@ -1047,6 +1105,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerDeadlinesForTesting()
+    const {
+  return impl_->GetActiveHandlerDeadlinesForTesting();
+}
+
 void RunHandlerPool::Quiesce() const { impl_->Quiesce(); }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
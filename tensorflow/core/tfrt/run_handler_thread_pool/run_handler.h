@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -47,10 +48,22 @@ class RunHandler;
 
 // Options for RunHanler.
 struct RunHandlerOptions {
-  RunHandlerOptions() : priority(0) {}
+  RunHandlerOptions() : priority(0), qos_class(0), deadline_us(0) {}
 
   // Request priority.
   int priority;
+
+  // QoS class of the request, e.g. one per model or per tenant. Bounds the
+  // number of concurrent handlers of the class (see
+  // RunHandlerPool::Options::max_concurrent_handlers_per_qos_class) and labels
+  // the queueing delay metric.
+  int qos_class;
+
+  // Absolute deadline of the request in microseconds since the unix epoch, or
+  // 0 if it has none. Among requests of equal priority, work of the request
+  // with the earliest deadline is dispatched first. Requests without a
+  // deadline come after those with one, in arrival order.
+  int64_t deadline_us;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -82,6 +95,13 @@ class RunHandlerPool {
     // The number of max concurrent handlers.
     int max_concurrent_handler = 128;
 
+    // The number of max concurrent handlers of each QoS class (see
+    // RunHandlerOptions::qos_class). Classes without an entry are only bounded
+    // by max_concurrent_handler.
+    // Get() blocks a request whose class is at its cap, so that a burst of
+    // requests of one class cannot take every handler from the others.
+    std::map<int, int> max_concurrent_handlers_per_qos_class;
+
     // The number of sub thread pool configed.
     int num_sub_thread_pool = 1;
 
@@ -122,7 +142,9 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler and the request's QoS class
+  // is below its concurrency cap. The time spent blocked is recorded in
+  // /tfrt/run_handler/queueing_delay by QoS class.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunHandlerOptions& options = RunHandlerOptions());
@@ -131,6 +153,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the deadlines for active handlers, in the order of the active handler
+  // list.
+  std::vector<int64_t> GetActiveHandlerDeadlinesForTesting() const;
+
   // Block until the system is quiescent (no pending work and no inflight work).
   void Quiesce() const;
 
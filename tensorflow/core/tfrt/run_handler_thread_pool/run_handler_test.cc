@@ -119,6 +119,55 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = 2;
+  pool_options.num_inter_op_threads = 2;
+  pool_options.num_threads_in_sub_thread_pool = {2};
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.deadline_us = 0;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.deadline_us = 300;
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.deadline_us = 100;
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.priority = 1;
+  options.deadline_us = 500;
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  // Higher priority first, then earliest deadline, then no deadline.
+  EXPECT_EQ(pool->GetActiveHandlerDeadlinesForTesting(),
+            std::vector<int64_t>({500, 100, 300, 0}));
+}
+
+TEST(RunHandlerUtilTest, QosClassConcurrencyCapTest) {
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = 2;
+  pool_options.num_inter_op_threads = 2;
+  pool_options.num_threads_in_sub_thread_pool = {2};
+  pool_options.max_concurrent_handlers_per_qos_class = {{1, 1}};
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions heavy_options = RunHandlerOptions();
+  heavy_options.qos_class = 1;
+  RunHandlerOptions light_options = RunHandlerOptions();
+  light_options.qos_class = 2;
+
+  auto heavy1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, heavy_options);
+  ASSERT_NE(heavy1, nullptr);
+  // The heavy class is at its cap, but other classes are still admitted.
+  EXPECT_EQ(pool->Get(/*step_id=*/2, /*timeout_in_ms=*/10, heavy_options),
+            nullptr);
+  auto light = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/10, light_options);
+  EXPECT_NE(light, nullptr);
+
+  heavy1.reset();
+  auto heavy2 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/10, heavy_options);
+  EXPECT_NE(heavy2, nullptr);
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
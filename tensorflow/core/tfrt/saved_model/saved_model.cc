@@ -31,6 +31,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/mlir_roundtrip_flags.h"
 #include "tensorflow/compiler/mlir/tf2xla/api/v2/graph_to_tf_executor.h"
@@ -57,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -395,6 +398,36 @@ bool AotPackageExists(absl::string_view saved_model_dir) {
          env->FileExists(aot_bef_path).ok();
 }
 
+// Returns the directory whose `aot_packages` subdirectory holds the AOT package
+// to load for the SavedModel in `saved_model_dir`, or nullopt if there is none.
+// Entries of `aot_package_cache_dir` are keyed by the SavedModel's singleprint
+// and take precedence over the package shipped inside the SavedModel.
+std::optional<std::string> FindAotPackageRoot(
+    absl::string_view saved_model_dir,
+    absl::string_view aot_package_cache_dir) {
+  if (!aot_package_cache_dir.empty()) {
+    absl::StatusOr<std::string> singleprint =
+        saved_model::fingerprinting::Singleprint(saved_model_dir);
+    if (singleprint.ok()) {
+      // The singleprint joins its hashes with '/'; flatten it into one
+      // directory name.
+      std::string cache_entry =
+          tsl::io::JoinPath(aot_package_cache_dir,
+                            absl::StrReplaceAll(*singleprint, {{"/", "_"}}));
+      if (AotPackageExists(cache_entry)) {
+        LOG(INFO) << "Found AOT package for " << saved_model_dir
+                  << " in the AOT package cache at " << cache_entry;
+        return cache_entry;
+      }
+    } else {
+      LOG(WARNING) << "Not using the AOT package cache for " << saved_model_dir
+                   << ": " << singleprint.status();
+    }
+  }
+  if (AotPackageExists(saved_model_dir)) return std::string(saved_model_dir);
+  return std::nullopt;
+}
+
 std::string GetInferredModelType(const MetaGraphDef& meta_graph_def) {
   bool found_xla_call_module_op = false;
   for (const auto& function : meta_graph_def.graph_def().library().function()) {
@@ -528,7 +561,9 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   UpdateTpuTargetByBridgeCompatibility(options.graph_execution_options,
                                        meta_graph_def.graph_def());
   UpdateCompileOptions(options);
-  const bool aot_exist = AotPackageExists(saved_model_dir);
+  const std::optional<std::string> aot_package_root =
+      FindAotPackageRoot(saved_model_dir, options.aot_package_cache_dir);
+  const bool aot_exist = aot_package_root.has_value();
   options.enable_lazy_loading = options.enable_lazy_loading && !aot_exist;
 
   if (aot_exist || options.aot_generation) {
@@ -585,7 +620,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     LOG(INFO) << "Found AOT package. Load and deserialize MLIR module.";
 
     TF_RETURN_IF_ERROR(
-        DeserializeAoTMlirModule(saved_model_dir, &context, &mlir_module));
+        DeserializeAoTMlirModule(*aot_package_root, &context, &mlir_module));
   } else {
     ASSIGN_OR_RETURN_IN_IMPORT(
         mlir_module,
@@ -691,7 +726,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
       ASSIGN_OR_RETURN_IN_COMPILE(
           bytecode,
           LoadMlrtAndMlir(options.graph_execution_options.compile_options,
-                          mlir_module.get(), saved_model_dir_string,
+                          mlir_module.get(), *aot_package_root,
                           fallback_state.get()));
 
     } else {
@@ -699,7 +734,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
 
       ASSIGN_OR_RETURN_IN_COMPILE(
           bef, LoadBefAndMlir(options.graph_execution_options.compile_options,
-                              mlir_module.get(), saved_model_dir_string,
+                              mlir_module.get(), *aot_package_root,
                               fallback_state.get()));
       metrics::UpdateAotBefMlirLoadCount();
     }
@@ -783,7 +818,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     // Set persistent cache directory so that the binaries can be loaded from
     // the AOT directory.
     const std::string persistent_cache_directory =
-        GetAotPackagePath(saved_model_dir);
+        GetAotPackagePath(*aot_package_root);
     tensorflow::GetMarkForCompilationPassFlags()
         ->tf_xla_persistent_cache_directory = persistent_cache_directory;
     tensorflow::GetMarkForCompilationPassFlags()
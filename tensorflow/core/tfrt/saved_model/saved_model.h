@@ -110,6 +110,16 @@ class SavedModel {
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If non-empty, a directory of AOT packages that outlives the SavedModel
+    // directory, e.g. a local disk cache that survives process restarts. The
+    // AOT package for a SavedModel is looked up in
+    // `<aot_package_cache_dir>/<singleprint>/aot_packages`, where
+    // `<singleprint>` is the SavedModel's fingerprint (see
+    // tensorflow/cc/saved_model/fingerprinting.h) with '/' replaced by '_',
+    // before falling back to `<saved_model_dir>/aot_packages`. Since the key
+    // changes with the model, stale packages are never picked up.
+    std::string aot_package_cache_dir;
+
     // Make a best-effort guess at the model type and emit a metric. E.g.
     // detecting JAX models by looking for the `XlaCallModule` op in the
     // MetaGraphDef.
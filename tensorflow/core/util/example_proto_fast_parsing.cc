@@ -568,6 +568,45 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
+size_t ConfigSize(const Config& config) {
+  return config.dense.size() + config.sparse.size() + config.ragged.size();
+}
+
+// Fills `config_index` with the hashes of all feature names in `config`,
+// bumping the seed of `hasher` until the hashes are collision free.
+absl::Status BuildConfigIndex(
+    const Config& config,
+    PresizedCuckooMap<std::pair<size_t, Type>>* config_index,
+    SeededHasher* hasher) {
+  const size_t config_size = ConfigSize(config);
+  bool ok = true;
+  for (size_t i = 0; i < 1000; ++i) {
+    for (size_t d = 0; d < config.dense.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(config.dense[d].feature_name),
+                                       {d, Type::Dense});
+    }
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(config.sparse[d].feature_name),
+                                       {d, Type::Sparse});
+    }
+    for (size_t d = 0; d < config.ragged.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(config.ragged[d].feature_name),
+                                       {d, Type::Ragged});
+    }
+    if (ok) break;
+    LOG(WARNING) << "Collision found. This should happen only if you have "
+                    "around 2^32 entries in your config.";
+    hasher->seed++;
+    config_index->Clear(config_size);
+    ok = true;
+  }
+  if (!ok) {
+    return errors::Internal(
+        "Could not avoid collision. This should not happen.");
+  }
+  return absl::OkStatus();
+}
+
 void LogDenseFeatureDataLoss(absl::string_view feature_name) {
   LOG(WARNING) << "Data loss! Feature '" << feature_name
                << "' is present in multiple concatenated "
@@ -1134,6 +1173,27 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
 
 }  // namespace
 
+class FastParseExampleConfigIndex {
+ public:
+  explicit FastParseExampleConfigIndex(size_t config_size)
+      : config_size(config_size), config_index(config_size) {}
+
+  // Number of sub-configs the index was built for, used to detect configs
+  // that have been extended after the index was built.
+  const size_t config_size;
+  SeededHasher hasher;
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index;
+};
+
+absl::Status PrecomputeFastParseExampleConfigIndex(Config* config) {
+  auto index =
+      std::make_shared<FastParseExampleConfigIndex>(ConfigSize(*config));
+  TF_RETURN_IF_ERROR(
+      BuildConfigIndex(*config, &index->config_index, &index->hasher));
+  config->index = std::move(index);
+  return absl::OkStatus();
+}
+
 absl::Status FastParseExample(const Config& config,
                               absl::Span<const tstring> serialized,
                               absl::Span<const tstring> example_names,
@@ -1146,36 +1206,18 @@ absl::Status FastParseExample(const Config& config,
     result->feature_stats.resize(serialized.size());
   }
 
-  size_t config_size =
-      config.dense.size() + config.sparse.size() + config.ragged.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    for (size_t d = 0; d < config.ragged.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.ragged[d].feature_name),
-                                      {d, Type::Ragged});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
+  // Use the precomputed config index if there is one.
+  std::optional<FastParseExampleConfigIndex> local_index;
+  const FastParseExampleConfigIndex* index = config.index.get();
+  if (index == nullptr || index->config_size != ConfigSize(config)) {
+    local_index.emplace(ConfigSize(config));
+    TF_RETURN_IF_ERROR(BuildConfigIndex(config, &local_index->config_index,
+                                        &local_index->hasher));
+    index = &*local_index;
   }
+  const PresizedCuckooMap<std::pair<size_t, Type>>& config_index =
+      index->config_index;
+  const SeededHasher hasher = index->hasher;
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse and ragged have to be buffered).
@@ -1461,37 +1503,18 @@ absl::Status FastParseSingleExample(const Config& config,
     stats = &result->feature_stats.back();
   }
 
-  // TODO(mrry): Cache the construction of this map at Op construction time.
-  size_t config_size =
-      config.dense.size() + config.sparse.size() + config.ragged.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    for (size_t d = 0; d < config.ragged.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.ragged[d].feature_name),
-                                      {d, Type::Ragged});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
+  // Use the precomputed config index if there is one.
+  std::optional<FastParseExampleConfigIndex> local_index;
+  const FastParseExampleConfigIndex* index = config.index.get();
+  if (index == nullptr || index->config_size != ConfigSize(config)) {
+    local_index.emplace(ConfigSize(config));
+    TF_RETURN_IF_ERROR(BuildConfigIndex(config, &local_index->config_index,
+                                        &local_index->hasher));
+    index = &*local_index;
   }
+  const PresizedCuckooMap<std::pair<size_t, Type>>& config_index =
+      index->config_index;
+  const SeededHasher hasher = index->hasher;
 
   result->sparse_indices.reserve(config.sparse.size());
   result->sparse_values.reserve(config.sparse.size());
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -35,6 +36,10 @@ limitations under the License.
 namespace tensorflow {
 namespace example {
 
+// Lookup table from feature names to the sub-configs of a
+// FastParseExampleConfig. Defined in example_proto_fast_parsing.cc.
+class FastParseExampleConfigIndex;
+
 // FastParseExampleConfig defines how to parse features in Example.
 // Each sub-config is responsible for one feature identified with feature_name.
 // FastParseExampleConfig can't have two sub-configs with the same feature_name.
@@ -97,8 +102,19 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // Lookup table over the feature names above, set by
+  // `PrecomputeFastParseExampleConfigIndex()`. If unset, the table is rebuilt
+  // on every parse call. The feature names must not be changed once it is set.
+  std::shared_ptr<const FastParseExampleConfigIndex> index;
 };
 
+// Builds the feature name lookup table of `config` and stores it in
+// `config->index`, so that it is shared by all parse calls with (copies of)
+// that config instead of being rebuilt for each batch.
+absl::Status PrecomputeFastParseExampleConfigIndex(
+    FastParseExampleConfig* config);
+
 // Statistics about the features in each example passed to
 // `FastParse[Single]Example()`.
 //
@@ -140,7 +156,6 @@ absl::Status FastParseExample(const FastParseExampleConfig& config,
                               absl::Span<const tstring> example_names,
                               thread::ThreadPool* thread_pool, Result* result);
 
-// TODO(mrry): Move the hash table construction into the config object.
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
 absl::Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
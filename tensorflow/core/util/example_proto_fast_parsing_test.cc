@@ -327,6 +327,46 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, PrecomputedConfigIndex) {
+  const size_t kNumExamples = 5;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("float_list", DT_FLOAT, {-1}, true, 1, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+
+  FastParseExampleConfig indexed_config = config;
+  TF_CHECK_OK(PrecomputeFastParseExampleConfigIndex(&indexed_config));
+  ASSERT_NE(indexed_config.index, nullptr);
+
+  Result expected;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+  // Copies of the config share the precomputed index.
+  FastParseExampleConfig copied_config = indexed_config;
+  EXPECT_EQ(copied_config.index, indexed_config.index);
+  Result result;
+  TF_CHECK_OK(
+      FastParseExample(copied_config, serialized, {}, nullptr, &result));
+
+  ASSERT_EQ(expected.dense_values.size(), result.dense_values.size());
+  for (size_t d = 0; d < expected.dense_values.size(); ++d) {
+    EXPECT_EQ(expected.dense_values[d].DebugString(kNumExamples * 2),
+              result.dense_values[d].DebugString(kNumExamples * 2));
+  }
+  ASSERT_EQ(1, result.sparse_values.size());
+  EXPECT_EQ(expected.sparse_values[0].DebugString(kNumExamples * 3),
+            result.sparse_values[0].DebugString(kNumExamples * 3));
+  EXPECT_EQ(expected.sparse_indices[0].DebugString(kNumExamples * 6),
+            result.sparse_indices[0].DebugString(kNumExamples * 6));
+
+  Result single_result;
+  TF_CHECK_OK(
+      FastParseSingleExample(indexed_config, serialized[0], &single_result));
+  ASSERT_EQ(1, single_result.sparse_values.size());
+  EXPECT_EQ(3, single_result.sparse_values[0].NumElements());
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
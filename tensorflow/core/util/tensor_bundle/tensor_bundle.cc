@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/lib/io/buffered_file.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -428,6 +429,29 @@ absl::Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// A read-only tensor buffer aliasing part of a memory-mapped data file. Keeps
+// the mapping alive for as long as the buffer is referenced.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("bundle_reader_mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -1038,6 +1062,64 @@ absl::Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+absl::Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+
+  const auto lookup_copy = [this, key, val]() {
+    *val = Tensor();
+    return Lookup(key, val);
+  };
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_ || entry.offset() % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return lookup_copy();
+  }
+
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  const int64_t expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            expected_size);
+  }
+
+  std::shared_ptr<const ReadOnlyMemoryRegion>& region =
+      mapped_data_[entry.shard_id()];
+  if (region == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    if (!env_->NewReadOnlyMemoryRegionFromFile(
+                  DataFilename(prefix_, entry.shard_id(), num_shards_),
+                  &new_region)
+             .ok()) {
+      return lookup_copy();
+    }
+    region = std::move(new_region);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is truncated: key ", key,
+                            " ends at ", entry.offset() + entry.size(),
+                            " but the file has ", region->length(), " bytes");
+  }
+
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+
+  *val = Tensor(entry.dtype(), stored_shape,
+                core::RefCountPtr<TensorBuffer>(
+                    new MappedTensorBuffer(region, data, entry.size())));
+  return absl::OkStatus();
+}
+
 absl::Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
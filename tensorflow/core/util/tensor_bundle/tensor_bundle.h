@@ -264,6 +264,23 @@ class BundleReader {
   // REQUIRES: status().ok()
   absl::Status Lookup(absl::string_view key, Tensor* val);
 
+  // Like "Lookup()", but intended for immutable weights: if the tensor keyed
+  // by "key" is stored whole, has a memcpy-able dtype, needs no byte swapping
+  // and starts at an EIGEN_MAX_ALIGN_BYTES-aligned offset in its data file,
+  // "val" is set to a read-only tensor backed by a memory mapping of that
+  // file rather than a private copy. Readers of the same bundle then share
+  // the page cache. Callers must not mutate such a tensor.
+  //
+  // Falls back to "Lookup()" for every other tensor, and when the file system
+  // cannot map the data file. Writing the bundle with a
+  // "BundleWriter::Options::data_alignment" that is a multiple of
+  // EIGEN_MAX_ALIGN_BYTES makes every eligible tensor mappable.
+  //
+  // Unlike "Lookup()", "val" is always replaced. Validates the stored crc32c
+  // checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  absl::Status LookupMapped(absl::string_view key, Tensor* val);
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -340,6 +357,11 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Memory mappings of data files, created on demand by "LookupMapped()".
+  // Shared with the tensors handed out from them.
+  std::unordered_map<int32_t, std::shared_ptr<const ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
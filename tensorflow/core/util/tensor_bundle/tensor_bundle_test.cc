@@ -1270,6 +1270,45 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("flag", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("weights", Constant_100x100<float>(3.f)));
+    TF_EXPECT_OK(writer.Add("names", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("unaligned"));
+    TF_EXPECT_OK(writer.Add("flag", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("weights", Constant_2x3<float>(3.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(Env::Default(), Prefix("mapped"));
+  TF_ASSERT_OK(reader.status());
+  Tensor weights;
+  TF_ASSERT_OK(reader.LookupMapped("weights", &weights));
+  test::ExpectTensorEqual<float>(weights, Constant_100x100<float>(3.f));
+  // Both lookups alias the same mapping instead of copying it.
+  Tensor weights_again;
+  TF_ASSERT_OK(reader.LookupMapped("weights", &weights_again));
+  EXPECT_EQ(weights.tensor_data().data(), weights_again.tensor_data().data());
+
+  // Tensors that cannot be mapped are copied.
+  Tensor names;
+  TF_ASSERT_OK(reader.LookupMapped("names", &names));
+  test::ExpectTensorEqual<tstring>(names, Constant_2x3<tstring>("foo"));
+
+  BundleReader unaligned_reader(Env::Default(), Prefix("unaligned"));
+  TF_ASSERT_OK(unaligned_reader.status());
+  Tensor unaligned_weights;
+  TF_ASSERT_OK(unaligned_reader.LookupMapped("weights", &unaligned_weights));
+  test::ExpectTensorEqual<float>(unaligned_weights, Constant_2x3<float>(3.f));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -2430,9 +2430,11 @@ void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
   memory_planner_->GetAllocInfo(&alloc_info->arena_size,
                                 &alloc_info->arena_persist_size);
   for (const auto& tensor : tensors_) {
-    if (tensor.allocation_type == kTfLiteDynamic &&
-        tensor.data.raw != nullptr) {
+    if (tensor.data.raw == nullptr) continue;
+    if (tensor.allocation_type == kTfLiteDynamic) {
       alloc_info->dynamic_size += tensor.bytes;
+    } else if (tensor.allocation_type == kTfLitePersistentRo) {
+      alloc_info->persistent_ro_size += tensor.bytes;
     }
   }
   if (GetSubgraphIndex() == 0) {
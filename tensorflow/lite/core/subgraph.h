@@ -433,6 +433,9 @@ class Subgraph {
     size_t arena_persist_size;
     size_t dynamic_size;
     size_t resource_size;
+    // Heap memory of kTfLitePersistentRo tensors, e.g. weights that kernels
+    // converted or quantized into a copy at Prepare time.
+    size_t persistent_ro_size;
   } SubgraphAllocInfo;
 
   // WARNING: This is an experimental API and subject to change.
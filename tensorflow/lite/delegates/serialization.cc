@@ -32,6 +32,7 @@ limitations under the License.
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -73,6 +74,23 @@ inline std::string GetFilePath(const std::string& cache_dir,
   return JoinPath(cache_dir, file_name);
 }
 
+// Returns a path to write data to before it is renamed to its final path. The
+// path is unique across threads and processes writing to the same cache_dir,
+// so that concurrent writers never share (and interleave writes into) the same
+// temporary file.
+std::string GetTempFilePath(const std::string& cache_dir,
+                            const std::string& model_token,
+                            const uint64_t fingerprint) {
+  static std::atomic<uint64_t> temp_file_counter{0};
+  std::string file_name = model_token + std::to_string(fingerprint) +
+                          std::to_string(time(nullptr)) + "_" +
+                          std::to_string(temp_file_counter.fetch_add(1));
+#if !defined(_WIN32)
+  file_name += "_" + std::to_string(getpid());
+#endif  // !defined(_WIN32)
+  return JoinPath(cache_dir, file_name);
+}
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -93,8 +111,7 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
   auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
   // Temporary file to write data to.
   const std::string temp_filepath =
-      JoinPath(cache_dir_, (model_token_ + std::to_string(fingerprint_) +
-                            std::to_string(time(nullptr))));
+      GetTempFilePath(cache_dir_, model_token_, fingerprint_);
 
 #if defined(_WIN32)
   std::ofstream out_file(temp_filepath.c_str(), std::ios_base::binary);
@@ -114,7 +131,7 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
 #else   // !defined(_WIN32)
   // This method only works on unix/POSIX systems.
   const int fd = open(temp_filepath.c_str(),
-                      O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+                      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
   if (fd < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to open for writing: %s",
                        temp_filepath.c_str());
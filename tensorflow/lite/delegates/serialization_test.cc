@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/serialization.h"
 
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -309,6 +310,40 @@ TEST_F(SerializationTest, SerializationData) {
   }
 }
 
+TEST_F(SerializationTest, ConcurrentWritesDoNotInterleave) {
+  std::string model_token = "model_concurrent";
+  std::string test_dir = getSerializationDir();
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+  TfLiteDelegateParams partition = GenerateTfLiteDelegateParams(
+      /*num_nodes=*/2, /*num_input_tensors=*/3, /*num_output_tensors=*/1);
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  Serialization serialization(serialization_params);
+
+  constexpr int kNumWriters = 8;
+  constexpr int kDataSize = 4096;
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kNumWriters; ++i) {
+    writers.emplace_back([&, i] {
+      const std::string data(kDataSize, static_cast<char>('a' + i));
+      auto entry =
+          serialization.GetEntryForKernel("concurrent", &context, &partition);
+      EXPECT_EQ(entry.SetData(&context, data.data(), data.size()), kTfLiteOk);
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  // The stored data must be exactly one of the writes.
+  auto entry =
+      serialization.GetEntryForKernel("concurrent", &context, &partition);
+  std::string read_back;
+  ASSERT_EQ(entry.GetData(&context, &read_back), kTfLiteOk);
+  ASSERT_EQ(read_back.size(), kDataSize);
+  EXPECT_EQ(read_back, std::string(kDataSize, read_back[0]));
+}
+
 TEST_F(SerializationTest, CachingDelegatedNodes) {
   std::string model_token = "model1";
   std::string test_dir = getSerializationDir();
@@ -251,6 +251,11 @@ bool WeightCacheBuilder::Start(const char* path) {
   if (IsInMemoryCachePath(file_path_)) {
     fd_ = CreateInMemoryFileDescriptor("XNNPack in-memory weight cache");
   } else {
+    // Unlink any previous cache file instead of truncating it: other processes
+    // may still have it mapped and truncating it under them would corrupt
+    // their view (SIGBUS on access). They keep the old inode alive while the
+    // new cache is built in a fresh file.
+    std::remove(file_path_.c_str());
     fd_ = FileDescriptor::Open(file_path_.c_str(), O_CREAT | O_TRUNC | O_RDWR,
                                0644);
   }
@@ -436,6 +436,34 @@ TEST(WeightCacheBuilderTest, NonExistingPathFails) {
   EXPECT_FALSE(builder.Start("/seldf/sedsft"));
 }
 
+TEST(WeightCacheBuilderTest, RebuildDoesNotClobberExistingMappings) {
+  const std::string payload = "This is some data in the file.";
+  const PackIdentifier dummy_id{1, 2, 3};
+  const std::string cache_path = testing::TempDir() + "/rebuild_cache";
+
+  {
+    WeightCacheBuilder builder;
+    ASSERT_TRUE(builder.Start(cache_path.c_str()));
+    ASSERT_TRUE(builder.StartBuildStep());
+    builder.Append(dummy_id, payload.c_str(), payload.size());
+    ASSERT_TRUE(builder.StopBuildStep());
+  }
+
+  MMapHandle handle;
+  ASSERT_TRUE(handle.Map(cache_path.c_str()));
+  const std::string mapped_before(reinterpret_cast<const char*>(handle.data()),
+                                  handle.size());
+
+  // Starting a new build on the same path must not truncate the file that is
+  // still mapped.
+  WeightCacheBuilder builder;
+  ASSERT_TRUE(builder.Start(cache_path.c_str()));
+
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(handle.data()),
+                        handle.size()),
+            mapped_before);
+}
+
 TEST(WeightCacheBuilderTest, InMemoryCacheTriggeredByCorrectPrefix) {
   if (!TfLiteXNNPackDelegateCanUseInMemoryWeightCacheProvider()) {
     GTEST_SKIP() << "In-memory weight cache isn't enabled for this build or "
@@ -1241,28 +1241,37 @@ class Subgraph {
 
     if (enable_subgraph_reshaping) {
       xnn_status status = xnn_status_invalid_state;
-      for (int i = 0; i < inputs_.size(); ++i) {
-        const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
-        const int dims_count = NumDimensions(tensor);
-        std::array<size_t, XNN_MAX_TENSOR_DIMS> xnn_dims;
-        std::copy(&tensor->dims->data[0], &tensor->dims->data[dims_count],
-                  xnn_dims.begin());
-        status = xnn_reshape_external_value(
-            runtime_.get(), tflite_tensor_to_xnnpack_[inputs_[i]], dims_count,
-            xnn_dims.data());
+      if (InputShapesChanged(context) || !runtime_reshaped_) {
+        for (int i = 0; i < inputs_.size(); ++i) {
+          const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
+          const int dims_count = NumDimensions(tensor);
+          std::array<size_t, XNN_MAX_TENSOR_DIMS> xnn_dims;
+          std::copy(&tensor->dims->data[0], &tensor->dims->data[dims_count],
+                    xnn_dims.begin());
+          status = xnn_reshape_external_value(
+              runtime_.get(), tflite_tensor_to_xnnpack_[inputs_[i]],
+              dims_count, xnn_dims.data());
+          if (status != xnn_status_success) {
+            TF_LITE_KERNEL_LOG(
+                context, "XNNPack delegate failed to reshape external value");
+            runtime_reshaped_ = false;
+            return kTfLiteError;
+          }
+        }
+        status = xnn_reshape_runtime(runtime_.get());
         if (status != xnn_status_success) {
-          TF_LITE_KERNEL_LOG(
-              context, "XNNPack delegate failed to reshape external value");
+          TF_LITE_KERNEL_LOG(context,
+                             "XNNPack delegate failed to reshape runtime");
+          runtime_reshaped_ = false;
           return kTfLiteError;
         }
-        // signal that setup must be called.
-        externals_[inputs_[i]] = nullptr;
+        runtime_reshaped_ = true;
       }
-      status = xnn_reshape_runtime(runtime_.get());
-      if (status != xnn_status_success) {
-        TF_LITE_KERNEL_LOG(context,
-                           "XNNPack delegate failed to reshape runtime");
-        return kTfLiteError;
+      // Signal that setup must be called. This is needed even if this runtime
+      // was not reshaped, since reshaping another runtime may have moved the
+      // shared workspace.
+      for (int i = 0; i < inputs_.size(); ++i) {
+        externals_[inputs_[i]] = nullptr;
       }
 
       for (int i = 0; i < outputs_.size(); ++i) {
@@ -1292,6 +1301,23 @@ class Subgraph {
     return kTfLiteOk;
   }
 
+  // Returns whether the shapes of the input tensors differ from those the
+  // runtime was last reshaped for, and records the current shapes.
+  bool InputShapesChanged(TfLiteContext* context) {
+    bool changed = reshaped_input_dims_.size() != inputs_.size();
+    reshaped_input_dims_.resize(inputs_.size());
+    for (int i = 0; i < inputs_.size(); ++i) {
+      const TfLiteIntArray* dims = context->tensors[inputs_[i]].dims;
+      std::vector<int>& reshaped_dims = reshaped_input_dims_[i];
+      if (!std::equal(reshaped_dims.begin(), reshaped_dims.end(), dims->data,
+                      dims->data + dims->size)) {
+        reshaped_dims.assign(dims->data, dims->data + dims->size);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
   TfLiteStatus Invoke(TfLiteContext* context, bool enable_subgraph_reshaping,
                       Delegate* delegate) {
     std::lock_guard<std::mutex> lock(delegate->workspace_mutex_);
@@ -7145,6 +7171,11 @@ class Subgraph {
   // The output tensors to the XNNPack partition. Not all node output tensors
   // are consumed by XNNPack.
   std::vector<int> outputs_;
+  // Shapes of `inputs_` the runtime was last reshaped for. Reshaping is
+  // skipped in Prepare() while they are unchanged.
+  std::vector<std::vector<int>> reshaped_input_dims_;
+  // Whether the last attempt to reshape the runtime succeeded.
+  bool runtime_reshaped_ = false;
   // Mapping from TFLite Tensor IDs for tensors in the delegated subgraph to
   // the XNNPACK ID.
   std::unordered_map<int, uint32_t> tflite_tensor_to_xnnpack_;
@@ -113,7 +113,8 @@ void update_slice(int current_dim, int max_dim, const int32_t* output_stride,
   if (current_dim == max_dim) return;
   if (current_dim == max_dim - 1) {
     output += indices_data[current_dim] * output_stride[current_dim];
-    memcpy(output, update, update_shape[max_dim - 1] * sizeof(T));
+    memcpy(output, update,
+           update_shape[max_dim - 1] * output_stride[max_dim - 1] * sizeof(T));
   } else {
     output += indices_data[current_dim] * output_stride[current_dim];
     for (int i = 0; i < update_shape[current_dim]; ++i) {
@@ -166,7 +167,16 @@ void DynamicUpdateSlice(const TfLiteTensor* input, const TfLiteTensor* update,
     output_stride[i] = output_stride[i + 1] * input_shape_data[i + 1];
     update_stride[i] = update_stride[i + 1] * update_shape_data[i + 1];
   }
-  update_slice(0, input_dims, output_stride.data(), update_stride.data(),
+  // Trailing dimensions fully covered by the update are contiguous in both the
+  // output and the update, so they are copied together with the innermost
+  // partially updated dimension. E.g. a [batch, 1, heads, dim] update into a
+  // [batch, seq, heads, dim] KV cache is one memcpy per batch.
+  int copy_dims = input_dims;
+  while (copy_dims > 1 &&
+         update_shape_data[copy_dims - 1] == input_shape_data[copy_dims - 1]) {
+    --copy_dims;
+  }
+  update_slice(0, copy_dims, output_stride.data(), update_stride.data(),
                update_shape.DimsData(), update_data,
                clamped_start_indices.data(), output_data);
 }
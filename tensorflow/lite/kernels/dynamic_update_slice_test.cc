@@ -147,6 +147,21 @@ TEST(DynamicUpdateSliceOpTest, SimpleTestF32) {
                                                7, -2, 9})));
 }
 
+TEST(DynamicUpdateSliceOpTest, FullTrailingDimsTestF32) {
+  DynamicUpdateSliceOpModel m({TensorType_FLOAT32, {2, 3, 2}},
+                              {TensorType_FLOAT32, {2, 1, 2}},
+                              {TensorType_INT32, {3}});
+  m.SetInput<float>({1, 2, 3, 4, 5, 6,  //
+                     7, 8, 9, 10, 11, 12});
+  m.SetUpdate<float>({-1, -2,  //
+                      -3, -4});
+  m.SetStartIndices<int32_t>({0, 1, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput<float>(),
+              ElementsAreArray(ArrayFloatNear({1, 2, -1, -2, 5, 6,  //
+                                               7, 8, -3, -4, 11, 12})));
+}
+
 TEST(DynamicUpdateSliceOpTest, SimpleTestI1) {
   DynamicUpdateSliceOpModel m({TensorType_BOOL, {3, 3}},
                               {TensorType_BOOL, {2, 1}},
@@ -35,7 +35,7 @@ class GatherOpModel : public SingleOpModel {
   GatherOpModel(const TensorData& input, const TensorData& positions,
                 bool constant_tensor, const std::vector<InputType>& input_data,
                 const std::vector<PositionsType>& positions_data, int axis = 0,
-                int batch_dims = 0) {
+                int batch_dims = 0, int num_threads = -1) {
     if (constant_tensor) {
       input_ = AddConstInput(input, input_data);
       positions_ = AddConstInput(positions, positions_data);
@@ -46,7 +46,9 @@ class GatherOpModel : public SingleOpModel {
     output_ = AddOutput(input.type);
     SetBuiltinOp(BuiltinOperator_GATHER, BuiltinOptions_GatherOptions,
                  CreateGatherOptions(builder_, axis, batch_dims).Union());
-    BuildInterpreter({GetShape(input_), GetShape(positions_)});
+    BuildInterpreter({GetShape(input_), GetShape(positions_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
     if (!constant_tensor) {
       if (input.type == TensorType_INT4) {
         SetInputInt4(input_, input_data,
@@ -206,6 +208,43 @@ TEST_P(GatherOpTest, Axis1) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 2, 3}));
 }
 
+TEST_P(GatherOpTest, LargeMultiThreaded) {
+  bool constant_tensor = GetParam();
+  // Large enough for the copy to be split across threads.
+  const int outer_size = 8;
+  const int axis_size = 16;
+  const int inner_size = 1024;
+  std::vector<float> input_data(outer_size * axis_size * inner_size);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = i;
+  }
+  for (const int axis : {0, 1}) {
+    const std::vector<int32_t> positions =
+        axis == 0 ? std::vector<int32_t>{7, 0, 3, 3, 5, 1}
+                  : std::vector<int32_t>{15, 2, 2, 9, 0, 11};
+    std::vector<float> expected;
+    const int outer = axis == 0 ? 1 : outer_size;
+    const int gathered = axis == 0 ? outer_size : axis_size;
+    const int inner = axis == 0 ? axis_size * inner_size : inner_size;
+    for (int o = 0; o < outer; ++o) {
+      for (const int p : positions) {
+        for (int i = 0; i < inner; ++i) {
+          expected.push_back((o * gathered + p) * inner + i);
+        }
+      }
+    }
+    for (int num_threads = 1; num_threads <= 4; ++num_threads) {
+      GatherOpModel<float, int32_t> m(
+          {TensorType_FLOAT32, {outer_size, axis_size, inner_size}},
+          {TensorType_INT32, {static_cast<int>(positions.size())}},
+          constant_tensor, input_data, positions, axis, /*batch_dims=*/0,
+          num_threads);
+      ASSERT_EQ(m.Invoke(), kTfLiteOk);
+      EXPECT_THAT(m.GetOutput(), ElementsAreArray(expected));
+    }
+  }
+}
+
 TEST_P(GatherOpTest, Axis10DIndex) {
   bool constant_tensor = GetParam();
   const int axis = 1;
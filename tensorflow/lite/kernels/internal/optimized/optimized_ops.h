@@ -8022,6 +8022,129 @@ inline void AddN(const RuntimeShape& input_shape, const size_t num_inputs,
   }
 }
 
+// Gathers the slices in [start, end) of a Gather flattened to an input of
+// shape [outer_size, axis_size, inner_size] and coordinates of shape
+// [coord_size]. Slices are split along the outer dimension, or along the
+// coordinates if the outer dimension is 1.
+template <typename T, typename CoordsT>
+struct GatherWorkerTask : cpu_backend_threadpool::Task {
+  GatherWorkerTask(const T* input_data, const CoordsT* coords_data,
+                   T* output_data, int axis_size, int coord_size,
+                   int inner_size, bool split_outer, int start, int end)
+      : input_data(input_data),
+        coords_data(coords_data),
+        output_data(output_data),
+        axis_size(axis_size),
+        coord_size(coord_size),
+        inner_size(inner_size),
+        split_outer(split_outer),
+        start(start),
+        end(end) {}
+  void Run() override {
+    tflite::GatherParams op_params;
+    op_params.axis = 1;
+    op_params.batch_dims = 0;
+    const int length = end - start;
+    if (split_outer) {
+      const int64_t input_offset =
+          static_cast<int64_t>(start) * axis_size * inner_size;
+      const int64_t output_offset =
+          static_cast<int64_t>(start) * coord_size * inner_size;
+      status = reference_ops::Gather(
+          op_params, RuntimeShape({length, axis_size, inner_size}),
+          input_data + input_offset, RuntimeShape({coord_size}), coords_data,
+          RuntimeShape({length, coord_size, inner_size}),
+          output_data + output_offset);
+    } else {
+      status = reference_ops::Gather(
+          op_params, RuntimeShape({1, axis_size, inner_size}), input_data,
+          RuntimeShape({length}), coords_data + start,
+          RuntimeShape({1, length, inner_size}),
+          output_data + static_cast<int64_t>(start) * inner_size);
+    }
+  }
+
+  const T* input_data;
+  const CoordsT* coords_data;
+  T* output_data;
+  int axis_size;
+  int coord_size;
+  int inner_size;
+  bool split_outer;
+  int start;
+  int end;
+  TfLiteStatus status = kTfLiteOk;
+};
+
+// Multi-threaded Gather. Large gathers without batch dimensions are split
+// across the CpuBackendContext threads; everything else uses the
+// single-threaded reference implementation.
+template <typename T, typename CoordsT>
+inline TfLiteStatus Gather(const tflite::GatherParams& op_params,
+                           const RuntimeShape& input_shape, const T* input_data,
+                           const RuntimeShape& coords_shape,
+                           const CoordsT* coords_data,
+                           const RuntimeShape& output_shape, T* output_data,
+                           bool int4_input,
+                           CpuBackendContext* cpu_backend_context) {
+  // Minimum number of bytes copied per task for threading to pay off.
+  constexpr int64_t kMinBytesPerThread = 64 * 1024;
+
+  const int dims_count = input_shape.DimensionsCount();
+  int axis = op_params.axis;
+  if (axis < 0) {
+    axis += dims_count;
+  }
+  const int max_threads =
+      cpu_backend_context ? cpu_backend_context->max_num_threads() : 1;
+  if (int4_input || op_params.batch_dims != 0 || max_threads <= 1 ||
+      axis < 0 || axis >= dims_count) {
+    return reference_ops::Gather(op_params, input_shape, input_data,
+                                 coords_shape, coords_data, output_shape,
+                                 output_data, int4_input);
+  }
+
+  int outer_size = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int inner_size = 1;
+  for (int i = axis + 1; i < dims_count; ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+  const int axis_size = input_shape.Dims(axis);
+  const int coord_size = coords_shape.FlatSize();
+
+  const int64_t total_bytes = static_cast<int64_t>(outer_size) * coord_size *
+                              inner_size * sizeof(T);
+  const bool split_outer = outer_size > 1;
+  const int work_items = split_outer ? outer_size : coord_size;
+  const int thread_count = static_cast<int>(std::min<int64_t>(
+      {static_cast<int64_t>(max_threads), static_cast<int64_t>(work_items),
+       total_bytes / kMinBytesPerThread}));
+  if (thread_count <= 1) {
+    return reference_ops::Gather(op_params, input_shape, input_data,
+                                 coords_shape, coords_data, output_shape,
+                                 output_data, int4_input);
+  }
+
+  std::vector<GatherWorkerTask<T, CoordsT>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int end = start + (work_items - start) / (thread_count - i);
+    tasks.emplace_back(input_data, coords_data, output_data, axis_size,
+                       coord_size, inner_size, split_outer, start, end);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+  for (const auto& task : tasks) {
+    TF_LITE_ENSURE_STATUS(task.status);
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 
@@ -177,6 +177,24 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
   Index<IndexType> batch_index(num_batch_dims);
   Index<IndexType> offset_index(data->num_offset_dims);
+
+  const DataType* operand_data = GetTensorData<DataType>(operand);
+  DataType* result_data = GetTensorData<DataType>(output);
+  const RuntimeShape output_shape = GetTensorShape(output);
+
+  // If the innermost result dimension is an offset dimension and the innermost
+  // operand dimension is not collapsed, the two correspond to each other. Each
+  // innermost row of the result is then a contiguous run of the operand and
+  // is copied at once.
+  int64_t row_size = 1;
+  if (result_rank > 0 &&
+      ArrayContains(data->offset_dims, data->num_offset_dims,
+                    result_rank - 1) &&
+      !ArrayContains(data->collapsed_slice_dims,
+                     data->num_collapsed_slice_dims, operand_rank - 1)) {
+    row_size = std::max(1, result_runtime_shape.Dims(result_rank - 1));
+  }
+
   do {
     TF_LITE_ENSURE_OK(
         context, SetBatchAndOffsetIndices(result_index, data->offset_dims,
@@ -204,16 +222,17 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     Index<IndexType> operand_lookup_index =
         AddIndices(final_starting_index, full_offset_index);
 
-    const DataType* operand_data = GetTensorData<DataType>(operand);
     IndexType flat_operand_index =
         TensorIndexToFlat(operand_lookup_index.data(),
-                          operand_lookup_index.size(), GetTensorShape(operand));
-    DataType looked_up_value = operand_data[flat_operand_index];
-
-    DataType* result_data = GetTensorData<DataType>(output);
+                          operand_lookup_index.size(), operand_shape);
     IndexType flat_result_index = TensorIndexToFlat(
-        result_index.data(), result_index.size(), GetTensorShape(output));
-    result_data[flat_result_index] = looked_up_value;
+        result_index.data(), result_index.size(), output_shape);
+    std::copy_n(operand_data + flat_operand_index, row_size,
+                result_data + flat_result_index);
+    if (row_size > 1) {
+      // Skip the rest of the row; NextIndex() moves on to the next one.
+      result_index[result_rank - 1] += row_size - 1;
+    }
   } while (NextIndex(result_rank, result_runtime_shape.DimsData(),
                      result_index.data()));
 
@@ -597,6 +597,7 @@ void PrintInterpreterState(const Interpreter* interpreter,
   printf("--------------Memory Arena Status Start--------------\n");
   size_t total_arena_memory_bytes = 0;
   size_t total_dynamic_memory_bytes = 0;
+  size_t total_persistent_ro_bytes = 0;
   size_t total_resource_bytes = 0;
 
   for (int i = 0; i < num_subgraphs; ++i) {
@@ -606,13 +607,15 @@ void PrintInterpreterState(const Interpreter* interpreter,
     total_arena_memory_bytes += alloc_info.arena_size;
     total_arena_memory_bytes += alloc_info.arena_persist_size;
     total_dynamic_memory_bytes += alloc_info.dynamic_size;
+    total_persistent_ro_bytes += alloc_info.persistent_ro_size;
     // Resources are shared with all subgraphs. So calculate it only once.
     if (i == 0) {
       total_resource_bytes = alloc_info.resource_size;
     }
   }
   size_t total_memory_bytes = total_arena_memory_bytes +
-                              total_dynamic_memory_bytes + total_resource_bytes;
+                              total_dynamic_memory_bytes +
+                              total_persistent_ro_bytes + total_resource_bytes;
   printf("Total memory usage: %zu bytes (%.3f MB)\n", total_memory_bytes,
          static_cast<float>(total_memory_bytes) / (1 << 20));
   printf("- Total arena memory usage: %zu bytes (%.3f MB)\n",
@@ -621,6 +624,11 @@ void PrintInterpreterState(const Interpreter* interpreter,
   printf("- Total dynamic memory usage: %zu bytes (%.3f MB)\n",
          total_dynamic_memory_bytes,
          static_cast<float>(total_dynamic_memory_bytes) / (1 << 20));
+  if (total_persistent_ro_bytes) {
+    printf("- Total persistent read-only memory usage: %zu bytes (%.3f MB)\n",
+           total_persistent_ro_bytes,
+           static_cast<float>(total_persistent_ro_bytes) / (1 << 20));
+  }
   if (total_resource_bytes) {
     printf("- Total resource memory usage: %zu bytes (%.3f MB)\n",
            total_resource_bytes,
@@ -650,6 +658,12 @@ void PrintInterpreterState(const Interpreter* interpreter,
              static_cast<float>(alloc_info.dynamic_size * 100) /
                  total_memory_bytes);
     }
+    if (alloc_info.persistent_ro_size) {
+      printf("Subgraph#%-3d %-18s %10zu (%.2f%%)\n", i, "Persistent RO",
+             alloc_info.persistent_ro_size,
+             static_cast<float>(alloc_info.persistent_ro_size * 100) /
+                 total_memory_bytes);
+    }
   }
   printf("--------------Memory Arena Status End--------------\n\n");
 }
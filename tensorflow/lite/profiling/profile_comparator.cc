@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/profile_comparator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/profiling/proto/profiling_info.pb.h"
+
+namespace tflite {
+namespace profiling {
+
+namespace {
+
+using OpKey = std::pair<std::string, std::string>;
+
+void AddOps(const std::string& owner_name,
+            const google::protobuf::RepeatedPtrField<OpProfileData>& ops,
+            std::map<OpKey, const OpProfileData*>* op_map) {
+  for (const OpProfileData& op : ops) {
+    op_map->emplace(OpKey(owner_name, op.name()), &op);
+  }
+}
+
+std::map<OpKey, const OpProfileData*> GetOpMap(
+    const ModelProfilingData& profile) {
+  std::map<OpKey, const OpProfileData*> op_map;
+  for (const SubGraphProfilingData& subgraph : profile.subgraph_profiles()) {
+    const std::string owner_name =
+        subgraph.subgraph_name().empty()
+            ? "Subgraph " + std::to_string(subgraph.subgraph_index())
+            : subgraph.subgraph_name();
+    AddOps(owner_name, subgraph.per_op_profiles(), &op_map);
+  }
+  for (const DelegateProfilingData& delegate : profile.delegate_profiles()) {
+    AddOps(delegate.delegate_name(), delegate.per_op_profiles(), &op_map);
+  }
+  return op_map;
+}
+
+// Welch's t statistic for the difference of the means of `current` and
+// `baseline`.
+double WelchTStatistic(const OpProfilingStat& baseline,
+                       const OpProfilingStat& current) {
+  const double diff = static_cast<double>(current.avg()) - baseline.avg();
+  double variance_of_diff = 0.0;
+  if (baseline.count() > 0) {
+    variance_of_diff += static_cast<double>(baseline.stddev()) *
+                        baseline.stddev() / baseline.count();
+  }
+  if (current.count() > 0) {
+    variance_of_diff += static_cast<double>(current.stddev()) *
+                        current.stddev() / current.count();
+  }
+  if (variance_of_diff <= 0.0) {
+    if (diff == 0.0) return 0.0;
+    return diff > 0.0 ? std::numeric_limits<double>::infinity()
+                      : -std::numeric_limits<double>::infinity();
+  }
+  return diff / std::sqrt(variance_of_diff);
+}
+
+}  // namespace
+
+std::vector<OpRegression> FindOpRegressions(
+    const ModelProfilingData& baseline, const ModelProfilingData& current,
+    const ProfileComparisonOptions& options) {
+  const std::map<OpKey, const OpProfileData*> baseline_ops =
+      GetOpMap(baseline);
+  std::vector<OpRegression> regressions;
+  for (const auto& [key, current_op] : GetOpMap(current)) {
+    const auto it = baseline_ops.find(key);
+    if (it == baseline_ops.end()) continue;
+    const OpProfilingStat& baseline_stat =
+        it->second->inference_microseconds();
+    const OpProfilingStat& current_stat = current_op->inference_microseconds();
+    if (baseline_stat.avg() <= 0) continue;
+
+    const double relative_change =
+        (static_cast<double>(current_stat.avg()) - baseline_stat.avg()) /
+        baseline_stat.avg();
+    const double t_statistic = WelchTStatistic(baseline_stat, current_stat);
+    if (relative_change < options.min_relative_change ||
+        t_statistic < options.min_t_statistic) {
+      continue;
+    }
+    regressions.push_back({key.first, key.second, current_op->node_type(),
+                           static_cast<double>(baseline_stat.avg()),
+                           static_cast<double>(current_stat.avg()),
+                           relative_change, t_statistic});
+  }
+  std::sort(regressions.begin(), regressions.end(),
+            [](const OpRegression& a, const OpRegression& b) {
+              return a.relative_change > b.relative_change;
+            });
+  return regressions;
+}
+
+}  // namespace profiling
+}  // namespace tflite
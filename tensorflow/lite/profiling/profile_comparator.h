@@ -0,0 +1,61 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PROFILE_COMPARATOR_H_
+#define TENSORFLOW_LITE_PROFILING_PROFILE_COMPARATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/profiling/proto/profiling_info.pb.h"
+
+namespace tflite {
+namespace profiling {
+
+struct ProfileComparisonOptions {
+  // Minimum relative increase of an op's average latency to be reported, e.g.
+  // 0.03 for a 3% slowdown.
+  double min_relative_change = 0.03;
+  // Minimum Welch's t statistic of the slowdown for it to be considered
+  // significant rather than run-to-run noise.
+  double min_t_statistic = 3.0;
+};
+
+// An op whose average latency regressed between two profiles.
+struct OpRegression {
+  // Name of the subgraph, or of the delegate for delegate ops.
+  std::string owner_name;
+  std::string op_name;
+  std::string node_type;
+  double baseline_avg_us;
+  double current_avg_us;
+  // (current_avg_us - baseline_avg_us) / baseline_avg_us.
+  double relative_change;
+  double t_statistic;
+};
+
+// Compares the per-op latencies of `current` against `baseline`, e.g. two
+// runtime profiles written by benchmark_model with
+// --op_profiling_output_mode=proto, and returns the ops that got
+// significantly slower. Ops are matched by subgraph (or delegate) and op name;
+// ops present in only one of the profiles are ignored. The result is sorted by
+// decreasing relative change.
+std::vector<OpRegression> FindOpRegressions(
+    const ModelProfilingData& baseline, const ModelProfilingData& current,
+    const ProfileComparisonOptions& options = {});
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PROFILE_COMPARATOR_H_
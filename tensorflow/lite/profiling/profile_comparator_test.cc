@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/profile_comparator.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/proto/profiling_info.pb.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+void AddOp(SubGraphProfilingData* subgraph, const std::string& name,
+           int64_t avg_us, float stddev_us, int64_t count) {
+  OpProfileData* op = subgraph->add_per_op_profiles();
+  op->set_name(name);
+  op->set_node_type("CONV_2D");
+  OpProfilingStat* stat = op->mutable_inference_microseconds();
+  stat->set_avg(avg_us);
+  stat->set_stddev(stddev_us);
+  stat->set_count(count);
+}
+
+TEST(ProfileComparatorTest, ReportsSignificantSlowdowns) {
+  ModelProfilingData baseline;
+  SubGraphProfilingData* baseline_subgraph = baseline.add_subgraph_profiles();
+  baseline_subgraph->set_subgraph_name("Primary graph");
+  AddOp(baseline_subgraph, "conv", 1000, 10, 100);
+  AddOp(baseline_subgraph, "noisy", 1000, 500, 100);
+  AddOp(baseline_subgraph, "small", 1000, 10, 100);
+  AddOp(baseline_subgraph, "removed", 1000, 10, 100);
+
+  ModelProfilingData current;
+  SubGraphProfilingData* current_subgraph = current.add_subgraph_profiles();
+  current_subgraph->set_subgraph_name("Primary graph");
+  // 5% slower with low variance: a regression.
+  AddOp(current_subgraph, "conv", 1050, 10, 100);
+  // 5% slower but within noise.
+  AddOp(current_subgraph, "noisy", 1050, 500, 100);
+  // Significant but below the relative threshold.
+  AddOp(current_subgraph, "small", 1010, 10, 100);
+  AddOp(current_subgraph, "added", 5000, 10, 100);
+
+  const std::vector<OpRegression> regressions =
+      FindOpRegressions(baseline, current);
+  ASSERT_EQ(regressions.size(), 1);
+  EXPECT_EQ(regressions[0].owner_name, "Primary graph");
+  EXPECT_EQ(regressions[0].op_name, "conv");
+  EXPECT_EQ(regressions[0].node_type, "CONV_2D");
+  EXPECT_DOUBLE_EQ(regressions[0].baseline_avg_us, 1000);
+  EXPECT_DOUBLE_EQ(regressions[0].current_avg_us, 1050);
+  EXPECT_NEAR(regressions[0].relative_change, 0.05, 1e-9);
+  EXPECT_GT(regressions[0].t_statistic, 3.0);
+}
+
+TEST(ProfileComparatorTest, IgnoresSpeedups) {
+  ModelProfilingData baseline;
+  AddOp(baseline.add_subgraph_profiles(), "conv", 1000, 10, 100);
+  ModelProfilingData current;
+  AddOp(current.add_subgraph_profiles(), "conv", 500, 10, 100);
+
+  EXPECT_TRUE(FindOpRegressions(baseline, current).empty());
+}
+
+TEST(ProfileComparatorTest, SortsByRelativeChange) {
+  ModelProfilingData baseline;
+  SubGraphProfilingData* baseline_subgraph = baseline.add_subgraph_profiles();
+  AddOp(baseline_subgraph, "a", 1000, 0, 10);
+  AddOp(baseline_subgraph, "b", 1000, 0, 10);
+  ModelProfilingData current;
+  SubGraphProfilingData* current_subgraph = current.add_subgraph_profiles();
+  AddOp(current_subgraph, "a", 1100, 0, 10);
+  AddOp(current_subgraph, "b", 1500, 0, 10);
+
+  const std::vector<OpRegression> regressions =
+      FindOpRegressions(baseline, current);
+  ASSERT_EQ(regressions.size(), 2);
+  EXPECT_EQ(regressions[0].op_name, "b");
+  EXPECT_EQ(regressions[1].op_name, "a");
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -262,7 +262,7 @@ TfLiteStatus SimpleMemoryArena::Allocate(
     if (aligned_current_offset + size <= alloc.offset &&
         alloc.offset - aligned_current_offset < best_offset_fit) {
       best_offset = aligned_current_offset;
-      best_offset_fit = alloc.offset - current_offset;
+      best_offset_fit = alloc.offset - aligned_current_offset;
     }
     current_offset = std::max(current_offset, alloc.offset + alloc.size);
     // A gap of zero is as good as it gets, no point continuing.
@@ -93,6 +93,21 @@ class CompressionOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
         compressed, structure.type_spec_from_value(element))
     self.assertValuesEqual(element, self.evaluate(uncompressed))
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(element=_test_objects()),
+          combinations.combine(
+              codec=["snappy", "zstd", "none"], chunk_size_bytes=[0, 5])))
+  def testCompressionCodecs(self, element, codec, chunk_size_bytes):
+    element = element._obj
+
+    compressed = compression_ops.compress(
+        element, codec=codec, chunk_size_bytes=chunk_size_bytes)
+    uncompressed = compression_ops.uncompress(
+        compressed, structure.type_spec_from_value(element))
+    self.assertValuesEqual(element, self.evaluate(uncompressed))
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations(),
                          combinations.combine(element=_test_objects())) +
@@ -412,6 +412,41 @@ class DistributedSaveLoadTest(
                      "Snapshot chunks should be sorted by chunk indices.")
 
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              num_parallel_chunks=[1, 4],
+              max_buffered_bytes=[1, 16 << 10])))
+  def test_parallel_snapshot_chunks_order(
+      self, num_parallel_chunks: int, max_buffered_bytes: int):
+    cluster = data_service_test_base.TestCluster(
+        num_workers=3, snapshot_max_chunk_size_bytes=16)
+    snapshot_dir = data_service_test_base.TempDir()
+    dataset = dataset_ops.Dataset.range(100)
+    self.evaluate(
+        distributed_save_op.distributed_save(
+            dataset, snapshot_dir.full_path, cluster.dispatcher_address()))
+    dataset = dataset_ops.Dataset.load(snapshot_dir.full_path, wait=True)
+    self.getDatasetOutput(dataset)  # Waits for the snapshot to finish.
+
+    metadata = load_op._load_distributed_snapshot_metadata(
+        snapshot_dir.full_path)
+    element_spec = load_op._parse_element_spec(metadata.element_spec)
+    sequential = load_op._ListSnapshotChunksDataset(snapshot_dir.full_path)
+    sequential = sequential.flat_map(
+        lambda chunk_file: load_op._SnapshotChunkDataset(  # pylint:disable=g-long-lambda
+            chunk_file,
+            element_spec=element_spec,
+            compression=metadata.compression))
+    parallel = load_op._ParallelSnapshotChunksDataset(
+        snapshot_dir.full_path,
+        element_spec=element_spec,
+        compression=metadata.compression,
+        num_parallel_chunks=num_parallel_chunks,
+        max_buffered_bytes=max_buffered_bytes)
+    self.assertDatasetProduces(parallel, self.getDatasetOutput(sequential))
+
 class SaveLoadCheckpointTest(
     data_service_test_base.TestBase,
     checkpoint_test_base.CheckpointTestBase,
@@ -17,11 +17,15 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 
 
-def compress(element):
+def compress(element, codec="snappy", level=0, chunk_size_bytes=0):
   """Compress a dataset element.
 
   Args:
     element: A nested structure of types supported by Tensorflow.
+    codec: One of "snappy", "zstd" or "none".
+    level: Codec-specific compression level. 0 selects the codec's default.
+    chunk_size_bytes: If positive, the element is split into chunks of this
+      size which are compressed and uncompressed independently and in parallel.
 
   Returns:
     A variant tensor representing the compressed element. This variant can be
@@ -29,7 +33,8 @@ def compress(element):
   """
   element_spec = structure.type_spec_from_value(element)
   tensor_list = structure.to_tensor_list(element_spec, element)
-  return ged_ops.compress_element(tensor_list)
+  return ged_ops.compress_element(
+      tensor_list, codec=codec, level=level, chunk_size_bytes=chunk_size_bytes)
 
 
 def uncompress(element, output_spec):
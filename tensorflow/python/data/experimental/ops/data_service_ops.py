@@ -41,6 +41,11 @@ from tensorflow.python.util.tf_export import tf_export
 COMPRESSION_AUTO = "AUTO"
 COMPRESSION_NONE = None
 COMPRESSION_SNAPPY = "SNAPPY"
+COMPRESSION_ZSTD = "ZSTD"
+
+# Size of the independently compressed chunks of an element for codecs which
+# support parallel decompression.
+_COMPRESSION_CHUNK_SIZE_BYTES = 4 * 1024 * 1024
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
 
@@ -188,6 +193,7 @@ def _validate_compression(compression) -> None:
       COMPRESSION_AUTO,
       COMPRESSION_NONE,
       COMPRESSION_SNAPPY,
+      COMPRESSION_ZSTD,
   ]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
@@ -200,6 +206,8 @@ def _get_compression_proto(
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
   if compression == COMPRESSION_SNAPPY:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_FORCED_SNAPPY
+  if compression == COMPRESSION_ZSTD:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_ZSTD
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
   raise ValueError(f"Invalid `compression` argument: {compression}. "
@@ -500,7 +508,8 @@ def _distribute(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      snappy compression.
+      snappy compression. "ZSTD" uses ZSTD compression of chunks which are
+      decompressed in parallel, which suits large elements.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -760,7 +769,8 @@ def distribute(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      the use of snappy compression.
+      the use of snappy compression. "ZSTD" uses ZSTD compression of chunks
+      which are decompressed in parallel, which suits large elements.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -809,7 +819,8 @@ def _register_dataset(
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
       tf.data service runtime. `None` indicates not to compress. "SNAPPY" forces
-      the use of snappy compression.
+      the use of snappy compression. "ZSTD" uses ZSTD compression of chunks
+      which are decompressed in parallel, which suits large elements.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -842,6 +853,11 @@ def _register_dataset(
     dataset = dataset.map(
         lambda *x: compression_ops.compress(x),
         num_parallel_calls=dataset_ops.AUTOTUNE)
+  elif compression == COMPRESSION_ZSTD:
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(
+            x, codec="zstd", chunk_size_bytes=_COMPRESSION_CHUNK_SIZE_BYTES),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
   metadata = data_service_pb2.DataServiceMetadata(
@@ -899,7 +915,8 @@ def register_dataset(
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
       compress up to the tf.data service runtime. "SNAPPY" forces snappy
-      compression. `None` indicates not to compress.
+      compression. "ZSTD" uses ZSTD compression of chunks which are
+      decompressed in parallel. `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
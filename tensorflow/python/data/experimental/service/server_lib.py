@@ -315,7 +315,8 @@ class WorkerConfig(
     dispatcher_timeout_ms: How long, in milliseconds, to retry requests to the
       dispatcher before giving up and reporting an error. Defaults to 1 hour.
     data_transfer_protocol: A string indicating the protocol to be used by the
-      worker to transfer data to the client. E.g. "grpc".
+      worker to transfer data to the client. E.g. "grpc", or "shm" to serve
+      clients on the same host through shared memory.
     data_transfer_address: A string indicating the data transfer address of the
       worker server.
   """
@@ -45,11 +45,29 @@ def _load(  # pylint: disable=unused-private-name
     compression: Optional[str],
     reader_func: Optional[Callable[[dataset_ops.Dataset], dataset_ops.Dataset]],
     wait: bool,
+    parallel_chunk_reads: bool = False,
 ) -> dataset_ops.Dataset:
-  """Loads dataset from tf.data snapshot."""
+  """Loads dataset from tf.data snapshot.
+
+  If `parallel_chunk_reads` is true and no `reader_func` is given, the chunks of
+  a distributed snapshot are read concurrently and their elements are produced
+  chunk by chunk. By default the chunks are interleaved by `reader_func`.
+  """
 
   if wait:
-    return _load_with_retry(path, element_spec, compression, reader_func)
+    return _load_with_retry(
+        path, element_spec, compression, reader_func, parallel_chunk_reads)
+
+  distributed_snapshot_metadata = _load_distributed_snapshot_metadata(path)
+  if (distributed_snapshot_metadata and parallel_chunk_reads and
+      reader_func is None):
+    _validate_snapshot(
+        path, distributed_snapshot_metadata, element_spec, compression)
+    return _ParallelSnapshotChunksDataset(
+        path,
+        element_spec=_parse_element_spec(
+            distributed_snapshot_metadata.element_spec),
+        compression=distributed_snapshot_metadata.compression)
 
   if reader_func is None:
     reader_func = lambda datasets: datasets.interleave(  # pylint:disable=g-long-lambda
@@ -57,7 +75,6 @@ def _load(  # pylint: disable=unused-private-name
         cycle_length=multiprocessing.cpu_count(),
         num_parallel_calls=dataset_ops.AUTOTUNE)
 
-  distributed_snapshot_metadata = _load_distributed_snapshot_metadata(path)
   if distributed_snapshot_metadata:
     _validate_snapshot(
         path, distributed_snapshot_metadata, element_spec, compression)
@@ -75,17 +92,19 @@ def _load_with_retry(  # pylint: disable=unused-private-name
     compression: Optional[str] = None,
     reader_func: Optional[
         Callable[[dataset_ops.Dataset], dataset_ops.Dataset]] = None,
+    parallel_chunk_reads: bool = False,
 ) -> dataset_ops.Dataset:
   """Tries loading the snapshot. Retries if not found."""
 
   while True:
     try:
-      dataset = dataset_ops.Dataset.load(
+      dataset = _load(
           path=path,
           element_spec=element_spec,
           compression=compression,
           reader_func=reader_func,
-          wait=False)
+          wait=False,
+          parallel_chunk_reads=parallel_chunk_reads)
       logging.info("Load tf.data snapshot at %s.", path)
       return dataset
     except (errors.NotFoundError, FileNotFoundError):
@@ -241,6 +260,36 @@ class _ListSnapshotChunksDataset(dataset_ops.DatasetSource):
     return tensor_spec.TensorSpec([], dtypes.string)
 
 
+class _ParallelSnapshotChunksDataset(dataset_ops.DatasetSource):
+  """A dataset that reads all chunks of a tf.data distributed snapshot.
+
+  Up to `num_parallel_chunks` chunks are read and decompressed concurrently,
+  buffering at most `max_buffered_bytes` of elements. Elements are produced
+  chunk by chunk in the order the chunks are listed.
+  """
+
+  def __init__(
+      self,
+      snapshot_path: str,
+      element_spec: Any,
+      compression: str,
+      num_parallel_chunks: int = dataset_ops.AUTOTUNE,
+      max_buffered_bytes: int = dataset_ops.AUTOTUNE):
+    self._snapshot_path = snapshot_path
+    self._element_spec = element_spec
+    variant_tensor = ged_ops.parallel_snapshot_chunks_dataset(
+        snapshot_path,
+        num_parallel_chunks=num_parallel_chunks,
+        max_buffered_bytes=max_buffered_bytes,
+        compression=compression,
+        **self._flat_structure)
+    super().__init__(variant_tensor)
+
+  @property
+  def element_spec(self) -> Any:
+    return self._element_spec
+
+
 def _validate_snapshot(
     path: str,
     metadata: snapshot_pb2.DistributedSnapshotMetadata,
@@ -45,12 +45,16 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  HOST_AWARE: Similar to HILL_CLIMB but also caps the total parallelism at the
+  number of CPU cores that are not kept busy by other work on the host.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  HOST_AWARE = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +68,12 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.HOST_AWARE:
+      return model_pb2.AutotuneAlgorithm.HOST_AWARE
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `HOST_AWARE`. "
+        f"Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +87,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.HOST_AWARE:
+      return cls.HOST_AWARE
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `HOST_AWARE`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -241,6 +250,19 @@ class AutotuneOptions(options_lib.OptionsBase):
       ),
   )
 
+  state_path = options_lib.create_option(
+      name="state_path",
+      ty=str,
+      docstring=(
+          "When autotuning is enabled (through `autotune`), determines a"
+          " directory in which the tuned parameter values are saved, keyed by"
+          " the fingerprint of the input pipeline. A later iterator over the"
+          " same input pipeline, e.g. after the job restarts, starts from the"
+          " saved values instead of rediscovering them. If None, tuned values"
+          " are not persisted."
+      ),
+  )
+
   def _to_proto(self):
     pb = dataset_options_pb2.AutotuneOptions()
     if self.enabled is not None:
@@ -254,6 +276,8 @@ class AutotuneOptions(options_lib.OptionsBase):
           self.autotune_algorithm)
     if self.initial_parallelism is not None:
       pb.initial_parallelism = self.initial_parallelism
+    if self.state_path is not None:
+      pb.state_path = self.state_path
     return pb
 
   def _from_proto(self, pb):
@@ -268,6 +292,8 @@ class AutotuneOptions(options_lib.OptionsBase):
           pb.autotune_algorithm)
     if pb.WhichOneof("optional_initial_parallelism") is not None:
       self.initial_parallelism = pb.initial_parallelism
+    if pb.WhichOneof("optional_state_path") is not None:
+      self.state_path = pb.state_path
 
   def _set_mutable(self, mutable):
     """Change the mutability value to `mutable` on this options and children."""
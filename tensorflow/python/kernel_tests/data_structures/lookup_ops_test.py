@@ -136,6 +136,25 @@ class StaticHashTableTest(BaseLookupTableTest, parameterized.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([[0, 1], [-1, -1]], result)
 
+  def testStaticHashTableFindLargeBatch(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    default_val = -1
+    num_keys = 1000
+    keys = constant_op.constant(["key%d" % i for i in range(num_keys)])
+    values = constant_op.constant(np.arange(num_keys), dtypes.int64)
+    table = self.getHashTable()(
+        lookup_ops.KeyValueTensorInitializer(keys, values),
+        default_val,
+        experimental_is_anonymous=is_anonymous)
+    self.initialize_table(table)
+
+    # Large enough to be split across threads; every other key is missing.
+    ids = np.arange(100000) % (2 * num_keys)
+    input_string = constant_op.constant(["key%d" % i for i in ids])
+    result = self.evaluate(table.lookup(input_string))
+    self.assertAllEqual(np.where(ids < num_keys, ids, default_val), result)
+
   def testStaticHashTableInitWithPythonArrays(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
       self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
@@ -195,6 +195,16 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testLongRowTopK(self):
+    # Rows long enough to be split across threads, with many repeated values.
+    b = 2
+    n = 200000
+    inputs = np.random.randint(0, 1000, size=(b, n)).astype(np.int32)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :100]
+    values = -np.sort(-inputs, axis=1)[:, :100]
+    self._validateTopK(inputs, 100, values, indices)
+    self._validateTopK(inputs, 100, values, indices, sorted=False)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
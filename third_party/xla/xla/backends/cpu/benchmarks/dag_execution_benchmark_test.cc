@@ -15,9 +15,12 @@ limitations under the License.
 
 #include <cstdint>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/backends/cpu/benchmarks/hlo_benchmark_runner.h"
@@ -100,4 +103,62 @@ BENCHMARK(BM_DagExecution)
     ->Arg(8192)
     ->Arg(16384);
 
+static void BM_WideDagExecution(benchmark::State& state) {
+  int64_t width = state.range(0);
+  int64_t d0 = state.range(1);
+
+  // A wide and shallow graph of small independent fusions: each branch adds a
+  // constant to the parameter and reduces the result to a scalar. Every
+  // branch is cheap, so this benchmark measures how much ThunkExecutor
+  // scheduling overhead eats into the available parallelism.
+  std::string hlo = R"(
+    HloModule wide_dag_$width_$d0
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      p0 = f32[$d0] parameter(0)
+      c0 = f32[] constant(0)
+  )";
+
+  std::vector<std::string> results;
+  for (int64_t i = 0; i < width; ++i) {
+    absl::StrAppendFormat(&hlo,
+                          "c%d = f32[] constant(%d)\n"
+                          "bcast%d = f32[$d0] broadcast(c%d), dimensions={}\n"
+                          "add%d = f32[$d0] add(p0, bcast%d)\n"
+                          "r%d = f32[] reduce(add%d, c0), dimensions={0}, "
+                          "to_apply=add\n",
+                          i + 1, i + 1, i, i + 1, i, i, i, i);
+    results.push_back(absl::StrCat("r", i));
+  }
+  absl::StrAppend(&hlo, "ROOT out = (",
+                  absl::StrJoin(std::vector<std::string>(width, "f32[]"), ","),
+                  ") tuple(", absl::StrJoin(results, ","), ")\n}");
+
+  std::minstd_rand0 engine;
+
+  auto shape = ShapeUtil::MakeShape(F32, {d0});
+  auto p0 = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 1.0f, 0.1f);
+
+  std::vector<const Literal*> args = {&p0};
+  CHECK_OK(RunHloBenchmark(
+      state, hlo, args,
+      {{"$width", absl::StrCat(width)}, {"$d0", absl::StrCat(d0)}}));
+}
+
+BENCHMARK(BM_WideDagExecution)
+    ->MeasureProcessCPUTime()
+    ->ArgNames({"width", "d0"})
+    ->Args({16, 1024})
+    ->Args({16, 16384})
+    ->Args({64, 1024})
+    ->Args({64, 16384})
+    ->Args({256, 1024})
+    ->Args({256, 16384});
+
 }  // namespace xla::cpu
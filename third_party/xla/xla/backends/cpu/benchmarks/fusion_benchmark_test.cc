@@ -245,6 +245,38 @@ static void BM_ChainOfAddF32(benchmark::State& state) {
                             {"$additions", additions}}));
 }
 
+static void BM_FusionF32VectorWidth(benchmark::State& state) {
+  int64_t d0 = state.range(0);
+
+  HloBenchmarkOptions benchmark_options;
+  benchmark_options.prefer_vector_width = state.range(1);
+
+  // Elementwise fusion with a transcendental, emitted for different preferred
+  // vector widths. There is no autotuning for XLA:CPU fusions, and this is the
+  // way to find the best vector width for a given host by hand.
+  absl::string_view hlo = R"(
+    HloModule fusion_f32_vector_width_$d0
+
+    ENTRY e {
+      p0 = f32[$d0,1024] parameter(0)
+      p1 = f32[$d0,1024] parameter(1)
+      multiply = f32[$d0,1024] multiply(p0, p1)
+      exp = f32[$d0,1024] exponential(multiply)
+      ROOT add = f32[$d0,1024] add(exp, p0)
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto shape = ShapeUtil::MakeShape(F32, {d0, 1024});
+  auto p0 = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 1.0f, 0.1f);
+  auto p1 = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 1.0f, 0.1f);
+
+  std::vector<const Literal*> args = {&p0, &p1};
+  CHECK_OK(RunHloBenchmark(state, hlo, args, {{"$d0", absl::StrCat(d0)}},
+                           benchmark_options));
+}
+
 BENCHMARK(BM_FusionF32)
     ->MeasureProcessCPUTime()
     ->Arg(128)
@@ -287,4 +319,17 @@ BENCHMARK(BM_ChainOfAddF32)
     ->Arg(512)
     ->Arg(1024);
 
+BENCHMARK(BM_FusionF32VectorWidth)
+    ->MeasureProcessCPUTime()
+    ->ArgNames({"d0", "vector_width"})
+    ->Args({16, 128})
+    ->Args({16, 256})
+    ->Args({16, 512})
+    ->Args({256, 128})
+    ->Args({256, 256})
+    ->Args({256, 512})
+    ->Args({1024, 128})
+    ->Args({1024, 256})
+    ->Args({1024, 512});
+
 }  // namespace xla::cpu
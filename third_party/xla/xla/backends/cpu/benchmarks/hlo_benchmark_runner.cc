@@ -40,9 +40,25 @@ limitations under the License.
 #include "xla/tsl/platform/statusor.h"
 #include "xla/tsl/platform/test_benchmark.h"
 #include "xla/tsl/platform/threadpool.h"
+#include "xla/xla.pb.h"
 
 namespace xla::cpu {
 
+static CompileOptions GetCompileOptions(
+    const HloBenchmarkOptions& benchmark_options) {
+  CompileOptions compile_options;
+  DebugOptions* debug_options =
+      compile_options.executable_build_options.mutable_debug_options();
+  if (benchmark_options.disable_parallel_task_assigner) {
+    debug_options->add_xla_disable_hlo_passes("cpu-parallel-task-assigner");
+  }
+  if (benchmark_options.prefer_vector_width > 0) {
+    debug_options->set_xla_cpu_prefer_vector_width(
+        benchmark_options.prefer_vector_width);
+  }
+  return compile_options;
+}
+
 absl::Status RunHloBenchmark(benchmark::State& state,
                              absl::string_view hlo_module,
                              absl::Span<const Literal* const> args,
@@ -61,11 +77,7 @@ absl::Status RunHloBenchmark(benchmark::State& state,
   XlaComputation computation(module->ToProto());
 
   // Compile HLO module to executable.
-  CompileOptions compile_options;
-  if (benchmark_options.disable_parallel_task_assigner) {
-    compile_options.executable_build_options.mutable_debug_options()
-        ->add_xla_disable_hlo_passes("cpu-parallel-task-assigner");
-  }
+  CompileOptions compile_options = GetCompileOptions(benchmark_options);
   TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
                       client->Compile(computation, compile_options));
 
@@ -173,11 +185,7 @@ absl::Status CompileHloBenchmark(benchmark::State& state,
 
   XlaComputation computation(module->ToProto());
 
-  CompileOptions compile_options;
-  if (benchmark_options.disable_parallel_task_assigner) {
-    compile_options.executable_build_options.mutable_debug_options()
-        ->add_xla_disable_hlo_passes("cpu-parallel-task-assigner");
-  }
+  CompileOptions compile_options = GetCompileOptions(benchmark_options);
 
   for (auto _ : state) {
     TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
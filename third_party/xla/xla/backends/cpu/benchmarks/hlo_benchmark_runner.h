@@ -35,6 +35,10 @@ using StrToStrMapping =
 struct HloBenchmarkOptions {
   int32_t num_executions = 1;
   bool disable_parallel_task_assigner = false;
+
+  // If non-zero, overrides `xla_cpu_prefer_vector_width` to compare the
+  // performance of fusions emitted for different vector widths.
+  int32_t prefer_vector_width = 0;
 };
 
 // Runs the given HLO module as a benchmark.
@@ -65,6 +65,12 @@ absl::Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  // Record the module size after the pass, so that together with the pass
+  // timestamps the dumped metadata shows which passes grow the module and
+  // where compile time goes on large modules.
+  TF_RETURN_IF_ERROR(module.metadata()->set_key_value_metric(
+      std::string(HloPassPipeline::kInstructionCountMetric),
+      module.instruction_count()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return absl::OkStatus();
 }
@@ -37,6 +37,11 @@ namespace xla {
 // Pipeline of HLO passes.
 class HloPassPipeline : public HloPassInterface {
  public:
+  // Key of the per-pass metric holding the number of instructions in the
+  // module after the pass ran.
+  static constexpr absl::string_view kInstructionCountMetric =
+      "instruction_count";
+
   explicit HloPassPipeline(const std::string& name,
                            CompilationStats* compilation_stats = nullptr)
       : name_(name), compilation_stats_(compilation_stats) {
@@ -415,6 +415,11 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
       EXPECT_GT(pass_metadata.start_timestamp_usec(), 0);
       EXPECT_LE(pass_metadata.start_timestamp_usec(),
                 pass_metadata.end_timestamp_usec());
+      ASSERT_THAT(pass_metadata.kv_metrics(), SizeIs(1));
+      EXPECT_EQ(pass_metadata.kv_metrics(0).key(),
+                HloPassPipeline::kInstructionCountMetric);
+      EXPECT_EQ(pass_metadata.kv_metrics(0).value(),
+                module->instruction_count());
     }
   }
 }
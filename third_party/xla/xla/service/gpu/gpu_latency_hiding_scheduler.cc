@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/utils/hlo_query.h"
+#include "xla/layout.h"
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/cublas_cudnn.h"
@@ -102,6 +104,30 @@ std::pair<GpuResourceType, ResourceUsageType> GetP2PResourceAndUsage(
   return {resource, usage};
 }
 
+// Returns the resource for a copy-start/copy-done pair that moves data between
+// device and host memory. Offloads and prefetches travel in opposite
+// directions over PCIe, so they can overlap with each other, but concurrent
+// copies in the same direction share bandwidth and only delay each other.
+std::optional<GpuResourceType> GetHostTransferResource(
+    const HloInstruction& instr) {
+  const HloInstruction* start =
+      instr.opcode() == HloOpcode::kCopyDone ? instr.operand(0) : &instr;
+  if (start->opcode() != HloOpcode::kCopyStart) {
+    return std::nullopt;
+  }
+  auto is_host = [](const Shape& shape) {
+    return shape.has_layout() &&
+           shape.layout().memory_space() == Layout::kHostMemorySpace;
+  };
+  if (is_host(start->shape().tuple_shapes(0))) {
+    return GpuResourceType::kGpuAsyncStreamDeviceToHost;
+  }
+  if (is_host(start->operand(0)->shape())) {
+    return GpuResourceType::kGpuAsyncStreamHostToDevice;
+  }
+  return std::nullopt;
+}
+
 // Marks async start operations to be scheduled as early as possible.
 // It allows maximum overlap of operations while respecting dependencies.
 // Besides async collectives, copy-start is async memcpy D2H/H2D, the beginning
@@ -329,8 +355,15 @@ ResourcesVector GpuAsyncTracker::GetResourcesFromInstructionImpl(
   if (op.outer == HloOpcode::kAsyncStart || op.outer == HloOpcode::kAsyncDone) {
     ResourceUsageType usage;
     GpuResourceType resource;
+    std::optional<GpuResourceType> host_transfer_resource =
+        GetHostTransferResource(instr);
     if (op.inner == HloOpcode::kSend || op.inner == HloOpcode::kRecv) {
       std::tie(resource, usage) = GetP2PResourceAndUsage(instr, op);
+    } else if (host_transfer_resource.has_value()) {
+      usage = op.outer == HloOpcode::kAsyncStart
+                  ? ResourceUsageType::kResourceRelease
+                  : ResourceUsageType::kResourceOccupy;
+      resource = *host_transfer_resource;
     } else {
       usage = op.outer == HloOpcode::kAsyncStart
                   ? ResourceUsageType::kResourceRelease
@@ -404,6 +437,10 @@ absl::string_view GpuAsyncTracker::GetResourceName(
       return "kGpuAsyncStreamCollectives";
     case GpuResourceType::kGpuAsyncStreamComputes:
       return "kGpuAsyncStreamComputes";
+    case GpuResourceType::kGpuAsyncStreamDeviceToHost:
+      return "kGpuAsyncStreamDeviceToHost";
+    case GpuResourceType::kGpuAsyncStreamHostToDevice:
+      return "kGpuAsyncStreamHostToDevice";
     default:
       return "kUnsupportedResource";
   }
@@ -53,11 +53,13 @@ enum class GpuResourceType {
   kGpuAsyncStreamSend0 = ResourceTypeToIndex(
       ResourceType::kTargetDefinedResourceTypeBegin),  // A resource for P2P
                                                        // Send operation.
-  kGpuAsyncStreamSend1,        // Another resource for P2P Send operation.
-  kGpuAsyncStreamRecv0,        // A resource for P2P Recv operation.
-  kGpuAsyncStreamRecv1,        // Another resource for P2P Recv operation.
-  kGpuAsyncStreamCollectives,  // The resource for collective operations.
-  kGpuAsyncStreamComputes,     // The resource for async compute operations.
+  kGpuAsyncStreamSend1,         // Another resource for P2P Send operation.
+  kGpuAsyncStreamRecv0,         // A resource for P2P Recv operation.
+  kGpuAsyncStreamRecv1,         // Another resource for P2P Recv operation.
+  kGpuAsyncStreamCollectives,   // The resource for collective operations.
+  kGpuAsyncStreamComputes,      // The resource for async compute operations.
+  kGpuAsyncStreamDeviceToHost,  // The resource for copies to host memory.
+  kGpuAsyncStreamHostToDevice,  // The resource for copies from host memory.
   kGpuResourceTypeEnd,
 };
 
@@ -31,6 +31,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/service/gpu/gpu_hlo_schedule.h"
 #include "xla/service/hlo_module_config.h"
+#include "xla/service/latency_hiding_scheduler.h"
 #include "xla/service/profile_guided_latency_estimator.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/tsl/lib/core/status_test_util.h"
@@ -41,6 +42,8 @@ limitations under the License.
 namespace xla::gpu {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::Pair;
 using ::testing::Property;
 using ::testing::UnorderedElementsAre;
 using ::tsl::testing::StatusIs;
@@ -552,5 +555,40 @@ TEST_F(GpuLatencyHidingSchedulerBaseTest, SchedulePipelinedSendRecvsLate) {
             GetIndexByName(while_body_instrs, "some_res"));
 }
 
+TEST_F(GpuLatencyHidingSchedulerBaseTest,
+       HostOffloadCopiesUseDirectionalResources) {
+  absl::string_view kHloModule = R"(
+    HloModule m
+
+    ENTRY main {
+      p0 = f32[1024]{0} parameter(0)
+      offload_start = (f32[1024]{0:S(5)}, f32[1024]{0}, u32[]) copy-start(p0)
+      offload_done = f32[1024]{0:S(5)} copy-done(offload_start)
+      prefetch_start = (f32[1024]{0}, f32[1024]{0:S(5)}, u32[]) copy-start(offload_done)
+      ROOT prefetch_done = f32[1024]{0} copy-done(prefetch_start)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloModule));
+  GpuAsyncTracker tracker(SchedulerConfig{});
+
+  auto resources = [&](absl::string_view name) {
+    return tracker.GetResourcesFromInstruction(
+        *FindInstruction(module.get(), name));
+  };
+  auto d2h = ResourceTypeToIndex(GpuResourceType::kGpuAsyncStreamDeviceToHost);
+  auto h2d = ResourceTypeToIndex(GpuResourceType::kGpuAsyncStreamHostToDevice);
+
+  EXPECT_THAT(resources("offload_start"),
+              ElementsAre(Pair(d2h, ResourceUsageType::kResourceRelease)));
+  EXPECT_THAT(resources("offload_done"),
+              ElementsAre(Pair(d2h, ResourceUsageType::kResourceOccupy)));
+  EXPECT_THAT(resources("prefetch_start"),
+              ElementsAre(Pair(h2d, ResourceUsageType::kResourceRelease)));
+  EXPECT_THAT(resources("prefetch_done"),
+              ElementsAre(Pair(h2d, ResourceUsageType::kResourceOccupy)));
+}
+
 }  // namespace
 }  // namespace xla::gpu
@@ -1289,18 +1289,25 @@ absl::Status CoordinationServiceStandaloneImpl::InsertKeyValue(
   VLOG(3) << "InsertKeyValue(): " << key << ": " << value
           << " allow_overwrite: " << allow_overwrite;
   const std::string norm_key = NormalizeKey(key);
-  absl::MutexLock l(&kv_mu_);
-  if (!allow_overwrite && kv_store_.find(norm_key) != kv_store_.end()) {
-    return MakeCoordinationError(absl::AlreadyExistsError(
-        absl::StrCat("Config key ", key, " already exists.")));
-  }
-  kv_store_.insert_or_assign(norm_key, value);
-  auto iter = get_cb_.find(norm_key);
-  if (iter != get_cb_.end()) {
-    for (const auto& cb : iter->second) {
-      cb(value);
+  std::vector<StatusOrValueCallback> callbacks;
+  {
+    absl::MutexLock l(&kv_mu_);
+    if (!allow_overwrite && kv_store_.find(norm_key) != kv_store_.end()) {
+      return MakeCoordinationError(absl::AlreadyExistsError(
+          absl::StrCat("Config key ", key, " already exists.")));
+    }
+    kv_store_.insert_or_assign(norm_key, value);
+    auto iter = get_cb_.find(norm_key);
+    if (iter != get_cb_.end()) {
+      callbacks = std::move(iter->second);
+      get_cb_.erase(iter);
     }
-    get_cb_.erase(iter);
+  }
+  // Run the callbacks of pending GetKeyValue() calls outside of `kv_mu_`: they
+  // send RPC responses, and with many tasks waiting on the same key they
+  // would otherwise block all other key-value operations.
+  for (const auto& cb : callbacks) {
+    cb(value);
   }
   return absl::OkStatus();
 }
@@ -1309,18 +1316,17 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
     std::string_view key, StatusOrValueCallback done) {
   VLOG(3) << "GetKeyValue(): " << key;
   const std::string norm_key = NormalizeKey(key);
-  absl::MutexLock l(&kv_mu_);
-  const auto& iter = kv_store_.find(norm_key);
-  if (iter != kv_store_.end()) {
-    done(iter->second);
-    return;
-  }
-  auto cb_iter = get_cb_.find(norm_key);
-  if (cb_iter == get_cb_.end()) {
-    cb_iter =
-        get_cb_.emplace(norm_key, std::vector<StatusOrValueCallback>()).first;
+  std::string value;
+  {
+    absl::MutexLock l(&kv_mu_);
+    const auto& iter = kv_store_.find(norm_key);
+    if (iter == kv_store_.end()) {
+      get_cb_[norm_key].emplace_back(std::move(done));
+      return;
+    }
+    value = iter->second;
   }
-  cb_iter->second.emplace_back(std::move(done));
+  done(value);
 }
 
 absl::StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
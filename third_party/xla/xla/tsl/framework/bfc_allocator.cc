@@ -29,6 +29,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -53,6 +54,140 @@ const uint64_t kDefaultMemoryFilterMask = tsl::profiler::TraceMeFiltersToMask(
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+// Caches freed chunks of the small bins, so that allocations and deallocations
+// of common sizes do not contend on `BFCAllocator::mutex_`.
+//
+// Freed chunks go to one of `kNumShards` shards, picked per thread. A shard
+// only holds chunks of up to `max_bytes_per_shard` bytes in total; when it is
+// full, chunks are freed to the allocator as usual. Because deallocation only
+// knows the pointer, the size of each cacheable chunk handed out by the
+// allocator is recorded in a table striped by address.
+//
+// Chunks stay in use from the point of view of the allocator while they are
+// cached. Locks of this class may be acquired while holding
+// `BFCAllocator::mutex_`, but never the other way around.
+class BFCAllocator::ChunkCache {
+ public:
+  explicit ChunkCache(size_t max_bytes_per_shard)
+      : max_bytes_per_shard_(max_bytes_per_shard) {}
+
+  // Records that the chunk at `ptr` of `chunk_size` bytes was handed out.
+  void RecordSize(const void* ptr, size_t chunk_size) {
+    SizeStripe& stripe = StripeFor(ptr);
+    absl::MutexLock l(&stripe.mu);
+    stripe.sizes[ptr] = chunk_size;
+  }
+
+  // Forgets the size recorded for `ptr`, if any.
+  void EraseSize(const void* ptr) {
+    SizeStripe& stripe = StripeFor(ptr);
+    absl::MutexLock l(&stripe.mu);
+    stripe.sizes.erase(ptr);
+  }
+
+  // Returns a cached chunk of bin `bin_num` of at least `rounded_bytes`, or
+  // nullptr if there is none in the calling thread's shard.
+  void* Pop(BinNum bin_num, size_t rounded_bytes) {
+    Shard& shard = shards_[ShardIndex()];
+    absl::MutexLock l(&shard.mu);
+    std::vector<Entry>& entries = shard.bins[bin_num];
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+      if (it->size >= rounded_bytes) {
+        void* ptr = it->ptr;
+        shard.bytes -= it->size;
+        *it = entries.back();
+        entries.pop_back();
+        return ptr;
+      }
+    }
+    return nullptr;
+  }
+
+  // Caches the chunk at `ptr` and returns true if it is cacheable and the
+  // calling thread's shard has room for it. Otherwise forgets its size and
+  // returns false, and the caller must free the chunk.
+  bool Push(void* ptr) {
+    size_t size;
+    {
+      SizeStripe& stripe = StripeFor(ptr);
+      absl::MutexLock l(&stripe.mu);
+      auto it = stripe.sizes.find(ptr);
+      if (it == stripe.sizes.end()) return false;
+      size = it->second;
+      Shard& shard = shards_[ShardIndex()];
+      absl::MutexLock shard_lock(&shard.mu);
+      if (shard.bytes + size <= max_bytes_per_shard_) {
+        shard.bins[BinNumForSize(size)].push_back({ptr, size});
+        shard.bytes += size;
+        num_cached_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      stripe.sizes.erase(it);
+    }
+    return false;
+  }
+
+  // Removes every cached chunk and appends it to `ptrs`, forgetting its size.
+  void TakeAll(std::vector<void*>* ptrs) {
+    if (num_cached_.load(std::memory_order_relaxed) == 0) return;
+    const size_t begin = ptrs->size();
+    for (Shard& shard : shards_) {
+      absl::MutexLock l(&shard.mu);
+      for (std::vector<Entry>& entries : shard.bins) {
+        for (const Entry& entry : entries) {
+          ptrs->push_back(entry.ptr);
+        }
+        entries.clear();
+      }
+      shard.bytes = 0;
+    }
+    num_cached_.fetch_sub(ptrs->size() - begin, std::memory_order_relaxed);
+    for (size_t i = begin; i < ptrs->size(); ++i) {
+      EraseSize((*ptrs)[i]);
+    }
+  }
+
+ private:
+  static constexpr int kNumShards = 16;
+  static constexpr int kNumStripes = 64;
+
+  struct Entry {
+    void* ptr;
+    size_t size;
+  };
+
+  struct alignas(64) Shard {
+    absl::Mutex mu;
+    std::array<std::vector<Entry>, kNumCachedBins> bins ABSL_GUARDED_BY(mu);
+    size_t bytes ABSL_GUARDED_BY(mu) = 0;
+  };
+
+  struct alignas(64) SizeStripe {
+    absl::Mutex mu;
+    absl::flat_hash_map<const void*, size_t> sizes ABSL_GUARDED_BY(mu);
+  };
+
+  // Threads are assigned to shards round-robin on first use.
+  static int ShardIndex() {
+    static std::atomic<unsigned int> next_shard{0};
+    thread_local const int shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return shard;
+  }
+
+  SizeStripe& StripeFor(const void* ptr) {
+    // Chunks are at least `kMinAllocationSize`-aligned.
+    return stripes_[(reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits) %
+                    kNumStripes];
+  }
+
+  const size_t max_bytes_per_shard_;
+  // Approximate number of cached chunks, to skip flushing empty caches.
+  std::atomic<int64_t> num_cached_{0};
+  std::array<Shard, kNumShards> shards_;
+  std::array<SizeStripe, kNumStripes> stripes_;
+};
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -62,6 +197,9 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
+  if (opts.chunk_cache_bytes > 0) {
+    chunk_cache_ = std::make_unique<ChunkCache>(opts.chunk_cache_bytes);
+  }
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -278,6 +416,19 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (chunk_cache_ != nullptr && timing_counter_ == nullptr &&
+      allocation_attr.freed_by_func == nullptr && num_bytes > 0) {
+    const size_t rounded_bytes = RoundedBytes(num_bytes);
+    const BinNum bin_num = BinNumForSize(rounded_bytes);
+    if (bin_num < kNumCachedBins) {
+      void* ptr = chunk_cache_->Pop(bin_num, rounded_bytes);
+      if (ptr != nullptr) {
+        VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr
+                << " from the chunk cache";
+        return ptr;
+      }
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -457,6 +608,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Return the cached chunks to the bins before growing the pool.
+  if (FlushChunkCache()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -647,6 +807,11 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         }
 #endif
 
+        if (chunk_cache_ != nullptr && timing_counter_ == nullptr &&
+            BinNumForSize(chunk->size) < kNumCachedBins) {
+          chunk_cache_->RecordSize(chunk->ptr, chunk->size);
+        }
+
         VLOG(4) << "Returning: " << chunk->ptr;
         if (VLOG_IS_ON(4)) {
           LOG(INFO) << "A: " << RenderOccupancy();
@@ -703,6 +868,13 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (chunk_cache_ != nullptr && ptr != nullptr) {
+    if (timing_counter_ == nullptr) {
+      if (chunk_cache_->Push(ptr)) return;
+    } else {
+      chunk_cache_->EraseSize(ptr);
+    }
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -713,7 +885,22 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   absl::MutexLock l(&mutex_);
+  FreeChunk(ptr);
+}
+
+bool BFCAllocator::FlushChunkCache() {
+  if (chunk_cache_ == nullptr) return false;
+  std::vector<void*> ptrs;
+  chunk_cache_->TakeAll(&ptrs);
+  for (void* ptr : ptrs) {
+    FreeChunk(ptr);
+  }
+  if (ptrs.empty()) return false;
+  VLOG(2) << "Flushed " << ptrs.size() << " cached chunks of " << Name();
+  return true;
+}
 
+void BFCAllocator::FreeChunk(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -1169,6 +1356,8 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   mas->set_bytes_in_use(stats_.bytes_in_use);
   mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
   mas->set_largest_alloc_size(stats_.largest_alloc_size);
+  mas->set_pool_bytes(stats_.pool_bytes.value_or(0));
+  mas->set_largest_free_chunk(LargestFreeChunk());
 
   // Record summary data for every bin.
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
@@ -1187,9 +1376,21 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
   // Record state of every defined Chunk.
   for (const auto& region : region_manager_.regions()) {
+    tensorflow::RegionSummary* rs = md.add_region_summary();
+    rs->set_address(reinterpret_cast<uint64>(region.ptr()));
+    rs->set_size(region.memory_size());
+    int64_t bytes_in_use = 0;
+    int64_t largest_free_chunk = 0;
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
+      rs->set_num_chunks(rs->num_chunks() + 1);
+      if (c->in_use()) {
+        bytes_in_use += c->size;
+      } else {
+        largest_free_chunk =
+            std::max(largest_free_chunk, static_cast<int64_t>(c->size));
+      }
       tensorflow::MemChunk* mc = md.add_chunk();
       mc->set_in_use(c->in_use());
       mc->set_address(reinterpret_cast<uint64>(c->ptr));
@@ -1206,6 +1407,13 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
       }
       h = c->next;
     }
+    rs->set_bytes_in_use(bytes_in_use);
+    rs->set_largest_free_chunk(largest_free_chunk);
+    const int64_t free_bytes = region.memory_size() - bytes_in_use;
+    rs->set_fragmentation_metric(
+        free_bytes > 0
+            ? static_cast<double>(free_bytes - largest_free_chunk) / free_bytes
+            : 0);
   }
 
   mas->set_fragmentation_metric(GetFragmentation());
@@ -1225,6 +1433,35 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   return md;
 }
 
+size_t BFCAllocator::ReleaseFreeRegions() {
+  absl::MutexLock l(&mutex_);
+  FlushChunkCache();
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  absl::flat_hash_set<void*> free_region_ptrs;
+  size_t free_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    const Chunk* c = ChunkFromHandle(h);
+    // A free region that is not fragmented consists of a single free chunk,
+    // and timestamped chunks cannot be released yet.
+    if (!c->in_use() && c->next == kInvalidChunkHandle &&
+        c->freed_at_count == 0) {
+      free_region_ptrs.insert(region.ptr());
+      free_bytes += region.memory_size();
+    }
+  }
+  if (free_bytes == 0) {
+    return 0;
+  }
+  VLOG(1) << "Releasing " << free_region_ptrs.size() << " free regions of "
+          << Name() << " totaling "
+          << strings::HumanReadableNumBytes(free_bytes);
+  DeallocateRegions(free_region_ptrs);
+  return free_bytes;
+}
+
 std::optional<AllocatorStats> BFCAllocator::GetStats() {
   absl::MutexLock l(&mutex_);
   return stats_;
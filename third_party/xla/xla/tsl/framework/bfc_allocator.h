@@ -55,6 +55,10 @@ using tensorflow::MemoryDump;
 // all requests to allocate memory go through this interface.
 class BFCAllocator : public Allocator {
  public:
+  // Chunks in the bins of up to this size may be cached, see
+  // `Options::chunk_cache_bytes`.
+  static constexpr size_t kMaxCachedBinSize = size_t{1} << 20;
+
   struct Options {
     bool allow_growth = true;
 
@@ -73,6 +77,16 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, freed chunks of less than `2 * kMaxCachedBinSize` bytes are
+    // kept in caches shared by a few threads each, holding at most this many
+    // bytes per cache, and handed back out to allocations of the same bin
+    // without taking the allocator lock. Cached chunks count as in use in the
+    // allocator stats, and keep the requested size and allocation id of the
+    // allocation that first claimed them. The caches are flushed whenever an
+    // allocation cannot be satisfied from the free bins. Ignored once a timing
+    // counter is set.
+    size_t chunk_cache_bytes = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -112,6 +126,15 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the memory of every region without allocated chunks to the
+  // sub-allocator, after returning the cached chunks to the bins and merging
+  // the free chunks whose timestamps are safe. Live allocations cannot be
+  // moved, so this is meant to be called in idle windows, e.g. between the
+  // requests of a server, when most allocations are gone: regions obtained
+  // afterwards can then be allocated as fewer, larger regions. Returns the
+  // number of bytes released.
+  size_t ReleaseFreeRegions();
+
  private:
   struct Bin;
 
@@ -125,6 +148,13 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Frees the chunk at `ptr` into the bins, coalescing it if possible.
+  void FreeChunk(void* ptr) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns every chunk held by `chunk_cache_` to the bins. Returns true if any
+  // chunk was returned.
+  bool FlushChunkCache() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -166,6 +196,11 @@ class BFCAllocator : public Allocator {
   static constexpr int kInvalidBinNum = -1;
   // The following means that the largest bin'd chunk size is 256 << 21 = 512MB.
   static constexpr int kNumBins = 21;
+  // The bins up to `kMaxCachedBinSize` may have their chunks cached.
+  static constexpr int kNumCachedBins = 13;
+  static_assert((size_t{256} << (kNumCachedBins - 1)) == kMaxCachedBinSize);
+
+  class ChunkCache;
 
   // A Chunk points to a piece of memory that's either entirely free or entirely
   // in use by one user memory allocation.
@@ -550,7 +585,7 @@ class BFCAllocator : public Allocator {
   size_t BinNumToSize(BinNum index) {
     return static_cast<size_t>(256) << index;
   }
-  BinNum BinNumForSize(size_t bytes) {
+  static BinNum BinNumForSize(size_t bytes) {
     uint64 v = std::max<size_t>(bytes, 256) >> kMinAllocationBits;
     int b = std::min(kNumBins - 1, tsl::Log2Floor64(v));
     return b;
@@ -578,6 +613,9 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Null unless `Options::chunk_cache_bytes` is positive.
+  std::unique_ptr<ChunkCache> chunk_cache_;
+
   // Structures mutable after construction
   mutable absl::Mutex mutex_;
   RegionManager region_manager_ ABSL_GUARDED_BY(mutex_);
@@ -142,6 +142,16 @@ class ServingDeviceSelector {
     // Selects a device based on the tracked states of all devices.
     virtual int SelectDevice(absl::string_view program_fingerprint,
                              const DeviceStates& device_states) = 0;
+
+   protected:
+    // Estimates the time in nanoseconds until the device becomes idle, over
+    // the queues of all priorities.
+    static int64_t EstimateTimeTillIdleNs(const DeviceState& device_state,
+                                          int64_t now_ns) {
+      return ServingDeviceSelector::EstimateTimeTillIdleNs(
+          device_state, device_state.enqueued_programs.size() - 1,
+          /*min_exec_time=*/0, now_ns);
+    }
   };
 
   virtual ~ServingDeviceSelector() = default;
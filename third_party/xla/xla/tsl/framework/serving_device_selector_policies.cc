@@ -15,8 +15,11 @@ limitations under the License.
 #include "xla/tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
+#include <limits>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "xla/tsl/framework/serving_device_selector.h"
 
 namespace tsl {
@@ -28,4 +31,39 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+LeastLoadedPolicy::LeastLoadedPolicy(int64_t (*now_ns)())
+    : now_ns_(now_ns != nullptr ? now_ns : absl::GetCurrentTimeNanos),
+      ordinal_(0) {}
+
+int LeastLoadedPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int64_t now_ns = now_ns_();
+  const int start =
+      ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
+  int best_device = start;
+  int64_t best_ns = std::numeric_limits<int64_t>::max();
+  size_t best_queued = std::numeric_limits<size_t>::max();
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const ServingDeviceSelector::DeviceState& state =
+        device_states.states[device];
+    const int64_t ns = EstimateTimeTillIdleNs(state, now_ns);
+    size_t queued = 0;
+    for (const auto& programs : state.enqueued_programs) {
+      queued += programs.size();
+    }
+    for (const auto& programs : state.scheduled_programs) {
+      queued += programs.size();
+    }
+    if (ns < best_ns || (ns == best_ns && queued < best_queued)) {
+      best_device = device;
+      best_ns = ns;
+      best_queued = queued;
+    }
+  }
+  return best_device;
+}
+
 }  // namespace tsl
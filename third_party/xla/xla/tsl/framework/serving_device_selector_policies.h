@@ -16,6 +16,7 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
 
 #include "xla/tsl/framework/serving_device_selector.h"
 
@@ -23,6 +24,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLeastLoaded,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +39,27 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device that is expected to become idle first, based on the
+// running average execution time of the programs queued on each device. Since
+// the new program costs the same on every device, this is also the device on
+// which it is expected to complete first. Ties, e.g. between idle devices or
+// devices running programs that never completed before, go to the device with
+// the fewest queued programs, and then rotate across devices.
+class LeastLoadedPolicy : public ServingDeviceSelector::Policy {
+ public:
+  // `now_ns` returns the current time in nanoseconds, on the same clock as the
+  // one used by the device selector; defaults to absl::GetCurrentTimeNanos.
+  explicit LeastLoadedPolicy(int64_t (*now_ns)() = nullptr);
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  int64_t (*now_ns_)();
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
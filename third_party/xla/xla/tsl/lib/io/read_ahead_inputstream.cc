@@ -0,0 +1,215 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/read_ahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+ReadAheadInputStream::ReadAheadInputStream(RandomAccessFile* file,
+                                           size_t block_size, int depth,
+                                           Runner runner)
+    : file_(file),
+      block_size_(std::max<size_t>(block_size, 1)),
+      depth_(std::max(depth, 1)),
+      runner_(std::move(runner)),
+      state_(std::make_shared<State>()) {}
+
+ReadAheadInputStream::~ReadAheadInputStream() {
+  DropBlocks();
+  mutex_lock l(state_->mu);
+  while (state_->reads_in_progress > 0) {
+    state_->cv.wait(l);
+  }
+}
+
+void ReadAheadInputStream::FillPipeline() {
+  std::vector<std::shared_ptr<Block>> to_issue;
+  while (!eof_ && blocks_.size() < depth_) {
+    auto block = std::make_shared<Block>();
+    block->offset = next_block_offset_;
+    next_block_offset_ += block_size_;
+    blocks_.push_back(block);
+    to_issue.push_back(std::move(block));
+  }
+  // Issue the reads without holding `State::mu`, since `runner_` may run them
+  // inline. The closures do not touch `this`, so they may safely run after the
+  // stream is destroyed, in which case the read has been cancelled.
+  for (auto& block : to_issue) {
+    runner_([state = state_, file = file_, block_size = block_size_,
+             block = std::move(block)]() {
+      {
+        mutex_lock l(state->mu);
+        if (block->started) {
+          return;
+        }
+        block->started = true;
+        ++state->reads_in_progress;
+      }
+      ReadBlock(file, block_size, state.get(), block.get());
+    });
+  }
+}
+
+void ReadAheadInputStream::ReadBlock(RandomAccessFile* file,
+                                     size_t block_size, State* state,
+                                     Block* block) {
+  tstring data;
+  data.resize_uninitialized(block_size);
+  char* buffer = &data[0];
+  absl::string_view result;
+  absl::Status s = file->Read(block->offset, block_size, &result, buffer);
+  if (result.data() != buffer) {
+    memmove(buffer, result.data(), result.size());
+  }
+  data.resize(result.size());
+
+  mutex_lock l(state->mu);
+  block->data = std::move(data);
+  // A short read at the end of the file is reported through the block size.
+  block->status = errors::IsOutOfRange(s) ? absl::OkStatus() : s;
+  block->done = true;
+  --state->reads_in_progress;
+  state->cv.notify_all();
+}
+
+void ReadAheadInputStream::DropBlocks() {
+  {
+    mutex_lock l(state_->mu);
+    for (const auto& block : blocks_) {
+      block->started = true;
+    }
+  }
+  blocks_.clear();
+}
+
+absl::Status ReadAheadInputStream::WaitForReadableBlock() {
+  while (true) {
+    FillPipeline();
+    if (blocks_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    Block* block = blocks_.front().get();
+    bool read_inline = false;
+    {
+      mutex_lock l(state_->mu);
+      if (!block->started) {
+        // The runner has not got to this read yet, and may never do so if its
+        // threads are blocked, so read the block on this thread instead.
+        block->started = true;
+        ++state_->reads_in_progress;
+        read_inline = true;
+      }
+    }
+    if (read_inline) {
+      ReadBlock(file_, block_size_, state_.get(), block);
+    } else {
+      mutex_lock l(state_->mu);
+      while (!block->done) {
+        state_->cv.wait(l);
+      }
+    }
+    TF_RETURN_IF_ERROR(block->status);
+    if (pos_in_block_ < block->data.size()) {
+      return absl::OkStatus();
+    }
+    if (block->data.size() < block_size_) {
+      // A short block marks the end of the file, so anything read ahead of it
+      // is empty.
+      eof_ = true;
+      DropBlocks();
+      pos_in_block_ = 0;
+      return errors::OutOfRange("reached end of file");
+    }
+    blocks_.pop_front();
+    pos_in_block_ = 0;
+  }
+}
+
+void ReadAheadInputStream::RestartAt(int64_t offset) {
+  DropBlocks();
+  next_block_offset_ = offset;
+  pos_in_block_ = 0;
+  pos_ = offset;
+  eof_ = false;
+}
+
+absl::Status ReadAheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                              tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  while (result->size() < bytes_to_read) {
+    absl::Status s = WaitForReadableBlock();
+    if (!s.ok()) {
+      return s;
+    }
+    const Block& block = *blocks_.front();
+    const size_t bytes = std::min<size_t>(block.data.size() - pos_in_block_,
+                                          bytes_to_read - result->size());
+    result->append(block.data.data() + pos_in_block_, bytes);
+    pos_in_block_ += bytes;
+    pos_ += bytes;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadAheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  const int64_t target = pos_ + bytes_to_skip;
+  if (target >= next_block_offset_ && bytes_to_skip > 0) {
+    // The target is beyond the read-ahead window. Verify that it is within the
+    // file, as `RandomAccessInputStream` does, and restart read-ahead there.
+    char scratch;
+    absl::string_view data;
+    absl::Status s = file_->Read(target - 1, 1, &data, &scratch);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+    if (data.size() == 1) {
+      RestartAt(target);
+      return absl::OkStatus();
+    }
+  }
+  while (pos_ < target) {
+    TF_RETURN_IF_ERROR(WaitForReadableBlock());
+    const Block& block = *blocks_.front();
+    const size_t bytes = std::min<size_t>(block.data.size() - pos_in_block_,
+                                          target - pos_);
+    pos_in_block_ += bytes;
+    pos_ += bytes;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadAheadInputStream::Reset() {
+  RestartAt(0);
+  return absl::OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,126 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+#define XLA_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/status/status.h"
+#include "xla/tsl/lib/io/inputstream_interface.h"
+#include "xla/tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tsl {
+namespace io {
+
+// An InputStreamInterface that reads a RandomAccessFile sequentially while
+// keeping up to `depth` block reads of `block_size` bytes in flight.
+//
+// Reads are issued through a caller-provided `runner`, so a single consumer
+// thread can keep many outstanding reads against high-latency storage without
+// dedicating a thread to each file. The runner may execute closures inline.
+// The consumer never waits for a read that the runner has not started: it
+// performs such a read itself, so a runner whose threads are all busy (for
+// example, blocked on this stream's consumer) slows read-ahead down but cannot
+// deadlock it.
+//
+// A given instance of ReadAheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  using Runner = std::function<void(std::function<void()>)>;
+
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadAheadInputStream(RandomAccessFile* file, size_t block_size, int depth,
+                       Runner runner);
+
+  // Cancels the reads that have not started and blocks until the ones in
+  // progress have completed.
+  ~ReadAheadInputStream() override;
+
+  absl::Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  absl::Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override { return pos_; }
+
+  absl::Status Reset() override;
+
+ private:
+  struct Block {
+    int64_t offset = 0;
+    // The fields below are guarded by `State::mu` until `done` is set, after
+    // which they are only accessed by the consumer.
+    tstring data;
+    absl::Status status;
+    // Set by whichever of the runner and the consumer claims the read first,
+    // or when the block is dropped before its read started.
+    bool started = false;
+    bool done = false;
+  };
+
+  // State shared with the closures handed to `runner_`, which may run after
+  // the stream has been destroyed.
+  struct State {
+    mutex mu;
+    condition_variable cv;
+    int64_t reads_in_progress TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Issues reads until `depth_` blocks are queued or the end of the file has
+  // been observed.
+  void FillPipeline();
+
+  // Reads `block`, which the caller has claimed, from `file` and marks it as
+  // done.
+  static void ReadBlock(RandomAccessFile* file, size_t block_size,
+                        State* state, Block* block);
+
+  // Drops all queued blocks, cancelling the reads that have not started.
+  void DropBlocks();
+
+  // Waits until the front block has unread data. Returns OUT_OF_RANGE at the
+  // end of the file.
+  absl::Status WaitForReadableBlock();
+
+  // Drops all queued blocks and restarts read-ahead at `offset`.
+  void RestartAt(int64_t offset);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t block_size_;
+  const size_t depth_;
+  const Runner runner_;
+
+  // Blocks are shared with in-flight reads, so that dropping a block does not
+  // invalidate the buffer its read is writing into.
+  std::deque<std::shared_ptr<Block>> blocks_;
+  int64_t next_block_offset_ = 0;  // File offset of the next block to issue.
+  size_t pos_in_block_ = 0;        // Consumer offset within `blocks_.front()`.
+  int64_t pos_ = 0;                // Consumer offset within the file.
+  bool eof_ = false;               // Whether a short block has been consumed.
+
+  const std::shared_ptr<State> state_;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
@@ -0,0 +1,123 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/read_ahead_inputstream.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/test.h"
+#include "xla/tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+ReadAheadInputStream::Runner InlineRunner() {
+  return [](std::function<void()> fn) { fn(); };
+}
+
+class ReadAheadInputStreamTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    fname_ = testing::TmpDir() + "/read_ahead_inputstream_test";
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname_, "0123456789"));
+    TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname_, &file_));
+  }
+
+  std::string fname_;
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST_P(ReadAheadInputStreamTest, ReadNBytes) {
+  thread::ThreadPool pool(Env::Default(), "read_ahead", 4);
+  ReadAheadInputStream in(
+      file_.get(), /*block_size=*/3, /*depth=*/GetParam(),
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); });
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(4, &read));
+  EXPECT_EQ(read, "0123");
+  EXPECT_EQ(4, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(0, &read));
+  EXPECT_EQ(read, "");
+  TF_ASSERT_OK(in.ReadNBytes(5, &read));
+  EXPECT_EQ(read, "45678");
+  EXPECT_EQ(9, in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+  EXPECT_EQ(read, "9");
+  EXPECT_EQ(10, in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  EXPECT_EQ(read, "");
+}
+
+TEST_P(ReadAheadInputStreamTest, SkipNBytes) {
+  ReadAheadInputStream in(file_.get(), /*block_size=*/3, /*depth=*/GetParam(),
+                          InlineRunner());
+  tstring read;
+  TF_ASSERT_OK(in.SkipNBytes(1));
+  EXPECT_EQ(1, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(2, &read));
+  EXPECT_EQ(read, "12");
+  // Skip beyond the read-ahead window.
+  TF_ASSERT_OK(in.SkipNBytes(5));
+  EXPECT_EQ(8, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(1, &read));
+  EXPECT_EQ(read, "8");
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+  EXPECT_EQ(10, in.Tell());
+}
+
+TEST_P(ReadAheadInputStreamTest, Reset) {
+  ReadAheadInputStream in(file_.get(), /*block_size=*/4, /*depth=*/GetParam(),
+                          InlineRunner());
+  tstring read;
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(11, &read)));
+  EXPECT_EQ(read, "0123456789");
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(0, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(10, &read));
+  EXPECT_EQ(read, "0123456789");
+}
+
+TEST_P(ReadAheadInputStreamTest, RunnerThatNeverRuns) {
+  // Models a runner whose threads are all blocked, e.g. on this consumer.
+  std::vector<std::function<void()>> pending;
+  {
+    ReadAheadInputStream in(
+        file_.get(), /*block_size=*/3, /*depth=*/GetParam(),
+        [&pending](std::function<void()> fn) {
+          pending.push_back(std::move(fn));
+        });
+    tstring read;
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(11, &read)));
+    EXPECT_EQ(read, "0123456789");
+  }
+  EXPECT_FALSE(pending.empty());
+  // Closures that run after the stream is gone are cancelled reads.
+  for (auto& fn : pending) {
+    fn();
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Depths, ReadAheadInputStreamTest,
+                         ::testing::Values(1, 2, 8));
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
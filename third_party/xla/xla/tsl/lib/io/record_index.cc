@@ -0,0 +1,230 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xla/tsl/lib/io/record_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/lib/hash/crc32c.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/file_system.h"
+#include "tsl/platform/coding.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr char kRecordIndexSuffix[] = ".idx";
+
+uint32_t FooterChecksum(const char* footer) {
+  return crc32c::Mask(
+      crc32c::Value(footer, sizeof(uint64_t) + sizeof(uint32_t)));
+}
+
+uint64_t NumBlocks(uint64_t num_records) {
+  return (num_records + RecordIndexWriter::kEntriesPerBlock - 1) /
+         RecordIndexWriter::kEntriesPerBlock;
+}
+
+uint64_t IndexFileSize(uint64_t num_records, bool block_checksums) {
+  uint64_t size = num_records * RecordIndexWriter::kEntrySize +
+                  RecordIndexWriter::kFooterSize;
+  if (block_checksums) {
+    size += NumBlocks(num_records) * sizeof(uint32_t);
+  }
+  return size;
+}
+
+RecordLocation DecodeEntry(const char* entry) {
+  RecordLocation location;
+  location.offset = core::DecodeFixed64(entry);
+  location.length = core::DecodeFixed64(entry + sizeof(uint64_t));
+  return location;
+}
+
+}  // namespace
+
+std::string RecordIndexFileName(absl::string_view filename) {
+  return absl::StrCat(filename, kRecordIndexSuffix);
+}
+
+RecordIndexWriter::RecordIndexWriter(WritableFile* dest,
+                                     const RecordIndexOptions& options)
+    : dest_(dest), options_(options) {}
+
+absl::Status RecordIndexWriter::Add(const RecordLocation& location) {
+  if (finished_) {
+    return absl::FailedPreconditionError(
+        "Cannot add records to a finished record index.");
+  }
+  char entry[kEntrySize];
+  core::EncodeFixed64(entry, location.offset);
+  core::EncodeFixed64(entry + sizeof(uint64_t), location.length);
+  TF_RETURN_IF_ERROR(dest_->Append(absl::string_view(entry, sizeof(entry))));
+  ++num_records_;
+  if (options_.block_checksums) {
+    block_crc_ = crc32c::Extend(block_crc_, entry, sizeof(entry));
+    if (num_records_ % kEntriesPerBlock == 0) {
+      block_crcs_.push_back(crc32c::Mask(block_crc_));
+      block_crc_ = 0;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RecordIndexWriter::Finish() {
+  if (finished_) {
+    return absl::FailedPreconditionError("Record index is already finished.");
+  }
+  uint32_t flags = 0;
+  if (options_.block_checksums) {
+    flags |= kBlockChecksums;
+    if (num_records_ % kEntriesPerBlock != 0) {
+      block_crcs_.push_back(crc32c::Mask(block_crc_));
+    }
+    std::string checksums;
+    checksums.reserve(block_crcs_.size() * sizeof(uint32_t));
+    for (uint32_t crc : block_crcs_) {
+      core::PutFixed32(&checksums, crc);
+    }
+    TF_RETURN_IF_ERROR(dest_->Append(checksums));
+  }
+  char footer[kFooterSize];
+  core::EncodeFixed64(footer, num_records_);
+  core::EncodeFixed32(footer + sizeof(uint64_t), flags);
+  core::EncodeFixed32(footer + sizeof(uint64_t) + sizeof(uint32_t),
+                      FooterChecksum(footer));
+  core::EncodeFixed64(footer + sizeof(uint64_t) + 2 * sizeof(uint32_t), kMagic);
+  finished_ = true;
+  return dest_->Append(absl::string_view(footer, sizeof(footer)));
+}
+
+absl::StatusOr<std::unique_ptr<RecordIndex>> RecordIndex::Open(
+    Env* env, const std::string& filename) {
+  uint64_t file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size < RecordIndexWriter::kFooterSize) {
+    return absl::DataLossError(
+        absl::StrCat("Record index ", filename, " is too small: ", file_size,
+                     " bytes."));
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  char scratch[RecordIndexWriter::kFooterSize];
+  absl::string_view footer;
+  TF_RETURN_IF_ERROR(file->Read(file_size - RecordIndexWriter::kFooterSize,
+                                RecordIndexWriter::kFooterSize, &footer,
+                                scratch));
+  if (footer.size() != RecordIndexWriter::kFooterSize ||
+      core::DecodeFixed64(footer.data() + sizeof(uint64_t) +
+                          2 * sizeof(uint32_t)) != RecordIndexWriter::kMagic) {
+    return absl::DataLossError(
+        absl::StrCat("Invalid record index footer in ", filename));
+  }
+  const uint32_t expected_crc =
+      core::DecodeFixed32(footer.data() + sizeof(uint64_t) + sizeof(uint32_t));
+  if (FooterChecksum(footer.data()) != expected_crc) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupted record index footer in ", filename));
+  }
+  const uint64_t num_records = core::DecodeFixed64(footer.data());
+  const uint32_t flags = core::DecodeFixed32(footer.data() + sizeof(uint64_t));
+  if ((flags & ~RecordIndexWriter::kBlockChecksums) != 0) {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported record index flags ", flags, " in ", filename));
+  }
+  const bool block_checksums =
+      (flags & RecordIndexWriter::kBlockChecksums) != 0;
+  const uint64_t expected_size = IndexFileSize(num_records, block_checksums);
+  if (expected_size != file_size) {
+    return absl::DataLossError(absl::StrCat(
+        "Record index ", filename, " has ", file_size, " bytes, expected ",
+        expected_size, " bytes for ", num_records, " records."));
+  }
+  return absl::WrapUnique(new RecordIndex(std::move(file), filename,
+                                          num_records, block_checksums));
+}
+
+RecordIndex::RecordIndex(std::unique_ptr<RandomAccessFile> file,
+                         std::string filename, uint64_t num_records,
+                         bool block_checksums)
+    : file_(std::move(file)),
+      filename_(std::move(filename)),
+      num_records_(num_records),
+      block_checksums_(block_checksums) {}
+
+absl::StatusOr<RecordLocation> RecordIndex::GetLocation(uint64_t index) const {
+  if (index >= num_records_) {
+    return absl::OutOfRangeError(absl::StrCat(
+        "Record index ", index, " is out of range [0, ", num_records_,
+        ") in ", filename_));
+  }
+  if (block_checksums_) {
+    return GetVerifiedLocation(index);
+  }
+  char scratch[RecordIndexWriter::kEntrySize];
+  absl::string_view entry;
+  TF_RETURN_IF_ERROR(file_->Read(index * RecordIndexWriter::kEntrySize,
+                                 RecordIndexWriter::kEntrySize, &entry,
+                                 scratch));
+  if (entry.size() != RecordIndexWriter::kEntrySize) {
+    return absl::DataLossError(
+        absl::StrCat("Truncated read from record index ", filename_));
+  }
+  return DecodeEntry(entry.data());
+}
+
+absl::StatusOr<RecordLocation> RecordIndex::GetVerifiedLocation(
+    uint64_t index) const {
+  const uint64_t block = index / RecordIndexWriter::kEntriesPerBlock;
+  const uint64_t first = block * RecordIndexWriter::kEntriesPerBlock;
+  const uint64_t block_size =
+      std::min(RecordIndexWriter::kEntriesPerBlock, num_records_ - first) *
+      RecordIndexWriter::kEntrySize;
+  std::string scratch(block_size, '\0');
+  absl::string_view entries;
+  TF_RETURN_IF_ERROR(file_->Read(first * RecordIndexWriter::kEntrySize,
+                                 block_size, &entries, &scratch[0]));
+  char crc_scratch[sizeof(uint32_t)];
+  absl::string_view crc;
+  TF_RETURN_IF_ERROR(
+      file_->Read(num_records_ * RecordIndexWriter::kEntrySize +
+                      block * sizeof(uint32_t),
+                  sizeof(uint32_t), &crc, crc_scratch));
+  if (entries.size() != block_size || crc.size() != sizeof(uint32_t)) {
+    return absl::DataLossError(
+        absl::StrCat("Truncated read from record index ", filename_));
+  }
+  if (crc32c::Mask(crc32c::Value(entries.data(), entries.size())) !=
+      core::DecodeFixed32(crc.data())) {
+    return absl::DataLossError(absl::StrCat("Corrupted block ", block,
+                                            " in record index ", filename_));
+  }
+  return DecodeEntry(entries.data() +
+                     (index - first) * RecordIndexWriter::kEntrySize);
+}
+
+}  // namespace io
+}  // namespace tsl
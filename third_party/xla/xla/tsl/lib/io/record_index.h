@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef XLA_TSL_LIB_IO_RECORD_INDEX_H_
+#define XLA_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/file_system.h"
+
+namespace tsl {
+namespace io {
+
+// A sidecar index of the records in an uncompressed TFRecord file. It allows
+// seeking to record N without scanning the file.
+//
+// Format of the index file:
+//  entry[num_records]:
+//    uint64    offset of the record in the TFRecord file
+//    uint64    length of the record data
+//  block_crc[num_blocks]:   (only if kBlockChecksums is set in flags)
+//    uint32    masked crc of the entries of the block
+//  footer:
+//    uint64    num_records
+//    uint32    flags
+//    uint32    masked crc of num_records and flags
+//    uint64    magic number
+//
+// The offset points to the record header, so `RecordReader::ReadRecord` can
+// read the record directly from it. Entries are grouped in blocks of
+// `kEntriesPerBlock`; the last block may be partial.
+struct RecordLocation {
+  uint64_t offset = 0;
+  uint64_t length = 0;
+};
+
+// Returns the name of the index file of the TFRecord file `filename`.
+std::string RecordIndexFileName(absl::string_view filename);
+
+struct RecordIndexOptions {
+  // If true, a checksum is stored for every block of entries and verified
+  // whenever a location is read from the block.
+  bool block_checksums = false;
+};
+
+// Writes a record index file.
+//
+// Note: this class is not thread safe; external synchronization required.
+class RecordIndexWriter {
+ public:
+  static constexpr size_t kEntrySize = 2 * sizeof(uint64_t);
+  static constexpr size_t kFooterSize =
+      2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+  static constexpr uint64_t kMagic = 0x78646e4963657254ull;  // "TrecIndx"
+  static constexpr uint64_t kEntriesPerBlock = 256;
+
+  // Flags stored in the footer.
+  static constexpr uint32_t kBlockChecksums = 1u << 0;
+
+  // Create a writer that will append the index to "*dest".
+  // "*dest" must remain live while this Writer is in use.
+  explicit RecordIndexWriter(
+      WritableFile* dest,
+      const RecordIndexOptions& options = RecordIndexOptions());
+
+  // Appends the location of the next record.
+  absl::Status Add(const RecordLocation& location);
+
+  // Writes the footer. `dest` is not closed. No more records can be added.
+  absl::Status Finish();
+
+  uint64_t num_records() const { return num_records_; }
+
+ private:
+  WritableFile* dest_;
+  const RecordIndexOptions options_;
+  uint64_t num_records_ = 0;
+  bool finished_ = false;
+  // Unmasked crc of the entries of the current block, and the masked crcs of
+  // all completed blocks. Only used with `block_checksums`.
+  uint32_t block_crc_ = 0;
+  std::vector<uint32_t> block_crcs_;
+
+  RecordIndexWriter(const RecordIndexWriter&) = delete;
+  void operator=(const RecordIndexWriter&) = delete;
+};
+
+// Reads a record index file. Record locations are read from the file on
+// demand, so memory usage does not depend on the number of records.
+//
+// This class is thread safe.
+class RecordIndex {
+ public:
+  // Opens the index file `filename` and validates its footer.
+  static absl::StatusOr<std::unique_ptr<RecordIndex>> Open(
+      Env* env, const std::string& filename);
+
+  uint64_t num_records() const { return num_records_; }
+  bool has_block_checksums() const { return block_checksums_; }
+
+  // Returns the location of the record at `index`. Returns OUT_OF_RANGE if
+  // `index` >= `num_records()`, or DATA_LOSS if the block holding the entry
+  // fails checksum verification.
+  absl::StatusOr<RecordLocation> GetLocation(uint64_t index) const;
+
+ private:
+  RecordIndex(std::unique_ptr<RandomAccessFile> file, std::string filename,
+              uint64_t num_records, bool block_checksums);
+
+  // Reads the entry at `index` and verifies the checksum of its block.
+  absl::StatusOr<RecordLocation> GetVerifiedLocation(uint64_t index) const;
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  const std::string filename_;
+  const uint64_t num_records_;
+  const bool block_checksums_;
+
+  RecordIndex(const RecordIndex&) = delete;
+  void operator=(const RecordIndex&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_RECORD_INDEX_H_
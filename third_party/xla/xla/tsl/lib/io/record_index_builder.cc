@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xla/tsl/lib/io/record_index_builder.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/io/record_index.h"
+#include "xla/tsl/lib/io/record_reader.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/file_system.h"
+#include "tsl/platform/tstring.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// Buffer size used when scanning a TFRecord file to build its index.
+constexpr int64_t kBuildIndexBufferSize = 256 << 10;  // 256KB
+
+}  // namespace
+
+absl::Status BuildRecordIndex(Env* env, const std::string& tfrecord_filename,
+                              const std::string& index_filename,
+                              const RecordIndexOptions& options) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(tfrecord_filename, &file));
+  RecordReaderOptions reader_options;
+  reader_options.buffer_size = kBuildIndexBufferSize;
+  RecordReader reader(file.get(), reader_options);
+
+  // Writes to a temporary file first so that readers never observe a
+  // partially written index.
+  const std::string tmp_filename = absl::StrCat(index_filename, ".tmp");
+  std::unique_ptr<WritableFile> dest;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &dest));
+  RecordIndexWriter writer(dest.get(), options);
+  uint64_t offset = 0;
+  while (true) {
+    RecordLocation location;
+    location.offset = offset;
+    tstring record;
+    absl::Status s = reader.ReadRecord(&offset, &record);
+    if (absl::IsOutOfRange(s)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(s);
+    location.length = record.size();
+    TF_RETURN_IF_ERROR(writer.Add(location));
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  TF_RETURN_IF_ERROR(dest->Close());
+  return env->RenameFile(tmp_filename, index_filename);
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,37 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef XLA_TSL_LIB_IO_RECORD_INDEX_BUILDER_H_
+#define XLA_TSL_LIB_IO_RECORD_INDEX_BUILDER_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "xla/tsl/lib/io/record_index.h"
+#include "xla/tsl/platform/env.h"
+
+namespace tsl {
+namespace io {
+
+// Scans the uncompressed TFRecord file `tfrecord_filename` and writes its
+// index to `index_filename`. Every record is verified while scanning.
+absl::Status BuildRecordIndex(
+    Env* env, const std::string& tfrecord_filename,
+    const std::string& index_filename,
+    const RecordIndexOptions& options = RecordIndexOptions());
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_RECORD_INDEX_BUILDER_H_
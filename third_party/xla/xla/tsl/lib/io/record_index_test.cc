@@ -0,0 +1,259 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xla/tsl/lib/io/record_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/record_index_builder.h"
+#include "xla/tsl/lib/io/record_reader.h"
+#include "xla/tsl/lib/io/record_writer.h"
+#include "xla/tsl/platform/env.h"
+#include "xla/tsl/platform/status_matchers.h"
+#include "xla/tsl/platform/statusor.h"
+#include "xla/tsl/platform/test.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/tstring.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+std::string TestFileName(const std::string& name) {
+  return tsl::io::JoinPath(testing::TmpDir(), name);
+}
+
+std::vector<std::string> TestRecords(int64_t num_records) {
+  std::vector<std::string> records;
+  for (int64_t i = 0; i < num_records; ++i) {
+    records.push_back(std::string(i % 17, 'a' + i % 26));
+  }
+  return records;
+}
+
+void WriteRecords(const std::string& filename,
+                  const std::vector<std::string>& records) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+  RecordWriter writer(file.get());
+  for (const std::string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+}
+
+TEST(RecordIndexTest, RandomAccess) {
+  const std::string filename = TestFileName("record_index_random_access");
+  const std::vector<std::string> records = TestRecords(100);
+  WriteRecords(filename, records);
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename,
+                                RecordIndexFileName(filename)));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RecordIndex> index,
+      RecordIndex::Open(Env::Default(), RecordIndexFileName(filename)));
+  ASSERT_EQ(index->num_records(), records.size());
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  RecordReader reader(file.get());
+  for (uint64_t i : {99, 0, 17, 50, 1, 98}) {
+    TF_ASSERT_OK_AND_ASSIGN(RecordLocation location, index->GetLocation(i));
+    EXPECT_EQ(location.length, records[i].size());
+    uint64_t offset = location.offset;
+    tstring record;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+  EXPECT_THAT(index->GetLocation(records.size()),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const std::string filename = TestFileName("record_index_empty");
+  WriteRecords(filename, {});
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename,
+                                RecordIndexFileName(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RecordIndex> index,
+      RecordIndex::Open(Env::Default(), RecordIndexFileName(filename)));
+  EXPECT_EQ(index->num_records(), 0);
+  EXPECT_THAT(index->GetLocation(0), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(RecordIndexTest, CorruptedFooter) {
+  const std::string filename = TestFileName("record_index_corrupted");
+  WriteRecords(filename, TestRecords(10));
+  const std::string index_filename = RecordIndexFileName(filename);
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename, index_filename));
+
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+  contents[contents.size() - RecordIndexWriter::kFooterSize] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, contents));
+  EXPECT_THAT(RecordIndex::Open(Env::Default(), index_filename),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(RecordIndexTest, TruncatedIndex) {
+  const std::string filename = TestFileName("record_index_truncated");
+  WriteRecords(filename, TestRecords(10));
+  const std::string index_filename = RecordIndexFileName(filename);
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename, index_filename));
+
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), index_filename,
+      contents.substr(RecordIndexWriter::kEntrySize)));
+  EXPECT_THAT(RecordIndex::Open(Env::Default(), index_filename),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(RecordIndexTest, CorruptedTFRecordFile) {
+  const std::string filename = TestFileName("record_index_bad_tfrecord");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 "not a TFRecord file, not a TFRecord file"));
+  EXPECT_THAT(BuildRecordIndex(Env::Default(), filename,
+                               RecordIndexFileName(filename)),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(RecordIndexTest, BlockChecksums) {
+  const std::string filename = TestFileName("record_index_block_checksums");
+  // Two full blocks and a partial one.
+  const std::vector<std::string> records =
+      TestRecords(2 * RecordIndexWriter::kEntriesPerBlock + 10);
+  WriteRecords(filename, records);
+  const std::string index_filename = RecordIndexFileName(filename);
+  RecordIndexOptions options;
+  options.block_checksums = true;
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename, index_filename,
+                                options));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<RecordIndex> index,
+                          RecordIndex::Open(Env::Default(), index_filename));
+  ASSERT_EQ(index->num_records(), records.size());
+  EXPECT_TRUE(index->has_block_checksums());
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  RecordReader reader(file.get());
+  for (uint64_t i : {uint64_t{0}, RecordIndexWriter::kEntriesPerBlock,
+                     uint64_t{records.size() - 1}}) {
+    TF_ASSERT_OK_AND_ASSIGN(RecordLocation location, index->GetLocation(i));
+    uint64_t offset = location.offset;
+    tstring record;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+
+  // Corrupts an entry of the second block.
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+  contents[(RecordIndexWriter::kEntriesPerBlock + 3) *
+           RecordIndexWriter::kEntrySize] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, contents));
+  TF_ASSERT_OK_AND_ASSIGN(index,
+                          RecordIndex::Open(Env::Default(), index_filename));
+  TF_EXPECT_OK(index->GetLocation(0).status());
+  EXPECT_THAT(index->GetLocation(RecordIndexWriter::kEntriesPerBlock + 1),
+              StatusIs(absl::StatusCode::kDataLoss));
+  TF_EXPECT_OK(index->GetLocation(records.size() - 1).status());
+}
+
+TEST(RecordIndexTest, WrittenByRecordWriter) {
+  const std::string filename = TestFileName("record_index_record_writer");
+  const std::string index_filename = RecordIndexFileName(filename);
+  const std::vector<std::string> records = TestRecords(300);
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(index_filename, &index_file));
+  RecordWriterOptions options;
+  options.index_dest = index_file.get();
+  options.index_options.block_checksums = true;
+  {
+    RecordWriter writer(file.get(), options);
+    for (const std::string& record : records) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    TF_ASSERT_OK(writer.Close());
+  }
+  TF_ASSERT_OK(file->Close());
+  TF_ASSERT_OK(index_file->Close());
+
+  // The index matches the one built by scanning the file.
+  const std::string built_filename = TestFileName("record_index_built");
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename, built_filename,
+                                options.index_options));
+  std::string written, built;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &written));
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), built_filename, &built));
+  EXPECT_EQ(written, built);
+}
+
+TEST(RecordIndexTest, SequentialReaderSeekToRecord) {
+  const std::string filename = TestFileName("record_index_seek");
+  const std::vector<std::string> records = TestRecords(50);
+  WriteRecords(filename, records);
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename,
+                                RecordIndexFileName(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RecordIndex> index,
+      RecordIndex::Open(Env::Default(), RecordIndexFileName(filename)));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  RecordReaderOptions options;
+  options.buffer_size = 1024;
+  SequentialRecordReader reader(file.get(), options);
+  TF_ASSERT_OK(reader.SeekToRecord(*index, 20));
+  tstring record;
+  TF_ASSERT_OK(reader.ReadRecord(&record));
+  EXPECT_EQ(record, records[20]);
+  TF_ASSERT_OK(reader.SeekToRecord(*index, 42));
+  TF_ASSERT_OK(reader.ReadRecord(&record));
+  EXPECT_EQ(record, records[42]);
+  TF_ASSERT_OK(reader.ReadRecord(&record));
+  EXPECT_EQ(record, records[43]);
+  EXPECT_THAT(reader.SeekToRecord(*index, 10),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(reader.SeekToRecord(*index, records.size()),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(RecordIndexTest, AddAfterFinish) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      TestFileName("record_index_add_after_finish"), &file));
+  RecordIndexWriter writer(file.get());
+  TF_ASSERT_OK(writer.Add({/*offset=*/0, /*length=*/10}));
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_THAT(writer.Add({/*offset=*/22, /*length=*/10}),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_EQ(writer.num_records(), 1);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -21,8 +21,11 @@ limitations under the License.
 #include "xla/tsl/lib/io/buffered_inputstream.h"
 #include "xla/tsl/lib/io/compression.h"
 #include "xla/tsl/lib/io/random_inputstream.h"
+#include "xla/tsl/lib/io/read_ahead_inputstream.h"
+#include "xla/tsl/lib/io/record_index.h"
 #include "xla/tsl/platform/env.h"
 #include "xla/tsl/platform/errors.h"
+#include "xla/tsl/platform/statusor.h"
 #include "tsl/platform/raw_coding.h"
 
 namespace tsl {
@@ -56,12 +59,17 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
-    : options_(options),
-      input_stream_(new RandomAccessInputStream(file)),
-      last_read_failed_(false) {
-  if (options.buffer_size > 0) {
-    input_stream_.reset(new BufferedInputStream(input_stream_.release(),
-                                                options.buffer_size, true));
+    : options_(options), last_read_failed_(false) {
+  if (options.buffer_size > 0 && options.read_ahead_depth > 0 &&
+      options.read_ahead_runner) {
+    input_stream_.reset(new ReadAheadInputStream(file, options.buffer_size,
+                                                 options.read_ahead_depth,
+                                                 options.read_ahead_runner));
+  } else if (options.buffer_size > 0) {
+    input_stream_.reset(new BufferedInputStream(
+        new RandomAccessInputStream(file), options.buffer_size, true));
+  } else {
+    input_stream_.reset(new RandomAccessInputStream(file));
   }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordReaderOptions::NONE) {
@@ -258,7 +266,98 @@ absl::Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
 
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
-    : underlying_(file, options), offset_(0) {}
+    : underlying_(file, options),
+      offset_(0),
+      compressed_(options.compression_type != RecordReaderOptions::NONE) {}
+
+absl::Status SequentialRecordReader::SeekToRecord(const RecordIndex& index,
+                                                  uint64 record_index) {
+  if (compressed_) {
+    return errors::FailedPrecondition(
+        "Seeking to a record through a record index requires an uncompressed "
+        "file.");
+  }
+  TF_ASSIGN_OR_RETURN(RecordLocation location,
+                      index.GetLocation(record_index));
+  return SeekOffset(location.offset);
+}
+
+MemoryMappedRecordReader::MemoryMappedRecordReader(
+    ReadOnlyMemoryRegion* region)
+    : data_(static_cast<const char*>(region->data())),
+      size_(region->length()) {}
+
+absl::Status MemoryMappedRecordReader::ParseRecord(
+    uint64 offset, bool verify_data, absl::string_view* record) const {
+  if (offset >= size_) {
+    return errors::OutOfRange("eof", GetChecksumErrorSuffix(offset));
+  }
+  if (size_ - offset < RecordReader::kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset,
+                            GetChecksumErrorSuffix(offset));
+  }
+
+  // Verify the header, containing size of data.
+  const char* header = data_ + offset;
+  const uint32 masked_length_crc = core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_length_crc) !=
+      crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset,
+                            GetChecksumErrorSuffix(offset));
+  }
+  const uint64 length = core::DecodeFixed64(header);
+
+  // Guard against overflow before computing the end of the record.
+  const uint64 remaining = size_ - offset - RecordReader::kHeaderSize;
+  if (remaining < RecordReader::kFooterSize ||
+      length > remaining - RecordReader::kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset,
+                            GetChecksumErrorSuffix(offset));
+  }
+
+  const char* payload = header + RecordReader::kHeaderSize;
+  if (verify_data) {
+    const uint32 masked_crc = core::DecodeFixed32(payload + length);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(payload, length)) {
+      return errors::DataLoss("corrupted record at ", offset,
+                              GetChecksumErrorSuffix(offset));
+    }
+  }
+  *record = absl::string_view(payload, length);
+  return absl::OkStatus();
+}
+
+absl::Status MemoryMappedRecordReader::ReadRecord(absl::string_view* record) {
+  TF_RETURN_IF_ERROR(ParseRecord(offset_, /*verify_data=*/true, record));
+  offset_ += RecordReader::kHeaderSize + record->size() +
+             RecordReader::kFooterSize;
+  return absl::OkStatus();
+}
+
+absl::Status MemoryMappedRecordReader::SkipRecords(int num_to_skip,
+                                                   int* num_skipped) {
+  *num_skipped = 0;
+  absl::string_view record;
+  for (int i = 0; i < num_to_skip; ++i) {
+    // Like `RecordReader::SkipRecords`, only the header checksum is verified
+    // for skipped records.
+    TF_RETURN_IF_ERROR(ParseRecord(offset_, /*verify_data=*/false, &record));
+    offset_ += RecordReader::kHeaderSize + record.size() +
+               RecordReader::kFooterSize;
+    (*num_skipped)++;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MemoryMappedRecordReader::SeekOffset(uint64 offset) {
+  if (offset > size_) {
+    return errors::InvalidArgument("Trying to seek offset: ", offset,
+                                   " which is beyond the end of the file: ",
+                                   size_);
+  }
+  offset_ = offset;
+  return absl::OkStatus();
+}
 
 }  // namespace io
 }  // namespace tsl
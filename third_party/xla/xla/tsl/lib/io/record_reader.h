@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef XLA_TSL_LIB_IO_RECORD_READER_H_
 #define XLA_TSL_LIB_IO_RECORD_READER_H_
 
+#include <functional>
+
 #include "xla/tsl/lib/io/inputstream_interface.h"
+#include "xla/tsl/lib/io/record_index.h"
 #include "xla/tsl/platform/errors.h"
 #include "tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
@@ -30,6 +33,7 @@ limitations under the License.
 
 namespace tsl {
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -46,6 +50,13 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If read_ahead_depth is positive, buffer_size is non-zero and
+  // read_ahead_runner is set, up to read_ahead_depth reads of buffer_size bytes
+  // are kept in flight, issued through read_ahead_runner. The same restrictions
+  // as for buffering apply.
+  int read_ahead_depth = 0;
+  std::function<void(std::function<void()>)> read_ahead_runner;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -169,9 +180,66 @@ class SequentialRecordReader {
     return absl::OkStatus();
   }
 
+  // Seek to the record at position `record_index` of the file, looked up in
+  // `index`, the record index of the file. This takes constant time instead
+  // of skipping over the preceding records. Only valid for uncompressed
+  // files; like SeekOffset(), seeking backward is an error.
+  absl::Status SeekToRecord(const RecordIndex& index, uint64 record_index);
+
  private:
   RecordReader underlying_;
   uint64 offset_ = 0;
+  const bool compressed_;
+};
+
+// Interface to read uncompressed TFRecord files that have been mapped into
+// memory, e.g. via `Env::NewReadOnlyMemoryRegionFromFile`.
+//
+// Unlike `RecordReader`, records are returned as views into the mapped region,
+// so no intermediate buffering or copying takes place. Checksums are verified
+// on every read, like in `RecordReader`.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MemoryMappedRecordReader {
+ public:
+  // Create a reader that will return records from "*region".
+  // "*region" must remain live while this Reader is in use.
+  explicit MemoryMappedRecordReader(tsl::ReadOnlyMemoryRegion* region);
+
+  virtual ~MemoryMappedRecordReader() = default;
+
+  // Read the next record in the region into *record. Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error. On success,
+  // *record points into the mapped region and remains valid for as long as
+  // the region is live.
+  absl::Status ReadRecord(absl::string_view* record);
+
+  // Skip the next num_to_skip record in the region. Return OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  // "*num_skipped" records the number of records that are actually skipped.
+  // It should be equal to num_to_skip on success.
+  absl::Status SkipRecords(int num_to_skip, int* num_skipped);
+
+  // Return the current offset in the region.
+  uint64 TellOffset() const { return offset_; }
+
+  // Seek to this offset within the region and set this offset as the current
+  // offset. Since the whole file is addressable, seeking backward is allowed.
+  absl::Status SeekOffset(uint64 offset);
+
+ private:
+  // Parses the record starting at `offset`. On success, stores the record
+  // payload (without header and footer) in *record. Data checksums are only
+  // verified if `verify_data` is true.
+  absl::Status ParseRecord(uint64 offset, bool verify_data,
+                           absl::string_view* record) const;
+
+  const char* const data_;
+  const uint64 size_;
+  uint64 offset_ = 0;
+
+  MemoryMappedRecordReader(const MemoryMappedRecordReader&) = delete;
+  void operator=(const MemoryMappedRecordReader&) = delete;
 };
 
 }  // namespace io
@@ -267,6 +267,76 @@ TEST(RecordReaderWriterTest, TestMalformedInput) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestMemoryMapped) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mmap_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_EXPECT_OK(writer.WriteRecord("hij"));
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+    io::MemoryMappedRecordReader reader(region.get());
+    absl::string_view record;
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("abc", record);
+    // The record is a view into the mapped region.
+    EXPECT_EQ(static_cast<const char*>(region->data()) +
+                  io::RecordReader::kHeaderSize,
+              record.data());
+    const uint64 second_offset = reader.TellOffset();
+    int num_skipped;
+    TF_CHECK_OK(reader.SkipRecords(1, &num_skipped));
+    EXPECT_EQ(1, num_skipped);
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("hij", record);
+    EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&record).code());
+
+    // Seeking backward is allowed.
+    TF_CHECK_OK(reader.SeekOffset(second_offset));
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("defg", record);
+    EXPECT_EQ(error::INVALID_ARGUMENT,
+              reader.SeekOffset(region->length() + 1).code());
+  }
+}
+
+TEST(RecordReaderWriterTest, TestMemoryMappedMalformedInput) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_mmap_malformed_input_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    TF_CHECK_OK(file->Append("abcdefghijklmno"));
+    TF_CHECK_OK(file->Close());
+  }
+
+  {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+    io::MemoryMappedRecordReader reader(region.get());
+    absl::string_view record;
+    absl::Status s = reader.ReadRecord(&record);
+    EXPECT_EQ(error::DATA_LOSS, s.code());
+    EXPECT_EQ("corrupted record at 0 (Is this even a TFRecord file?)",
+              s.message());
+    TF_CHECK_OK(reader.SeekOffset(10));
+    s = reader.ReadRecord(&record);
+    EXPECT_EQ(error::DATA_LOSS, s.code());
+    EXPECT_EQ("truncated record at 10", s.message());
+  }
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "xla/tsl/lib/io/record_writer.h"
 
+#include <memory>
+
 #include "xla/tsl/lib/hash/crc32c.h"
 #include "xla/tsl/lib/io/compression.h"
+#include "xla/tsl/lib/io/record_index.h"
 #include "xla/tsl/platform/env.h"
 #include "tsl/platform/coding.h"
 
@@ -84,6 +87,15 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options.index_dest != nullptr) {
+    if (options.compression_type == RecordWriterOptions::NONE) {
+      index_writer_ = std::make_unique<RecordIndexWriter>(
+          options.index_dest, options.index_options);
+    } else {
+      LOG(ERROR) << "Record indices are only supported for uncompressed "
+                 << "files. No index will be written.";
+    }
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -111,7 +123,8 @@ absl::Status RecordWriter::WriteRecord(absl::string_view data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(absl::string_view(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(absl::string_view(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(absl::string_view(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -131,12 +144,28 @@ absl::Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(absl::string_view(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(absl::string_view(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(absl::string_view(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 #endif
 
+absl::Status RecordWriter::AddToIndex(size_t length) {
+  const uint64 offset = offset_;
+  offset_ += kHeaderSize + length + kFooterSize;
+  if (index_writer_ == nullptr) return absl::OkStatus();
+  RecordLocation location;
+  location.offset = offset;
+  location.length = length;
+  return index_writer_->Add(location);
+}
+
 absl::Status RecordWriter::Close() {
   if (dest_ == nullptr) return absl::OkStatus();
+  if (index_writer_ != nullptr) {
+    absl::Status s = index_writer_->Finish();
+    index_writer_.reset();
+    TF_RETURN_IF_ERROR(s);
+  }
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     absl::Status s = dest_->Close();
     delete dest_;
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef XLA_TSL_LIB_IO_RECORD_WRITER_H_
 #define XLA_TSL_LIB_IO_RECORD_WRITER_H_
 
+#include <memory>
+
 #include "xla/tsl/lib/hash/crc32c.h"
+#include "xla/tsl/lib/io/record_index.h"
 #include "xla/tsl/platform/status.h"
 #include "tsl/platform/coding.h"
 #include "tsl/platform/stringpiece.h"
@@ -48,6 +51,13 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If set, the writer also appends a record index (see record_index.h) of
+  // the written records to "*index_dest" and finishes it on Close(). Only
+  // supported without compression. "*index_dest" is not closed by the writer
+  // and must remain live while the writer is in use.
+  WritableFile* index_dest = nullptr;
+  RecordIndexOptions index_options;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
@@ -88,7 +98,8 @@ class RecordWriter {
   // WritableFile.
   absl::Status Flush();
 
-  // Writes all output to the file. Does *not* close the WritableFile.
+  // Writes all output to the file, and finishes the record index if one is
+  // written. Does *not* close the WritableFile.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -114,6 +125,14 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Set if a record index is written. `offset_` is the offset of the next
+  // record in the uncompressed file.
+  std::unique_ptr<RecordIndexWriter> index_writer_;
+  uint64 offset_ = 0;
+
+  // Adds the next record of `length` bytes to the index, if any.
+  absl::Status AddToIndex(size_t length);
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -16,12 +16,14 @@ limitations under the License.
 #include "xla/tsl/platform/cloud/curl_http_request.h"
 
 #include <algorithm>
+#include <array>
 
 #include "xla/tsl/lib/gtl/map_util.h"
 #include "xla/tsl/platform/errors.h"
 #include "xla/tsl/platform/macros.h"
 #include "xla/tsl/platform/types.h"
 #include "xla/tsl/util/env_var.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/scanner.h"
 #include "tsl/platform/str_util.h"
 
@@ -112,6 +114,50 @@ class LibCurlProxy : public LibCurl {
   }
 
   void curl_free(void* p) override { ::curl_free(p); }
+
+  CURLSH* curl_share_handle() override { return share_; }
+
+ private:
+  LibCurlProxy() {
+    share_ = ::curl_share_init();
+    if (share_ == nullptr) {
+      LOG(WARNING) << "Couldn't initialize a curl share handle, DNS and TLS "
+                      "session caches won't be shared across requests.";
+      return;
+    }
+    // Share handles may be used from multiple threads, so libcurl requires
+    // lock callbacks. Connections are deliberately not shared: libcurl does
+    // not support using a shared connection cache from concurrent threads.
+    if (::curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &LockShare) !=
+            CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &UnlockShare) !=
+            CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) !=
+            CURLSHE_OK ||
+        ::curl_share_setopt(share_, CURLSHOPT_SHARE,
+                            CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK) {
+      LOG(WARNING) << "Couldn't configure the curl share handle, DNS and TLS "
+                      "session caches won't be shared across requests.";
+      ::curl_share_cleanup(share_);
+      share_ = nullptr;
+    }
+  }
+
+  static std::array<mutex, CURL_LOCK_DATA_LAST>& ShareLocks() {
+    static auto* locks = new std::array<mutex, CURL_LOCK_DATA_LAST>;
+    return *locks;
+  }
+
+  static void LockShare(CURL* handle, curl_lock_data data,
+                        curl_lock_access access, void* userptr) {
+    ShareLocks()[data].lock();
+  }
+
+  static void UnlockShare(CURL* handle, curl_lock_data data, void* userptr) {
+    ShareLocks()[data].unlock();
+  }
+
+  CURLSH* share_ = nullptr;
 };
 }  // namespace
 
@@ -140,6 +186,13 @@ CurlHttpRequest::CurlHttpRequest(LibCurl* libcurl, Env* env)
   // Do not use signals for timeouts - does not work in multi-threaded programs.
   CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L));
 
+  // Reuse resolved addresses and TLS sessions of previous requests instead of
+  // paying for a DNS lookup and a full TLS handshake on every request.
+  if (CURLSH* share = libcurl_->curl_share_handle()) {
+    CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_SHARE,
+                                             static_cast<void*>(share)));
+  }
+
   // TODO(b/74351157): Enable HTTP/2.
   CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
                                            CURL_HTTP_VERSION_1_1));
@@ -270,6 +270,11 @@ class LibCurl {
   virtual void curl_slist_free_all(curl_slist* list) = 0;
   virtual char* curl_easy_escape(CURL* curl, const char* str, int length) = 0;
   virtual void curl_free(void* p) = 0;
+
+  // Returns a share handle that every easy handle is attached to via
+  // CURLOPT_SHARE, so that state such as the DNS cache and TLS sessions is
+  // reused across requests. Returns nullptr if nothing is shared.
+  virtual CURLSH* curl_share_handle() { return nullptr; }
 };
 
 }  // namespace tsl
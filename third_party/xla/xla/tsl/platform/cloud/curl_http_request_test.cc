@@ -113,6 +113,9 @@ class FakeLibCurl : public LibCurl {
       case CURLOPT_XFERINFODATA:
         progress_data_ = param;
         break;
+      case CURLOPT_SHARE:
+        share_ = param;
+        break;
       default:
         break;
     }
@@ -231,11 +234,13 @@ class FakeLibCurl : public LibCurl {
     delete reinterpret_cast<std::vector<string>*>(list);
   }
   void curl_free(void* p) override { port::Free(p); }
+  CURLSH* curl_share_handle() override { return share_handle_; }
 
   // Variables defining the behavior of this fake.
   string response_content_;
   uint64 response_code_;
   std::vector<string> response_headers_;
+  CURLSH* share_handle_ = nullptr;
 
   // Internal variables to store the libcurl state.
   string url_;
@@ -260,6 +265,7 @@ class FakeLibCurl : public LibCurl {
   int (*progress_callback_)(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
                             curl_off_t ultotal, curl_off_t ulnow) = nullptr;
   void* progress_data_ = nullptr;
+  void* share_ = nullptr;
   // Outcome of performing the request.
   string posted_content_;
   CURLcode curl_easy_perform_result_ = CURLE_OK;
@@ -330,6 +336,29 @@ TEST(CurlHttpRequestTest, GetRequest_Direct) {
   EXPECT_EQ(200, http_request.GetResponseCode());
 }
 
+TEST(CurlHttpRequestTest, GetRequest_NoShareHandle) {
+  FakeLibCurl libcurl("get response", 200);
+  CurlHttpRequest http_request(&libcurl);
+
+  http_request.SetUri("http://www.testuri.com");
+  TF_EXPECT_OK(http_request.Send());
+
+  EXPECT_EQ(nullptr, libcurl.share_);
+}
+
+TEST(CurlHttpRequestTest, GetRequest_SharesStateAcrossRequests) {
+  FakeLibCurl libcurl("get response", 200);
+  int fake_share_handle = 0;
+  libcurl.share_handle_ = reinterpret_cast<CURLSH*>(&fake_share_handle);
+  CurlHttpRequest http_request(&libcurl);
+
+  http_request.SetUri("http://www.testuri.com");
+  TF_EXPECT_OK(http_request.Send());
+
+  EXPECT_EQ(&fake_share_handle, libcurl.share_);
+  EXPECT_EQ(200, http_request.GetResponseCode());
+}
+
 TEST(CurlHttpRequestTest, GetRequest_CustomCaInfoFlag) {
   static char set_var[] = "CURL_CA_BUNDLE=test";
   putenv(set_var);
@@ -1702,10 +1702,15 @@ absl::Status GcsFileSystem::GetMatchingPaths(const string& pattern,
           return errors::InvalidArgument(
               "A GCS pattern doesn't have a bucket name: ", pattern);
         }
+        // Every match starts with the part of the fixed prefix after `dir`, so
+        // only list the objects with that prefix rather than all objects
+        // under `dir`. E.g. "gs://bucket/data/train-*" lists "data/train-"
+        // instead of the whole "data/" folder.
+        const string name_prefix(this->Basename(fixed_prefix));
         std::vector<string> all_files;
         TF_RETURN_IF_ERROR(GetChildrenBounded(
             dir, UINT64_MAX, &all_files, true /* recursively */,
-            false /* include_self_directory_marker */));
+            false /* include_self_directory_marker */, name_prefix));
 
         const auto& files_and_folders = AddAllSubpaths(all_files);
 
@@ -1735,7 +1740,8 @@ absl::Status GcsFileSystem::GetMatchingPaths(const string& pattern,
 
 absl::Status GcsFileSystem::GetChildrenBounded(
     const string& dirname, uint64 max_results, std::vector<string>* result,
-    bool recursive, bool include_self_directory_marker) {
+    bool recursive, bool include_self_directory_marker,
+    const string& name_prefix) {
   if (!result) {
     return errors::InvalidArgument("'result' cannot be null");
   }
@@ -1759,9 +1765,10 @@ absl::Status GcsFileSystem::GetChildrenBounded(
                             "?fields=items%2Fname%2Cprefixes%2CnextPageToken");
       uri = strings::StrCat(uri, "&delimiter=%2F");
     }
-    if (!object_prefix.empty()) {
-      uri = strings::StrCat(uri,
-                            "&prefix=", request->EscapeString(object_prefix));
+    if (!object_prefix.empty() || !name_prefix.empty()) {
+      uri = strings::StrCat(
+          uri, "&prefix=",
+          request->EscapeString(strings::StrCat(object_prefix, name_prefix)));
     }
     if (!nextPageToken.empty()) {
       uri = strings::StrCat(
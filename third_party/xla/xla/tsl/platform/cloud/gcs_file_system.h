@@ -416,9 +416,14 @@ class GcsFileSystem : public FileSystem {
   /// If 'include_self_directory_marker' is true and there is a GCS directory
   /// marker at the path 'dir', GetChildrenBound will return an empty string
   /// as one of the children that represents this marker.
+  ///
+  /// If 'name_prefix' is not empty, only children whose path relative to 'dir'
+  /// starts with it are listed. The filtering is done by GCS, so the objects
+  /// that don't match are never transferred.
   absl::Status GetChildrenBounded(const string& dir, uint64 max_results,
                                   std::vector<string>* result, bool recursively,
-                                  bool include_self_directory_marker);
+                                  bool include_self_directory_marker,
+                                  const string& name_prefix = "");
 
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.